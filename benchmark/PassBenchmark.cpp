@@ -0,0 +1,280 @@
+//===- PassBenchmark.cpp - Compile time of the Triton passes -------------===//
+//
+// Times the major passes, and the whole pipeline from TTIR to LLVM IR, over
+// the tutorial kernels of the lit tests and over synthetic kernels scaled by
+// their number of loads and the depth of their loop nest. The input of each
+// pass is prepared by the passes before it outside of the timed region.
+// Every benchmark reports the peak resident memory of the process so far.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlow.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Transforms/Passes.h"
+#include "triton/Conversion/TritonGPUToLLVM/Passes.h"
+#include "triton/Conversion/TritonToLinalg/Passes.h"
+#include "triton/Conversion/TritonToTritonGPU/Passes.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Target/LLVMIR/LLVMIRTranslation.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+
+#include <string>
+#include <vector>
+
+using namespace mlir;
+
+namespace {
+
+// The pipelines of python/triton/compiler/compiler.py
+const std::string kOptimizeTTIR =
+    "inline,triton-combine,canonicalize,cse,loop-invariant-code-motion,"
+    "symbol-dce";
+const std::string kTTIRToTTGIR = "convert-triton-to-tritongpu{num-warps=4}";
+const std::string kCoalesce = "tt.func(tritongpu-coalesce)";
+const std::string kRemoveLayoutConversions =
+    "tt.func(tritongpu-remove-layout-conversions)";
+const std::string kBeforePipeline =
+    "tt.func(tritongpu-coalesce,tritongpu-remove-layout-conversions,"
+    "tritongpu-accelerate-matmul{compute-capability=80},"
+    "tritongpu-remove-layout-conversions,tritongpu-optimize-dot-operands)";
+const std::string kPipeline = "tt.func(tritongpu-pipeline{num-stages=3})";
+const std::string kAfterPipeline =
+    "tt.func(tritongpu-prefetch,tritongpu-optimize-dot-operands,"
+    "tritongpu-remove-layout-conversions,tritongpu-decompose-conversions,"
+    "tritongpu-reorder-instructions),cse,symbol-dce";
+
+std::string join(std::initializer_list<std::string> pipelines) {
+  std::string joined;
+  for (const std::string &pipeline : pipelines) {
+    if (!joined.empty() && !pipeline.empty())
+      joined += ",";
+    joined += pipeline;
+  }
+  return joined;
+}
+
+// A benchmarked pipeline, run on the TTIR of a kernel once `prepare` ran on
+// it; `translate` also translates the result to LLVM IR.
+struct Stage {
+  std::string name;
+  std::string prepare;
+  std::string pipeline;
+  bool translate = false;
+};
+
+std::vector<Stage> getStages() {
+  std::string ttgir = join({kOptimizeTTIR, kTTIRToTTGIR});
+  return {
+      {"OptimizeTTIR", "", kOptimizeTTIR},
+      {"TritonToLinalg", kOptimizeTTIR, "triton-to-linalg"},
+      {"TritonToTritonGPU", kOptimizeTTIR, kTTIRToTTGIR},
+      {"Coalesce", ttgir, kCoalesce},
+      {"RemoveLayoutConversions", join({ttgir, kCoalesce}),
+       kRemoveLayoutConversions},
+      {"Pipeline", join({ttgir, kBeforePipeline}), kPipeline},
+      {"TritonGPUToLLVM",
+       join({ttgir, kBeforePipeline, kPipeline, kAfterPipeline}),
+       "convert-triton-gpu-to-llvm{compute-capability=80}"},
+      {"TTIRToLLVMIR", "",
+       join({ttgir, kBeforePipeline, kPipeline, kAfterPipeline}), true},
+  };
+}
+
+const char *kKernels[] = {
+    "kernel-01-vector-add.mlir",
+    "kernel-02-fused-softmax.mlir",
+    "kernel-03-matrix-multiplication.mlir",
+    "kernel-05-layer-norm-fwd.mlir",
+    "kernel-05-layer-norm-dwdb.mlir",
+};
+
+// A kernel summing `numLoads` blocks of 1024 floats in the innermost loop of
+// a nest of `depth` loops, and advancing its pointers in each iteration.
+std::string makeScaledKernel(int numLoads, int depth) {
+  const std::string ptrTy = "tensor<1024x!tt.ptr<f32>>";
+  const std::string valTy = "tensor<1024xf32>";
+  const std::string offTy = "tensor<1024xi32>";
+  std::string src;
+  llvm::raw_string_ostream os(src);
+  os << "tt.func public @scaled_kernel(%in: !tt.ptr<f32> {tt.divisibility = "
+        "16 : i32}, %out: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %n: "
+        "i32) {\n";
+  os << "  %c0 = arith.constant 0 : i32\n";
+  os << "  %c1 = arith.constant 1 : i32\n";
+  os << "  %step = arith.constant dense<1024> : " << offTy << "\n";
+  os << "  %zero = arith.constant dense<0.000000e+00> : " << valTy << "\n";
+  os << "  %range = tt.make_range {end = 1024 : i32, start = 0 : i32} : "
+     << offTy << "\n";
+  os << "  %base = tt.splat %in : (!tt.ptr<f32>) -> " << ptrTy << "\n";
+  os << "  %init = tt.addptr %base, %range : " << ptrTy << ", " << offTy
+     << "\n";
+  std::string acc = "%zero", ptr = "%init";
+  for (int d = 0; d < depth; ++d) {
+    os << "  %loop" << d << ":2 = scf.for %i" << d
+       << " = %c0 to %n step %c1 iter_args(%sum" << d << " = " << acc
+       << ", %ptr" << d << " = " << ptr << ") -> (" << valTy << ", " << ptrTy
+       << ") : i32 {\n";
+    acc = "%sum" + std::to_string(d);
+    ptr = "%ptr" + std::to_string(d);
+  }
+  for (int k = 0; k < numLoads; ++k) {
+    os << "  %off" << k << " = arith.constant dense<" << k * 1024
+       << "> : " << offTy << "\n";
+    os << "  %ptrs" << k << " = tt.addptr " << ptr << ", %off" << k << " : "
+       << ptrTy << ", " << offTy << "\n";
+    os << "  %val" << k << " = tt.load %ptrs" << k
+       << " {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : "
+       << valTy << "\n";
+    os << "  %add" << k << " = arith.addf " << acc << ", %val" << k << " : "
+       << valTy << "\n";
+    acc = "%add" + std::to_string(k);
+  }
+  os << "  %next = tt.addptr " << ptr << ", %step : " << ptrTy << ", "
+     << offTy << "\n";
+  os << "  scf.yield " << acc << ", %next : " << valTy << ", " << ptrTy
+     << "\n";
+  os << "  }\n";
+  for (int d = depth - 1; d > 0; --d)
+    os << "  scf.yield %loop" << d << "#0, %loop" << d << "#1 : " << valTy
+       << ", " << ptrTy << "\n  }\n";
+  os << "  %obase = tt.splat %out : (!tt.ptr<f32>) -> " << ptrTy << "\n";
+  os << "  %optrs = tt.addptr %obase, %range : " << ptrTy << ", " << offTy
+     << "\n";
+  os << "  tt.store %optrs, %loop0#0 {cache = 1 : i32, evict = 1 : i32} : "
+     << valTy << "\n";
+  os << "  tt.return\n}\n";
+  return os.str();
+}
+
+MLIRContext &getContext() {
+  static MLIRContext *context = [] {
+    DialectRegistry registry;
+    registry.insert<triton::TritonDialect, triton::gpu::TritonGPUDialect,
+                    math::MathDialect, arith::ArithDialect, scf::SCFDialect,
+                    cf::ControlFlowDialect, func::FuncDialect,
+                    LLVM::LLVMDialect, gpu::GPUDialect>();
+    // single-threaded, so that timings do not depend on the machine load
+    auto *context =
+        new MLIRContext(registry, MLIRContext::Threading::DISABLED);
+    context->loadAllAvailableDialects();
+    return context;
+  }();
+  return *context;
+}
+
+LogicalResult runPipeline(ModuleOp module, const std::string &pipeline) {
+  if (pipeline.empty())
+    return success();
+  PassManager pm(module->getContext());
+  if (failed(parsePassPipeline(pipeline, pm)))
+    return failure();
+  return pm.run(module);
+}
+
+double getPeakRSSMegabytes() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // kilobytes on Linux
+  return usage.ru_maxrss / 1024.0;
+}
+
+void runStage(benchmark::State &state, const Stage &stage,
+              const std::string &src) {
+  OwningOpRef<ModuleOp> input =
+      parseSourceString<ModuleOp>(src, &getContext());
+  if (!input || failed(runPipeline(*input, stage.prepare))) {
+    state.SkipWithError("failed to prepare the kernel");
+    return;
+  }
+  int64_t numOps = 0;
+  input->walk([&](Operation *) { ++numOps; });
+  for (auto _ : state) {
+    state.PauseTiming();
+    OwningOpRef<ModuleOp> module = input->clone();
+    state.ResumeTiming();
+    if (failed(runPipeline(*module, stage.pipeline))) {
+      state.SkipWithError("pipeline failed");
+      return;
+    }
+    if (stage.translate) {
+      llvm::LLVMContext llvmContext;
+      auto llvmModule = triton::translateTritonGPUToLLVMIR(
+          &llvmContext, *module, /*computeCapability=*/80, /*isROCM=*/false);
+      if (!llvmModule) {
+        state.SkipWithError("translation to LLVM IR failed");
+        return;
+      }
+      benchmark::DoNotOptimize(llvmModule.get());
+    }
+  }
+  state.counters["ops"] = numOps;
+  state.counters["peak_rss_mb"] = getPeakRSSMegabytes();
+}
+
+void registerBenchmarks() {
+  for (const Stage &stage : getStages()) {
+    for (const char *kernel : kKernels) {
+      std::string path = std::string(TRITON_BENCHMARK_KERNELS_DIR) + "/" +
+                         kernel;
+      auto buffer = llvm::MemoryBuffer::getFile(path);
+      if (!buffer) {
+        llvm::errs() << "cannot read " << path << "\n";
+        continue;
+      }
+      std::string src = (*buffer)->getBuffer().str();
+      benchmark::RegisterBenchmark(
+          (stage.name + "/" + kernel).c_str(),
+          [stage, src](benchmark::State &state) {
+            runStage(state, stage, src);
+          })
+          ->Unit(benchmark::kMillisecond);
+    }
+    benchmark::RegisterBenchmark(
+        (stage.name + "/scaled").c_str(),
+        [stage](benchmark::State &state) {
+          runStage(state, stage,
+                   makeScaledKernel(state.range(0), state.range(1)));
+        })
+        ->ArgNames({"loads", "depth"})
+        ->ArgsProduct({{8, 32, 128}, {1, 2, 4}})
+        ->Unit(benchmark::kMillisecond);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  registerTransformsPasses();
+  registerTritonPasses();
+  registerTritonGPUPasses();
+  triton::registerTritonToLinalgPass();
+  triton::registerConvertTritonToTritonGPUPass();
+  triton::registerConvertTritonGPUToLLVMPass();
+  registerBenchmarks();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/LogicalResult.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace mlir {
+namespace triton {
+
+// An input file of a batch and the file its result is written to
+struct BatchJob {
+  std::string input;
+  std::string output;
+};
+
+// Read the jobs of a batch manifest, one `<input> <output>` pair of paths per
+// line. Empty lines and lines starting with '#' are skipped
+inline LogicalResult parseBatchManifest(llvm::StringRef path,
+                                        llvm::SmallVectorImpl<BatchJob> &jobs) {
+  std::string errorMessage;
+  auto manifest = openInputFile(path, &errorMessage);
+  if (!manifest) {
+    llvm::errs() << errorMessage << "\n";
+    return failure();
+  }
+  llvm::SmallVector<llvm::StringRef> lines;
+  manifest->getBuffer().split(lines, '\n');
+  for (size_t lineNo = 0; lineNo < lines.size(); ++lineNo) {
+    llvm::StringRef line = lines[lineNo].trim();
+    if (line.empty() || line.startswith("#"))
+      continue;
+    auto [input, output] = line.split(' ');
+    output = output.trim();
+    if (input.empty() || output.empty() || output.contains(' ')) {
+      llvm::errs() << path << ":" << lineNo + 1
+                   << ": expected '<input> <output>'\n";
+      return failure();
+    }
+    jobs.push_back({input.str(), output.str()});
+  }
+  return success();
+}
+
+// Run process on every job of a batch, on numThreads threads (0 for one per
+// hardware thread), and write its output to the output file of the job. The
+// output files of failed jobs are not kept. Fails if any job does, after
+// running them all
+inline LogicalResult runBatch(
+    llvm::ArrayRef<BatchJob> jobs, unsigned numThreads,
+    llvm::function_ref<LogicalResult(std::unique_ptr<llvm::MemoryBuffer>,
+                                     llvm::raw_ostream &)>
+        process) {
+  std::mutex errorsMutex;
+  std::atomic<unsigned> numFailed = 0;
+  auto reportError = [&](const BatchJob &job, const llvm::Twine &message) {
+    std::lock_guard<std::mutex> lock(errorsMutex);
+    llvm::errs() << job.input << ": " << message << "\n";
+    ++numFailed;
+  };
+
+  llvm::ThreadPool pool(llvm::hardware_concurrency(numThreads));
+  for (const BatchJob &job : jobs)
+    pool.async([&, &job = job]() {
+      std::string errorMessage;
+      auto input = openInputFile(job.input, &errorMessage);
+      if (!input)
+        return reportError(job, errorMessage);
+      auto output = openOutputFile(job.output, &errorMessage);
+      if (!output)
+        return reportError(job, errorMessage);
+      if (failed(process(std::move(input), output->os())))
+        return reportError(job, "failed");
+      output->keep();
+    });
+  pool.wait();
+
+  if (numFailed > 0)
+    llvm::errs() << numFailed << " of " << jobs.size() << " jobs failed\n";
+  return success(numFailed == 0);
+}
+
+} // namespace triton
+} // namespace mlir
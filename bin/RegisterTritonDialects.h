@@ -16,6 +16,7 @@ namespace test {
 void registerTestAliasPass();
 void registerTestAlignmentPass();
 void registerTestAllocationPass();
+void registerTestBankConflictsPass();
 void registerTestMembarPass();
 } // namespace test
 } // namespace mlir
@@ -27,8 +28,14 @@ inline void registerTritonDialects(mlir::DialectRegistry &registry) {
   mlir::test::registerTestAliasPass();
   mlir::test::registerTestAlignmentPass();
   mlir::test::registerTestAllocationPass();
+  mlir::test::registerTestBankConflictsPass();
   mlir::test::registerTestMembarPass();
   mlir::triton::registerTritonToLinalgPass();
+  mlir::triton::registerTritonLinalgGridLauncherPass();
+  mlir::triton::registerTritonLinalgPrefetchPass();
+  mlir::triton::registerTritonLinalgFuseElementwisePass();
+  mlir::triton::registerTritonLinalgTileMatmulPass();
+  mlir::triton::registerTritonLinalgSplitKPass();
   mlir::triton::registerConvertTritonToTritonGPUPass();
   mlir::triton::registerConvertTritonGPUToLLVMPass();
 
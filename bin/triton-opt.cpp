@@ -1,11 +1,46 @@
+#include "./BatchMode.h"
 #include "./RegisterTritonDialects.h"
 
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
+#include "llvm/Support/InitLLVM.h"
+
+static llvm::cl::opt<std::string> batchManifest(
+    "batch",
+    llvm::cl::desc("Run the pipeline on every <input> <output> pair of files "
+                   "listed in the manifest, instead of on the input file"),
+    llvm::cl::value_desc("manifest"), llvm::cl::init(""));
+
+static llvm::cl::opt<unsigned> batchThreads(
+    "batch-threads",
+    llvm::cl::desc("Number of files of the batch processed in parallel, 0 "
+                   "for one per hardware thread"),
+    llvm::cl::init(0));
 
 int main(int argc, char **argv) {
   mlir::DialectRegistry registry;
   registerTritonDialects(registry);
 
-  return mlir::asMainReturnCode(mlir::MlirOptMain(
-      argc, argv, "Triton (GPU) optimizer driver\n", registry));
+  auto [inputFilename, outputFilename] = mlir::registerAndParseCLIOptions(
+      argc, argv, "Triton (GPU) optimizer driver\n", registry);
+  if (batchManifest.empty())
+    return mlir::asMainReturnCode(mlir::MlirOptMain(
+        argc, argv, inputFilename, outputFilename, registry));
+
+  // The passes, dialects and options are registered once for all the files,
+  // each of which is processed in a context of its own. The files are
+  // processed in parallel, so the contexts do not spawn threads of their own
+  llvm::InitLLVM y(argc, argv);
+  auto &options = llvm::cl::getRegisteredOptions();
+  if (auto *disableThreading = static_cast<llvm::cl::opt<bool> *>(
+          options.lookup("mlir-disable-threading")))
+    disableThreading->setValue(true);
+  llvm::SmallVector<mlir::triton::BatchJob> jobs;
+  if (mlir::failed(mlir::triton::parseBatchManifest(batchManifest, jobs)))
+    return EXIT_FAILURE;
+  auto config = mlir::MlirOptMainConfig::createFromCLOptions();
+  return mlir::asMainReturnCode(mlir::triton::runBatch(
+      jobs, batchThreads,
+      [&](std::unique_ptr<llvm::MemoryBuffer> input, llvm::raw_ostream &os) {
+        return mlir::MlirOptMain(os, std::move(input), registry, config);
+      }));
 }
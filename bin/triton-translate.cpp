@@ -1,3 +1,5 @@
+#include "./BatchMode.h"
+
 #include "mlir/ExecutionEngine/ExecutionEngine.h"
 #include "mlir/ExecutionEngine/OptUtils.h"
 #include "mlir/IR/AsmState.h"
@@ -26,46 +28,55 @@
 namespace mlir {
 namespace triton {
 
-OwningOpRef<ModuleOp> loadMLIRModule(llvm::StringRef inputFilename,
-                                     MLIRContext &context) {
-  std::string errorMessage;
-  auto input = openInputFile(inputFilename, &errorMessage);
-  if (!input) {
-    llvm::errs() << errorMessage << "\n";
-    return nullptr;
-  }
-
+void initContext(MLIRContext &context) {
   mlir::DialectRegistry registry;
   registry
       .insert<TritonDialect, triton::gpu::TritonGPUDialect,
               mlir::math::MathDialect, arith::ArithDialect, scf::SCFDialect>();
 
   context.appendDialectRegistry(registry);
+  context.loadAllAvailableDialects();
+  context.allowUnregisteredDialects();
+}
 
-  auto processBuffer = [&](std::unique_ptr<llvm::MemoryBuffer> ownedBuffer)
-      -> OwningOpRef<ModuleOp> {
-    llvm::SourceMgr sourceMgr;
-    sourceMgr.AddNewSourceBuffer(std::move(ownedBuffer), SMLoc());
+OwningOpRef<ModuleOp>
+parseMLIRModule(std::unique_ptr<llvm::MemoryBuffer> ownedBuffer,
+                MLIRContext &context) {
+  llvm::SourceMgr sourceMgr;
+  sourceMgr.AddNewSourceBuffer(std::move(ownedBuffer), SMLoc());
 
-    context.loadAllAvailableDialects();
-    context.allowUnregisteredDialects();
+  OwningOpRef<ModuleOp> module = parseSourceFile<ModuleOp>(sourceMgr, &context);
+  if (!module) {
+    llvm::errs() << "Parse MLIR file failed.";
+    return nullptr;
+  }
 
-    OwningOpRef<ModuleOp> module =
-        parseSourceFile<ModuleOp>(sourceMgr, &context);
-    if (!module) {
-      llvm::errs() << "Parse MLIR file failed.";
-      return nullptr;
-    }
+  return module;
+}
 
-    return module;
-  };
+// The passes of the translation load their dialects in the context of the
+// module they run on, so that contexts are not shared between threads. Each
+// thread of a batch reuses its context for all the files it translates
+MLIRContext &getThreadContext() {
+  thread_local std::unique_ptr<MLIRContext> context;
+  if (!context) {
+    context = std::make_unique<MLIRContext>(MLIRContext::Threading::DISABLED);
+    initContext(*context);
+  }
+  return *context;
+}
 
-  auto module = processBuffer(std::move(input));
-  if (!module) {
+OwningOpRef<ModuleOp> loadMLIRModule(llvm::StringRef inputFilename,
+                                     MLIRContext &context) {
+  std::string errorMessage;
+  auto input = openInputFile(inputFilename, &errorMessage);
+  if (!input) {
+    llvm::errs() << errorMessage << "\n";
     return nullptr;
   }
 
-  return module;
+  initContext(context);
+  return parseMLIRModule(std::move(input), context);
 }
 
 LogicalResult tritonTranslateMain(int argc, char **argv,
@@ -101,12 +112,69 @@ LogicalResult tritonTranslateMain(int argc, char **argv,
       "", llvm::cl::desc("AMDGCN features. e.g. '+sramecc,-xnack'"),
       llvm::cl::value_desc("features"), llvm::cl::init("+sramecc,-xnack"));
 
+  static llvm::cl::opt<std::string> batchManifest(
+      "batch",
+      llvm::cl::desc("Translate every <input> <output> pair of files listed "
+                     "in the manifest, instead of the input file"),
+      llvm::cl::value_desc("manifest"), llvm::cl::init(""));
+
+  static llvm::cl::opt<unsigned> batchThreads(
+      "batch-threads",
+      llvm::cl::desc("Number of files of the batch translated in parallel, 0 "
+                     "for one per hardware thread"),
+      llvm::cl::init(0));
+
   llvm::InitLLVM y(argc, argv);
 
   registerAsmPrinterCLOptions();
   registerMLIRContextCLOptions();
   llvm::cl::ParseCommandLineOptions(argc, argv, toolName);
 
+  // Each module is translated in an LLVM context of its own, as they are not
+  // thread-safe
+  auto translate = [&](ModuleOp module, llvm::raw_ostream &os) {
+    llvm::LLVMContext llvmContext;
+    auto llvmir = translateTritonGPUToLLVMIR(
+        &llvmContext, module, SMArch.getValue(), false /*isRocm*/);
+    if (!llvmir) {
+      llvm::errs() << "Translate to LLVM IR failed";
+      return failure();
+    }
+
+    if (targetKind == "llvmir")
+      os << *llvmir << '\n';
+    else if (targetKind == "ptx")
+      os << ::triton::translateLLVMIRToPTX(*llvmir, SMArch.getValue(),
+                                           ptxVersion.getValue());
+    else if (targetKind == "hsaco") {
+      auto [hsacoModule, hsaco] = ::triton::translateLLVMIRToHSACO(
+          *llvmir, GCNArch.getValue(), GCNTriple.getValue(),
+          GCNFeatures.getValue());
+      os << hsaco;
+    } else {
+      llvm::errs() << "Error: Unknown target specified: " << targetKind << "\n";
+      return failure();
+    }
+    return success();
+  };
+
+  // The files of a batch share the initialization of the targets, and the
+  // contexts and target machines of the threads they are translated on
+  if (!batchManifest.empty()) {
+    SmallVector<BatchJob> jobs;
+    if (failed(parseBatchManifest(batchManifest, jobs)))
+      return failure();
+    return runBatch(jobs, batchThreads,
+                    [&](std::unique_ptr<llvm::MemoryBuffer> input,
+                        llvm::raw_ostream &os) -> LogicalResult {
+                      auto module =
+                          parseMLIRModule(std::move(input), getThreadContext());
+                      if (!module)
+                        return failure();
+                      return translate(*module, os);
+                    });
+  }
+
   mlir::MLIRContext context;
   auto module = loadMLIRModule(inputFilename, context);
   if (!module) {
@@ -120,28 +188,9 @@ LogicalResult tritonTranslateMain(int argc, char **argv,
     return failure();
   }
 
-  llvm::LLVMContext llvmContext;
-  auto llvmir = translateTritonGPUToLLVMIR(&llvmContext, *module,
-                                           SMArch.getValue(), false /*isRocm*/);
-  if (!llvmir) {
-    llvm::errs() << "Translate to LLVM IR failed";
-  }
-
-  if (targetKind == "llvmir")
-    llvm::outs() << *llvmir << '\n';
-  else if (targetKind == "ptx")
-    llvm::outs() << ::triton::translateLLVMIRToPTX(*llvmir, SMArch.getValue(),
-                                                   ptxVersion.getValue());
-  else if (targetKind == "hsaco") {
-    auto [module, hsaco] = ::triton::translateLLVMIRToHSACO(
-        *llvmir, GCNArch.getValue(), GCNTriple.getValue(),
-        GCNFeatures.getValue());
-    llvm::outs() << hsaco;
-  } else {
-    llvm::errs() << "Error: Unknown target specified: " << targetKind << "\n";
+  if (failed(translate(*module, output->os())))
     return failure();
-  }
-
+  output->keep();
   return success();
 }
 
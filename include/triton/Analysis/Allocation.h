@@ -16,9 +16,12 @@ namespace mlir {
 namespace triton {
 class AllocationAnalysis;
 
+/// Returns the shape of the scratch buffer of `op`, with its rows padded or,
+/// if `swizzle` is set, swizzled as the shared layout it is set to.
 SmallVector<unsigned>
 getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
-                             unsigned &outVec);
+                             unsigned &outVec,
+                             triton::gpu::SharedEncodingAttr *swizzle = nullptr);
 
 } // namespace triton
 
@@ -49,6 +52,16 @@ private:
   T End = std::numeric_limits<T>::max();
 };
 
+/// Strategies to assign the offsets of the shared memory buffers.
+enum class AllocationPolicy {
+  /// Triple-based first fit followed by graph coloring of the overlaps.
+  FirstFit,
+  /// Greedy interval packing: each buffer goes into the smallest gap left by
+  /// the buffers live at the same time, for several orders of the buffers,
+  /// keeping the order with the lowest peak.
+  BestFit,
+};
+
 class Allocation {
 public:
   /// A unique identifier for shared memory buffers
@@ -60,7 +73,11 @@ public:
 
   /// Creates a new Allocation analysis that computes the shared memory
   /// information for all associated shared memory values.
-  Allocation(Operation *operation) : operation(operation) { run(); }
+  Allocation(Operation *operation,
+             AllocationPolicy policy = AllocationPolicy::FirstFit)
+      : operation(operation), policy(policy) {
+    run();
+  }
 
   /// Returns the operation this analysis was constructed from.
   Operation *getOperation() const { return operation; }
@@ -112,6 +129,29 @@ public:
   /// Returns the size of total shared memory allocated
   size_t getSharedMemorySize() const { return sharedMemorySize; }
 
+  /// Returns the largest number of bytes live at the same time, which is a
+  /// lower bound of the size of total shared memory.
+  size_t getMaxLiveSize() const { return maxLiveSize; }
+
+  /// Returns the bytes that are allocated but never live at the peak.
+  size_t getFragmentation() const { return sharedMemorySize - maxLiveSize; }
+
+  /// A summary of a shared memory buffer, e.g. to report the usage.
+  struct BufferInfo {
+    BufferId id;
+    /// The operation defining an explicit buffer, or the operation using a
+    /// scratch buffer
+    Operation *owner;
+    bool isScratch;
+    size_t offset;
+    size_t size;
+    /// The ids of the operations the buffer is live across
+    Interval<size_t> liveness;
+  };
+
+  /// Returns the information of all the buffers, sorted by buffer id.
+  SmallVector<BufferInfo> getBufferInfos() const;
+
   bool isIntersected(BufferId lhsId, BufferId rhsId) const {
     if (lhsId == InvalidBufferId || rhsId == InvalidBufferId)
       return false;
@@ -132,6 +172,9 @@ private:
     BufferId id;
     size_t size;
     size_t offset;
+    /// The offset is a multiple of it
+    size_t alignment = 1;
+    Interval<size_t> liveness;
 
     bool operator==(const BufferT &other) const { return id == other.id; }
     bool operator<(const BufferT &other) const { return id < other.id; }
@@ -179,17 +222,24 @@ private:
 
 private:
   Operation *operation;
+  AllocationPolicy policy;
   OpScratchMapT opScratch;
   ValueBufferMapT valueBuffer;
   AliasBufferMapT aliasBuffer;
   BufferSetT bufferSet;
   size_t sharedMemorySize = 0;
+  size_t maxLiveSize = 0;
 
   friend class triton::AllocationAnalysis;
 };
 
 template <typename T> Interval(T, T) -> Interval<T>;
 
+/// Returns the buffers of `allocation` as an array of dictionaries with the
+/// owning op and its location, the kind, the offset, the size and the
+/// liveness interval of each buffer.
+ArrayAttr getSharedMemoryBufferReport(const Allocation &allocation);
+
 } // namespace mlir
 
 #endif // TRITON_ANALYSIS_ALLOCATION_H
@@ -282,6 +282,13 @@ private:
         lattice->join(AxisInfo::getPessimisticValueState(lattice->getPoint())));
   }
 
+  /// Derives the induction variable of scf.for from the lattices of its lower
+  /// bound and step.
+  void visitNonControlFlowArguments(
+      Operation *op, const RegionSuccessor &successor,
+      ArrayRef<dataflow::Lattice<AxisInfo> *> argLattices,
+      unsigned firstIndex) override;
+
 public:
   AxisInfoAnalysis(DataFlowSolver &solver);
   using dataflow::SparseDataFlowAnalysis<
@@ -0,0 +1,53 @@
+#ifndef TRITON_ANALYSIS_BANKCONFLICTS_H
+#define TRITON_ANALYSIS_BANKCONFLICTS_H
+
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+
+namespace mlir {
+
+/// Shared memory is split in 32 banks of 4 bytes, and a warp request that
+/// hits the same bank at distinct addresses is replayed once per address.
+/// The functions below simulate the addresses the lanes of a warp access
+/// when lowered to LLVM and return the worst-case number of replays, i.e.:
+///   1 -- conflict-free;
+///   n -- some bank is accessed at n distinct addresses by one request;
+///   0 -- the access pattern is not modeled.
+
+/// Returns the bank conflict degree of the stores (or loads) between a
+/// tensor of `shape` and `elemTy` in `distributedLayout` and shared memory
+/// in `sharedLayout`. Blocked layouts are modeled with the access widths of
+/// storeDistributedToShared, and MMAv2 dot operands with the 16-byte lines
+/// loaded by ldmatrix.
+unsigned getBankConflictDegree(Attribute distributedLayout,
+                               triton::gpu::SharedEncodingAttr sharedLayout,
+                               ArrayRef<int64_t> shape, Type elemTy);
+
+/// Returns the bank conflict degree of the shared memory accesses of
+/// convert_layout and insert_slice_async, or 0 for other operations.
+unsigned getBankConflictDegree(Operation *op);
+
+/// Returns the swizzled shared layout with the least conflicts for
+/// accessing a tensor of `shape` and `elemTy` in `distributedLayout`, with
+/// the order of `order`. The unswizzled layout is kept when it is
+/// conflict-free, otherwise the swizzle with the fewest replays summed over
+/// all requests is returned.
+triton::gpu::SharedEncodingAttr
+getConflictFreeSharedEncoding(Attribute distributedLayout,
+                              ArrayRef<int64_t> shape,
+                              ArrayRef<unsigned> order, Type elemTy);
+
+/// Returns the swizzled layout of the scratch buffer of `repShape` and
+/// `order` through which a convert_layout between `srcLayout` and
+/// `dstLayout` stores `inVec` and loads `outVec` elements at a time, with the
+/// fewest wavefronts summed over both, or a null attribute if padding its
+/// rows by `pad` elements has as few.
+triton::gpu::SharedEncodingAttr
+getScratchSwizzle(triton::gpu::BlockedEncodingAttr srcLayout,
+                  triton::gpu::BlockedEncodingAttr dstLayout,
+                  ArrayRef<unsigned> repShape, ArrayRef<unsigned> order,
+                  unsigned inVec, unsigned outVec, unsigned pad,
+                  unsigned elemBytes);
+
+} // namespace mlir
+
+#endif // TRITON_ANALYSIS_BANKCONFLICTS_H
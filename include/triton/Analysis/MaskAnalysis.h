@@ -20,29 +20,42 @@ class ConversionPatternRewriter;
 namespace triton {
 // Data structure used to decode the pattern in a mask used for load and store.
 // start and end field represent the start and end index of a range (produced
-// by make_range, addi, etc.). While multi-dimensional data is possible, we
-// assume range comparison can only be done on 1 dimension at a time (and
+// by make_range, addi, etc.), which varies along dimension rangeDim. Tiles may
+// have any rank, but a range comparison is done on 1 dimension at a time (and
 // results of range comparions across dimensions can be combined), hence start
 // and end are not vectors. dims represents the real access size for ld/st
-// (instead of the tensor/memref size specified by the IR). scalar is a shortcut
-// used when the entire state contains a single scalar value.
+// (instead of the tensor/memref size specified by the IR), and offsets the
+// index of the first accessed element in each dimension, which is non-zero
+// only for masks with a lower bound. scalar is a shortcut used when the entire
+// state contains a single scalar value.
 //
 // The general lifetime of this data structure is roughly:
 // 1. A range is created by make_range and optionally operated on by addi w/
-// result of splat, expand_dims, etc. During this phase, either (1) both start
-// and end are populated, or (2) scalar is populated. Only one of the dimensions
-// (that contains the range) can have dim > 1.
+// result of splat, expand_dims, broadcast, etc. During this phase, either (1)
+// both start and end are populated, or (2) scalar is populated.
 // 2. Result from step 1 is compared with a another MaskState that represents a
-// scalar value. The resulting state only has dims populated.
+// scalar value, either as an upper bound (<, <=) or as a lower bound (>=, >).
+// The resulting state only has dims and offsets populated, and only dimension
+// rangeDim is masked. A splat of a scalar condition masks all or nothing.
 // 3. Optionally, result from step 2 can be broadcasted and anded with other
-// results from step 2. The resulting state only has dims populated.
+// results from step 2, which intersects them dimension by dimension. The
+// resulting state only has dims and offsets populated.
 //
 // Example of creating 2D mask:
 //  mask = (rows[:, None] < M) & (cols[None, :] < N)
+// Example of a two-sided mask on a single dimension:
+//  mask = (cols >= lo) & (cols < hi)
+// Example of a 4-D mask of attention blocks, whose batch and head ranges of
+// size 1 are broadcast after their comparison:
+//  mask = ((b + arange(0, 1))[:, None, None, None] < B) &
+//         ((h + arange(0, 1))[None, :, None, None] < H) &
+//         (seq[None, None, :, None] < S) & (dim[None, None, None, :] < D)
 struct MaskState {
   OpFoldResult start;
   OpFoldResult end;
+  int64_t rangeDim = -1;
   SmallVector<OpFoldResult> dims;
+  SmallVector<OpFoldResult> offsets;
   OpFoldResult scalar;
 
   int64_t getRank() const { return dims.size(); }
@@ -74,6 +87,12 @@ private:
   LogicalResult addStates(const MaskState &lhsState, const MaskState &rhsState,
                           Location loc, ConversionPatternRewriter &rewriter);
 
+  LogicalResult subStates(const MaskState &lhsState, const MaskState &rhsState,
+                          Location loc, ConversionPatternRewriter &rewriter);
+
+  LogicalResult mulStates(const MaskState &lhsState, const MaskState &rhsState,
+                          Location loc, ConversionPatternRewriter &rewriter);
+
   LogicalResult minStates(const MaskState &lhsState, const MaskState &rhsState,
                           Location loc, ConversionPatternRewriter &rewriter);
   // -------
@@ -85,7 +104,8 @@ private:
   LogicalResult parseConstant(arith::ConstantOp constOp, const Location loc,
                               ConversionPatternRewriter &rewriter);
 
-  // Operand is an integer scalar
+  // Operand is an integer or index scalar, e.g. a bound computed from the
+  // induction variable or an iter arg of an enclosing scf.for.
   LogicalResult parseIntScalar(Value scalar, const Location loc,
                                ConversionPatternRewriter &rewriter);
 
@@ -94,16 +114,28 @@ private:
   // and end, dims remains unchanged, and scalar is empty.
   LogicalResult parseAdd(arith::AddIOp addOp, const Location loc,
                          ConversionPatternRewriter &rewriter);
+  // Operand is the result of subi
+  // Either both operands are scalars, or the rhs is a scalar subtracted from
+  // a range.
+  LogicalResult parseSub(arith::SubIOp subOp, const Location loc,
+                         ConversionPatternRewriter &rewriter);
+
+  // Operand is the result of muli
+  // Both operands must be scalars.
+  LogicalResult parseMul(arith::MulIOp mulOp, const Location loc,
+                         ConversionPatternRewriter &rewriter);
+
   // Operand is the result of andi
-  // Each of the result state dims is smaller of the two operands' dims.
-  // Insert instruction if needed to get new dims.
+  // The result state is the intersection of the two operands in each
+  // dimension. Insert instruction if needed to get new offsets and dims.
   LogicalResult parseAnd(arith::AndIOp andOp, const Location loc,
                          ConversionPatternRewriter &rewriter);
 
   // Operand is the result of cmpi
-  // Assume only of the dimensions have size > 1. Only support slt for now.
-  // For that dimension, calculate this new dim as: dim = min(end, value) -
-  // start
+  // One side is a range, the other a scalar bound. For the dimension rangeDim
+  // of the range, an upper bound gives dim = min(end, bound) - start, and a
+  // lower bound gives offset = max(start, bound) - start and
+  // dim = end - max(start, bound).
   LogicalResult parseCmp(arith::CmpIOp cmpOp, const Location loc,
                          ConversionPatternRewriter &rewriter);
   // Operand is the result of make_range
@@ -111,18 +143,21 @@ private:
   LogicalResult parseMakeRange(triton::MakeRangeOp rangeOp, const Location loc,
                                ConversionPatternRewriter &rewriter);
   // Operand is the result of broadcast
-  // Change dims only; assume only applies to tensors.
+  // Change dims only; assume only applies to tensors. A masked dimension of
+  // size 1 keeps all or none of its elements once broadcast, and a range cannot
+  // be broadcast along its own dimension.
   LogicalResult parseBroadcast(triton::BroadcastOp broadcastOp,
                                const Location loc,
                                ConversionPatternRewriter &rewriter);
   // Operand is the result of splat
   // Assume only applies to scalar. start and end are left empty; scalar will
-  // be assigned, and dims will be updated.
+  // be assigned, and dims will be updated. The splat of an i1 condition is a
+  // mask of the whole tile or of nothing, selected at runtime.
   LogicalResult parseSplat(triton::SplatOp splatOp, const Location loc,
                            ConversionPatternRewriter &rewriter);
   // Operand is the result of expand_dims
-  // Insert additional dims; start and end do not change and correspond to the
-  // dimension that contains the range.
+  // Insert additional dims; start and end do not change and rangeDim moves
+  // with the dimension that contains the range.
   LogicalResult parseExpandDims(triton::ExpandDimsOp expandDimsOp,
                                 const Location loc,
                                 ConversionPatternRewriter &rewriter);
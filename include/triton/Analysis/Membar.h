@@ -2,7 +2,13 @@
 #define TRITON_ANALYSIS_MEMBAR_H
 
 #include "Allocation.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <tuple>
 
 namespace mlir {
 
@@ -26,21 +32,63 @@ public:
   /// a shared memory read. If the temporary storage is written but not read,
   /// it is considered as the problem of the operation itself but not the membar
   /// analysis.
-  /// The following circumstances are not considered yet:
-  /// - Double buffers
-  /// - N buffers
+  /// Double and N buffers are tracked per slot: insert_slice_async writes
+  /// and the reads through extract_slice only touch one slice along axis 0,
+  /// and accesses to two slots that provably differ, e.g. the insert and the
+  /// extract indices of a pipelined loop, do not require a barrier.
+  /// Slices with static offsets and sizes, e.g. the k-slices of the dot
+  /// operands read by the prefetch pass, are tracked by their ranges too,
+  /// and accesses to disjoint ranges do not require a barrier either.
+  /// Adjacent barriers are folded into one.
   MembarAnalysis(Allocation *allocation) : allocation(allocation) {}
 
   /// Runs the membar analysis to the given operation, inserts a barrier if
   /// necessary.
   void run();
 
+  /// Returns the number of barriers that have been saved, either because the
+  /// accesses were to disjoint slots of the same buffer or because they were
+  /// folded into an adjacent barrier.
+  unsigned getNumRemovedBarriers() const { return numRemovedBarriers; }
+
 private:
+  /// A slot along axis 0 of a buffer, i.e. (base + offset) mod numSlots.
+  /// A null base denotes a constant slot. A buffer without slots is a single
+  /// constant slot of itself.
+  /// The ranges [lower, upper) of the elements accessed in the slot along
+  /// each of its dimensions are empty if they are unknown.
+  struct Slot {
+    Value base;
+    int64_t offset = 0;
+    int64_t numSlots = 1;
+    SmallVector<int64_t> lower;
+    SmallVector<int64_t> upper;
+
+    bool operator<(const Slot &other) const {
+      return std::make_tuple(base.getAsOpaquePointer(), offset, numSlots,
+                             lower, upper) <
+             std::make_tuple(other.base.getAsOpaquePointer(), other.offset,
+                             other.numSlots, other.lower, other.upper);
+    }
+
+    bool operator==(const Slot &other) const {
+      return base == other.base && offset == other.offset &&
+             numSlots == other.numSlots && lower == other.lower &&
+             upper == other.upper;
+    }
+  };
+
+  using DisjointFn = std::function<bool(const Slot &, const Slot &)>;
+
   struct BlockInfo {
     using BufferIdSetT = Allocation::BufferIdSetT;
+    using SlotMapT = std::map<Allocation::BufferId, std::set<Slot>>;
 
     BufferIdSetT syncReadBuffers;
     BufferIdSetT syncWriteBuffers;
+    /// Accesses that only touch a single slot of a buffer
+    SlotMapT syncReadSlots;
+    SlotMapT syncWriteSlots;
 
     BlockInfo() = default;
     BlockInfo(const BufferIdSetT &syncReadBuffers,
@@ -54,31 +102,45 @@ private:
                              other.syncReadBuffers.end());
       syncWriteBuffers.insert(other.syncWriteBuffers.begin(),
                               other.syncWriteBuffers.end());
+      for (auto &[bufferId, slots] : other.syncReadSlots)
+        syncReadSlots[bufferId].insert(slots.begin(), slots.end());
+      for (auto &[bufferId, slots] : other.syncWriteSlots)
+        syncWriteSlots[bufferId].insert(slots.begin(), slots.end());
       return *this;
     }
 
     /// Returns true if buffers in two BlockInfo objects are intersected.
-    bool isIntersected(const BlockInfo &other, Allocation *allocation) const {
-      return /*RAW*/ isIntersected(syncWriteBuffers, other.syncReadBuffers,
-                                   allocation) ||
+    /// Two slots of the same buffer are intersected unless `isDisjoint`
+    /// proves otherwise.
+    bool isIntersected(const BlockInfo &other, Allocation *allocation,
+                       const DisjointFn &isDisjoint) const {
+      return /*RAW*/ isIntersected(syncWriteBuffers, syncWriteSlots,
+                                   other.syncReadBuffers, other.syncReadSlots,
+                                   allocation, isDisjoint) ||
              /*WAR*/
-             isIntersected(syncReadBuffers, other.syncWriteBuffers,
-                           allocation) ||
+             isIntersected(syncReadBuffers, syncReadSlots,
+                           other.syncWriteBuffers, other.syncWriteSlots,
+                           allocation, isDisjoint) ||
              /*WAW*/
-             isIntersected(syncWriteBuffers, other.syncWriteBuffers,
-                           allocation);
+             isIntersected(syncWriteBuffers, syncWriteSlots,
+                           other.syncWriteBuffers, other.syncWriteSlots,
+                           allocation, isDisjoint);
     }
 
     /// Clears the buffers because a barrier is inserted.
     void sync() {
       syncReadBuffers.clear();
       syncWriteBuffers.clear();
+      syncReadSlots.clear();
+      syncWriteSlots.clear();
     }
 
     /// Compares two BlockInfo objects.
     bool operator==(const BlockInfo &other) const {
       return syncReadBuffers == other.syncReadBuffers &&
-             syncWriteBuffers == other.syncWriteBuffers;
+             syncWriteBuffers == other.syncWriteBuffers &&
+             syncReadSlots == other.syncReadSlots &&
+             syncWriteSlots == other.syncWriteSlots;
     }
 
     bool operator!=(const BlockInfo &other) const { return !(*this == other); }
@@ -93,6 +155,40 @@ private:
         });
       });
     }
+
+    /// Returns true if a buffer in two sets is intersected. A slot
+    /// intersects any whole buffer that it intersects.
+    bool isIntersected(const BufferIdSetT &lhs, const SlotMapT &lhsSlots,
+                       const BufferIdSetT &rhs, const SlotMapT &rhsSlots,
+                       Allocation *allocation,
+                       const DisjointFn &isDisjoint) const {
+      if (isIntersected(lhs, rhs, allocation))
+        return true;
+      auto intersectsSlot = [&](const BufferIdSetT &buffers,
+                                const SlotMapT &slots) {
+        return std::any_of(slots.begin(), slots.end(), [&](auto &entry) {
+          return std::any_of(buffers.begin(), buffers.end(), [&](auto id) {
+            return allocation->isIntersected(id, entry.first);
+          });
+        });
+      };
+      if (intersectsSlot(lhs, rhsSlots) || intersectsSlot(rhs, lhsSlots))
+        return true;
+      for (auto &[lhsId, lhsSet] : lhsSlots) {
+        for (auto &[rhsId, rhsSet] : rhsSlots) {
+          if (lhsId != rhsId) {
+            if (allocation->isIntersected(lhsId, rhsId))
+              return true;
+            continue;
+          }
+          for (auto &lhsSlot : lhsSet)
+            for (auto &rhsSlot : rhsSet)
+              if (!isDisjoint(lhsSlot, rhsSlot))
+                return true;
+        }
+      }
+      return false;
+    }
   };
 
   /// Applies the barrier analysis based on the SCF dialect, in which each
@@ -117,10 +213,43 @@ private:
   /// Collects the successors of the terminator
   void visitTerminator(Operation *operation, SmallVector<Block *> &successors);
 
+  /// Returns the BlockInfo of `block` as seen by its successor through the
+  /// `successorIndex`-th edge. Slots whose base is redefined by the
+  /// successor are rewritten in terms of its arguments, or widened to the
+  /// whole buffer if that is not possible.
+  BlockInfo translate(const BlockInfo &blockInfo, Block *block,
+                      unsigned successorIndex);
+
+  /// Returns the slot of the buffer accessed through `value`, if `value` is
+  /// known to cover a single slice along axis 0 only.
+  std::optional<Slot> getSlot(Value value, unsigned depth = 0);
+
+  /// Returns the slot selected by `index` in a buffer of `numSlots` slots.
+  std::optional<Slot> getSlotOfIndex(OpFoldResult index, int64_t numSlots);
+
+  /// Returns the slot of the slice of `source` of type `sliceType` at
+  /// `offsets`, which is read by extract_slice or written by insert_slice.
+  std::optional<Slot> getSlotOfSlice(Value source, RankedTensorType sliceType,
+                                     ArrayRef<OpFoldResult> offsets,
+                                     ArrayRef<OpFoldResult> sizes,
+                                     ArrayRef<OpFoldResult> strides,
+                                     unsigned depth = 0);
+
+  /// Returns the slot a block argument holds on every incoming edge,
+  /// expressed in terms of another argument of the same block.
+  std::optional<Slot> getBlockArgSlot(BlockArgument arg, unsigned depth);
+
+  /// Returns true if the two slots can never be the same.
+  bool isDisjoint(const Slot &lhs, const Slot &rhs);
+
 private:
   Allocation *allocation;
   DenseMap<Block *, BlockInfo> inputBlockInfoMap;
   DenseMap<Block *, BlockInfo> outputBlockInfoMap;
+  /// Operations a barrier would have been inserted before without the slot
+  /// reasoning
+  llvm::SetVector<Operation *> elidedBarrierOps;
+  unsigned numRemovedBarriers = 0;
 };
 
 } // namespace mlir
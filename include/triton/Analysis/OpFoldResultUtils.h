@@ -43,6 +43,27 @@ OpFoldResult mulOFRValue(const OpFoldResult lhs, const Value rhs,
 OpFoldResult minOFRs(const OpFoldResult lhs, const OpFoldResult rhs,
                      const Location loc, ConversionPatternRewriter &rewriter);
 
+OpFoldResult maxOFRs(const OpFoldResult lhs, const OpFoldResult rhs,
+                     const Location loc, ConversionPatternRewriter &rewriter);
+
+// Produce result = lhs % rhs (signed). If both OFRs are Integer Attributes,
+// result is an Integer Attribute. Otherwise, insert the arith.remsi
+// instruction and use its result Value.
+OpFoldResult remOFRs(const OpFoldResult lhs, const OpFoldResult rhs,
+                     const Location loc, ConversionPatternRewriter &rewriter);
+
+// Produce result = ceildiv(lhs, rhs) (signed). If both OFRs are Integer
+// Attributes, result is an Integer Attribute. Otherwise, insert the
+// arith.ceildivsi instruction and use its result Value.
+OpFoldResult ceilDivOFRs(const OpFoldResult lhs, const OpFoldResult rhs,
+                         const Location loc,
+                         ConversionPatternRewriter &rewriter);
+
+// Return ofr as an index Value, materializing a constant if it is an Integer
+// Attribute.
+Value ofrToIndexValue(const OpFoldResult ofr, const Location loc,
+                      ConversionPatternRewriter &rewriter);
+
 } // namespace mlir
 
 #endif
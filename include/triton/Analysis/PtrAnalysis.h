@@ -13,6 +13,9 @@
 
 #include "triton/Dialect/Triton/IR/Dialect.h"
 
+#include "llvm/ADT/DenseMap.h"
+
+#include <optional>
 #include <set>
 
 namespace mlir {
@@ -26,17 +29,48 @@ namespace triton {
 // in a linearly laid-out memory, which is the same as pointer arithmetic
 // operations in Triton language. scalar is a shortcut used when the entire
 // state describes a single scalar value. source is the base pointer.
+//
+// Pointers computed from a loaded index tensor (e.g. embedding lookups) are
+// only irregular along one dimension. For those, gatherIndices is the 1-D
+// index tensor and element i along gatherDim is additionally offset by
+// gatherIndices[i] * gatherScale; all the other dimensions remain described by
+// offsets, sizes, and strides.
+//
+// Offsets taken modulo a bound, as in (start + arange) % M, wrap around along
+// one dimension. Element i along wrapDim is at the regular offset while
+// wrapStart + i * strides[wrapDim] < wrapBound, and k * wrapBound elements
+// before it once it has wrapped around k times.
+//
+// Block pointers (tt.make_tensor_ptr) keep offsets[i] = index_i * strides[i]
+// per dimension, where index_i is the position of the block in dimension i of
+// its parent tensor. shape holds the extents of the parent tensor and
+// baseOffset the offset of its first element, both used to lower boundary
+// checks.
 struct PtrState {
   SmallVector<OpFoldResult> offsets;
   SmallVector<OpFoldResult> sizes;
   SmallVector<OpFoldResult> strides;
   Value source;
   Value scalar;
+  Value gatherIndices;
+  int64_t gatherDim = -1;
+  OpFoldResult gatherScale;
+  int64_t wrapDim = -1;
+  OpFoldResult wrapStart;
+  OpFoldResult wrapBound;
+  SmallVector<OpFoldResult> shape;
+  OpFoldResult baseOffset;
 
   int64_t getRank() const;
 
   bool isEmpty() const;
 
+  bool isGather() const { return gatherIndices != nullptr; }
+
+  bool isWrapped() const { return wrapDim >= 0; }
+
+  bool isBlockPtr() const { return !shape.empty(); }
+
   // Process addition of two PtrStates.
   void addState(const PtrState &lhsState, const PtrState &rhsState,
                 Location loc, ConversionPatternRewriter &rewriter);
@@ -52,6 +86,69 @@ struct PtrState {
                                          ConversionPatternRewriter &rewriter);
 };
 
+// Memo of PtrStates computed by PtrAnalysis::visitOperand, keyed by the
+// analyzed Value. Offset expressions frequently share sub-expressions (e.g. the
+// same make_range feeding both the row and the column offsets), and without
+// memoization every use re-walks and re-materializes the whole def chain,
+// which is exponential in the depth of the chain. A cached state refers to
+// index computations inserted at the point where it was first built, so it is
+// only handed out where all of those values are still visible.
+class PtrStateCache {
+public:
+  // Return the cached state of v if there is one and all the values it refers
+  // to are defined before the current insertion point of builder.
+  std::optional<PtrState> lookup(Value v, const OpBuilder &builder) const;
+
+  void insert(Value v, const PtrState &state) { states[v] = state; }
+
+  // Share the cached states between the rewrites of the ops of scope, e.g.
+  // the function being converted; they are forgotten when another scope is
+  // entered.
+  void enterScope(Operation *op) {
+    if (op != scope)
+      clear();
+    scope = op;
+  }
+
+  // Forget all cached states, including the ones of block pointers; hit and
+  // miss counts are kept.
+  void clear() {
+    states.clear();
+    blockPtrStates.clear();
+    blockPtrLog.clear();
+  }
+
+  // A failed rewrite rolls back the IR the states cached since checkpoint()
+  // returned mark refer to. rollback(mark) forgets all the cached states, and
+  // the states of the block pointers recorded since then. The earlier states
+  // of block pointers are kept, since loads and stores need them to lower
+  // boundary checks after the pointers were rewritten, and block pointers
+  // carried by loops and branches are only known through them.
+  size_t checkpoint() const { return blockPtrLog.size(); }
+  void rollback(size_t mark);
+
+  // Return the state recorded for the block pointer v if all the values it
+  // refers to are defined before the current insertion point of builder.
+  std::optional<PtrState> lookupBlockPtr(Value v,
+                                         const OpBuilder &builder) const;
+
+  void insertBlockPtr(Value v, const PtrState &state);
+
+  void recordHit() { ++hits; }
+  void recordMiss() { ++misses; }
+  uint64_t getNumHits() const { return hits; }
+  uint64_t getNumMisses() const { return misses; }
+
+private:
+  llvm::DenseMap<Value, PtrState> states;
+  llvm::DenseMap<Value, PtrState> blockPtrStates;
+  // The block pointers recorded in order, with the state each one replaced
+  llvm::SmallVector<std::pair<Value, std::optional<PtrState>>> blockPtrLog;
+  Operation *scope = nullptr;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+};
+
 class PtrAnalysis {
 public:
   using IndexMapSet = std::map<int, std::set<int>>;
@@ -61,7 +158,15 @@ public:
   static void
   visitOperand(Value operand, PtrState &state, const Location loc,
                ConversionPatternRewriter &rewriter,
-               const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+               const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+               PtrStateCache *cache = nullptr);
+
+  // Uncached part of visitOperand: dispatch on the defining operation.
+  static void
+  visitOperandImpl(Value operand, PtrState &state, const Location loc,
+                   ConversionPatternRewriter &rewriter,
+                   const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                   PtrStateCache *cache);
 
   // Operand is the result of arith.addi. Process both arguments and insert any
   // arith.addi instruction as needed.
@@ -76,7 +181,8 @@ public:
   static void
   visitOperandAdd(arith::AddIOp addOp, PtrState &state, const Location loc,
                   ConversionPatternRewriter &rewriter,
-                  const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                  const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                  PtrStateCache *cache = nullptr);
 
   // Operand is the result of arith.muli. Process both arguments and insert any
   // arith.muli instruction as needed.
@@ -92,7 +198,8 @@ public:
   static void
   visitOperandMul(arith::MulIOp mulOp, PtrState &state, const Location loc,
                   ConversionPatternRewriter &rewriter,
-                  const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                  const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                  PtrStateCache *cache = nullptr);
 
   // Operand is the result of make_range.
   // Main assumptions:
@@ -107,7 +214,8 @@ public:
   static void
   visitOperandMakeRange(triton::MakeRangeOp rangeOp, PtrState &state,
                         Location loc, ConversionPatternRewriter &rewriter,
-                        const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                        const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                        PtrStateCache *cache = nullptr);
 
   // Operand is the result of expand_dims
   // Main assumptions:
@@ -119,17 +227,20 @@ public:
   visitOperandExpandDims(triton::ExpandDimsOp expandDimsOp, PtrState &state,
                          const Location loc,
                          ConversionPatternRewriter &rewriter,
-                         const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                         const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                         PtrStateCache *cache = nullptr);
 
   // Operand is the result of broadcast
   // Main assumptions:
   //  Rank of soure and result is the same
   // Expected result:
-  //  Update sizes[i] only, no changes to other fields
+  //  For every broadcast dimension i, sizes[i] = the size of the result and
+  //  strides[i] = 0, no changes to other fields
   static void
   visitOperandBroadcast(triton::BroadcastOp broadcastOp, PtrState &state,
                         const Location loc, ConversionPatternRewriter &rewriter,
-                        const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                        const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                        PtrStateCache *cache = nullptr);
 
   // Operand is the result of splat
   // Main assumptions:
@@ -140,7 +251,8 @@ public:
   static void
   visitOperandSplat(triton::SplatOp splatOp, PtrState &state,
                     const Location loc, ConversionPatternRewriter &rewriter,
-                    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                    PtrStateCache *cache = nullptr);
 
   // Operand is the result of arith.constant that is a splat
   // Main assumptions:
@@ -153,7 +265,8 @@ public:
   visitOperandConstSplat(arith::ConstantOp op, PtrState &state,
                          const Location loc,
                          ConversionPatternRewriter &rewriter,
-                         const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                         const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                         PtrStateCache *cache = nullptr);
 
   // Operand is the result of addptr.
   // Main assumptions:
@@ -164,7 +277,51 @@ public:
   static void
   visitOperandAddptr(triton::AddPtrOp addptrOp, PtrState &state,
                      const Location loc, ConversionPatternRewriter &rewriter,
-                     const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                     const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                     PtrStateCache *cache = nullptr);
+
+  // Operand is the result of make_tensor_ptr.
+  // Main assumptions:
+  //  The base is a scalar pointer
+  // Expected result:
+  //  source = base, sizes[i] = block shape, strides[i] = strides of the
+  //  parent tensor, offsets[i] = offsets[i] * strides[i], shape[i] = shape of
+  //  the parent tensor
+  static void visitOperandMakeTensorPtr(
+      triton::MakeTensorPtrOp makeTensorPtrOp, PtrState &state,
+      const Location loc, ConversionPatternRewriter &rewriter,
+      const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+      PtrStateCache *cache = nullptr);
+
+  // Operand is the result of advance.
+  // Main assumptions:
+  //  The ptr field is a block pointer
+  // Expected result:
+  //  offsets[i] of the block pointer is moved by offsets[i] * strides[i]
+  static void
+  visitOperandAdvance(triton::AdvanceOp advanceOp, PtrState &state,
+                      const Location loc, ConversionPatternRewriter &rewriter,
+                      const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                      PtrStateCache *cache = nullptr);
+
+  // Operand is the result of arith.remsi or arith.remui.
+  // Main assumptions:
+  //  The divisor is a scalar and the dividend is non-negative.
+  //  At most one dimension of the dividend has a non-zero stride; that
+  //  dimension becomes the wrap-around dimension of the resulting state.
+  static void
+  visitOperandRem(Operation *remOp, PtrState &state, const Location loc,
+                  ConversionPatternRewriter &rewriter,
+                  const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                  PtrStateCache *cache = nullptr);
+
+  // Operand is a 1-D integer tensor loaded from memory, used as gather
+  // indices. The state has a single dimension of stride 0 whose per-element
+  // offsets come from the loaded tensor.
+  static void
+  visitOperandGatherIndices(triton::LoadOp loadOp, PtrState &state,
+                            const Location loc,
+                            ConversionPatternRewriter &rewriter);
 
   // Operand is the result of reinterpret_cast.
   // Main assumptions:
@@ -174,14 +331,24 @@ public:
   static void
   visitOperandReintCast(memref::ReinterpretCastOp reintCastOp, PtrState &state,
                         const Location loc, ConversionPatternRewriter &rewriter,
-                        const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                        const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                        PtrStateCache *cache = nullptr);
 
   // Parse the state of AddPtrOp, insert any instruction needed to
   // calculate strides and offsets, build PtrState for this operand, and record
   // PtrState for knownPtrs.
   static void rewriteAddptrOp(triton::AddPtrOp op,
                               ConversionPatternRewriter &rewriter,
-                              llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                              llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                              PtrStateCache *cache = nullptr);
+
+  // Parse the state of a block pointer produced by MakeTensorPtrOp or
+  // AdvanceOp, replace it with a reinterpret_cast of the block, and record
+  // PtrState in knownPtrs and, if given, in cache.
+  static void
+  rewriteBlockPtrOp(Operation *op, ConversionPatternRewriter &rewriter,
+                    llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                    PtrStateCache *cache = nullptr);
 
   // Parse the state of YieldOp, insert any instruction needed to calculate
   // strides and offsets, build PtrState for this operand, and record PtrState
@@ -189,12 +356,39 @@ public:
   static void
   rewriteYieldOp(scf::YieldOp op, ConversionPatternRewriter &rewriter,
                  const IndexMapSet &levelToBlockArgIndex, const int level,
-                 const llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+                 const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                 PtrStateCache *cache = nullptr);
+
+  // Carry the offsets and strides of every pointer init arg of the loop as
+  // additional iter args, and rewrite the pointer arithmetic in the loop body
+  // in terms of them. Fails on loop bodies that cannot be rewritten, e.g.
+  // nested loops.
+  static LogicalResult
+  rewriteForOp(scf::ForOp op, ConversionPatternRewriter &rewriter,
+               IndexMapSet &levelToBlockArgIndex, const int level,
+               llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+               PtrStateCache *cache = nullptr);
+
+  // Same as rewriteForOp for scf.while. The offsets and strides of the
+  // pointers forwarded by scf.condition are carried into the after region.
+  // Pointers forwarded by scf.condition have to be block arguments of the
+  // before region.
+  static LogicalResult
+  rewriteWhileOp(scf::WhileOp op, ConversionPatternRewriter &rewriter,
+                 llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                 PtrStateCache *cache = nullptr);
 
-  static void rewriteForOp(scf::ForOp op, ConversionPatternRewriter &rewriter,
-                           IndexMapSet &levelToBlockArgIndex, const int level,
-                           llvm::SmallDenseMap<Value, PtrState> &knownPtrs);
+  // Rewrite the pointer arithmetic in both branches of an scf.if. Every
+  // pointer result is returned together with its offsets and strides, so
+  // that the branches are free to advance it differently; both branches must
+  // point into the same source.
+  static LogicalResult
+  rewriteIfOp(scf::IfOp op, ConversionPatternRewriter &rewriter,
+              llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+              PtrStateCache *cache = nullptr);
 
+  // Produce a 1-element memref view for the scalar pointer ptr, given
+  // memRef, its remapped value. Used to lower scalar loads and stores.
   static Value getScalarMemRef(Value ptr, Value memRef, const Location loc,
                                ConversionPatternRewriter &rewriter);
 };
@@ -41,10 +41,23 @@ public:
 
   unsigned getThreadsReductionAxis();
 
+  // Returns true if the reduced axis is held within a single warp, so that
+  // the reduction is done with warp shuffles only and needs neither shared
+  // memory nor barriers.
+  bool isWarpSynchronous();
+
   SmallVector<unsigned> getScratchConfigBasic();
 
   SmallVector<SmallVector<unsigned>> getScratchConfigsFast();
 
+  // Returns the number of scratch elements reserved for each operand.
+  unsigned getScratchElemsPerOperand();
+
+  // Returns the offset in bytes of the scratch buffer of each operand. The
+  // buffers are laid out one after the other, each aligned to the size of
+  // its elements.
+  SmallVector<unsigned> getScratchOffsetsInBytes();
+
   unsigned getScratchSizeInBytes();
 
   bool isSupportedLayout();
@@ -57,12 +70,75 @@ private:
   int axis;
 };
 
+class ScanLoweringHelper {
+public:
+  explicit ScanLoweringHelper(triton::ScanOp op) : scanOp(op) {
+    auto type = op.getOperands()[0].getType().cast<RankedTensorType>();
+    srcShape = type.getShape();
+    srcEncoding = type.getEncoding();
+    srcElementTypes = op.getElementTypes();
+  }
+
+  ArrayRef<int64_t> getSrcShape() { return srcShape; }
+
+  Attribute getSrcLayout() { return srcEncoding; }
+
+  unsigned getAxis() { return scanOp.getAxis(); }
+
+  // Returns true if the scan is lowered with warp shuffles: a blocked layout
+  // of integer or floating-point elements, holding at least one thread's
+  // worth of elements along the axis.
+  bool isSupported();
+
+  // Returns the number of contiguous elements of a thread along the axis.
+  unsigned getAxisNumElementsPerThread();
+
+  // Returns the number of lanes of a warp holding distinct elements along
+  // the axis.
+  unsigned getAxisNumThreadsPerWarp();
+
+  // Returns the distance between the ids of two lanes holding consecutive
+  // elements along the axis.
+  unsigned getAxisThreadStride();
+
+  // Returns the number of warps holding distinct elements along the axis.
+  unsigned getAxisNumWarps();
+
+  // Returns the number of times the layout is repeated along the axis.
+  unsigned getAxisNumBlocks();
+
+  // Returns the number of elements of the tensor at each position along the
+  // axis.
+  unsigned getNonAxisNumElements();
+
+  // Returns the number of scratch elements reserved for each operand: the
+  // partial scan of each warp in each repetition, or none if a single warp
+  // scans the whole axis at once.
+  unsigned getScratchElemsPerOperand();
+
+  // Returns the offset in bytes of the scratch buffer of each operand, laid
+  // out as those of ReduceOpHelper.
+  SmallVector<unsigned> getScratchOffsetsInBytes();
+
+  unsigned getScratchSizeInBytes();
+
+private:
+  triton::ScanOp scanOp;
+  ArrayRef<int64_t> srcShape;
+  Attribute srcEncoding;
+  SmallVector<Type> srcElementTypes;
+};
+
 bool isSharedEncoding(Value value);
 
 bool maybeSharedAllocationOp(Operation *op);
 
 bool maybeAliasOp(Operation *op);
 
+/// Returns true if `op` converts shared memory to an operand of an MMAv3 dot,
+/// which wgmma reads in place, so that the result aliases the source.
+bool isMmaV3OperandCvt(Operation *op);
+
 bool supportMMA(triton::DotOp op, int version);
 
 bool supportMMA(Value value, int version);
@@ -108,6 +184,26 @@ bool isSingleValue(Value value);
 
 bool isMmaToDotShortcut(RankedTensorType &srcTy, RankedTensorType &dstTy);
 
+/// Where a thread finds one of its elements after a convert_layout that only
+/// moves data within warps: in one of `srcElems` of its own source elements,
+/// or of the source elements of another lane, depending on the lane.
+struct WarpShuffleElem {
+  SmallVector<unsigned, 4> srcElems;
+  bool fromOtherLane;
+};
+
+/// Returns, for every element of a thread in `dstTy`, where to find it in
+/// `srcTy` if the conversion can be done with warp shuffles, i.e. if every
+/// element is held by the same warp in both layouts, and the lanes of a warp
+/// do not pick each of their elements out of too many source elements. Only
+/// blocked and MMAv2 layouts are supported.
+std::optional<SmallVector<WarpShuffleElem>>
+getWarpShuffleCvt(RankedTensorType srcTy, RankedTensorType dstTy);
+
+/// Returns the lane of a warp that provides `index` of a tensor in `layout`
+/// to warp shuffles.
+unsigned getWarpShuffleSrcLane(Attribute layout, ArrayRef<unsigned> index);
+
 /// Multi-root DAG topological sort.
 /// Performs a topological sort of the Operation in the `toSort` SetVector.
 /// Returns a topologically sorted SetVector.
@@ -121,9 +217,24 @@ SetVector<Operation *>
 multiRootGetSlice(Operation *op, TransitiveFilter backwardFilter = nullptr,
                   TransitiveFilter forwardFilter = nullptr);
 
+// Estimated number of 32-bit registers a thread needs to hold `v`
+int64_t getNumRegisters(Value v);
+
+// Peak number of registers held by the values defined in a block whose ops
+// run in `order`
+int64_t getPeakRegisters(Block *block, ArrayRef<Operation *> order);
+
+// Largest peak number of registers of the blocks nested in `op`, in their
+// current order
+int64_t getPeakRegisters(Operation *op);
+
 // Create a basic DataFlowSolver with constant and dead code analysis included.
 std::unique_ptr<DataFlowSolver> createDataFlowSolver();
 
+// Reports, as a remark on `op`, that `pass` did not optimize it and why, when
+// TRITON_REMARKS is set
+void emitMissedRemark(Operation *op, StringRef pass, const Twine &reason);
+
 } // namespace mlir
 
 #endif // TRITON_ANALYSIS_UTILITY_H
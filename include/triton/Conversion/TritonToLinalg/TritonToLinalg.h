@@ -12,19 +12,55 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
 
+#include "triton/Analysis/PtrAnalysis.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 
 namespace mlir {
 namespace triton {
 
+// Number of program ids, one per launch grid dimension, appended to the
+// arguments of converted kernels.
+static unsigned int constexpr LAUNCH_GRID_RANK = 3;
+
 std::unique_ptr<OperationPass<ModuleOp>> createTritonToLinalgPass();
 
+std::unique_ptr<OperationPass<ModuleOp>> createTritonLinalgGridLauncherPass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createTritonLinalgPrefetchPass();
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createTritonLinalgFuseElementwisePass();
+
+std::unique_ptr<OperationPass<ModuleOp>> createTritonLinalgTileMatmulPass();
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createTritonLinalgSplitKPass(unsigned splitK = 1);
+
+// Sizes of the caches and vector registers of a CPU that
+// triton-linalg-tile-matmul blocks matmuls for.
+struct CPUTargetDescription {
+  unsigned l1CacheBytes = 32 * 1024;
+  unsigned l2CacheBytes = 1024 * 1024;
+  unsigned vectorBits = 128;
+  unsigned numVectorRegisters = 16;
+
+  // The description of the host, from its features and, where the system
+  // reports them, its cache sizes; the defaults otherwise.
+  static CPUTargetDescription getHost();
+};
+
 void populateTritonToLinalgCanonicalizationPatterns(
     RewritePatternSet &patterns);
 
-void populateTritonToLinalgConversionPatterns(TypeConverter &typeConverter,
-                                              RewritePatternSet &patterns,
-                                              unsigned int launchGridRank);
+// If cache is provided, PtrStates built while lowering addptr and for ops are
+// memoized in it; it must outlive the conversion. Without it, boundary checks
+// of block pointers carried through loops cannot be lowered. Loads are copied
+// into buffers in loadMemorySpace, or in the space of their "MemorySpace"
+// attribute if they have one.
+void populateTritonToLinalgConversionPatterns(
+    TypeConverter &typeConverter, RewritePatternSet &patterns,
+    unsigned int launchGridRank, bool inPlaceStores = false,
+    PtrStateCache *cache = nullptr, unsigned int loadMemorySpace = 0);
 
 } // namespace triton
 } // namespace mlir
@@ -11,6 +11,8 @@ std::unique_ptr<Pass> createCombineOpsPass();
 std::unique_ptr<Pass>
 createRewriteTensorPointerPass(int computeCapability = 80);
 
+std::unique_ptr<Pass> createFuseKernelsPass(StringRef name = "fused_kernel");
+
 } // namespace triton
 
 #define GEN_PASS_REGISTRATION
@@ -5,6 +5,47 @@
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Dialect.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <mutex>
+
+namespace mlir {
+namespace triton {
+namespace gpu {
+
+/// Memoizes the facts the utilities below derive from layouts, which the
+/// passes of a context query for every op they visit. Facts are computed
+/// outside of the lock, as they query the cache for the parents of layouts.
+class LayoutInfoCache {
+public:
+  enum class Kind {
+    ThreadsPerWarp,
+    WarpsPerCTA,
+    SizePerThread,
+    ContigPerThread,
+    ThreadsPerCTA,
+    ShapePerCTA,
+    Order
+  };
+
+  /// Returns the fact of `kind` about `layout`, computing it the first time.
+  SmallVector<unsigned>
+  getOrCompute(Attribute layout, Kind kind,
+               function_ref<SmallVector<unsigned>()> compute);
+
+  /// Returns the number of elements per thread of tensors of `type`,
+  /// computing it the first time.
+  unsigned getOrCompute(Type type, function_ref<unsigned()> compute);
+
+private:
+  std::mutex mutex;
+  DenseMap<std::pair<Attribute, unsigned>, SmallVector<unsigned>> facts;
+  DenseMap<Type, unsigned> elemsPerThread;
+};
+
+} // namespace gpu
+} // namespace triton
+} // namespace mlir
 
 // TritonGPU depends on Triton
 #include "triton/Dialect/Triton/IR/Dialect.h"
@@ -21,6 +62,9 @@ namespace mlir {
 namespace triton {
 namespace gpu {
 
+/// Returns the layout facts of `context`, see LayoutInfoCache.
+LayoutInfoCache &getLayoutInfoCache(MLIRContext *context);
+
 unsigned getElemsPerThread(Type type);
 
 SmallVector<unsigned> getThreadsPerWarp(Attribute layout);
@@ -4,17 +4,37 @@
 #include "mlir/Pass/Pass.h"
 
 namespace mlir {
-std::unique_ptr<Pass> createTritonGPUPipelinePass(int numStages = 2);
+std::unique_ptr<Pass>
+createTritonGPUPipelinePass(int numStages = 2, bool registerStaging = false,
+                            bool pipelineNonDotLoads = false);
+
+std::unique_ptr<Pass>
+createTritonGPUAccelerateMatmulPass(int computeCapability = 80,
+                                    int matrixCoreVersion = 0);
+
+std::unique_ptr<Pass> createTritonGPUPipelineChainedDotsPass();
+
+std::unique_ptr<Pass> createTritonGPUPrefetchPass(int distance = 1,
+                                                  int sliceWidth = 0);
 
 std::unique_ptr<Pass>
-createTritonGPUAccelerateMatmulPass(int computeCapability = 80);
+createTritonGPUPersistentKernelPass(bool pipelineTiles = false);
 
-std::unique_ptr<Pass> createTritonGPUPrefetchPass();
+std::unique_ptr<Pass> createTritonGPUSplitKPass(int splitK = 1);
 
 std::unique_ptr<Pass> createTritonGPUCanonicalizeLoopsPass();
 
 std::unique_ptr<Pass> createTritonGPUCoalescePass();
 
+std::unique_ptr<Pass>
+createTritonGPUCoalesceEpiloguePass(int maxSharedMemory = 49152);
+
+std::unique_ptr<Pass> createTritonGPUInstrumentRegionsPass(
+    int capacity = 256, bool loops = false, bool dots = false,
+    bool loads = false, bool globalTimer = false);
+
+std::unique_ptr<Pass> createTritonGPUGridBarriersPass();
+
 std::unique_ptr<Pass> createTritonGPUReorderInstructionsPass();
 
 std::unique_ptr<Pass> createTritonGPUDecomposeConversionsPass();
@@ -8,17 +8,28 @@
 #define TRITON_DIALECT_TRITONGPU_TRANSFORMS_TRITONGPUCONVERSION_H_
 
 #include "mlir/Transforms/DialectConversion.h"
+#include <map>
 
 namespace mlir {
 
+class AxisInfoAnalysis;
+
 class TritonGPUTypeConverter : public TypeConverter {
 public:
-  TritonGPUTypeConverter(MLIRContext *context, int numWarps);
+  TritonGPUTypeConverter(MLIRContext *context, int numWarps,
+                         int threadsPerWarp);
   int getNumWarps() const { return numWarps; }
+  int getThreadsPerWarp() const { return threadsPerWarp; }
+
+  // Gives the tensors of `shape` the layout `encoding` instead of the default
+  // one. Returns false, and keeps the first one, if `shape` already has one.
+  bool setShapeEncoding(ArrayRef<int64_t> shape, Attribute encoding);
 
 private:
   MLIRContext *context;
   int numWarps;
+  int threadsPerWarp;
+  std::map<SmallVector<int64_t>, Attribute> shapeEncodings;
 };
 
 class TritonGPUConversionTarget : public ConversionTarget {
@@ -28,6 +39,12 @@ public:
                                      TritonGPUTypeConverter &typeConverter);
 };
 
+// The blocked layout in which the accesses through the tensor of pointers
+// `ptr` are coalesced, and vectorized as far as its contiguity and alignment
+// allow
+Attribute getCoalescedEncoding(MLIRContext *context, AxisInfoAnalysis &axisInfo,
+                               Value ptr, int numWarps, int threadsPerWarp);
+
 } // namespace mlir
 
 #endif // TRITON_DIALECT_TRITONGPU_TRANSFORMS_TRITONGPUCONVERSION_H_
@@ -11,7 +11,8 @@ class Module;
 
 namespace triton {
 
-// Translate TritonGPU IR to HSACO code.
+// Translate TritonGPU IR to AMDGCN assembly and the bytes of the linked HSACO
+// code object.
 std::tuple<std::string, std::string>
 translateLLVMIRToHSACO(llvm::Module &module, std::string gfx_arch,
                        std::string gfx_triple, std::string gfx_features);
@@ -9,8 +9,10 @@ class Module;
 
 namespace triton {
 
-// Translate TritonGPU IR to PTX code.
-std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version);
+// Translate TritonGPU IR to PTX code, with the code generation of LLVM at
+// `optLevel`, from 0 to 3.
+std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version,
+                                 int optLevel = 3);
 
 } // namespace triton
 
@@ -38,6 +38,15 @@ void SharedMemoryAliasAnalysis::visitOperation(
       // insert_slice %src into %dst[%offsets]
       aliasInfo = AliasInfo(operands[1]->getValue());
       pessimistic = false;
+    } else if (auto insertOp = dyn_cast<triton::gpu::InsertSliceTMAOp>(op)) {
+      // insert_slice_tma %desc[%indices], %dst, %index, %barriers, %pred
+      aliasInfo =
+          AliasInfo(operands[1 + insertOp.getIndices().size()]->getValue());
+      pessimistic = false;
+    } else if (isMmaV3OperandCvt(op)) {
+      // MMAv3 dot operands stay in the shared memory they are converted from
+      aliasInfo = AliasInfo(operands[0]->getValue());
+      pessimistic = false;
     } else if (isSharedEncoding(result)) {
       aliasInfo.insert(result);
       pessimistic = false;
@@ -4,13 +4,17 @@
 #include "mlir/Analysis/SliceAnalysis.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "triton/Analysis/Alias.h"
+#include "triton/Analysis/BankConflicts.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
 
 #include <algorithm>
+#include <functional>
 #include <limits>
 #include <numeric>
+#include <tuple>
 
 using ::mlir::triton::gpu::BlockedEncodingAttr;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
@@ -18,6 +22,7 @@ using ::mlir::triton::gpu::getContigPerThread;
 using ::mlir::triton::gpu::getOrder;
 using ::mlir::triton::gpu::getShapePerCTA;
 using ::mlir::triton::gpu::getSizePerThread;
+using ::mlir::triton::gpu::MfmaEncodingAttr;
 using ::mlir::triton::gpu::MmaEncodingAttr;
 using ::mlir::triton::gpu::SharedEncodingAttr;
 using ::mlir::triton::gpu::SliceEncodingAttr;
@@ -34,9 +39,9 @@ constexpr int kPtrBitWidth = 64;
 
 static std::pair<SmallVector<unsigned>, SmallVector<unsigned>>
 getCvtOrder(Attribute srcLayout, Attribute dstLayout) {
-  auto srcMmaLayout = srcLayout.dyn_cast<MmaEncodingAttr>();
+  bool srcMmaLayout = srcLayout.isa<MmaEncodingAttr, MfmaEncodingAttr>();
   auto srcDotLayout = srcLayout.dyn_cast<DotOperandEncodingAttr>();
-  auto dstMmaLayout = dstLayout.dyn_cast<MmaEncodingAttr>();
+  bool dstMmaLayout = dstLayout.isa<MmaEncodingAttr, MfmaEncodingAttr>();
   auto dstDotLayout = dstLayout.dyn_cast<DotOperandEncodingAttr>();
   assert(!(srcMmaLayout && dstMmaLayout) &&
          "Unexpected mma -> mma layout conversion");
@@ -52,7 +57,7 @@ getCvtOrder(Attribute srcLayout, Attribute dstLayout) {
 
 SmallVector<unsigned>
 getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
-                             unsigned &outVec) {
+                             unsigned &outVec, SharedEncodingAttr *swizzle) {
   auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
   auto dstTy = op.getResult().getType().cast<RankedTensorType>();
   Attribute srcLayout = srcTy.getEncoding();
@@ -89,6 +94,23 @@ getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
   }
   if (rank == 1)
     return paddedRepShape;
+  // Transposes between blocked layouts swizzle their rows rather than pad
+  // them when it conflicts less
+  auto srcBlocked = srcLayout.dyn_cast<BlockedEncodingAttr>();
+  auto dstBlocked = dstLayout.dyn_cast<BlockedEncodingAttr>();
+  if (srcBlocked && dstBlocked && inOrd[0] != outOrd[0]) {
+    unsigned elemBytes =
+        srcTy.getElementType().isa<triton::PointerType>()
+            ? kPtrBitWidth / 8
+            : std::max<int>(8, srcTy.getElementTypeBitWidth()) / 8;
+    auto layout = getScratchSwizzle(srcBlocked, dstBlocked, paddedRepShape,
+                                    outOrd, inVec, outVec, pad, elemBytes);
+    if (layout) {
+      if (swizzle)
+        *swizzle = layout;
+      return paddedRepShape;
+    }
+  }
   unsigned paddedDim = 1;
   if (auto dstBlockedLayout = dstLayout.dyn_cast<BlockedEncodingAttr>()) {
     paddedDim = dstBlockedLayout.getOrder()[0];
@@ -133,6 +155,7 @@ private:
 
   void run() {
     getValuesAndSizes();
+    resolveAlignment();
     resolveLiveness();
     computeOffsets();
   }
@@ -164,8 +187,19 @@ private:
   void getScratchValueSize(Operation *op) {
     if (auto reduceOp = dyn_cast<triton::ReduceOp>(op)) {
       ReduceOpHelper helper(reduceOp);
+      // Reductions within warps are done with warp shuffles
+      if (helper.isWarpSynchronous())
+        return;
       unsigned bytes = helper.getScratchSizeInBytes();
       allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+    } else if (auto scanOp = dyn_cast<triton::ScanOp>(op)) {
+      ScanLoweringHelper helper(scanOp);
+      // Scans within warps are done with warp shuffles
+      unsigned bytes =
+          helper.isSupported() ? helper.getScratchSizeInBytes() : 0;
+      if (bytes == 0)
+        return;
+      allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
     } else if (auto cvtLayout = dyn_cast<triton::gpu::ConvertLayoutOp>(op)) {
       auto srcTy = cvtLayout.getSrc().getType().cast<RankedTensorType>();
       auto dstTy = cvtLayout.getResult().getType().cast<RankedTensorType>();
@@ -176,10 +210,10 @@ private:
         // Conversions from/to shared memory do not need scratch memory.
         return;
       }
+      // Conversions within warps are done with warp shuffles
+      if (getWarpShuffleCvt(srcTy, dstTy))
+        return;
       // ConvertLayoutOp with both input/output non-shared_layout
-      // TODO: Besides of implementing ConvertLayoutOp via shared memory, it's
-      //       also possible to realize it with other approaches in restricted
-      //       conditions, such as warp-shuffle
       unsigned inVec = 0;
       unsigned outVec = 0;
       auto smemShape = getScratchConfigForCvtLayout(cvtLayout, inVec, outVec);
@@ -260,6 +294,18 @@ private:
     });
   }
 
+  /// Aligns the buffers read by wgmma and written by TMA to the 1024 bytes
+  /// the 128B swizzle pattern repeats every, as both swizzle by the address
+  /// bits while the shared layout swizzles from the start of the buffer.
+  void resolveAlignment() {
+    operation->walk([&](Operation *op) {
+      if (!isMmaV3OperandCvt(op) && !isa<triton::gpu::InsertSliceTMAOp>(op))
+        return;
+      for (auto *buffer : allocation->aliasBuffer.lookup(op->getResult(0)))
+        buffer->alignment = std::max<size_t>(buffer->alignment, 1024);
+    });
+  }
+
   /// Computes the liveness range of the allocated value.
   /// Each buffer is allocated only once.
   void resolveExplicitBufferLiveness(
@@ -352,6 +398,8 @@ private:
     resolveExplicitBufferLiveness(getValueLivenessRange);
     resolveAliasBufferLiveness(getValueLivenessRange);
     resolveScratchBufferLiveness(operationId);
+    for (auto [buffer, range] : bufferRange)
+      buffer->liveness = range;
   }
 
   /// Computes the shared memory offsets for all related values.
@@ -363,6 +411,12 @@ private:
       buffers.emplace_back(bufferIter.first);
     }
 
+    allocation->maxLiveSize = computeMaxLiveSize(buffers);
+    if (allocation->policy == AllocationPolicy::BestFit) {
+      allocateBestFit(buffers);
+      return;
+    }
+
     DenseMap<BufferT *, size_t> bufferStart;
     calculateStarts(buffers, bufferStart);
 
@@ -413,10 +467,11 @@ private:
         auto buffer = *bufferIt;
         auto xSize = buffer->size;
         auto xRange = bufferRange.lookup(buffer);
-        bufferStart[buffer] = size;
+        auto xStart = llvm::alignTo(size, buffer->alignment);
+        bufferStart[buffer] = xStart;
         tripleMap.insert(
-            {size + xSize, Interval{std::max(range.start(), xRange.start()),
-                                    std::min(range.end(), xRange.end())}});
+            {xStart + xSize, Interval{std::max(range.start(), xRange.start()),
+                                      std::min(range.end(), xRange.end())}});
         // We could either insert (range.start, xRange.start) or (range.start,
         // xRange.end), both are correct and determine the potential buffer
         // offset, and the graph coloring algorithm will solve the interference,
@@ -491,7 +546,108 @@ private:
       for (auto y : interference.lookup(x)) {
         adj = std::max(adj, bufferStart.lookup(y) + y->size);
       }
-      x->offset = bufferStart.lookup(x) + colors.lookup(x) * adj;
+      x->offset = llvm::alignTo(bufferStart.lookup(x) + colors.lookup(x) * adj,
+                                x->alignment);
+      allocation->sharedMemorySize =
+          std::max(allocation->sharedMemorySize, x->offset + x->size);
+    }
+  }
+
+  /// Computes the largest sum of the sizes of the buffers live at the same
+  /// time. The sum only grows at the start of a liveness range.
+  size_t computeMaxLiveSize(const SmallVector<BufferT *> &buffers) {
+    size_t maxLiveSize = 0;
+    for (auto x : buffers) {
+      auto start = bufferRange.lookup(x).start();
+      size_t liveSize = 0;
+      for (auto y : buffers)
+        if (bufferRange.lookup(y).contains(start))
+          liveSize += y->size;
+      maxLiveSize = std::max(maxLiveSize, liveSize);
+    }
+    return maxLiveSize;
+  }
+
+  /// Places the buffers in the given order, each into the smallest gap left
+  /// by the already placed buffers whose liveness ranges intersect its own,
+  /// or above all of them if none fits. Returns the peak.
+  size_t packBestFit(ArrayRef<BufferT *> buffers,
+                     DenseMap<BufferT *, size_t> &bufferStart) {
+    size_t peak = 0;
+    SmallVector<BufferT *> placed;
+    for (auto x : buffers) {
+      auto xRange = bufferRange.lookup(x);
+      SmallVector<Interval<size_t>> taken;
+      for (auto y : placed)
+        if (bufferRange.lookup(y).intersects(xRange))
+          taken.push_back({bufferStart[y], bufferStart[y] + y->size});
+      llvm::sort(taken);
+
+      size_t start = 0;
+      size_t bestGap = std::numeric_limits<size_t>::max();
+      size_t end = 0;
+      for (auto interval : taken) {
+        size_t gapStart = llvm::alignTo(end, x->alignment);
+        if (interval.start() > gapStart &&
+            interval.start() - gapStart >= x->size &&
+            interval.start() - gapStart < bestGap) {
+          bestGap = interval.start() - gapStart;
+          start = gapStart;
+        }
+        end = std::max(end, interval.end());
+      }
+      if (bestGap == std::numeric_limits<size_t>::max())
+        start = llvm::alignTo(end, x->alignment);
+
+      bufferStart[x] = start;
+      peak = std::max(peak, start + x->size);
+      placed.push_back(x);
+    }
+    return peak;
+  }
+
+  /// Computes the shared memory offsets by interval packing. Finding the
+  /// optimal packing is NP-hard, so this tries a few orders of the buffers
+  /// and keeps the one with the lowest peak, stopping as soon as the peak is
+  /// the number of bytes live at the same time.
+  /// Unlike the first fit allocation, any two buffers with disjoint liveness
+  /// ranges may share memory, e.g. the scratch buffers of two loops.
+  void allocateBestFit(const SmallVector<BufferT *> &buffers) {
+    auto range = [&](BufferT *x) { return bufferRange.lookup(x); };
+    SmallVector<std::function<bool(BufferT *, BufferT *)>> orders = {
+        // largest buffers first
+        [&](BufferT *x, BufferT *y) {
+          return std::make_tuple(y->size, range(x).start(), x->id) <
+                 std::make_tuple(x->size, range(y).start(), y->id);
+        },
+        // longest lived buffers first
+        [&](BufferT *x, BufferT *y) {
+          return std::make_tuple(range(y).size(), y->size, x->id) <
+                 std::make_tuple(range(x).size(), x->size, y->id);
+        },
+        // in program order
+        [&](BufferT *x, BufferT *y) {
+          return std::make_tuple(range(x).start(), y->size, x->id) <
+                 std::make_tuple(range(y).start(), x->size, y->id);
+        }};
+
+    DenseMap<BufferT *, size_t> bestStart;
+    size_t bestPeak = std::numeric_limits<size_t>::max();
+    for (auto &order : orders) {
+      SmallVector<BufferT *> sortedBuffers = buffers;
+      llvm::sort(sortedBuffers, order);
+      DenseMap<BufferT *, size_t> bufferStart;
+      size_t peak = packBestFit(sortedBuffers, bufferStart);
+      if (peak < bestPeak) {
+        bestPeak = peak;
+        bestStart = std::move(bufferStart);
+      }
+      if (bestPeak == allocation->maxLiveSize)
+        break;
+    }
+
+    for (auto x : buffers) {
+      x->offset = bestStart.lookup(x);
       allocation->sharedMemorySize =
           std::max(allocation->sharedMemorySize, x->offset + x->size);
     }
@@ -506,4 +662,46 @@ private:
 
 void Allocation::run() { triton::AllocationAnalysis(getOperation(), this); }
 
+SmallVector<Allocation::BufferInfo> Allocation::getBufferInfos() const {
+  SmallVector<BufferInfo> infos;
+  auto addInfo = [&](const BufferT *buffer, Operation *owner) {
+    infos.push_back({buffer->id, owner,
+                     buffer->kind == BufferT::BufferKind::Scratch,
+                     buffer->offset, buffer->size, buffer->liveness});
+  };
+  for (auto [value, buffer] : valueBuffer)
+    addInfo(buffer, value.getDefiningOp());
+  for (auto [op, buffer] : opScratch)
+    addInfo(buffer, op);
+  llvm::sort(infos, [](const BufferInfo &lhs, const BufferInfo &rhs) {
+    return lhs.id < rhs.id;
+  });
+  return infos;
+}
+
+ArrayAttr getSharedMemoryBufferReport(const Allocation &allocation) {
+  Builder builder(allocation.getOperation()->getContext());
+  SmallVector<Attribute> buffers;
+  for (auto &info : allocation.getBufferInfos()) {
+    std::string loc;
+    llvm::raw_string_ostream os(loc);
+    info.owner->getLoc().print(os);
+    buffers.push_back(builder.getDictionaryAttr({
+        builder.getNamedAttr(
+            "op", builder.getStringAttr(info.owner->getName().getStringRef())),
+        builder.getNamedAttr("loc", builder.getStringAttr(os.str())),
+        builder.getNamedAttr(
+            "kind", builder.getStringAttr(info.isScratch ? "scratch"
+                                                         : "explicit")),
+        builder.getNamedAttr("offset", builder.getI64IntegerAttr(info.offset)),
+        builder.getNamedAttr("size", builder.getI64IntegerAttr(info.size)),
+        builder.getNamedAttr("live_start",
+                             builder.getI64IntegerAttr(info.liveness.start())),
+        builder.getNamedAttr("live_end",
+                             builder.getI64IntegerAttr(info.liveness.end())),
+    }));
+  }
+  return builder.getArrayAttr(buffers);
+}
+
 } // namespace mlir
@@ -336,7 +336,6 @@ private:
     auto resTy = op.getResult().getType().template dyn_cast<RankedTensorType>();
     if (!resTy)
       return BinaryOpVisitorImpl<OpTy>::getConstancy(op, lhs, rhs, dim);
-    auto shape = resTy.getShape();
     // Case 1: both lhs and rhs are constants.
     auto constancy = gcd(lhs.getConstancy(dim), rhs.getConstancy(dim));
     // Case 2: lhs contiguous, rhs constant.
@@ -348,12 +347,13 @@ private:
     // the minimal constancy is gcd(d_lhs, d_rhs).
     // Since gcd(d_lhs, d_rhs) maybe > len(lhs),
     // we need to use another gcd to get the actual constancy.
-    if (AxisInfoVisitor::isContiguousDim(lhs, shape, dim) &&
-        AxisInfoVisitor::isConstantDim(rhs, shape, dim)) {
-      constancy = std::max(constancy, gcd(lhs.getContiguity(dim),
-                                          gcd(lhs.getDivisibility(dim),
-                                              rhs.getDivisibility(dim))));
-    }
+    // This holds for every contiguous group of lhs over which rhs is
+    // constant, so neither of them has to span the whole dimension.
+    if (lhs.getContiguity(dim) > 1)
+      constancy = std::max(
+          constancy,
+          gcd(gcd(lhs.getContiguity(dim), rhs.getConstancy(dim)),
+              gcd(lhs.getDivisibility(dim), rhs.getDivisibility(dim))));
     return constancy;
   }
 
@@ -391,8 +391,6 @@ private:
     auto resTy = op.getResult().getType().template dyn_cast<RankedTensorType>();
     if (!resTy)
       return BinaryOpVisitorImpl<OpTy>::getContiguity(op, lhs, rhs, dim);
-    auto shape = resTy.getShape();
-    int64_t contiguity = 1;
     // lhs contiguous, rhs constant
     // lhs: d_lhs * k, d_lhs * k + 1, ..., d_lhs * k + n
     // rhs: d_rhs * p, d_rhs * p, ..., d_rhs * p
@@ -402,13 +400,10 @@ private:
     // The minimal contiguity is gcd(d_lhs, d_rhs).
     // Since gcd(d_lhs, d_rhs) maybe > len(lhs),
     // we need to use another gcd to get the actual contiguity.
-    if (AxisInfoVisitor::isContiguousDim(lhs, shape, dim) &&
-        AxisInfoVisitor::isConstantDim(rhs, shape, dim)) {
-      contiguity = std::max(contiguity, gcd(lhs.getContiguity(dim),
-                                            gcd(lhs.getDivisibility(dim),
-                                                rhs.getDivisibility(dim))));
-    }
-    return contiguity;
+    // This holds for every contiguous group of lhs over which rhs is
+    // constant, so neither of them has to span the whole dimension.
+    return gcd(gcd(lhs.getContiguity(dim), rhs.getConstancy(dim)),
+               gcd(lhs.getDivisibility(dim), rhs.getDivisibility(dim)));
   }
 
   int64_t getDivisibility(OpTy op, const AxisInfo &lhs, const AxisInfo &rhs,
@@ -417,7 +412,13 @@ private:
     // rhs: d_rhs * p = gcd(d_lhs, d_rhs) * p' * p = gcd(d_lhs, d_rhs) * p''
     // lhs = gcd(d_lhs, d_rhs) * k'' = gcd(d_lhs, d_rhs) * d + r
     // r must be divisible by gcd(d_lhs, d_rhs)
-    return gcd(lhs.getDivisibility(dim), rhs.getDivisibility(dim));
+    auto divisibility = gcd(lhs.getDivisibility(dim), rhs.getDivisibility(dim));
+    // The contiguous groups of the result may start in the middle of a group
+    // of lhs, whose first element only is known to be divisible by d_lhs
+    auto contiguity = getContiguity(op, lhs, rhs, dim);
+    if (contiguity < lhs.getContiguity(dim))
+      divisibility = gcd(divisibility, contiguity);
+    return divisibility;
   };
 
   int64_t getConstancy(OpTy op, const AxisInfo &lhs, const AxisInfo &rhs,
@@ -637,14 +638,19 @@ public:
   AxisInfo
   getAxisInfo(OpTy op,
               ArrayRef<const dataflow::Lattice<AxisInfo> *> operands) override {
-    auto resTy = op.getResult().getType().template dyn_cast<RankedTensorType>();
-    if (!resTy)
-      return AxisInfo();
-    auto shape = resTy.getShape();
-    auto rank = shape.size();
-    auto condConstancy = operands[0]->getValue().getConstancy();
     auto lhsInfo = operands[1]->getValue();
     auto rhsInfo = operands[2]->getValue();
+    auto rank = lhsInfo.getRank();
+    // A scalar condition selects the same operand for the whole tensor
+    AxisInfo::DimVectorT condConstancy;
+    if (op.getCondition().getType().template isa<RankedTensorType>())
+      condConstancy = operands[0]->getValue().getConstancy();
+    else if (auto resTy = op.getResult()
+                              .getType()
+                              .template dyn_cast<RankedTensorType>())
+      condConstancy = AxisInfo::DimVectorT(resTy.getShape());
+    else
+      condConstancy = AxisInfo::DimVectorT(rank, 1);
 
     AxisInfo::DimVectorT contiguity, divisibility, constancy;
     std::optional<int64_t> constantValue;
@@ -727,15 +733,22 @@ private:
 
   int64_t getDivisibility(arith::ShLIOp op, const AxisInfo &lhs,
                           const AxisInfo &rhs, int dim) override {
-    auto shift = rhs.getConstantValue().has_value()
-                     ? rhs.getConstantValue().value()
-                     : rhs.getDivisibility(dim);
-    auto numBits = log2Int(lhs.getDivisibility(dim));
+    // An unknown shift is only known to be at least 0
+    auto shift = rhs.getConstantValue().value_or(0);
+    auto lhsDivisibility = lhs.getDivisibility(dim);
+    // Unless it is known to be 0, the shift breaks the contiguous groups of
+    // lhs, so every element of the result is a group, while d_lhs only
+    // divides the first one of lhs's: [2^n, 2^n + 1, ...] is treated as
+    // divisible by 1 instead of 2^n
+    if (lhs.getContiguity(dim) > 1 &&
+        (!rhs.getConstantValue().has_value() || shift != 0))
+      lhsDivisibility = 1;
+    auto numBits = log2Int(lhsDivisibility);
     auto maxBits = log2Int(highestPowOf2Divisor<int64_t>(0));
     // Make sure the return value doesn't exceed highestPowOf2Divisor<int64>(0)
     if (shift + numBits > maxBits)
       return highestPowOf2Divisor<int64_t>(0);
-    return lhs.getDivisibility(dim) << shift;
+    return lhsDivisibility << shift;
   }
 
   int64_t getConstancy(arith::ShLIOp op, const AxisInfo &lhs,
@@ -769,17 +782,33 @@ private:
 
   int64_t getDivisibility(OpTy op, const AxisInfo &lhs, const AxisInfo &rhs,
                           int dim) override {
-    if (rhs.getConstantValue().has_value())
-      return std::max<int64_t>(1, lhs.getDivisibility(dim) /
-                                      (1 << rhs.getConstantValue().value()));
-    else
-      return std::max<int64_t>(1, lhs.getDivisibility(dim) /
-                                      (1 << rhs.getDivisibility(dim)));
+    // Nothing is known about the result of an unknown shift
+    if (!rhs.getConstantValue().has_value())
+      return 1;
+    auto shift = rhs.getConstantValue().value();
+    if (shift == 0)
+      return lhs.getDivisibility(dim);
+    // d_lhs only divides the first element of the contiguous groups of lhs,
+    // which the shift breaks
+    if (lhs.getContiguity(dim) > 1 || shift >= 63)
+      return 1;
+    return std::max<int64_t>(1, lhs.getDivisibility(dim) >> shift);
   }
 
   int64_t getConstancy(OpTy op, const AxisInfo &lhs, const AxisInfo &rhs,
                        int dim) override {
-    return gcd(lhs.getConstancy(dim), rhs.getConstancy(dim));
+    auto constancy = gcd(lhs.getConstancy(dim), rhs.getConstancy(dim));
+    // lhs >> k = lhs / 2^k: the groups of gcd(d_lhs, 2^k) contiguous
+    // elements of lhs become constant
+    if (rhs.getConstantValue().has_value() && lhs.getContiguity(dim) > 1) {
+      auto shift = rhs.getConstantValue().value();
+      if (shift > 0 && shift < 63)
+        constancy = std::max(
+            constancy,
+            gcd(gcd(lhs.getContiguity(dim), rhs.getConstancy(dim)),
+                gcd(lhs.getDivisibility(dim), int64_t(1) << shift)));
+    }
+    return constancy;
   }
 
   std::optional<int64_t> getConstantValue(OpTy op, const AxisInfo &lhs,
@@ -873,14 +902,67 @@ AxisInfoAnalysis::AxisInfoAnalysis(DataFlowSolver &solver)
                   MaxMinOpAxisInfoVisitor<arith::MinUIOp>>();
 }
 
+void AxisInfoAnalysis::visitNonControlFlowArguments(
+    Operation *op, const RegionSuccessor &successor,
+    ArrayRef<dataflow::Lattice<AxisInfo> *> argLattices, unsigned firstIndex) {
+  auto forOp = dyn_cast<scf::ForOp>(op);
+  if (!forOp)
+    return dataflow::SparseDataFlowAnalysis<dataflow::Lattice<AxisInfo>>::
+        visitNonControlFlowArguments(op, successor, argLattices, firstIndex);
+  // iv = lb + k * step is divisible by gcd(d_lb, d_step), whether or not the
+  // bounds are constants
+  Block *body = forOp.getBody();
+  auto lbInfo = getLatticeElementFor(body, forOp.getLowerBound())->getValue();
+  auto stepInfo = getLatticeElementFor(body, forOp.getStep())->getValue();
+  unsigned numInputs = successor.getSuccessorInputs().size();
+  for (unsigned i = 0; i < argLattices.size(); ++i) {
+    // The iter args are handled by the region control flow
+    if (i >= firstIndex && i < firstIndex + numInputs)
+      continue;
+    auto *lattice = argLattices[i];
+    if (lattice->getPoint() != forOp.getInductionVar()) {
+      setToEntryState(lattice);
+      continue;
+    }
+    // Revisited once the bounds are known
+    if (lbInfo.getRank() == 0 || stepInfo.getRank() == 0)
+      continue;
+    auto divisibility =
+        gcd(lbInfo.getDivisibility(0), stepInfo.getDivisibility(0));
+    propagateIfChanged(lattice, lattice->join(AxisInfo(
+                                    /*knownContiguity=*/{1},
+                                    /*knownDivisibility=*/{divisibility},
+                                    /*knownConstancy=*/{1})));
+  }
+}
+
 void AxisInfoAnalysis::visitOperation(
     Operation *op, ArrayRef<const dataflow::Lattice<AxisInfo> *> operands,
     ArrayRef<dataflow::Lattice<AxisInfo> *> results) {
   // TODO: For sure not the right way to do this
   // but why is scf.if not initialized otherwise?
-  for (auto op : operands)
-    if (op->getValue().getRank() == 0)
-      setToEntryState((dataflow::Lattice<AxisInfo> *)op);
+  for (auto *operand : operands) {
+    if (operand->getValue().getRank() != 0)
+      continue;
+    auto *lattice = const_cast<dataflow::Lattice<AxisInfo> *>(operand);
+    // A loop-carried value starts from its initial value rather than the
+    // pessimistic state, which it could never leave: the yielded values are
+    // joined into it until the loop reaches its fixpoint. The join takes the
+    // gcd, so the fixpoint is reached after finitely many iterations.
+    if (auto arg = lattice->getPoint().dyn_cast<BlockArgument>()) {
+      auto forOp = dyn_cast<scf::ForOp>(arg.getOwner()->getParentOp());
+      if (forOp && arg != forOp.getInductionVar()) {
+        auto initInfo =
+            getLatticeElement(forOp.getIterOperands()[arg.getArgNumber() - 1])
+                ->getValue();
+        if (initInfo.getRank() != 0) {
+          propagateIfChanged(lattice, lattice->join(initInfo));
+          continue;
+        }
+      }
+    }
+    setToEntryState(lattice);
+  }
   AxisInfo curr = visitors.apply(op, operands);
   if (curr.getRank() == 0)
     return setAllToEntryStates(results);
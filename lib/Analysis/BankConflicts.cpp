@@ -0,0 +1,289 @@
+#include "triton/Analysis/BankConflicts.h"
+#include "triton/Analysis/Utility.h"
+#include "llvm/ADT/DenseSet.h"
+
+#include <algorithm>
+
+namespace mlir {
+
+using ::mlir::triton::gpu::BlockedEncodingAttr;
+using ::mlir::triton::gpu::DotOperandEncodingAttr;
+using ::mlir::triton::gpu::MmaEncodingAttr;
+using ::mlir::triton::gpu::SharedEncodingAttr;
+
+namespace {
+
+constexpr unsigned kNumBanks = 32;
+constexpr unsigned kBankBytes = 4;
+constexpr unsigned kWarpSize = 32;
+
+/// One lane's request: the byte address and the number of bytes accessed.
+using Access = std::pair<int64_t, unsigned>;
+
+/// The cost of a set of requests issued by a warp.
+struct Cost {
+  /// The largest number of replays of a single request.
+  unsigned degree = 0;
+  /// The number of replays summed over all requests.
+  unsigned wavefronts = 0;
+
+  void add(unsigned requestDegree) {
+    degree = std::max(degree, requestDegree);
+    wavefronts += requestDegree;
+  }
+};
+
+/// Returns the number of replays of the request made of `accesses`, one per
+/// lane. Requests wider than 4 bytes per lane are served in phases of 128
+/// bytes, and lanes accessing the same word get it broadcast.
+unsigned getRequestDegree(ArrayRef<Access> accesses) {
+  unsigned width = std::max(accesses.front().second, kBankBytes);
+  unsigned lanesPerPhase = std::max(1u, kNumBanks * kBankBytes / width);
+  unsigned degree = 0;
+  for (size_t begin = 0; begin < accesses.size(); begin += lanesPerPhase) {
+    SmallVector<llvm::SmallDenseSet<int64_t>, kNumBanks> words(kNumBanks);
+    size_t end = std::min(accesses.size(), begin + lanesPerPhase);
+    for (size_t i = begin; i < end; ++i) {
+      auto [addr, bytes] = accesses[i];
+      for (int64_t word = addr / kBankBytes;
+           word <= (addr + bytes - 1) / kBankBytes; ++word)
+        words[word % kNumBanks].insert(word);
+    }
+    for (auto &bank : words)
+      degree = std::max<unsigned>(degree, bank.size());
+  }
+  return degree;
+}
+
+SmallVector<unsigned> delinearize(unsigned linear, ArrayRef<unsigned> shape,
+                                  ArrayRef<unsigned> order) {
+  SmallVector<unsigned> multiDim(shape.size());
+  for (unsigned d : order) {
+    multiDim[d] = linear % shape[d];
+    linear /= shape[d];
+  }
+  return multiDim;
+}
+
+/// Returns the offset, in elements, of `coord` in shared memory, following
+/// getSwizzledSharedPtrs.
+int64_t getSharedOffset(SharedEncodingAttr sharedLayout,
+                        ArrayRef<int64_t> shape, ArrayRef<unsigned> coord,
+                        unsigned minVec) {
+  auto order = sharedLayout.getOrder();
+  unsigned outVec = sharedLayout.getVec();
+  unsigned col = coord[order[0]];
+  unsigned row = coord[order[1]];
+  unsigned phase =
+      (row / sharedLayout.getPerPhase()) % sharedLayout.getMaxPhase();
+  unsigned colOff =
+      ((col / outVec) ^ phase) * outVec + (col % outVec) / minVec * minVec;
+  return static_cast<int64_t>(row) * shape[order[0]] + colOff;
+}
+
+/// Every lane of the first warp accesses its elements `vec` at a time, at
+/// the offsets in elements given by `getOffset`.
+Cost getBlockedCost(BlockedEncodingAttr blocked, ArrayRef<int64_t> shape,
+                    unsigned vec, unsigned elemBytes,
+                    function_ref<int64_t(ArrayRef<unsigned>)> getOffset) {
+  auto sizePerThread = blocked.getSizePerThread();
+  auto threadsPerWarp = blocked.getThreadsPerWarp();
+  auto warpsPerCTA = blocked.getWarpsPerCTA();
+  auto order = blocked.getOrder();
+  auto shapePerCTA = triton::gpu::getShapePerCTA(blocked);
+  unsigned rank = shape.size();
+
+  SmallVector<unsigned> tilesPerDim(rank);
+  unsigned numTiles = 1;
+  for (unsigned d = 0; d < rank; ++d) {
+    tilesPerDim[d] = std::max<unsigned>(1, shape[d] / shapePerCTA[d]);
+    numTiles *= tilesPerDim[d];
+  }
+  unsigned totalSizePerThread = product<unsigned>(sizePerThread);
+  unsigned numElems = numTiles * totalSizePerThread;
+  unsigned numLanes = product<unsigned>(threadsPerWarp);
+
+  Cost cost;
+  for (unsigned elem = 0; elem < numElems; elem += vec) {
+    auto tile = delinearize(elem / totalSizePerThread, tilesPerDim, order);
+    auto elemInTile =
+        delinearize(elem % totalSizePerThread, sizePerThread, order);
+    SmallVector<Access> accesses;
+    for (unsigned lane = 0; lane < numLanes; ++lane) {
+      auto laneId = delinearize(lane, threadsPerWarp, order);
+      SmallVector<unsigned> coord(rank);
+      for (unsigned d = 0; d < rank; ++d)
+        coord[d] = (tile[d] * sizePerThread[d] * threadsPerWarp[d] *
+                        warpsPerCTA[d] +
+                    laneId[d] * sizePerThread[d] + elemInTile[d]) %
+                   shape[d];
+      accesses.push_back({getOffset(coord) * elemBytes, vec * elemBytes});
+    }
+    cost.add(getRequestDegree(accesses));
+  }
+  return cost;
+}
+
+/// Blocked layouts are stored with the access widths of
+/// storeDistributedToShared.
+Cost getBlockedCost(BlockedEncodingAttr blocked,
+                    SharedEncodingAttr sharedLayout, ArrayRef<int64_t> shape,
+                    unsigned elemBytes) {
+  unsigned inVec =
+      blocked.getOrder() == sharedLayout.getOrder()
+          ? triton::gpu::getContigPerThread(blocked)[blocked.getOrder()[0]]
+          : 1;
+  unsigned minVec = std::min(sharedLayout.getVec(), inVec);
+  return getBlockedCost(blocked, shape, minVec, elemBytes,
+                        [&](ArrayRef<unsigned> coord) {
+                          return getSharedOffset(sharedLayout, shape, coord,
+                                                 minVec);
+                        });
+}
+
+/// ldmatrix loads 8x8 matrices of 16-bit elements, each of which is 8 lines
+/// of 16 bytes along the strided dimension of shared memory, whose
+/// addresses are provided by 8 lanes.
+Cost getLdmatrixCost(SharedEncodingAttr sharedLayout, ArrayRef<int64_t> shape,
+                     unsigned elemBytes) {
+  constexpr unsigned kLineBytes = 16;
+  constexpr unsigned kLinesPerMatrix = 8;
+  Cost cost;
+  auto order = sharedLayout.getOrder();
+  unsigned lineElems = kLineBytes / elemBytes;
+  if (lineElems == 0 || shape[order[0]] < lineElems)
+    return cost;
+  for (unsigned col = 0; col < shape[order[0]]; col += lineElems)
+    for (unsigned row = 0; row < shape[order[1]]; row += kLinesPerMatrix) {
+      SmallVector<Access> accesses;
+      for (unsigned line = 0; line < kLinesPerMatrix; ++line) {
+        SmallVector<unsigned> coord(2);
+        coord[order[0]] = col;
+        coord[order[1]] = (row + line) % shape[order[1]];
+        int64_t offset =
+            getSharedOffset(sharedLayout, shape, coord, lineElems);
+        accesses.push_back({offset * elemBytes, kLineBytes});
+      }
+      cost.add(getRequestDegree(accesses));
+    }
+  return cost;
+}
+
+Cost getCost(Attribute distributedLayout, SharedEncodingAttr sharedLayout,
+             ArrayRef<int64_t> shape, Type elemTy) {
+  if (shape.size() != 2 || !elemTy.isIntOrFloat())
+    return Cost();
+  unsigned elemBytes = std::max(1u, elemTy.getIntOrFloatBitWidth() / 8);
+  if (auto blocked = distributedLayout.dyn_cast<BlockedEncodingAttr>()) {
+    if (product<unsigned>(blocked.getThreadsPerWarp()) != kWarpSize)
+      return Cost();
+    return getBlockedCost(blocked, sharedLayout, shape, elemBytes);
+  }
+  if (auto dotOp = distributedLayout.dyn_cast<DotOperandEncodingAttr>()) {
+    auto mma = dotOp.getParent().dyn_cast<MmaEncodingAttr>();
+    if (mma && mma.isAmpere())
+      return getLdmatrixCost(sharedLayout, shape, elemBytes);
+  }
+  return Cost();
+}
+
+} // namespace
+
+unsigned getBankConflictDegree(Attribute distributedLayout,
+                               SharedEncodingAttr sharedLayout,
+                               ArrayRef<int64_t> shape, Type elemTy) {
+  return getCost(distributedLayout, sharedLayout, shape, elemTy).degree;
+}
+
+unsigned getBankConflictDegree(Operation *op) {
+  if (auto cvt = dyn_cast<triton::gpu::ConvertLayoutOp>(op)) {
+    auto srcTy = cvt.getSrc().getType().cast<RankedTensorType>();
+    auto dstTy = cvt.getType().cast<RankedTensorType>();
+    auto srcShared = srcTy.getEncoding().dyn_cast<SharedEncodingAttr>();
+    auto dstShared = dstTy.getEncoding().dyn_cast<SharedEncodingAttr>();
+    if (dstShared && !srcShared)
+      return getBankConflictDegree(srcTy.getEncoding(), dstShared,
+                                   srcTy.getShape(), srcTy.getElementType());
+    if (srcShared && !dstShared)
+      return getBankConflictDegree(dstTy.getEncoding(), srcShared,
+                                   dstTy.getShape(), dstTy.getElementType());
+    return 0;
+  }
+  if (auto insert = dyn_cast<triton::gpu::InsertSliceAsyncOp>(op)) {
+    auto srcTy = insert.getSrc().getType().cast<RankedTensorType>();
+    auto dstTy = insert.getType().cast<RankedTensorType>();
+    auto dstShared = dstTy.getEncoding().cast<SharedEncodingAttr>();
+    return getBankConflictDegree(srcTy.getEncoding(), dstShared,
+                                 srcTy.getShape(), dstTy.getElementType());
+  }
+  return 0;
+}
+
+SharedEncodingAttr getConflictFreeSharedEncoding(Attribute distributedLayout,
+                                                 ArrayRef<int64_t> shape,
+                                                 ArrayRef<unsigned> order,
+                                                 Type elemTy) {
+  auto *ctx = distributedLayout.getContext();
+  auto best = SharedEncodingAttr::get(ctx, 1, 1, 1, order);
+  auto bestCost = getCost(distributedLayout, best, shape, elemTy);
+  if (bestCost.degree <= 1)
+    return best;
+  // Try every swizzle that fits in the contiguous dimension, and keep the
+  // one with the fewest wavefronts, i.e. requests times their replays
+  unsigned contig = shape[order[0]];
+  for (unsigned vec = 1; vec <= contig; vec *= 2)
+    for (unsigned perPhase = 1; perPhase <= 8; perPhase *= 2)
+      for (unsigned maxPhase = 2; vec * maxPhase <= contig && maxPhase <= 32;
+           maxPhase *= 2) {
+        auto candidate =
+            SharedEncodingAttr::get(ctx, vec, perPhase, maxPhase, order);
+        auto cost = getCost(distributedLayout, candidate, shape, elemTy);
+        if (cost.wavefronts < bestCost.wavefronts) {
+          best = candidate;
+          bestCost = cost;
+        }
+      }
+  return best;
+}
+
+SharedEncodingAttr getScratchSwizzle(BlockedEncodingAttr srcLayout,
+                                     BlockedEncodingAttr dstLayout,
+                                     ArrayRef<unsigned> repShape,
+                                     ArrayRef<unsigned> order, unsigned inVec,
+                                     unsigned outVec, unsigned pad,
+                                     unsigned elemBytes) {
+  if (repShape.size() != 2 ||
+      product<unsigned>(srcLayout.getThreadsPerWarp()) != kWarpSize ||
+      product<unsigned>(dstLayout.getThreadsPerWarp()) != kWarpSize)
+    return {};
+  SmallVector<int64_t> shape(repShape.begin(), repShape.end());
+  auto getWavefronts = [&](function_ref<int64_t(ArrayRef<unsigned>)> offset) {
+    return getBlockedCost(srcLayout, shape, inVec, elemBytes, offset)
+               .wavefronts +
+           getBlockedCost(dstLayout, shape, outVec, elemBytes, offset)
+               .wavefronts;
+  };
+  unsigned bestWavefronts = getWavefronts([&](ArrayRef<unsigned> coord) {
+    return static_cast<int64_t>(coord[order[1]]) * (shape[order[0]] + pad) +
+           coord[order[0]];
+  });
+  // Groups of the widest access keep each access contiguous
+  unsigned vec = std::max(inVec, outVec);
+  SharedEncodingAttr best;
+  for (unsigned perPhase = 1; perPhase <= shape[order[1]]; perPhase *= 2)
+    for (unsigned maxPhase = 2; vec * maxPhase <= shape[order[0]];
+         maxPhase *= 2) {
+      auto candidate = SharedEncodingAttr::get(srcLayout.getContext(), vec,
+                                               perPhase, maxPhase, order);
+      unsigned wavefronts = getWavefronts([&](ArrayRef<unsigned> coord) {
+        return getSharedOffset(candidate, shape, coord, 1);
+      });
+      if (wavefronts < bestWavefronts) {
+        best = candidate;
+        bestWavefronts = wavefronts;
+      }
+    }
+  return best;
+}
+
+} // namespace mlir
@@ -18,10 +18,14 @@ LogicalResult MaskState::parse(Value operand, const Location loc,
                                ConversionPatternRewriter &rewriter) {
   if (auto op = operand.getDefiningOp<arith::ConstantOp>()) {
     return this->parseConstant(op, loc, rewriter);
-  } else if (operand.getType().isa<IntegerType>()) {
+  } else if (operand.getType().isa<IntegerType, IndexType>()) {
     return this->parseIntScalar(operand, loc, rewriter);
   } else if (auto op = operand.getDefiningOp<arith::AddIOp>()) {
     return this->parseAdd(op, loc, rewriter);
+  } else if (auto op = operand.getDefiningOp<arith::SubIOp>()) {
+    return this->parseSub(op, loc, rewriter);
+  } else if (auto op = operand.getDefiningOp<arith::MulIOp>()) {
+    return this->parseMul(op, loc, rewriter);
   } else if (auto op = operand.getDefiningOp<arith::AndIOp>()) {
     return this->parseAnd(op, loc, rewriter);
   } else if (auto op = operand.getDefiningOp<arith::CmpIOp>()) {
@@ -43,7 +47,6 @@ tensor::ExtractSliceOp
 MaskState::getExtractSlice(Value source, const Location loc,
                            ConversionPatternRewriter &rewriter) const {
   auto sourceType = source.getType().cast<RankedTensorType>();
-  SmallVector<OpFoldResult> offsets(getRank(), rewriter.getIndexAttr(0));
   SmallVector<OpFoldResult> strides(getRank(), rewriter.getIndexAttr(1));
 
   auto dstType = tensor::ExtractSliceOp::inferResultType(sourceType, offsets,
@@ -57,7 +60,6 @@ memref::SubViewOp
 MaskState::getSubview(Value source, const Location loc,
                       ConversionPatternRewriter &rewriter) const {
   auto sourceType = source.getType().cast<MemRefType>();
-  SmallVector<OpFoldResult> offsets(getRank(), rewriter.getIndexAttr(0));
   SmallVector<OpFoldResult> strides(getRank(), rewriter.getIndexAttr(1));
   auto dstType =
       memref::SubViewOp::inferResultType(sourceType, offsets, dims, strides);
@@ -71,7 +73,9 @@ LogicalResult MaskState::addStateScalar(const MaskState &state,
                                         ConversionPatternRewriter &rewriter) {
   start = addOFRs(state.start, scalar, loc, rewriter);
   end = addOFRs(state.end, scalar, loc, rewriter);
+  rangeDim = state.rangeDim;
   dims = state.dims;
+  offsets = state.offsets;
   return success();
 }
 
@@ -79,9 +83,10 @@ LogicalResult MaskState::addStates(const MaskState &lhsState,
                                    const MaskState &rhsState, Location loc,
                                    ConversionPatternRewriter &rewriter) {
   if (lhsState.scalar && rhsState.scalar) {
-    InFlightDiagnostic diag =
-        emitError(loc) << "Unexpected case where both lhs and rhs are scalars";
-    return failure();
+    scalar = addOFRs(lhsState.scalar, rhsState.scalar, loc, rewriter);
+    dims = lhsState.dims;
+    offsets = lhsState.offsets;
+    return success();
   }
 
   if (!lhsState.scalar && !rhsState.scalar) {
@@ -97,6 +102,48 @@ LogicalResult MaskState::addStates(const MaskState &lhsState,
     return addStateScalar(lhsState, rhsState.scalar, loc, rewriter);
 }
 
+LogicalResult MaskState::subStates(const MaskState &lhsState,
+                                   const MaskState &rhsState, Location loc,
+                                   ConversionPatternRewriter &rewriter) {
+  if (!rhsState.scalar) {
+    InFlightDiagnostic diag =
+        emitError(loc) << "Unsupported scenario where rhs is not a scalar";
+    return failure();
+  }
+
+  if (lhsState.scalar) {
+    scalar = subOFRs(lhsState.scalar, rhsState.scalar, loc, rewriter);
+    dims = lhsState.dims;
+    offsets = lhsState.offsets;
+    return success();
+  }
+
+  start = subOFRs(lhsState.start, rhsState.scalar, loc, rewriter);
+  end = subOFRs(lhsState.end, rhsState.scalar, loc, rewriter);
+  rangeDim = lhsState.rangeDim;
+  dims = lhsState.dims;
+  offsets = lhsState.offsets;
+  return success();
+}
+
+LogicalResult MaskState::mulStates(const MaskState &lhsState,
+                                   const MaskState &rhsState, Location loc,
+                                   ConversionPatternRewriter &rewriter) {
+  if (!lhsState.scalar || !rhsState.scalar) {
+    InFlightDiagnostic diag =
+        emitError(loc) << "Unsupported scenario where lhs or rhs is not a "
+                          "scalar";
+    return failure();
+  }
+
+  scalar = mulOFRValue(lhsState.scalar,
+                       ofrToIndexValue(rhsState.scalar, loc, rewriter), loc,
+                       rewriter);
+  dims = lhsState.dims;
+  offsets = lhsState.offsets;
+  return success();
+}
+
 LogicalResult MaskState::minStates(const MaskState &lhsState,
                                    const MaskState &rhsState, Location loc,
                                    ConversionPatternRewriter &rewriter) {
@@ -107,10 +154,25 @@ LogicalResult MaskState::minStates(const MaskState &lhsState,
     return failure();
   }
 
+  // Intersect [offset, offset + dim) of both states in every dimension. The
+  // offsets of both states lie within [0, tile size], and so does their
+  // maximum.
   for (uint32_t i = 0; i < lhsState.getRank(); i++) {
-    auto lhsDim = lhsState.dims[i];
-    auto rhsDim = rhsState.dims[i];
-    dims.push_back(minOFRs(lhsDim, rhsDim, loc, rewriter));
+    auto lhsOffset = lhsState.offsets[i];
+    auto rhsOffset = rhsState.offsets[i];
+    auto newOffset = maxOFRs(lhsOffset, rhsOffset, loc, rewriter);
+    auto newEnd =
+        minOFRs(addOFRs(lhsOffset, lhsState.dims[i], loc, rewriter),
+                addOFRs(rhsOffset, rhsState.dims[i], loc, rewriter), loc,
+                rewriter);
+    auto newDim = subOFRs(newEnd, newOffset, loc, rewriter);
+    // Intervals that both start at 0 intersect in the shorter one, but
+    // disjoint windows, e.g. of a lower and an upper bound, intersect in an
+    // empty one
+    if (getIntAttr(newOffset) != 0)
+      newDim = maxOFRs(newDim, rewriter.getIndexAttr(0), loc, rewriter);
+    offsets.push_back(newOffset);
+    dims.push_back(newDim);
   }
   return success();
 }
@@ -142,6 +204,10 @@ LogicalResult MaskState::parseConstant(arith::ConstantOp constOp,
 LogicalResult MaskState::parseIntScalar(Value scalar, const Location loc,
                                         ConversionPatternRewriter &rewriter) {
   assert(this->isEmpty());
+  if (scalar.getType().isa<IndexType>()) {
+    this->scalar = scalar;
+    return success();
+  }
   auto castOp =
       rewriter.create<arith::IndexCastOp>(loc, rewriter.getIndexType(), scalar);
   this->scalar = castOp.getResult();
@@ -163,6 +229,36 @@ LogicalResult MaskState::parseAdd(arith::AddIOp addOp, const Location loc,
   return this->addStates(lhsState, rhsState, loc, rewriter);
 }
 
+LogicalResult MaskState::parseSub(arith::SubIOp subOp, const Location loc,
+                                  ConversionPatternRewriter &rewriter) {
+  assert(this->isEmpty());
+
+  MaskState lhsState;
+  if (failed(lhsState.parse(subOp.getLhs(), loc, rewriter)))
+    return failure();
+
+  MaskState rhsState;
+  if (failed(rhsState.parse(subOp.getRhs(), loc, rewriter)))
+    return failure();
+
+  return this->subStates(lhsState, rhsState, loc, rewriter);
+}
+
+LogicalResult MaskState::parseMul(arith::MulIOp mulOp, const Location loc,
+                                  ConversionPatternRewriter &rewriter) {
+  assert(this->isEmpty());
+
+  MaskState lhsState;
+  if (failed(lhsState.parse(mulOp.getLhs(), loc, rewriter)))
+    return failure();
+
+  MaskState rhsState;
+  if (failed(rhsState.parse(mulOp.getRhs(), loc, rewriter)))
+    return failure();
+
+  return this->mulStates(lhsState, rhsState, loc, rewriter);
+}
+
 LogicalResult MaskState::parseAnd(arith::AndIOp andOp, const Location loc,
                                   ConversionPatternRewriter &rewriter) {
   assert(this->isEmpty());
@@ -180,15 +276,34 @@ LogicalResult MaskState::parseAnd(arith::AndIOp andOp, const Location loc,
   return this->minStates(lhsState, rhsState, loc, rewriter);
 }
 
+// Return the predicate p' such that (rhs p' lhs) == (lhs p rhs).
+static arith::CmpIPredicate swapPredicate(arith::CmpIPredicate predicate) {
+  switch (predicate) {
+  case arith::CmpIPredicate::slt:
+    return arith::CmpIPredicate::sgt;
+  case arith::CmpIPredicate::sle:
+    return arith::CmpIPredicate::sge;
+  case arith::CmpIPredicate::sgt:
+    return arith::CmpIPredicate::slt;
+  case arith::CmpIPredicate::sge:
+    return arith::CmpIPredicate::sle;
+  case arith::CmpIPredicate::ult:
+    return arith::CmpIPredicate::ugt;
+  case arith::CmpIPredicate::ule:
+    return arith::CmpIPredicate::uge;
+  case arith::CmpIPredicate::ugt:
+    return arith::CmpIPredicate::ult;
+  case arith::CmpIPredicate::uge:
+    return arith::CmpIPredicate::ule;
+  default:
+    return predicate;
+  }
+}
+
 LogicalResult MaskState::parseCmp(arith::CmpIOp cmpOp, const Location loc,
                                   ConversionPatternRewriter &rewriter) {
   assert(this->isEmpty());
 
-  if (cmpOp.getPredicate() != arith::CmpIPredicate::slt) {
-    InFlightDiagnostic diag = emitError(loc) << "Unsupported cmpi predicate";
-    return failure();
-  }
-
   MaskState lhsState;
   if (failed(lhsState.parse(cmpOp.getLhs(), loc, rewriter)))
     return failure();
@@ -197,32 +312,72 @@ LogicalResult MaskState::parseCmp(arith::CmpIOp cmpOp, const Location loc,
   if (failed(rhsState.parse(cmpOp.getRhs(), loc, rewriter)))
     return failure();
 
-  assert((!lhsState.scalar && rhsState.scalar) && "Unsupported cmpi scenario");
+  // Canonicalize to range <predicate> scalar
+  auto predicate = cmpOp.getPredicate();
+  if (lhsState.scalar && !rhsState.scalar) {
+    std::swap(lhsState, rhsState);
+    predicate = swapPredicate(predicate);
+  }
 
-  int32_t cmpDim = -1;
-  for (int32_t i = 0; i < lhsState.getRank(); i++) {
-    auto dimIntAttr = getIntAttr(lhsState.dims[i]);
-    if (!dimIntAttr || dimIntAttr.value() != 1) {
-      if (cmpDim != -1) {
-        InFlightDiagnostic diag = emitError(loc)
-                                  << "Unsupported cmpi with more than one "
-                                     "dimension with size larger than 1";
-        return failure();
-      }
-      cmpDim = i;
-    }
+  if (lhsState.scalar || !rhsState.scalar) {
+    InFlightDiagnostic diag = emitError(loc) << "Unsupported cmpi scenario";
+    return failure();
   }
-  assert(cmpDim != -1 &&
-         "Unexpected case where no dimension has size larger than 1");
 
-  auto newEnd = minOFRs(lhsState.end, rhsState.scalar, loc, rewriter);
-  auto newDim = subOFRs(newEnd, lhsState.start, loc, rewriter);
+  // The other dimensions, of size 1 or broadcast, are kept whole
+  int64_t cmpDim = lhsState.rangeDim;
+  assert(cmpDim >= 0 && cmpDim < lhsState.getRank() &&
+         "Unexpected case where the range has no dimension");
+
+  OpFoldResult newOffset = rewriter.getIndexAttr(0);
+  OpFoldResult newDim;
+  switch (predicate) {
+  case arith::CmpIPredicate::slt:
+  case arith::CmpIPredicate::ult:
+  case arith::CmpIPredicate::sle:
+  case arith::CmpIPredicate::ule: {
+    // Upper bound: range < bound, or range < bound + 1
+    auto bound = rhsState.scalar;
+    if (predicate == arith::CmpIPredicate::sle ||
+        predicate == arith::CmpIPredicate::ule)
+      bound = addOFRs(bound, rewriter.getIndexAttr(1), loc, rewriter);
+    auto newEnd = minOFRs(lhsState.end, bound, loc, rewriter);
+    newDim = subOFRs(newEnd, lhsState.start, loc, rewriter);
+    break;
+  }
+  case arith::CmpIPredicate::sge:
+  case arith::CmpIPredicate::uge:
+  case arith::CmpIPredicate::sgt:
+  case arith::CmpIPredicate::ugt: {
+    // Lower bound: range >= bound, or range >= bound + 1
+    auto bound = rhsState.scalar;
+    if (predicate == arith::CmpIPredicate::sgt ||
+        predicate == arith::CmpIPredicate::ugt)
+      bound = addOFRs(bound, rewriter.getIndexAttr(1), loc, rewriter);
+    // Clamp the start to the range, so that the offset stays within
+    // [0, tile size] and the tile is empty when it lies entirely below the
+    // bound
+    auto newStart =
+        minOFRs(maxOFRs(lhsState.start, bound, loc, rewriter), lhsState.end,
+                loc, rewriter);
+    newOffset = subOFRs(newStart, lhsState.start, loc, rewriter);
+    newDim = subOFRs(lhsState.end, newStart, loc, rewriter);
+    break;
+  }
+  default: {
+    InFlightDiagnostic diag = emitError(loc) << "Unsupported cmpi predicate";
+    return failure();
+  }
+  }
 
-  for (int32_t i = 0; i < lhsState.getRank(); i++) {
-    if (i == cmpDim)
+  for (int64_t i = 0; i < lhsState.getRank(); i++) {
+    if (i == cmpDim) {
+      this->offsets.push_back(newOffset);
       this->dims.push_back(newDim);
-    else
+    } else {
+      this->offsets.push_back(lhsState.offsets[i]);
       this->dims.push_back(lhsState.dims[i]);
+    }
   }
 
   return success();
@@ -248,7 +403,9 @@ LogicalResult MaskState::parseMakeRange(triton::MakeRangeOp rangeOp,
 
   this->start = rewriter.getIndexAttr(start);
   this->end = rewriter.getIndexAttr(end);
+  this->rangeDim = 0;
   this->dims.push_back(rewriter.getIndexAttr(shape[0]));
+  this->offsets.push_back(rewriter.getIndexAttr(0));
 
   return success();
 }
@@ -271,12 +428,30 @@ LogicalResult MaskState::parseBroadcast(triton::BroadcastOp broadcastOp,
   if (failed(parse(src, loc, rewriter)))
     return failure();
 
+  // A compared dimension of size 1, e.g. along the batch of an N-D tile, keeps
+  // none or all of the broadcast elements. Its dim is min(1, bound - start),
+  // which is negative when the bound is below the start, so it is clamped to
+  // [0, 1] before it is scaled by the broadcast size
   for (size_t i = 0; i < srcShape.size(); i++) {
     if (srcShape[i] == dstShape[i])
       continue;
-    else if (srcShape[i] < dstShape[i])
-      this->dims[i] = rewriter.getIndexAttr(dstShape[i]);
-    else
+    else if (srcShape[i] < dstShape[i]) {
+      if (this->start && this->rangeDim == static_cast<int64_t>(i)) {
+        InFlightDiagnostic diag =
+            emitError(loc) << "Unsupported broadcast of a range along its "
+                              "own dimension";
+        return failure();
+      }
+      auto dstDim = rewriter.getIndexAttr(dstShape[i]);
+      auto dim = minOFRs(
+          maxOFRs(this->dims[i], rewriter.getIndexAttr(0), loc, rewriter),
+          rewriter.getIndexAttr(1), loc, rewriter);
+      if (auto staticDim = getIntAttr(dim))
+        this->dims[i] = rewriter.getIndexAttr(staticDim.value() * dstShape[i]);
+      else
+        this->dims[i] = mulOFRValue(dstDim, dim.get<Value>(), loc, rewriter);
+      this->offsets[i] = rewriter.getIndexAttr(0);
+    } else
       llvm_unreachable("unexpected dimensions used in broadcast");
   }
 
@@ -298,11 +473,29 @@ LogicalResult MaskState::parseSplat(triton::SplatOp splatOp, const Location loc,
     return failure();
   }
 
+  // A condition on scalars, e.g. on the program ids, masks the whole tile or
+  // nothing; emptying its first dimension empties it
+  if (src.getType().isInteger(1)) {
+    for (auto s : dstShape) {
+      this->dims.push_back(rewriter.getIndexAttr(s));
+      this->offsets.push_back(rewriter.getIndexAttr(0));
+    }
+    if (!dstShape.empty()) {
+      Value full = ofrToIndexValue(this->dims[0], loc, rewriter);
+      Value none = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+      this->dims[0] =
+          rewriter.create<arith::SelectOp>(loc, src, full, none).getResult();
+    }
+    return success();
+  }
+
   if (failed(this->parse(src, loc, rewriter)))
     return failure();
 
-  for (auto s : dstShape)
+  for (auto s : dstShape) {
     this->dims.push_back(rewriter.getIndexAttr(s));
+    this->offsets.push_back(rewriter.getIndexAttr(0));
+  }
 
   return success();
 }
@@ -321,6 +514,9 @@ LogicalResult MaskState::parseExpandDims(triton::ExpandDimsOp expandDimsOp,
   assert(dstShape[axis] == 1 &&
          "expect changed dimension to be 1 in expand_dims");
   this->dims.insert(this->dims.begin() + axis, rewriter.getIndexAttr(1));
+  this->offsets.insert(this->offsets.begin() + axis, rewriter.getIndexAttr(0));
+  if (this->rangeDim >= static_cast<int64_t>(axis))
+    this->rangeDim++;
 
   return success();
 }
@@ -5,14 +5,129 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/GPU/IR/GPUDialect.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/Matchers.h"
 #include <deque>
 
 namespace mlir {
 
+namespace {
+
+int64_t floorMod(int64_t value, int64_t modulus) {
+  return ((value % modulus) + modulus) % modulus;
+}
+
+/// Decomposes `value` into base + offset, with a null base for constants.
+std::pair<Value, int64_t> getLinearExpr(Value value) {
+  int64_t offset = 0;
+  while (true) {
+    APInt constant;
+    if (matchPattern(value, m_ConstantInt(&constant)))
+      return {Value(), offset + constant.getSExtValue()};
+    if (auto addOp = value.getDefiningOp<arith::AddIOp>()) {
+      if (matchPattern(addOp.getRhs(), m_ConstantInt(&constant))) {
+        offset += constant.getSExtValue();
+        value = addOp.getLhs();
+        continue;
+      }
+      if (matchPattern(addOp.getLhs(), m_ConstantInt(&constant))) {
+        offset += constant.getSExtValue();
+        value = addOp.getRhs();
+        continue;
+      }
+    }
+    if (auto subOp = value.getDefiningOp<arith::SubIOp>()) {
+      if (matchPattern(subOp.getRhs(), m_ConstantInt(&constant))) {
+        offset -= constant.getSExtValue();
+        value = subOp.getLhs();
+        continue;
+      }
+    }
+    return {value, offset};
+  }
+}
+
+/// Returns the value `pred` passes to `arg`, or null if it is unknown or
+/// differs between the edges from `pred`.
+Value getIncomingValue(Block *pred, BlockArgument arg) {
+  auto branch = dyn_cast<BranchOpInterface>(pred->getTerminator());
+  if (!branch)
+    return Value();
+  Value incoming;
+  for (unsigned i = 0; i < branch->getNumSuccessors(); ++i) {
+    if (branch->getSuccessor(i) != arg.getOwner())
+      continue;
+    Value value = branch.getSuccessorOperands(i)[arg.getArgNumber()];
+    if (!value || (incoming && incoming != value))
+      return Value();
+    incoming = value;
+  }
+  return incoming;
+}
+
+/// Returns d such that lhs - rhs == d (mod modulus) every time their block
+/// is entered. The difference has to be set by at least one edge and
+/// preserved by all the others, e.g. the back edge of a loop that bumps
+/// both arguments by the same amount.
+std::optional<int64_t> getArgDifference(BlockArgument lhs, BlockArgument rhs,
+                                        int64_t modulus) {
+  std::optional<int64_t> difference;
+  for (Block *pred : lhs.getOwner()->getPredecessors()) {
+    Value lhsIncoming = getIncomingValue(pred, lhs);
+    Value rhsIncoming = getIncomingValue(pred, rhs);
+    if (!lhsIncoming || !rhsIncoming)
+      return std::nullopt;
+    auto [lhsBase, lhsOffset] = getLinearExpr(lhsIncoming);
+    auto [rhsBase, rhsOffset] = getLinearExpr(rhsIncoming);
+    if (lhsBase == rhsBase) {
+      int64_t edgeDifference = floorMod(lhsOffset - rhsOffset, modulus);
+      if (difference && *difference != edgeDifference)
+        return std::nullopt;
+      difference = edgeDifference;
+    } else if (lhsBase != lhs || rhsBase != rhs ||
+               floorMod(lhsOffset - rhsOffset, modulus) != 0) {
+      return std::nullopt;
+    }
+  }
+  return difference;
+}
+
+/// Returns the buffer that `value` is the result of inserting slices into.
+Value getInsertedBuffer(Value value) {
+  while (true) {
+    if (auto insertOp = value.getDefiningOp<tensor::InsertSliceOp>())
+      value = insertOp.getDest();
+    else if (auto insertOp =
+                 value.getDefiningOp<triton::gpu::InsertSliceAsyncOp>())
+      value = insertOp.getDst();
+    else
+      return value;
+  }
+}
+
+} // namespace
+
 void MembarAnalysis::run() {
   auto *operation = allocation->getOperation();
   OpBuilder builder(operation);
   resolve(operation, &builder);
+  // Barriers may still have been required before some of these operations
+  // by other accesses
+  for (auto *op : elidedBarrierOps) {
+    auto *prevOp = op->getPrevNode();
+    if (!prevOp || !isa<gpu::BarrierOp>(prevOp))
+      ++numRemovedBarriers;
+  }
+  // Fold adjacent barriers
+  SmallVector<gpu::BarrierOp> redundantBarriers;
+  operation->walk([&](gpu::BarrierOp barrier) {
+    auto *prevOp = barrier->getPrevNode();
+    if (prevOp && isa<gpu::BarrierOp>(prevOp))
+      redundantBarriers.push_back(barrier);
+  });
+  for (auto barrier : redundantBarriers)
+    barrier->erase();
+  numRemovedBarriers += redundantBarriers.size();
 }
 
 void MembarAnalysis::resolve(Operation *operation, OpBuilder *builder) {
@@ -57,13 +172,204 @@ void MembarAnalysis::resolve(Operation *operation, OpBuilder *builder) {
     // Update the current block
     outputBlockInfoMap[block].join(inputBlockInfo);
     // Update the successors
-    for (auto *successor : successors) {
-      inputBlockInfoMap[successor].join(outputBlockInfoMap[block]);
-      blockList.emplace_back(successor);
+    for (unsigned i = 0; i < successors.size(); ++i) {
+      inputBlockInfoMap[successors[i]].join(
+          translate(outputBlockInfoMap[block], block, i));
+      blockList.emplace_back(successors[i]);
     }
   }
 }
 
+MembarAnalysis::BlockInfo
+MembarAnalysis::translate(const BlockInfo &blockInfo, Block *block,
+                          unsigned successorIndex) {
+  Block *successor = block->getSuccessor(successorIndex);
+  auto branch = dyn_cast<BranchOpInterface>(block->getTerminator());
+  auto translateSlot = [&](const Slot &slot) -> std::optional<Slot> {
+    // The base keeps its value unless the successor defines it
+    if (!slot.base || slot.base.getParentBlock() != successor)
+      return slot;
+    if (!branch)
+      return std::nullopt;
+    auto operands = branch.getSuccessorOperands(successorIndex);
+    for (BlockArgument arg : successor->getArguments()) {
+      Value incoming = operands[arg.getArgNumber()];
+      if (!incoming)
+        continue;
+      auto [base, offset] = getLinearExpr(incoming);
+      if (base == slot.base) {
+        Slot newSlot = slot;
+        newSlot.base = arg;
+        newSlot.offset = floorMod(slot.offset - offset, slot.numSlots);
+        return newSlot;
+      }
+    }
+    return std::nullopt;
+  };
+  BlockInfo result(blockInfo.syncReadBuffers, blockInfo.syncWriteBuffers);
+  auto translateSlots = [&](const BlockInfo::SlotMapT &slots,
+                            BlockInfo::SlotMapT &newSlots,
+                            BlockInfo::BufferIdSetT &buffers) {
+    for (auto &[bufferId, slotSet] : slots)
+      for (auto &slot : slotSet) {
+        if (auto newSlot = translateSlot(slot))
+          newSlots[bufferId].insert(*newSlot);
+        else
+          buffers.insert(bufferId);
+      }
+  };
+  translateSlots(blockInfo.syncReadSlots, result.syncReadSlots,
+                 result.syncReadBuffers);
+  translateSlots(blockInfo.syncWriteSlots, result.syncWriteSlots,
+                 result.syncWriteBuffers);
+  return result;
+}
+
+std::optional<MembarAnalysis::Slot>
+MembarAnalysis::getSlotOfIndex(OpFoldResult index, int64_t numSlots) {
+  if (auto attr = index.dyn_cast<Attribute>())
+    return Slot{Value(), floorMod(attr.cast<IntegerAttr>().getInt(), numSlots),
+                numSlots};
+  Value value = index.get<Value>();
+  // A slot index is in [0, numSlots), so the modulo does not change it
+  APInt divisor;
+  if (auto remOp = value.getDefiningOp<arith::RemSIOp>()) {
+    if (matchPattern(remOp.getRhs(), m_ConstantInt(&divisor)) &&
+        divisor.getSExtValue() == numSlots)
+      value = remOp.getLhs();
+  } else if (auto remOp = value.getDefiningOp<arith::RemUIOp>()) {
+    if (matchPattern(remOp.getRhs(), m_ConstantInt(&divisor)) &&
+        divisor.getSExtValue() == numSlots)
+      value = remOp.getLhs();
+  }
+  auto [base, offset] = getLinearExpr(value);
+  return Slot{base, floorMod(offset, numSlots), numSlots};
+}
+
+std::optional<MembarAnalysis::Slot> MembarAnalysis::getSlot(Value value,
+                                                            unsigned depth) {
+  // Bounds the search through block arguments forwarding each other
+  if (depth > 4)
+    return std::nullopt;
+  auto tensorType = value.getType().dyn_cast<RankedTensorType>();
+  if (!tensorType)
+    return std::nullopt;
+  if (auto arg = value.dyn_cast<BlockArgument>())
+    return getBlockArgSlot(arg, depth);
+  auto extractOp = value.getDefiningOp<triton::gpu::ExtractSliceOp>();
+  if (!extractOp)
+    return std::nullopt;
+  return getSlotOfSlice(extractOp.getSource(), tensorType,
+                        extractOp.getMixedOffsets(), extractOp.getMixedSizes(),
+                        extractOp.getMixedStrides(), depth);
+}
+
+std::optional<MembarAnalysis::Slot> MembarAnalysis::getSlotOfSlice(
+    Value source, RankedTensorType sliceType, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, ArrayRef<OpFoldResult> strides,
+    unsigned depth) {
+  auto srcType = source.getType().cast<RankedTensorType>();
+  int64_t rank = sliceType.getRank();
+  std::optional<Slot> slot;
+  unsigned firstDim = 0;
+  if (srcType.getRank() == rank + 1) {
+    // A single slot along axis 0
+    auto size = getConstantIntValue(sizes[0]);
+    if (!size || *size != 1)
+      return std::nullopt;
+    slot = getSlotOfIndex(offsets[0], srcType.getShape()[0]);
+    slot->lower.assign(rank, 0);
+    slot->upper.assign(srcType.getShape().begin() + 1,
+                       srcType.getShape().end());
+    firstDim = 1;
+  } else if (srcType.getRank() == rank) {
+    // A slice of a slot, or of a buffer without slots
+    slot = getSlot(source, depth + 1);
+    if (!slot && allocation->getBufferId(getInsertedBuffer(source)) !=
+                     Allocation::InvalidBufferId) {
+      slot = Slot();
+      slot->lower.assign(rank, 0);
+      slot->upper.assign(srcType.getShape().begin(), srcType.getShape().end());
+    }
+  }
+  if (!slot)
+    return std::nullopt;
+  // The ranges of the slice within those of the source, if they are known
+  for (int64_t i = 0; i < rank; ++i) {
+    auto offset = getConstantIntValue(offsets[firstDim + i]);
+    auto size = getConstantIntValue(sizes[firstDim + i]);
+    auto stride = getConstantIntValue(strides[firstDim + i]);
+    if (slot->lower.size() != static_cast<size_t>(rank) || !offset || !size ||
+        !stride || *stride != 1) {
+      slot->lower.clear();
+      slot->upper.clear();
+      return slot;
+    }
+    slot->lower[i] += *offset;
+    slot->upper[i] = slot->lower[i] + *size;
+  }
+  return slot;
+}
+
+std::optional<MembarAnalysis::Slot>
+MembarAnalysis::getBlockArgSlot(BlockArgument arg, unsigned depth) {
+  Block *block = arg.getOwner();
+  if (block->hasNoPredecessors())
+    return std::nullopt;
+  // Looks for an integer argument `candidate` such that the slot passed to
+  // `arg` is candidate + c on every edge
+  for (BlockArgument candidate : block->getArguments()) {
+    if (!candidate.getType().isIntOrIndex())
+      continue;
+    std::optional<Slot> result;
+    bool consistent = true;
+    for (Block *pred : block->getPredecessors()) {
+      Value incoming = getIncomingValue(pred, arg);
+      Value candidateIncoming = getIncomingValue(pred, candidate);
+      std::optional<Slot> slot;
+      if (incoming && candidateIncoming)
+        slot = getSlot(incoming, depth + 1);
+      if (!slot) {
+        consistent = false;
+        break;
+      }
+      auto [base, offset] = getLinearExpr(candidateIncoming);
+      Slot edgeSlot{candidate, floorMod(slot->offset - offset, slot->numSlots),
+                    slot->numSlots};
+      if (slot->base != base || (result && !(*result == edgeSlot))) {
+        consistent = false;
+        break;
+      }
+      result = edgeSlot;
+    }
+    if (consistent && result)
+      return result;
+  }
+  return std::nullopt;
+}
+
+bool MembarAnalysis::isDisjoint(const Slot &lhs, const Slot &rhs) {
+  if (lhs.numSlots != rhs.numSlots)
+    return false;
+  // Disjoint ranges along any dimension do not overlap, whichever the slots
+  if (!lhs.lower.empty() && lhs.lower.size() == rhs.lower.size())
+    for (size_t i = 0; i < lhs.lower.size(); ++i)
+      if (lhs.upper[i] <= rhs.lower[i] || rhs.upper[i] <= lhs.lower[i])
+        return true;
+  int64_t numSlots = lhs.numSlots;
+  if (lhs.base == rhs.base)
+    return floorMod(lhs.offset - rhs.offset, numSlots) != 0;
+  if (!lhs.base || !rhs.base)
+    return false;
+  auto lhsArg = lhs.base.dyn_cast<BlockArgument>();
+  auto rhsArg = rhs.base.dyn_cast<BlockArgument>();
+  if (!lhsArg || !rhsArg || lhsArg.getOwner() != rhsArg.getOwner())
+    return false;
+  auto difference = getArgDifference(lhsArg, rhsArg, numSlots);
+  return difference &&
+         floorMod(*difference + lhs.offset - rhs.offset, numSlots) != 0;
+}
+
 void MembarAnalysis::visitTerminator(Operation *op,
                                      SmallVector<Block *> &successors) {
   if (auto branchInterface = dyn_cast<BranchOpInterface>(op)) {
@@ -83,7 +389,8 @@ void MembarAnalysis::visitTerminator(Operation *op,
 void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
                             OpBuilder *builder) {
   if (isa<triton::gpu::ExtractSliceOp>(op) ||
-      isa<triton::gpu::AllocTensorOp>(op) || isa<triton::TransOp>(op)) {
+      isa<triton::gpu::AllocTensorOp>(op) ||
+      isa<triton::gpu::AllocMBarrierOp>(op) || isa<triton::TransOp>(op)) {
     // alloc is an allocation op without memory write.
     // FIXME(Keren): extract_slice is always alias for now
     return;
@@ -109,16 +416,56 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
 
   BlockInfo curBlockInfo;
   for (Value value : op->getOperands()) {
-    for (auto bufferId : allocation->getBufferIds(value)) {
+    // mbarriers synchronize the threads by themselves
+    if (auto insertOp = dyn_cast<triton::gpu::InsertSliceTMAOp>(op))
+      if (value == insertOp.getBarriers())
+        continue;
+    if (isa<triton::gpu::MBarrierWaitOp>(op))
+      continue;
+    auto bufferIds = allocation->getBufferIds(value);
+    if (bufferIds.empty() ||
+        llvm::all_of(bufferIds, [](auto bufferId) {
+          return bufferId == Allocation::InvalidBufferId;
+        }))
+      continue;
+    bool isWrite = isa<triton::gpu::InsertSliceAsyncOp>(op) ||
+                   isa<triton::gpu::InsertSliceTMAOp>(op) ||
+                   isa<tensor::InsertSliceOp>(op);
+    // insert_slice_async writes and reads through extract_slice touch a
+    // single slot of the buffer, and insert_slice writes a slice of it
+    std::optional<Slot> slot;
+    if (auto insertOp = dyn_cast<triton::gpu::InsertSliceAsyncOp>(op)) {
+      if (value == insertOp.getDst() && insertOp.getAxis() == 0)
+        slot = getSlotOfIndex(
+            insertOp.getIndex(),
+            value.getType().cast<RankedTensorType>().getShape()[0]);
+    } else if (auto insertOp = dyn_cast<triton::gpu::InsertSliceTMAOp>(op)) {
+      if (value == insertOp.getDst())
+        slot = getSlotOfIndex(
+            insertOp.getIndex(),
+            value.getType().cast<RankedTensorType>().getShape()[0]);
+    } else if (auto insertOp = dyn_cast<tensor::InsertSliceOp>(op)) {
+      if (value == insertOp.getDest())
+        slot = getSlotOfSlice(value, insertOp.getSourceType(),
+                              insertOp.getMixedOffsets(),
+                              insertOp.getMixedSizes(),
+                              insertOp.getMixedStrides());
+    } else if (!isWrite) {
+      slot = getSlot(value);
+    }
+    for (auto bufferId : bufferIds) {
       if (bufferId != Allocation::InvalidBufferId) {
-        if (isa<triton::gpu::InsertSliceAsyncOp>(op) ||
-            isa<tensor::InsertSliceOp>(op)) {
-          // FIXME(Keren): insert_slice and insert_slice_async are always
-          // alias for now
-          curBlockInfo.syncWriteBuffers.insert(bufferId);
+        if (isWrite) {
+          if (slot)
+            curBlockInfo.syncWriteSlots[bufferId].insert(*slot);
+          else
+            curBlockInfo.syncWriteBuffers.insert(bufferId);
         } else {
           // ConvertLayoutOp: shared memory -> registers
-          curBlockInfo.syncReadBuffers.insert(bufferId);
+          if (slot)
+            curBlockInfo.syncReadSlots[bufferId].insert(*slot);
+          else
+            curBlockInfo.syncReadBuffers.insert(bufferId);
         }
       }
     }
@@ -137,11 +484,18 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
     curBlockInfo.syncReadBuffers.insert(bufferId);
   }
 
-  if (blockInfo->isIntersected(curBlockInfo, allocation)) {
+  auto isDisjoint = [&](const Slot &lhs, const Slot &rhs) {
+    return this->isDisjoint(lhs, rhs);
+  };
+  if (blockInfo->isIntersected(curBlockInfo, allocation, isDisjoint)) {
     OpBuilder::InsertionGuard g(*builder);
     builder->setInsertionPoint(op);
     builder->create<gpu::BarrierOp>(op->getLoc());
     blockInfo->sync();
+  } else if (blockInfo->isIntersected(
+                 curBlockInfo, allocation,
+                 [](const Slot &, const Slot &) { return false; })) {
+    elidedBarrierOps.insert(op);
   }
   // Update the region info, even if barrier is inserted, we have to maintain
   // the current op's read/write buffers.
@@ -7,6 +7,7 @@
 #include "triton/Analysis/OpFoldResultUtils.h"
 
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Support/MathExtras.h"
 #include "mlir/Transforms/DialectConversion.h"
 
 namespace mlir {
@@ -114,19 +115,18 @@ OpFoldResult mulOFRValue(const OpFoldResult lhs, const Value rhs,
     rhsConstValue = rhsOp.getValue().cast<IntegerAttr>().getInt();
   }
 
-  // shortcuts for special cases
+  // shortcuts for special cases; multiplying by a constant 1 keeps a static
+  // lhs static, e.g. a unit stride
+  if (rhsIsConst && rhsConstValue == 1)
+    return lhs;
   if (lhsIntAttr) {
     if (lhsIntAttr.value() == 0)
       return lhs;
     if (lhsIntAttr.value() == 1)
       return rhs;
   }
-  if (rhsIsConst) {
-    if (rhsConstValue == 0)
-      return rhsOp.getResult();
-    if (rhsConstValue == 1)
-      return lhs;
-  }
+  if (rhsIsConst && rhsConstValue == 0)
+    return rhsOp.getResult();
 
   // 0. both lhs and rhs are constants
   if (lhsIntAttr && rhsIsConst)
@@ -176,4 +176,72 @@ OpFoldResult minOFRs(const OpFoldResult lhs, const OpFoldResult rhs,
   return minOp.getResult();
 }
 
+OpFoldResult maxOFRs(const OpFoldResult lhs, const OpFoldResult rhs,
+                     const Location loc, ConversionPatternRewriter &rewriter) {
+  auto lhsIntAttr = getIntAttr(lhs);
+  auto rhsIntAttr = getIntAttr(rhs);
+
+  // both lhs and rhs are constants, return result directly
+  if (lhsIntAttr && rhsIntAttr)
+    return rewriter.getIndexAttr(
+        std::max(lhsIntAttr.value(), rhsIntAttr.value()));
+
+  // otherwise, need to create instructions to calculate new attribute value
+  auto lhsValue = ofrToIndexValue(lhs, loc, rewriter);
+  auto rhsValue = ofrToIndexValue(rhs, loc, rewriter);
+  auto maxOp = rewriter.create<arith::MaxSIOp>(loc, lhsValue, rhsValue);
+  return maxOp.getResult();
+}
+
+OpFoldResult remOFRs(const OpFoldResult lhs, const OpFoldResult rhs,
+                     const Location loc, ConversionPatternRewriter &rewriter) {
+  auto lhsIntAttr = getIntAttr(lhs);
+  auto rhsIntAttr = getIntAttr(rhs);
+
+  // both lhs and rhs are constants, return result directly
+  if (lhsIntAttr && rhsIntAttr)
+    return rewriter.getIndexAttr(lhsIntAttr.value() % rhsIntAttr.value());
+
+  // otherwise, need to create instructions to calculate new attribute value
+  auto lhsValue = ofrToIndexValue(lhs, loc, rewriter);
+  auto rhsValue = ofrToIndexValue(rhs, loc, rewriter);
+  auto remOp = rewriter.create<arith::RemSIOp>(loc, lhsValue, rhsValue);
+  return remOp.getResult();
+}
+
+OpFoldResult ceilDivOFRs(const OpFoldResult lhs, const OpFoldResult rhs,
+                         const Location loc,
+                         ConversionPatternRewriter &rewriter) {
+  auto lhsIntAttr = getIntAttr(lhs);
+  auto rhsIntAttr = getIntAttr(rhs);
+
+  // shortcut for special cases
+  if (rhsIntAttr && rhsIntAttr.value() == 1)
+    return lhs;
+
+  // both lhs and rhs are constants, return result directly
+  if (lhsIntAttr && rhsIntAttr)
+    return rewriter.getIndexAttr(
+        ceilDiv(lhsIntAttr.value(), rhsIntAttr.value()));
+
+  // otherwise, need to create instructions to calculate new attribute value
+  auto lhsValue = ofrToIndexValue(lhs, loc, rewriter);
+  auto rhsValue = ofrToIndexValue(rhs, loc, rewriter);
+  auto divOp = rewriter.create<arith::CeilDivSIOp>(loc, lhsValue, rhsValue);
+  return divOp.getResult();
+}
+
+Value ofrToIndexValue(const OpFoldResult ofr, const Location loc,
+                      ConversionPatternRewriter &rewriter) {
+  if (auto intAttr = getIntAttr(ofr)) {
+    auto constOp = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getIndexAttr(intAttr.value()));
+    return constOp.getResult();
+  }
+
+  auto value = ofr.get<Value>();
+  assert(value.getType().isa<IndexType>());
+  return value;
+}
+
 } // namespace mlir
@@ -7,10 +7,14 @@
 #include "triton/Analysis/PtrAnalysis.h"
 #include "triton/Analysis/OpFoldResultUtils.h"
 
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "mlir/Transforms/DialectConversion.h"
 
 #include "llvm/Support/Debug.h"
+#include <numeric>
 #include <set>
 
 #define DEBUG_TYPE "triton-ptr-analysis"
@@ -25,7 +29,7 @@ int64_t PtrState::getRank() const {
 }
 
 bool PtrState::isEmpty() const {
-  return (getRank() == 0 && !source && !scalar);
+  return (getRank() == 0 && !source && !scalar && !gatherIndices);
 }
 
 void PtrState::addState(const PtrState &lhsState, const PtrState &rhsState,
@@ -37,6 +41,20 @@ void PtrState::addState(const PtrState &lhsState, const PtrState &rhsState,
   assert(!(lhsState.source && rhsState.source));
   source = lhsState.source ? lhsState.source : rhsState.source;
 
+  assert(!(lhsState.isGather() && rhsState.isGather()) &&
+         "currently does not support adding two gathers");
+  const PtrState &gatherState = lhsState.isGather() ? lhsState : rhsState;
+  gatherIndices = gatherState.gatherIndices;
+  gatherDim = gatherState.gatherDim;
+  gatherScale = gatherState.gatherScale;
+
+  assert(!(lhsState.isWrapped() && rhsState.isWrapped()) &&
+         "currently does not support adding two wrap-around offsets");
+  const PtrState &wrapState = lhsState.isWrapped() ? lhsState : rhsState;
+  wrapDim = wrapState.wrapDim;
+  wrapStart = wrapState.wrapStart;
+  wrapBound = wrapState.wrapBound;
+
   if (lhsState.scalar && rhsState.scalar) {
     auto addOp =
         rewriter.create<arith::AddIOp>(loc, lhsState.scalar, rhsState.scalar);
@@ -77,6 +95,20 @@ void PtrState::mulState(const PtrState &lhsState, const PtrState &rhsState,
   if (!rhsState.scalar && lhsState.scalar)
     rhsScalar = false;
 
+  const PtrState &tensorState = rhsScalar ? lhsState : rhsState;
+  Value scalarFactor = rhsScalar ? rhsState.scalar : lhsState.scalar;
+  if (tensorState.isGather()) {
+    gatherIndices = tensorState.gatherIndices;
+    gatherDim = tensorState.gatherDim;
+    gatherScale =
+        mulOFRValue(tensorState.gatherScale, scalarFactor, loc, rewriter);
+  }
+  if (tensorState.isWrapped()) {
+    wrapDim = tensorState.wrapDim;
+    wrapStart = mulOFRValue(tensorState.wrapStart, scalarFactor, loc, rewriter);
+    wrapBound = mulOFRValue(tensorState.wrapBound, scalarFactor, loc, rewriter);
+  }
+
   for (uint64_t i = 0; i < lhsState.sizes.size(); i++) {
     OpFoldResult newOffset;
     OpFoldResult newStride;
@@ -97,11 +129,52 @@ void PtrState::mulState(const PtrState &lhsState, const PtrState &rhsState,
   }
 }
 
+// Largest power of two, up to 2^30, known to divide v. Divisibility of kernel
+// arguments comes from their tt.divisibility attribute, e.g. as set by the JIT
+// for arguments divisible by 16.
+static int64_t getKnownDivisor(Value v) {
+  constexpr int64_t maxDivisor = int64_t(1) << 30;
+
+  if (auto castOp = v.getDefiningOp<UnrealizedConversionCastOp>())
+    return getKnownDivisor(castOp.getInputs()[0]);
+  if (auto castOp = v.getDefiningOp<arith::IndexCastOp>())
+    return getKnownDivisor(castOp.getIn());
+
+  APInt value;
+  if (matchPattern(v, m_ConstantInt(&value)))
+    return std::gcd(value.getSExtValue(), maxDivisor);
+  if (auto addOp = v.getDefiningOp<arith::AddIOp>())
+    return std::min(getKnownDivisor(addOp.getLhs()),
+                    getKnownDivisor(addOp.getRhs()));
+  if (auto mulOp = v.getDefiningOp<arith::MulIOp>())
+    return std::gcd(getKnownDivisor(mulOp.getLhs()) *
+                        getKnownDivisor(mulOp.getRhs()),
+                    maxDivisor);
+
+  auto arg = v.dyn_cast<BlockArgument>();
+  if (!arg)
+    return 1;
+  auto funcOp =
+      dyn_cast_or_null<FunctionOpInterface>(arg.getOwner()->getParentOp());
+  if (!funcOp || !arg.getOwner()->isEntryBlock())
+    return 1;
+  auto divisibility = funcOp.getArgAttrOfType<IntegerAttr>(arg.getArgNumber(),
+                                                           "tt.divisibility");
+  return divisibility ? std::gcd(divisibility.getInt(), maxDivisor) : 1;
+}
+
+static int64_t getKnownDivisor(OpFoldResult ofr) {
+  if (auto value = ofr.dyn_cast<Value>())
+    return getKnownDivisor(value);
+  return std::gcd(getIntAttr(ofr).value(), int64_t(1) << 30);
+}
+
 memref::ReinterpretCastOp
 PtrState::createCastOp(ArrayRef<int64_t> resultShape, const Location loc,
                        ConversionPatternRewriter &rewriter) {
   // Accumulate final offset
-  OpFoldResult targetOffset = rewriter.getIndexAttr(0);
+  OpFoldResult targetOffset =
+      baseOffset ? baseOffset : rewriter.getIndexAttr(0);
   for (auto o : offsets)
     targetOffset = addOFRs(targetOffset, o, loc, rewriter);
 
@@ -119,19 +192,112 @@ PtrState::createCastOp(ArrayRef<int64_t> resultShape, const Location loc,
   auto resultType = MemRefType::get(resultShape, elementType, layout);
 
   // Create reinterpret cast
-  return rewriter.create<memref::ReinterpretCastOp>(
+  auto castOp = rewriter.create<memref::ReinterpretCastOp>(
       loc, resultType, source, targetOffset, sizes, strides);
+
+  // Tag the cast with the alignment in bytes of its first element when it is
+  // known to exceed that of the element type. Loads and stores through the
+  // cast turn it into a memref.assume_alignment for downstream passes.
+  int64_t elemBytes = elementType.getIntOrFloatBitWidth() / 8;
+  if (elemBytes > 0) {
+    int64_t alignment = std::gcd(getKnownDivisor(source),
+                                 getKnownDivisor(targetOffset) * elemBytes);
+    if (alignment > elemBytes)
+      castOp->setAttr("Alignment", rewriter.getI64IntegerAttr(alignment));
+  }
+
+  return castOp;
+}
+
+// Check whether v is visible at the insertion point (block, ip), i.e. v is
+// defined in block or one of its ancestors, before ip or the op enclosing it.
+static bool isAvailableAt(Value v, Block *block, Block::iterator ip) {
+  Block *defBlock = v.getParentBlock();
+  while (block != defBlock) {
+    Operation *parentOp = block->getParentOp();
+    if (!parentOp || !parentOp->getBlock())
+      return false;
+    block = parentOp->getBlock();
+    ip = Block::iterator(parentOp);
+  }
+
+  if (v.isa<BlockArgument>() || ip == block->end())
+    return true;
+  return v.getDefiningOp()->isBeforeInBlock(&*ip);
+}
+
+// Check whether all the values state refers to are visible at the insertion
+// point of builder.
+static bool isStateAvailable(const PtrState &state, const OpBuilder &builder) {
+  Block *block = builder.getInsertionBlock();
+  auto ip = builder.getInsertionPoint();
+  if (!block)
+    return false;
+
+  auto isAvailable = [&](Value val) {
+    return !val || isAvailableAt(val, block, ip);
+  };
+  auto isAvailableOFR = [&](OpFoldResult ofr) {
+    return isAvailable(ofr.dyn_cast<Value>());
+  };
+
+  return isAvailable(state.source) && isAvailable(state.scalar) &&
+         isAvailable(state.gatherIndices) &&
+         (!state.gatherScale || isAvailableOFR(state.gatherScale)) &&
+         (!state.wrapStart || isAvailableOFR(state.wrapStart)) &&
+         (!state.wrapBound || isAvailableOFR(state.wrapBound)) &&
+         (!state.baseOffset || isAvailableOFR(state.baseOffset)) &&
+         llvm::all_of(state.offsets, isAvailableOFR) &&
+         llvm::all_of(state.sizes, isAvailableOFR) &&
+         llvm::all_of(state.strides, isAvailableOFR) &&
+         llvm::all_of(state.shape, isAvailableOFR);
+}
+
+std::optional<PtrState> PtrStateCache::lookup(Value v,
+                                              const OpBuilder &builder) const {
+  auto it = states.find(v);
+  if (it == states.end() || !isStateAvailable(it->second, builder))
+    return std::nullopt;
+  return it->second;
+}
+
+std::optional<PtrState>
+PtrStateCache::lookupBlockPtr(Value v, const OpBuilder &builder) const {
+  auto it = blockPtrStates.find(v);
+  if (it == blockPtrStates.end() || !isStateAvailable(it->second, builder))
+    return std::nullopt;
+  return it->second;
+}
+
+void PtrStateCache::insertBlockPtr(Value v, const PtrState &state) {
+  std::optional<PtrState> replaced;
+  if (auto it = blockPtrStates.find(v); it != blockPtrStates.end())
+    replaced = it->second;
+  blockPtrLog.emplace_back(v, std::move(replaced));
+  blockPtrStates[v] = state;
+}
+
+void PtrStateCache::rollback(size_t mark) {
+  states.clear();
+  while (blockPtrLog.size() > mark) {
+    auto [v, replaced] = blockPtrLog.pop_back_val();
+    if (replaced)
+      blockPtrStates[v] = *replaced;
+    else
+      blockPtrStates.erase(v);
+  }
 }
 
 void PtrAnalysis::visitOperandAdd(
     arith::AddIOp addOp, PtrState &state, const Location loc,
     ConversionPatternRewriter &rewriter,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
   PtrState lhsState;
-  visitOperand(addOp.getLhs(), lhsState, loc, rewriter, knownPtrs);
+  visitOperand(addOp.getLhs(), lhsState, loc, rewriter, knownPtrs, cache);
 
   PtrState rhsState;
-  visitOperand(addOp.getRhs(), rhsState, loc, rewriter, knownPtrs);
+  visitOperand(addOp.getRhs(), rhsState, loc, rewriter, knownPtrs, cache);
 
   state.addState(lhsState, rhsState, loc, rewriter);
 }
@@ -139,12 +305,13 @@ void PtrAnalysis::visitOperandAdd(
 void PtrAnalysis::visitOperandMul(
     arith::MulIOp mulOp, PtrState &state, const Location loc,
     ConversionPatternRewriter &rewriter,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
   PtrState lhsState;
-  visitOperand(mulOp.getLhs(), lhsState, loc, rewriter, knownPtrs);
+  visitOperand(mulOp.getLhs(), lhsState, loc, rewriter, knownPtrs, cache);
 
   PtrState rhsState;
-  visitOperand(mulOp.getRhs(), rhsState, loc, rewriter, knownPtrs);
+  visitOperand(mulOp.getRhs(), rhsState, loc, rewriter, knownPtrs, cache);
 
   state.mulState(lhsState, rhsState, loc, rewriter);
 }
@@ -152,7 +319,8 @@ void PtrAnalysis::visitOperandMul(
 void PtrAnalysis::visitOperandMakeRange(
     triton::MakeRangeOp rangeOp, PtrState &state, Location loc,
     ConversionPatternRewriter &rewriter,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
   assert(state.isEmpty());
 
   auto shape = rangeOp.getType().cast<ShapedType>().getShape();
@@ -169,10 +337,11 @@ void PtrAnalysis::visitOperandMakeRange(
 void PtrAnalysis::visitOperandExpandDims(
     triton::ExpandDimsOp expandDimsOp, PtrState &state, const Location loc,
     ConversionPatternRewriter &rewriter,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
   assert(state.isEmpty());
 
-  visitOperand(expandDimsOp.getSrc(), state, loc, rewriter, knownPtrs);
+  visitOperand(expandDimsOp.getSrc(), state, loc, rewriter, knownPtrs, cache);
 
   auto dstShape =
       expandDimsOp.getResult().getType().cast<ShapedType>().getShape();
@@ -185,12 +354,73 @@ void PtrAnalysis::visitOperandExpandDims(
   state.offsets.insert(state.offsets.begin() + axis, rewriter.getIndexAttr(0));
   state.sizes.insert(state.sizes.begin() + axis, rewriter.getIndexAttr(1));
   state.strides.insert(state.strides.begin() + axis, rewriter.getIndexAttr(0));
+
+  if (state.isGather() && state.gatherDim >= axis)
+    state.gatherDim++;
+  if (state.isWrapped() && state.wrapDim >= axis)
+    state.wrapDim++;
+}
+
+void PtrAnalysis::visitOperandRem(
+    Operation *remOp, PtrState &state, const Location loc,
+    ConversionPatternRewriter &rewriter,
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
+  assert(state.isEmpty());
+  assert((isa<arith::RemSIOp, arith::RemUIOp>(remOp)));
+
+  PtrState lhsState;
+  visitOperand(remOp->getOperand(0), lhsState, loc, rewriter, knownPtrs, cache);
+
+  PtrState rhsState;
+  visitOperand(remOp->getOperand(1), rhsState, loc, rewriter, knownPtrs, cache);
+
+  assert(rhsState.scalar && "only support remainder by a scalar");
+  assert(!lhsState.source && !lhsState.isGather() && !lhsState.isWrapped() &&
+         "unsupported dividend for remainder");
+
+  // Splat of a scalar: take the remainder of the scalar itself.
+  if (lhsState.scalar) {
+    auto remScalar = rewriter.create<arith::RemSIOp>(loc, lhsState.scalar,
+                                                     rhsState.scalar);
+    state.scalar = remScalar.getResult();
+    for (int64_t i = 0; i < lhsState.getRank(); i++) {
+      state.offsets.push_back(i == 0 ? OpFoldResult(state.scalar)
+                                     : rewriter.getIndexAttr(0));
+      state.sizes.push_back(lhsState.sizes[i]);
+      state.strides.push_back(lhsState.strides[i]);
+    }
+    return;
+  }
+
+  int64_t wrapDim = -1;
+  OpFoldResult start = rewriter.getIndexAttr(0);
+  for (int64_t i = 0; i < lhsState.getRank(); i++) {
+    start = addOFRs(start, lhsState.offsets[i], loc, rewriter);
+    if (getIntAttr(lhsState.strides[i]) == 0)
+      continue;
+    assert(wrapDim == -1 &&
+           "only support remainder of a range along a single dimension");
+    wrapDim = i;
+  }
+  assert(wrapDim != -1 && "expect a range along one dimension");
+
+  start = remOFRs(start, rhsState.scalar, loc, rewriter);
+  for (int64_t i = 0; i < lhsState.getRank(); i++) {
+    state.offsets.push_back(i == wrapDim ? start : rewriter.getIndexAttr(0));
+    state.sizes.push_back(lhsState.sizes[i]);
+    state.strides.push_back(lhsState.strides[i]);
+  }
+  state.wrapDim = wrapDim;
+  state.wrapStart = start;
+  state.wrapBound = rhsState.scalar;
 }
 
 void PtrAnalysis::visitOperandBroadcast(
     triton::BroadcastOp broadcastOp, PtrState &state, const Location loc,
     ConversionPatternRewriter &rewriter,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
   assert(state.isEmpty());
 
   auto src = broadcastOp.getSrc();
@@ -203,14 +433,17 @@ void PtrAnalysis::visitOperandBroadcast(
   assert(srcShape.size() == dstShape.size() &&
          "rank of source and destination should match");
 
-  visitOperand(src, state, loc, rewriter, knownPtrs);
+  visitOperand(src, state, loc, rewriter, knownPtrs, cache);
 
+  // Every element along a broadcast dimension is the single element of the
+  // source, e.g. of a range of size 1 indexing the batch of an N-D tile
   for (size_t i = 0; i < srcShape.size(); i++) {
     if (srcShape[i] == dstShape[i])
       continue;
-    else if (srcShape[i] < dstShape[i])
+    else if (srcShape[i] < dstShape[i]) {
       state.sizes[i] = rewriter.getIndexAttr(dstShape[i]);
-    else
+      state.strides[i] = rewriter.getIndexAttr(0);
+    } else
       llvm_unreachable("unexpected dimensions used in broadcast");
   }
 
@@ -220,14 +453,15 @@ void PtrAnalysis::visitOperandBroadcast(
 void PtrAnalysis::visitOperandSplat(
     triton::SplatOp splatOp, PtrState &state, const Location loc,
     ConversionPatternRewriter &rewriter,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
   assert(state.isEmpty());
 
   auto src = splatOp.getSrc();
   auto dst = splatOp.getResult();
   auto dstShape = dst.getType().cast<ShapedType>().getShape();
 
-  visitOperand(src, state, loc, rewriter, knownPtrs);
+  visitOperand(src, state, loc, rewriter, knownPtrs, cache);
 
   if (src.getType().isa<IntegerType>() ||
       src.getType().isa<triton::PointerType>()) {
@@ -274,16 +508,17 @@ void PtrAnalysis::visitOperandSplat(
 void PtrAnalysis::visitOperandAddptr(
     triton::AddPtrOp addptrOp, PtrState &state, const Location loc,
     ConversionPatternRewriter &rewriter,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
   assert(state.isEmpty());
 
   PtrState ptrState;
   visitOperand(addptrOp.getPtr(), ptrState, addptrOp.getLoc(), rewriter,
-               knownPtrs);
+               knownPtrs, cache);
 
   PtrState offsetState;
   visitOperand(addptrOp.getOffset(), offsetState, addptrOp.getLoc(), rewriter,
-               knownPtrs);
+               knownPtrs, cache);
 
   assert(ptrState.source && "ptr field should provide source / base pointer");
 
@@ -304,10 +539,93 @@ void PtrAnalysis::visitOperandAddptr(
   state.addState(ptrState, offsetState, addptrOp.getLoc(), rewriter);
 }
 
+// Shape of the block a tensor pointer type points to.
+static ArrayRef<int64_t> getBlockShape(Type type) {
+  return type.cast<triton::PointerType>()
+      .getPointeeType()
+      .cast<RankedTensorType>()
+      .getShape();
+}
+
+void PtrAnalysis::visitOperandMakeTensorPtr(
+    triton::MakeTensorPtrOp makeTensorPtrOp, PtrState &state,
+    const Location loc, ConversionPatternRewriter &rewriter,
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
+  assert(state.isEmpty());
+
+  PtrState baseState;
+  visitOperand(makeTensorPtrOp.getBase(), baseState, loc, rewriter, knownPtrs,
+               cache);
+  assert(baseState.source && baseState.getRank() == 0 &&
+         "base of a block pointer should be a scalar pointer");
+  state.source = baseState.source;
+  if (baseState.scalar)
+    state.baseOffset = baseState.scalar;
+
+  // Constant strides, e.g. a unit stride of the innermost dimension, are kept
+  // static in the layout of the block.
+  auto visitScalar = [&](Value v) -> OpFoldResult {
+    PtrState scalarState;
+    visitOperand(v, scalarState, loc, rewriter, knownPtrs, cache);
+    return getAsOpFoldResult(scalarState.scalar);
+  };
+
+  auto blockShape = getBlockShape(makeTensorPtrOp.getResult().getType());
+  for (auto [i, size] : llvm::enumerate(blockShape)) {
+    auto stride = visitScalar(makeTensorPtrOp.getStrides()[i]);
+    auto offset = visitScalar(makeTensorPtrOp.getOffsets()[i]);
+    state.sizes.push_back(rewriter.getIndexAttr(size));
+    state.strides.push_back(stride);
+    state.offsets.push_back(mulOFRValue(
+        stride, ofrToIndexValue(offset, loc, rewriter), loc, rewriter));
+    state.shape.push_back(visitScalar(makeTensorPtrOp.getShape()[i]));
+  }
+}
+
+void PtrAnalysis::visitOperandAdvance(
+    triton::AdvanceOp advanceOp, PtrState &state, const Location loc,
+    ConversionPatternRewriter &rewriter,
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
+  assert(state.isEmpty());
+
+  visitOperand(advanceOp.getPtr(), state, loc, rewriter, knownPtrs, cache);
+  assert(state.isBlockPtr() && "advance expects a block pointer");
+
+  for (auto [i, offset] : llvm::enumerate(advanceOp.getOffsets())) {
+    PtrState offsetState;
+    visitOperand(offset, offsetState, loc, rewriter, knownPtrs, cache);
+    state.offsets[i] = addOFRs(
+        state.offsets[i],
+        mulOFRValue(state.strides[i], offsetState.scalar, loc, rewriter), loc,
+        rewriter);
+  }
+}
+
+void PtrAnalysis::visitOperandGatherIndices(
+    triton::LoadOp loadOp, PtrState &state, const Location loc,
+    ConversionPatternRewriter &rewriter) {
+  assert(state.isEmpty());
+
+  auto shape = loadOp.getResult().getType().cast<ShapedType>().getShape();
+  assert(shape.size() == 1 && "only 1-D index tensors are supported in gathers");
+
+  state.gatherIndices = rewriter.getRemappedValue(loadOp.getResult());
+  assert(state.gatherIndices && "index tensor should be converted before use");
+  state.gatherDim = 0;
+  state.gatherScale = rewriter.getIndexAttr(1);
+
+  state.offsets.push_back(rewriter.getIndexAttr(0));
+  state.sizes.push_back(rewriter.getIndexAttr(shape[0]));
+  state.strides.push_back(rewriter.getIndexAttr(0));
+}
+
 void PtrAnalysis::visitOperandReintCast(
     memref::ReinterpretCastOp reintCastOp, PtrState &state, const Location loc,
     ConversionPatternRewriter &rewriter,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
   assert(state.isEmpty());
 
   state.offsets = reintCastOp.getMixedOffsets();
@@ -326,21 +644,79 @@ void PtrAnalysis::visitOperandReintCast(
 void PtrAnalysis::visitOperand(
     Value operand, PtrState &state, const Location loc,
     ConversionPatternRewriter &rewriter,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
 
   if (knownPtrs.find(operand) != knownPtrs.end()) {
     state = knownPtrs.lookup(operand);
     return;
   }
 
+  if (cache) {
+    if (auto blockPtr = cache->lookupBlockPtr(operand, rewriter)) {
+      state = *blockPtr;
+      return;
+    }
+    if (auto cached = cache->lookup(operand, rewriter)) {
+      cache->recordHit();
+      state = *cached;
+      return;
+    }
+    cache->recordMiss();
+  }
+
+  visitOperandImpl(operand, state, loc, rewriter, knownPtrs, cache);
+
+  if (cache)
+    cache->insert(operand, state);
+}
+
+void PtrAnalysis::visitOperandImpl(
+    Value operand, PtrState &state, const Location loc,
+    ConversionPatternRewriter &rewriter,
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
+
   if (operand.getType().isa<IntegerType>()) {
+    // Keep constants, e.g. arguments the JIT specialized to 1, recognizable so
+    // that the strides they produce stay static.
+    APInt value;
+    if (matchPattern(operand, m_ConstantInt(&value))) {
+      state.scalar = rewriter.create<arith::ConstantOp>(
+          loc, rewriter.getIndexAttr(value.getSExtValue()));
+      return;
+    }
+
     auto castOp = rewriter.create<arith::IndexCastOp>(
         loc, rewriter.getIndexType(), operand);
     state.scalar = castOp.getResult();
     return;
   }
 
+  // Pointers produced by loops and branches were replaced by a view built
+  // from the offsets and strides carried along with them.
+  if (isa<triton::PointerType>(getElementTypeOrSelf(operand.getType())) &&
+      isa_and_nonnull<scf::ForOp, scf::WhileOp, scf::IfOp>(
+          operand.getDefiningOp())) {
+    assert(!triton::isTensorPointerType(operand.getType()) &&
+           "block pointer states are expected in the cache");
+    auto castOp = rewriter.getRemappedValue(operand)
+                      .getDefiningOp<memref::ReinterpretCastOp>();
+    assert(castOp && "expected a carried pointer to be rewritten");
+    visitOperandReintCast(castOp, state, loc, rewriter, knownPtrs, cache);
+    return;
+  }
+
   if (operand.getType().isa<triton::PointerType>()) {
+    if (auto op = operand.getDefiningOp<triton::MakeTensorPtrOp>()) {
+      visitOperandMakeTensorPtr(op, state, loc, rewriter, knownPtrs, cache);
+      return;
+    }
+    if (auto op = operand.getDefiningOp<triton::AdvanceOp>()) {
+      visitOperandAdvance(op, state, loc, rewriter, knownPtrs, cache);
+      return;
+    }
+
     auto remappedPtr = rewriter.getRemappedValue(operand);
     assert(remappedPtr);
 
@@ -349,7 +725,7 @@ void PtrAnalysis::visitOperand(
       assert(operand.getDefiningOp<triton::AddPtrOp>() &&
              "Assume only addptr can produce a scalar pointer");
       visitOperandAddptr(cast<triton::AddPtrOp>(op), state, loc, rewriter,
-                         knownPtrs);
+                         knownPtrs, cache);
     } else {
       state.source = remappedPtr;
     }
@@ -357,21 +733,27 @@ void PtrAnalysis::visitOperand(
   }
 
   if (auto op = operand.getDefiningOp<arith::AddIOp>()) {
-    visitOperandAdd(op, state, loc, rewriter, knownPtrs);
+    visitOperandAdd(op, state, loc, rewriter, knownPtrs, cache);
   } else if (auto op = operand.getDefiningOp<arith::MulIOp>()) {
-    visitOperandMul(op, state, loc, rewriter, knownPtrs);
+    visitOperandMul(op, state, loc, rewriter, knownPtrs, cache);
   } else if (auto op = operand.getDefiningOp<triton::MakeRangeOp>()) {
-    visitOperandMakeRange(op, state, loc, rewriter, knownPtrs);
+    visitOperandMakeRange(op, state, loc, rewriter, knownPtrs, cache);
   } else if (auto op = operand.getDefiningOp<triton::BroadcastOp>()) {
-    visitOperandBroadcast(op, state, loc, rewriter, knownPtrs);
+    visitOperandBroadcast(op, state, loc, rewriter, knownPtrs, cache);
   } else if (auto op = operand.getDefiningOp<triton::SplatOp>()) {
-    visitOperandSplat(op, state, loc, rewriter, knownPtrs);
+    visitOperandSplat(op, state, loc, rewriter, knownPtrs, cache);
   } else if (auto op = operand.getDefiningOp<triton::ExpandDimsOp>()) {
-    visitOperandExpandDims(op, state, loc, rewriter, knownPtrs);
+    visitOperandExpandDims(op, state, loc, rewriter, knownPtrs, cache);
   } else if (auto op = operand.getDefiningOp<triton::AddPtrOp>()) {
-    visitOperandAddptr(op, state, loc, rewriter, knownPtrs);
+    visitOperandAddptr(op, state, loc, rewriter, knownPtrs, cache);
   } else if (auto op = operand.getDefiningOp<arith::ConstantOp>()) {
-    visitOperandConstSplat(op, state, loc, rewriter, knownPtrs);
+    visitOperandConstSplat(op, state, loc, rewriter, knownPtrs, cache);
+  } else if (isa_and_nonnull<arith::RemSIOp, arith::RemUIOp>(
+                 operand.getDefiningOp())) {
+    visitOperandRem(operand.getDefiningOp(), state, loc, rewriter, knownPtrs,
+                    cache);
+  } else if (auto op = operand.getDefiningOp<triton::LoadOp>()) {
+    visitOperandGatherIndices(op, state, loc, rewriter);
   } else {
     operand.getDefiningOp()->dump();
     llvm_unreachable("encountered addptr operand produced by an "
@@ -382,7 +764,8 @@ void PtrAnalysis::visitOperand(
 void PtrAnalysis::visitOperandConstSplat(
     arith::ConstantOp op, PtrState &state, const Location loc,
     ConversionPatternRewriter &rewriter,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
   assert(state.isEmpty());
   // this condition is to handle cases where tt.broadcast and tt.splat are
   // folded
@@ -412,13 +795,13 @@ void PtrAnalysis::visitOperandConstSplat(
 
 void PtrAnalysis::rewriteAddptrOp(
     triton::AddPtrOp op, ConversionPatternRewriter &rewriter,
-    llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    llvm::SmallDenseMap<Value, PtrState> &knownPtrs, PtrStateCache *cache) {
   // any inserted instruction should be before this addptr
   auto origIp = rewriter.saveInsertionPoint();
   rewriter.setInsertionPoint(op);
 
   PtrState state;
-  visitOperandAddptr(op, state, op.getLoc(), rewriter, knownPtrs);
+  visitOperandAddptr(op, state, op.getLoc(), rewriter, knownPtrs, cache);
 
   // If the result is a scalar pointer, visitOperandAddptr will not populate
   // sizes, strides, and offsets. We need to do it here.
@@ -452,6 +835,14 @@ void PtrAnalysis::rewriteAddptrOp(
   }
 
   auto castOp = state.createCastOp(resultShape, op.getLoc(), rewriter);
+  // The cast only describes the regular part of gathers and wrap-around
+  // offsets; tag it so that loads through it re-analyze the full pointer.
+  assert(!(state.isGather() && state.isWrapped()) &&
+         "gathers with wrap-around offsets are not supported");
+  if (state.isGather())
+    castOp->setAttr("Gather", UnitAttr::get(rewriter.getContext()));
+  if (state.isWrapped())
+    castOp->setAttr("Wrap", UnitAttr::get(rewriter.getContext()));
   LLVM_DEBUG({
     llvm::dbgs() << "cast MemRefType:\n";
     castOp.getOperation()->print(llvm::dbgs(),
@@ -467,10 +858,42 @@ void PtrAnalysis::rewriteAddptrOp(
   rewriter.restoreInsertionPoint(origIp);
 }
 
+void PtrAnalysis::rewriteBlockPtrOp(
+    Operation *op, ConversionPatternRewriter &rewriter,
+    llvm::SmallDenseMap<Value, PtrState> &knownPtrs, PtrStateCache *cache) {
+  // any inserted instruction should be before this op
+  OpBuilder::InsertionGuard insertionGuard{rewriter};
+  rewriter.setInsertionPoint(op);
+
+  PtrState state;
+  if (auto makeTensorPtrOp = dyn_cast<triton::MakeTensorPtrOp>(op))
+    visitOperandMakeTensorPtr(makeTensorPtrOp, state, op->getLoc(), rewriter,
+                              knownPtrs, cache);
+  else
+    visitOperandAdvance(cast<triton::AdvanceOp>(op), state, op->getLoc(),
+                        rewriter, knownPtrs, cache);
+
+  auto result = op->getResult(0);
+  auto castOp = state.createCastOp(getBlockShape(result.getType()),
+                                   op->getLoc(), rewriter);
+  LLVM_DEBUG({
+    llvm::dbgs() << "block pointer cast:\n";
+    castOp.getOperation()->print(llvm::dbgs(),
+                                 OpPrintingFlags().printGenericOpForm());
+    llvm::dbgs() << "\n";
+  });
+  rewriter.replaceOp(op, castOp.getResult());
+
+  knownPtrs[result] = state;
+  if (cache)
+    cache->insertBlockPtr(result, state);
+}
+
 void PtrAnalysis::rewriteYieldOp(
     scf::YieldOp op, ConversionPatternRewriter &rewriter,
     const IndexMapSet &levelToBlockArgIndex, const int level,
-    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
+    const llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+    PtrStateCache *cache) {
   // any inserted instruction should be before this yield
   OpBuilder::InsertionGuard insertionGuard{rewriter};
   rewriter.setInsertionPoint(op);
@@ -535,6 +958,17 @@ void PtrAnalysis::rewriteYieldOp(
     if (thisSet.find(i) == thisSet.end())
       continue;
 
+    // Block pointers yield their per-dimension offsets rather than the
+    // collapsed offset of the reinterpret_cast. Pointers that are carried
+    // through unchanged yield the block arguments they came from.
+    auto origV = adaptor.getOperands()[i];
+    if (auto it = knownPtrs.find(origV);
+        it != knownPtrs.end() &&
+        (it->second.isBlockPtr() || isa<BlockArgument>(origV))) {
+      initArgState.push_back(it->second);
+      continue;
+    }
+
     auto reintCastOp = v.getDefiningOp<memref::ReinterpretCastOp>();
     assert(
         reintCastOp ||
@@ -544,9 +978,9 @@ void PtrAnalysis::rewriteYieldOp(
     PtrState state;
     if (reintCastOp) {
       visitOperandReintCast(reintCastOp, state, op.getLoc(), rewriter,
-                            knownPtrs);
+                            knownPtrs, cache);
     } else {
-      visitOperand(v, state, op.getLoc(), rewriter, knownPtrs);
+      visitOperand(v, state, op.getLoc(), rewriter, knownPtrs, cache);
     }
     initArgState.push_back(state);
   }
@@ -590,17 +1024,102 @@ void PtrAnalysis::rewriteYieldOp(
   });
 }
 
-void PtrAnalysis::rewriteForOp(
-    scf::ForOp op, ConversionPatternRewriter &rewriter,
-    IndexMapSet &levelToBlockArgIndex, const int level,
-    llvm::SmallDenseMap<Value, PtrState> &knownPtrs) {
-  SmallVector<Value> newInitArgs;
+// Tensors of pointers and block pointers, which loops and branches carry
+// together with their offsets and strides.
+static bool isCarriedPtrType(Type type) {
+  return triton::isTensorPointerType(type) ||
+         (type.isa<RankedTensorType>() &&
+          getElementTypeOrSelf(type).isa<triton::PointerType>());
+}
+
+// Shape of the view that a carried pointer of the given type is rewritten to.
+static ArrayRef<int64_t> getCarriedShape(Type type) {
+  if (triton::isTensorPointerType(type))
+    return getBlockShape(type);
+  return type.cast<ShapedType>().getShape();
+}
 
-  SmallVector<std::pair<int, PtrState>> initArgIndexState;
-  SmallVector<std::pair<int, PtrState>> knownPtrsTmp;
+// Type of the view built by createCastOp from a state whose offsets and
+// strides are all carried values.
+static MemRefType getCarriedMemRefType(const PtrState &state, Type type) {
+  auto layout = StridedLayoutAttr::get(
+      type.getContext(), ShapedType::kDynamic,
+      SmallVector<int64_t>(state.getRank(), ShapedType::kDynamic));
+  return MemRefType::get(
+      getCarriedShape(type),
+      state.source.getType().cast<BaseMemRefType>().getElementType(), layout);
+}
+
+// Number of values appendCarriedValues adds for state.
+static unsigned getNumCarriedValues(const PtrState &state) {
+  return state.offsets.size() + state.strides.size();
+}
+
+// Append the offsets and strides of state to values, materializing the
+// constant ones.
+static void appendCarriedValues(const PtrState &state,
+                                SmallVectorImpl<Value> &values,
+                                const Location loc,
+                                ConversionPatternRewriter &rewriter) {
+  for (auto ofr : state.offsets)
+    values.push_back(ofrToIndexValue(ofr, loc, rewriter));
+  for (auto ofr : state.strides)
+    values.push_back(ofrToIndexValue(ofr, loc, rewriter));
+}
+
+// Point the offsets and strides of state to the values carried at position
+// pos and onward. Return the position following them.
+static unsigned setCarriedValues(PtrState &state, ValueRange values,
+                                 unsigned pos) {
+  for (auto &ofr : state.offsets)
+    ofr = values[pos++];
+  for (auto &ofr : state.strides)
+    ofr = values[pos++];
+  return pos;
+}
+
+// reinterpret_cast ignores the offset of its source, so views of views can
+// be traced back to the memref they were cast from.
+static Value getCastSource(Value source) {
+  while (auto castOp = source.getDefiningOp<memref::ReinterpretCastOp>())
+    source = castOp.getSource();
+  return source;
+}
+
+// Build the view that replaces result, a carried pointer produced by a loop
+// or a branch, from state, whose offsets and strides are results of the same
+// op. Record state for the users of result.
+static Value
+createCarriedResult(Value result, PtrState state, const Location loc,
+                    ConversionPatternRewriter &rewriter,
+                    llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                    PtrStateCache *cache) {
+  auto castOp =
+      state.createCastOp(getCarriedShape(result.getType()), loc, rewriter);
+  knownPtrs[result] = state;
+  if (cache && state.isBlockPtr())
+    cache->insertBlockPtr(result, state);
+  return castOp.getResult();
+}
+
+// Collect the init args of the loop op into newInitArgs, using the remapped
+// value where there is one. Every init arg that addptr may use, i.e. a memref
+// created by a reinterpret_cast or a tensor of index, gets a PtrState that is
+// recorded in initArgStates, with its offsets and strides appended to
+// newInitArgs.
+static void
+expandInitArgs(Operation *op, ValueRange initArgs,
+               ConversionPatternRewriter &rewriter,
+               SmallVectorImpl<Value> &newInitArgs,
+               SmallVectorImpl<std::pair<int, PtrState>> &initArgStates,
+               PtrStateCache *cache) {
+  // Set insertion point to be before the loop for new variables passed into
+  // the new loop.
+  OpBuilder::InsertionGuard insertionGuard{rewriter};
+  rewriter.setInsertionPoint(op);
 
   // Create a new list of init args
-  for (auto [i, arg] : llvm::enumerate(op.getInitArgs())) {
+  for (auto [i, arg] : llvm::enumerate(initArgs)) {
     auto mappedV = rewriter.getRemappedValue(arg);
 
     // Trace back the original value. See comments in rewriteYieldOp.
@@ -642,28 +1161,31 @@ void PtrAnalysis::rewriteForOp(
       continue;
 
     PtrState state;
-    if (reintCastOp) {
-      visitOperandReintCast(reintCastOp, state, op.getLoc(), rewriter,
-                            llvm::SmallDenseMap<Value, PtrState>(0));
+    if (triton::isTensorPointerType(arg.getType())) {
+      // Block pointers keep the offset of every dimension, which boundary
+      // checks rely on, so analyze the original pointer.
+      PtrAnalysis::visitOperand(arg, state, op->getLoc(), rewriter,
+                                llvm::SmallDenseMap<Value, PtrState>(0),
+                                cache);
+    } else if (reintCastOp) {
+      PtrAnalysis::visitOperandReintCast(
+          reintCastOp, state, op->getLoc(), rewriter,
+          llvm::SmallDenseMap<Value, PtrState>(0), cache);
     } else {
       // TODO:
-      visitOperand(arg, state, op.getLoc(), rewriter,
-                   llvm::SmallDenseMap<Value, PtrState>(0));
+      PtrAnalysis::visitOperand(arg, state, op->getLoc(), rewriter,
+                                llvm::SmallDenseMap<Value, PtrState>(0),
+                                cache);
     }
 
     // Record the PtrState for later processing
-    initArgIndexState.push_back(std::make_pair(i, state));
+    initArgStates.push_back(std::make_pair(i, state));
   }
 
-  // Set insertion point to be before the for loop for new variables passed
-  // into the new loop.
-  auto origIp = rewriter.saveInsertionPoint();
-  rewriter.setInsertionPoint(op);
-
   // For each of the PtrState recorded in the last step, insert new
   // instructions to describe offset and stride for each dimension and append
   // them to init args
-  for (auto [i, state] : initArgIndexState) {
+  for (auto &[i, state] : initArgStates) {
     // For each dimension, if the corresponding offset and stride is an
     // integer attribute, create a constant value and append them at the end
     // of init arg list.
@@ -671,7 +1193,7 @@ void PtrAnalysis::rewriteForOp(
       auto sIntAttr = getIntAttr(s);
       if (sIntAttr) {
         auto constOp = rewriter.create<arith::ConstantOp>(
-            op.getLoc(), rewriter.getIndexAttr(sIntAttr.value()));
+            op->getLoc(), rewriter.getIndexAttr(sIntAttr.value()));
         newInitArgs.push_back(constOp.getResult());
         state.offsets[j] = constOp.getResult();
       } else {
@@ -683,7 +1205,7 @@ void PtrAnalysis::rewriteForOp(
       auto sIntAttr = getIntAttr(s);
       if (sIntAttr) {
         auto constOp = rewriter.create<arith::ConstantOp>(
-            op.getLoc(), rewriter.getIndexAttr(sIntAttr.value()));
+            op->getLoc(), rewriter.getIndexAttr(sIntAttr.value()));
         newInitArgs.push_back(constOp.getResult());
         state.strides[j] = constOp.getResult();
       } else {
@@ -691,13 +1213,6 @@ void PtrAnalysis::rewriteForOp(
       }
     }
 
-    // Note that we want the knownPtrs to be indexed by block arg, but we only
-    // have index for now. Also, the state we record is the init arg, but want
-    // to to use newly created block arg. These block args are not created yet.
-    // We will translate this mapping later.
-    knownPtrsTmp.push_back(std::make_pair(i, state));
-    levelToBlockArgIndex[level].insert(i);
-
     // If the original init arg is a memref produced by reinterpret_cast, create
     // a new memref using new strides and offsets created above. This produces a
     // canonicalized memref, which will match what the for loop generates if it
@@ -716,7 +1231,7 @@ void PtrAnalysis::rewriteForOp(
         assert(sIntAttr && "expected constant size");
         resultShape.push_back(sIntAttr.value());
       }
-      auto castOp = state.createCastOp(resultShape, op.getLoc(), rewriter);
+      auto castOp = state.createCastOp(resultShape, op->getLoc(), rewriter);
 
       LLVM_DEBUG({
         llvm::dbgs() << "new reinterpret_cast with dynamic sizes "
@@ -728,8 +1243,45 @@ void PtrAnalysis::rewriteForOp(
       newInitArgs[i] = castOp.getResult();
     }
   }
+}
 
-  rewriter.restoreInsertionPoint(origIp);
+// Rewrite the pointer arithmetic directly nested in block, using and
+// extending the states in knownPtrs.
+static LogicalResult
+rewriteNestedPtrOps(Block &block, ConversionPatternRewriter &rewriter,
+                    llvm::SmallDenseMap<Value, PtrState> &knownPtrs,
+                    PtrStateCache *cache) {
+  for (auto &op : block) {
+    if (auto addptrOp = dyn_cast<triton::AddPtrOp>(op)) {
+      PtrAnalysis::rewriteAddptrOp(addptrOp, rewriter, knownPtrs, cache);
+    } else if (isa<triton::MakeTensorPtrOp, triton::AdvanceOp>(op)) {
+      PtrAnalysis::rewriteBlockPtrOp(&op, rewriter, knownPtrs, cache);
+    } else if (auto ifOp = dyn_cast<scf::IfOp>(op)) {
+      if (failed(PtrAnalysis::rewriteIfOp(ifOp, rewriter, knownPtrs, cache)))
+        return failure();
+    } else if (isa<scf::ForOp, scf::WhileOp>(op)) {
+      // TODO:
+      //  Nested loops carrying pointers are not supported at the moment. Loops
+      //  that do not are converted on their own.
+      if (llvm::any_of(op.getOperandTypes(), [](Type t) {
+            return getElementTypeOrSelf(t).isa<triton::PointerType>();
+          }))
+        return failure();
+    }
+  }
+  return success();
+}
+
+LogicalResult PtrAnalysis::rewriteForOp(
+    scf::ForOp op, ConversionPatternRewriter &rewriter,
+    IndexMapSet &levelToBlockArgIndex, const int level,
+    llvm::SmallDenseMap<Value, PtrState> &knownPtrs, PtrStateCache *cache) {
+  SmallVector<Value> newInitArgs;
+  SmallVector<std::pair<int, PtrState>> initArgStates;
+  expandInitArgs(op, op.getInitArgs(), rewriter, newInitArgs, initArgStates,
+                 cache);
+  for (auto &argState : initArgStates)
+    levelToBlockArgIndex[level].insert(argState.first);
 
   // create a new scf::ForOp that uses updated init args and same loop body
   auto newOp = rewriter.create<scf::ForOp>(
@@ -747,47 +1299,43 @@ void PtrAnalysis::rewriteForOp(
   // Convert the book-keeping data structure to use the correct key and value.
   // Key is converted from init arg index to newly created block arg, and
   // Value's PtrState fields are converted from init arg to newly created block
-  // arg
-  int cnt = op.getRegionIterArgs().size();
-  for (auto [i, state] : knownPtrsTmp) {
-    for (auto it = state.offsets.begin(); it != state.offsets.end(); it++) {
-      *it = newOp.getRegionIterArgs()[cnt];
-      cnt++;
-    }
-
-    for (auto it = state.strides.begin(); it != state.strides.end(); it++) {
-      *it = newOp.getRegionIterArgs()[cnt];
-      cnt++;
+  // arg. Pointers used after the loop are rebuilt from the results the same
+  // way.
+  OpBuilder::InsertionGuard insertionGuard{rewriter};
+  rewriter.setInsertionPointAfter(newOp);
+  SmallVector<Value> results(newOp.result_begin(),
+                             newOp.result_begin() + op.getNumResults());
+  unsigned cnt = op.getRegionIterArgs().size();
+  for (auto [i, state] : initArgStates) {
+    auto result = op.getResult(i);
+    if (isCarriedPtrType(result.getType()) && !result.use_empty()) {
+      auto resultState = state;
+      setCarriedValues(resultState, newOp.getResults(), cnt);
+      results[i] = createCarriedResult(result, resultState, op.getLoc(),
+                                       rewriter, knownPtrs, cache);
     }
 
+    cnt = setCarriedValues(state, newOp.getRegionIterArgs(), cnt);
     auto key = newOp.getRegionIterArgs()[i];
     knownPtrs.insert(std::make_pair(key, state));
+    if (cache && state.isBlockPtr())
+      cache->insertBlockPtr(key, state);
   }
-  assert(static_cast<size_t>(cnt) == newOp.getRegionIterArgs().size() &&
+  assert(cnt == newOp.getRegionIterArgs().size() &&
          "expect to remap all new block args");
 
   // replace only the results that correspond to the original scf.for
-  auto resultsToReplaceWith = ResultRange(
-      newOp.result_begin(), newOp.result_begin() + op.getNumResults());
-  rewriter.replaceOp(op, resultsToReplaceWith);
+  rewriter.replaceOp(op, results);
 
   // Update the loop body. Manually invoke the rewrite logic on addptr and yield
   // in the loop body, so we can take advantage of the states we built up
-  for (auto &bodyOp : newOp.getLoopBody().getOps()) {
-    if (auto addptrOp = dyn_cast<triton::AddPtrOp>(bodyOp)) {
-      rewriteAddptrOp(addptrOp, rewriter, knownPtrs);
-    } else if (auto forOp = dyn_cast<scf::ForOp>(bodyOp)) {
-      // TODO:
-      //  Nested for loops are not supported at the moment
-      assert(0 && "nested loops currently not supported");
-      // rewriteForOp(forOp, rewriter, levelToBlockArgIndex, level+1,
-      // knownPtrs); levelToBlockArgIndex.erase(level+1);
-    }
-  }
+  if (failed(rewriteNestedPtrOps(*newOp.getBody(), rewriter, knownPtrs, cache)))
+    return failure();
 
   if (op.getNumRegionIterArgs()) {
     auto yieldOp = cast<scf::YieldOp>(newOp.getBody()->getTerminator());
-    rewriteYieldOp(yieldOp, rewriter, levelToBlockArgIndex, level, knownPtrs);
+    rewriteYieldOp(yieldOp, rewriter, levelToBlockArgIndex, level, knownPtrs,
+                   cache);
   }
 
   LLVM_DEBUG({
@@ -796,6 +1344,245 @@ void PtrAnalysis::rewriteForOp(
                                 OpPrintingFlags().printGenericOpForm());
     llvm::dbgs() << "\n";
   });
+  return success();
+}
+
+LogicalResult PtrAnalysis::rewriteWhileOp(
+    scf::WhileOp op, ConversionPatternRewriter &rewriter,
+    llvm::SmallDenseMap<Value, PtrState> &knownPtrs, PtrStateCache *cache) {
+  auto conditionOp = op.getConditionOp();
+
+  SmallVector<Value> newInitArgs;
+  SmallVector<std::pair<int, PtrState>> initArgStates;
+  expandInitArgs(op, op.getInits(), rewriter, newInitArgs, initArgStates,
+                 cache);
+
+  // Pointers are only known in the after region if scf.condition forwards
+  // them unchanged from the before region.
+  llvm::SmallDenseMap<unsigned, unsigned> argStates;
+  for (auto [s, argState] : llvm::enumerate(initArgStates))
+    argStates[argState.first] = s;
+
+  SmallVector<std::pair<unsigned, unsigned>> forwarded;
+  for (auto [j, arg] : llvm::enumerate(conditionOp.getArgs())) {
+    auto blockArg = dyn_cast<BlockArgument>(arg);
+    if (blockArg && blockArg.getOwner() == op.getBeforeBody() &&
+        argStates.count(blockArg.getArgNumber())) {
+      forwarded.push_back(
+          std::make_pair(j, argStates[blockArg.getArgNumber()]));
+      continue;
+    }
+    if (getElementTypeOrSelf(arg.getType()).isa<triton::PointerType>())
+      return failure();
+  }
+
+  SmallVector<Type> resultTypes(conditionOp.getArgs().getTypes());
+  for (auto [j, s] : forwarded)
+    resultTypes[j] = newInitArgs[initArgStates[s].first].getType();
+  for (auto [j, s] : forwarded)
+    resultTypes.append(getNumCarriedValues(initArgStates[s].second),
+                       rewriter.getIndexType());
+
+  // create a new scf::WhileOp that uses updated init args and same regions
+  auto cloneBody = [](Block *body, OpBuilder &b, ValueRange args) {
+    IRMapping mapping;
+    mapping.map(body->getArguments(),
+                args.take_front(body->getNumArguments()));
+    for (auto &bodyOp : body->getOperations())
+      b.clone(bodyOp, mapping);
+  };
+  auto newOp = rewriter.create<scf::WhileOp>(
+      op.getLoc(), resultTypes, newInitArgs,
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        cloneBody(op.getBeforeBody(), b, args);
+      },
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        cloneBody(op.getAfterBody(), b, args);
+      });
+
+  // Point the states at the block args of the new regions, and the pointers
+  // used after the loop at its results.
+  unsigned cnt = op.getNumOperands();
+  for (auto &[i, state] : initArgStates) {
+    cnt = setCarriedValues(state, newOp.getBeforeArguments(), cnt);
+    auto key = newOp.getBeforeArguments()[i];
+    knownPtrs[key] = state;
+    if (cache && state.isBlockPtr())
+      cache->insertBlockPtr(key, state);
+  }
+
+  OpBuilder::InsertionGuard insertionGuard{rewriter};
+  rewriter.setInsertionPointAfter(newOp);
+  SmallVector<Value> results(newOp.result_begin(),
+                             newOp.result_begin() + op.getNumResults());
+  cnt = op.getNumResults();
+  for (auto [j, s] : forwarded) {
+    auto state = initArgStates[s].second;
+    auto result = op.getResult(j);
+    if (isCarriedPtrType(result.getType()) && !result.use_empty()) {
+      auto resultState = state;
+      setCarriedValues(resultState, newOp.getResults(), cnt);
+      results[j] = createCarriedResult(result, resultState, op.getLoc(),
+                                       rewriter, knownPtrs, cache);
+    }
+
+    cnt = setCarriedValues(state, newOp.getAfterArguments(), cnt);
+    auto key = newOp.getAfterArguments()[j];
+    knownPtrs[key] = state;
+    if (cache && state.isBlockPtr())
+      cache->insertBlockPtr(key, state);
+  }
+  rewriter.replaceOp(op, results);
+
+  // Rewrite the before region and forward the offsets and strides along with
+  // the pointers.
+  if (failed(rewriteNestedPtrOps(*newOp.getBeforeBody(), rewriter, knownPtrs,
+                                 cache)))
+    return failure();
+
+  auto newConditionOp = newOp.getConditionOp();
+  rewriter.setInsertionPoint(newConditionOp);
+  SmallVector<Value> conditionArgs(newConditionOp.getArgs());
+  for (auto [j, s] : forwarded)
+    appendCarriedValues(initArgStates[s].second, conditionArgs,
+                        newConditionOp.getLoc(), rewriter);
+  // scf.condition is a terminator op that must be at the end of the region
+  rewriter.setInsertionPointAfter(newConditionOp);
+  rewriter.replaceOpWithNewOp<scf::ConditionOp>(
+      newConditionOp, newConditionOp.getCondition(), conditionArgs);
+
+  // Rewrite the after region, which yields to the before region like the body
+  // of an scf.for.
+  if (failed(rewriteNestedPtrOps(*newOp.getAfterBody(), rewriter, knownPtrs,
+                                 cache)))
+    return failure();
+
+  IndexMapSet levelToBlockArgIndex;
+  for (auto &argState : initArgStates)
+    levelToBlockArgIndex[0].insert(argState.first);
+  rewriteYieldOp(newOp.getYieldOp(), rewriter, levelToBlockArgIndex, 0,
+                 knownPtrs, cache);
+
+  LLVM_DEBUG({
+    llvm::dbgs() << "new while\n";
+    newOp.getOperation()->print(llvm::dbgs(),
+                                OpPrintingFlags().printGenericOpForm());
+    llvm::dbgs() << "\n";
+  });
+  return success();
+}
+
+LogicalResult PtrAnalysis::rewriteIfOp(
+    scf::IfOp op, ConversionPatternRewriter &rewriter,
+    llvm::SmallDenseMap<Value, PtrState> &knownPtrs, PtrStateCache *cache) {
+  // Rewrite the pointer arithmetic in both branches first, so that the states
+  // of the yielded pointers are known.
+  for (auto &region : op->getRegions())
+    for (auto &block : region)
+      if (failed(rewriteNestedPtrOps(block, rewriter, knownPtrs, cache)))
+        return failure();
+
+  SmallVector<unsigned> ptrResults;
+  for (auto [i, type] : llvm::enumerate(op.getResultTypes())) {
+    if (isCarriedPtrType(type))
+      ptrResults.push_back(i);
+    else if (type.isa<triton::PointerType>())
+      return failure();
+  }
+  if (ptrResults.empty())
+    return success();
+
+  // Parse the state of each yielded pointer. Both branches have to produce a
+  // view of the same source with the same shape, only offsets and strides
+  // may differ.
+  OpBuilder::InsertionGuard insertionGuard{rewriter};
+  SmallVector<scf::YieldOp> yieldOps{op.thenYield(), op.elseYield()};
+  SmallVector<SmallVector<PtrState>> branchStates;
+  for (auto yieldOp : yieldOps) {
+    rewriter.setInsertionPoint(yieldOp);
+    auto &states = branchStates.emplace_back();
+    for (auto i : ptrResults) {
+      PtrState state;
+      visitOperand(yieldOp.getOperand(i), state, op.getLoc(), rewriter,
+                   knownPtrs, cache);
+      if (state.isGather() || state.isWrapped())
+        return failure();
+      state.source = getCastSource(state.source);
+      states.push_back(state);
+    }
+  }
+
+  for (auto [thenState, elseState] :
+       llvm::zip(branchStates[0], branchStates[1])) {
+    if (thenState.source != elseState.source ||
+        thenState.sizes != elseState.sizes ||
+        thenState.shape != elseState.shape ||
+        thenState.baseOffset != elseState.baseOffset)
+      return failure();
+  }
+
+  SmallVector<Type> resultTypes(op.getResultTypes());
+  for (auto [j, i] : llvm::enumerate(ptrResults)) {
+    auto &state = branchStates[0][j];
+    resultTypes[i] = getCarriedMemRefType(state, op.getResult(i).getType());
+    resultTypes.append(getNumCarriedValues(state), rewriter.getIndexType());
+  }
+
+  // Yield a view with dynamic offsets and strides in place of every pointer,
+  // followed by the offsets and strides.
+  for (auto [yieldOp, states] : llvm::zip(yieldOps, branchStates)) {
+    rewriter.setInsertionPoint(yieldOp);
+    SmallVector<Value> operands(yieldOp.getOperands());
+    SmallVector<Value> carried;
+    for (auto [j, i] : llvm::enumerate(ptrResults)) {
+      auto state = states[j];
+      auto pos = carried.size();
+      appendCarriedValues(state, carried, yieldOp.getLoc(), rewriter);
+      setCarriedValues(state, carried, pos);
+      auto shape = getCarriedShape(op.getResult(i).getType());
+      operands[i] =
+          state.createCastOp(shape, yieldOp.getLoc(), rewriter).getResult();
+    }
+    operands.append(carried);
+
+    // Yield is a terminator op that must be at the end of the region
+    rewriter.setInsertionPointAfter(yieldOp);
+    rewriter.replaceOpWithNewOp<scf::YieldOp>(yieldOp, operands);
+  }
+
+  rewriter.setInsertionPoint(op);
+  auto newOp = rewriter.create<scf::IfOp>(op.getLoc(), resultTypes,
+                                          op.getCondition(),
+                                          /*withElseRegion=*/true);
+  rewriter.eraseBlock(newOp.thenBlock());
+  rewriter.eraseBlock(newOp.elseBlock());
+  rewriter.inlineRegionBefore(op.getThenRegion(), newOp.getThenRegion(),
+                              newOp.getThenRegion().end());
+  rewriter.inlineRegionBefore(op.getElseRegion(), newOp.getElseRegion(),
+                              newOp.getElseRegion().end());
+
+  // Rebuild the pointers used after the branch from the carried results.
+  rewriter.setInsertionPointAfter(newOp);
+  SmallVector<Value> results(newOp.result_begin(),
+                             newOp.result_begin() + op.getNumResults());
+  unsigned cnt = op.getNumResults();
+  for (auto [j, i] : llvm::enumerate(ptrResults)) {
+    auto state = branchStates[0][j];
+    cnt = setCarriedValues(state, newOp.getResults(), cnt);
+    auto result = op.getResult(i);
+    if (!result.use_empty())
+      results[i] = createCarriedResult(result, state, op.getLoc(), rewriter,
+                                       knownPtrs, cache);
+  }
+  rewriter.replaceOp(op, results);
+
+  LLVM_DEBUG({
+    llvm::dbgs() << "new if\n";
+    newOp.getOperation()->print(llvm::dbgs(),
+                                OpPrintingFlags().printGenericOpForm());
+    llvm::dbgs() << "\n";
+  });
+  return success();
 }
 
 Value PtrAnalysis::getScalarMemRef(Value ptr, Value memRef, const Location loc,
@@ -824,6 +1611,15 @@ Value PtrAnalysis::getScalarMemRef(Value ptr, Value memRef, const Location loc,
 
   assert(isa<BlockArgument>(ptr) &&
          "pointer is neither produced by addptr nor a block argument");
+
+  // A scalar pointer carried through a loop has already been rewritten into
+  // a 1-element view by rewriteForOp; use it directly.
+  if (auto memRefType = memRef.getType().dyn_cast<MemRefType>()) {
+    assert(memRefType.getRank() == 1 && memRefType.getShape()[0] == 1 &&
+           "expected 1-element memref for scalar pointer");
+    return memRef;
+  }
+
   PtrState state;
   state.source = memRef;
   state.offsets.push_back(rewriter.getIndexAttr(0));
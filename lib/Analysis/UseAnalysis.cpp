@@ -9,6 +9,10 @@
 
 #include "mlir/Analysis/DataFlow/ConstantPropagationAnalysis.h"
 #include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
+#include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Debug.h"
@@ -63,6 +67,22 @@ void triton::UseAnalysis::visitOperation(Operation *op,
           propagateUse(operands[2], UseType::MetaUse);
         }
       })
+      .Case<triton::AtomicRMWOp>([&](auto rmw) {
+        propagateUse(operands[0], UseType::MetaUse);
+        propagateUse(operands[1], UseType::DataUse);
+        if (rmw.getMask())
+          propagateUse(operands[2], UseType::MetaUse);
+      })
+      .Case<triton::AtomicCASOp>([&](auto cas) {
+        propagateUse(operands[0], UseType::MetaUse);
+        propagateUse(operands[1], UseType::DataUse);
+        propagateUse(operands[2], UseType::DataUse);
+      })
+      .Case<triton::PrefetchOp>([&](auto prefetch) {
+        propagateUse(operands[0], UseType::MetaUse);
+        if (prefetch.getMask())
+          propagateUse(operands[1], UseType::MetaUse);
+      })
       .Case<triton::DotOp>([&](auto dot) {
         propagateResults(operands[0], results);
         propagateResults(operands[1], results);
@@ -96,6 +116,21 @@ LogicalResult triton::runUseAnalysis(triton::FuncOp &funcOp) {
   if (failed(solver.initializeAndRun(funcOp)))
     return failure();
 
+  // A producer of tensors the pointer side can share: computing it has no side
+  // effects and it is only needed for its metadata once cloned
+  auto isCheapMixUse = [&](Operation *op) {
+    if (op->getNumResults() != 1 || op->getNumRegions() != 0 ||
+        !isMemoryEffectFree(op) ||
+        !op->getResult(0).getType().isa<ShapedType>())
+      return false;
+    auto use = solver.lookupState<UseInfo>(op->getResult(0));
+    return use && use->type == UseType::MixUse;
+  };
+
+  // The clones of the producers the pointer side got, shared by all of the
+  // ops of their block
+  IRMapping metaClones;
+
   // Walk the func op, convert tags on operands to tags on operations
   funcOp.walk([&](Operation *op) {
     UseType useType = UseType::Undefined;
@@ -116,7 +151,23 @@ LogicalResult triton::runUseAnalysis(triton::FuncOp &funcOp) {
     if (useType == UseType::Undefined) {
       LLVM_DEBUG({ op->setAttr("Undefined", UnitAttr::get(context)); });
       return;
-    } else if (useType == UseType::MetaUse) {
+    }
+
+    // Loaded values feeding into pointer arithmetic are gather indices. They
+    // are read from memory at runtime, so the load has to be materialized no
+    // matter how its result is used.
+    if (isa<triton::LoadOp>(op) && useType != UseType::DataUse) {
+      LLVM_DEBUG({ op->setAttr("GatherIndices", UnitAttr::get(context)); });
+      return;
+    }
+
+    // Loops and branches carrying pointers are rewritten by PtrAnalysis, no
+    // matter how many values they produce.
+    if (useType == UseType::MetaUse &&
+        isa<scf::ForOp, scf::WhileOp, scf::IfOp>(op))
+      return;
+
+    if (useType == UseType::MetaUse) {
       assert(op->getNumResults() == 1 &&
              "Ops used for meta computation are expected to have one result");
       // Only set the tag if the operation uses tensors
@@ -164,6 +215,18 @@ LogicalResult triton::runUseAnalysis(triton::FuncOp &funcOp) {
               if (result == ptr || result == mask)
                 metaUsers.insert(user);
             })
+            .Case<triton::AtomicRMWOp>([&](auto rmw) {
+              if (result == rmw.getPtr() || result == rmw.getMask())
+                metaUsers.insert(user);
+            })
+            .Case<triton::AtomicCASOp>([&](auto cas) {
+              if (result == cas.getPtr())
+                metaUsers.insert(user);
+            })
+            .Case<triton::PrefetchOp>([&](auto prefetch) {
+              if (result == prefetch.getPtr() || result == prefetch.getMask())
+                metaUsers.insert(user);
+            })
             .Case<triton::DotOp>([&](auto dot) {
               auto opc = dot.getC();
               triton::SplatOp splat;
@@ -181,7 +244,7 @@ LogicalResult triton::runUseAnalysis(triton::FuncOp &funcOp) {
               bool allMeta = true;
               for (auto res : op->getResults()) {
                 auto resUse = solver.lookupState<UseInfo>(res);
-                if (resUse->type != UseType::MetaUse) {
+                if (!resUse || resUse->type != UseType::MetaUse) {
                   allMeta = false;
                   break;
                 }
@@ -198,9 +261,22 @@ LogicalResult triton::runUseAnalysis(triton::FuncOp &funcOp) {
       return;
     }
 
-    // Clone the operation; switch all meta users to use the clone
+    // Clone the operation, along with the cheap MixUse producers of its block
+    // it depends on, so that the pointer side has a chain of its own and
+    // the original ops are only left with the users that compute data. Switch
+    // all meta users to use the clone.
+    SetVector<Operation *> chain;
+    getBackwardSlice(op, &chain, [&](Operation *producer) {
+      return producer->getBlock() == op->getBlock() && isCheapMixUse(producer);
+    });
     OpBuilder builder(op);
-    auto clone = builder.clone(*op);
+    for (auto producer : chain) {
+      if (metaClones.contains(producer->getResult(0)))
+        continue;
+      auto producerClone = builder.clone(*producer, metaClones);
+      producerClone->setAttr("MetaUse", UnitAttr::get(context));
+    }
+    auto clone = builder.clone(*op, metaClones);
     LLVM_DEBUG({ op->setAttr("MixUse", UnitAttr::get(context)); });
 
     // Setting tag for erasing op later
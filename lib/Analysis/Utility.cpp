@@ -5,7 +5,10 @@
 #include "mlir/IR/Matchers.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
+#include "llvm/Support/MathExtras.h"
 #include <deque>
+#include <map>
 
 namespace mlir {
 
@@ -32,6 +35,10 @@ unsigned ReduceOpHelper::getThreadsReductionAxis() {
          triton::gpu::getWarpsPerCTA(srcLayout)[axis];
 }
 
+bool ReduceOpHelper::isWarpSynchronous() {
+  return isFastReduction() && getInterWarpSize() == 1;
+}
+
 SmallVector<unsigned> ReduceOpHelper::getScratchConfigBasic() {
   auto smemShape = convertType<unsigned>(getSrcShape());
   smemShape[axis] = std::min(smemShape[axis], getThreadsReductionAxis());
@@ -43,7 +50,7 @@ SmallVector<SmallVector<unsigned>> ReduceOpHelper::getScratchConfigsFast() {
 
   auto argLayout = getSrcLayout();
   auto argLayoutMma = argLayout.dyn_cast<triton::gpu::MmaEncodingAttr>();
-  if (argLayoutMma && argLayoutMma.getVersionMajor() == 2 &&
+  if (argLayoutMma && (argLayoutMma.isAmpere() || argLayoutMma.isHopper()) &&
       triton::gpu::getWarpsPerCTA(argLayout)[axis] == 1)
     return {{1, 1}, {1, 1}};
 
@@ -55,12 +62,17 @@ SmallVector<SmallVector<unsigned>> ReduceOpHelper::getScratchConfigsFast() {
   /// shared memory block1:
   auto mod = op->getParentOfType<ModuleOp>();
   unsigned numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
-  smemShapes[1].push_back(numWarps * 32);
+  unsigned threadsPerWarp =
+      triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+  smemShapes[1].push_back(numWarps * threadsPerWarp);
 
   return smemShapes;
 }
 
-unsigned ReduceOpHelper::getScratchSizeInBytes() {
+unsigned ReduceOpHelper::getScratchElemsPerOperand() {
+  if (isWarpSynchronous())
+    return 0;
+
   unsigned elems = 0;
   if (isFastReduction()) {
     auto smemShapes = getScratchConfigsFast();
@@ -70,12 +82,33 @@ unsigned ReduceOpHelper::getScratchSizeInBytes() {
     auto smemShape = getScratchConfigBasic();
     elems = product<unsigned>(smemShape);
   }
+  return elems;
+}
 
-  unsigned bytesPerElem = 0;
+// Booleans are stored as bytes
+static unsigned getScratchElemBytes(Type ty) {
+  return std::max<unsigned>(8, ty.getIntOrFloatBitWidth()) / 8;
+}
+
+SmallVector<unsigned> ReduceOpHelper::getScratchOffsetsInBytes() {
+  unsigned elems = getScratchElemsPerOperand();
+  SmallVector<unsigned> offsets;
+  unsigned offset = 0;
   for (const auto &ty : srcElementTypes) {
-    bytesPerElem += ty.getIntOrFloatBitWidth() / 8;
+    unsigned bytesPerElem = getScratchElemBytes(ty);
+    offset = llvm::alignTo(offset, bytesPerElem);
+    offsets.push_back(offset);
+    offset += elems * bytesPerElem;
   }
-  return bytesPerElem * elems;
+  return offsets;
+}
+
+unsigned ReduceOpHelper::getScratchSizeInBytes() {
+  unsigned elems = getScratchElemsPerOperand();
+  if (elems == 0)
+    return 0;
+  auto offsets = getScratchOffsetsInBytes();
+  return offsets.back() + elems * getScratchElemBytes(srcElementTypes.back());
 }
 
 bool ReduceOpHelper::isSupportedLayout() {
@@ -84,13 +117,91 @@ bool ReduceOpHelper::isSupportedLayout() {
     return true;
   }
   if (auto mmaLayout = srcLayout.dyn_cast<triton::gpu::MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere()) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       return true;
     }
   }
   return false;
 }
 
+bool ScanLoweringHelper::isSupported() {
+  auto blocked =
+      getSrcLayout().dyn_cast_or_null<triton::gpu::BlockedEncodingAttr>();
+  if (!blocked)
+    return false;
+  if (srcShape[getAxis()] < blocked.getSizePerThread()[getAxis()])
+    return false;
+  return llvm::all_of(srcElementTypes,
+                      [](Type ty) { return ty.isIntOrFloat(); });
+}
+
+unsigned ScanLoweringHelper::getAxisNumElementsPerThread() {
+  return triton::gpu::getSizePerThread(getSrcLayout())[getAxis()];
+}
+
+unsigned ScanLoweringHelper::getAxisNumThreadsPerWarp() {
+  unsigned threads = srcShape[getAxis()] / getAxisNumElementsPerThread();
+  return std::min(threads,
+                  triton::gpu::getThreadsPerWarp(getSrcLayout())[getAxis()]);
+}
+
+unsigned ScanLoweringHelper::getAxisThreadStride() {
+  auto threadsPerWarp = triton::gpu::getThreadsPerWarp(getSrcLayout());
+  unsigned stride = 1;
+  for (unsigned dim : triton::gpu::getOrder(getSrcLayout())) {
+    if (dim == getAxis())
+      break;
+    stride *= threadsPerWarp[dim];
+  }
+  return stride;
+}
+
+unsigned ScanLoweringHelper::getAxisNumWarps() {
+  unsigned warps =
+      srcShape[getAxis()] / (getAxisNumElementsPerThread() *
+                             triton::gpu::getThreadsPerWarp(
+                                 getSrcLayout())[getAxis()]);
+  return std::clamp<unsigned>(
+      warps, 1, triton::gpu::getWarpsPerCTA(getSrcLayout())[getAxis()]);
+}
+
+unsigned ScanLoweringHelper::getAxisNumBlocks() {
+  unsigned shapePerCTA =
+      triton::gpu::getShapePerCTA(getSrcLayout(), srcShape)[getAxis()];
+  return std::max<unsigned>(srcShape[getAxis()] / shapePerCTA, 1);
+}
+
+unsigned ScanLoweringHelper::getNonAxisNumElements() {
+  return product<int64_t>(srcShape) / srcShape[getAxis()];
+}
+
+unsigned ScanLoweringHelper::getScratchElemsPerOperand() {
+  if (getAxisNumWarps() == 1 && getAxisNumBlocks() == 1)
+    return 0;
+  return getAxisNumBlocks() * getAxisNumWarps() * getNonAxisNumElements();
+}
+
+SmallVector<unsigned> ScanLoweringHelper::getScratchOffsetsInBytes() {
+  unsigned elems = getScratchElemsPerOperand();
+  SmallVector<unsigned> offsets;
+  unsigned offset = 0;
+  for (const auto &ty : srcElementTypes) {
+    unsigned bytesPerElem = getScratchElemBytes(ty);
+    offset = llvm::alignTo(offset, bytesPerElem);
+    offsets.push_back(offset);
+    offset += elems * bytesPerElem;
+  }
+  return offsets;
+}
+
+unsigned ScanLoweringHelper::getScratchSizeInBytes() {
+  unsigned elems = getScratchElemsPerOperand();
+  if (elems == 0)
+    return 0;
+  auto offsets = getScratchOffsetsInBytes();
+  return offsets.back() + elems * getScratchElemBytes(srcElementTypes.back());
+}
+
 bool isSharedEncoding(Value value) {
   auto type = value.getType();
   if (auto tensorType = type.dyn_cast<RankedTensorType>()) {
@@ -116,9 +227,24 @@ bool maybeSharedAllocationOp(Operation *op) {
 bool maybeAliasOp(Operation *op) {
   return isa<triton::gpu::ExtractSliceOp>(op) || isa<triton::TransOp>(op) ||
          isa<triton::gpu::InsertSliceAsyncOp>(op) ||
+         isa<triton::gpu::InsertSliceTMAOp>(op) ||
          isa<tensor::InsertSliceOp>(op);
 }
 
+bool isMmaV3OperandCvt(Operation *op) {
+  auto cvt = dyn_cast<triton::gpu::ConvertLayoutOp>(op);
+  if (!cvt)
+    return false;
+  auto dstLayout = cvt.getType().cast<RankedTensorType>().getEncoding();
+  auto dotOperandLayout =
+      dstLayout.dyn_cast<triton::gpu::DotOperandEncodingAttr>();
+  if (!dotOperandLayout)
+    return false;
+  auto mmaLayout =
+      dotOperandLayout.getParent().dyn_cast<triton::gpu::MmaEncodingAttr>();
+  return mmaLayout && mmaLayout.isHopper() && isSharedEncoding(cvt.getSrc());
+}
+
 bool supportMMA(triton::DotOp op, int version) {
   // Refer to mma section for the data type supported by Volta and Hopper
   // Tensor Core in
@@ -135,12 +261,13 @@ bool supportMMA(Value value, int version) {
   // Tell whether a DotOp support HMMA by the operand type(either $a or $b).
   // We cannot get both the operand types(in TypeConverter), here we assume the
   // types of both the operands are identical here.
-  assert((version == 1 || version == 2) &&
+  assert((version == 1 || version == 2 || version == 3) &&
          "Unexpected MMA layout version found");
   auto elemTy = value.getType().cast<RankedTensorType>().getElementType();
   return elemTy.isF16() || elemTy.isBF16() ||
          (elemTy.isF32() && version >= 2) ||
-         (elemTy.isInteger(8) && version >= 2);
+         (elemTy.isInteger(8) && version >= 2) ||
+         (elemTy.isa<Float8E4M3FNType, Float8E5M2Type>() && version >= 2);
 }
 
 Type getElementType(Value value) {
@@ -171,6 +298,146 @@ bool isMmaToDotShortcut(RankedTensorType &srcTy, RankedTensorType &dstTy) {
          !srcTy.getElementType().isF32();
 }
 
+namespace {
+
+SmallVector<unsigned> delinearize(unsigned linear, ArrayRef<unsigned> shape,
+                                  ArrayRef<unsigned> order) {
+  SmallVector<unsigned> multiDim(shape.size());
+  for (unsigned d : order) {
+    multiDim[d] = linear % shape[d];
+    linear /= shape[d];
+  }
+  return multiDim;
+}
+
+/// Returns the indices of the elements held by `lane` of `warp`, in the
+/// order of emitIndices, or nothing for unsupported layouts.
+SmallVector<SmallVector<unsigned>> getThreadIndices(Attribute layout,
+                                                    ArrayRef<int64_t> shape,
+                                                    unsigned warp,
+                                                    unsigned lane) {
+  SmallVector<SmallVector<unsigned>> indices;
+  unsigned rank = shape.size();
+  if (auto blocked = layout.dyn_cast<triton::gpu::BlockedEncodingAttr>()) {
+    auto sizePerThread = blocked.getSizePerThread();
+    auto threadsPerWarp = blocked.getThreadsPerWarp();
+    auto warpsPerCTA = blocked.getWarpsPerCTA();
+    auto order = blocked.getOrder();
+    auto warpId = delinearize(warp, warpsPerCTA, order);
+    auto laneId = delinearize(lane, threadsPerWarp, order);
+    SmallVector<unsigned> base(rank), tilesPerDim(rank);
+    for (unsigned k = 0; k < rank; ++k) {
+      unsigned maxWarps =
+          ceil<unsigned>(shape[k], sizePerThread[k] * threadsPerWarp[k]);
+      unsigned maxThreads = ceil<unsigned>(shape[k], sizePerThread[k]);
+      base[k] = sizePerThread[k] * (laneId[k] % maxThreads +
+                                    warpId[k] % maxWarps * threadsPerWarp[k]);
+      tilesPerDim[k] = ceil<unsigned>(
+          shape[k], sizePerThread[k] * threadsPerWarp[k] * warpsPerCTA[k]);
+    }
+    unsigned totalSizePerThread = product<unsigned>(sizePerThread);
+    unsigned numElems = product<unsigned>(tilesPerDim) * totalSizePerThread;
+    for (unsigned n = 0; n < numElems; ++n) {
+      auto tile = delinearize(n / totalSizePerThread, tilesPerDim, order);
+      auto elem = delinearize(n % totalSizePerThread, sizePerThread, order);
+      SmallVector<unsigned> index(rank);
+      for (unsigned k = 0; k < rank; ++k)
+        index[k] = base[k] +
+                   tile[k] * sizePerThread[k] * threadsPerWarp[k] *
+                       warpsPerCTA[k] +
+                   elem[k];
+      indices.push_back(index);
+    }
+  } else if (auto mma = layout.dyn_cast<triton::gpu::MmaEncodingAttr>()) {
+    if (!(mma.isAmpere() || mma.isHopper()) || rank != 2 || shape[0] < 16 ||
+        shape[1] < 8)
+      return indices;
+    auto warpsPerCTA = mma.getWarpsPerCTA();
+    unsigned warpId0 = warp % warpsPerCTA[0] % (shape[0] / 16);
+    unsigned warpId1 = warp / warpsPerCTA[0] % warpsPerCTA[1] % (shape[1] / 8);
+    unsigned base0 = lane / 4 + warpId0 * 16;
+    unsigned base1 = lane % 4 * 2 + warpId1 * 8;
+    for (unsigned i = 0; i < shape[0]; i += 16 * warpsPerCTA[0])
+      for (unsigned j = 0; j < shape[1]; j += 8 * warpsPerCTA[1]) {
+        indices.push_back({base0 + i, base1 + j});
+        indices.push_back({base0 + i, base1 + j + 1});
+        indices.push_back({base0 + i + 8, base1 + j});
+        indices.push_back({base0 + i + 8, base1 + j + 1});
+      }
+  }
+  return indices;
+}
+
+} // namespace
+
+unsigned getWarpShuffleSrcLane(Attribute layout, ArrayRef<unsigned> index) {
+  if (auto blocked = layout.dyn_cast<triton::gpu::BlockedEncodingAttr>()) {
+    auto sizePerThread = blocked.getSizePerThread();
+    auto threadsPerWarp = blocked.getThreadsPerWarp();
+    unsigned lane = 0;
+    for (unsigned k : llvm::reverse(blocked.getOrder()))
+      lane = lane * threadsPerWarp[k] +
+             index[k] / sizePerThread[k] % threadsPerWarp[k];
+    return lane;
+  }
+  // MMAv2: lane l holds rows l / 4 (+ 8) and columns 2 * (l % 4) (+ 1)
+  return index[0] % 8 * 4 + index[1] % 8 / 2;
+}
+
+std::optional<SmallVector<WarpShuffleElem>>
+getWarpShuffleCvt(RankedTensorType srcTy, RankedTensorType dstTy) {
+  constexpr unsigned warpSize = 32;
+  auto srcLayout = srcTy.getEncoding();
+  auto dstLayout = dstTy.getEncoding();
+  auto shape = srcTy.getShape();
+  auto isSupported = [&](Attribute layout) {
+    return layout.isa<triton::gpu::BlockedEncodingAttr,
+                      triton::gpu::MmaEncodingAttr>() &&
+           product<unsigned>(triton::gpu::getThreadsPerWarp(layout)) ==
+               warpSize;
+  };
+  if (!isSupported(srcLayout) || !isSupported(dstLayout))
+    return std::nullopt;
+  unsigned numWarps = product<unsigned>(triton::gpu::getWarpsPerCTA(srcLayout));
+  if (numWarps != product<unsigned>(triton::gpu::getWarpsPerCTA(dstLayout)))
+    return std::nullopt;
+
+  // Every source element an element may come from costs a shuffle
+  constexpr unsigned maxSrcElems = 4;
+  std::optional<SmallVector<WarpShuffleElem>> elems;
+  for (unsigned warp = 0; warp < numWarps; ++warp) {
+    // The source elements of every lane of the warp, by index
+    SmallVector<std::map<SmallVector<unsigned>, unsigned>> srcElems(warpSize);
+    for (unsigned lane = 0; lane < warpSize; ++lane) {
+      auto indices = getThreadIndices(srcLayout, shape, warp, lane);
+      if (indices.empty())
+        return std::nullopt;
+      for (auto it : llvm::enumerate(indices))
+        srcElems[lane].insert({it.value(), it.index()});
+    }
+    for (unsigned lane = 0; lane < warpSize; ++lane) {
+      auto indices = getThreadIndices(dstLayout, shape, warp, lane);
+      if (indices.empty())
+        return std::nullopt;
+      if (!elems)
+        elems = SmallVector<WarpShuffleElem>(indices.size(), {{}, false});
+      for (auto it : llvm::enumerate(indices)) {
+        unsigned srcLane = getWarpShuffleSrcLane(srcLayout, it.value());
+        auto srcElem = srcElems[srcLane].find(it.value());
+        if (srcElem == srcElems[srcLane].end())
+          return std::nullopt;
+        auto &elem = (*elems)[it.index()];
+        if (!llvm::is_contained(elem.srcElems, srcElem->second))
+          elem.srcElems.push_back(srcElem->second);
+        if (elem.srcElems.size() > maxSrcElems)
+          return std::nullopt;
+        elem.fromOtherLane |= srcLane != lane;
+      }
+    }
+  }
+  return elems;
+}
+
 bool isSingleValue(Value value) {
   // Don't consider load as expensive if it is loading a scalar.
   if (auto tensorTy = value.getType().dyn_cast<RankedTensorType>())
@@ -383,6 +650,68 @@ private:
 };
 } // namespace
 
+// Estimated number of 32-bit registers a thread needs to hold `v`
+int64_t getNumRegisters(Value v) {
+  auto tensorType = v.getType().dyn_cast<RankedTensorType>();
+  if (!tensorType)
+    return 1;
+  // shared memory tensors only hold a base pointer
+  Attribute encoding = tensorType.getEncoding();
+  if (!encoding || encoding.isa<triton::gpu::SharedEncodingAttr>())
+    return 1;
+  Type eltTy = tensorType.getElementType();
+  int64_t bits =
+      eltTy.isa<triton::PointerType>() ? 64 : eltTy.getIntOrFloatBitWidth();
+  return ceil<int64_t>(triton::gpu::getElemsPerThread(tensorType) * bits, 32);
+}
+
+// Ops of `block` that use `v`
+static SetVector<Operation *> getInBlockUsers(Block *block, Value v) {
+  SetVector<Operation *> users;
+  for (Operation *user : v.getUsers())
+    if (Operation *ancestor = block->findAncestorOpInBlock(*user))
+      users.insert(ancestor);
+  return users;
+}
+
+// Peak number of registers held by the values defined in a block whose ops
+// run in `order`
+int64_t getPeakRegisters(Block *block, ArrayRef<Operation *> order) {
+  DenseMap<Operation *, unsigned> position;
+  for (const auto &item : llvm::enumerate(order))
+    position[item.value()] = item.index();
+  SmallVector<int64_t> delta(order.size() + 1, 0);
+  for (const auto &item : llvm::enumerate(order)) {
+    for (Value result : item.value()->getResults()) {
+      SetVector<Operation *> users = getInBlockUsers(block, result);
+      if (users.empty())
+        continue;
+      unsigned last = item.index();
+      for (Operation *user : users)
+        last = std::max(last, position.lookup(user));
+      int64_t regs = getNumRegisters(result);
+      delta[item.index()] += regs;
+      delta[last + 1] -= regs;
+    }
+  }
+  int64_t live = 0, peak = 0;
+  for (int64_t d : delta) {
+    live += d;
+    peak = std::max(peak, live);
+  }
+  return peak;
+}
+
+int64_t getPeakRegisters(Operation *op) {
+  int64_t peak = 0;
+  op->walk([&](Block *block) {
+    SmallVector<Operation *> order =
+        llvm::to_vector(llvm::make_pointer_range(*block));
+    peak = std::max(peak, getPeakRegisters(block, order));
+  });
+  return peak;
+}
+
 std::unique_ptr<DataFlowSolver> createDataFlowSolver() {
   auto solver = std::make_unique<DataFlowSolver>();
   solver->load<dataflow::DeadCodeAnalysis>();
@@ -390,4 +719,9 @@ std::unique_ptr<DataFlowSolver> createDataFlowSolver() {
   return solver;
 }
 
+void emitMissedRemark(Operation *op, StringRef pass, const Twine &reason) {
+  if (::triton::tools::getBoolEnv("TRITON_REMARKS"))
+    op->emitRemark() << "[" << pass << "] " << reason;
+}
+
 } // namespace mlir
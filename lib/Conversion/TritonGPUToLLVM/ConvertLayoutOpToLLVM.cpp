@@ -38,6 +38,20 @@ Value convertLayout(int opIdx, ConversionPatternRewriter &rewriter,
                     DotOperandEncodingAttr bEncoding,
                     const SharedMemoryObject &smemObj,
                     TritonGPUToLLVMTypeConverter *typeConverter, Value thread);
+
+Value dequantize(int opIdx, ConversionPatternRewriter &rewriter, Location loc,
+                 Value tensor, DotOperandEncodingAttr encoding,
+                 const SharedMemoryObject &smemObj, ArrayRef<int64_t> shape,
+                 Value scale, Value zero, bool isSigned,
+                 TritonGPUToLLVMTypeConverter *typeConverter, Value thread);
+}
+
+namespace SharedToDotOperandMFMA {
+Value convertLayout(int opIdx, ConversionPatternRewriter &rewriter,
+                    Location loc, Value tensor,
+                    DotOperandEncodingAttr encoding,
+                    const SharedMemoryObject &smemObj,
+                    TritonGPUToLLVMTypeConverter *typeConverter, Value thread);
 }
 
 namespace SharedToDotOperandFMA {
@@ -71,6 +85,8 @@ public:
       return lowerSharedToDotOperand(op, adaptor, rewriter);
     }
     if (isaDistributedLayout(srcLayout) && isaDistributedLayout(dstLayout)) {
+      if (auto elems = getWarpShuffleCvt(srcTy, dstTy))
+        return lowerDistributedWithWarpShuffles(op, adaptor, rewriter, *elems);
       return lowerDistributedToDistributed(op, adaptor, rewriter);
     }
     if (srcLayout.isa<MmaEncodingAttr>() &&
@@ -138,7 +154,7 @@ private:
       Value _4 = i32_val(4);
       Value _8 = i32_val(8);
       Value _16 = i32_val(16);
-      if (mmaLayout.isAmpere()) {
+      if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
         multiDimWarpId[0] = urem(multiDimWarpId[0], i32_val(shape[0] / 16));
         multiDimWarpId[1] = urem(multiDimWarpId[1], i32_val(shape[1] / 8));
         Value mmaGrpId = udiv(laneId, _4);
@@ -160,7 +176,7 @@ private:
 
       assert(rank == 2);
       SmallVector<Value> multiDimOffset(rank);
-      if (mmaLayout.isAmpere()) {
+      if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
         multiDimOffset[0] = elemId < 2 ? mmaRowIdx[0] : mmaRowIdx[1];
         multiDimOffset[1] = elemId % 2 == 0 ? mmaColIdx[0] : mmaColIdx[1];
         multiDimOffset[0] = add(
@@ -179,17 +195,30 @@ private:
       }
       return multiDimOffset;
     }
+    if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+      assert(rank == 2);
+      auto multiDimBase =
+          emitBaseIndexForLayout(loc, rewriter, mfmaLayout, type);
+      SmallVector<Value> multiDimOffset(rank);
+      multiDimOffset[0] =
+          add(multiDimBase[0], i32_val(multiDimCTAInRepId[0] * shapePerCTA[0] +
+                                       8 * (elemId / 4) + elemId % 4));
+      multiDimOffset[1] = add(multiDimBase[1], i32_val(multiDimCTAInRepId[1] *
+                                                       shapePerCTA[1]));
+      return multiDimOffset;
+    }
     llvm_unreachable("unexpected layout in getMultiDimOffset");
   }
 
-  // shared memory rd/st for blocked or mma layout with data padding
+  // shared memory rd/st for blocked or mma layout with data padding, or with
+  // the rows swizzled as `swizzle` if it is set
   void processReplica(Location loc, ConversionPatternRewriter &rewriter,
                       bool stNotRd, RankedTensorType type,
                       ArrayRef<unsigned> numCTAsEachRep,
                       ArrayRef<unsigned> multiDimRepId, unsigned vec,
                       ArrayRef<unsigned> paddedRepShape,
                       ArrayRef<unsigned> outOrd, SmallVector<Value> &vals,
-                      Value smemBase) const {
+                      Value smemBase, SharedEncodingAttr swizzle = {}) const {
     auto accumNumCTAsEachRep = product<unsigned>(numCTAsEachRep);
     auto layout = type.getEncoding();
     auto rank = type.getRank();
@@ -230,6 +259,16 @@ private:
         SmallVector<Value> multiDimOffset =
             getMultiDimOffset(layout, loc, rewriter, elemId, type,
                               multiDimCTAInRepId, shapePerCTA);
+        if (swizzle) {
+          Value swizzleVec = i32_val(swizzle.getVec());
+          Value col = multiDimOffset[outOrd[0]];
+          Value phase = urem(udiv(multiDimOffset[outOrd[1]],
+                                  i32_val(swizzle.getPerPhase())),
+                             i32_val(swizzle.getMaxPhase()));
+          multiDimOffset[outOrd[0]] =
+              add(mul(xor_(udiv(col, swizzleVec), phase), swizzleVec),
+                  urem(col, swizzleVec));
+        }
         Value offset =
             linearize(rewriter, loc, multiDimOffset, paddedRepShape, outOrd);
 
@@ -427,7 +466,9 @@ private:
                                                      rewriter, srcTy);
     unsigned inVec = 0;
     unsigned outVec = 0;
-    auto paddedRepShape = getScratchConfigForCvtLayout(op, inVec, outVec);
+    SharedEncodingAttr swizzle;
+    auto paddedRepShape =
+        getScratchConfigForCvtLayout(op, inVec, outVec, &swizzle);
 
     unsigned outElems = getElemsPerThread(dstTy);
     auto outOrd = getOrder(dstLayout);
@@ -440,7 +481,8 @@ private:
         barrier();
       if (srcLayout.isa<BlockedEncodingAttr>() ||
           srcLayout.isa<SliceEncodingAttr>() ||
-          srcLayout.isa<MmaEncodingAttr>()) {
+          srcLayout.isa<MmaEncodingAttr>() ||
+          srcLayout.isa<MfmaEncodingAttr>()) {
         if (isSrcMmaV1)
           processReplicaForMMAV1(loc, rewriter, /*stNotRd*/ true, srcTy,
                                  multiDimRepId, inVec, paddedRepShape, outOrd,
@@ -448,7 +490,7 @@ private:
         else
           processReplica(loc, rewriter, /*stNotRd*/ true, srcTy,
                          inNumCTAsEachRep, multiDimRepId, inVec, paddedRepShape,
-                         outOrd, vals, smemBase);
+                         outOrd, vals, smemBase, swizzle);
       } else {
         assert(0 && "ConvertLayout with input layout not implemented");
         return failure();
@@ -457,7 +499,8 @@ private:
       barrier();
       if (dstLayout.isa<BlockedEncodingAttr>() ||
           dstLayout.isa<SliceEncodingAttr>() ||
-          dstLayout.isa<MmaEncodingAttr>()) {
+          dstLayout.isa<MmaEncodingAttr>() ||
+          dstLayout.isa<MfmaEncodingAttr>()) {
         if (isDstMmaV1)
           processReplicaForMMAV1(loc, rewriter, /*stNotRd*/ false, dstTy,
                                  multiDimRepId, outVec, paddedRepShape, outOrd,
@@ -465,7 +508,7 @@ private:
         else
           processReplica(loc, rewriter, /*stNotRd*/ false, dstTy,
                          outNumCTAsEachRep, multiDimRepId, outVec,
-                         paddedRepShape, outOrd, outVals, smemBase);
+                         paddedRepShape, outOrd, outVals, smemBase, swizzle);
       } else {
         assert(0 && "ConvertLayout with output layout not implemented");
         return failure();
@@ -482,6 +525,103 @@ private:
     return success();
   }
 
+  // blocked/mma -> blocked/mma, within warps.
+  // Every element is read with a shuffle from the lane of the same warp that
+  // holds it in the source layout, which needs neither shared memory nor
+  // barriers.
+  LogicalResult
+  lowerDistributedWithWarpShuffles(triton::gpu::ConvertLayoutOp op,
+                                   OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   ArrayRef<WarpShuffleElem> elems) const {
+    auto loc = op.getLoc();
+    auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
+    auto dstTy = op.getResult().getType().cast<RankedTensorType>();
+    Attribute srcLayout = srcTy.getEncoding();
+    auto inVals = getTypeConverter()->unpackLLElements(loc, adaptor.getSrc(),
+                                                       rewriter, srcTy);
+    auto dstIndices = emitIndices(loc, rewriter, dstTy.getEncoding(), dstTy);
+    SmallVector<Value> outVals;
+    for (auto it : llvm::enumerate(elems)) {
+      ArrayRef<Value> index = dstIndices[it.index()];
+      ArrayRef<unsigned> srcElems = it.value().srcElems;
+      Value srcLane;
+      if (it.value().fromOtherLane)
+        srcLane = emitWarpShuffleSrcLane(loc, rewriter, srcLayout, index);
+      auto getSrcVal = [&](unsigned srcElem) -> Value {
+        Value val = inVals[srcElem];
+        return srcLane ? shflIdxSync(loc, rewriter, val, srcLane) : val;
+      };
+      // The lanes that get the element from different source elements
+      // shuffle all of them, and select theirs
+      Value val = getSrcVal(srcElems[0]);
+      if (srcElems.size() > 1) {
+        Value srcElem = emitWarpShuffleSrcElem(loc, rewriter, srcTy, index);
+        for (unsigned other : srcElems.drop_front())
+          val = select(icmp_eq(srcElem, i32_val(other)), getSrcVal(other), val);
+      }
+      outVals.push_back(val);
+    }
+    Value result =
+        getTypeConverter()->packLLElements(loc, outVals, rewriter, dstTy);
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+
+  // Emits getWarpShuffleSrcLane(layout, index)
+  Value emitWarpShuffleSrcLane(Location loc,
+                               ConversionPatternRewriter &rewriter,
+                               Attribute layout, ArrayRef<Value> index) const {
+    if (auto blocked = layout.dyn_cast<BlockedEncodingAttr>()) {
+      auto sizePerThread = blocked.getSizePerThread();
+      auto threadsPerWarp = blocked.getThreadsPerWarp();
+      Value lane = i32_val(0);
+      for (unsigned k : llvm::reverse(blocked.getOrder())) {
+        Value laneK = urem(udiv(index[k], i32_val(sizePerThread[k])),
+                           i32_val(threadsPerWarp[k]));
+        lane = add(mul(lane, i32_val(threadsPerWarp[k])), laneK);
+      }
+      return lane;
+    }
+    return add(mul(urem(index[0], i32_val(8)), i32_val(4)),
+               udiv(urem(index[1], i32_val(8)), i32_val(2)));
+  }
+
+  // Emits the position of `index` among the elements of the lane that holds
+  // it in the layout of `type`, in the order of emitIndices
+  Value emitWarpShuffleSrcElem(Location loc,
+                               ConversionPatternRewriter &rewriter,
+                               RankedTensorType type,
+                               ArrayRef<Value> index) const {
+    auto shape = type.getShape();
+    Attribute layout = type.getEncoding();
+    if (auto blocked = layout.dyn_cast<BlockedEncodingAttr>()) {
+      auto sizePerThread = blocked.getSizePerThread();
+      auto shapePerCTA = getShapePerCTA(blocked);
+      Value tile = i32_val(0);
+      Value elem = i32_val(0);
+      for (unsigned k : llvm::reverse(blocked.getOrder())) {
+        unsigned tilesPerDim = ceil<unsigned>(shape[k], shapePerCTA[k]);
+        tile = add(mul(tile, i32_val(tilesPerDim)),
+                   udiv(index[k], i32_val(shapePerCTA[k])));
+        elem = add(mul(elem, i32_val(sizePerThread[k])),
+                   urem(index[k], i32_val(sizePerThread[k])));
+      }
+      unsigned totalSizePerThread = product<unsigned>(sizePerThread);
+      return add(mul(tile, i32_val(totalSizePerThread)), elem);
+    }
+    // MMAv2: every tile of a lane holds rows r, r + 8 and columns c, c + 1
+    auto shapePerCTA = getShapePerCTA(layout);
+    unsigned colTiles = ceil<unsigned>(shape[1], shapePerCTA[1]);
+    Value tile = add(mul(udiv(index[0], i32_val(shapePerCTA[0])),
+                         i32_val(colTiles)),
+                     udiv(index[1], i32_val(shapePerCTA[1])));
+    Value elem = add(mul(udiv(urem(index[0], i32_val(16)), i32_val(8)),
+                         i32_val(2)),
+                     urem(index[1], i32_val(2)));
+    return add(mul(tile, i32_val(4)), elem);
+  }
+
   // blocked -> shared.
   // Swizzling in shared memory to avoid bank conflict. Normally used for
   // A/B operands of dots.
@@ -544,6 +684,12 @@ private:
             dotOperandLayout.getParent().dyn_cast_or_null<MmaEncodingAttr>()) {
       res = lowerSharedToDotOperandMMA(op, adaptor, rewriter, mmaLayout,
                                        dotOperandLayout, isOuter);
+    } else if (dotOperandLayout.getParent().isa<MfmaEncodingAttr>()) {
+      auto smemObj =
+          getSharedMemoryObjectFromStruct(loc, adaptor.getSrc(), rewriter);
+      res = SharedToDotOperandMFMA::convertLayout(
+          dotOperandLayout.getOpIdx(), rewriter, loc, src, dotOperandLayout,
+          smemObj, getTypeConverter(), tid_val());
     } else if (auto blockedLayout =
                    dotOperandLayout.getParent()
                        .dyn_cast_or_null<BlockedEncodingAttr>()) {
@@ -649,6 +795,11 @@ private:
           dotOperandLayout.getOpIdx(), rewriter, loc, src, dotOperandLayout,
           smemObj, getTypeConverter(), tid_val());
 
+    } else if (!isOuter && mmaLayout.isHopper() && isHMMA) { // tensor core v3
+      // wgmma reads its operands from shared memory, so they are passed to
+      // the dot as the shared memory object
+      res = adaptor.getSrc();
+
     } else if (!isOuter && mmaLayout.isVolta() && isHMMA) { // tensor core v1
       bool isMMAv1Row = dotOperandLayout.getMMAv1IsRow();
       auto srcSharedLayout = src.getType()
@@ -673,6 +824,28 @@ private:
   }
 }; // namespace triton::gpu::ConvertLayoutOp>
 
+struct DequantizeOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::DequantizeOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::DequantizeOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::DequantizeOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto dstTy = op.getType().cast<RankedTensorType>();
+    auto encoding = dstTy.getEncoding().cast<DotOperandEncodingAttr>();
+    auto smemObj =
+        getSharedMemoryObjectFromStruct(loc, adaptor.getSrc(), rewriter);
+    Value res = SharedToDotOperandMMAv2::dequantize(
+        encoding.getOpIdx(), rewriter, loc, op.getSrc(), encoding, smemObj,
+        dstTy.getShape(), adaptor.getScale(), adaptor.getZero(),
+        op.getIsSigned(), getTypeConverter(), tid_val());
+    rewriter.replaceOp(op, res);
+    return success();
+  }
+};
+
 void populateConvertLayoutOpToLLVMPatterns(
     TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     int numWarps, AxisInfoAnalysis &axisInfoAnalysis,
@@ -681,4 +854,5 @@ void populateConvertLayoutOpToLLVMPatterns(
     PatternBenefit benefit) {
   patterns.add<ConvertLayoutOpConversion>(typeConverter, allocation, smem,
                                           indexCacheInfo, benefit);
+  patterns.add<DequantizeOpConversion>(typeConverter, benefit);
 }
@@ -86,6 +86,34 @@ ValueTable getValueTableFromStruct(Value val, int K, int n0, int shapePerCTA,
   return res;
 }
 
+// Returns the number of elements of an operand a thread reads from shared
+// memory at once. Along the non-K dimension, when it is contiguous in an
+// unswizzled `layout`, the `sizePerThread` elements a thread holds are read
+// in vectors of up to 128 bits.
+int getVecSizeForMN(SharedEncodingAttr layout, bool isMNContig,
+                    int sizePerThread, int contigPerThread, int64_t extent,
+                    Type elemTy) {
+  if (!isMNContig || layout.getMaxPhase() != 1)
+    return 1;
+  int vec = 128 / std::max<unsigned>(elemTy.getIntOrFloatBitWidth(), 8);
+  while (vec > 1 && (sizePerThread % vec != 0 || contigPerThread % vec != 0 ||
+                     extent % vec != 0))
+    vec /= 2;
+  return vec;
+}
+
+// Appends the `vec` elements from `ptr` on to `vals`.
+void loadVec(Value ptr, int vec, Type elemTy, SmallVector<Value> &vals,
+             ConversionPatternRewriter &rewriter, Location loc) {
+  if (vec == 1) {
+    vals.push_back(load(ptr));
+    return;
+  }
+  Value valVec = load(bitcast(ptr, ptr_ty(vec_ty(elemTy, vec), 3)));
+  for (int j = 0; j < vec; ++j)
+    vals.push_back(extract_element(elemTy, valVec, i32_val(j)));
+}
+
 Value loadAFMA(Value A, Value llA, BlockedEncodingAttr dLayout, Value thread,
                Location loc, TritonGPUToLLVMTypeConverter *typeConverter,
                ConversionPatternRewriter &rewriter) {
@@ -136,15 +164,16 @@ Value loadAFMA(Value A, Value llA, BlockedEncodingAttr dLayout, Value thread,
 
   int mShapePerCTA = getShapePerCTAForMN(dLayout, true /*isM*/);
   int mSizePerThread = getSizePerThreadForMN(dLayout, true /*isM*/);
+  int vec = getVecSizeForMN(aLayout, !isARow, mSizePerThread,
+                            sizePerThread[order[1]], M, elemTy);
 
   for (unsigned k = 0; k < K; ++k)
     for (unsigned m = 0; m < M; m += mShapePerCTA)
-      for (unsigned mm = 0; mm < mSizePerThread; ++mm) {
+      for (unsigned mm = 0; mm < mSizePerThread; mm += vec) {
         Value offset =
             add(mul(i32_val(m + mm), strideAM), mul(i32_val(k), strideAK));
         Value pa = gep(ptrTy, aPtrs[0], offset);
-        Value va = load(pa);
-        vas.emplace_back(va);
+        loadVec(pa, vec, elemTy, vas, rewriter, loc);
       }
 
   return getStructFromValueTable(vas, rewriter, loc, typeConverter, elemTy);
@@ -200,15 +229,16 @@ Value loadBFMA(Value B, Value llB, BlockedEncodingAttr dLayout, Value thread,
 
   int nShapePerCTA = getShapePerCTAForMN(dLayout, false /*isM*/);
   int nSizePerThread = getSizePerThreadForMN(dLayout, false /*isM*/);
+  int vec = getVecSizeForMN(bLayout, isBRow, nSizePerThread,
+                            sizePerThread[order[0]], N, elemTy);
 
   for (unsigned k = 0; k < K; ++k)
     for (unsigned n = 0; n < N; n += nShapePerCTA)
-      for (unsigned nn = 0; nn < nSizePerThread; ++nn) {
+      for (unsigned nn = 0; nn < nSizePerThread; nn += vec) {
         Value offset =
             add(mul(i32_val(n + nn), strideBN), mul(i32_val(k), strideBK));
         Value pb = gep(ptrTy, bPtrs[0], offset);
-        Value vb = load(pb);
-        vbs.emplace_back(vb);
+        loadVec(pb, vec, elemTy, vbs, rewriter, loc);
       }
 
   return getStructFromValueTable(vbs, rewriter, loc, typeConverter, elemTy);
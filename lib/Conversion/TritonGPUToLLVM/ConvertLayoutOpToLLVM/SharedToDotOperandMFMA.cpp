@@ -0,0 +1,101 @@
+#include "../ConvertLayoutOpToLLVM.h"
+#include "../Utility.h"
+
+using ::mlir::triton::gpu::DotOperandEncodingAttr;
+using ::mlir::triton::gpu::MfmaEncodingAttr;
+using ::mlir::triton::gpu::SharedEncodingAttr;
+
+namespace {
+
+// Each lane holds kWidth consecutive elements along K of the 8 multiplied by
+// a v_mfma_f32_32x32x8 instruction, see DotOperandEncodingAttr.
+constexpr int kWidth = 4;
+constexpr int kInstrK = 8;
+
+} // namespace
+
+namespace SharedToDotOperandMFMA {
+
+// Loads operand `opIdx` of the MFMA instructions of a wavefront from shared
+// memory, as rep[0] x rep[1] groups of kWidth elements ordered by their
+// index along M (resp. N) first, then along K. The kWidth elements of a lane
+// are read with a single vector load when K is the contiguous dimension of
+// the swizzled layout, and one at a time otherwise.
+Value convertLayout(int opIdx, ConversionPatternRewriter &rewriter,
+                    Location loc, Value tensor, DotOperandEncodingAttr encoding,
+                    const SharedMemoryObject &smemObj,
+                    TritonGPUToLLVMTypeConverter *typeConverter, Value thread) {
+  auto tensorTy = tensor.getType().cast<RankedTensorType>();
+  auto shape = tensorTy.getShape();
+  auto sharedLayout = tensorTy.getEncoding().cast<SharedEncodingAttr>();
+  auto order = sharedLayout.getOrder();
+  unsigned vec = sharedLayout.getVec();
+  unsigned perPhase = sharedLayout.getPerPhase();
+  unsigned maxPhase = sharedLayout.getMaxPhase();
+  auto mfmaLayout = encoding.getParent().cast<MfmaEncodingAttr>();
+  auto warpsPerCTA = mfmaLayout.getWarpsPerCTA();
+  constexpr int nonKDim = MfmaEncodingAttr::kNonKDim;
+  auto rep = encoding.getMFMARep(shape);
+
+  int nonKIdx = opIdx == 0 ? 0 : 1;
+  int kIdx = opIdx == 0 ? 1 : 0;
+  int numRepNonK = rep[nonKIdx];
+  int numRepK = rep[kIdx];
+  bool isKContig = order[0] == kIdx && vec % kWidth == 0;
+
+  Value waveSize = i32_val(MfmaEncodingAttr::kWavefrontSize);
+  Value lane = urem(thread, waveSize);
+  Value wave = udiv(thread, waveSize);
+  Value waveNonK = opIdx == 0 ? urem(wave, i32_val(warpsPerCTA[0]))
+                              : urem(udiv(wave, i32_val(warpsPerCTA[0])),
+                                     i32_val(warpsPerCTA[1]));
+  Value laneNonK = add(mul(waveNonK, i32_val(nonKDim)),
+                       urem(lane, i32_val(nonKDim)));
+  Value laneK = mul(udiv(lane, i32_val(nonKDim)), i32_val(kWidth));
+
+  // Swizzling is relative to the allocation the operand is a slice of
+  Type elemTy = typeConverter->convertType(tensorTy.getElementType());
+  Type elemPtrTy = ptr_ty(elemTy, 3);
+  Value sliceOffset = add(mul(smemObj.offsets[0], smemObj.strides[0]),
+                          mul(smemObj.offsets[1], smemObj.strides[1]));
+  Value base = gep(elemPtrTy, smemObj.base, sub(i32_val(0), sliceOffset));
+  auto getPtr = [&](Value nonK, Value k) {
+    SmallVector<Value> coord(2);
+    coord[nonKIdx] = nonK;
+    coord[kIdx] = k;
+    Value col = add(coord[order[0]], smemObj.offsets[order[0]]);
+    Value row = add(coord[order[1]], smemObj.offsets[order[1]]);
+    Value phase = urem(udiv(row, i32_val(perPhase)), i32_val(maxPhase));
+    Value colOff = add(mul(xor_(udiv(col, i32_val(vec)), phase), i32_val(vec)),
+                       urem(col, i32_val(vec)));
+    Value offset = add(mul(row, smemObj.strides[order[1]]),
+                       mul(colOff, smemObj.strides[order[0]]));
+    return gep(elemPtrTy, base, offset);
+  };
+
+  Type vecTy = vec_ty(elemTy, kWidth);
+  SmallVector<Value> vals;
+  for (int nonKRep = 0; nonKRep < numRepNonK; ++nonKRep) {
+    Value nonK = urem(
+        add(laneNonK, i32_val(nonKRep * nonKDim * warpsPerCTA[nonKIdx])),
+        i32_val(shape[nonKIdx]));
+    for (int kRep = 0; kRep < numRepK; ++kRep) {
+      Value k = add(laneK, i32_val(kRep * kInstrK));
+      if (isKContig) {
+        Value ptr = bitcast(getPtr(nonK, k), ptr_ty(vecTy, 3));
+        Value valVec = load(ptr);
+        for (int j = 0; j < kWidth; ++j)
+          vals.push_back(extract_element(elemTy, valVec, i32_val(j)));
+      } else {
+        for (int j = 0; j < kWidth; ++j)
+          vals.push_back(load(getPtr(nonK, add(k, i32_val(j)))));
+      }
+    }
+  }
+
+  auto dotOpTy =
+      RankedTensorType::get(shape, tensorTy.getElementType(), encoding);
+  return typeConverter->packLLElements(loc, vals, rewriter, dotOpTy);
+}
+
+} // namespace SharedToDotOperandMFMA
@@ -217,6 +217,8 @@ SmallVector<Value> MMA16816SmemLoader::computeB8MatOffs(Value warpOff,
 
     Value cMatOff = add(mul(warpOff, i32_val(warpOffStride)),
                         mul(nkMatArr, i32_val(matArrStride)));
+    Value cSwizzleMatOff = udiv(cSwizzleOffset, i32_val(cMatShape));
+    cMatOff = add(cMatOff, cSwizzleMatOff);
     Value sMatOff = kMatArr;
 
     for (int loadx4Off = 0; loadx4Off < numPtrs / 8; ++loadx4Off) {
@@ -226,7 +228,13 @@ SmallVector<Value> MMA16816SmemLoader::computeB8MatOffs(Value warpOff,
                                               (kOrder == 1 ? 1 : 2)));
         Value sOffInMatElem = add(sOffInMat, i32_val(elemOff));
 
-        // disable swizzling ...
+        // Each of the 4 rows a thread loads has its own phase. The rows of
+        // the other matrices loaded at the same time are sMatShape apart,
+        // which is a multiple of perPhase * maxPhase, so their phase is the
+        // same.
+        Value phase =
+            urem(udiv(sOffInMatElem, i32_val(perPhase)), i32_val(maxPhase));
+        cMatOffI = xor_(cMatOffI, phase);
 
         Value cOff = add(cOffInMat, mul(cMatOffI, i32_val(cMatShape)));
         Value sOff = add(sOffInMatElem, mul(sMatOff, i32_val(sMatShape)));
@@ -458,7 +466,8 @@ Type getShemPtrTy(Type argType) {
     return ptr_ty(type::i16Ty(ctx), 3);
   else if (argType.isF32())
     return ptr_ty(type::f32Ty(ctx), 3);
-  else if (argType.isInteger(8))
+  else if (argType.isInteger(8) ||
+           argType.isa<Float8E4M3FNType, Float8E5M2Type>())
     return ptr_ty(type::i8Ty(ctx), 3);
   else
     llvm::report_fatal_error("mma16816 data type not supported");
@@ -488,7 +497,9 @@ Type getMatType(Type argType) {
     return bf16x2Pack4Ty;
   else if (argType.isF32())
     return fp32Pack4Ty;
-  else if (argType.isInteger(8))
+  // fp8 is stored as i8
+  else if (argType.isInteger(8) ||
+           argType.isa<Float8E4M3FNType, Float8E5M2Type>())
     return i8x4Pack4Ty;
   else
     llvm::report_fatal_error("mma16816 data type not supported");
@@ -687,4 +698,111 @@ Value convertLayout(int opIdx, ConversionPatternRewriter &rewriter,
                  thread);
   }
 }
+
+// Each thread loads the integers of its fragments of the operand with lds,
+// rather than with ldmatrix: the fragments of i8 follow the layout of the
+// k32 mma of i8, not the one of the f16 operand they are dequantized to.
+Value dequantize(int opIdx, ConversionPatternRewriter &rewriter, Location loc,
+                 Value tensor, DotOperandEncodingAttr encoding,
+                 const SharedMemoryObject &smemObj, ArrayRef<int64_t> shape,
+                 Value scale, Value zero, bool isSigned,
+                 TritonGPUToLLVMTypeConverter *typeConverter, Value thread) {
+  auto tensorTy = tensor.getType().cast<RankedTensorType>();
+  auto sharedLayout = tensorTy.getEncoding().cast<SharedEncodingAttr>();
+  auto mmaLayout = encoding.getParent().cast<MmaEncodingAttr>();
+  auto order = sharedLayout.getOrder();
+  int vec = sharedLayout.getVec();
+  int perPhase = sharedLayout.getPerPhase();
+  int maxPhase = sharedLayout.getMaxPhase();
+  int wpt0 = mmaLayout.getWarpsPerCTA()[0];
+  int wpt1 = mmaLayout.getWarpsPerCTA()[1];
+  int kDim = opIdx == 0 ? 1 : 0;
+  // two i4 per byte along k
+  bool isPacked = tensorTy.getShape()[kDim] != shape[kDim];
+  // the pair of i8 of consecutive k of a thread is one i16 when k is
+  // contiguous and not split by the swizzle
+  bool isPairVec =
+      !isPacked && order[0] == kDim && (vec % 2 == 0 || maxPhase == 1);
+
+  Value warp = udiv(thread, i32_val(32));
+  Value lane = urem(thread, i32_val(32));
+  Value kBase = mul(urem(lane, i32_val(4)), i32_val(2));
+  Value nonKBase;
+  int numNonK;
+  std::function<int(int)> nonKOffset;
+  auto numRep = encoding.getMMAv2Rep(shape, 16);
+  if (opIdx == 0) {
+    Value warpM = urem(urem(warp, i32_val(wpt0)), i32_val(shape[0] / 16));
+    nonKBase = add(mul(warpM, i32_val(16)), udiv(lane, i32_val(4)));
+    numNonK = 2 * numRep[0];
+    nonKOffset = [=](int i) { return 16 * wpt0 * (i / 2) + 8 * (i % 2); };
+  } else {
+    Value warpN = urem(urem(udiv(warp, i32_val(wpt0)), i32_val(wpt1)),
+                       i32_val(shape[1] / 8));
+    nonKBase = add(mul(warpN, i32_val(8)), udiv(lane, i32_val(4)));
+    numNonK = numRep[1];
+    nonKOffset = [=](int i) { return 8 * wpt1 * i; };
+  }
+
+  Value smemBase = smemObj.getBaseBeforeSwizzle(order[0], loc, rewriter);
+  Value cSwizzleOffset = smemObj.getCSwizzleOffset(order[0]);
+  Type smemPtrTy = ptr_ty(i8_ty, 3);
+  auto getPtr = [&](Value nonK, Value k) -> Value {
+    SmallVector<Value> coord(2);
+    coord[kDim] = isPacked ? udiv(k, i32_val(2)) : k;
+    coord[1 - kDim] = nonK;
+    Value inner = add(coord[order[0]], cSwizzleOffset);
+    Value outer = coord[order[1]];
+    Value phase = urem(udiv(outer, i32_val(perPhase)), i32_val(maxPhase));
+    Value vecIdx = xor_(udiv(inner, i32_val(vec)), phase);
+    inner = add(mul(vecIdx, i32_val(vec)), urem(inner, i32_val(vec)));
+    Value offset = add(mul(inner, smemObj.strides[order[0]]),
+                       mul(outer, smemObj.strides[order[1]]));
+    return gep(smemPtrTy, smemBase, offset);
+  };
+  // the integers of k and k + 1, k even
+  auto loadPair = [&](Value nonK, Value k) -> std::pair<Value, Value> {
+    if (isPacked) {
+      Value byte = load(getPtr(nonK, k));
+      Value four = int_val(8, 4);
+      if (isSigned)
+        return {rewriter.create<LLVM::AShrOp>(loc, shl(byte, four), four),
+                rewriter.create<LLVM::AShrOp>(loc, byte, four)};
+      return {and_(byte, int_val(8, 0xf)), lshr(byte, four)};
+    }
+    if (isPairVec) {
+      Value word = load(bitcast(getPtr(nonK, k), ptr_ty(i16_ty, 3)));
+      return {rewriter.create<LLVM::TruncOp>(loc, i8_ty, word),
+              rewriter.create<LLVM::TruncOp>(loc, i8_ty,
+                                             lshr(word, int_val(16, 8)))};
+    }
+    return {load(getPtr(nonK, k)),
+            load(getPtr(nonK, add(k, i32_val(1))))};
+  };
+  auto convert = [&](Value x) -> Value {
+    Value val = isSigned
+                    ? rewriter.create<LLVM::SIToFPOp>(loc, f32_ty, x)
+                          .getResult()
+                    : rewriter.create<LLVM::UIToFPOp>(loc, f32_ty, x)
+                          .getResult();
+    val = fmul(rewriter.create<LLVM::FSubOp>(loc, val, zero), scale);
+    return rewriter.create<LLVM::FPTruncOp>(loc, f16_ty, val);
+  };
+
+  // the f16x2 of the rows (A) or columns (B) i and the k of j
+  ValueTable vals;
+  Type pairTy = vec_ty(f16_ty, 2);
+  for (int i = 0; i < numNonK; ++i) {
+    Value nonK = add(nonKBase, i32_val(nonKOffset(i)));
+    for (int j = 0; j < 2 * numRep[kDim]; ++j) {
+      auto [lo, hi] = loadPair(nonK, add(kBase, i32_val(8 * j)));
+      Value pair = undef(pairTy);
+      pair = insert_element(pairTy, pair, convert(lo), i32_val(0));
+      pair = insert_element(pairTy, pair, convert(hi), i32_val(1));
+      vals[{i, j}] = pair;
+    }
+  }
+  return composeValuesToDotOperandLayoutStruct(
+      vals, numNonK / 2, numRep[kDim], typeConverter, loc, rewriter);
+}
 } // namespace SharedToDotOperandMMAv2
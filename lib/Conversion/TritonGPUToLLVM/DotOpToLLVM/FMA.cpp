@@ -77,20 +77,48 @@ LogicalResult convertFMADot(triton::DotOp op, triton::DotOp::Adaptor adaptor,
 
   SmallVector<Value> ret = cc;
   bool isCRow = order[0] == 1;
+  auto getIdx = [&](unsigned m, unsigned mm, unsigned n, unsigned nn) {
+    int mIdx = m / mShapePerCTA * mSizePerThread + mm;
+    int nIdx = n / nShapePerCTA * nSizePerThread + nn;
+    return isCRow ? mIdx * N / nShapePerCTA * mSizePerThread + nIdx
+                  : nIdx * M / mShapePerCTA * nSizePerThread + mIdx;
+  };
+
+  // Pairs of f16 along N are accumulated by fma.rn.f16x2
+  Type elemTy = dTensorTy.getElementType();
+  bool isPacked = elemTy.isF16() && aTensorTy.getElementType().isF16() &&
+                  nSizePerThread % 2 == 0;
+  Type pairTy = vec_ty(elemTy, 2);
+  auto pack = [&](Value lo, Value hi) -> Value {
+    Value pair = undef(pairTy);
+    pair = insert_element(pairTy, pair, lo, i32_val(0));
+    return insert_element(pairTy, pair, hi, i32_val(1));
+  };
 
   for (unsigned k = 0; k < K; k++) {
     for (unsigned m = 0; m < M; m += mShapePerCTA)
       for (unsigned n = 0; n < N; n += nShapePerCTA)
-        for (unsigned mm = 0; mm < mSizePerThread; ++mm)
+        for (unsigned mm = 0; mm < mSizePerThread; ++mm) {
+          Value a = has[{m + mm, k}];
+          if (isPacked) {
+            Value aPair = pack(a, a);
+            for (unsigned nn = 0; nn < nSizePerThread; nn += 2) {
+              int z0 = getIdx(m, mm, n, nn);
+              int z1 = getIdx(m, mm, n, nn + 1);
+              Value d = rewriter.create<LLVM::FMulAddOp>(
+                  loc, aPair, pack(hbs[{n + nn, k}], hbs[{n + nn + 1, k}]),
+                  pack(ret[z0], ret[z1]));
+              ret[z0] = extract_element(elemTy, d, i32_val(0));
+              ret[z1] = extract_element(elemTy, d, i32_val(1));
+            }
+            continue;
+          }
           for (unsigned nn = 0; nn < nSizePerThread; ++nn) {
-            int mIdx = m / mShapePerCTA * mSizePerThread + mm;
-            int nIdx = n / nShapePerCTA * nSizePerThread + nn;
-
-            int z = isCRow ? mIdx * N / nShapePerCTA * mSizePerThread + nIdx
-                           : nIdx * M / mShapePerCTA * nSizePerThread + mIdx;
-            ret[z] = rewriter.create<LLVM::FMulAddOp>(loc, has[{m + mm, k}],
-                                                      hbs[{n + nn, k}], ret[z]);
+            int z = getIdx(m, mm, n, nn);
+            ret[z] = rewriter.create<LLVM::FMulAddOp>(loc, a, hbs[{n + nn, k}],
+                                                      ret[z]);
           }
+        }
   }
 
   auto res = typeConverter->packLLElements(loc, ret, rewriter, dTensorTy);
@@ -0,0 +1,103 @@
+#include "../DotOpToLLVM.h"
+#include "../Utility.h"
+
+#include "mlir/Dialect/LLVMIR/ROCDLDialect.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::triton::gpu::DotOperandEncodingAttr;
+using ::mlir::triton::gpu::MfmaEncodingAttr;
+
+namespace {
+
+// The number of elements along K each lane passes to an instruction, and
+// the number of accumulators it holds.
+constexpr int kWidth = 4;
+constexpr int kNumAccs = 16;
+
+// Emits the v_mfma_f32_32x32x8 of the element type of the operands: f16 on
+// every CDNA generation, and bf16 from CDNA2 on with the .1k variant, which
+// takes bf16 operands as i16.
+Value generateMFMAOp(ConversionPatternRewriter &rewriter, Location loc,
+                     Type elemTy, Value a, Value b, Value c) {
+  auto resTy = c.getType();
+  Value zero = i32_val(0);
+  SmallVector<Value> operands = {a, b, c, zero, zero, zero};
+  if (elemTy.isF16())
+    return rewriter.create<ROCDL::mfma_f32_32x32x8f16>(loc, resTy, operands);
+  assert(elemTy.isBF16() && "Unsupported mfma operand type");
+  return rewriter.create<ROCDL::mfma_f32_32x32x8bf16_1k>(loc, resTy, operands);
+}
+
+// Groups the values of a dot operand into the vectors of kWidth elements
+// of each instruction.
+SmallVector<Value> getOperandVectors(Location loc,
+                                     ConversionPatternRewriter &rewriter,
+                                     ArrayRef<Value> elems, Type vecTy) {
+  SmallVector<Value> vecs;
+  for (size_t i = 0; i < elems.size(); i += kWidth) {
+    Value vec = undef(vecTy);
+    for (int j = 0; j < kWidth; ++j)
+      vec = insert_element(vecTy, vec, elems[i + j], i32_val(j));
+    vecs.push_back(vec);
+  }
+  return vecs;
+}
+
+} // namespace
+
+// Convert to v_mfma_f32_32x32x8, with one instruction per block of 32x32 of
+// the result held by a wavefront and per 8 elements along K, whose operands
+// are loaded by SharedToDotOperandMFMA.
+LogicalResult convertMFMA(triton::DotOp op, triton::DotOp::Adaptor adaptor,
+                          TritonGPUToLLVMTypeConverter *typeConverter,
+                          ConversionPatternRewriter &rewriter) {
+  auto loc = op.getLoc();
+  auto aTensorTy = op.getA().getType().cast<RankedTensorType>();
+  auto bTensorTy = op.getB().getType().cast<RankedTensorType>();
+  auto dTensorTy = op.getD().getType().cast<RankedTensorType>();
+  auto elemTy = aTensorTy.getElementType();
+  assert(dTensorTy.getElementType().isF32() &&
+         "mfma accumulates into f32 only");
+
+  auto aEncoding = aTensorTy.getEncoding().cast<DotOperandEncodingAttr>();
+  auto bEncoding = bTensorTy.getEncoding().cast<DotOperandEncodingAttr>();
+  auto aRep = aEncoding.getMFMARep(aTensorTy.getShape());
+  auto bRep = bEncoding.getMFMARep(bTensorTy.getShape());
+  int repM = aRep[0];
+  int repK = aRep[1];
+  int repN = bRep[1];
+  assert(repK == bRep[0] && "mismatched operands along K");
+
+  auto ha = typeConverter->unpackLLElements(loc, adaptor.getA(), rewriter,
+                                            aTensorTy);
+  auto hb = typeConverter->unpackLLElements(loc, adaptor.getB(), rewriter,
+                                            bTensorTy);
+  auto fc =
+      typeConverter->unpackLLElements(loc, adaptor.getC(), rewriter, dTensorTy);
+
+  Type llElemTy = typeConverter->convertType(elemTy);
+  Type vecTy = vec_ty(llElemTy, kWidth);
+  auto aVecs = getOperandVectors(loc, rewriter, ha, vecTy);
+  auto bVecs = getOperandVectors(loc, rewriter, hb, vecTy);
+
+  Type accTy = f32_ty;
+  Type accVecTy = vec_ty(accTy, kNumAccs);
+  for (int m = 0; m < repM; ++m)
+    for (int n = 0; n < repN; ++n) {
+      int base = (m * repN + n) * kNumAccs;
+      Value acc = undef(accVecTy);
+      for (int i = 0; i < kNumAccs; ++i)
+        acc = insert_element(accVecTy, acc, fc[base + i], i32_val(i));
+      for (int k = 0; k < repK; ++k)
+        acc = generateMFMAOp(rewriter, loc, elemTy, aVecs[m * repK + k],
+                             bVecs[n * repK + k], acc);
+      for (int i = 0; i < kNumAccs; ++i)
+        fc[base + i] = extract_element(accTy, acc, i32_val(i));
+    }
+
+  Value res = typeConverter->packLLElements(loc, fc, rewriter, dTensorTy);
+  rewriter.replaceOp(op, res);
+  return success();
+}
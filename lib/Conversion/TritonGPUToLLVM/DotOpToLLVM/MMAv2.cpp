@@ -78,6 +78,8 @@ enum class TensorCoreType : uint8_t {
   FP32_BF16_BF16_FP32,
   FP32_TF32_TF32_FP32,
   FP16_FP16_FP16_FP16,
+  FP32_FP8E4M3_FP8E4M3_FP32, // sm89+
+  FP32_FP8E5M2_FP8E5M2_FP32, // sm89+
   // integer tensor core instr
   INT32_INT1_INT1_INT32, // Not implemented
   INT32_INT4_INT4_INT32, // Not implemented
@@ -105,6 +107,10 @@ Type getMmaRetType(TensorCoreType mmaType, MLIRContext *ctx) {
     return fp32x4Ty;
   case TensorCoreType::FP16_FP16_FP16_FP16:
     return fp16x2Pack2Ty;
+  case TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32:
+    return fp32x4Ty;
+  case TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32:
+    return fp32x4Ty;
   case TensorCoreType::INT32_INT8_INT8_INT32:
     return i32x4Ty;
   default:
@@ -130,6 +136,12 @@ TensorCoreType getMmaType(triton::DotOp op) {
     if (aTy.getElementType().isF32() && bTy.getElementType().isF32() &&
         op.getAllowTF32())
       return TensorCoreType::FP32_TF32_TF32_FP32;
+    if (aTy.getElementType().isa<Float8E4M3FNType>() &&
+        bTy.getElementType().isa<Float8E4M3FNType>())
+      return TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32;
+    if (aTy.getElementType().isa<Float8E5M2Type>() &&
+        bTy.getElementType().isa<Float8E5M2Type>())
+      return TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32;
   } else if (dTy.getElementType().isInteger(32)) {
     if (aTy.getElementType().isInteger(8) && bTy.getElementType().isInteger(8))
       return TensorCoreType::INT32_INT8_INT8_INT32;
@@ -148,6 +160,10 @@ inline static const std::map<TensorCoreType, std::string> mmaInstrPtx = {
      "mma.sync.aligned.m16n8k16.row.col.f32.bf16.bf16.f32"},
     {TensorCoreType::FP32_TF32_TF32_FP32,
      "mma.sync.aligned.m16n8k8.row.col.f32.tf32.tf32.f32"},
+    {TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32,
+     "mma.sync.aligned.m16n8k32.row.col.f32.e4m3.e4m3.f32"},
+    {TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32,
+     "mma.sync.aligned.m16n8k32.row.col.f32.e5m2.e5m2.f32"},
 
     {TensorCoreType::INT32_INT1_INT1_INT32,
      "mma.sync.aligned.m16n8k256.row.col.s32.b1.b1.s32.xor.popc"},
@@ -0,0 +1,163 @@
+#include "../DotOpToLLVM.h"
+#include "../Utility.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::triton::gpu::MmaEncodingAttr;
+
+namespace {
+
+// wgmma multiplies 32 bytes of K per instruction, whatever the element type,
+// into at most 256 columns of the accumulator.
+constexpr int kInstrKBytes = 32;
+constexpr int kMaxInstrN = 256;
+
+// Returns the types of D, A and B in the wgmma instruction for `op`, and the
+// immediate operands following scale-d: the scales of A and B and, for 16-bit
+// operands, their transposition, which is none as both are K-major.
+std::pair<std::string, std::string> getWgmmaTypes(triton::DotOp op) {
+  auto aElemTy = op.getA().getType().cast<RankedTensorType>().getElementType();
+  if (aElemTy.isF16())
+    return {"f32.f16.f16", ", 1, 1, 0, 0"};
+  if (aElemTy.isBF16())
+    return {"f32.bf16.bf16", ", 1, 1, 0, 0"};
+  if (aElemTy.isF32())
+    return {"f32.tf32.tf32", ", 1, 1"};
+  if (aElemTy.isa<Float8E4M3FNType>())
+    return {"f32.e4m3.e4m3", ", 1, 1"};
+  if (aElemTy.isa<Float8E5M2Type>())
+    return {"f32.e5m2.e5m2", ", 1, 1"};
+  if (aElemTy.isInteger(8))
+    return {"s32.s8.s8", ""};
+  llvm::report_fatal_error("Unsupported wgmma operand type");
+}
+
+// Returns the descriptor of the K-major matrix in shared memory at `ptr`,
+// whose rows are `rowBytes` long and swizzled with the swizzle mode of the
+// same width, i.e.
+//   bits  0-13: the start address >> 4
+//   bits 16-29: the leading byte offset >> 4, unused as a row is one swizzle
+//   bits 32-45: the stride byte offset >> 4, from 8 rows to the next 8
+//   bits 62-63: the swizzle mode, 1 for 128B, 2 for 64B and 3 for 32B
+Value getMatrixDescriptor(Location loc, ConversionPatternRewriter &rewriter,
+                          Value ptr, int rowBytes) {
+  uint64_t swizzleMode = rowBytes == 128 ? 1 : rowBytes == 64 ? 2 : 3;
+  uint64_t fields = (uint64_t(1) << 16) |
+                    (uint64_t(8 * rowBytes >> 4) << 32) | (swizzleMode << 62);
+  Value addr = and_(ptrtoint(i32_ty, ptr), i32_val(0x3FFFF));
+  Value start = zext(i64_ty, lshr(addr, i32_val(4)));
+  return or_(start, int_val(64, static_cast<int64_t>(fields)));
+}
+
+void emitInstr(Location loc, ConversionPatternRewriter &rewriter,
+               StringRef instr) {
+  PTXBuilder builder;
+  auto &ptx = *builder.create<>(instr.str());
+  ptx();
+  builder.launch(rewriter, loc, void_ty(rewriter.getContext()));
+}
+
+} // namespace
+
+// Convert to wgmma.mma_async.m64nNkK, with both operands read from shared
+// memory. Each warpgroup of 4 warps computes 64 rows of the accumulator at a
+// time, as laid out by MmaEncodingAttr version 3.
+LogicalResult convertWGMMA(triton::DotOp op, triton::DotOp::Adaptor adaptor,
+                           TritonGPUToLLVMTypeConverter *typeConverter,
+                           ConversionPatternRewriter &rewriter, Value thread) {
+  auto loc = op.getLoc();
+  auto aTensorTy = op.getA().getType().cast<RankedTensorType>();
+  auto dTensorTy = op.getD().getType().cast<RankedTensorType>();
+  auto mmaLayout = dTensorTy.getEncoding().cast<MmaEncodingAttr>();
+  auto warpsPerCTA = mmaLayout.getWarpsPerCTA();
+  assert(warpsPerCTA[0] % 4 == 0 && warpsPerCTA[1] == 1 &&
+         "MMAv3 expects whole warpgroups along M");
+
+  auto dShape = dTensorTy.getShape();
+  int M = dShape[0];
+  int N = dShape[1];
+  int K = aTensorTy.getShape()[1];
+  int elemBytes = aTensorTy.getElementTypeBitWidth() / 8;
+  int rowBytes = K * elemBytes;
+  assert((rowBytes == 32 || rowBytes == 64 || rowBytes == 128) &&
+         "K-major operands are expected to be rows of a swizzle");
+  int instrK = kInstrKBytes / elemBytes;
+  int instrN = std::min(N, kMaxInstrN);
+  int rowsPerRep = 16 * warpsPerCTA[0];
+  int repM = M / rowsPerRep;
+  int repN = N / instrN;
+  int repK = K / instrK;
+
+  auto smemA = getSharedMemoryObjectFromStruct(loc, adaptor.getA(), rewriter);
+  auto smemB = getSharedMemoryObjectFromStruct(loc, adaptor.getB(), rewriter);
+  auto fc =
+      typeConverter->unpackLLElements(loc, adaptor.getC(), rewriter, dTensorTy);
+  Type accTy = typeConverter->convertType(dTensorTy.getElementType());
+  bool isIntMMA = dTensorTy.getElementType().isInteger(32);
+  auto [types, immediates] = getWgmmaTypes(op);
+
+  // The first row of A multiplied by the warpgroup of this thread
+  Value warpGroupRow = mul(udiv(thread, i32_val(128)), i32_val(64));
+
+  // The operands were written to shared memory through the generic proxy,
+  // and are read by wgmma through the async proxy
+  emitInstr(loc, rewriter, "fence.proxy.async.shared::cta");
+  barrier();
+  emitInstr(loc, rewriter, "wgmma.fence.sync.aligned");
+
+  int numRegs = instrN / 2;
+  std::string instr = "{\n"
+                      ".reg .pred p;\n"
+                      "setp.ne.b32 p, $" +
+                      std::to_string(numRegs + 2) +
+                      ", 0;\n"
+                      "wgmma.mma_async.sync.aligned.m64n" +
+                      std::to_string(instrN) + "k" + std::to_string(instrK) +
+                      "." + types + " {";
+  for (int r = 0; r < numRegs; ++r)
+    instr += (r ? ", $" : "$") + std::to_string(r);
+  instr += "}, $" + std::to_string(numRegs) + ", $" +
+           std::to_string(numRegs + 1) + ", p" + immediates + ";\n}";
+
+  auto elemPtrTy = smemA.base.getType();
+  Type resTy = LLVM::LLVMStructType::getLiteral(
+      rewriter.getContext(), SmallVector<Type>(numRegs, accTy));
+  for (int m = 0; m < repM; ++m)
+    for (int n = 0; n < repN; ++n)
+      for (int k = 0; k < repK; ++k) {
+        Value aOffset = add(mul(warpGroupRow, i32_val(K)),
+                            i32_val(m * rowsPerRep * K + k * instrK));
+        Value bOffset = i32_val(n * instrN * K + k * instrK);
+        Value descA = getMatrixDescriptor(
+            loc, rewriter, gep(elemPtrTy, smemA.base, aOffset), rowBytes);
+        Value descB = getMatrixDescriptor(
+            loc, rewriter, gep(elemPtrTy, smemB.base, bOffset), rowBytes);
+
+        PTXBuilder builder;
+        auto &wgmma = *builder.create<PTXInstr>(instr);
+        SmallVector<PTXBuilder::Operand *> operands;
+        for (int r = 0; r < numRegs; ++r)
+          operands.push_back(builder.newOperand(isIntMMA ? "=r" : "=f"));
+        operands.push_back(builder.newOperand(descA, "l"));
+        operands.push_back(builder.newOperand(descB, "l"));
+        operands.push_back(builder.newOperand(i32_val(1), "r"));
+        // The accumulator is read and written in place
+        int base = (m * N + n * instrN) / 2;
+        for (int r = 0; r < numRegs; ++r)
+          operands.push_back(
+              builder.newOperand(fc[base + r], std::to_string(r)));
+        wgmma(operands, /*onlyAttachMLIRArgs=*/true);
+        Value res = builder.launch(rewriter, loc, resTy);
+        for (int r = 0; r < numRegs; ++r)
+          fc[base + r] = extract_val(accTy, res, r);
+      }
+
+  // The instructions are issued back to back, and waited for all at once
+  emitInstr(loc, rewriter, "wgmma.commit_group.sync.aligned");
+  emitInstr(loc, rewriter, "wgmma.wait_group.sync.aligned 0");
+
+  Value res = typeConverter->packLLElements(loc, fc, rewriter, dTensorTy);
+  rewriter.replaceOp(op, res);
+  return success();
+}
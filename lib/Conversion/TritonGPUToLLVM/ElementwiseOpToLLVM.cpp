@@ -444,6 +444,28 @@ struct FpToFpOpConversion
     return convertFp16x4ToFp8E4M3x4(loc, rewriter, c0, c1, c2, c3);
   }
 
+  static SmallVector<Value>
+  convertFp8E5M2x4ToFp64x4(Location loc, ConversionPatternRewriter &rewriter,
+                           const Value &v0, const Value &v1, const Value &v2,
+                           const Value &v3) {
+    auto fp16Values = convertFp8E5M2x4ToFp16x4(loc, rewriter, v0, v1, v2, v3);
+    return {rewriter.create<LLVM::FPExtOp>(loc, f64_ty, fp16Values[0]),
+            rewriter.create<LLVM::FPExtOp>(loc, f64_ty, fp16Values[1]),
+            rewriter.create<LLVM::FPExtOp>(loc, f64_ty, fp16Values[2]),
+            rewriter.create<LLVM::FPExtOp>(loc, f64_ty, fp16Values[3])};
+  }
+
+  static SmallVector<Value>
+  convertFp64x4ToFp8E5M2x4(Location loc, ConversionPatternRewriter &rewriter,
+                           const Value &v0, const Value &v1, const Value &v2,
+                           const Value &v3) {
+    auto c0 = rewriter.create<LLVM::FPTruncOp>(loc, f16_ty, v0);
+    auto c1 = rewriter.create<LLVM::FPTruncOp>(loc, f16_ty, v1);
+    auto c2 = rewriter.create<LLVM::FPTruncOp>(loc, f16_ty, v2);
+    auto c3 = rewriter.create<LLVM::FPTruncOp>(loc, f16_ty, v3);
+    return convertFp16x4ToFp8E5M2x4(loc, rewriter, c0, c1, c2, c3);
+  }
+
   static Value convertBf16ToFp32(Location loc,
                                  ConversionPatternRewriter &rewriter,
                                  const Value &v) {
@@ -537,6 +559,12 @@ struct FpToFpOpConversion
         // F32 -> F8
         {{F32TyID, F8E4M3TyID}, convertFp32x4ToFp8E4M3x4},
         {{F32TyID, F8E5M2TyID}, convertFp32x4ToFp8E5M2x4},
+        // F8 -> F64
+        {{F8E4M3TyID, F64TyID}, convertFp8E4M3x4ToFp64x4},
+        {{F8E5M2TyID, F64TyID}, convertFp8E5M2x4ToFp64x4},
+        // F64 -> F8
+        {{F64TyID, F8E4M3TyID}, convertFp64x4ToFp8E4M3x4},
+        {{F64TyID, F8E5M2TyID}, convertFp64x4ToFp8E5M2x4},
     };
 
     std::pair<TypeID, TypeID> key = {srcEltType.getTypeID(),
@@ -548,18 +576,18 @@ struct FpToFpOpConversion
     }
     auto convertor = convertorMap.lookup(key);
 
-    // Vectorized casting
-    assert(elems % 4 == 0 &&
-           "FP8 casting only support tensors with 4-aligned sizes");
+    // Vectorized casting, 4 elements at a time. The last group is padded
+    // when the number of elements isn't a multiple of 4.
     auto elements = getTypeConverter()->unpackLLElements(
         loc, adaptor.getFrom(), rewriter, srcTensorType);
+    Value last = elements.back();
+    elements.resize(llvm::alignTo(elems, 4), last);
     for (size_t i = 0; i < elems; i += 4) {
       auto converted = convertor(loc, rewriter, elements[i], elements[i + 1],
                                  elements[i + 2], elements[i + 3]);
       resultVals.append(converted);
     }
-
-    assert(resultVals.size() == elems);
+    resultVals.resize(elems);
     auto result = getTypeConverter()->packLLElements(loc, resultVals, rewriter,
                                                      dstTensorType);
     rewriter.replaceOp(op, result);
@@ -593,6 +621,15 @@ public:
     auto operands = getOperands(rewriter, adaptor, resultTy, elems, loc);
     SmallVector<Value> resultVals(elems);
     for (unsigned i = 0; i < elems; ++i) {
+      if (i + 1 < elems) {
+        auto packed = concreteThis->createPackedDestOps(
+            op, adaptor, rewriter, elemTy, operands[i], operands[i + 1], loc);
+        if (!packed.empty()) {
+          resultVals[i] = packed[0];
+          resultVals[++i] = packed[1];
+          continue;
+        }
+      }
       resultVals[i] = concreteThis->createDestOp(op, adaptor, rewriter, elemTy,
                                                  operands[i], loc);
       if (!bool(resultVals[i]))
@@ -605,6 +642,16 @@ public:
     return success();
   }
 
+  // An interface to lower two elements at once with a packed instruction.
+  // Returns no values to lower them one at a time with createDestOp.
+  SmallVector<Value> createPackedDestOps(SourceOp op, OpAdaptor adaptor,
+                                         ConversionPatternRewriter &rewriter,
+                                         Type elemTy, ValueRange operands0,
+                                         ValueRange operands1,
+                                         Location loc) const {
+    return {};
+  }
+
 protected:
   SmallVector<SmallVector<Value>>
   getOperands(ConversionPatternRewriter &rewriter, OpAdaptor adaptor,
@@ -812,6 +859,41 @@ struct FDivOpConversion
   }
 };
 
+// Lowers a binary operation on two pairs of f16 or bf16 elements with one
+// x2 instruction. f16 is lowered to the vector LLVM operation `FOp`, which
+// is selected as a f16x2 instruction, and bf16 to `bf16x2Asm`.
+template <typename FOp>
+SmallVector<Value> createPacked16BitOps(ConversionPatternRewriter &rewriter,
+                                        Location loc, Type srcElemTy,
+                                        Type elemTy, ValueRange operands0,
+                                        ValueRange operands1,
+                                        const char *bf16x2Asm) {
+  if (!srcElemTy.isF16() && !srcElemTy.isBF16())
+    return {};
+  Type vecTy = vec_ty(elemTy, 2);
+  auto pack = [&](Value val0, Value val1) {
+    Value vec = undef(vecTy);
+    vec = insert_element(vecTy, vec, val0, i32_val(0));
+    return insert_element(vecTy, vec, val1, i32_val(1));
+  };
+  Value lhs = pack(operands0[0], operands1[0]);
+  Value rhs = pack(operands0[1], operands1[1]);
+  Value res;
+  if (srcElemTy.isF16()) {
+    res = rewriter.create<FOp>(loc, vecTy, lhs, rhs);
+  } else {
+    PTXBuilder builder;
+    auto &fOp = *builder.create<PTXInstr>(bf16x2Asm);
+    auto resOpr = builder.newOperand("=r");
+    auto lhsOpr = builder.newOperand(bitcast(lhs, i32_ty), "r");
+    auto rhsOpr = builder.newOperand(bitcast(rhs, i32_ty), "r");
+    fOp({resOpr, lhsOpr, rhsOpr}, /*onlyAttachMLIRArgs=*/true);
+    res = bitcast(builder.launch(rewriter, loc, i32_ty, false), vecTy);
+  }
+  return {extract_element(elemTy, res, i32_val(0)),
+          extract_element(elemTy, res, i32_val(1))};
+}
+
 struct FMulOpConversion
     : ElementwiseOpConversionBase<mlir::arith::MulFOp, FMulOpConversion> {
   using Base =
@@ -840,6 +922,20 @@ struct FMulOpConversion
                                            operands[1]);
     }
   }
+
+  SmallVector<Value> createPackedDestOps(mlir::arith::MulFOp op,
+                                         OpAdaptor adaptor,
+                                         ConversionPatternRewriter &rewriter,
+                                         Type elemTy, ValueRange operands0,
+                                         ValueRange operands1,
+                                         Location loc) const {
+    auto ptxAsm = " { .reg .b32 c;            \n"
+                  "    mov.b32 c, 0x80008000U; \n" // (-0.0, -0.0)
+                  "    fma.rn.bf16x2 $0, $1, $2, c; } \n";
+    return createPacked16BitOps<LLVM::FMulOp>(
+        rewriter, loc, getElementType(op.getLhs()), elemTy, operands0,
+        operands1, ptxAsm);
+  }
 };
 
 struct FAddOpConversion
@@ -870,6 +966,20 @@ struct FAddOpConversion
                                            operands[1]);
     }
   }
+
+  SmallVector<Value> createPackedDestOps(mlir::arith::AddFOp op,
+                                         OpAdaptor adaptor,
+                                         ConversionPatternRewriter &rewriter,
+                                         Type elemTy, ValueRange operands0,
+                                         ValueRange operands1,
+                                         Location loc) const {
+    auto ptxAsm = "{ .reg .b32 c;             \n"
+                  "   mov.b32 c, 0x3f803f80U; \n" // (1.0, 1.0)
+                  "   fma.rn.bf16x2 $0, $1, c, $2; } \n";
+    return createPacked16BitOps<LLVM::FAddOp>(
+        rewriter, loc, getElementType(op.getLhs()), elemTy, operands0,
+        operands1, ptxAsm);
+  }
 };
 
 struct FSubOpConversion
@@ -900,6 +1010,20 @@ struct FSubOpConversion
                                            operands[1]);
     }
   }
+
+  SmallVector<Value> createPackedDestOps(mlir::arith::SubFOp op,
+                                         OpAdaptor adaptor,
+                                         ConversionPatternRewriter &rewriter,
+                                         Type elemTy, ValueRange operands0,
+                                         ValueRange operands1,
+                                         Location loc) const {
+    auto ptxAsm = " { .reg .b32 c;             \n"
+                  "    mov.b32 c, 0xbf80bf80U; \n" // (-1.0, -1.0)
+                  "    fma.rn.bf16x2 $0, $2, c, $1;} \n";
+    return createPacked16BitOps<LLVM::FSubOp>(
+        rewriter, loc, getElementType(op.getLhs()), elemTy, operands0,
+        operands1, ptxAsm);
+  }
 };
 
 struct SIToFPOpConversion
@@ -3,6 +3,7 @@
 
 #include "ConvertLayoutOpToLLVM.h"
 #include "LoadStoreOpToLLVM.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
 
 using namespace mlir;
 using namespace mlir::triton;
@@ -13,8 +14,10 @@ using ::mlir::triton::gpu::SharedEncodingAttr;
 
 // Contains some helper functions for both Load and Store conversions.
 struct LoadStoreConversionBase {
-  explicit LoadStoreConversionBase(AxisInfoAnalysis &axisAnalysisPass)
-      : axisAnalysisPass(axisAnalysisPass) {}
+  explicit LoadStoreConversionBase(AxisInfoAnalysis &axisAnalysisPass,
+                                   int computeCapability = 0)
+      : axisAnalysisPass(axisAnalysisPass),
+        computeCapability(computeCapability) {}
 
   unsigned getContiguity(Value ptr) const {
     auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
@@ -37,8 +40,37 @@ struct LoadStoreConversionBase {
     return axisAnalysisPass.getMaskAlignment(mask);
   }
 
+  /// Reports the vector width chosen for a load or a store when
+  /// TRITON_REMARK_VECTOR_WIDTH is set.
+  void remarkVectorWidth(Operation *op, unsigned vec) const {
+    if (::triton::tools::getBoolEnv("TRITON_REMARK_VECTOR_WIDTH"))
+      op->emitRemark() << "vector width = " << vec;
+  }
+
+  /// Returns a 64-bit L2 cache policy for `evict`, to be passed to the
+  /// `L2::cache_hint` variants of ld and st, or a null value when `evict`
+  /// asks for no policy or the target predates sm_80.
+  Value createL2EvictPolicy(Location loc, ConversionPatternRewriter &rewriter,
+                            triton::EvictionPolicy evict) const {
+    if (computeCapability < 80 || evict == triton::EvictionPolicy::NORMAL)
+      return Value();
+    PTXBuilder ptxBuilder;
+    auto &createPolicy =
+        ptxBuilder.create<>("createpolicy")
+            ->o("fractional")
+            .o("L2::evict_first",
+               evict == triton::EvictionPolicy::EVICT_FIRST)
+            .o("L2::evict_last", evict == triton::EvictionPolicy::EVICT_LAST)
+            .b(64);
+    auto *dstOpr = ptxBuilder.newOperand("=l", /*init=*/true);
+    auto *fractionOpr = ptxBuilder.newConstantOperand("1.0");
+    createPolicy(dstOpr, fractionOpr);
+    return ptxBuilder.launch(rewriter, loc, i64_ty, /*hasSideEffect=*/false);
+  }
+
 protected:
   AxisInfoAnalysis &axisAnalysisPass;
+  int computeCapability;
 };
 
 struct LoadOpConversion
@@ -48,9 +80,10 @@ struct LoadOpConversion
       triton::LoadOp>::ConvertTritonGPUOpToLLVMPattern;
 
   LoadOpConversion(TritonGPUToLLVMTypeConverter &converter,
-                   AxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit)
+                   AxisInfoAnalysis &axisAnalysisPass, int computeCapability,
+                   PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::LoadOp>(converter, benefit),
-        LoadStoreConversionBase(axisAnalysisPass) {}
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability) {}
 
   LogicalResult
   matchAndRewrite(triton::LoadOp op, OpAdaptor adaptor,
@@ -73,8 +106,16 @@ struct LoadOpConversion
         typeConverter->convertType(getElementTypeOrSelf(valueTy));
     unsigned vec = getVectorSize(ptr);
     unsigned numElems = getElemsPerThread(ptr.getType());
+    // Masks not known to be constant over whole vectors, e.g. the bounds of
+    // ragged shapes, load each vector that is fully in bounds at runtime
+    // with a single wide load, and the others with loads of the width of
+    // the mask alignment. Volatile loads are not issued twice
+    unsigned maskVec = vec;
     if (llMask)
-      vec = std::min<size_t>(vec, getMaskAlignment(mask));
+      maskVec = std::min<size_t>(vec, getMaskAlignment(mask));
+    if (maskVec < vec && op.getIsVolatile())
+      vec = maskVec;
+    remarkVectorWidth(op, vec);
 
     // Get the LLVM values for pointers
     auto ptrElems = getTypeConverter()->unpackLLElements(loc, llPtr, rewriter,
@@ -110,10 +151,22 @@ struct LoadOpConversion
     // vectorized iteration through all the pointer/mask/other elements
     const int valueElemNBits =
         std::max(8u, valueElemTy.getIntOrFloatBitWidth());
-    const int numVecs = numElems / vec;
 
-    SmallVector<Value> loadedVals;
-    for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
+    // Volatile loads can't carry a cache hint
+    Value l2EvictPolicy =
+        op.getIsVolatile()
+            ? Value()
+            : createL2EvictPolicy(loc, rewriter, op.getEvict());
+    // PTX takes either a cache operator or L1 eviction priorities
+    bool hasCacheModifier = op.getCache() != triton::CacheModifier::NONE;
+    bool l1EvictFirst = !hasCacheModifier &&
+                        op.getEvict() == triton::EvictionPolicy::EVICT_FIRST;
+    bool l1EvictLast = !hasCacheModifier &&
+                       op.getEvict() == triton::EvictionPolicy::EVICT_LAST;
+
+    // Load the vec elements from vecStart, where pred holds
+    auto loadVector = [&](size_t vecStart, unsigned vec,
+                          Value pred) -> SmallVector<Value> {
       // TODO: optimization when ptr is GEP with constant offset
       size_t in_off = 0;
 
@@ -123,16 +176,10 @@ struct LoadOpConversion
       const size_t nWords = std::max<size_t>(1, totalWidth / width);
       const size_t wordNElems = width / valueElemNBits;
       const size_t movWidth = width < 16 ? 16 : width;
-      assert(wordNElems * nWords * numVecs == numElems);
-
-      // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
-      const bool hasL2EvictPolicy = false;
+      assert(wordNElems * nWords == vec);
 
       PTXBuilder ptxBuilder;
 
-      Value pred = mask ? maskElems[vecStart] : int_val(1, 1);
-
       const std::string readConstraint =
           (width == 64) ? "l" : ((width == 32) ? "r" : "c");
       const std::string writeConstraint =
@@ -155,19 +202,16 @@ struct LoadOpConversion
                      .global()
                      .o("ca", op.getCache() == triton::CacheModifier::CA)
                      .o("cg", op.getCache() == triton::CacheModifier::CG)
-                     .o("L1::evict_first",
-                        op.getEvict() == triton::EvictionPolicy::EVICT_FIRST)
-                     .o("L1::evict_last",
-                        op.getEvict() == triton::EvictionPolicy::EVICT_LAST)
-                     .o("L1::cache_hint", hasL2EvictPolicy)
+                     .o("cs", op.getCache() == triton::CacheModifier::CS)
+                     .o("L1::evict_first", l1EvictFirst)
+                     .o("L1::evict_last", l1EvictLast)
+                     .o("L2::cache_hint", bool(l2EvictPolicy))
                      .v(nWords)
                      .b(width);
 
       PTXBuilder::Operand *evictOpr{};
-
-      // Here lack a mlir::Value to bind to this operation, so disabled.
-      // if (has_l2_evict_policy)
-      //   evictOpr = ptxBuilder.newOperand(l2Evict, "l");
+      if (l2EvictPolicy)
+        evictOpr = ptxBuilder.newOperand(l2EvictPolicy, "l");
 
       if (!evictOpr)
         ld(dstsOpr, addrOpr).predicate(pred, "b");
@@ -211,10 +255,6 @@ struct LoadOpConversion
                        ? LLVM::LLVMStructType::getLiteral(getContext(), retTys)
                        : retTys[0];
 
-      // TODO: if (has_l2_evict_policy)
-      // auto asmDialectAttr =
-      // LLVM::AsmDialectAttr::get(rewriter.getContext(),
-      //                                                 LLVM::AsmDialect::AD_ATT);
       Value ret = ptxBuilder.launch(rewriter, loc, retTy);
 
       // Extract and store return values
@@ -231,13 +271,37 @@ struct LoadOpConversion
         rets.push_back(curr);
       }
       int tmp = width / valueElemNBits;
+      SmallVector<Value> loadedVals;
       for (size_t ii = 0; ii < vec; ++ii) {
         Value vecIdx = createIndexAttrConstant(
             rewriter, loc, this->getTypeConverter()->getIndexType(), ii % tmp);
         Value loaded = extract_element(valueElemTy, rets[ii / tmp], vecIdx);
         loadedVals.push_back(loaded);
       }
-    } // end vec
+      return loadedVals;
+    };
+
+    SmallVector<Value> loadedVals;
+    for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
+      if (maskVec == vec) {
+        Value pred = mask ? maskElems[vecStart] : int_val(1, 1);
+        auto vals = loadVector(vecStart, vec, pred);
+        loadedVals.append(vals.begin(), vals.end());
+        continue;
+      }
+      // The narrow loads are predicated off for the vectors loaded whole
+      Value inBounds = maskElems[vecStart];
+      for (size_t i = maskVec; i < vec; i += maskVec)
+        inBounds = and_(inBounds, maskElems[vecStart + i]);
+      Value notInBounds = xor_(inBounds, int_val(1, 1));
+      auto wideVals = loadVector(vecStart, vec, inBounds);
+      for (size_t i = 0; i < vec; i += maskVec) {
+        auto vals = loadVector(vecStart + i, maskVec,
+                               and_(maskElems[vecStart + i], notInBounds));
+        for (size_t ii = 0; ii < maskVec; ++ii)
+          loadedVals.push_back(select(inBounds, wideVals[i + ii], vals[ii]));
+      }
+    }
 
     Type llvmResultStructTy = getTypeConverter()->convertType(valueTy);
     Value resultStruct = getTypeConverter()->packLLElements(
@@ -254,9 +318,10 @@ struct StoreOpConversion
       triton::StoreOp>::ConvertTritonGPUOpToLLVMPattern;
 
   StoreOpConversion(TritonGPUToLLVMTypeConverter &converter,
-                    AxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit)
+                    AxisInfoAnalysis &axisAnalysisPass, int computeCapability,
+                    PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::StoreOp>(converter, benefit),
-        LoadStoreConversionBase(axisAnalysisPass) {}
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability) {}
 
   LogicalResult
   matchAndRewrite(triton::StoreOp op, OpAdaptor adaptor,
@@ -295,6 +360,7 @@ struct StoreOpConversion
       unsigned maskAlign = getMaskAlignment(mask);
       vec = std::min(vec, maskAlign);
     }
+    remarkVectorWidth(op, vec);
 
     // numElements = 1 for scalar
     auto tensorTy = valueTy.dyn_cast<RankedTensorType>();
@@ -309,6 +375,12 @@ struct StoreOpConversion
     const size_t valueElemNBits = dtsize * 8;
 
     const int numVecs = elemsPerThread / vec;
+    Value l2EvictPolicy = createL2EvictPolicy(loc, rewriter, op.getEvict());
+    bool hasCacheModifier = op.getCache() != triton::CacheModifier::NONE;
+    bool l1EvictFirst = !hasCacheModifier &&
+                        op.getEvict() == triton::EvictionPolicy::EVICT_FIRST;
+    bool l1EvictLast = !hasCacheModifier &&
+                       op.getEvict() == triton::EvictionPolicy::EVICT_LAST;
     for (size_t vecStart = 0; vecStart < elemsPerThread; vecStart += vec) {
       // TODO: optimization when ptr is AddPtr with constant offset
       size_t in_off = 0;
@@ -320,9 +392,6 @@ struct StoreOpConversion
       const size_t wordNElems = width / valueElemNBits;
       assert(wordNElems * nWords * numVecs == elemsPerThread);
 
-      // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
-
       Type valArgTy = IntegerType::get(ctx, width);
       auto wordTy = vec_ty(valueElemTy, wordNElems);
 
@@ -357,8 +426,23 @@ struct StoreOpConversion
           ptxBuilder.newAddrOperand(ptrElems[vecStart], "l", in_off);
 
       auto &ptxStoreInstr =
-          ptxBuilder.create<>("st")->global().v(nWords).b(width);
-      ptxStoreInstr(asmAddr, asmArgList).predicate(maskVal, "b");
+          ptxBuilder.create<>("st")
+              ->global()
+              .o("wb", op.getCache() == triton::CacheModifier::WB)
+              .o("cg", op.getCache() == triton::CacheModifier::CG)
+              .o("cs", op.getCache() == triton::CacheModifier::CS)
+              .o("wt", op.getCache() == triton::CacheModifier::WT)
+              .o("L1::evict_first", l1EvictFirst)
+              .o("L1::evict_last", l1EvictLast)
+              .o("L2::cache_hint", bool(l2EvictPolicy))
+              .v(nWords)
+              .b(width);
+      if (l2EvictPolicy)
+        ptxStoreInstr(asmAddr, asmArgList,
+                      ptxBuilder.newOperand(l2EvictPolicy, "l"))
+            .predicate(maskVal, "b");
+      else
+        ptxStoreInstr(asmAddr, asmArgList).predicate(maskVal, "b");
 
       Type boolTy = getTypeConverter()->convertType(rewriter.getIntegerType(1));
       llvm::SmallVector<Type> argTys({boolTy, ptr.getType()});
@@ -373,6 +457,59 @@ struct StoreOpConversion
   }
 };
 
+struct PrefetchOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::PrefetchOp>,
+      public LoadStoreConversionBase {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::PrefetchOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  PrefetchOpConversion(TritonGPUToLLVMTypeConverter &converter,
+                       AxisInfoAnalysis &axisAnalysisPass,
+                       int computeCapability, PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::PrefetchOp>(converter,
+                                                            benefit),
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability) {}
+
+  LogicalResult
+  matchAndRewrite(triton::PrefetchOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op->getLoc();
+    Value ptr = op.getPtr();
+    Value mask = op.getMask();
+    Value llMask = adaptor.getMask();
+
+    unsigned vec = getVectorSize(ptr);
+    unsigned numElems = getElemsPerThread(ptr.getType());
+    if (llMask)
+      vec = std::min<size_t>(vec, getMaskAlignment(mask));
+
+    auto ptrElems = getTypeConverter()->unpackLLElements(
+        loc, adaptor.getPtr(), rewriter, ptr.getType());
+    SmallVector<Value> maskElems;
+    if (llMask)
+      maskElems = getTypeConverter()->unpackLLElements(loc, llMask, rewriter,
+                                                       mask.getType());
+
+    // No vector is wider than a cache line, so prefetching the first
+    // element of every vector brings all of them into L2
+    bool evictLast = computeCapability >= 80 &&
+                     op.getEvict() == triton::EvictionPolicy::EVICT_LAST;
+    for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
+      PTXBuilder ptxBuilder;
+      auto &prefetch = ptxBuilder.create<>("prefetch")
+                           ->global()
+                           .o("L2", !evictLast)
+                           .o("L2::evict_last", evictLast);
+      auto *addrOpr = ptxBuilder.newAddrOperand(ptrElems[vecStart], "l");
+      Value pred = llMask ? maskElems[vecStart] : int_val(1, 1);
+      prefetch(addrOpr).predicate(pred, "b");
+      ptxBuilder.launch(rewriter, loc, void_ty(getContext()));
+    }
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 struct AtomicCASOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::AtomicCASOp>,
       public LoadStoreConversionBase {
@@ -459,10 +596,78 @@ struct AtomicRMWOpConversion
   AtomicRMWOpConversion(TritonGPUToLLVMTypeConverter &converter,
                         const Allocation *allocation, Value smem,
                         AxisInfoAnalysis &axisAnalysisPass,
-                        PatternBenefit benefit)
+                        int computeCapability, PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::AtomicRMWOp>(
             converter, allocation, smem, benefit),
-        LoadStoreConversionBase(axisAnalysisPass) {}
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability) {}
+
+  /// Combines `lhs` and `rhs` as `rmwOp` does. XCHG isn't combinable.
+  static Value combine(Location loc, ConversionPatternRewriter &rewriter,
+                       RMWOp rmwOp, Value lhs, Value rhs) {
+    Type ty = lhs.getType();
+    switch (rmwOp) {
+    case RMWOp::AND:
+      return and_(lhs, rhs);
+    case RMWOp::OR:
+      return or_(lhs, rhs);
+    case RMWOp::XOR:
+      return xor_(lhs, rhs);
+    case RMWOp::ADD:
+      return add(lhs, rhs);
+    case RMWOp::FADD:
+      return fadd(lhs, rhs);
+    case RMWOp::MAX:
+      return smax(ty, lhs, rhs);
+    case RMWOp::MIN:
+      return smin(ty, lhs, rhs);
+    case RMWOp::UMAX:
+      return umax(ty, lhs, rhs);
+    case RMWOp::UMIN:
+      return umin(ty, lhs, rhs);
+    default:
+      llvm_unreachable("unsupported atomic to aggregate");
+    }
+  }
+
+  /// Returns the index of the lowest set bit of `mask`, or 32 if none.
+  static Value lowestSetBit(Location loc, ConversionPatternRewriter &rewriter,
+                            Value mask) {
+    Value lowest = and_(mask, sub(i32_val(0), mask));
+    return rewriter.create<LLVM::CtPopOp>(loc, i32_ty,
+                                          sub(lowest, i32_val(1)));
+  }
+
+  /// Combines `val` over the lanes of the warp whose `ptr` is the same, as
+  /// in "Voting and Shuffling to Optimize Atomic Operations": the peers are
+  /// found with match.any.sync and reduced as a tree by shuffles, in at most
+  /// log2(32) steps, into the lowest peer. `pred` is narrowed to that lane,
+  /// the only one that has to issue the atomic.
+  Value aggregateByAddress(Location loc, ConversionPatternRewriter &rewriter,
+                           RMWOp rmwOp, Value ptr, Value val,
+                           Value &pred) const {
+    Value laneId = urem(tid_val(), i32_val(32));
+    Value peers = and_(matchAnySync(loc, rewriter, ptrtoint(i64_ty, ptr)),
+                       ballotSync(loc, rewriter, pred));
+    peers = select(pred, peers, i32_val(0));
+    Value leader = lowestSetBit(loc, rewriter, peers);
+    Value lowerLanes = sub(shl(i32_val(1), laneId), i32_val(1));
+    Value relPos =
+        rewriter.create<LLVM::CtPopOp>(loc, i32_ty, and_(peers, lowerLanes));
+    // Each lane only combines the values of the peers above it
+    peers = and_(peers, shl(i32_val(~1), laneId));
+    for (int step = 0; step < 5; ++step) {
+      Value next = lowestSetBit(loc, rewriter, peers);
+      Value other = shflIdxSync(loc, rewriter, val, next);
+      val = select(icmp_ne(peers, i32_val(0)),
+                   combine(loc, rewriter, rmwOp, val, other), val);
+      // The peers at an odd position are combined into their predecessor
+      Value done = icmp_ne(and_(relPos, i32_val(1)), i32_val(0));
+      peers = and_(peers, xor_(ballotSync(loc, rewriter, done), i32_val(-1)));
+      relPos = lshr(relPos, i32_val(1));
+    }
+    pred = and_(pred, icmp_eq(laneId, leader));
+    return val;
+  }
 
   LogicalResult
   matchAndRewrite(triton::AtomicRMWOp op, OpAdaptor adaptor,
@@ -494,16 +699,32 @@ struct AtomicRMWOpConversion
                  : op.getResult().getType();
     const size_t valueElemNBits = valueElemTy.getIntOrFloatBitWidth();
     auto elemsPerThread = getElemsPerThread(val.getType());
+    // The old values of unused results need not be returned, so red is
+    // issued instead of atom
+    bool isRed = tensorTy && op.getResult().use_empty() &&
+                 atomicRmwAttr != RMWOp::XCHG;
+    // Floats are added a whole vector at a time with red.global.v2/v4/v8
+    // from sm_90 on
+    bool isVectorRed = isRed && computeCapability >= 90 &&
+                       atomicRmwAttr == RMWOp::FADD &&
+                       (valueElemTy.isF32() || valueElemTy.isF16());
     // vec = 1, numElements = 1 for scalar
     auto vec = getVectorSize(ptr);
     int numElems = 1;
     // tensor
     if (tensorTy) {
       auto valTy = val.getType().cast<RankedTensorType>();
-      vec = std::min<unsigned>(vec, valTy.getElementType().isF16() ? 2 : 1);
+      if (llMask)
+        vec = std::min(vec, getMaskAlignment(op.getMask()));
+      if (!isVectorRed)
+        vec = std::min<unsigned>(vec, valTy.getElementType().isF16() ? 2 : 1);
       // mask
       numElems = tensorTy.getNumElements();
     }
+    // Scattered pointers, e.g. the bins of a histogram, may hit the same
+    // address from several lanes, which then serialize on the atomic
+    bool aggregate = isRed && vec == 1 && valueElemNBits == 32 &&
+                     computeCapability >= 70 && getContiguity(ptr) == 1;
     Value mask = int_val(1, 1);
     auto tid = tid_val();
     mask = and_(mask,
@@ -521,16 +742,37 @@ struct AtomicRMWOpConversion
 
       Value rmwPtr = ptrElements[i];
       Value rmwMask = llMask ? and_(mask, maskElements[i]) : mask;
+      if (aggregate) {
+        Value combined = aggregateByAddress(loc, rewriter, atomicRmwAttr,
+                                            rmwPtr, valElements[i], rmwMask);
+        rmwVal = insert_element(vecTy, undef(vecTy), combined, i32_val(0));
+      }
       std::string sTy;
       PTXBuilder ptxBuilderAtomicRMW;
       std::string tyId = valueElemNBits * vec == 64
                              ? "l"
                              : (valueElemNBits * vec == 32 ? "r" : "h");
-      auto *dstOpr = ptxBuilderAtomicRMW.newOperand("=" + tyId, /*init=*/true);
+      PTXBuilder::Operand *dstOpr{};
+      if (!isRed)
+        dstOpr = ptxBuilderAtomicRMW.newOperand("=" + tyId, /*init=*/true);
       auto *ptrOpr = ptxBuilderAtomicRMW.newAddrOperand(rmwPtr, "l");
-      auto *valOpr = ptxBuilderAtomicRMW.newOperand(rmwVal, tyId);
+      PTXBuilder::Operand *valOpr{};
+      if (isVectorRed) {
+        Type intTy = IntegerType::get(ctx, valueElemNBits);
+        SmallVector<std::pair<Value, std::string>> elems;
+        for (int ii = 0; ii < vec; ++ii)
+          elems.emplace_back(bitcast(valElements[i + ii], intTy),
+                             valueElemNBits == 32 ? "r" : "h");
+        valOpr = vec == 1 ? ptxBuilderAtomicRMW.newOperand(elems[0].first,
+                                                           elems[0].second)
+                          : ptxBuilderAtomicRMW.newListOperand(elems);
+      } else {
+        valOpr = ptxBuilderAtomicRMW.newOperand(rmwVal, tyId);
+      }
 
-      auto &atom = ptxBuilderAtomicRMW.create<>("atom")->global().o("gpu");
+      auto &atom = ptxBuilderAtomicRMW.create<>(isRed ? "red" : "atom")
+                       ->global()
+                       .o("gpu");
       auto rmwOp = stringifyRMWOp(atomicRmwAttr).str();
       auto sBits = std::to_string(valueElemNBits);
       switch (atomicRmwAttr) {
@@ -572,8 +814,14 @@ struct AtomicRMWOpConversion
       default:
         return failure();
       }
-      atom.o(rmwOp).o(sTy);
-      if (tensorTy) {
+      if (isVectorRed)
+        atom.o(rmwOp).v(vec).o("f" + sBits);
+      else
+        atom.o(rmwOp).o(sTy);
+      if (isRed) {
+        atom(ptrOpr, valOpr).predicate(rmwMask);
+        ptxBuilderAtomicRMW.launch(rewriter, loc, void_ty(ctx));
+      } else if (tensorTy) {
         atom(dstOpr, ptrOpr, valOpr).predicate(rmwMask);
         auto retType = vec == 1 ? valueElemTy : vecTy;
         auto ret = ptxBuilderAtomicRMW.launch(rewriter, loc, retType);
@@ -606,7 +854,9 @@ struct AtomicRMWOpConversion
         rewriter.replaceOp(op, {ret});
       }
     }
-    if (tensorTy) {
+    if (isRed) {
+      rewriter.eraseOp(op);
+    } else if (tensorTy) {
       Type structTy = getTypeConverter()->convertType(tensorTy);
       Value resultStruct = getTypeConverter()->packLLElements(
           loc, resultVals, rewriter, structTy);
@@ -845,21 +1095,241 @@ struct InsertSliceAsyncOpConversion
   }
 };
 
+struct InsertSliceTMAOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::InsertSliceTMAOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::InsertSliceTMAOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::InsertSliceTMAOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    // insert_slice_tma %desc[%indices], %dst, %index, %barriers, %pred
+    auto loc = op.getLoc();
+    auto dstTy = op.getDst().getType().cast<RankedTensorType>();
+    auto dstShape = dstTy.getShape();
+    assert(dstShape.size() == 3 && op.getIndices().size() == 2 &&
+           "insert_slice_tma: only 2D tiles are supported");
+    auto elemTy = getTypeConverter()->convertType(dstTy.getElementType());
+    unsigned bytes =
+        dstShape[1] * dstShape[2] * dstTy.getElementTypeBitWidth() / 8;
+
+    auto dstObj = getSharedMemoryObjectFromStruct(loc, adaptor.getDst(),
+                                                  rewriter);
+    SmallVector<Value> offsetVals = {adaptor.getIndex(), i32_val(0),
+                                     i32_val(0)};
+    Value dstOffset = dot(rewriter, loc, offsetVals, dstObj.strides);
+    Value dstPtr = gep(ptr_ty(elemTy, 3), dstObj.base, dstOffset);
+    auto barObj = getSharedMemoryObjectFromStruct(loc, adaptor.getBarriers(),
+                                                  rewriter);
+    Value barPtr = gep(ptr_ty(i64_ty, 3), barObj.base, adaptor.getIndex());
+
+    // Thread 0 issues the copy and arrives on the barrier, expecting the
+    // bytes of the copy. Without a copy, its arrival completes the phase
+    Value isLeader = icmp_eq(getThreadId(rewriter, loc), i32_val(0));
+    Value pred = adaptor.getPred();
+    Value isFull = and_(isLeader, pred);
+    Value isEmpty = and_(isLeader, xor_(pred, int_val(1, 1)));
+
+    // The coordinates of the tensor map are innermost first
+    auto indices = adaptor.getIndices();
+    PTXBuilder ptxBuilder;
+    auto &copy = *ptxBuilder.create<PTXInstr>(
+        "@$0 mbarrier.arrive.expect_tx.shared.b64 _, [$2], " +
+        std::to_string(bytes) +
+        ";\n"
+        "@$0 cp.async.bulk.tensor.2d.shared::cluster.global.mbarrier::"
+        "complete_tx::bytes [$3], [$4, {$5, $6}], [$2];\n"
+        "@$1 mbarrier.arrive.shared.b64 _, [$2];");
+    copy({ptxBuilder.newOperand(isFull, "b"),
+          ptxBuilder.newOperand(isEmpty, "b"),
+          ptxBuilder.newOperand(barPtr, "r"), ptxBuilder.newOperand(dstPtr, "r"),
+          ptxBuilder.newOperand(adaptor.getDesc(), "l"),
+          ptxBuilder.newOperand(indices[1], "r"),
+          ptxBuilder.newOperand(indices[0], "r")},
+         /*onlyAttachMLIRArgs=*/true);
+    ptxBuilder.launch(rewriter, loc, void_ty(getContext()));
+
+    rewriter.replaceOp(op, adaptor.getDst());
+    return success();
+  }
+};
+
+struct MBarrierWaitOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::MBarrierWaitOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::MBarrierWaitOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::MBarrierWaitOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto barObj = getSharedMemoryObjectFromStruct(loc, adaptor.getBarriers(),
+                                                  rewriter);
+    Value barPtr = gep(ptr_ty(i64_ty, 3), barObj.base, adaptor.getIndex());
+
+    // try_wait suspends the thread for a while, and is retried until the
+    // phase completes
+    PTXBuilder ptxBuilder;
+    auto &wait = *ptxBuilder.create<PTXInstr>(
+        "{\n"
+        ".reg .pred p;\n"
+        "LAB_WAIT:\n"
+        "mbarrier.try_wait.parity.shared.b64 p, [$0], $1;\n"
+        "@!p bra.uni LAB_WAIT;\n"
+        "}");
+    wait({ptxBuilder.newOperand(barPtr, "r"),
+          ptxBuilder.newOperand(adaptor.getPhase(), "r")},
+         /*onlyAttachMLIRArgs=*/true);
+    ptxBuilder.launch(rewriter, loc, void_ty(getContext()));
+
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+struct ProfileRecordOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::ProfileRecordOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::ProfileRecordOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::ProfileRecordOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto mod = op->getParentOfType<ModuleOp>();
+    int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    int capacity = op.getCapacity();
+    Value tid = getThreadId(rewriter, loc);
+    Value warpSize = i32_val(threadsPerWarp);
+    Value warp = udiv(tid, warpSize);
+    Value lane = urem(tid, warpSize);
+    Value index = adaptor.getIndex();
+    // the first thread of the warp writes the record, if the warp has room
+    // for it
+    Value pred = and_(icmp_eq(lane, i32_val(0)),
+                      icmp_slt(index, i32_val(capacity)));
+    Value slot = add(mul(warp, i32_val(capacity)), index);
+    Value ptr =
+        gep(ptr_ty(i64_ty, 1), adaptor.getBuffer(), mul(slot, i32_val(2)));
+    int64_t header = (int64_t(op.getRegionId()) + 1) << 1 | op.getIsStart();
+
+    // The timer is read right before the store, in the same asm statement,
+    // so that the compiler can't move the read away from the record
+    std::string timer = op.getGlobalTimer() ? "%globaltimer" : "%clock64";
+    PTXBuilder ptxBuilder;
+    auto &record = *ptxBuilder.create<PTXInstr>(
+        "{\n"
+        ".reg .b64 t;\n"
+        "mov.u64 t, " +
+        timer +
+        ";\n"
+        "@$0 st.global.v2.b64 [$1], {$2, t};\n"
+        "}");
+    record({ptxBuilder.newOperand(pred, "b"), ptxBuilder.newOperand(ptr, "l"),
+            ptxBuilder.newOperand(int_val(64, header), "l")},
+           /*onlyAttachMLIRArgs=*/true);
+    ptxBuilder.launch(rewriter, loc, void_ty(getContext()));
+
+    rewriter.replaceOp(op, add(index, i32_val(1)));
+    return success();
+  }
+};
+
+// The markers of kernels that are not profiled
+struct ProfileMarkerOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::ProfileMarkerOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::ProfileMarkerOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ProfileMarkerOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+struct GridBarrierOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::GridBarrierOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::GridBarrierOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::GridBarrierOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    Value numPrograms = i32_val(1);
+    for (auto dim : {mlir::gpu::Dimension::x, mlir::gpu::Dimension::y,
+                     mlir::gpu::Dimension::z}) {
+      Value gridDim = rewriter.create<::mlir::gpu::GridDimOp>(loc, dim);
+      numPrograms = mul(
+          numPrograms, rewriter.create<arith::TruncIOp>(loc, i32_ty, gridDim));
+    }
+    Value isLeader = icmp_eq(getThreadId(rewriter, loc), i32_val(0));
+
+    // The first thread of the program arrives once all its threads are done,
+    // and spins until the counter reaches the next multiple of the number of
+    // programs, which all of them arriving at this barrier add up to. The
+    // fences order the writes of the program before its arrival and the
+    // reads after the barrier after the arrival of all of them.
+    barrier();
+    PTXBuilder ptxBuilder;
+    auto &arrive = *ptxBuilder.create<PTXInstr>(
+        "{\n"
+        ".reg .pred p;\n"
+        ".reg .u32 target, count;\n"
+        "@!$0 bra LAB_DONE;\n"
+        "membar.gl;\n"
+        "atom.global.add.u32 target, [$1], 1;\n"
+        "div.u32 target, target, $2;\n"
+        "add.u32 target, target, 1;\n"
+        "mul.lo.u32 target, target, $2;\n"
+        "LAB_WAIT:\n"
+        "ld.volatile.global.u32 count, [$1];\n"
+        "setp.lt.u32 p, count, target;\n"
+        "@p bra LAB_WAIT;\n"
+        "membar.gl;\n"
+        "LAB_DONE:\n"
+        "}");
+    arrive({ptxBuilder.newOperand(isLeader, "b"),
+            ptxBuilder.newOperand(adaptor.getCounter(), "l"),
+            ptxBuilder.newOperand(numPrograms, "r")},
+           /*onlyAttachMLIRArgs=*/true);
+    ptxBuilder.launch(rewriter, loc, void_ty(getContext()));
+    barrier();
+
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 void populateLoadStoreOpToLLVMPatterns(
     TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     int numWarps, AxisInfoAnalysis &axisInfoAnalysis,
     const Allocation *allocation, Value smem,
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
-    PatternBenefit benefit) {
-  patterns.add<LoadOpConversion>(typeConverter, axisInfoAnalysis, benefit);
-  patterns.add<StoreOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+    int computeCapability, PatternBenefit benefit) {
+  patterns.add<LoadOpConversion>(typeConverter, axisInfoAnalysis,
+                                 computeCapability, benefit);
+  patterns.add<StoreOpConversion>(typeConverter, axisInfoAnalysis,
+                                  computeCapability, benefit);
+  patterns.add<PrefetchOpConversion>(typeConverter, axisInfoAnalysis,
+                                     computeCapability, benefit);
   patterns.add<AtomicCASOpConversion>(typeConverter, allocation, smem,
                                       axisInfoAnalysis, benefit);
   patterns.add<AtomicRMWOpConversion>(typeConverter, allocation, smem,
-                                      axisInfoAnalysis, benefit);
+                                      axisInfoAnalysis, computeCapability,
+                                      benefit);
   patterns.add<InsertSliceOpConversion>(typeConverter, allocation, smem,
                                         indexCacheInfo, benefit);
   patterns.add<InsertSliceAsyncOpConversion>(typeConverter, allocation, smem,
                                              indexCacheInfo, axisInfoAnalysis,
                                              benefit);
+  patterns.add<InsertSliceTMAOpConversion>(typeConverter, allocation, smem,
+                                           benefit);
+  patterns.add<MBarrierWaitOpConversion>(typeConverter, allocation, smem,
+                                         benefit);
+  patterns.add<ProfileRecordOpConversion>(typeConverter, benefit);
+  patterns.add<ProfileMarkerOpConversion>(typeConverter, benefit);
+  patterns.add<GridBarrierOpConversion>(typeConverter, benefit);
 }
@@ -3,7 +3,9 @@
 using namespace mlir;
 using namespace mlir::triton;
 
+using ::mlir::LLVM::reduxSync;
 using ::mlir::LLVM::shflSync;
+using ::mlir::LLVM::shflSyncAMD;
 using ::mlir::LLVM::storeShared;
 using ::mlir::triton::gpu::getElemsPerThread;
 using ::mlir::triton::gpu::getOrder;
@@ -11,8 +13,13 @@ using ::mlir::triton::gpu::getOrder;
 struct ReduceOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::ReduceOp> {
 public:
-  using ConvertTritonGPUOpToLLVMPattern<
-      triton::ReduceOp>::ConvertTritonGPUOpToLLVMPattern;
+  ReduceOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                     const Allocation *allocation, Value smem,
+                     IndexCacheInfo indexCacheInfo, int computeCapability,
+                     bool isROCM, PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::ReduceOp>(
+            typeConverter, allocation, smem, indexCacheInfo, benefit),
+        computeCapability(computeCapability), isROCM(isROCM) {}
 
   LogicalResult
   matchAndRewrite(triton::ReduceOp op, OpAdaptor adaptor,
@@ -23,6 +30,18 @@ public:
   }
 
 private:
+  int computeCapability;
+  bool isROCM;
+
+  // Butterfly shuffle with the lane `i` away, with shfl.sync on NVIDIA GPUs
+  // and the LDS crossbar of AMD wavefronts
+  Value shuffleXor(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                   int i) const {
+    if (isROCM)
+      return shflSyncAMD(loc, rewriter, val, i);
+    return shflSync(loc, rewriter, val, i);
+  }
+
   void accumulate(ConversionPatternRewriter &rewriter, Region &combineOp,
                   llvm::SmallVectorImpl<Value> &acc, ValueRange cur,
                   bool isFirst) const {
@@ -61,6 +80,157 @@ private:
     rewriter.eraseOp(returnOp);
   }
 
+  // Returns the redux.sync operation and type computing `op`, i.e. when it
+  // reduces a single i32 operand with one integer operation of the block
+  // arguments.
+  std::optional<std::pair<StringRef, StringRef>>
+  getReduxKind(triton::ReduceOp op) const {
+    if (computeCapability < 80 || op.getNumOperands() != 1 ||
+        !op.getElementTypes()[0].isInteger(32))
+      return std::nullopt;
+    Block &block = op.getCombineOp().front();
+    if (block.getOperations().size() != 2)
+      return std::nullopt;
+    Operation *combine = &block.front();
+    auto returnOp = cast<triton::ReduceReturnOp>(block.getTerminator());
+    if (combine->getNumOperands() != 2 || combine->getNumResults() != 1 ||
+        returnOp.getResult()[0] != combine->getResult(0))
+      return std::nullopt;
+    Value lhs = combine->getOperand(0);
+    Value rhs = combine->getOperand(1);
+    if (!((lhs == block.getArgument(0) && rhs == block.getArgument(1)) ||
+          (lhs == block.getArgument(1) && rhs == block.getArgument(0))))
+      return std::nullopt;
+    if (isa<arith::AddIOp>(combine))
+      return std::make_pair("add", "s32");
+    if (isa<arith::MinSIOp>(combine))
+      return std::make_pair("min", "s32");
+    if (isa<arith::MaxSIOp>(combine))
+      return std::make_pair("max", "s32");
+    if (isa<arith::MinUIOp>(combine))
+      return std::make_pair("min", "u32");
+    if (isa<arith::MaxUIOp>(combine))
+      return std::make_pair("max", "u32");
+    if (isa<arith::AndIOp>(combine))
+      return std::make_pair("and", "b32");
+    if (isa<arith::OrIOp>(combine))
+      return std::make_pair("or", "b32");
+    if (isa<arith::XOrIOp>(combine))
+      return std::make_pair("xor", "b32");
+    return std::nullopt;
+  }
+
+  // Exchanges two 16-bit values with a single 32-bit shuffle
+  std::pair<Value, Value> shflSyncPacked(Location loc,
+                                         ConversionPatternRewriter &rewriter,
+                                         Value val0, Value val1, int i) const {
+    Type ty = val0.getType();
+    Type vecTy = vec_ty(ty, 2);
+    Value vec = undef(vecTy);
+    vec = insert_element(vecTy, vec, val0, i32_val(0));
+    vec = insert_element(vecTy, vec, val1, i32_val(1));
+    Value packed = shuffleXor(loc, rewriter, bitcast(vec, i32_ty), i);
+    vec = bitcast(packed, vecTy);
+    return {extract_element(ty, vec, i32_val(0)),
+            extract_element(ty, vec, i32_val(1))};
+  }
+
+  // Reduces each of `accs` over `numLanes` consecutive lanes, leaving the
+  // result in all of them. 16-bit accumulators of two consecutive elements
+  // share their shuffles.
+  void warpReduce(Location loc, ConversionPatternRewriter &rewriter,
+                  triton::ReduceOp op, SmallVector<SmallVector<Value> *> &accs,
+                  unsigned numLanes) const {
+    auto *combineOp = &op.getCombineOp();
+    unsigned numOperands = op.getNumOperands();
+    if (numLanes == 32) {
+      if (auto kind = getReduxKind(op)) {
+        for (SmallVector<Value> *acc : accs)
+          (*acc)[0] = reduxSync(loc, rewriter, (*acc)[0], kind->first,
+                                kind->second);
+        return;
+      }
+    }
+    for (unsigned N = numLanes / 2; N > 0; N >>= 1) {
+      for (unsigned k = 0; k < accs.size(); k += 2) {
+        bool hasPair = k + 1 < accs.size();
+        SmallVector<Value> shfl0(numOperands);
+        SmallVector<Value> shfl1(numOperands);
+        for (unsigned i = 0; i < numOperands; ++i) {
+          Value val0 = (*accs[k])[i];
+          if (hasPair && val0.getType().isIntOrFloat() &&
+              val0.getType().getIntOrFloatBitWidth() == 16) {
+            std::tie(shfl0[i], shfl1[i]) = shflSyncPacked(
+                loc, rewriter, val0, (*accs[k + 1])[i], N);
+            continue;
+          }
+          shfl0[i] = shuffleXor(loc, rewriter, val0, N);
+          if (hasPair)
+            shfl1[i] = shuffleXor(loc, rewriter, (*accs[k + 1])[i], N);
+        }
+        accumulate(rewriter, *combineOp, *accs[k], shfl0, false);
+        if (hasPair)
+          accumulate(rewriter, *combineOp, *accs[k + 1], shfl1, false);
+      }
+    }
+  }
+
+  // Packs the results of a warp-synchronous reduction, where the result
+  // element of each thread is the accumulator of the source elements it
+  // was reduced from.
+  SmallVector<Value>
+  packWarpResults(Location loc, ConversionPatternRewriter &rewriter,
+                  triton::ReduceOp op,
+                  std::map<SmallVector<unsigned>, SmallVector<Value>> &accs)
+      const {
+    unsigned axis = op.getAxis();
+    SmallVector<Value> results(op.getNumOperands());
+    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+      auto resultTy = op.getResult()[i].getType().dyn_cast<RankedTensorType>();
+      if (!resultTy) {
+        // 0d-tensor -> scalar
+        results[i] = accs.begin()->second[i];
+        continue;
+      }
+      // nd-tensor where n >= 1
+      auto resultLayout = resultTy.getEncoding().cast<SliceEncodingAttr>();
+      auto parentTy = RankedTensorType::get(
+          resultLayout.paddedShape(resultTy.getShape()),
+          resultTy.getElementType(), resultLayout.getParent());
+      auto resultOffsets =
+          emitOffsetForLayout(resultLayout.getParent(), parentTy);
+      unsigned resultElems = getElemsPerThread(resultTy);
+      assert(resultOffsets.size() == resultElems);
+
+      SmallVector<Value> resultVals(resultElems);
+      for (unsigned j = 0; j < resultElems; ++j) {
+        SmallVector<unsigned> key = resultOffsets[j];
+        key[axis] = 0;
+        assert(accs.count(key) && "result element not reduced by thread");
+        resultVals[j] = accs[key][i];
+      }
+      results[i] = getTypeConverter()->packLLElements(loc, resultVals,
+                                                      rewriter, resultTy);
+    }
+    return results;
+  }
+
+  // Returns the scratch buffer of each operand
+  SmallVector<Value> getSmemBases(Location loc,
+                                  ConversionPatternRewriter &rewriter,
+                                  ReduceOpHelper &helper, triton::ReduceOp op,
+                                  ArrayRef<Type> elemPtrTys) const {
+    Value base = bitcast(getSharedMemoryBase(loc, rewriter, op.getOperation()),
+                         ptr_ty(i8_ty, 3));
+    auto offsets = helper.getScratchOffsetsInBytes();
+    SmallVector<Value> smemBases(op.getNumOperands());
+    for (unsigned i = 0; i < op.getNumOperands(); ++i)
+      smemBases[i] =
+          bitcast(gep(ptr_ty(i8_ty, 3), base, i32_val(offsets[i])),
+                  elemPtrTys[i]);
+    return smemBases;
+  }
+
   SmallVector<SmallVector<Value>>
   unpackInputs(Location loc, triton::ReduceOp op, OpAdaptor adaptor,
                ConversionPatternRewriter &rewriter) const {
@@ -104,7 +274,7 @@ private:
       writeIdx[axis] = udiv(index[axis], axisSizePerThread);
     }
     auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>();
-    if (mmaLayout && mmaLayout.isAmpere()) {
+    if (mmaLayout && (mmaLayout.isAmpere() || mmaLayout.isHopper())) {
       if (axis == 0) {
         // Because warpTileSize = [16, 8] and threadsPerWarp = [8, 4], each 8
         // rows in smem would correspond to a warp. The mapping
@@ -116,7 +286,7 @@ private:
         writeIdx[axis] = udiv(index[axis], axisSizePerThread);
       }
     }
-    if (mmaLayout && !mmaLayout.isAmpere()) {
+    if (mmaLayout && mmaLayout.isVolta()) {
       llvm::report_fatal_error("Unsupported layout");
     }
   }
@@ -149,16 +319,8 @@ private:
     auto indexPtrTy = LLVM::LLVMPointerType::get(llvmIndexTy, 3);
 
     auto smemShape = helper.getScratchConfigBasic();
-    unsigned elems = product<unsigned>(smemShape);
-
-    SmallVector<Value> smemBases(op.getNumOperands());
-    smemBases[0] = bitcast(
-        getSharedMemoryBase(loc, rewriter, op.getOperation()), elemPtrTys[0]);
-    for (unsigned i = 1; i < op.getNumOperands(); ++i) {
-      smemBases[i] =
-          bitcast(gep(elemPtrTys[i - 1], smemBases[i - 1], i32_val(elems)),
-                  elemPtrTys[i]);
-    }
+    SmallVector<Value> smemBases =
+        getSmemBases(loc, rewriter, helper, op, elemPtrTys);
 
     unsigned srcElems = getElemsPerThread(srcTys[0]);
     // Emits indices of the original tensor that each thread
@@ -316,19 +478,6 @@ private:
     auto llvmIndexTy = getTypeConverter()->getIndexType();
     auto indexPtrTy = LLVM::LLVMPointerType::get(llvmIndexTy, 3);
 
-    auto smemShapes = helper.getScratchConfigsFast();
-    unsigned elems = product<unsigned>(smemShapes[0]);
-    unsigned maxElems = std::max(elems, product<unsigned>(smemShapes[1]));
-
-    SmallVector<Value> smemBases(op.getNumOperands());
-    smemBases[0] = bitcast(
-        getSharedMemoryBase(loc, rewriter, op.getOperation()), elemPtrTys[0]);
-    for (unsigned i = 1; i < op.getNumOperands(); ++i) {
-      smemBases[i] =
-          bitcast(gep(elemPtrTys[i - 1], smemBases[i - 1], i32_val(maxElems)),
-                  elemPtrTys[i]);
-    }
-
     unsigned sizeIntraWarps = helper.getIntraWarpSize();
     unsigned sizeInterWarps = helper.getInterWarpSize();
 
@@ -355,12 +504,30 @@ private:
         indices[key] = srcIndices[i];
     }
 
+    // Reduce within warps
+    SmallVector<SmallVector<Value> *> warpAccs;
+    for (auto &it : accs)
+      warpAccs.push_back(&it.second);
+    warpReduce(loc, rewriter, op, warpAccs, sizeIntraWarps);
+
+    // Every lane now holds the reduction of its elements
+    if (helper.isWarpSynchronous()) {
+      rewriter.replaceOp(op, packWarpResults(loc, rewriter, op, accs));
+      return success();
+    }
+
+    auto smemShapes = helper.getScratchConfigsFast();
+    unsigned elems = product<unsigned>(smemShapes[0]);
+    SmallVector<Value> smemBases =
+        getSmemBases(loc, rewriter, helper, op, elemPtrTys);
+
+    auto threadsPerWarp = triton::gpu::getThreadsPerWarp(srcLayout);
+    unsigned numLanes = product<unsigned>(threadsPerWarp);
     Value threadId = getThreadId(rewriter, loc);
-    Value warpSize = i32_val(32);
+    Value warpSize = i32_val(numLanes);
     Value warpId = udiv(threadId, warpSize);
     Value laneId = urem(threadId, warpSize);
 
-    auto threadsPerWarp = triton::gpu::getThreadsPerWarp(srcLayout);
     auto warpsPerCTA = triton::gpu::getWarpsPerCTA(srcLayout);
     auto order = getOrder(srcLayout);
     SmallVector<Value> multiDimLaneId =
@@ -378,15 +545,6 @@ private:
       const SmallVector<unsigned> &key = it.first;
       SmallVector<Value> acc = it.second;
 
-      // Reduce within warps
-      for (unsigned N = sizeIntraWarps / 2; N > 0; N >>= 1) {
-        SmallVector<Value> shfl(op.getNumOperands());
-        for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-          shfl[i] = shflSync(loc, rewriter, acc[i], N);
-        }
-        accumulate(rewriter, *combineOp, acc, shfl, false);
-      }
-
       SmallVector<Value> writeIdx = indices[key];
       writeIdx[axis] = (sizeInterWarps == 1) ? zero : warpIdAxis;
       Value writeOffset =
@@ -406,7 +564,7 @@ private:
     // Each thread needs to process:
     //   elemsPerThread = sizeInterWarps * s1 * s2 .. Sn / numThreads
     unsigned numThreads =
-        product<unsigned>(triton::gpu::getWarpsPerCTA(srcLayout)) * 32;
+        product<unsigned>(triton::gpu::getWarpsPerCTA(srcLayout)) * numLanes;
     unsigned elemsPerThread = std::max<unsigned>(elems / numThreads, 1);
     Value readOffset = threadId;
     for (unsigned round = 0; round < elemsPerThread; ++round) {
@@ -421,7 +579,7 @@ private:
       for (unsigned N = sizeInterWarps / 2; N > 0; N >>= 1) {
         SmallVector<Value> shfl(op.getNumOperands());
         for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-          shfl[i] = shflSync(loc, rewriter, acc[i], N);
+          shfl[i] = shuffleXor(loc, rewriter, acc[i], N);
         }
         accumulate(rewriter, *combineOp, acc, shfl, false);
       }
@@ -491,7 +649,8 @@ void populateReduceOpToLLVMPatterns(
     int numWarps, AxisInfoAnalysis &axisInfoAnalysis,
     const Allocation *allocation, Value smem,
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
-    PatternBenefit benefit) {
+    int computeCapability, bool isROCM, PatternBenefit benefit) {
   patterns.add<ReduceOpConversion>(typeConverter, allocation, smem,
-                                   indexCacheInfo, benefit);
+                                   indexCacheInfo, computeCapability, isROCM,
+                                   benefit);
 }
@@ -11,6 +11,6 @@ void populateReduceOpToLLVMPatterns(
     int numWarps, AxisInfoAnalysis &axisInfoAnalysis,
     const Allocation *allocation, Value smem,
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
-    PatternBenefit benefit);
+    int computeCapability, bool isROCM, PatternBenefit benefit);
 
 #endif
@@ -0,0 +1,301 @@
+#include "ScanOpToLLVM.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::LLVM::shflIdxSync;
+using ::mlir::LLVM::storeShared;
+using ::mlir::triton::gpu::getElemsPerThread;
+using ::mlir::triton::gpu::getOrder;
+
+// Lowers an inclusive scan along the axis of a blocked layout in three
+// stages: each thread scans its contiguous elements, the lanes of each warp
+// scan the last element of their threads with shuffles, and, if the axis
+// spans several warps or repetitions of the layout, the partial scans of
+// the warps are exchanged through shared memory. The combine region is only
+// assumed to be associative, so accumulators always come first.
+struct ScanOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::ScanOp> {
+public:
+  ScanOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                   const Allocation *allocation, Value smem,
+                   IndexCacheInfo indexCacheInfo, bool isROCM,
+                   PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::ScanOp>(
+            typeConverter, allocation, smem, indexCacheInfo, benefit),
+        isROCM(isROCM) {}
+
+  LogicalResult
+  matchAndRewrite(triton::ScanOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override;
+
+private:
+  bool isROCM;
+
+  // Returns the combination of `acc` then `cur` by a new copy of the combine
+  // region, inlined at the insertion point
+  SmallVector<Value> combine(ConversionPatternRewriter &rewriter,
+                             triton::ScanOp op, ValueRange acc,
+                             ValueRange cur) const {
+    Block *currentBlock = rewriter.getBlock();
+    Region &parent = *currentBlock->getParent();
+    rewriter.cloneRegionBefore(op.getCombineOp(), &parent.front());
+    auto &newScan = parent.front();
+    auto returnOp = cast<triton::ScanReturnOp>(newScan.getTerminator());
+
+    SmallVector<Value> combineArgs(acc.begin(), acc.end());
+    combineArgs.append(cur.begin(), cur.end());
+    rewriter.mergeBlockBefore(&newScan, &*rewriter.getInsertionPoint(),
+                              combineArgs);
+
+    SmallVector<Value> results(returnOp.getResult().begin(),
+                               returnOp.getResult().end());
+    // Delete the terminator, which is no longer used
+    rewriter.eraseOp(returnOp);
+    return results;
+  }
+
+  SmallVector<Value> selectAll(ConversionPatternRewriter &rewriter,
+                               Location loc, Value pred, ValueRange trueVals,
+                               ValueRange falseVals) const {
+    SmallVector<Value> results;
+    for (auto [trueVal, falseVal] : llvm::zip(trueVals, falseVals))
+      results.push_back(select(pred, trueVal, falseVal));
+    return results;
+  }
+
+  // Returns the values of the lane `delta` before, or the own values of the
+  // lanes without one, which `pred` tells
+  SmallVector<Value> shuffleUp(ConversionPatternRewriter &rewriter,
+                               Location loc, ValueRange vals, Value laneId,
+                               unsigned delta, Value pred) const {
+    Value lane = select(pred, sub(laneId, i32_val(delta)), laneId);
+    SmallVector<Value> results;
+    for (Value val : vals)
+      results.push_back(shflIdxSync(loc, rewriter, val, lane));
+    return results;
+  }
+
+  SmallVector<SmallVector<Value>>
+  unpackInputs(Location loc, triton::ScanOp op, OpAdaptor adaptor,
+               ConversionPatternRewriter &rewriter) const {
+    auto types = op.getInputTypes();
+    auto operands = adaptor.getOperands();
+    unsigned srcElems = getElemsPerThread(types[0]);
+    SmallVector<SmallVector<Value>> srcValues(srcElems);
+    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+      auto values = getTypeConverter()->unpackLLElements(loc, operands[i],
+                                                         rewriter, types[i]);
+      assert(values.size() == srcValues.size());
+      for (unsigned j = 0; j < srcValues.size(); ++j)
+        srcValues[j].push_back(values[j]);
+    }
+    return srcValues;
+  }
+};
+
+LogicalResult
+ScanOpConversion::matchAndRewrite(triton::ScanOp op, OpAdaptor adaptor,
+                                  ConversionPatternRewriter &rewriter) const {
+  ScanLoweringHelper helper(op);
+  if (isROCM || !helper.isSupported())
+    return op.emitError("scans are only lowered from blocked layouts of "
+                        "integers or floats on NVIDIA GPUs");
+
+  Location loc = op.getLoc();
+  unsigned axis = helper.getAxis();
+  unsigned numOperands = op.getNumOperands();
+  auto srcTys = op.getInputTypes();
+  auto srcLayout = helper.getSrcLayout();
+  auto srcShape = helper.getSrcShape();
+
+  unsigned elemsPerThread = helper.getAxisNumElementsPerThread();
+  unsigned numLanes = helper.getAxisNumThreadsPerWarp();
+  unsigned laneStride = helper.getAxisThreadStride();
+  unsigned numWarps = helper.getAxisNumWarps();
+  unsigned numBlocks = helper.getAxisNumBlocks();
+
+  // Group the elements of the thread by their position off the axis, in
+  // order along it
+  auto srcValues = unpackInputs(loc, op, adaptor, rewriter);
+  auto offsets = emitOffsetForLayout(srcLayout, srcTys[0]);
+  std::map<SmallVector<unsigned>, SmallVector<unsigned>> groups;
+  for (unsigned i = 0; i < offsets.size(); ++i) {
+    SmallVector<unsigned> key = offsets[i];
+    key[axis] = 0;
+    groups[key].push_back(i);
+  }
+  for (auto &it : groups) {
+    llvm::sort(it.second, [&](unsigned a, unsigned b) {
+      return offsets[a][axis] < offsets[b][axis];
+    });
+    assert(it.second.size() == elemsPerThread * numBlocks);
+  }
+
+  auto threadsPerWarp = triton::gpu::getThreadsPerWarp(srcLayout);
+  auto warpsPerCTA = triton::gpu::getWarpsPerCTA(srcLayout);
+  auto order = getOrder(srcLayout);
+  Value threadId = getThreadId(rewriter, loc);
+  Value warpSize = i32_val(product<unsigned>(threadsPerWarp));
+  Value laneId = urem(threadId, warpSize);
+  Value warpId = udiv(threadId, warpSize);
+  // Lanes and warps past the size of the axis hold copies of the ones before
+  Value laneIdAxis =
+      urem(delinearize(rewriter, loc, laneId, threadsPerWarp, order)[axis],
+           i32_val(numLanes));
+  Value warpIdAxis =
+      urem(delinearize(rewriter, loc, warpId, warpsPerCTA, order)[axis],
+           i32_val(numWarps));
+
+  // The scan of each block of the layout within its warp, in each group
+  std::map<SmallVector<unsigned>, SmallVector<SmallVector<Value>>> warpScans;
+  for (auto &[key, ids] : groups) {
+    for (unsigned block = 0; block < numBlocks; ++block) {
+      auto chunk = ArrayRef<unsigned>(ids).slice(block * elemsPerThread,
+                                                 elemsPerThread);
+      // Scan the contiguous elements of the thread
+      for (unsigned j = 1; j < elemsPerThread; ++j)
+        srcValues[chunk[j]] = combine(rewriter, op, srcValues[chunk[j - 1]],
+                                      srcValues[chunk[j]]);
+
+      // Scan the last elements of the lanes along the axis
+      SmallVector<Value> acc = srcValues[chunk.back()];
+      for (unsigned i = 1; i < numLanes; i <<= 1) {
+        Value pred = icmp_uge(laneIdAxis, i32_val(i));
+        auto shfl =
+            shuffleUp(rewriter, loc, acc, laneId, i * laneStride, pred);
+        acc = selectAll(rewriter, loc, pred,
+                        combine(rewriter, op, shfl, acc), acc);
+      }
+      // and combine the scan of the lanes before with the other elements
+      if (numLanes > 1 && elemsPerThread > 1) {
+        Value pred = icmp_ugt(laneIdAxis, i32_val(0));
+        auto prefix = shuffleUp(rewriter, loc, acc, laneId, laneStride, pred);
+        for (unsigned id : chunk.drop_back())
+          srcValues[id] =
+              selectAll(rewriter, loc, pred,
+                        combine(rewriter, op, prefix, srcValues[id]),
+                        srcValues[id]);
+        srcValues[chunk.back()] = acc;
+      }
+      warpScans[key].push_back(acc);
+    }
+  }
+
+  if (helper.getScratchElemsPerOperand() > 0) {
+    // The last lane of each warp writes the scan of the warp at
+    //   ((block * numWarps) + warp) * nonAxisElems + position off the axis
+    SmallVector<Type> elemTys(numOperands);
+    SmallVector<Value> smemBases(numOperands);
+    Value base = bitcast(getSharedMemoryBase(loc, rewriter, op.getOperation()),
+                         ptr_ty(i8_ty, 3));
+    auto smemOffsets = helper.getScratchOffsetsInBytes();
+    for (unsigned i = 0; i < numOperands; ++i) {
+      Type ty = getTypeConverter()->convertType(srcTys[i].getElementType());
+      // Booleans are stored as bytes
+      elemTys[i] = ty.isInteger(1) ? i8_ty : ty;
+      smemBases[i] =
+          bitcast(gep(ptr_ty(i8_ty, 3), base, i32_val(smemOffsets[i])),
+                  ptr_ty(elemTys[i], 3));
+    }
+
+    SmallVector<unsigned> nonAxisShape;
+    for (unsigned d = 0; d < srcShape.size(); ++d)
+      if (d != axis)
+        nonAxisShape.push_back(srcShape[d]);
+    unsigned nonAxisElems = helper.getNonAxisNumElements();
+    auto indices = emitIndices(loc, rewriter, srcLayout, srcTys[0]);
+    std::map<SmallVector<unsigned>, Value> nonAxisOffsets;
+    for (auto &[key, ids] : groups) {
+      SmallVector<Value> index = indices[ids.front()];
+      index.erase(index.begin() + axis);
+      nonAxisOffsets[key] = linearize(rewriter, loc, index, nonAxisShape);
+    }
+    auto getPtr = [&](unsigned i, Value slot,
+                      const SmallVector<unsigned> &key) {
+      Value offset =
+          add(mul(slot, i32_val(nonAxisElems)), nonAxisOffsets[key]);
+      return gep(ptr_ty(elemTys[i], 3), smemBases[i], offset);
+    };
+
+    Value isLastLane = icmp_eq(laneIdAxis, i32_val(numLanes - 1));
+    for (auto &[key, scans] : warpScans) {
+      for (unsigned block = 0; block < numBlocks; ++block) {
+        Value slot = add(i32_val(block * numWarps), warpIdAxis);
+        for (unsigned i = 0; i < numOperands; ++i) {
+          Value val = scans[block][i];
+          if (val.getType() != elemTys[i])
+            val = zext(elemTys[i], val);
+          storeShared(rewriter, loc, getPtr(i, slot, key), val, isLastLane);
+        }
+      }
+    }
+
+    barrier();
+
+    // Each thread combines the scans of the warps and blocks before it with
+    // its elements
+    for (auto &[key, ids] : groups) {
+      SmallVector<Value> carry;
+      for (unsigned block = 0; block < numBlocks; ++block) {
+        SmallVector<Value> total;
+        SmallVector<Value> prefix;
+        for (unsigned warp = 0; warp < numWarps; ++warp) {
+          SmallVector<Value> scan(numOperands);
+          for (unsigned i = 0; i < numOperands; ++i) {
+            scan[i] = load(getPtr(i, i32_val(block * numWarps + warp), key));
+            if (scan[i].getType() != srcValues[ids.front()][i].getType())
+              scan[i] = rewriter.create<LLVM::TruncOp>(
+                  loc, srcValues[ids.front()][i].getType(), scan[i]);
+          }
+          if (warp == 0) {
+            total = scan;
+            prefix = scan;
+            continue;
+          }
+          if (warp > 1)
+            prefix = selectAll(rewriter, loc,
+                               icmp_eq(warpIdAxis, i32_val(warp)), total,
+                               prefix);
+          total = combine(rewriter, op, total, scan);
+        }
+
+        auto chunk = ArrayRef<unsigned>(ids).slice(block * elemsPerThread,
+                                                   elemsPerThread);
+        for (unsigned id : chunk) {
+          if (numWarps > 1) {
+            Value pred = icmp_ugt(warpIdAxis, i32_val(0));
+            srcValues[id] =
+                selectAll(rewriter, loc, pred,
+                          combine(rewriter, op, prefix, srcValues[id]),
+                          srcValues[id]);
+          }
+          if (!carry.empty())
+            srcValues[id] = combine(rewriter, op, carry, srcValues[id]);
+        }
+        carry = carry.empty() ? total : combine(rewriter, op, carry, total);
+      }
+    }
+  }
+
+  SmallVector<Value> results(numOperands);
+  for (unsigned i = 0; i < numOperands; ++i) {
+    SmallVector<Value> resultVals;
+    for (const auto &vals : srcValues)
+      resultVals.push_back(vals[i]);
+    results[i] = getTypeConverter()->packLLElements(loc, resultVals, rewriter,
+                                                    srcTys[i]);
+  }
+  rewriter.replaceOp(op, results);
+  return success();
+}
+
+void populateScanOpToLLVMPatterns(
+    TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    int numWarps, AxisInfoAnalysis &axisInfoAnalysis,
+    const Allocation *allocation, Value smem,
+    ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+    bool isROCM, PatternBenefit benefit) {
+  patterns.add<ScanOpConversion>(typeConverter, allocation, smem,
+                                 indexCacheInfo, isROCM, benefit);
+}
@@ -251,7 +251,7 @@ struct AssertOpConversion
     auto elems = getTypeConverter()->unpackLLElements(
         loc, adaptor.getCondition(), rewriter, op.getCondition().getType());
     auto elemTy = elems[0].getType();
-    Value condition = int_val(elemTy.getIntOrFloatBitWidth(), 0);
+    Value condition = int_val(1, 0);
     for (auto elem : elems) {
       if (elemTy.isSignedInteger() || elemTy.isSignlessInteger()) {
         condition =
@@ -271,21 +271,43 @@ struct AssertOpConversion
 
   // op: the op at which the assert is inserted. Unlike printf, we need to
   // know about the op to split the block.
-  static void llAssert(Operation *op, Value condition, StringRef message,
-                       StringRef file, StringRef func, int line,
-                       ConversionPatternRewriter &rewriter) {
+  //
+  // The fast path is a single vote of the warp on `condition` and a branch
+  // that is uniform over the warp and hinted as not taken, so that the
+  // reporting blocks are laid out of line. Only the lowest failing lane of
+  // a failing warp reports, __assertfail aborting the kernel anyway.
+  void llAssert(Operation *op, Value condition, StringRef message,
+                StringRef file, StringRef func, int line,
+                ConversionPatternRewriter &rewriter) const {
     ConversionPatternRewriter::InsertionGuard guard(rewriter);
     auto ctx = rewriter.getContext();
     auto loc = op->getLoc();
 
     // #block1
-    // if (condition) {
+    // failed = ballot(condition)
+    // if (expect(failed != 0, false)) {
     //   #block2
-    //   __assertfail(message);
+    //   if (laneId == lowest set bit of failed) {
+    //     #block3
+    //     __assertfail(message);
+    //   }
     // }
-    // #block3
+    // #block4
     Block *prevBlock = op->getBlock();
-    Block *ifBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+    rewriter.setInsertionPoint(op);
+    Value failed = ballotSync(loc, rewriter, condition);
+    Value anyFailed = rewriter.create<LLVM::ExpectOp>(
+        loc, icmp_ne(failed, i32_val(0)), int_val(1, 0));
+
+    Block *coldBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+    rewriter.setInsertionPointToStart(coldBlock);
+    Value lowest = and_(failed, sub(i32_val(0), failed));
+    Value leader =
+        rewriter.create<LLVM::CtPopOp>(loc, i32_ty, sub(lowest, i32_val(1)));
+    Value laneId = urem(getThreadId(rewriter, loc), i32_val(32));
+    Value isLeader = icmp_eq(laneId, leader);
+
+    Block *ifBlock = rewriter.splitBlock(coldBlock, op->getIterator());
     rewriter.setInsertionPointToStart(ifBlock);
 
     auto funcOp = getAssertfailDeclaration(rewriter);
@@ -308,8 +330,10 @@ struct AssertOpConversion
     Block *thenBlock = rewriter.splitBlock(ifBlock, op->getIterator());
     rewriter.setInsertionPointToEnd(ifBlock);
     rewriter.create<cf::BranchOp>(loc, thenBlock);
+    rewriter.setInsertionPointToEnd(coldBlock);
+    rewriter.create<cf::CondBranchOp>(loc, isLeader, ifBlock, thenBlock);
     rewriter.setInsertionPointToEnd(prevBlock);
-    rewriter.create<cf::CondBranchOp>(loc, condition, ifBlock, thenBlock);
+    rewriter.create<cf::CondBranchOp>(loc, anyFailed, coldBlock, thenBlock);
   }
 
   static LLVM::LLVMFuncOp
@@ -492,6 +516,48 @@ struct AllocTensorOpConversion
   }
 };
 
+struct AllocMBarrierOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::AllocMBarrierOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::AllocMBarrierOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::AllocMBarrierOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    auto ctx = op.getContext();
+    Value smemBase = getSharedMemoryBase(loc, rewriter, op.getResult());
+    auto resultTy = op.getType().cast<RankedTensorType>();
+    auto elemPtrTy = ptr_ty(i64_ty, 3);
+    smemBase = bitcast(smemBase, elemPtrTy);
+
+    // Thread 0 initializes the barriers once the memory they take is no
+    // longer in use, and makes them visible to the others and to TMA
+    Value isLeader = icmp_eq(getThreadId(rewriter, loc), i32_val(0));
+    barrier();
+    for (int64_t i = 0; i < resultTy.getShape()[0]; ++i) {
+      PTXBuilder ptxBuilder;
+      auto &init = *ptxBuilder.create<PTXInstr>(
+          "@$0 mbarrier.init.shared.b64 [$1], 1;");
+      init({ptxBuilder.newOperand(isLeader, "b"),
+            ptxBuilder.newOperand(gep(elemPtrTy, smemBase, i32_val(i)), "r")},
+           /*onlyAttachMLIRArgs=*/true);
+      ptxBuilder.launch(rewriter, loc, void_ty(ctx));
+    }
+    PTXBuilder ptxBuilder;
+    auto &fence = *ptxBuilder.create<>("fence.mbarrier_init.release.cluster");
+    fence();
+    ptxBuilder.launch(rewriter, loc, void_ty(ctx));
+    barrier();
+
+    auto smemObj = SharedMemoryObject(smemBase, resultTy.getShape(), {0}, loc,
+                                      rewriter);
+    auto retVal = getStructFromSharedMemoryObject(loc, smemObj, rewriter);
+    rewriter.replaceOp(op, retVal);
+    return success();
+  }
+};
+
 struct ExtractSliceOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::ExtractSliceOp> {
   using ConvertTritonGPUOpToLLVMPattern<
@@ -620,6 +686,8 @@ void populateTritonGPUToLLVMPatterns(
   patterns.add<AddPtrOpConversion>(typeConverter, benefit);
   patterns.add<AllocTensorOpConversion>(typeConverter, allocation, smem,
                                         benefit);
+  patterns.add<AllocMBarrierOpConversion>(typeConverter, allocation, smem,
+                                          benefit);
   patterns.add<AsyncCommitGroupOpConversion>(typeConverter, benefit);
   patterns.add<AsyncWaitOpConversion>(typeConverter, benefit);
   patterns.add<BroadcastOpConversion>(typeConverter, benefit);
@@ -18,6 +18,7 @@ using namespace mlir::triton;
 using ::mlir::LLVM::SharedMemoryObject;
 using ::mlir::triton::gpu::BlockedEncodingAttr;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
+using ::mlir::triton::gpu::MfmaEncodingAttr;
 using ::mlir::triton::gpu::MmaEncodingAttr;
 using ::mlir::triton::gpu::SliceEncodingAttr;
 
@@ -169,14 +170,19 @@ struct CacheKeyDenseMapInfo {
 
 class ConvertTritonGPUOpToLLVMPatternBase {
 public:
-  // Two levels of value cache in emitting indices calculation:
+  // Two levels of value cache in emitting indices calculation, emitted at
+  // the start of the function being lowered and cleared when moving on to
+  // the next one, and a cache of the constant offsets of each element of a
+  // thread, shared by all functions:
   // Key: pair<layout, shape>
   struct IndexCacheInfo {
     DenseMap<IndexCacheKeyT, SmallVector<Value>, CacheKeyDenseMapInfo>
-        *baseIndexCache;
+        *baseIndexCache = nullptr;
     DenseMap<IndexCacheKeyT, SmallVector<SmallVector<Value>>,
-             CacheKeyDenseMapInfo> *indexCache;
-    OpBuilder::InsertPoint *indexInsertPoint;
+             CacheKeyDenseMapInfo> *indexCache = nullptr;
+    OpBuilder::InsertPoint *indexInsertPoint = nullptr;
+    DenseMap<IndexCacheKeyT, SmallVector<SmallVector<unsigned>>,
+             CacheKeyDenseMapInfo> *offsetCache = nullptr;
   };
 
   explicit ConvertTritonGPUOpToLLVMPatternBase(
@@ -507,6 +513,7 @@ public:
     auto cache = indexCacheInfo.baseIndexCache;
     assert(cache && "baseIndexCache is nullptr");
     auto insertPt = indexCacheInfo.indexInsertPoint;
+    clearIndexCacheOfOtherFunction(rewriter);
     if (cache->count(key) > 0) {
       return cache->lookup(key);
     } else {
@@ -519,8 +526,11 @@ public:
       } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
         if (mmaLayout.isVolta())
           result = emitBaseIndexForMmaLayoutV1(loc, rewriter, mmaLayout, type);
-        if (mmaLayout.isAmpere())
+        // The accumulator of wgmma has the layout of mma.16816's
+        if (mmaLayout.isAmpere() || mmaLayout.isHopper())
           result = emitBaseIndexForMmaLayoutV2(loc, rewriter, mmaLayout, type);
+      } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+        result = emitBaseIndexForMfmaLayout(loc, rewriter, mfmaLayout, type);
       } else {
         llvm_unreachable("unsupported emitBaseIndexForLayout");
       }
@@ -532,14 +542,28 @@ public:
 
   SmallVector<SmallVector<unsigned>>
   emitOffsetForLayout(Attribute layout, RankedTensorType type) const {
+    auto cache = indexCacheInfo.offsetCache;
+    if (!cache)
+      return computeOffsetForLayout(layout, type);
+    IndexCacheKeyT key(layout, type);
+    auto it = cache->find(key);
+    if (it == cache->end())
+      it = cache->try_emplace(key, computeOffsetForLayout(layout, type)).first;
+    return it->second;
+  }
+
+  SmallVector<SmallVector<unsigned>>
+  computeOffsetForLayout(Attribute layout, RankedTensorType type) const {
     if (auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>())
       return emitOffsetForBlockedLayout(blockedLayout, type);
     if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
       if (mmaLayout.isVolta())
         return emitOffsetForMmaLayoutV1(mmaLayout, type);
-      if (mmaLayout.isAmpere())
+      if (mmaLayout.isAmpere() || mmaLayout.isHopper())
         return emitOffsetForMmaLayoutV2(mmaLayout, type);
     }
+    if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>())
+      return emitOffsetForMfmaLayout(mfmaLayout, type);
     llvm_unreachable("unsupported emitOffsetForLayout");
   }
 
@@ -554,6 +578,7 @@ public:
     auto cache = indexCacheInfo.indexCache;
     assert(cache && "indexCache is nullptr");
     auto insertPt = indexCacheInfo.indexInsertPoint;
+    clearIndexCacheOfOtherFunction(b);
     if (cache->count(key) > 0) {
       return cache->lookup(key);
     } else {
@@ -564,6 +589,8 @@ public:
         result = emitIndicesForDistributedLayout(loc, b, blocked, type);
       } else if (auto mma = layout.dyn_cast<MmaEncodingAttr>()) {
         result = emitIndicesForDistributedLayout(loc, b, mma, type);
+      } else if (auto mfma = layout.dyn_cast<MfmaEncodingAttr>()) {
+        result = emitIndicesForDistributedLayout(loc, b, mfma, type);
       } else if (auto slice = layout.dyn_cast<SliceEncodingAttr>()) {
         result = emitIndicesForSliceLayout(loc, b, slice, type);
       } else {
@@ -589,6 +616,25 @@ private:
     }
   }
 
+  // Indices emitted at the start of another function, or by a previous run
+  // before any insertion point was set, can't be used in the one being
+  // lowered
+  void clearIndexCacheOfOtherFunction(
+      ConversionPatternRewriter &rewriter) const {
+    auto insertPt = indexCacheInfo.indexInsertPoint;
+    if (insertPt->isSet()) {
+      Operation *parent = rewriter.getInsertionBlock()->getParentOp();
+      auto func = dyn_cast<LLVM::LLVMFuncOp>(parent);
+      if (!func)
+        func = parent->getParentOfType<LLVM::LLVMFuncOp>();
+      if (insertPt->getBlock()->getParentOp() == func.getOperation())
+        return;
+    }
+    indexCacheInfo.baseIndexCache->clear();
+    indexCacheInfo.indexCache->clear();
+    *insertPt = OpBuilder::InsertPoint();
+  }
+
   // -----------------------------------------------------------------------
   // Blocked layout indices
   // -----------------------------------------------------------------------
@@ -598,12 +644,13 @@ private:
       Location loc, ConversionPatternRewriter &rewriter,
       const BlockedEncodingAttr &blocked_layout, RankedTensorType type) const {
     auto shape = type.getShape();
+    auto sizePerThread = blocked_layout.getSizePerThread();
+    auto threadsPerWarp = blocked_layout.getThreadsPerWarp();
     Value threadId = getThreadId(rewriter, loc);
-    Value warpSize = i32_val(32);
+    // 32 lanes on NVIDIA GPUs, 64 on AMD wavefronts
+    Value warpSize = i32_val(product<unsigned>(threadsPerWarp));
     Value laneId = urem(threadId, warpSize);
     Value warpId = udiv(threadId, warpSize);
-    auto sizePerThread = blocked_layout.getSizePerThread();
-    auto threadsPerWarp = blocked_layout.getThreadsPerWarp();
     auto warpsPerCTA = blocked_layout.getWarpsPerCTA();
     auto order = blocked_layout.getOrder();
     unsigned rank = shape.size();
@@ -857,6 +904,53 @@ private:
     return ret;
   }
 
+  // -----------------------------------------------------------------------
+  // Mfma layout indices
+  // -----------------------------------------------------------------------
+
+  // The first row and the column of the block of the wavefront of this
+  // thread held by its lane, see MfmaEncodingAttr.
+  SmallVector<Value>
+  emitBaseIndexForMfmaLayout(Location loc, ConversionPatternRewriter &rewriter,
+                             const MfmaEncodingAttr &mfmaLayout,
+                             RankedTensorType type) const {
+    auto shape = type.getShape();
+    auto _warpsPerCTA = mfmaLayout.getWarpsPerCTA();
+    assert(_warpsPerCTA.size() == 2);
+    constexpr unsigned nonKDim = MfmaEncodingAttr::kNonKDim;
+    Value threadId = getThreadId(rewriter, loc);
+    Value warpSize = i32_val(MfmaEncodingAttr::kWavefrontSize);
+    Value laneId = urem(threadId, warpSize);
+    Value warpId = udiv(threadId, warpSize);
+    SmallVector<Value> warpsPerCTA = {i32_val(_warpsPerCTA[0]),
+                                      i32_val(_warpsPerCTA[1])};
+    Value warpId0 = urem(urem(warpId, warpsPerCTA[0]),
+                         i32_val(ceil<unsigned>(shape[0], nonKDim)));
+    Value warpId1 = urem(urem(udiv(warpId, warpsPerCTA[0]), warpsPerCTA[1]),
+                         i32_val(ceil<unsigned>(shape[1], nonKDim)));
+
+    SmallVector<Value> multiDimBase(2);
+    multiDimBase[0] = add(mul(udiv(laneId, i32_val(nonKDim)), i32_val(4)),
+                          mul(warpId0, i32_val(nonKDim)));
+    multiDimBase[1] =
+        add(urem(laneId, i32_val(nonKDim)), mul(warpId1, i32_val(nonKDim)));
+    return multiDimBase;
+  }
+
+  SmallVector<SmallVector<unsigned>>
+  emitOffsetForMfmaLayout(const MfmaEncodingAttr &mfmaLayout,
+                          RankedTensorType type) const {
+    auto shape = type.getShape();
+    auto shapePerCTA = getShapePerCTA(mfmaLayout);
+    SmallVector<SmallVector<unsigned>> ret;
+
+    for (unsigned i = 0; i < shape[0]; i += shapePerCTA[0])
+      for (unsigned j = 0; j < shape[1]; j += shapePerCTA[1])
+        for (unsigned elem = 0; elem < 16; ++elem)
+          ret.push_back({i + 8 * (elem / 4) + elem % 4, j});
+    return ret;
+  }
+
   // Emit indices calculation within each ConversionPattern, and returns a
   // [elemsPerThread X rank] index matrix.
   SmallVector<SmallVector<Value>> emitIndicesForDistributedLayout(
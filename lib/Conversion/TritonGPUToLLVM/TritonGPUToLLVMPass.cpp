@@ -26,6 +26,7 @@
 #include "ElementwiseOpToLLVM.h"
 #include "LoadStoreOpToLLVM.h"
 #include "ReduceOpToLLVM.h"
+#include "ScanOpToLLVM.h"
 #include "TritonGPUToLLVM.h"
 #include "TypeConverter.h"
 #include "ViewOpToLLVM.h"
@@ -142,17 +143,22 @@ public:
     TritonGPUToLLVMTypeConverter typeConverter(context, option);
     TritonLLVMConversionTarget target(*context, isROCM);
     int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
 
     /* preprocess */
-    decomposeMmaToDotOperand(mod, numWarps);
+    decomposeMmaToDotOperand(mod, numWarps, threadsPerWarp);
     decomposeBlockedToDotOperand(mod);
     if (failed(decomposeInsertSliceAsyncOp(mod)))
       return signalPassFailure();
 
     /* allocate shared memory and set barrier */
-    Allocation allocation(mod);
+    Allocation allocation(mod, bestFitAllocation
+                                   ? AllocationPolicy::BestFit
+                                   : AllocationPolicy::FirstFit);
+    sharedMemoryFragmentation += allocation.getFragmentation();
     MembarAnalysis membarPass(&allocation);
     membarPass.run();
+    numRemovedBarriers += membarPass.getNumRemovedBarriers();
 
     /* lower functions */
     {
@@ -178,13 +184,15 @@ public:
     mod->setAttr("triton_gpu.shared",
                  mlir::IntegerAttr::get(mlir::IntegerType::get(context, 32),
                                         allocation.getSharedMemorySize()));
+    mod->setAttr("triton_gpu.shared_buffers",
+                 getSharedMemoryBufferReport(allocation));
 
     /* rewrite ops */
     RewritePatternSet patterns(context);
     // TritonGPU lowering patterns
     OpBuilder::InsertPoint indexInsertPoint;
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo indexCacheInfo{
-        &baseIndexCache, &indexCache, &indexInsertPoint};
+        &baseIndexCache, &indexCache, &indexInsertPoint, &offsetCache};
     auto populatePatterns1 = [&](auto populateFunc) {
       populateFunc(typeConverter, patterns, numWarps, *axisInfoAnalysis,
                    &allocation, smem, indexCacheInfo, /*benefit*/ 1);
@@ -197,8 +205,17 @@ public:
     populatePatterns1(populateConvertLayoutOpToLLVMPatterns);
     populatePatterns2(populateDotOpToLLVMPatterns);
     populatePatterns2(populateElementwiseOpToLLVMPatterns);
-    populatePatterns1(populateLoadStoreOpToLLVMPatterns);
-    populatePatterns1(populateReduceOpToLLVMPatterns);
+    populateLoadStoreOpToLLVMPatterns(typeConverter, patterns, numWarps,
+                                      *axisInfoAnalysis, &allocation, smem,
+                                      indexCacheInfo, computeCapability,
+                                      /*benefit*/ 1);
+    populateReduceOpToLLVMPatterns(typeConverter, patterns, numWarps,
+                                   *axisInfoAnalysis, &allocation, smem,
+                                   indexCacheInfo, computeCapability, isROCM,
+                                   /*benefit*/ 1);
+    populateScanOpToLLVMPatterns(typeConverter, patterns, numWarps,
+                                 *axisInfoAnalysis, &allocation, smem,
+                                 indexCacheInfo, isROCM, /*benefit*/ 1);
     populatePatterns2(populateViewOpToLLVMPatterns);
 
     // Native lowering patterns
@@ -224,6 +241,9 @@ private:
   DenseMap<IndexCacheKeyT, SmallVector<SmallVector<Value>>,
            CacheKeyDenseMapInfo>
       indexCache;
+  DenseMap<IndexCacheKeyT, SmallVector<SmallVector<unsigned>>,
+           CacheKeyDenseMapInfo>
+      offsetCache;
 
   int computeCapability{};
   bool isROCM{};
@@ -253,7 +273,8 @@ private:
     smem = b.create<LLVM::BitcastOp>(loc, ptrTy, smem);
   }
 
-  void decomposeMmaToDotOperand(ModuleOp mod, int numWarps) const {
+  void decomposeMmaToDotOperand(ModuleOp mod, int numWarps,
+                                int threadsPerWarp) const {
     // Replace `mma -> dot_op` with `mma -> blocked -> dot_op`
     // unless certain conditions are met
     mod.walk([&](triton::gpu::ConvertLayoutOp cvtOp) -> void {
@@ -269,7 +290,7 @@ private:
             dstType.getShape(), dstType.getElementType(),
             triton::gpu::BlockedEncodingAttr::get(
                 mod.getContext(), srcType.getShape(), getSizePerThread(srcMma),
-                getOrder(srcMma), numWarps));
+                getOrder(srcMma), numWarps, threadsPerWarp));
         auto tmp = builder.create<triton::gpu::ConvertLayoutOp>(
             cvtOp.getLoc(), tmpType, cvtOp.getOperand());
         auto newConvert = builder.create<triton::gpu::ConvertLayoutOp>(
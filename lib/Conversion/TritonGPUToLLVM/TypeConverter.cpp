@@ -86,7 +86,22 @@ SmallVector<Value> TritonGPUToLLVMTypeConverter::unpackLLElements(
   ArrayRef<Type> types =
       llvmStruct.getType().cast<LLVM::LLVMStructType>().getBody();
   SmallVector<Value> results(types.size());
+  // Structs packed by packLLElements are unpacked into the values they were
+  // packed from rather than extracted back, so that large tensors do not
+  // leave chains of extracts of inserts, quadratic for LLVM to fold, between
+  // each pair of converted ops. The last insert into a field is its value.
+  Value container = llvmStruct;
+  while (auto insert = container.getDefiningOp<LLVM::InsertValueOp>()) {
+    ArrayRef<int64_t> position = insert.getPosition();
+    if (position.size() != 1)
+      break;
+    if (!results[position[0]])
+      results[position[0]] = insert.getValue();
+    container = insert.getContainer();
+  }
   for (unsigned i = 0; i < types.size(); ++i) {
+    if (results[i])
+      continue;
     Type type = types[i];
     results[i] = extract_val(type, llvmStruct, i);
   }
@@ -102,7 +117,7 @@ Type TritonGPUToLLVMTypeConverter::getElementTypeForStruct(
   if (!dotOpLayout)
     return elemTy;
   auto mmaParent = dotOpLayout.getParent().dyn_cast<MmaEncodingAttr>();
-  if (!mmaParent)
+  if (!mmaParent || mmaParent.isHopper())
     return elemTy;
   if (mmaParent.isAmpere()) {
     int bitwidth = elemTy.getIntOrFloatBitWidth();
@@ -130,7 +145,14 @@ Type TritonGPUToLLVMTypeConverter::convertTritonTensorType(
   SmallVector<int64_t> shape(type.getShape().begin(), type.getShape().end());
   Type eltType = getElementTypeForStruct(type);
 
-  if (auto shared_layout = layout.dyn_cast<SharedEncodingAttr>()) {
+  // wgmma reads its operands from shared memory, so the operands of MMAv3
+  // dots are kept as the shared memory object they are loaded from
+  bool isMmaV3Operand = false;
+  if (auto dotOpLayout = layout.dyn_cast<DotOperandEncodingAttr>())
+    if (auto mmaParent = dotOpLayout.getParent().dyn_cast<MmaEncodingAttr>())
+      isMmaV3Operand = mmaParent.isHopper();
+
+  if (layout.isa<SharedEncodingAttr>() || isMmaV3Operand) {
     SmallVector<Type, 4> types;
     // base ptr
     auto ptrType = LLVM::LLVMPointerType::get(eltType, 3);
@@ -1,6 +1,8 @@
 #include "Utility.h"
 #include "TypeConverter.h"
 
+#include "mlir/Dialect/LLVMIR/ROCDLDialect.h"
+
 namespace mlir {
 
 namespace LLVM {
@@ -112,6 +114,127 @@ Value shflSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
   return builder.launch(rewriter, loc, val.getType(), false);
 }
 
+Value shflIdxSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                  Value lane) {
+  Type ty = val.getType();
+  if (ty.isa<LLVM::LLVMPointerType>()) {
+    Value i = shflIdxSync(loc, rewriter, ptrtoint(i64_ty, val), lane);
+    return inttoptr(ty, i);
+  }
+  unsigned bits = ty.getIntOrFloatBitWidth();
+
+  if (bits == 64) {
+    Type vecTy = vec_ty(f32_ty, 2);
+    Value vec = bitcast(val, vecTy);
+    Value val0 = extract_element(f32_ty, vec, i32_val(0));
+    Value val1 = extract_element(f32_ty, vec, i32_val(1));
+    val0 = shflIdxSync(loc, rewriter, val0, lane);
+    val1 = shflIdxSync(loc, rewriter, val1, lane);
+    vec = undef(vecTy);
+    vec = insert_element(vecTy, vec, val0, i32_val(0));
+    vec = insert_element(vecTy, vec, val1, i32_val(1));
+    return bitcast(vec, ty);
+  }
+
+  if (bits < 32) {
+    Type intTy = rewriter.getIntegerType(bits);
+    Value i = zext(i32_ty, bitcast(val, intTy));
+    i = shflIdxSync(loc, rewriter, i, lane);
+    return bitcast(rewriter.create<LLVM::TruncOp>(loc, intTy, i), ty);
+  }
+
+  PTXBuilder builder;
+  auto &shfl = builder.create("shfl.sync")->o("idx").o("b32");
+  auto *dOpr = builder.newOperand("=r");
+  auto *aOpr = builder.newOperand(val, "r");
+  auto *bOpr = builder.newOperand(lane, "r");
+  auto *cOpr = builder.newConstantOperand("0x1f");
+  auto *maskOpr = builder.newConstantOperand("0xffffffff");
+  shfl(dOpr, aOpr, bOpr, cOpr, maskOpr);
+  return builder.launch(rewriter, loc, ty, false);
+}
+
+Value shflSyncAMD(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                  int i) {
+  Type ty = val.getType();
+  unsigned bits = ty.getIntOrFloatBitWidth();
+
+  if (bits == 64) {
+    Type vecTy = vec_ty(i32_ty, 2);
+    Value vec = bitcast(val, vecTy);
+    Value val0 = extract_element(i32_ty, vec, i32_val(0));
+    Value val1 = extract_element(i32_ty, vec, i32_val(1));
+    val0 = shflSyncAMD(loc, rewriter, val0, i);
+    val1 = shflSyncAMD(loc, rewriter, val1, i);
+    vec = undef(vecTy);
+    vec = insert_element(vecTy, vec, val0, i32_val(0));
+    vec = insert_element(vecTy, vec, val1, i32_val(1));
+    return bitcast(vec, ty);
+  }
+
+  // The LDS crossbar moves 32-bit registers
+  Type intTy = rewriter.getIntegerType(bits);
+  Value src = bitcast(val, intTy);
+  if (bits < 32)
+    src = zext(i32_ty, src);
+
+  Value dst;
+  if (i < 32) {
+    // Bit-masked mode: lane ^ xor_mask over the lanes of each half, with
+    // the and_mask 0x1f keeping all the bits of the lane id
+    Value offset = i32_val((i << 10) | 0x1f);
+    dst = rewriter.create<ROCDL::DsSwizzleOp>(loc, i32_ty, src, offset);
+  } else {
+    assert(i == 32 && "a wavefront has 64 lanes");
+    // The lane id counts the lanes below this one
+    Value ones = i32_val(-1);
+    Value lane =
+        rewriter.create<ROCDL::MbcntLoOp>(loc, i32_ty, ones, i32_val(0));
+    lane = rewriter.create<ROCDL::MbcntHiOp>(loc, i32_ty, ones, lane);
+    Value byteAddr = shl(xor_(lane, i32_val(i)), i32_val(2));
+    dst = rewriter.create<ROCDL::DsBpermuteOp>(loc, i32_ty, byteAddr, src);
+  }
+
+  if (bits < 32)
+    dst = rewriter.create<LLVM::TruncOp>(loc, intTy, dst);
+  return bitcast(dst, ty);
+}
+
+Value reduxSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                StringRef kind, StringRef type) {
+  PTXBuilder builder;
+  auto &redux = builder.create("redux.sync")->o(kind.str()).o(type.str());
+  auto *dOpr = builder.newOperand("=r");
+  auto *aOpr = builder.newOperand(val, "r");
+  auto *maskOpr = builder.newConstantOperand("0xffffffff");
+  redux(dOpr, aOpr, maskOpr);
+  return builder.launch(rewriter, loc, val.getType(), false);
+}
+
+Value matchAnySync(Location loc, ConversionPatternRewriter &rewriter,
+                   Value val) {
+  unsigned bits = val.getType().getIntOrFloatBitWidth();
+  assert((bits == 32 || bits == 64) && "match.any.sync takes b32 or b64");
+  PTXBuilder builder;
+  auto &match = builder.create("match.any.sync")->b(bits);
+  auto *dOpr = builder.newOperand("=r");
+  auto *aOpr = builder.newOperand(val, bits == 64 ? "l" : "r");
+  auto *maskOpr = builder.newConstantOperand("0xffffffff");
+  match(dOpr, aOpr, maskOpr);
+  return builder.launch(rewriter, loc, i32_ty, false);
+}
+
+Value ballotSync(Location loc, ConversionPatternRewriter &rewriter,
+                 Value pred) {
+  PTXBuilder builder;
+  auto &ballot = builder.create("vote.sync.ballot")->b(32);
+  auto *dOpr = builder.newOperand("=r");
+  auto *aOpr = builder.newOperand(pred, "b");
+  auto *maskOpr = builder.newConstantOperand("0xffffffff");
+  ballot(dOpr, aOpr, maskOpr);
+  return builder.launch(rewriter, loc, i32_ty, false);
+}
+
 Value addStringToModule(Location loc, ConversionPatternRewriter &rewriter,
                         StringRef key, StringRef content) {
   auto moduleOp = rewriter.getBlock()->getParent()->getParentOfType<ModuleOp>();
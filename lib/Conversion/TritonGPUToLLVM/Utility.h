@@ -28,6 +28,7 @@
 #define umin(...) rewriter.create<LLVM::UMinOp>(loc, __VA_ARGS__)
 #define fmin(...) rewriter.create<LLVM::MinNumOp>(loc, __VA_ARGS__)
 #define shl(...) rewriter.create<LLVM::ShlOp>(loc, __VA_ARGS__)
+#define lshr(...) rewriter.create<LLVM::LShrOp>(loc, __VA_ARGS__)
 #define and_(...) rewriter.create<LLVM::AndOp>(loc, __VA_ARGS__)
 #define xor_(...) rewriter.create<LLVM::XOrOp>(loc, __VA_ARGS__)
 #define or_(...) rewriter.create<LLVM::OrOp>(loc, __VA_ARGS__)
@@ -263,6 +264,29 @@ Value storeShared(ConversionPatternRewriter &rewriter, Location loc, Value ptr,
 Value shflSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
                int i);
 
+Value shflIdxSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                  Value lane);
+
+// Butterfly shuffle of `val` with the lane `i` away in a 64-lane AMD
+// wavefront: ds_swizzle within each half of 32 lanes, and ds_bpermute across
+// the halves for i = 32.
+Value shflSyncAMD(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                  int i);
+
+// Reduces a 32-bit integer over the warp with redux.sync (sm80+), e.g.
+// kind = "add" and type = "s32".
+Value reduxSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                StringRef kind, StringRef type);
+
+// Returns the mask of the lanes of the warp whose `val` equals this lane's,
+// with match.any.sync (sm70+).
+Value matchAnySync(Location loc, ConversionPatternRewriter &rewriter,
+                   Value val);
+
+// Returns the mask of the lanes of the warp whose `pred` is true.
+Value ballotSync(Location loc, ConversionPatternRewriter &rewriter,
+                 Value pred);
+
 Value addStringToModule(Location loc, ConversionPatternRewriter &rewriter,
                         StringRef key, StringRef content);
 
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) Triton Project Contributors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "triton/Conversion/TritonToLinalg/TritonToLinalg.h"
+
+#include "mlir/Dialect/Arith/Transforms/BufferizableOpInterfaceImpl.h"
+#include "mlir/Dialect/Bufferization/Transforms/FuncBufferizableOpInterfaceImpl.h"
+#include "mlir/Dialect/Bufferization/Transforms/Passes.h"
+#include "mlir/Dialect/Linalg/Transforms/BufferizableOpInterfaceImpl.h"
+#include "mlir/Dialect/Linalg/Transforms/Transforms.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/Transforms/BufferizableOpInterfaceImpl.h"
+#include "mlir/Dialect/Tensor/Transforms/BufferizableOpInterfaceImpl.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "mlir/Transforms/Passes.h"
+
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "triton-linalg-fuse-elementwise"
+
+using namespace mlir;
+using namespace triton;
+
+#define GEN_PASS_CLASSES
+#include "triton/Conversion/TritonToLinalg/Passes.h.inc"
+
+namespace {
+
+class TritonLinalgFuseElementwisePass
+    : public TritonLinalgFuseElementwiseBase<TritonLinalgFuseElementwisePass> {
+
+  static unsigned countGenerics(ModuleOp moduleOp) {
+    unsigned count = 0;
+    moduleOp.walk([&](linalg::GenericOp) { ++count; });
+    return count;
+  }
+
+public:
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<bufferization::BufferizationDialect, linalg::LinalgDialect,
+                    memref::MemRefDialect, tensor::TensorDialect>();
+    arith::registerBufferizableOpInterfaceExternalModels(registry);
+    bufferization::func_ext::registerBufferizableOpInterfaceExternalModels(
+        registry);
+    linalg::registerBufferizableOpInterfaceExternalModels(registry);
+    scf::registerBufferizableOpInterfaceExternalModels(registry);
+    tensor::registerBufferizableOpInterfaceExternalModels(registry);
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    auto numGenerics = countGenerics(moduleOp);
+
+    // Fuse every elementwise generic into its consumer, as long as it has no
+    // other users that would have to recompute it.
+    RewritePatternSet patterns(&getContext());
+    linalg::populateElementwiseOpFusionPatterns(
+        patterns, [](OpOperand *fusedOperand) {
+          auto producer = fusedOperand->get().getDefiningOp();
+          return producer && producer->hasOneUse();
+        });
+    if (failed(applyPatternsAndFoldGreedily(moduleOp, std::move(patterns)))) {
+      signalPassFailure();
+      return;
+    }
+
+    auto numFused = numGenerics - countGenerics(moduleOp);
+    LLVM_DEBUG(llvm::dbgs() << "fused " << numFused << " of " << numGenerics
+                            << " generics\n");
+    numFusedGenerics += numFused;
+
+    if (!bufferize)
+      return;
+
+    // Kernel arguments are already memrefs, so only the tensors inside the
+    // function bodies are bufferized.
+    PassManager pm(&getContext(), moduleOp.getOperationName());
+    pm.addPass(bufferization::createEmptyTensorToAllocTensorPass());
+    pm.addPass(bufferization::createOneShotBufferizePass());
+    pm.addPass(createCanonicalizerPass());
+    if (failed(runPipeline(pm, moduleOp)))
+      signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+triton::createTritonLinalgFuseElementwisePass() {
+  return std::make_unique<TritonLinalgFuseElementwisePass>();
+}
@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) Triton Project Contributors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "triton/Conversion/TritonToLinalg/TritonToLinalg.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "triton-linalg-grid-launcher"
+
+using namespace mlir;
+using namespace triton;
+
+#define GEN_PASS_CLASSES
+#include "triton/Conversion/TritonToLinalg/Passes.h.inc"
+
+namespace {
+
+class TritonLinalgGridLauncherPass
+    : public TritonLinalgGridLauncherBase<TritonLinalgGridLauncherPass> {
+
+  // Launchers are tagged with this attribute so that running the pass again
+  // neither treats them as kernels nor adds a second launcher to a kernel.
+  static constexpr StringLiteral launcherAttrName = "GridLauncher";
+
+  // Kernels produced by triton-to-linalg return nothing and take the program
+  // ids as their trailing LAUNCH_GRID_RANK i32 arguments.
+  static bool isKernel(func::FuncOp func) {
+    if (func.isDeclaration() || !func.isPublic() ||
+        func->hasAttr(launcherAttrName) ||
+        func.getNumResults() != 0 ||
+        func.getNumArguments() < LAUNCH_GRID_RANK)
+      return false;
+
+    auto argTypes = func.getArgumentTypes();
+    return llvm::all_of(argTypes.take_back(LAUNCH_GRID_RANK),
+                        [](Type t) { return t.isInteger(32); });
+  }
+
+  static std::string getLauncherName(func::FuncOp kernel) {
+    return (kernel.getName() + "_grid").str();
+  }
+
+  // Build `<kernel>_grid(args..., num_programs...)`, which calls kernel once
+  // for every program id in the grid from an scf.parallel.
+  static void createLauncher(func::FuncOp kernel) {
+    OpBuilder b(kernel);
+    b.setInsertionPointAfter(kernel);
+    auto loc = kernel.getLoc();
+
+    auto launcher = b.create<func::FuncOp>(
+        loc, getLauncherName(kernel), kernel.getFunctionType());
+    launcher->setAttr(launcherAttrName, b.getUnitAttr());
+    SmallVector<DictionaryAttr> argAttrs;
+    kernel.getAllArgAttrs(argAttrs);
+    launcher.setAllArgAttrs(argAttrs);
+
+    auto entry = launcher.addEntryBlock();
+    b.setInsertionPointToStart(entry);
+
+    auto args = entry->getArguments();
+    auto kernelArgs = args.drop_back(LAUNCH_GRID_RANK);
+    auto gridSizes = args.take_back(LAUNCH_GRID_RANK);
+
+    Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+    Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+    SmallVector<Value> lbs(LAUNCH_GRID_RANK, zero);
+    SmallVector<Value> steps(LAUNCH_GRID_RANK, one);
+    SmallVector<Value> ubs;
+    for (auto size : gridSizes)
+      ubs.push_back(
+          b.create<arith::IndexCastOp>(loc, b.getIndexType(), size));
+
+    b.create<scf::ParallelOp>(
+        loc, lbs, ubs, steps,
+        [&](OpBuilder &nested, Location loc, ValueRange ivs) {
+          SmallVector<Value> callArgs(kernelArgs);
+          for (auto iv : ivs)
+            callArgs.push_back(
+                nested.create<arith::IndexCastOp>(loc, nested.getI32Type(), iv));
+          nested.create<func::CallOp>(loc, kernel, callArgs);
+        });
+
+    b.create<func::ReturnOp>(loc);
+  }
+
+public:
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+
+    SymbolTable symbolTable(moduleOp);
+    SmallVector<func::FuncOp> kernels;
+    for (auto func : moduleOp.getOps<func::FuncOp>()) {
+      if (!isKernel(func))
+        continue;
+      auto existing = symbolTable.lookup<func::FuncOp>(getLauncherName(func));
+      if (existing && existing->hasAttr(launcherAttrName))
+        continue;
+      kernels.push_back(func);
+    }
+
+    for (auto kernel : kernels) {
+      LLVM_DEBUG(llvm::dbgs() << "creating grid launcher for "
+                              << kernel.getName() << "\n");
+      createLauncher(kernel);
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+triton::createTritonLinalgGridLauncherPass() {
+  return std::make_unique<TritonLinalgGridLauncherPass>();
+}
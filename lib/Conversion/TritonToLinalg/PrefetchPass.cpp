@@ -0,0 +1,340 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) Triton Project Contributors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "triton/Conversion/TritonToLinalg/TritonToLinalg.h"
+
+#include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "triton-linalg-prefetch"
+
+using namespace mlir;
+using namespace triton;
+
+#define GEN_PASS_CLASSES
+#include "triton/Conversion/TritonToLinalg/Passes.h.inc"
+
+namespace {
+
+// A load inside a loop body as lowered by triton-to-linalg:
+//   %buf = memref.alloc() : memref<...>
+//   memref.copy %src, %buf
+//   %tensor = bufferization.to_tensor %buf
+struct LoopLoad {
+  memref::AllocOp alloc;
+  memref::CopyOp copy;
+  bufferization::ToTensorOp toTensor;
+};
+
+class TritonLinalgPrefetchPass
+    : public TritonLinalgPrefetchBase<TritonLinalgPrefetchPass> {
+
+  // Ops of the loop body that v is computed from.
+  static SetVector<Operation *> getBodySlice(Value v, scf::ForOp forOp) {
+    SetVector<Operation *> slice;
+    auto defOp = v.getDefiningOp();
+    if (!defOp || defOp->getBlock() != forOp.getBody())
+      return slice;
+
+    getBackwardSlice(defOp, &slice, [&](Operation *op) {
+      return op->getBlock() == forOp.getBody();
+    });
+    slice.insert(defOp);
+    return slice;
+  }
+
+  // The slice can be re-evaluated for another iteration anywhere in the body.
+  static bool isClonable(const SetVector<Operation *> &slice) {
+    return llvm::all_of(slice, [](Operation *op) {
+      return op->getNumRegions() == 0 && isMemoryEffectFree(op);
+    });
+  }
+
+  // Iter args of forOp that the ops in slice read.
+  static SetVector<unsigned> getUsedIterArgs(const SetVector<Operation *> &slice,
+                                             Value root, scf::ForOp forOp) {
+    SetVector<unsigned> iterArgs;
+    auto visit = [&](Value v) {
+      auto arg = v.dyn_cast<BlockArgument>();
+      if (arg && arg.getOwner() == forOp.getBody() && arg.getArgNumber() > 0)
+        iterArgs.insert(arg.getArgNumber() - 1);
+    };
+    visit(root);
+    for (auto op : slice)
+      for (auto operand : op->getOperands())
+        visit(operand);
+    return iterArgs;
+  }
+
+  // Nothing in the loop other than the load copies writes to memory, so
+  // issuing a copy some iterations early reads the same data.
+  static bool hasOtherWrites(scf::ForOp forOp,
+                             const SmallVector<LoopLoad> &loads) {
+    DenseSet<Operation *> copies;
+    for (auto &load : loads)
+      copies.insert(load.copy);
+
+    auto result = forOp.getBody()->walk([&](Operation *op) {
+      if (copies.contains(op) || isa<memref::AllocOp>(op) ||
+          op->hasTrait<OpTrait::HasRecursiveMemoryEffects>())
+        return WalkResult::advance();
+
+      auto iface = dyn_cast<MemoryEffectOpInterface>(op);
+      if (!iface || iface.hasEffect<MemoryEffects::Write>())
+        return WalkResult::interrupt();
+      return WalkResult::advance();
+    });
+    return result.wasInterrupted();
+  }
+
+  static std::optional<LoopLoad> matchLoad(memref::AllocOp alloc,
+                                           scf::ForOp forOp) {
+    auto type = alloc.getType();
+    if (!type.hasStaticShape() || !type.getLayout().isIdentity() ||
+        !alloc->hasNUses(2))
+      return std::nullopt;
+
+    LoopLoad load{alloc, nullptr, nullptr};
+    for (auto user : alloc->getUsers()) {
+      if (auto copy = dyn_cast<memref::CopyOp>(user)) {
+        if (copy.getTarget() == alloc.getResult())
+          load.copy = copy;
+      } else if (auto toTensor = dyn_cast<bufferization::ToTensorOp>(user)) {
+        load.toTensor = toTensor;
+      }
+    }
+    if (!load.copy || !load.toTensor ||
+        load.copy->getBlock() != forOp.getBody() ||
+        load.toTensor->getBlock() != forOp.getBody() ||
+        !load.copy->isBeforeInBlock(load.toTensor))
+      return std::nullopt;
+
+    // The buffer is reused N iterations later, so the loaded tensor must not
+    // be carried to the next iteration.
+    SetVector<Operation *> uses;
+    getForwardSlice(load.toTensor.getResult(), &uses);
+    if (llvm::any_of(uses, [&](Operation *op) {
+          return op == forOp.getBody()->getTerminator();
+        }))
+      return std::nullopt;
+
+    // Compute the source of the next iteration's copy from the current
+    // iteration's iter args and the yielded values.
+    auto src = load.copy.getSource();
+    auto srcSlice = getBodySlice(src, forOp);
+    if (!isClonable(srcSlice))
+      return std::nullopt;
+
+    auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+    for (auto i : getSourceIterArgs(src, forOp)) {
+      if (!isClonable(getBodySlice(yieldOp.getOperand(i), forOp)))
+        return std::nullopt;
+    }
+
+    return load;
+  }
+
+  // Iter args that src is computed from, directly or through the values
+  // yielded for them, i.e. those needed to compute src some iterations ahead.
+  static SetVector<unsigned> getSourceIterArgs(Value src, scf::ForOp forOp) {
+    auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+    auto iterArgs = getUsedIterArgs(getBodySlice(src, forOp), src, forOp);
+    for (unsigned i = 0; i < iterArgs.size(); i++) {
+      Value yielded = yieldOp.getOperand(iterArgs[i]);
+      for (auto j :
+           getUsedIterArgs(getBodySlice(yielded, forOp), yielded, forOp))
+        iterArgs.insert(j);
+    }
+    return iterArgs;
+  }
+
+  // Maps the body of forOp to the iteration with induction variable iv in
+  // which iterArgs have the values in args.
+  static IRMapping getIterationMapping(scf::ForOp forOp, Value iv,
+                                       ArrayRef<unsigned> iterArgs,
+                                       ArrayRef<Value> args) {
+    IRMapping mapping;
+    mapping.map(forOp.getInductionVar(), iv);
+    for (auto [i, arg] : llvm::zip(iterArgs, args))
+      mapping.map(forOp.getRegionIterArgs()[i], arg);
+    return mapping;
+  }
+
+  // Values of iterArgs in the iteration after the one with induction variable
+  // iv, in which they have the values in args.
+  static SmallVector<Value> advance(OpBuilder &b, scf::ForOp forOp, Value iv,
+                                    ArrayRef<unsigned> iterArgs,
+                                    ArrayRef<Value> args) {
+    auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+    auto mapping = getIterationMapping(forOp, iv, iterArgs, args);
+    SmallVector<Value> next;
+    for (auto i : iterArgs)
+      next.push_back(cloneSlice(b, yieldOp.getOperand(i), forOp, mapping));
+    return next;
+  }
+
+  // Index into the ring of the buffer used by the iteration with induction
+  // variable iv: ((iv - lb) / step) mod numBuffers.
+  static Value getSlot(OpBuilder &b, Location loc, scf::ForOp forOp, Value iv,
+                       unsigned numBuffers) {
+    Value iteration = b.create<arith::DivSIOp>(
+        loc, b.create<arith::SubIOp>(loc, iv, forOp.getLowerBound()),
+        forOp.getStep());
+    Value n = b.create<arith::ConstantIndexOp>(loc, numBuffers);
+    return b.create<arith::RemSIOp>(loc, iteration, n);
+  }
+
+  // Rank-reduced view of buffer slot of the ring.
+  static Value getSlotView(OpBuilder &b, Location loc, Value ring,
+                           OpFoldResult slot) {
+    auto ringType = ring.getType().cast<MemRefType>();
+    auto rank = ringType.getRank();
+
+    SmallVector<OpFoldResult> offsets(rank, b.getIndexAttr(0));
+    offsets[0] = slot;
+    SmallVector<OpFoldResult> sizes{b.getIndexAttr(1)};
+    for (auto dim : ringType.getShape().drop_front())
+      sizes.push_back(b.getIndexAttr(dim));
+    SmallVector<OpFoldResult> strides(rank, b.getIndexAttr(1));
+
+    auto viewType = memref::SubViewOp::inferRankReducedResultType(
+                        ringType.getShape().drop_front(), ringType, offsets,
+                        sizes, strides)
+                        .cast<MemRefType>();
+    return b.create<memref::SubViewOp>(loc, viewType, ring, offsets, sizes,
+                                       strides);
+  }
+
+  static Value cloneSlice(OpBuilder &b, Value v, scf::ForOp forOp,
+                          IRMapping &mapping) {
+    for (auto op : getBodySlice(v, forOp)) {
+      if (!mapping.contains(op->getResult(0)))
+        b.clone(*op, mapping);
+    }
+    return mapping.lookupOrDefault(v);
+  }
+
+  static void prefetchLoad(LoopLoad &load, scf::ForOp forOp,
+                           unsigned numBuffers) {
+    auto loc = load.alloc.getLoc();
+    auto type = load.alloc.getType();
+    auto src = load.copy.getSource();
+
+    // The ring, with one buffer per stage, lives across iterations.
+    OpBuilder b(forOp);
+    SmallVector<int64_t> ringShape{numBuffers};
+    ringShape.append(type.getShape().begin(), type.getShape().end());
+    auto ring = b.create<memref::AllocOp>(
+        loc, MemRefType::get(ringShape, type.getElementType(), AffineMap(),
+                             type.getMemorySpace()));
+
+    // The copy for iteration i is issued by iteration i - distance, into the
+    // buffer read by iteration i - numBuffers, which has completed.
+    unsigned distance = numBuffers - 1;
+    Value step = forOp.getStep();
+    auto iterArgs = getSourceIterArgs(src, forOp).takeVector();
+
+    // Prologue: the copies of the first distance iterations into buffers
+    // 0 .. distance - 1.
+    Value iv = forOp.getLowerBound();
+    SmallVector<Value> args;
+    for (auto i : iterArgs)
+      args.push_back(forOp.getIterOperands()[i]);
+    for (unsigned k = 0; k < distance; k++) {
+      if (k > 0) {
+        args = advance(b, forOp, iv, iterArgs, args);
+        iv = b.create<arith::AddIOp>(loc, iv, step);
+      }
+      Value hasIteration = b.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::slt, iv, forOp.getUpperBound());
+      b.create<scf::IfOp>(
+          loc, hasIteration, [&](OpBuilder &nested, Location loc) {
+            auto mapping = getIterationMapping(forOp, iv, iterArgs, args);
+            Value firstSrc = cloneSlice(nested, src, forOp, mapping);
+            auto view = getSlotView(nested, loc, ring, nested.getIndexAttr(k));
+            nested.create<memref::CopyOp>(loc, firstSrc, view);
+            nested.create<scf::YieldOp>(loc);
+          });
+    }
+
+    // At the top of the body, start the copy distance iterations ahead before
+    // this iteration computes.
+    b.setInsertionPointToStart(forOp.getBody());
+    Value distanceCst = b.create<arith::ConstantIndexOp>(loc, distance);
+    Value aheadIv = b.create<arith::AddIOp>(
+        loc, forOp.getInductionVar(),
+        b.create<arith::MulIOp>(loc, step, distanceCst));
+    Value hasAhead = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt,
+                                             aheadIv, forOp.getUpperBound());
+    b.create<scf::IfOp>(loc, hasAhead, [&](OpBuilder &nested, Location loc) {
+      // Values yielded by this iteration are the next one's iter args, and
+      // so on up to the iteration distance ahead.
+      Value cur = forOp.getInductionVar();
+      SmallVector<Value> aheadArgs;
+      for (auto i : iterArgs)
+        aheadArgs.push_back(forOp.getRegionIterArgs()[i]);
+      for (unsigned k = 0; k < distance; k++) {
+        if (k > 0)
+          cur = nested.create<arith::AddIOp>(loc, cur, step);
+        aheadArgs = advance(nested, forOp, cur, iterArgs, aheadArgs);
+      }
+
+      auto mapping = getIterationMapping(forOp, aheadIv, iterArgs, aheadArgs);
+      Value aheadSrc = cloneSlice(nested, src, forOp, mapping);
+      Value slot = getSlot(nested, loc, forOp, aheadIv, numBuffers);
+      nested.create<memref::CopyOp>(loc, aheadSrc,
+                                    getSlotView(nested, loc, ring, slot));
+      nested.create<scf::YieldOp>(loc);
+    });
+
+    // This iteration reads the buffer filled distance iterations earlier.
+    b.setInsertionPoint(load.toTensor);
+    Value slot = getSlot(b, loc, forOp, forOp.getInductionVar(), numBuffers);
+    load.toTensor->setOperand(0, getSlotView(b, loc, ring, slot));
+
+    load.copy.erase();
+    load.alloc.erase();
+  }
+
+public:
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    if (numBuffers < 2)
+      return;
+
+    SmallVector<scf::ForOp> forOps;
+    moduleOp.walk([&](scf::ForOp forOp) { forOps.push_back(forOp); });
+
+    for (auto forOp : forOps) {
+      SmallVector<LoopLoad> loads;
+      for (auto alloc : forOp.getBody()->getOps<memref::AllocOp>()) {
+        if (auto load = matchLoad(alloc, forOp))
+          loads.push_back(*load);
+      }
+      if (loads.empty() || hasOtherWrites(forOp, loads))
+        continue;
+
+      LLVM_DEBUG(llvm::dbgs() << "prefetching " << loads.size()
+                              << " loads in " << forOp << "\n");
+      for (auto &load : loads)
+        prefetchLoad(load, forOp, numBuffers);
+      numPrefetchedLoads += loads.size();
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+triton::createTritonLinalgPrefetchPass() {
+  return std::make_unique<TritonLinalgPrefetchPass>();
+}
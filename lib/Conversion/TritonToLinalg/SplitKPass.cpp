@@ -0,0 +1,287 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) Triton Project Contributors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "triton/Conversion/TritonToLinalg/TritonToLinalg.h"
+
+#include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "triton-linalg-split-k"
+
+using namespace mlir;
+using namespace triton;
+
+#define GEN_PASS_CLASSES
+#include "triton/Conversion/TritonToLinalg/Passes.h.inc"
+
+namespace {
+
+// A K loop of a converted matmul kernel: the loop accumulates the matmul
+// yielded as its result accIdx into the zero filled init of that result.
+// compute holds the ops of the body that only the accumulator depends on, in
+// order, which are skipped by the iterations outside the chunk of a program.
+struct SplitKLoop {
+  scf::ForOp loop;
+  unsigned accIdx;
+  linalg::FillOp init;
+  SmallVector<Operation *> compute;
+};
+
+// Whether the memory op writes to, if any, is a buffer allocated in loop,
+// e.g. the copy of a load.
+static bool writesOnlyLocalBuffers(Operation *op, scf::ForOp loop) {
+  if (isMemoryEffectFree(op))
+    return true;
+  auto effectOp = dyn_cast<MemoryEffectOpInterface>(op);
+  if (!effectOp)
+    return false;
+  SmallVector<MemoryEffects::EffectInstance> effects;
+  effectOp.getEffects(effects);
+  return llvm::all_of(effects, [&](MemoryEffects::EffectInstance &effect) {
+    if (!isa<MemoryEffects::Write>(effect.getEffect()))
+      return true;
+    auto alloc = effect.getValue()
+                     ? effect.getValue().getDefiningOp<memref::AllocOp>()
+                     : nullptr;
+    return alloc && loop->isProperAncestor(alloc);
+  });
+}
+
+static bool isZeroFill(linalg::FillOp fill) {
+  Value value = fill.getInputs()[0];
+  return matchPattern(value, m_AnyZeroFloat()) ||
+         matchPattern(value, m_Zero());
+}
+
+static std::optional<SplitKLoop> getSplitKLoop(scf::ForOp loop) {
+  Block *body = loop.getBody();
+  auto yield = cast<scf::YieldOp>(body->getTerminator());
+
+  // Each program starts from its own zero accumulator, so that the sum of
+  // the partial ones counts the init once
+  std::optional<unsigned> accIdx;
+  for (auto [idx, iterArg] : llvm::enumerate(loop.getRegionIterArgs())) {
+    auto matmul = yield.getOperand(idx).getDefiningOp<linalg::MatmulOp>();
+    auto init = loop.getInitArgs()[idx].getDefiningOp<linalg::FillOp>();
+    if (matmul && matmul->getBlock() == body && init && isZeroFill(init) &&
+        iterArg.hasOneUse() &&
+        matmul.getDpsInitOperand(0)->get() == iterArg) {
+      accIdx = idx;
+      break;
+    }
+  }
+  if (!accIdx)
+    return std::nullopt;
+
+  // The other values carried by the loop are computed by every program up to
+  // the end of its chunk, and their final values are no longer those of the
+  // whole loop
+  SetVector<Operation *> carried;
+  for (auto [idx, operand] : llvm::enumerate(yield.getOperands())) {
+    if (idx == *accIdx)
+      continue;
+    if (!loop.getResult(idx).use_empty())
+      return std::nullopt;
+    Operation *def = operand.getDefiningOp();
+    if (!def || def->getBlock() != body)
+      continue;
+    getBackwardSlice(def, &carried,
+                     [&](Operation *op) { return op->getBlock() == body; });
+    carried.insert(def);
+  }
+  if (!llvm::all_of(carried, isMemoryEffectFree))
+    return std::nullopt;
+
+  SplitKLoop splitKLoop;
+  splitKLoop.loop = loop;
+  splitKLoop.accIdx = *accIdx;
+  splitKLoop.init = loop.getInitArgs()[*accIdx].getDefiningOp<linalg::FillOp>();
+  for (Operation &op : body->without_terminator())
+    if (!carried.contains(&op))
+      splitKLoop.compute.push_back(&op);
+  Operation *matmul = yield.getOperand(*accIdx).getDefiningOp();
+  if (!llvm::is_contained(splitKLoop.compute, matmul))
+    return std::nullopt;
+
+  // Nothing but the accumulator may depend on the skipped ops, which may
+  // only write to their own buffers
+  DenseSet<Operation *> computeSet(splitKLoop.compute.begin(),
+                                   splitKLoop.compute.end());
+  for (Operation *op : splitKLoop.compute) {
+    if (!writesOnlyLocalBuffers(op, loop))
+      return std::nullopt;
+    for (OpOperand &use : op->getUses()) {
+      Operation *user = body->findAncestorOpInBlock(*use.getOwner());
+      if (user == yield && use.getOperandNumber() == *accIdx)
+        continue;
+      if (!user || !computeSet.contains(user))
+        return std::nullopt;
+    }
+  }
+  return splitKLoop;
+}
+
+class TritonLinalgSplitKPass
+    : public TritonLinalgSplitKBase<TritonLinalgSplitKPass> {
+
+  // Run loop across splitK programs of an scf.parallel, each over a chunk of
+  // ceil(trips / splitK) consecutive iterations, and sum their accumulators.
+  void splitLoop(const SplitKLoop &splitKLoop) {
+    scf::ForOp loop = splitKLoop.loop;
+    auto loc = loop.getLoc();
+    Value acc = loop.getResult(splitKLoop.accIdx);
+    auto accType = acc.getType().cast<RankedTensorType>();
+    Type elemType = accType.getElementType();
+    Type ivType = loop.getInductionVar().getType();
+
+    OpBuilder b(loop);
+    SmallVector<int64_t> workspaceShape{splitK};
+    llvm::append_range(workspaceShape, accType.getShape());
+    auto workspaceType = MemRefType::get(workspaceShape, elemType);
+    Value workspace = b.create<memref::AllocOp>(loc, workspaceType);
+
+    Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+    Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+    Value numSplits = b.create<arith::ConstantIndexOp>(loc, splitK);
+    Value start;
+    Value accInit;
+    Value split;
+    auto parallel = b.create<scf::ParallelOp>(
+        loc, ValueRange{zero}, ValueRange{numSplits}, ValueRange{one},
+        [&](OpBuilder &nested, Location loc, ValueRange ivs) {
+          split = ivs[0];
+          Value splitId = split;
+          if (!ivType.isIndex())
+            splitId = nested.create<arith::IndexCastOp>(loc, ivType, split);
+          Value splits = nested.create<arith::ConstantOp>(
+              loc, nested.getIntegerAttr(ivType, splitK));
+          Value lb = loop.getLowerBound();
+          Value ub = loop.getUpperBound();
+          Value step = loop.getStep();
+          Value span = nested.create<arith::SubIOp>(loc, ub, lb);
+          Value trips = nested.create<arith::CeilDivSIOp>(loc, span, step);
+          Value chunk = nested.create<arith::CeilDivSIOp>(loc, trips, splits);
+          Value chunkSpan = nested.create<arith::MulIOp>(loc, chunk, step);
+          start = nested.create<arith::AddIOp>(
+              loc, lb, nested.create<arith::MulIOp>(loc, splitId, chunkSpan));
+          Value end = nested.create<arith::MinSIOp>(
+              loc, ub, nested.create<arith::AddIOp>(loc, start, chunkSpan));
+          loop.setUpperBound(end);
+
+          auto init = splitKLoop.init;
+          Value empty = nested.create<tensor::EmptyOp>(
+              loc, accType.getShape(), elemType);
+          accInit = nested
+                        .create<linalg::FillOp>(loc, init.getInputs()[0],
+                                                empty)
+                        .getResult(0);
+        });
+
+    // The partial accumulators reduced into the result of the loop, from the
+    // zero filled init of the original loop
+    b.setInsertionPointAfter(parallel);
+    Value partials = b.create<bufferization::ToTensorOp>(
+        loc, RankedTensorType::get(workspaceShape, elemType), workspace,
+        true /* restrict */, true /* writable */);
+    auto reduce = b.create<linalg::ReduceOp>(
+        loc, ValueRange{partials}, ValueRange{splitKLoop.init.getResult(0)},
+        SmallVector<int64_t>{0},
+        [&](OpBuilder &nested, Location loc, ValueRange args) {
+          Value sum =
+              elemType.isa<FloatType>()
+                  ? nested.create<arith::AddFOp>(loc, args[0], args[1])
+                        .getResult()
+                  : nested.create<arith::AddIOp>(loc, args[0], args[1])
+                        .getResult();
+          nested.create<linalg::YieldOp>(loc, sum);
+        });
+    b.create<memref::DeallocOp>(loc, workspace);
+    acc.replaceAllUsesWith(reduce.getResult(0));
+
+    // The loop of each program, skipping the accumulation outside its chunk
+    Block *parallelBody = parallel.getBody();
+    loop->moveBefore(parallelBody->getTerminator());
+    loop->setOperand(loop.getNumControlOperands() + splitKLoop.accIdx,
+                     accInit);
+
+    auto yield = cast<scf::YieldOp>(loop.getBody()->getTerminator());
+    b.setInsertionPoint(yield);
+    Value inChunk = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sge,
+                                            loop.getInductionVar(), start);
+    auto ifOp = b.create<scf::IfOp>(loc, TypeRange{accType}, inChunk,
+                                    /*withElseRegion=*/true);
+    Block *thenBlock = ifOp.thenBlock();
+    for (Operation *op : splitKLoop.compute)
+      op->moveBefore(thenBlock, thenBlock->end());
+    b.setInsertionPointToEnd(thenBlock);
+    b.create<scf::YieldOp>(loc, yield.getOperand(splitKLoop.accIdx));
+    b.setInsertionPointToEnd(ifOp.elseBlock());
+    b.create<scf::YieldOp>(
+        loc, loop.getRegionIterArgs()[splitKLoop.accIdx]);
+    yield.setOperand(splitKLoop.accIdx, ifOp.getResult(0));
+
+    // Each program writes its partial accumulator into its slice of the
+    // workspace
+    b.setInsertionPoint(parallelBody->getTerminator());
+    int64_t rank = accType.getRank();
+    SmallVector<OpFoldResult> offsets{split};
+    offsets.append(rank, b.getIndexAttr(0));
+    SmallVector<OpFoldResult> sizes{b.getIndexAttr(1)};
+    for (int64_t size : accType.getShape())
+      sizes.push_back(b.getIndexAttr(size));
+    SmallVector<OpFoldResult> strides(rank + 1, b.getIndexAttr(1));
+    auto sliceType = memref::SubViewOp::inferRankReducedResultType(
+                         accType.getShape(), workspaceType, offsets, sizes,
+                         strides)
+                         .cast<MemRefType>();
+    Value slice = b.create<memref::SubViewOp>(loc, sliceType, workspace,
+                                              offsets, sizes, strides);
+    b.create<memref::TensorStoreOp>(loc, loop.getResult(splitKLoop.accIdx),
+                                    slice);
+  }
+
+public:
+  TritonLinalgSplitKPass() = default;
+  TritonLinalgSplitKPass(unsigned splitK) { this->splitK = splitK; }
+
+  void runOnOperation() override {
+    if (splitK <= 1)
+      return;
+
+    // Only the K loops of the kernels themselves, as the programs of a
+    // split loop run in parallel with nothing else of the kernel
+    SmallVector<SplitKLoop> loops;
+    getOperation().walk([&](func::FuncOp func) {
+      if (func.isDeclaration())
+        return;
+      for (auto loop : func.getBody().front().getOps<scf::ForOp>())
+        if (auto splitKLoop = getSplitKLoop(loop))
+          loops.push_back(std::move(*splitKLoop));
+    });
+
+    for (auto &splitKLoop : loops) {
+      LLVM_DEBUG(llvm::dbgs() << "splitting K loop across " << splitK
+                              << " programs: " << splitKLoop.loop << "\n");
+      splitLoop(splitKLoop);
+      ++numSplitKLoops;
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+triton::createTritonLinalgSplitKPass(unsigned splitK) {
+  return std::make_unique<TritonLinalgSplitKPass>(splitK);
+}
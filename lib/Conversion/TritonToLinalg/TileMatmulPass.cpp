@@ -0,0 +1,289 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) Triton Project Contributors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "triton/Conversion/TritonToLinalg/TritonToLinalg.h"
+
+#include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/Transforms/Transforms.h"
+#include "mlir/Dialect/Linalg/Utils/Utils.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
+#include "mlir/Dialect/Vector/Transforms/LoweringPatterns.h"
+#include "mlir/Dialect/Vector/Transforms/VectorTransforms.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/TargetParser/Host.h"
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#define DEBUG_TYPE "triton-linalg-tile-matmul"
+
+using namespace mlir;
+using namespace triton;
+
+#define GEN_PASS_CLASSES
+#include "triton/Conversion/TritonToLinalg/Passes.h.inc"
+
+CPUTargetDescription CPUTargetDescription::getHost() {
+  CPUTargetDescription target;
+  llvm::StringMap<bool> features;
+  if (llvm::sys::getHostCPUFeatures(features)) {
+    if (features.lookup("avx512f")) {
+      target.vectorBits = 512;
+      target.numVectorRegisters = 32;
+    } else if (features.lookup("avx")) {
+      target.vectorBits = 256;
+      target.numVectorRegisters = 16;
+    } else if (features.lookup("neon")) {
+      target.vectorBits = 128;
+      target.numVectorRegisters = 32;
+    }
+  }
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+  if (long size = sysconf(_SC_LEVEL1_DCACHE_SIZE); size > 0)
+    target.l1CacheBytes = size;
+#endif
+#ifdef _SC_LEVEL2_CACHE_SIZE
+  if (long size = sysconf(_SC_LEVEL2_CACHE_SIZE); size > 0)
+    target.l2CacheBytes = size;
+#endif
+  return target;
+}
+
+namespace {
+
+// Register tiles are unrolled over their whole block of kc rows of B, which
+// bounds kc.
+static constexpr int64_t maxUnrolledReduction = 64;
+
+// Largest power of two that is at most target and divides size, at least 1.
+static int64_t getDividingTileSize(int64_t size, int64_t target) {
+  int64_t tileSize = 1;
+  while (tileSize * 2 <= target && size % (tileSize * 2) == 0)
+    tileSize *= 2;
+  return tileSize;
+}
+
+// Tile sizes of a matmul: the blocks of mc x kc of A and kc x nc of B kept in
+// the caches, and the register tiles of mr x nr of C.
+struct MatmulBlocking {
+  int64_t mc, nc, kc;
+  int64_t mr, nr;
+};
+
+static MatmulBlocking getBlocking(int64_t m, int64_t n, int64_t k,
+                                  int64_t elemBytes, int64_t accBits,
+                                  const CPUTargetDescription &target) {
+  MatmulBlocking blocking;
+  // A row of a register tile is a vector of C, and the accumulators take
+  // half of the registers, the others holding A and B
+  blocking.nr = getDividingTileSize(
+      n, std::max<int64_t>(1, target.vectorBits / accBits));
+  blocking.mr = getDividingTileSize(
+      m, std::max<int64_t>(1, target.numVectorRegisters / 2));
+  // The kc x nr panel of B that a register tile reads fills half of L1
+  int64_t kc = target.l1CacheBytes / 2 / (blocking.nr * elemBytes);
+  blocking.kc = getDividingTileSize(
+      k, std::clamp<int64_t>(kc, 1, maxUnrolledReduction));
+  // The mc x kc block of A fills half of L2
+  int64_t mc = target.l2CacheBytes / 2 / (blocking.kc * elemBytes);
+  blocking.mc = getDividingTileSize(m, std::max(blocking.mr, mc));
+  blocking.nc = n;
+  return blocking;
+}
+
+class TritonLinalgTileMatmulPass
+    : public TritonLinalgTileMatmulBase<TritonLinalgTileMatmulPass> {
+
+  CPUTargetDescription getTargetDescription() {
+    auto target = CPUTargetDescription::getHost();
+    if (l1CacheSize)
+      target.l1CacheBytes = l1CacheSize;
+    if (l2CacheSize)
+      target.l2CacheBytes = l2CacheSize;
+    if (vectorBits)
+      target.vectorBits = vectorBits;
+    if (vectorRegisters)
+      target.numVectorRegisters = vectorRegisters;
+    return target;
+  }
+
+  static bool isStaticMatmul(linalg::MatmulOp op) {
+    return op.hasBufferSemantics() &&
+           llvm::all_of(op->getOperandTypes(), [](Type type) {
+             auto memrefType = type.dyn_cast<MemRefType>();
+             return memrefType && memrefType.hasStaticShape();
+           });
+  }
+
+  // Copy the block that blockOp reads from its input idx, a subview, into a
+  // contiguous buffer, in front of the outermost of the loops around it that
+  // the block does not depend on.
+  static LogicalResult packOperand(RewriterBase &rewriter,
+                                   linalg::LinalgOp blockOp, unsigned idx,
+                                   ArrayRef<Operation *> loops) {
+    OpOperand *operand = blockOp.getDpsInputOperand(idx);
+    auto subview = operand->get().getDefiningOp<memref::SubViewOp>();
+    if (!subview || loops.empty())
+      return failure();
+
+    // The ops computing the block inside the loops
+    SetVector<Operation *> slice;
+    getBackwardSlice(subview.getOperation(), &slice, [&](Operation *op) {
+      return loops.front()->isAncestor(op);
+    });
+    slice.insert(subview);
+    if (!llvm::all_of(slice, isMemoryEffectFree))
+      return failure();
+
+    Operation *insertionPoint = blockOp;
+    for (Operation *loop : llvm::reverse(loops)) {
+      Value iv = cast<scf::ForOp>(loop).getInductionVar();
+      if (llvm::any_of(slice, [&](Operation *op) {
+            return llvm::is_contained(op->getOperands(), iv);
+          }))
+        break;
+      insertionPoint = loop;
+    }
+
+    auto loc = blockOp.getLoc();
+    rewriter.setInsertionPoint(insertionPoint);
+    Value block = subview.getResult();
+    if (insertionPoint != blockOp) {
+      IRMapping mapping;
+      for (Operation *op : slice)
+        rewriter.clone(*op, mapping);
+      block = mapping.lookup(block);
+    }
+    auto type = subview.getType();
+    auto bufferType = MemRefType::get(type.getShape(), type.getElementType());
+    Value buffer = rewriter.create<memref::AllocOp>(
+        loc, bufferType, rewriter.getI64IntegerAttr(64));
+    linalg::makeMemRefCopyOp(rewriter, loc, block, buffer);
+    rewriter.setInsertionPointAfter(insertionPoint);
+    rewriter.create<memref::DeallocOp>(loc, buffer);
+    rewriter.updateRootInPlace(blockOp, [&]() { operand->set(buffer); });
+    return success();
+  }
+
+  // Tile op by tileSizes, 0 keeping a dimension whole, and erase it.
+  static FailureOr<linalg::TiledLinalgOp>
+  tile(RewriterBase &rewriter, linalg::LinalgOp op,
+       ArrayRef<int64_t> tileSizes, ArrayRef<unsigned> interchange = {}) {
+    linalg::LinalgTilingOptions options;
+    options.setTileSizes(tileSizes)
+        .setInterchange(interchange)
+        .setLoopType(linalg::LinalgTilingLoopType::Loops);
+    rewriter.setInsertionPoint(op);
+    auto tiled = linalg::tileLinalgOp(rewriter, op, options);
+    if (succeeded(tiled))
+      rewriter.eraseOp(op);
+    return tiled;
+  }
+
+  LogicalResult tileMatmul(RewriterBase &rewriter, linalg::MatmulOp op,
+                           const CPUTargetDescription &target) {
+    auto aType = op.getDpsInputOperand(0)->get().getType().cast<MemRefType>();
+    auto bType = op.getDpsInputOperand(1)->get().getType().cast<MemRefType>();
+    auto cType = op.getDpsInitOperand(0)->get().getType().cast<MemRefType>();
+    int64_t m = cType.getDimSize(0);
+    int64_t n = cType.getDimSize(1);
+    int64_t k = aType.getDimSize(1);
+    int64_t elemBytes = std::max(aType.getElementTypeBitWidth(),
+                                 bType.getElementTypeBitWidth()) /
+                        8;
+    auto blocking = getBlocking(m, n, k, std::max<int64_t>(1, elemBytes),
+                                cType.getElementTypeBitWidth(), target);
+    LLVM_DEBUG(llvm::dbgs() << "blocking " << m << "x" << n << "x" << k
+                            << " matmul by mc=" << blocking.mc
+                            << " nc=" << blocking.nc << " kc=" << blocking.kc
+                            << " mr=" << blocking.mr << " nr=" << blocking.nr
+                            << "\n");
+
+    // Cache blocks, looping over the blocks of columns of B, then over the
+    // blocks of kc rows of B, then over the blocks of mc rows of A
+    linalg::LinalgOp blockOp = op;
+    SmallVector<int64_t> blockSizes{blocking.mc == m ? 0 : blocking.mc,
+                                    blocking.nc == n ? 0 : blocking.nc,
+                                    blocking.kc == k ? 0 : blocking.kc};
+    if (llvm::any_of(blockSizes, [](int64_t size) { return size != 0; })) {
+      auto tiled = tile(rewriter, op, blockSizes, {1, 2, 0});
+      if (failed(tiled))
+        return failure();
+      blockOp = tiled->op;
+      if (packOperands)
+        for (unsigned idx : {0, 1})
+          if (succeeded(packOperand(rewriter, blockOp, idx, tiled->loops)))
+            ++numPackedOperands;
+    }
+
+    // Register tiles of the blocks, over all of their kc rows
+    linalg::LinalgOp tileOp = blockOp;
+    SmallVector<int64_t> tileSizes{blocking.mr == blocking.mc ? 0 : blocking.mr,
+                                   blocking.nr == blocking.nc ? 0 : blocking.nr,
+                                   0};
+    if (llvm::any_of(tileSizes, [](int64_t size) { return size != 0; })) {
+      auto tiled = tile(rewriter, blockOp, tileSizes);
+      if (failed(tiled))
+        return failure();
+      tileOp = tiled->op;
+    }
+    ++numTiledMatmuls;
+
+    if (succeeded(linalg::vectorize(rewriter, tileOp)))
+      ++numVectorizedTiles;
+    return success();
+  }
+
+public:
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SmallVector<linalg::MatmulOp> matmuls;
+    moduleOp.walk([&](linalg::MatmulOp op) {
+      if (isStaticMatmul(op))
+        matmuls.push_back(op);
+    });
+    if (matmuls.empty())
+      return;
+
+    auto target = getTargetDescription();
+    IRRewriter rewriter(&getContext());
+    for (auto op : matmuls)
+      if (failed(tileMatmul(rewriter, op, target))) {
+        op.emitError("failed to tile matmul");
+        return signalPassFailure();
+      }
+
+    // Lower the contractions of the register tiles to outer products, one
+    // FMA of a broadcast element of A and a row of B per row of C, and fold
+    // the subviews of the tiles
+    RewritePatternSet patterns(&getContext());
+    vector::populateVectorContractLoweringPatterns(
+        patterns, vector::VectorTransformsOptions().setVectorTransformsOptions(
+                      vector::VectorContractLowering::OuterProduct));
+    vector::populateVectorTransferPermutationMapLoweringPatterns(patterns);
+    memref::SubViewOp::getCanonicalizationPatterns(patterns, &getContext());
+    scf::ForOp::getCanonicalizationPatterns(patterns, &getContext());
+    if (failed(applyPatternsAndFoldGreedily(moduleOp, std::move(patterns))))
+      signalPassFailure();
+  }
+};
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+triton::createTritonLinalgTileMatmulPass() {
+  return std::make_unique<TritonLinalgTileMatmulPass>();
+}
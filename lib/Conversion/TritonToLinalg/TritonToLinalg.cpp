@@ -6,15 +6,26 @@
 
 #include "triton/Conversion/TritonToLinalg/TritonToLinalg.h"
 #include "triton/Analysis/MaskAnalysis.h"
+#include "triton/Analysis/OpFoldResultUtils.h"
 #include "triton/Analysis/PtrAnalysis.h"
+#include "triton/Analysis/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 
+#include "mlir/Analysis/SliceAnalysis.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Passes.h"
-
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/Utils/ReshapeOpsUtils.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/TypeUtilities.h"
+
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/FormatVariadic.h"
 
@@ -83,6 +94,210 @@ static SmallVector<utils::IteratorType> getNParallelLoopsAttrs(unsigned n) {
   return SmallVector<utils::IteratorType>(n, utils::IteratorType::parallel);
 }
 
+// Analyze the mask of `op` with MaskState. Masks that are not a contiguous
+// window are lowered with a predicated fallback, so the reason the analysis
+// gives up on them is only reported as a remark.
+static LogicalResult parseContiguousMask(MaskState &mstate, Value mask,
+                                         Operation *op, const Location loc,
+                                         ConversionPatternRewriter &rewriter) {
+  std::string reason;
+  LogicalResult result = failure();
+  {
+    ScopedDiagnosticHandler silenceAnalysis(rewriter.getContext(),
+                                            [&](Diagnostic &diag) {
+                                              if (reason.empty())
+                                                reason = diag.str();
+                                              return success();
+                                            });
+    result = mstate.parse(mask, loc, rewriter);
+  }
+  if (failed(result))
+    emitMissedRemark(op, "triton-to-linalg",
+                     "the mask is not a contiguous window, lowering to "
+                     "predicated accesses of single elements: " +
+                         reason);
+  return result;
+}
+
+// Return a value for mask that survives the conversion. UseAnalysis tags the
+// ops computing a mask as MetaUse, and MetaOpConverter erases them because the
+// contiguous lowering only needs their MaskState. Clone them without the tag;
+// the clones are then legalized like any other data computation.
+static Value materializeMask(Value mask, ConversionPatternRewriter &rewriter) {
+  auto isMetaUse = [](Operation *op) { return op->hasAttr("MetaUse"); };
+
+  auto defOp = mask.getDefiningOp();
+  if (!defOp || !isMetaUse(defOp))
+    return rewriter.getRemappedValue(mask);
+
+  SetVector<Operation *> slice;
+  getBackwardSlice(defOp, &slice, isMetaUse);
+  slice.insert(defOp);
+
+  IRMapping mapping;
+  for (auto op : slice) {
+    auto clone = rewriter.clone(*op, mapping);
+    clone->removeAttr("MetaUse");
+  }
+  return mapping.lookup(mask);
+}
+
+// Let downstream passes emit aligned accesses through ptr if PtrAnalysis
+// tagged its reinterpret_cast with a known alignment.
+static void assumeAlignment(Value ptr, const Location loc,
+                            ConversionPatternRewriter &rewriter) {
+  auto castOp = ptr.getDefiningOp<memref::ReinterpretCastOp>();
+  if (!castOp)
+    return;
+  if (auto alignment = castOp->getAttrOfType<IntegerAttr>("Alignment"))
+    rewriter.create<memref::AssumeAlignmentOp>(loc, ptr, alignment.getInt());
+}
+
+// Build the MaskState of the elements of the block addressed by the block
+// pointer ptr that lie inside its parent tensor along the dimensions in
+// boundaryCheck. Element j of dimension i is at index
+// offsets[i] / strides[i] + j of the parent tensor, so the valid elements are
+// the window [-index, shape[i] - index) clamped to the block.
+static LogicalResult getBoundaryMask(MaskState &mstate, Value ptr,
+                                     ArrayRef<int32_t> boundaryCheck,
+                                     ArrayRef<int64_t> blockShape,
+                                     PtrStateCache *cache, const Location loc,
+                                     ConversionPatternRewriter &rewriter) {
+  // Pointers carried through loops are only known through the states
+  // recorded when the loop was rewritten.
+  std::optional<PtrState> state;
+  if (cache)
+    state = cache->lookupBlockPtr(ptr, rewriter);
+  if (!state && isa_and_nonnull<triton::MakeTensorPtrOp, triton::AdvanceOp>(
+                    ptr.getDefiningOp())) {
+    state.emplace();
+    PtrAnalysis::visitOperand(ptr, *state, loc, rewriter,
+                              llvm::SmallDenseMap<Value, PtrState>(0));
+  }
+  if (!state || !state->isBlockPtr())
+    return failure();
+
+  auto zero = rewriter.getIndexAttr(0);
+  for (auto size : blockShape) {
+    mstate.offsets.push_back(zero);
+    mstate.dims.push_back(rewriter.getIndexAttr(size));
+  }
+
+  for (auto dim : boundaryCheck) {
+    auto size = mstate.dims[dim];
+    // A broadcast dimension has a zero stride, so its offset is 0 whatever the
+    // index of the block; it is checked at index 0 rather than divided by 0.
+    OpFoldResult stride = state->strides[dim];
+    auto staticStride = getIntAttr(stride);
+    OpFoldResult index = zero;
+    if (!staticStride) {
+      Value strideValue = ofrToIndexValue(stride, loc, rewriter);
+      Value zeroValue = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+      Value oneValue = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+      Value isBroadcast = rewriter.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::eq, strideValue, zeroValue);
+      stride = rewriter
+                   .create<arith::SelectOp>(loc, isBroadcast, oneValue,
+                                            strideValue)
+                   .getResult();
+    }
+    if (!staticStride || *staticStride != 0)
+      index = ceilDivOFRs(state->offsets[dim], stride, loc, rewriter);
+    auto lower = minOFRs(
+        maxOFRs(subOFRs(zero, index, loc, rewriter), zero, loc, rewriter),
+        size, loc, rewriter);
+    auto upper = minOFRs(
+        maxOFRs(subOFRs(state->shape[dim], index, loc, rewriter), lower, loc,
+                rewriter),
+        size, loc, rewriter);
+    mstate.offsets[dim] = lower;
+    mstate.dims[dim] = subOFRs(upper, lower, loc, rewriter);
+  }
+  return success();
+}
+
+// Value of the elements that a load through a block pointer reads outside of
+// the parent tensor, or std::nullopt if they are left undefined.
+static std::optional<Value> getPaddingValue(triton::LoadOp op,
+                                            const Location loc,
+                                            ConversionPatternRewriter &rewriter) {
+  auto padding = op.getPadding();
+  if (!padding)
+    return std::nullopt;
+
+  auto elementType =
+      op.getResult().getType().cast<ShapedType>().getElementType();
+  TypedAttr paddingAttr = rewriter.getZeroAttr(elementType);
+  if (*padding == triton::PaddingOption::PAD_NAN) {
+    auto floatType = elementType.cast<FloatType>();
+    paddingAttr = rewriter.getFloatAttr(
+        floatType, APFloat::getNaN(floatType.getFloatSemantics()));
+  }
+  return rewriter.create<arith::ConstantOp>(loc, paddingAttr).getResult();
+}
+
+// Return true if v is a splat of the constant 0, either as tt.splat of a
+// scalar constant or as a dense splat constant. Both float and integer zeros
+// are recognized.
+static bool isZeroSplat(Value v) {
+  if (auto splatOp = v.getDefiningOp<triton::SplatOp>())
+    v = splatOp.getSrc();
+  return matchPattern(v, m_AnyZeroFloat()) || matchPattern(v, m_Zero());
+}
+
+using MathOpBuilder = Value (*)(OpBuilder &, Location, ValueRange);
+
+template <typename OpTy>
+static Value buildMathOp(OpBuilder &b, Location loc, ValueRange args) {
+  return b.create<OpTy>(loc, args).getResult();
+}
+
+// Math dialect op computing the libdevice or libm function symbol on floats,
+// together with its number of arguments. Both the double and the float
+// variants of a function are recognized, e.g. __nv_exp, __nv_expf, exp and
+// expf. Returns std::nullopt for unknown symbols.
+static std::optional<std::pair<MathOpBuilder, unsigned>>
+lookupMathOp(StringRef symbol) {
+  symbol.consume_front("__nv_");
+
+  auto lookup = [](StringRef name) {
+    return llvm::StringSwitch<std::pair<MathOpBuilder, unsigned>>(name)
+        .Case("fabs", {buildMathOp<math::AbsFOp>, 1})
+        .Case("atan", {buildMathOp<math::AtanOp>, 1})
+        .Case("atan2", {buildMathOp<math::Atan2Op>, 2})
+        .Case("cbrt", {buildMathOp<math::CbrtOp>, 1})
+        .Case("ceil", {buildMathOp<math::CeilOp>, 1})
+        .Case("copysign", {buildMathOp<math::CopySignOp>, 2})
+        .Case("cos", {buildMathOp<math::CosOp>, 1})
+        .Case("erf", {buildMathOp<math::ErfOp>, 1})
+        .Case("exp", {buildMathOp<math::ExpOp>, 1})
+        .Case("exp2", {buildMathOp<math::Exp2Op>, 1})
+        .Case("expm1", {buildMathOp<math::ExpM1Op>, 1})
+        .Case("floor", {buildMathOp<math::FloorOp>, 1})
+        .Case("fma", {buildMathOp<math::FmaOp>, 3})
+        .Case("log", {buildMathOp<math::LogOp>, 1})
+        .Case("log10", {buildMathOp<math::Log10Op>, 1})
+        .Case("log1p", {buildMathOp<math::Log1pOp>, 1})
+        .Case("log2", {buildMathOp<math::Log2Op>, 1})
+        .Case("pow", {buildMathOp<math::PowFOp>, 2})
+        .Case("round", {buildMathOp<math::RoundOp>, 1})
+        .Case("rsqrt", {buildMathOp<math::RsqrtOp>, 1})
+        .Case("sin", {buildMathOp<math::SinOp>, 1})
+        .Case("sqrt", {buildMathOp<math::SqrtOp>, 1})
+        .Case("tan", {buildMathOp<math::TanOp>, 1})
+        .Case("tanh", {buildMathOp<math::TanhOp>, 1})
+        .Case("trunc", {buildMathOp<math::TruncOp>, 1})
+        .Default({nullptr, 0});
+  };
+
+  auto entry = lookup(symbol);
+  if (!entry.first && symbol.consume_back("f"))
+    entry = lookup(symbol);
+  if (!entry.first)
+    return std::nullopt;
+  return entry;
+}
+
 static Value getTransposedValue(Value source, const Location loc,
                                 ConversionPatternRewriter &rewriter) {
 
@@ -254,6 +469,100 @@ struct ExpandDimsConverter : public OpConversionPattern<triton::ExpandDimsOp> {
   }
 };
 
+// tt.view keeps the elements in row-major order, so it is a reshape. It is
+// lowered to a single tensor.collapse_shape or tensor.expand_shape when the
+// dimensions of one shape are groups of the other, and to a collapse into one
+// dimension followed by an expand otherwise. Both bufferize to views.
+struct ViewConverter : public OpConversionPattern<triton::ViewOp> {
+  using OpConversionPattern<triton::ViewOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ViewOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto src = adaptor.getSrc();
+    auto srcType = src.getType().cast<RankedTensorType>();
+    auto resType = op.getType().cast<RankedTensorType>();
+
+    if (srcType.getShape() == resType.getShape()) {
+      rewriter.replaceOp(op, src);
+      return success();
+    }
+
+    if (auto reassoc = getReassociationIndicesForReshape(srcType, resType)) {
+      if (srcType.getRank() > resType.getRank())
+        rewriter.replaceOpWithNewOp<tensor::CollapseShapeOp>(op, resType, src,
+                                                             *reassoc);
+      else
+        rewriter.replaceOpWithNewOp<tensor::ExpandShapeOp>(op, resType, src,
+                                                           *reassoc);
+      return success();
+    }
+
+    Value flat = src;
+    if (srcType.getRank() > 1) {
+      auto flatType = RankedTensorType::get({srcType.getNumElements()},
+                                            srcType.getElementType());
+      flat = rewriter.create<tensor::CollapseShapeOp>(
+          loc, flatType, src,
+          getReassociationIndicesForCollapse(srcType.getShape(),
+                                             flatType.getShape())
+              .value());
+    }
+
+    Value result = flat;
+    if (resType.getRank() > 1) {
+      auto flatType = flat.getType().cast<RankedTensorType>();
+      result = rewriter.create<tensor::ExpandShapeOp>(
+          loc, resType, flat,
+          getReassociationIndicesForCollapse(resType.getShape(),
+                                             flatType.getShape())
+              .value());
+    }
+
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+};
+
+// tt.cat concatenates its operands along the first dimension. Both are
+// inserted into one destination tensor, so that after bufferization they are
+// written once into a single buffer.
+struct CatConverter : public OpConversionPattern<triton::CatOp> {
+  using OpConversionPattern<triton::CatOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::CatOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto resType = op.getType().cast<RankedTensorType>();
+    auto lhsType = adaptor.getLhs().getType().cast<RankedTensorType>();
+    auto rhsType = adaptor.getRhs().getType().cast<RankedTensorType>();
+    auto rank = resType.getRank();
+
+    Value init = rewriter.create<tensor::EmptyOp>(loc, resType.getShape(),
+                                                  resType.getElementType());
+
+    SmallVector<OpFoldResult> offsets(rank, rewriter.getIndexAttr(0));
+    SmallVector<OpFoldResult> strides(rank, rewriter.getIndexAttr(1));
+    auto insertSlice = [&](Value src, RankedTensorType srcType, Value dest) {
+      auto sizes = getAsIndexOpFoldResult(rewriter.getContext(),
+                                          srcType.getShape());
+      return rewriter
+          .create<tensor::InsertSliceOp>(loc, src, dest, offsets, sizes,
+                                         strides)
+          .getResult();
+    };
+
+    auto withLhs = insertSlice(adaptor.getLhs(), lhsType, init);
+    offsets[0] = rewriter.getIndexAttr(lhsType.getShape()[0]);
+    auto withRhs = insertSlice(adaptor.getRhs(), rhsType, withLhs);
+
+    rewriter.replaceOp(op, withRhs);
+    return success();
+  }
+};
+
 struct TransposeConverter : public OpConversionPattern<triton::TransOp> {
   using OpConversionPattern<triton::TransOp>::OpConversionPattern;
 
@@ -307,14 +616,48 @@ struct MakeRangeConverter : public OpConversionPattern<triton::MakeRangeOp> {
   }
 };
 
+// The states cached by the rewrite of a root op are reused by the rewrites of
+// the later ops of the same function wherever the index computations they
+// refer to dominate the insertion point.
+static void enterPtrStateScope(PtrStateCache *cache, Operation *op) {
+  if (cache)
+    cache->enterScope(op->getParentOfType<triton::FuncOp>());
+}
+
 struct AddPtrConverter : public OpConversionPattern<triton::AddPtrOp> {
-  using OpConversionPattern<triton::AddPtrOp>::OpConversionPattern;
+private:
+  PtrStateCache *cache;
+
+public:
+  AddPtrConverter(MLIRContext *context, PtrStateCache *cache)
+      : OpConversionPattern<triton::AddPtrOp>(context), cache(cache) {}
 
   LogicalResult
   matchAndRewrite(triton::AddPtrOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
+    enterPtrStateScope(cache, op);
     llvm::SmallDenseMap<Value, PtrState> knwonPtrs;
-    PtrAnalysis::rewriteAddptrOp(op, rewriter, knwonPtrs);
+    PtrAnalysis::rewriteAddptrOp(op, rewriter, knwonPtrs, cache);
+    return success();
+  }
+};
+
+// Block pointers are lowered to a reinterpret_cast of the block; see
+// PtrAnalysis::rewriteBlockPtrOp.
+template <typename OpTy>
+struct BlockPtrConverter : public OpConversionPattern<OpTy> {
+private:
+  PtrStateCache *cache;
+
+public:
+  BlockPtrConverter(MLIRContext *context, PtrStateCache *cache)
+      : OpConversionPattern<OpTy>(context), cache(cache) {}
+
+  LogicalResult
+  matchAndRewrite(OpTy op, typename OpTy::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    llvm::SmallDenseMap<Value, PtrState> knownPtrs;
+    PtrAnalysis::rewriteBlockPtrOp(op, rewriter, knownPtrs, cache);
     return success();
   }
 };
@@ -322,6 +665,41 @@ struct AddPtrConverter : public OpConversionPattern<triton::AddPtrOp> {
 struct AssertConverter : public OpConversionPattern<triton::AssertOp> {
   using OpConversionPattern<triton::AssertOp>::OpConversionPattern;
 
+  // Reduce a tensor condition to whether all of its elements are true, so
+  // that the assert is checked once instead of per element.
+  static Value reduceCondition(Value cond, Location loc,
+                               ConversionPatternRewriter &rewriter) {
+    auto type = cond.getType().cast<RankedTensorType>();
+    auto rank = type.getRank();
+    auto context = rewriter.getContext();
+
+    Value allTrue = rewriter.create<arith::ConstantIntOp>(loc, 1, 1);
+    Value init = rewriter.create<tensor::EmptyOp>(loc, ArrayRef<int64_t>{},
+                                                  rewriter.getI1Type());
+    init = rewriter.create<linalg::FillOp>(loc, allTrue, init).result();
+
+    SmallVector<AffineMap> indexingMaps{
+        rewriter.getMultiDimIdentityMap(rank),
+        AffineMap::get(rank, /* symbolCount */ 0, context)};
+    SmallVector<utils::IteratorType> iteratorTypes(
+        rank, utils::IteratorType::reduction);
+    auto reduceOp = rewriter.create<linalg::GenericOp>(
+        loc, TypeRange{init.getType()}, ValueRange{cond}, ValueRange{init},
+        indexingMaps, iteratorTypes,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value elem = args[0];
+          if (!elem.getType().isInteger(1)) {
+            Value zero = b.create<arith::ConstantIntOp>(loc, 0, elem.getType());
+            elem = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::ne, elem,
+                                           zero);
+          }
+          Value all = b.create<arith::AndIOp>(loc, elem, args[1]);
+          b.create<linalg::YieldOp>(loc, all);
+        });
+    return rewriter.create<tensor::ExtractOp>(loc, reduceOp.getResult(0),
+                                              ValueRange{});
+  }
+
   LogicalResult
   matchAndRewrite(triton::AssertOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -329,14 +707,16 @@ struct AssertConverter : public OpConversionPattern<triton::AssertOp> {
 
     if (condVal.getType().isa<mlir::TensorType>()) {
       auto scalarVal = getScalarValue(op.getCondition(), op.getLoc(), rewriter);
-      condVal = scalarVal.value_or(condVal);
+      condVal = scalarVal ? *scalarVal
+                          : reduceCondition(adaptor.getCondition(),
+                                            op.getLoc(), rewriter);
     }
     assert(condVal && condVal.getType().isa<mlir::IntegerType>() &&
            "Only asserts on scalars are currently supported");
 
     if (!condVal.getType().isInteger(1)) {
-      auto zero =
-          rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), 0, 32);
+      auto zero = rewriter.create<mlir::arith::ConstantIntOp>(
+          op.getLoc(), 0, condVal.getType());
       auto newCond = rewriter.create<mlir::arith::CmpIOp>(
           op.getLoc(), arith::CmpIPredicate::ne, condVal, zero);
       condVal = newCond.getResult();
@@ -353,6 +733,19 @@ struct AssertConverter : public OpConversionPattern<triton::AssertOp> {
   }
 };
 
+// Regions of kernels are only profiled on GPUs
+struct ProfileMarkerConverter
+    : public OpConversionPattern<triton::ProfileMarkerOp> {
+  using OpConversionPattern<triton::ProfileMarkerOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ProfileMarkerOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 struct BitcastConverter : public OpConversionPattern<triton::BitcastOp> {
   using OpConversionPattern<triton::BitcastOp>::OpConversionPattern;
 
@@ -367,43 +760,553 @@ struct BitcastConverter : public OpConversionPattern<triton::BitcastOp> {
   }
 };
 
+// Lower tt.fp_to_fp. Casts between standard float types are arith.extf and
+// arith.truncf. fp8 values are decoded to and encoded from f16 bit for bit
+// like the GPU lowering: the exponent of e4m3 is rebiased by a shift and an
+// add, e5m2 is the upper byte of f16, encoding rounds to nearest with ties
+// away from zero, and subnormals are not handled. The bodies are integer ops
+// without branches or tables, so that they vectorize with the linalg.generic
+// and fuse into the consumers of the cast.
+struct FpToFpConverter : public OpConversionPattern<triton::FpToFpOp> {
+  using OpConversionPattern<triton::FpToFpOp>::OpConversionPattern;
+
+  static bool isFp8(Type type) {
+    return type.isa<Float8E4M3FNType, Float8E5M2Type>();
+  }
+
+  static Value getI16(OpBuilder &b, Location loc, int64_t value) {
+    return b.create<arith::ConstantIntOp>(loc, value, 16);
+  }
+
+  // Cast v between standard float types. f16 and bf16 are cast through f32,
+  // as neither holds all the values of the other.
+  static Value castFloat(OpBuilder &b, Location loc, Value v, Type dstType) {
+    auto srcType = v.getType().cast<FloatType>();
+    auto dstFloatType = dstType.cast<FloatType>();
+    if (srcType == dstFloatType)
+      return v;
+    if (srcType.getWidth() == dstFloatType.getWidth()) {
+      v = b.create<arith::ExtFOp>(loc, b.getF32Type(), v);
+      srcType = b.getF32Type();
+    }
+    if (srcType.getWidth() < dstFloatType.getWidth())
+      return b.create<arith::ExtFOp>(loc, dstType, v);
+    return b.create<arith::TruncFOp>(loc, dstType, v);
+  }
+
+  // Decode the fp8 value v to f16
+  static Value decodeFp8(OpBuilder &b, Location loc, Value v) {
+    Value bits = b.create<arith::BitcastOp>(loc, b.getI8Type(), v);
+    bits = b.create<arith::ExtUIOp>(loc, b.getI16Type(), bits);
+    bits = b.create<arith::ShLIOp>(loc, bits, getI16(b, loc, 8));
+    if (v.getType().isa<Float8E4M3FNType>()) {
+      // Move the 4 exponent bits into the 5 of f16 and add the difference of
+      // 8 between the biases, then restore the sign
+      Value sign = b.create<arith::AndIOp>(loc, bits, getI16(b, loc, 0x8000));
+      Value mag = b.create<arith::AndIOp>(loc, bits, getI16(b, loc, 0x7fff));
+      mag = b.create<arith::ShRUIOp>(loc, mag, getI16(b, loc, 1));
+      mag = b.create<arith::AddIOp>(loc, mag, getI16(b, loc, 0x2000));
+      bits = b.create<arith::OrIOp>(loc, mag, sign);
+    }
+    return b.create<arith::BitcastOp>(loc, b.getF16Type(), bits);
+  }
+
+  // Encode the f16 value v into the fp8 type dstType
+  static Value encodeFp8(OpBuilder &b, Location loc, Value v, Type dstType) {
+    Value bits = b.create<arith::BitcastOp>(loc, b.getI16Type(), v);
+    Value sign = b.create<arith::AndIOp>(loc, bits, getI16(b, loc, 0x8000));
+    Value mag = bits;
+    if (dstType.isa<Float8E4M3FNType>()) {
+      mag = b.create<arith::SubIOp>(loc, mag, getI16(b, loc, 0x2000));
+      mag = b.create<arith::ShLIOp>(loc, mag, getI16(b, loc, 1));
+    }
+    mag = b.create<arith::AndIOp>(loc, mag, getI16(b, loc, 0x7fff));
+    mag = b.create<arith::AddIOp>(loc, mag, getI16(b, loc, 0x80));
+    bits = b.create<arith::OrIOp>(loc, mag, sign);
+    bits = b.create<arith::ShRUIOp>(loc, bits, getI16(b, loc, 8));
+    bits = b.create<arith::TruncIOp>(loc, b.getI8Type(), bits);
+    return b.create<arith::BitcastOp>(loc, dstType, bits);
+  }
+
+  static Value buildCast(OpBuilder &b, Location loc, Value v, Type dstType) {
+    if (isFp8(v.getType()))
+      v = decodeFp8(b, loc, v);
+    if (!isFp8(dstType))
+      return castFloat(b, loc, v, dstType);
+    return encodeFp8(b, loc, castFloat(b, loc, v, b.getF16Type()), dstType);
+  }
+
+  LogicalResult
+  matchAndRewrite(triton::FpToFpOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto resultType = op.getResult().getType();
+    auto elementType = getElementTypeOrSelf(resultType);
+
+    auto tensorType = resultType.dyn_cast<RankedTensorType>();
+    if (!tensorType) {
+      rewriter.replaceOp(
+          op, buildCast(rewriter, loc, adaptor.getFrom(), elementType));
+      return success();
+    }
+
+    auto rank = tensorType.getRank();
+    SmallVector<AffineMap> indexingMaps(2,
+                                        rewriter.getMultiDimIdentityMap(rank));
+    Value init = rewriter.create<tensor::EmptyOp>(loc, tensorType.getShape(),
+                                                  elementType);
+    auto genericOp = rewriter.create<linalg::GenericOp>(
+        loc, TypeRange{tensorType}, ValueRange{adaptor.getFrom()},
+        ValueRange{init}, indexingMaps, getNParallelLoopsAttrs(rank),
+        [&](OpBuilder &b, Location loc, ValueRange blockArgs) {
+          auto result = buildCast(b, loc, blockArgs[0], elementType);
+          b.create<linalg::YieldOp>(loc, result);
+        });
+
+    rewriter.replaceOp(op, genericOp.getResults());
+    return success();
+  }
+};
+
+// Lower calls of external elementwise functions. Known libdevice and libm
+// functions on floats become math dialect ops, which can be expanded into
+// vectorizable polynomial approximations; everything else is a scalar call of
+// a declaration of the symbol. On tensors, the op or call is the body of an
+// elementwise linalg.generic.
+struct ExtElemwiseConverter
+    : public OpConversionPattern<triton::ExtElemwiseOp> {
+  using OpConversionPattern<triton::ExtElemwiseOp>::OpConversionPattern;
+
+  // Declare the scalar function symbol in the module of op, or return the
+  // existing declaration. Fails if the symbol is defined with another type.
+  FailureOr<func::FuncOp>
+  getOrDeclareFunc(triton::ExtElemwiseOp op, FunctionType type,
+                   ConversionPatternRewriter &rewriter) const {
+    auto moduleOp = op->getParentOfType<ModuleOp>();
+    if (auto funcOp = moduleOp.lookupSymbol<func::FuncOp>(op.getSymbol())) {
+      if (funcOp.getFunctionType() != type)
+        return failure();
+      return funcOp;
+    }
+    if (moduleOp.lookupSymbol(op.getSymbol()))
+      return failure();
+
+    OpBuilder::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPointToStart(moduleOp.getBody());
+    auto funcOp =
+        rewriter.create<func::FuncOp>(op.getLoc(), op.getSymbol(), type);
+    funcOp.setPrivate();
+    return funcOp;
+  }
+
+  LogicalResult
+  matchAndRewrite(triton::ExtElemwiseOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto args = adaptor.getArgs();
+    auto resultType = op.getResult().getType();
+    auto elementType = getElementTypeOrSelf(resultType);
+
+    MathOpBuilder mathOpBuilder = nullptr;
+    bool floatArgs = llvm::all_of(args, [](Value arg) {
+      return getElementTypeOrSelf(arg.getType()).isa<FloatType>();
+    });
+    if (auto entry = lookupMathOp(op.getSymbol())) {
+      if (floatArgs && elementType.isa<FloatType>() &&
+          entry->second == args.size())
+        mathOpBuilder = entry->first;
+    }
+
+    func::FuncOp funcOp;
+    if (!mathOpBuilder) {
+      auto argTypes = llvm::to_vector(llvm::map_range(args, [](Value arg) {
+        return getElementTypeOrSelf(arg.getType());
+      }));
+      auto funcType = rewriter.getFunctionType(argTypes, elementType);
+      auto maybeFuncOp = getOrDeclareFunc(op, funcType, rewriter);
+      if (failed(maybeFuncOp))
+        return rewriter.notifyMatchFailure(
+            op, "symbol is already defined with a different type");
+      funcOp = *maybeFuncOp;
+    }
+
+    auto buildBody = [&](OpBuilder &b, Location loc,
+                         ValueRange args) -> Value {
+      if (mathOpBuilder)
+        return mathOpBuilder(b, loc, args);
+      return b.create<func::CallOp>(loc, funcOp, args).getResult(0);
+    };
+
+    auto tensorType = resultType.dyn_cast<RankedTensorType>();
+    if (!tensorType) {
+      rewriter.replaceOp(op, buildBody(rewriter, loc, args));
+      return success();
+    }
+
+    auto rank = tensorType.getRank();
+    SmallVector<AffineMap> indexingMaps(args.size() + 1,
+                                        rewriter.getMultiDimIdentityMap(rank));
+    Value init = rewriter.create<tensor::EmptyOp>(loc, tensorType.getShape(),
+                                                  elementType);
+    auto genericOp = rewriter.create<linalg::GenericOp>(
+        loc, TypeRange{tensorType}, args, ValueRange{init}, indexingMaps,
+        getNParallelLoopsAttrs(rank),
+        [&](OpBuilder &b, Location loc, ValueRange blockArgs) {
+          auto result = buildBody(b, loc, blockArgs.drop_back());
+          b.create<linalg::YieldOp>(loc, result);
+        });
+
+    rewriter.replaceOp(op, genericOp.getResults());
+    return success();
+  }
+};
+
 struct LoadConverter : public OpConversionPattern<triton::LoadOp> {
 private:
   using OpConversionPattern<triton::LoadOp>::OpConversionPattern;
 
+  // Memory space of the buffers loads are copied into, unless the load is
+  // tagged with another "MemorySpace"; 0 is the default memory space.
+  const unsigned int memorySpace;
+
+  // States of the block pointers rewritten so far, used to lower boundary
+  // checks.
+  PtrStateCache *cache;
+
+  // Copy the data addressed by a gather PtrState into alloc, one row along
+  // the gather dimension at a time. Each row is still a strided view of the
+  // source, so only the row offset is read from the index tensor. If mstate is
+  // given, only the leading mstate->dims elements of each dimension are
+  // copied.
+  void copyGatherRows(PtrState &state, ArrayRef<int64_t> shape, Value alloc,
+                      const MaskState *mstate, const Location loc,
+                      ConversionPatternRewriter &rewriter) const {
+    auto gatherDim = state.gatherDim;
+
+    SmallVector<OpFoldResult> rowSizes;
+    for (int64_t i = 0; i < (int64_t)shape.size(); i++) {
+      if (i == gatherDim)
+        rowSizes.push_back(rewriter.getIndexAttr(1));
+      else if (mstate)
+        rowSizes.push_back(mstate->dims[i]);
+      else
+        rowSizes.push_back(rewriter.getIndexAttr(shape[i]));
+    }
+
+    Value numRows;
+    if (mstate)
+      numRows = mstate->dims[gatherDim].dyn_cast<Value>();
+    if (!numRows) {
+      auto rows = mstate ? getIntAttr(mstate->dims[gatherDim]).value()
+                         : shape[gatherDim];
+      numRows = rewriter.create<arith::ConstantOp>(
+          loc, rewriter.getIndexAttr(rows));
+    }
+    auto zero =
+        rewriter.create<arith::ConstantOp>(loc, rewriter.getIndexAttr(0));
+    auto one =
+        rewriter.create<arith::ConstantOp>(loc, rewriter.getIndexAttr(1));
+    auto forOp = rewriter.create<scf::ForOp>(loc, zero, numRows, one);
+
+    OpBuilder::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPointToStart(forOp.getBody());
+    Value iv = forOp.getInductionVar();
+
+    Value index =
+        rewriter.create<tensor::ExtractOp>(loc, state.gatherIndices, iv);
+    index = rewriter.create<arith::IndexCastOp>(loc, rewriter.getIndexType(),
+                                                index);
+
+    PtrState rowState = state;
+    rowState.gatherIndices = nullptr;
+    rowState.offsets[gatherDim] = addOFRs(
+        addOFRs(state.offsets[gatherDim],
+                mulOFRValue(state.strides[gatherDim], iv, loc, rewriter), loc,
+                rewriter),
+        mulOFRValue(state.gatherScale, index, loc, rewriter), loc, rewriter);
+    rowState.sizes[gatherDim] = rewriter.getIndexAttr(1);
+    rowState.strides[gatherDim] = rewriter.getIndexAttr(1);
+
+    SmallVector<int64_t> rowShape(shape);
+    rowShape[gatherDim] = 1;
+    Value src = rowState.createCastOp(rowShape, loc, rewriter);
+
+    SmallVector<OpFoldResult> zeros(shape.size(), rewriter.getIndexAttr(0));
+    SmallVector<OpFoldResult> ones(shape.size(), rewriter.getIndexAttr(1));
+    if (mstate)
+      src = rewriter.create<memref::SubViewOp>(loc, src, zeros, rowSizes, ones);
+
+    SmallVector<OpFoldResult> dstOffsets(zeros);
+    dstOffsets[gatherDim] = iv;
+    Value dst = rewriter.create<memref::SubViewOp>(loc, alloc, dstOffsets,
+                                                   rowSizes, ones);
+
+    rewriter.create<memref::CopyOp>(loc, src, dst);
+  }
+
+  // Copy the data addressed by a wrap-around PtrState into alloc in strided
+  // chunks along wrapDim: the elements before the first wrap-around, and the
+  // ones after each further wrap-around, which start wrapBound elements
+  // earlier than the previous chunk. Tiles longer than the bound wrap around
+  // more than once, so the chunks after the first are copied by a loop.
+  void copyWrappedChunks(PtrState &state, ArrayRef<int64_t> shape, Value alloc,
+                         const MaskState *mstate, const Location loc,
+                         ConversionPatternRewriter &rewriter) const {
+    auto wrapDim = state.wrapDim;
+
+    SmallVector<OpFoldResult> sizes;
+    for (int64_t i = 0; i < (int64_t)shape.size(); i++)
+      sizes.push_back(mstate ? mstate->dims[i]
+                             : OpFoldResult(rewriter.getIndexAttr(shape[i])));
+
+    // Number of elements from the wrap-around position pos to the bound,
+    // capped at the elements of the tile left after the first tilePos.
+    auto getChunkSize = [&](OpFoldResult pos, OpFoldResult tilePos) {
+      return minOFRs(
+          ceilDivOFRs(subOFRs(state.wrapBound, pos, loc, rewriter),
+                      state.strides[wrapDim], loc, rewriter),
+          subOFRs(sizes[wrapDim], tilePos, loc, rewriter), loc, rewriter);
+    };
+
+    SmallVector<OpFoldResult> zeros(shape.size(), rewriter.getIndexAttr(0));
+    SmallVector<OpFoldResult> ones(shape.size(), rewriter.getIndexAttr(1));
+
+    auto firstSize =
+        getChunkSize(state.wrapStart, rewriter.getIndexAttr(0));
+    SmallVector<OpFoldResult> firstSizes(sizes);
+    firstSizes[wrapDim] = firstSize;
+    Value firstSrc = state.createCastOp(shape, loc, rewriter);
+    rewriter.create<memref::CopyOp>(
+        loc,
+        rewriter.create<memref::SubViewOp>(loc, firstSrc, zeros, firstSizes,
+                                           ones),
+        rewriter.create<memref::SubViewOp>(loc, alloc, zeros, firstSizes,
+                                           ones));
+
+    // Loop over the chunks after the first one, carrying the position of the
+    // chunk in the tile and the total shift, k * wrapBound, of chunk k.
+    auto indexType = rewriter.getIndexType();
+    Value tileSize = ofrToIndexValue(sizes[wrapDim], loc, rewriter);
+    Value initPos = ofrToIndexValue(firstSize, loc, rewriter);
+    Value initShift = ofrToIndexValue(state.wrapBound, loc, rewriter);
+    auto whileOp = rewriter.create<scf::WhileOp>(
+        loc, TypeRange{indexType, indexType}, ValueRange{initPos, initShift});
+
+    OpBuilder::InsertionGuard guard(rewriter);
+    Block *before =
+        rewriter.createBlock(&whileOp.getBefore(), {}, {indexType, indexType},
+                             {loc, loc});
+    Value more = rewriter.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::slt, before->getArgument(0), tileSize);
+    rewriter.create<scf::ConditionOp>(loc, more, before->getArguments());
+
+    Block *after =
+        rewriter.createBlock(&whileOp.getAfter(), {}, {indexType, indexType},
+                             {loc, loc});
+    Value pos = after->getArgument(0);
+    Value shift = after->getArgument(1);
+    auto advance = [&](OpFoldResult offset) {
+      return subOFRs(
+          addOFRs(offset,
+                  mulOFRValue(state.strides[wrapDim], pos, loc, rewriter), loc,
+                  rewriter),
+          shift, loc, rewriter);
+    };
+
+    auto chunkSize = getChunkSize(advance(state.wrapStart), pos);
+    PtrState chunkState = state;
+    chunkState.offsets[wrapDim] = advance(state.offsets[wrapDim]);
+
+    SmallVector<OpFoldResult> chunkSizes(sizes);
+    chunkSizes[wrapDim] = chunkSize;
+    SmallVector<OpFoldResult> chunkOffsets(zeros);
+    chunkOffsets[wrapDim] = pos;
+    Value chunkSrc = chunkState.createCastOp(shape, loc, rewriter);
+    rewriter.create<memref::CopyOp>(
+        loc,
+        rewriter.create<memref::SubViewOp>(loc, chunkSrc, zeros, chunkSizes,
+                                           ones),
+        rewriter.create<memref::SubViewOp>(loc, alloc, chunkOffsets,
+                                           chunkSizes, ones));
+
+    Value nextPos = ofrToIndexValue(addOFRs(pos, chunkSize, loc, rewriter),
+                                    loc, rewriter);
+    Value nextShift = ofrToIndexValue(
+        addOFRs(shift, state.wrapBound, loc, rewriter), loc, rewriter);
+    rewriter.create<scf::YieldOp>(loc, ValueRange{nextPos, nextShift});
+  }
+
+  // Load the element at position ivs of the tile addressed by a gather or
+  // wrap-around PtrState, through a view of that single element.
+  Value loadIrregularElement(PtrState &state, ValueRange ivs,
+                             const Location loc,
+                             ConversionPatternRewriter &rewriter) const {
+    PtrState elementState = state;
+    elementState.gatherIndices = nullptr;
+    elementState.wrapDim = -1;
+    for (size_t i = 0; i < ivs.size(); i++) {
+      elementState.offsets[i] =
+          addOFRs(state.offsets[i],
+                  mulOFRValue(state.strides[i], ivs[i], loc, rewriter), loc,
+                  rewriter);
+      elementState.sizes[i] = rewriter.getIndexAttr(1);
+    }
+
+    if (state.isGather()) {
+      auto gatherDim = state.gatherDim;
+      Value index = rewriter.create<tensor::ExtractOp>(
+          loc, state.gatherIndices, ivs[gatherDim]);
+      index = rewriter.create<arith::IndexCastOp>(
+          loc, rewriter.getIndexType(), index);
+      elementState.offsets[gatherDim] =
+          addOFRs(elementState.offsets[gatherDim],
+                  mulOFRValue(state.gatherScale, index, loc, rewriter), loc,
+                  rewriter);
+    }
+
+    // Element i along wrapDim has wrapped around
+    // (wrapStart + i * stride) / wrapBound times.
+    if (state.isWrapped()) {
+      auto wrapDim = state.wrapDim;
+      Value pos = ofrToIndexValue(
+          addOFRs(state.wrapStart,
+                  mulOFRValue(state.strides[wrapDim], ivs[wrapDim], loc,
+                              rewriter),
+                  loc, rewriter),
+          loc, rewriter);
+      Value bound = ofrToIndexValue(state.wrapBound, loc, rewriter);
+      Value wraps = rewriter.create<arith::DivSIOp>(loc, pos, bound);
+      elementState.offsets[wrapDim] =
+          subOFRs(elementState.offsets[wrapDim],
+                  rewriter.create<arith::MulIOp>(loc, wraps, bound).getResult(),
+                  loc, rewriter);
+    }
+
+    SmallVector<int64_t> elementShape(ivs.size(), 1);
+    Value view = elementState.createCastOp(elementShape, loc, rewriter);
+    Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    SmallVector<Value> zeros(ivs.size(), zero);
+    return rewriter.create<memref::LoadOp>(loc, view, zeros);
+  }
+
+  void copyIrregular(PtrState &state, ArrayRef<int64_t> shape, Value alloc,
+                     const MaskState *mstate, const Location loc,
+                     ConversionPatternRewriter &rewriter) const {
+    if (state.isGather())
+      copyGatherRows(state, shape, alloc, mstate, loc, rewriter);
+    else
+      copyWrappedChunks(state, shape, alloc, mstate, loc, rewriter);
+  }
+
+public:
+  LoadConverter(MLIRContext *context, unsigned int memorySpace,
+                PtrStateCache *cache)
+      : OpConversionPattern(context), memorySpace(memorySpace), cache(cache) {}
+
   LogicalResult
   matchAndRewrite(triton::LoadOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     auto ptr = adaptor.getPtr();
     auto mask = op.getMask();
     auto other = op.getOther();
+    auto boundaryCheck = op.getBoundaryCheck().value_or(ArrayRef<int32_t>());
     auto loc = op.getLoc();
 
-    // 0. Shortcut for scalar loads
+    // 0. Shortcut for scalar loads. The pointer is turned into a 1-element
+    // view and read with memref.load; a scalar mask guards the load with an
+    // scf.if that yields other otherwise, or zero for the undefined data that
+    // Triton leaves there without other.
     if (!op.getResult().getType().isa<ShapedType>()) {
-      // Temporarily disbale scalar load until later passes support it
-      op.emitError("Scalar load is currently not supported");
-      return failure();
-
       auto sMemRef = PtrAnalysis::getScalarMemRef(op.getPtr(), adaptor.getPtr(),
                                                   loc, rewriter);
-      auto zeroMap = AffineMap::getConstantMap(0, rewriter.getContext());
-      auto loadOp = rewriter.create<AffineLoadOp>(op.getLoc(), sMemRef, zeroMap,
-                                                  std::nullopt);
-      rewriter.replaceOp(op, loadOp.getResult());
+      auto zero =
+          rewriter.create<arith::ConstantOp>(loc, rewriter.getIndexAttr(0));
+
+      if (!mask) {
+        auto loadOp = rewriter.create<memref::LoadOp>(loc, sMemRef,
+                                                      zero.getResult());
+        rewriter.replaceOp(op, loadOp.getResult());
+        return success();
+      }
+
+      Value otherValue = adaptor.getOther();
+      if (!other) {
+        auto zeroAttr = rewriter.getZeroAttr(op.getType());
+        if (!zeroAttr) {
+          op.emitError("masked scalar loads of this type require an other "
+                       "value");
+          return failure();
+        }
+        otherValue = rewriter.create<arith::ConstantOp>(loc, zeroAttr);
+      }
+
+      auto ifOp = rewriter.create<scf::IfOp>(
+          loc, adaptor.getMask(),
+          [&](OpBuilder &b, Location loc) {
+            auto loadOp =
+                b.create<memref::LoadOp>(loc, sMemRef, zero.getResult());
+            b.create<scf::YieldOp>(loc, loadOp.getResult());
+          },
+          [&](OpBuilder &b, Location loc) {
+            b.create<scf::YieldOp>(loc, otherValue);
+          });
+      rewriter.replaceOp(op, ifOp.getResults());
       return success();
     }
 
+    assumeAlignment(ptr, loc, rewriter);
+
     // 1. Simple case where no mask is used.
     auto type = ptr.getType().cast<MemRefType>();
     auto tensorType =
         RankedTensorType::get(type.getShape(), type.getElementType());
+
+    // Pointers with a gather or wrap-around dimension are not fully described
+    // by the converted pointer, so rebuild the full state from the original
+    // pointer expression. They are lowered to several strided copies.
+    std::optional<PtrState> fullState;
+    if (auto castOp = ptr.getDefiningOp<memref::ReinterpretCastOp>();
+        castOp && (castOp->hasAttr("Gather") || castOp->hasAttr("Wrap"))) {
+      fullState.emplace();
+      PtrAnalysis::visitOperand(op.getPtr(), *fullState, loc, rewriter,
+                                llvm::SmallDenseMap<Value, PtrState>(0));
+      assert(fullState->isGather() || fullState->isWrapped());
+      emitMissedRemark(op, "triton-to-linalg",
+                       fullState->isGather()
+                           ? "the offsets are not affine in the program and "
+                             "the ranges, lowering to a gather of rows"
+                           : "the offsets wrap around, lowering to one copy "
+                             "per contiguous piece");
+    }
+
+    // Loads tagged by the pass are known to read from a buffer that the kernel
+    // never writes to. Read the source memref in place; bufferization only
+    // inserts a copy if a later op ends up writing into the tensor.
+    if (!mask && !fullState && op->hasAttr("ZeroCopy")) {
+      assert(!other && "other value used in non-masked load");
+      Value tensor = rewriter.create<bufferization::ToTensorOp>(
+          loc, tensorType, ptr, true /* restrict */);
+      rewriter.replaceOp(op, tensor);
+      return success();
+    }
+
+    unsigned int space = memorySpace;
+    if (auto spaceAttr = op->getAttrOfType<IntegerAttr>("MemorySpace"))
+      space = spaceAttr.getInt();
+    Attribute allocMemorySpace;
+    if (space)
+      allocMemorySpace = rewriter.getI64IntegerAttr(space);
     auto alloc = rewriter.create<memref::AllocOp>(
-        loc, MemRefType::get(type.getShape(), type.getElementType()));
+        loc, MemRefType::get(type.getShape(), type.getElementType(),
+                             MemRefLayoutAttrInterface{}, allocMemorySpace));
 
-    if (!mask) {
+    if (!mask && boundaryCheck.empty()) {
       assert(!other && "other value used in non-masked load");
-      rewriter.create<memref::CopyOp>(loc, ptr, alloc);
+      if (fullState)
+        copyIrregular(*fullState, type.getShape(), alloc, nullptr, loc,
+                      rewriter);
+      else
+        rewriter.create<memref::CopyOp>(loc, ptr, alloc);
       // Value tensor = rewriter.create<bufferization::ToTensorOp>(
       //     loc, tensorType, alloc, true /* restrict */, true /* writable */);
       Value tensor = rewriter.create<bufferization::ToTensorOp>(
@@ -414,60 +1317,141 @@ private:
 
     // 2. Continuous masked loads.
     // Analyze the mask operand to determine at runtime the size of the data we
-    // are moving.
+    // are moving. Loads through block pointers are masked by the bounds of the
+    // parent tensor instead.
     MaskState mstate;
-    auto isContMask = mstate.parse(mask, loc, rewriter);
+    LogicalResult isContMask = success();
+    if (!boundaryCheck.empty()) {
+      if (failed(getBoundaryMask(mstate, op.getPtr(), boundaryCheck,
+                                 type.getShape(), cache, loc, rewriter))) {
+        op.emitError("cannot determine the bounds of the block pointer");
+        return failure();
+      }
+    } else {
+      isContMask = parseContiguousMask(mstate, mask, op, loc, rewriter);
+    }
 
-    if (isContMask.failed())
-      return failure();
+    // 3. Predicated fallback for masks that are not contiguous, e.g.
+    // checkerboard or triangular masks: load the elements one at a time where
+    // the mask is set, so that masked-off elements, which may be out of
+    // bounds, are never read. They hold other, or are left undefined without
+    // it.
+    if (isContMask.failed()) {
+      if (other) {
+        auto scalarOther = getScalarValue(other, loc, rewriter);
+        assert(scalarOther.has_value() &&
+               "other value used in masked load produced by "
+               "unsupported instruction");
+        rewriter.create<linalg::FillOp>(loc, ValueRange{scalarOther.value()},
+                                        ValueRange{alloc});
+      }
+
+      Value maskTensor = materializeMask(mask, rewriter);
+      Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+      Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+      SmallVector<Value> lbs(type.getRank(), zero);
+      SmallVector<Value> steps(type.getRank(), one);
+      SmallVector<Value> ubs;
+      for (auto size : type.getShape())
+        ubs.push_back(rewriter.create<arith::ConstantIndexOp>(loc, size));
+      scf::buildLoopNest(
+          rewriter, loc, lbs, ubs, steps,
+          [&](OpBuilder &b, Location loc, ValueRange ivs) {
+            auto cond = b.create<tensor::ExtractOp>(loc, maskTensor, ivs);
+            auto ifOp = b.create<scf::IfOp>(loc, cond, /*withElseRegion=*/false);
+            OpBuilder::InsertionGuard guard(rewriter);
+            rewriter.setInsertionPointToStart(ifOp.thenBlock());
+            Value element =
+                fullState
+                    ? loadIrregularElement(*fullState, ivs, loc, rewriter)
+                    : rewriter.create<memref::LoadOp>(loc, ptr, ivs)
+                          .getResult();
+            rewriter.create<memref::StoreOp>(loc, element, alloc, ivs);
+          });
+      Value tensor = rewriter.create<bufferization::ToTensorOp>(
+          loc, tensorType, alloc);
+      rewriter.replaceOp(op, tensor);
+      return success();
+    }
 
-    auto castOp = ptr.getDefiningOp<memref::ReinterpretCastOp>();
-    assert(castOp);
-    ptr = castOp.getResult();
+    // Gathered and wrapped copies place the masked elements at the start of
+    // every dimension.
+    if (fullState && llvm::any_of(mstate.offsets, [](OpFoldResult ofr) {
+          return getIntAttr(ofr) != 0;
+        })) {
+      op.emitError("masks with a lower bound are not supported on gathered "
+                   "or wrap-around loads");
+      return failure();
+    }
 
-    auto srcSubview = mstate.getSubview(ptr, loc, rewriter);
-    auto dstSubview = mstate.getSubview(alloc, loc, rewriter);
+    memref::SubViewOp srcSubview, dstSubview;
+    if (!fullState) {
+      srcSubview = mstate.getSubview(ptr, loc, rewriter);
+      dstSubview = mstate.getSubview(alloc, loc, rewriter);
+    }
 
-    // fill load destination with other value
-    if (other) {
-      auto scalarOther = getScalarValue(other, loc, rewriter);
+    // fill the part of the load destination outside of the mask with other,
+    // or with the padding of a block pointer
+    std::optional<Value> scalarOther;
+    if (!boundaryCheck.empty()) {
+      scalarOther = getPaddingValue(op, loc, rewriter);
+    } else if (other) {
+      scalarOther = getScalarValue(other, loc, rewriter);
       assert(scalarOther.has_value() &&
              "other value used in masked load produced by "
              "unsupported instruction");
+    }
 
-      // For each dimension check if mstate.dims[i] < shape[i], or-accumulate
-      // the result
+    if (scalarOther) {
+      // The complement of the masked region is covered by at most 2 * rank
+      // disjoint strips: the strips of dimension i hold the elements that are
+      // inside the mask in all dimensions before i and below or above it in
+      // dimension i. Every element is written once, either by a fill or by the
+      // copy below.
       auto shape = type.getShape();
-      auto accBase =
-          rewriter.create<arith::ConstantOp>(loc, rewriter.getBoolAttr(false))
-              .getResult();
-      for (size_t i = 0; i < type.getShape().size(); i++) {
-        auto shapei = rewriter.create<arith::ConstantOp>(
-            loc, rewriter.getIndexAttr(shape[i]));
-
-        Value dimi = mstate.dims[i].dyn_cast<Value>();
-        if (!dimi) {
-          dimi = rewriter.create<arith::ConstantOp>(
-              loc, mstate.dims[i].get<Attribute>().cast<IntegerAttr>());
+      auto rank = shape.size();
+      SmallVector<OpFoldResult> strides(rank, rewriter.getIndexAttr(1));
+      auto fillStrip = [&](size_t i, OpFoldResult offset, OpFoldResult size) {
+        // The mask statically covers this side of dimension i
+        if (getIntAttr(size) == 0)
+          return;
+
+        SmallVector<OpFoldResult> offsets;
+        SmallVector<OpFoldResult> sizes;
+        for (size_t j = 0; j < rank; j++) {
+          if (j < i) {
+            offsets.push_back(mstate.offsets[j]);
+            sizes.push_back(mstate.dims[j]);
+          } else if (j == i) {
+            offsets.push_back(offset);
+            sizes.push_back(size);
+          } else {
+            offsets.push_back(rewriter.getIndexAttr(0));
+            sizes.push_back(rewriter.getIndexAttr(shape[j]));
+          }
         }
 
-        auto cmpOp = rewriter.create<arith::CmpIOp>(
-            loc, arith::CmpIPredicate::slt, dimi, shapei);
-        accBase = rewriter.create<arith::OrIOp>(loc, accBase, cmpOp.getResult())
-                      .getResult();
+        auto padSubview = rewriter.create<memref::SubViewOp>(
+            loc, alloc, offsets, sizes, strides);
+        rewriter.create<linalg::FillOp>(loc, ValueRange{scalarOther.value()},
+                                        ValueRange{padSubview});
+      };
+
+      for (size_t i = 0; i < rank; i++) {
+        auto maskEnd =
+            addOFRs(mstate.offsets[i], mstate.dims[i], loc, rewriter);
+        fillStrip(i, rewriter.getIndexAttr(0), mstate.offsets[i]);
+        fillStrip(i, maskEnd,
+                  subOFRs(rewriter.getIndexAttr(shape[i]), maskEnd, loc,
+                          rewriter));
       }
-
-      // condition the memset on the or-accumulation
-      // initialize with padding prior to CopyOp
-      rewriter.create<scf::IfOp>(
-          loc, accBase, [&](OpBuilder &builder, Location loc) {
-            builder.create<linalg::FillOp>(loc, ValueRange{scalarOther.value()},
-                                           ValueRange{alloc});
-            builder.create<scf::YieldOp>(loc);
-          });
     }
 
-    rewriter.create<memref::CopyOp>(loc, srcSubview, dstSubview);
+    if (fullState)
+      copyIrregular(*fullState, type.getShape(), alloc, &mstate, loc,
+                    rewriter);
+    else
+      rewriter.create<memref::CopyOp>(loc, srcSubview, dstSubview);
     // Value tensor = rewriter.create<bufferization::ToTensorOp>(
     //     loc, tensorType, alloc, true /* restrict */, true /* writable */);
     Value tensor = rewriter.create<bufferization::ToTensorOp>(
@@ -478,29 +1462,146 @@ private:
   }
 };
 
+// A prefetch is only a hint, so there is nothing to lower when the pointer
+// analysis did not turn the pointer into a strided memref. Otherwise the
+// block is prefetched from its first element with memref.prefetch; masks are
+// ignored, as a prefetch of a location that is not accessed is harmless.
+struct PrefetchConverter : public OpConversionPattern<triton::PrefetchOp> {
+  using OpConversionPattern<triton::PrefetchOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::PrefetchOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    Value memRef = adaptor.getPtr();
+    if (!op.getPtr().getType().isa<ShapedType>())
+      memRef = PtrAnalysis::getScalarMemRef(op.getPtr(), adaptor.getPtr(), loc,
+                                            rewriter);
+    if (auto type = memRef.getType().dyn_cast<MemRefType>()) {
+      Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+      SmallVector<Value> indices(type.getRank(), zero);
+      rewriter.create<memref::PrefetchOp>(loc, memRef, indices,
+                                          /*isWrite=*/false,
+                                          /*localityHint=*/3,
+                                          /*isDataCache=*/true);
+    }
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 struct StoreConverter : public OpConversionPattern<triton::StoreOp> {
   using OpConversionPattern<triton::StoreOp>::OpConversionPattern;
 
+private:
+  const bool inPlace;
+
+  // States of the block pointers rewritten so far, used to lower boundary
+  // checks.
+  PtrStateCache *cache;
+
+  // If val is produced by an elementwise linalg.generic, re-create that
+  // generic with dst as its init so it writes straight into the destination
+  // buffer instead of a temporary tensor that is copied afterwards. For masked
+  // stores, mstate restricts the generic to the region that is actually
+  // written. Returns the result of the new generic, or nullptr if val cannot
+  // be computed in place.
+  Value computeInDestination(Value val, Value dst, const MaskState *mstate,
+                             const Location loc,
+                             ConversionPatternRewriter &rewriter) const {
+    auto genericOp = val.getDefiningOp<linalg::GenericOp>();
+    if (!genericOp || genericOp->getNumResults() != 1 ||
+        genericOp.getNumParallelLoops() != genericOp.getNumLoops())
+      return nullptr;
+
+    if (genericOp.payloadUsesValueFromOperand(genericOp.getDpsInitOperand(0)))
+      return nullptr;
+
+    auto indexingMaps = genericOp.getIndexingMapsArray();
+    if (!llvm::all_of(indexingMaps,
+                      [](AffineMap map) { return map.isIdentity(); }) ||
+        !llvm::all_of(genericOp.getDpsInputOperands(), [](OpOperand *input) {
+          return input->get().getType().isa<RankedTensorType>();
+        }))
+      return nullptr;
+
+    SmallVector<Value> inputs;
+    for (auto input : genericOp.getDpsInputOperands()) {
+      Value v = input->get();
+      if (mstate)
+        v = mstate->getExtractSlice(v, loc, rewriter);
+      inputs.push_back(v);
+    }
+
+    auto dstType = dst.getType().cast<MemRefType>();
+    auto dstTensorType =
+        RankedTensorType::get(dstType.getShape(), dstType.getElementType());
+    Value dstTensor = rewriter.create<bufferization::ToTensorOp>(
+        loc, dstTensorType, dst, true /* restrict */, true /* writable */);
+
+    auto newOp = rewriter.create<linalg::GenericOp>(
+        loc, TypeRange{dstTensorType}, inputs, ValueRange{dstTensor},
+        indexingMaps, genericOp.getIteratorTypesArray());
+    rewriter.cloneRegionBefore(genericOp.getRegion(), newOp.getRegion(),
+                               newOp.getRegion().end());
+
+    return newOp.getResult(0);
+  }
+
+public:
+  StoreConverter(MLIRContext *context, bool inPlace, PtrStateCache *cache)
+      : OpConversionPattern(context), inPlace(inPlace), cache(cache) {}
+
   LogicalResult
   matchAndRewrite(triton::StoreOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     auto ptr = adaptor.getPtr();
     auto val = adaptor.getValue();
     auto mask = op.getMask();
+    auto boundaryCheck = op.getBoundaryCheck().value_or(ArrayRef<int32_t>());
     auto loc = op.getLoc();
 
-    // 0. Shortcut for scalar stores
+    // 0. Shortcut for scalar stores; see the scalar load case in
+    // LoadConverter.
     if (!val.getType().isa<ShapedType>()) {
       auto sMemRef =
           PtrAnalysis::getScalarMemRef(op.getPtr(), ptr, loc, rewriter);
-      auto zeroMap = AffineMap::getConstantMap(0, rewriter.getContext());
-      rewriter.create<AffineStoreOp>(loc, val, sMemRef, zeroMap, std::nullopt);
+      auto zero =
+          rewriter.create<arith::ConstantOp>(loc, rewriter.getIndexAttr(0));
+
+      if (!mask) {
+        rewriter.create<memref::StoreOp>(loc, val, sMemRef, zero.getResult());
+      } else {
+        rewriter.create<scf::IfOp>(
+            loc, adaptor.getMask(), [&](OpBuilder &b, Location loc) {
+              b.create<memref::StoreOp>(loc, val, sMemRef, zero.getResult());
+              b.create<scf::YieldOp>(loc);
+            });
+      }
       rewriter.eraseOp(op);
       return success();
     }
 
+    if (auto castOp = ptr.getDefiningOp<memref::ReinterpretCastOp>();
+        castOp && castOp->hasAttr("Gather")) {
+      op.emitError("scatter stores through loaded indices are not supported");
+      return failure();
+    }
+
+    if (auto castOp = ptr.getDefiningOp<memref::ReinterpretCastOp>();
+        castOp && castOp->hasAttr("Wrap")) {
+      op.emitError("stores through wrap-around offsets are not supported");
+      return failure();
+    }
+
+    assumeAlignment(ptr, loc, rewriter);
+
     // 1. Simple case where no mask is used.
-    if (!mask) {
+    if (!mask && boundaryCheck.empty()) {
+      if (inPlace) {
+        if (auto res = computeInDestination(val, ptr, nullptr, loc, rewriter))
+          val = res;
+      }
       rewriter.create<memref::TensorStoreOp>(loc, val, ptr);
       rewriter.eraseOp(op);
       return success();
@@ -508,16 +1609,57 @@ struct StoreConverter : public OpConversionPattern<triton::StoreOp> {
 
     // 2. Continuous masked stores.
     // Analyze the mask operand to determine at runtime the size of the data we
-    // are moving.
+    // are moving. Stores through block pointers are masked by the bounds of
+    // the parent tensor instead.
     MaskState mstate;
-    auto isContMask = mstate.parse(mask, loc, rewriter);
+    LogicalResult isContMask = success();
+    if (!boundaryCheck.empty()) {
+      auto shape = ptr.getType().cast<MemRefType>().getShape();
+      if (failed(getBoundaryMask(mstate, op.getPtr(), boundaryCheck, shape,
+                                 cache, loc, rewriter))) {
+        op.emitError("cannot determine the bounds of the block pointer");
+        return failure();
+      }
+    } else {
+      isContMask = parseContiguousMask(mstate, mask, op, loc, rewriter);
+    }
 
-    if (isContMask.failed())
-      return failure();
+    // 3. Predicated fallback for masks that are not contiguous: store the
+    // elements one at a time where the mask is set, so that masked-off
+    // elements, which may be out of bounds or owned by other programs, are
+    // never written.
+    if (isContMask.failed()) {
+      auto type = ptr.getType().cast<MemRefType>();
+      Value maskTensor = materializeMask(mask, rewriter);
+      Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+      Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+      SmallVector<Value> lbs(type.getRank(), zero);
+      SmallVector<Value> steps(type.getRank(), one);
+      SmallVector<Value> ubs;
+      for (auto size : type.getShape())
+        ubs.push_back(rewriter.create<arith::ConstantIndexOp>(loc, size));
+      scf::buildLoopNest(
+          rewriter, loc, lbs, ubs, steps,
+          [&](OpBuilder &b, Location loc, ValueRange ivs) {
+            auto cond = b.create<tensor::ExtractOp>(loc, maskTensor, ivs);
+            b.create<scf::IfOp>(loc, cond, [&](OpBuilder &b, Location loc) {
+              auto element = b.create<tensor::ExtractOp>(loc, val, ivs);
+              b.create<memref::StoreOp>(loc, element, ptr, ivs);
+              b.create<scf::YieldOp>(loc);
+            });
+          });
+      rewriter.eraseOp(op);
+      return success();
+    }
 
-    auto srcSlice = mstate.getExtractSlice(val, loc, rewriter);
     auto dstSubview = mstate.getSubview(ptr, loc, rewriter);
 
+    Value srcSlice;
+    if (inPlace)
+      srcSlice = computeInDestination(val, dstSubview, &mstate, loc, rewriter);
+    if (!srcSlice)
+      srcSlice = mstate.getExtractSlice(val, loc, rewriter);
+
     rewriter.create<memref::TensorStoreOp>(loc, srcSlice, dstSubview);
     rewriter.eraseOp(op);
 
@@ -525,17 +1667,317 @@ struct StoreConverter : public OpConversionPattern<triton::StoreOp> {
   }
 };
 
+// Kind of the memref.atomic_rmw implementing rmwOp on elements of
+// elementType, or nullopt if there is none and the update has to be spelled
+// out in a memref.generic_atomic_rmw.
+static std::optional<arith::AtomicRMWKind>
+getAtomicRMWKind(triton::RMWOp rmwOp, Type elementType) {
+  auto isFloat = elementType.isa<FloatType>();
+  switch (rmwOp) {
+  case triton::RMWOp::AND:
+    return arith::AtomicRMWKind::andi;
+  case triton::RMWOp::OR:
+    return arith::AtomicRMWKind::ori;
+  case triton::RMWOp::ADD:
+    return arith::AtomicRMWKind::addi;
+  case triton::RMWOp::FADD:
+    return arith::AtomicRMWKind::addf;
+  case triton::RMWOp::MAX:
+    return isFloat ? arith::AtomicRMWKind::maxf : arith::AtomicRMWKind::maxs;
+  case triton::RMWOp::MIN:
+    return isFloat ? arith::AtomicRMWKind::minf : arith::AtomicRMWKind::mins;
+  case triton::RMWOp::UMAX:
+    return arith::AtomicRMWKind::maxu;
+  case triton::RMWOp::UMIN:
+    return arith::AtomicRMWKind::minu;
+  case triton::RMWOp::XCHG:
+    return arith::AtomicRMWKind::assign;
+  case triton::RMWOp::XOR:
+    return std::nullopt;
+  }
+  llvm_unreachable("unexpected atomic rmw op");
+}
+
+// Atomically replace the element of memRef at indices by the value computed
+// from it by body, and return the element it replaced.
+static Value createGenericAtomicUpdate(
+    OpBuilder &b, const Location loc, Value memRef, ValueRange indices,
+    function_ref<Value(OpBuilder &, Location, Value)> body) {
+  auto atomicOp = b.create<memref::GenericAtomicRMWOp>(loc, memRef, indices);
+  OpBuilder::InsertionGuard guard(b);
+  b.setInsertionPointToStart(atomicOp.getBody());
+  b.create<memref::AtomicYieldOp>(
+      loc, body(b, loc, atomicOp.getCurrentValue()));
+  return atomicOp.getResult();
+}
+
+// Update the element of memRef at indices with the elements of the operands
+// at the same position, and return the element it held before.
+using AtomicUpdateFn = function_ref<Value(
+    OpBuilder &, Location, Value memRef, ValueRange indices, ValueRange)>;
+
+// Lower an atomic op on ptr, the remapped pointer operand origPtr, one element
+// at a time. The elements of operands are passed to update. Contiguous masks
+// restrict the loop nest to the masked window; other masks are tested element
+// by element. Returns the old values, undefined where the mask is false, or
+// nullptr if the result of op is unused.
+static FailureOr<Value> lowerAtomicOp(Operation *op, Value origPtr, Value ptr,
+                                      Value mask, Value maskOperand,
+                                      ValueRange operands,
+                                      AtomicUpdateFn update,
+                                      ConversionPatternRewriter &rewriter) {
+  auto loc = op->getLoc();
+  auto result = op->getResult(0);
+  auto elementType = getElementTypeOrSelf(result.getType());
+
+  // Scalar atomics access a 1-element view of the pointer; see the scalar
+  // load case in LoadConverter.
+  if (!result.getType().isa<ShapedType>()) {
+    auto sMemRef = PtrAnalysis::getScalarMemRef(origPtr, ptr, loc, rewriter);
+    Value zero =
+        rewriter.create<arith::ConstantOp>(loc, rewriter.getIndexAttr(0));
+    if (!mask)
+      return update(rewriter, loc, sMemRef, zero, operands);
+
+    auto ifOp = rewriter.create<scf::IfOp>(
+        loc, maskOperand,
+        [&](OpBuilder &b, Location loc) {
+          b.create<scf::YieldOp>(loc, update(b, loc, sMemRef, zero, operands));
+        },
+        [&](OpBuilder &b, Location loc) {
+          b.create<scf::YieldOp>(loc, b.create<arith::ConstantOp>(
+                                          loc, b.getZeroAttr(elementType))
+                                          .getResult());
+        });
+    return ifOp.getResult(0);
+  }
+
+  if (auto castOp = ptr.getDefiningOp<memref::ReinterpretCastOp>();
+      castOp && (castOp->hasAttr("Gather") || castOp->hasAttr("Wrap"))) {
+    op->emitError("atomics through gathered or wrap-around pointers are not "
+                  "supported");
+    return failure();
+  }
+
+  assumeAlignment(ptr, loc, rewriter);
+
+  auto type = ptr.getType().cast<MemRefType>();
+  auto zero = rewriter.getIndexAttr(0);
+  SmallVector<OpFoldResult> lbs(type.getRank(), zero);
+  SmallVector<OpFoldResult> ubs;
+  for (auto size : type.getShape())
+    ubs.push_back(rewriter.getIndexAttr(size));
+
+  Value maskTensor;
+  if (mask) {
+    MaskState mstate;
+    if (succeeded(parseContiguousMask(mstate, mask, op, loc, rewriter))) {
+      for (auto [i, offset] : llvm::enumerate(mstate.offsets)) {
+        lbs[i] = offset;
+        ubs[i] = addOFRs(offset, mstate.dims[i], loc, rewriter);
+      }
+    } else {
+      maskTensor = materializeMask(mask, rewriter);
+    }
+  }
+
+  Value alloc;
+  if (!result.use_empty())
+    alloc = rewriter.create<memref::AllocOp>(
+        loc, MemRefType::get(type.getShape(), elementType));
+
+  SmallVector<Value> lbValues, ubValues;
+  for (auto [lb, ub] : llvm::zip(lbs, ubs)) {
+    lbValues.push_back(ofrToIndexValue(lb, loc, rewriter));
+    ubValues.push_back(ofrToIndexValue(ub, loc, rewriter));
+  }
+  SmallVector<Value> steps(
+      type.getRank(),
+      rewriter.create<arith::ConstantOp>(loc, rewriter.getIndexAttr(1)));
+
+  scf::buildLoopNest(
+      rewriter, loc, lbValues, ubValues, steps,
+      [&](OpBuilder &b, Location loc, ValueRange ivs) {
+        auto updateElement = [&](OpBuilder &b, Location loc) {
+          SmallVector<Value> elements;
+          for (auto operand : operands)
+            elements.push_back(b.create<tensor::ExtractOp>(loc, operand, ivs));
+          auto old = update(b, loc, ptr, ivs, elements);
+          if (alloc)
+            b.create<memref::StoreOp>(loc, old, alloc, ivs);
+        };
+
+        if (!maskTensor) {
+          updateElement(b, loc);
+          return;
+        }
+        auto cond = b.create<tensor::ExtractOp>(loc, maskTensor, ivs);
+        b.create<scf::IfOp>(loc, cond, [&](OpBuilder &b, Location loc) {
+          updateElement(b, loc);
+          b.create<scf::YieldOp>(loc);
+        });
+      });
+
+  if (!alloc)
+    return Value();
+
+  auto tensorType = RankedTensorType::get(type.getShape(), elementType);
+  return rewriter
+      .create<bufferization::ToTensorOp>(loc, tensorType, alloc,
+                                         true /* restrict */,
+                                         true /* writable */)
+      .getResult();
+}
+
+struct AtomicRMWConverter : public OpConversionPattern<triton::AtomicRMWOp> {
+  using OpConversionPattern<triton::AtomicRMWOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::AtomicRMWOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto elementType = getElementTypeOrSelf(op.getResult().getType());
+    auto kind = getAtomicRMWKind(op.getAtomicRmwOp(), elementType);
+
+    auto update = [&](OpBuilder &b, Location loc, Value memRef,
+                      ValueRange indices, ValueRange elements) -> Value {
+      auto val = elements[0];
+      if (kind) {
+        return b.create<memref::AtomicRMWOp>(loc, elementType, *kind, val,
+                                             memRef, indices);
+      }
+      assert(op.getAtomicRmwOp() == triton::RMWOp::XOR);
+      return createGenericAtomicUpdate(
+          b, loc, memRef, indices, [&](OpBuilder &b, Location loc, Value cur) {
+            return b.create<arith::XOrIOp>(loc, cur, val).getResult();
+          });
+    };
+
+    auto old = lowerAtomicOp(op, op.getPtr(), adaptor.getPtr(), op.getMask(),
+                             adaptor.getMask(), adaptor.getVal(), update,
+                             rewriter);
+    if (failed(old))
+      return failure();
+    if (*old)
+      rewriter.replaceOp(op, *old);
+    else
+      rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+struct AtomicCASConverter : public OpConversionPattern<triton::AtomicCASOp> {
+  using OpConversionPattern<triton::AtomicCASOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::AtomicCASOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    // Compare the bits in memory, so that e.g. NaNs can be swapped too.
+    auto update = [&](OpBuilder &b, Location loc, Value memRef,
+                      ValueRange indices, ValueRange elements) -> Value {
+      auto cmp = elements[0];
+      auto val = elements[1];
+      return createGenericAtomicUpdate(
+          b, loc, memRef, indices, [&](OpBuilder &b, Location loc, Value cur) {
+            Value lhs = cur;
+            Value rhs = cmp;
+            if (auto floatType = cur.getType().dyn_cast<FloatType>()) {
+              auto intType = b.getIntegerType(floatType.getWidth());
+              lhs = b.create<arith::BitcastOp>(loc, intType, lhs);
+              rhs = b.create<arith::BitcastOp>(loc, intType, rhs);
+            }
+            auto eq = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq,
+                                              lhs, rhs);
+            return b.create<arith::SelectOp>(loc, eq, val, cur).getResult();
+          });
+    };
+
+    auto old = lowerAtomicOp(op, op.getPtr(), adaptor.getPtr(), Value(),
+                             Value(), {adaptor.getCmp(), adaptor.getVal()},
+                             update, rewriter);
+    if (failed(old))
+      return failure();
+    if (*old)
+      rewriter.replaceOp(op, *old);
+    else
+      rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 struct LoopConverter : public OpConversionPattern<scf::ForOp> {
-  using OpConversionPattern<scf::ForOp>::OpConversionPattern;
+private:
+  PtrStateCache *cache;
+
+public:
+  LoopConverter(MLIRContext *context, PtrStateCache *cache)
+      : OpConversionPattern<scf::ForOp>(context), cache(cache) {}
 
   LogicalResult
   matchAndRewrite(scf::ForOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
+    enterPtrStateScope(cache, op);
+    size_t mark = cache ? cache->checkpoint() : 0;
     llvm::SmallDenseMap<Value, PtrState> knownPtrs;
     PtrAnalysis::IndexMapSet
         levelToBlockArgIndex; // level -> set of block arg index to be replaced
 
-    PtrAnalysis::rewriteForOp(op, rewriter, levelToBlockArgIndex, 0, knownPtrs);
+    if (failed(PtrAnalysis::rewriteForOp(op, rewriter, levelToBlockArgIndex,
+                                         0, knownPtrs, cache))) {
+      // The IR built for the cached states is rolled back
+      if (cache)
+        cache->rollback(mark);
+      return failure();
+    }
+    return success();
+  }
+};
+
+struct WhileConverter : public OpConversionPattern<scf::WhileOp> {
+private:
+  PtrStateCache *cache;
+
+public:
+  WhileConverter(MLIRContext *context, PtrStateCache *cache)
+      : OpConversionPattern<scf::WhileOp>(context), cache(cache) {}
+
+  LogicalResult
+  matchAndRewrite(scf::WhileOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    enterPtrStateScope(cache, op);
+    size_t mark = cache ? cache->checkpoint() : 0;
+    llvm::SmallDenseMap<Value, PtrState> knownPtrs;
+    if (failed(PtrAnalysis::rewriteWhileOp(op, rewriter, knownPtrs, cache))) {
+      // The IR built for the cached states is rolled back
+      if (cache)
+        cache->rollback(mark);
+      return rewriter.notifyMatchFailure(
+          op, "cannot rewrite the pointers carried by the loop");
+    }
+    return success();
+  }
+};
+
+struct IfConverter : public OpConversionPattern<scf::IfOp> {
+private:
+  PtrStateCache *cache;
+
+public:
+  IfConverter(MLIRContext *context, PtrStateCache *cache)
+      : OpConversionPattern<scf::IfOp>(context), cache(cache) {}
+
+  LogicalResult
+  matchAndRewrite(scf::IfOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    enterPtrStateScope(cache, op);
+    size_t mark = cache ? cache->checkpoint() : 0;
+    llvm::SmallDenseMap<Value, PtrState> knownPtrs;
+    if (failed(PtrAnalysis::rewriteIfOp(op, rewriter, knownPtrs, cache))) {
+      // The IR built for the cached states is rolled back
+      if (cache)
+        cache->rollback(mark);
+      return rewriter.notifyMatchFailure(
+          op, "cannot merge the pointers yielded by the branches");
+    }
     return success();
   }
 };
@@ -551,9 +1993,44 @@ struct YieldConverter : public OpConversionPattern<scf::YieldOp> {
   }
 };
 
+struct ConditionConverter : public OpConversionPattern<scf::ConditionOp> {
+  using OpConversionPattern<scf::ConditionOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(scf::ConditionOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    rewriter.replaceOpWithNewOp<scf::ConditionOp>(op, adaptor.getCondition(),
+                                                  adaptor.getArgs());
+    return success();
+  }
+};
+
 struct MatmulConverter : public OpConversionPattern<triton::DotOp> {
   using OpConversionPattern<triton::DotOp>::OpConversionPattern;
 
+private:
+  // Match an integer operand of the form extsi(x) - splat(zp), or x -
+  // splat(zp), as produced for asymmetrically quantized inputs. On success,
+  // return the converted x and the scalar zp.
+  static std::optional<std::pair<Value, Value>>
+  getZeroPointOperand(Value operand, ConversionPatternRewriter &rewriter) {
+    auto subOp = operand.getDefiningOp<arith::SubIOp>();
+    if (!subOp)
+      return std::nullopt;
+
+    auto splatOp = subOp.getRhs().getDefiningOp<triton::SplatOp>();
+    if (!splatOp)
+      return std::nullopt;
+
+    Value x = subOp.getLhs();
+    if (auto extOp = x.getDefiningOp<arith::ExtSIOp>())
+      x = extOp.getIn();
+
+    return std::make_pair(rewriter.getRemappedValue(x),
+                          rewriter.getRemappedValue(splatOp.getSrc()));
+  }
+
+public:
   LogicalResult
   matchAndRewrite(triton::DotOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -565,32 +2042,67 @@ struct MatmulConverter : public OpConversionPattern<triton::DotOp> {
     auto opc = adaptor.getC();
     auto opcOrig = op.getC();
 
-    bool skipC = false;
-    if (auto splatOp = opcOrig.getDefiningOp<triton::SplatOp>()) {
-      if (auto val = splatOp.getSrc().getDefiningOp<arith::ConstantOp>()) {
-        if (val.getValue().cast<FloatAttr>().getValueAsDouble() == 0.) {
-          skipC = true;
-        }
-      }
-    } else if (auto constOp = opcOrig.getDefiningOp<arith::ConstantOp>()) {
-      if (auto denseAttr = dyn_cast<DenseElementsAttr>(constOp.getValue())) {
-        if (denseAttr.isSplat() &&
-            denseAttr.getSplatValue<FloatAttr>().getValueAsDouble() == 0.) {
-          skipC = true;
-        }
-      }
+    // The accumulator is passed as the outs operand so that it is updated in
+    // place. A zero accumulator is dead meta data after UseAnalysis; replace
+    // it with a zero-filled init.
+    Value init;
+    if (isZeroSplat(opcOrig)) {
+      auto elementType = dstType.getElementType();
+      Value empty = rewriter.create<tensor::EmptyOp>(loc, dstType.getShape(),
+                                                     elementType);
+      Value zero = rewriter.create<arith::ConstantOp>(
+          loc, elementType, rewriter.getZeroAttr(elementType));
+      init = rewriter
+                 .create<linalg::FillOp>(loc, ValueRange{zero},
+                                         ValueRange{empty})
+                 .result();
+    } else {
+      init = opc;
     }
 
-    auto init = rewriter.create<tensor::EmptyOp>(loc, dstType.getShape(),
-                                                 dstType.getElementType());
-
-    auto res = rewriter
-                   .create<linalg::MatmulOp>(loc, ValueRange{opa, opb},
-                                             ValueRange{init})
-                   .getResult(0);
-
-    if (!skipC) {
-      res = rewriter.create<arith::AddFOp>(loc, res, opc);
+    // The named matmul ops promote their inputs to the element type of init,
+    // which covers bf16 x bf16 -> f32 and i8 x i8 -> i32 without upcasting the
+    // operands first. Integer operands that subtract a zero point lower to
+    // linalg.quantized_matmul on the narrow inputs instead. 3-D dots carry a
+    // leading batch dimension and lower to the batched variants.
+    auto isBatched = dstType.getRank() == 3;
+    if (dstType.getRank() != 2 && !isBatched)
+      return op.emitError("only 2-D and batched 3-D dots are supported");
+
+    Value res;
+    auto zpA = getZeroPointOperand(op.getA(), rewriter);
+    auto zpB = getZeroPointOperand(op.getB(), rewriter);
+    if (dstType.getElementType().isa<IntegerType>() && (zpA || zpB)) {
+      auto getZero = [&](Value other) -> Value {
+        return rewriter.create<arith::ConstantOp>(
+            loc, other.getType(), rewriter.getZeroAttr(other.getType()));
+      };
+      auto [a, aZp] = zpA ? *zpA : std::make_pair(opa, Value());
+      auto [b, bZp] = zpB ? *zpB : std::make_pair(opb, Value());
+      if (!aZp)
+        aZp = getZero(bZp);
+      if (!bZp)
+        bZp = getZero(aZp);
+      if (isBatched)
+        res = rewriter
+                  .create<linalg::QuantizedBatchMatmulOp>(
+                      loc, ValueRange{a, b, aZp, bZp}, ValueRange{init})
+                  .getResult(0);
+      else
+        res = rewriter
+                  .create<linalg::QuantizedMatmulOp>(
+                      loc, ValueRange{a, b, aZp, bZp}, ValueRange{init})
+                  .getResult(0);
+    } else if (isBatched) {
+      res = rewriter
+                .create<linalg::BatchMatmulOp>(loc, ValueRange{opa, opb},
+                                               ValueRange{init})
+                .getResult(0);
+    } else {
+      res = rewriter
+                .create<linalg::MatmulOp>(loc, ValueRange{opa, opb},
+                                          ValueRange{init})
+                .getResult(0);
     }
 
     rewriter.replaceOp(op, res);
@@ -611,21 +2123,64 @@ private:
     return ops;
   }
 
+  // Identity value of the combiner redOp for elemType, which the accumulator
+  // is initialized with. Returns std::nullopt for unsupported combiners.
+  std::optional<TypedAttr> getRedBaseAttr(Operation *redOp, Type elemType,
+                                          OpBuilder &b) const {
+    auto getFloat = [&](double val) -> TypedAttr {
+      return b.getFloatAttr(elemType, val);
+    };
+    auto getFloatInf = [&](bool negative) -> TypedAttr {
+      auto &semantics = elemType.cast<FloatType>().getFloatSemantics();
+      return b.getFloatAttr(elemType, APFloat::getInf(semantics, negative));
+    };
+    auto getInt = [&](APInt val) -> TypedAttr {
+      return b.getIntegerAttr(elemType, val);
+    };
+    auto width = elemType.getIntOrFloatBitWidth();
+
+    return llvm::TypeSwitch<Operation *, std::optional<TypedAttr>>(redOp)
+        .Case([&](arith::AddFOp) { return getFloat(0.); })
+        .Case([&](arith::MulFOp) { return getFloat(1.); })
+        .Case([&](arith::MaxFOp) { return getFloatInf(/*negative=*/true); })
+        .Case([&](arith::MinFOp) { return getFloatInf(/*negative=*/false); })
+        .Case<arith::AddIOp, arith::OrIOp, arith::XOrIOp, arith::MaxUIOp>(
+            [&](auto) { return getInt(APInt::getZero(width)); })
+        .Case([&](arith::MulIOp) { return getInt(APInt(width, 1)); })
+        .Case<arith::AndIOp, arith::MinUIOp>(
+            [&](auto) { return getInt(APInt::getAllOnes(width)); })
+        .Case([&](arith::MaxSIOp) {
+          return getInt(APInt::getSignedMinValue(width));
+        })
+        .Case([&](arith::MinSIOp) {
+          return getInt(APInt::getSignedMaxValue(width));
+        })
+        .Default([](Operation *) { return std::nullopt; });
+  }
+
   bool isReductionOpSupported(Operation *redOp) const {
-    return isa<arith::AddFOp, arith::MaxFOp>(redOp);
+    return isa<arith::AddFOp, arith::MulFOp, arith::MaxFOp, arith::MinFOp,
+               arith::AddIOp, arith::MulIOp, arith::MaxSIOp, arith::MinSIOp,
+               arith::MaxUIOp, arith::MinUIOp, arith::AndIOp, arith::OrIOp,
+               arith::XOrIOp>(redOp);
   }
 
-  float getRedBaseVal(Operation *redOp) const {
-    return llvm::TypeSwitch<Operation *, float>(redOp)
-        .Case([](arith::AddFOp) { return 0; })
-        .Case([](arith::MaxFOp) {
-          return -std::numeric_limits<float>::infinity();
-        })
-        .Default([](Operation *op) {
-          op->dump();
-          llvm_unreachable("Reduction op not yet supported");
-          return -1;
-        });
+  std::optional<vector::CombiningKind>
+  getCombiningKind(Operation *redOp) const {
+    using Kind = vector::CombiningKind;
+    return llvm::TypeSwitch<Operation *, std::optional<Kind>>(redOp)
+        .Case<arith::AddFOp, arith::AddIOp>([](auto) { return Kind::ADD; })
+        .Case<arith::MulFOp, arith::MulIOp>([](auto) { return Kind::MUL; })
+        .Case([](arith::MaxFOp) { return Kind::MAXF; })
+        .Case([](arith::MinFOp) { return Kind::MINF; })
+        .Case([](arith::MaxSIOp) { return Kind::MAXSI; })
+        .Case([](arith::MinSIOp) { return Kind::MINSI; })
+        .Case([](arith::MaxUIOp) { return Kind::MAXUI; })
+        .Case([](arith::MinUIOp) { return Kind::MINUI; })
+        .Case([](arith::AndIOp) { return Kind::AND; })
+        .Case([](arith::OrIOp) { return Kind::OR; })
+        .Case([](arith::XOrIOp) { return Kind::XOR; })
+        .Default([](Operation *) { return std::nullopt; });
   }
 
   bool requiresF32Conversion(const Type elemType, Operation *redOp) const {
@@ -638,22 +2193,204 @@ private:
   Value getRedElement(Value lhs, Value rhs, const Location loc,
                       Operation *redOp, OpBuilder &b,
                       const bool convertLhsToF32Precision) const {
-    return llvm::TypeSwitch<Operation *, Value>(redOp)
-        .Case([&](arith::AddFOp) {
-          if (convertLhsToF32Precision) {
-            lhs = b.create<arith::ExtFOp>(loc, Float32Type::get(b.getContext()),
-                                          lhs);
-          }
-          return b.create<arith::AddFOp>(loc, lhs, rhs);
-        })
-        .Case([&](arith::MaxFOp) {
-          return b.create<arith::MaxFOp>(loc, lhs, rhs);
-        })
-        .Default([](Operation *op) {
-          op->dump();
-          llvm_unreachable("Reduction op not yet supported");
-          return nullptr;
+    if (convertLhsToF32Precision) {
+      lhs = b.create<arith::ExtFOp>(loc, Float32Type::get(b.getContext()), lhs);
+    }
+    // All supported combiners are binary arith ops; re-create redOp on the
+    // new operands.
+    OperationState state(loc, redOp->getName(), ValueRange{lhs, rhs},
+                         TypeRange{rhs.getType()}, redOp->getAttrs());
+    return b.create(state)->getResult(0);
+  }
+
+  // Return true if cmpOp tests lhs > rhs (or >=), false if it tests lhs < rhs
+  // (or <=), and std::nullopt for other predicates.
+  static std::optional<bool> isMaxPredicate(Operation *cmpOp) {
+    if (auto cmpf = dyn_cast<arith::CmpFOp>(cmpOp)) {
+      switch (cmpf.getPredicate()) {
+      case arith::CmpFPredicate::OGT:
+      case arith::CmpFPredicate::OGE:
+      case arith::CmpFPredicate::UGT:
+      case arith::CmpFPredicate::UGE:
+        return true;
+      case arith::CmpFPredicate::OLT:
+      case arith::CmpFPredicate::OLE:
+      case arith::CmpFPredicate::ULT:
+      case arith::CmpFPredicate::ULE:
+        return false;
+      default:
+        return std::nullopt;
+      }
+    }
+    if (auto cmpi = dyn_cast<arith::CmpIOp>(cmpOp)) {
+      switch (cmpi.getPredicate()) {
+      case arith::CmpIPredicate::sgt:
+      case arith::CmpIPredicate::sge:
+      case arith::CmpIPredicate::ugt:
+      case arith::CmpIPredicate::uge:
+        return true;
+      case arith::CmpIPredicate::slt:
+      case arith::CmpIPredicate::sle:
+      case arith::CmpIPredicate::ult:
+      case arith::CmpIPredicate::ule:
+        return false;
+      default:
+        return std::nullopt;
+      }
+    }
+    return std::nullopt;
+  }
+
+  static bool isUnsignedPredicate(arith::CmpIPredicate pred) {
+    return pred == arith::CmpIPredicate::ugt ||
+           pred == arith::CmpIPredicate::uge ||
+           pred == arith::CmpIPredicate::ult ||
+           pred == arith::CmpIPredicate::ule;
+  }
+
+  // Lower a two-operand (value, index) reduction such as argmax and argmin to
+  // a two-result linalg.reduce whose body is the cloned combine region. The
+  // accumulators are the lhs arguments of the region, so ties are resolved
+  // as in Triton. The value accumulator starts at the identity of the
+  // ordering, signed or unsigned as the comparison, and the index accumulator
+  // at the largest index, which loses every tie against a real element.
+  LogicalResult
+  convertToLinalgArgReduce(triton::ReduceOp op,
+                           typename triton::ReduceOp::Adaptor adaptor,
+                           ConversionPatternRewriter &rewriter) const {
+    auto loc = op.getLoc();
+    auto sources = adaptor.getOperands();
+    auto body = op.getBody();
+    auto valueType =
+        sources[0].getType().cast<RankedTensorType>().getElementType();
+    auto indexType =
+        sources[1].getType().cast<RankedTensorType>().getElementType();
+
+    if (!indexType.isa<IntegerType>())
+      return op.emitError("two-operand reductions must carry an integer "
+                          "index as the second operand");
+
+    // Find the ordering the combiner implements from the comparison of the
+    // two value arguments.
+    Value lhsValue = body->getArgument(0), rhsValue = body->getArgument(2);
+    std::optional<bool> isMax;
+    bool isUnsigned = false;
+    for (auto &bodyOp : body->without_terminator()) {
+      if (!isa<arith::CmpFOp, arith::CmpIOp>(bodyOp))
+        continue;
+      auto pred = isMaxPredicate(&bodyOp);
+      if (!pred)
+        continue;
+      if (bodyOp.getOperand(0) == lhsValue && bodyOp.getOperand(1) == rhsValue)
+        isMax = *pred;
+      else if (bodyOp.getOperand(0) == rhsValue &&
+               bodyOp.getOperand(1) == lhsValue)
+        isMax = !*pred;
+      if (isMax) {
+        if (auto cmpi = dyn_cast<arith::CmpIOp>(bodyOp))
+          isUnsigned = isUnsignedPredicate(cmpi.getPredicate());
+        break;
+      }
+    }
+    if (!isMax)
+      return op.emitError("unsupported two-operand reduction; only argmax "
+                          "and argmin style combiners are supported");
+
+    TypedAttr valueBase;
+    if (auto floatType = valueType.dyn_cast<FloatType>())
+      valueBase = rewriter.getFloatAttr(
+          floatType, APFloat::getInf(floatType.getFloatSemantics(), *isMax));
+    else if (isUnsigned)
+      valueBase = rewriter.getIntegerAttr(
+          valueType,
+          *isMax ? APInt::getMinValue(valueType.getIntOrFloatBitWidth())
+                 : APInt::getMaxValue(valueType.getIntOrFloatBitWidth()));
+    else
+      valueBase = rewriter.getIntegerAttr(
+          valueType, *isMax ? APInt::getSignedMinValue(
+                                  valueType.getIntOrFloatBitWidth())
+                            : APInt::getSignedMaxValue(
+                                  valueType.getIntOrFloatBitWidth()));
+    TypedAttr indexBase = rewriter.getIntegerAttr(
+        indexType, APInt::getSignedMaxValue(indexType.getIntOrFloatBitWidth()));
+
+    SmallVector<Value> inits;
+    for (auto [base, result] :
+         llvm::zip(SmallVector<TypedAttr>{valueBase, indexBase},
+                   op.getResults())) {
+      Value accBase = rewriter.create<arith::ConstantOp>(loc, base);
+      if (auto resType = result.getType().dyn_cast<RankedTensorType>()) {
+        Value init = rewriter.create<tensor::EmptyOp>(
+            loc, resType.getShape(), resType.getElementType());
+        inits.push_back(rewriter
+                            .create<linalg::FillOp>(loc, ValueRange{accBase},
+                                                    ValueRange{init})
+                            .result());
+      } else {
+        Value init = rewriter.create<tensor::EmptyOp>(
+            loc, ArrayRef<int64_t>{}, base.getType());
+        inits.push_back(
+            rewriter.create<tensor::InsertOp>(loc, accBase, init, ValueRange{}));
+      }
+    }
+
+    auto reduceOp = rewriter.create<linalg::ReduceOp>(
+        loc, ValueRange(sources), ValueRange(inits),
+        SmallVector<int64_t>{op.getAxis()},
+        [&](OpBuilder &opBuilder, Location loc, ValueRange inputs) {
+          // inputs holds the elements followed by the accumulators; the
+          // region takes the accumulators (lhs) first.
+          IRMapping mapping;
+          mapping.map(body->getArgument(0), inputs[2]);
+          mapping.map(body->getArgument(1), inputs[3]);
+          mapping.map(body->getArgument(2), inputs[0]);
+          mapping.map(body->getArgument(3), inputs[1]);
+          for (auto &bodyOp : body->without_terminator())
+            opBuilder.clone(bodyOp, mapping);
+          SmallVector<Value> results;
+          for (auto operand : body->getTerminator()->getOperands())
+            results.push_back(mapping.lookupOrDefault(operand));
+          opBuilder.create<linalg::YieldOp>(loc, results);
         });
+
+    SmallVector<Value> finalResults;
+    for (auto [res, result] :
+         llvm::zip(reduceOp.getResults(), op.getResults())) {
+      Value finalResult = res;
+      if (!result.getType().isa<RankedTensorType>())
+        finalResult = rewriter.create<tensor::ExtractOp>(loc, finalResult,
+                                                         ValueRange{});
+      finalResults.push_back(finalResult);
+    }
+
+    rewriter.replaceOp(op, finalResults);
+    return success();
+  }
+
+  // Sum of a batched dot over its batch dimension: replace the
+  // linalg.batch_matmul produced for the dot by a linalg.batch_reduce_matmul
+  // that accumulates all batches into one output. The batch_matmul is left
+  // without users and is removed as dead code.
+  Value getBatchReduceMatmul(triton::ReduceOp op, Value source, Value init,
+                             Operation *redOp,
+                             ConversionPatternRewriter &rewriter) const {
+    if (op.getAxis() != 0 || !isa<arith::AddFOp, arith::AddIOp>(redOp))
+      return nullptr;
+
+    auto dotOp = op.getOperands().front().getDefiningOp<triton::DotOp>();
+    if (!dotOp || !dotOp->hasOneUse() || !isZeroSplat(dotOp.getC()))
+      return nullptr;
+
+    auto batchOp = source.getDefiningOp<linalg::BatchMatmulOp>();
+    if (!batchOp || init.getType().cast<ShapedType>().getElementType() !=
+                        dotOp.getType().getElementType())
+      return nullptr;
+
+    return rewriter
+        .create<linalg::BatchReduceMatmulOp>(op.getLoc(),
+                                             batchOp.getDpsInputs(),
+                                             ValueRange{init})
+        .getResult(0);
   }
 
   LogicalResult
@@ -673,7 +2410,7 @@ private:
     if (reductionOps.size() != 1 ||
         !isReductionOpSupported(reductionOps.front())) {
       return op.emitError("Only support lowering reduction with body "
-                          "containing 1 maxf or addf.");
+                          "containing 1 supported arith combiner.");
     }
 
     auto rop = reductionOps.front();
@@ -690,29 +2427,46 @@ private:
     auto constantType = convertToF32Precision
                             ? Float32Type::get(rewriter.getContext())
                             : elemType;
-    float accBaseVal = getRedBaseVal(rop);
-    auto accBase = rewriter.create<arith::ConstantOp>(
-        loc, constantType, rewriter.getFloatAttr(constantType, accBaseVal));
-    Value initTensor;
+    auto accBaseAttr = getRedBaseAttr(rop, constantType, rewriter);
+    assert(accBaseAttr && "Reduction op not yet supported");
+    auto accBase = rewriter.create<arith::ConstantOp>(loc, *accBaseAttr);
 
+    // Reduce whole vectors with vector.reduction, which lowers to SIMD
+    // lanes and a horizontal reduction instead of a serial scalar loop.
     if (isVectorReduce) {
-      // The affine vectorizer cannot vectorize affine loops generated from
-      // linalg.reduce for the vector reduce case, so we must rewrite the
-      // linalg.reduce to affine loops manually. Here we lower to AllocTensor
-      // directly instead of EmptyOp so that the subsequent pass can recognize
-      // the patterns (EmptyOp is susceptible to being CSE'd away, making it
-      // harder to match the patterns correctly).
-      initTensor = rewriter.create<bufferization::AllocTensorOp>(
-          loc, RankedTensorType::get({}, constantType), ValueRange{});
-      initTensor = rewriter.create<tensor::InsertOp>(loc, accBase, initTensor,
-                                                     ValueRange{});
-    } else {
-      Value init = rewriter.create<tensor::EmptyOp>(
-          loc, cast<RankedTensorType>(resType).getShape(), constantType);
-      initTensor = rewriter
-                       .create<linalg::FillOp>(loc, ValueRange{accBase},
-                                               ValueRange{init})
-                       .result();
+      auto kind = getCombiningKind(rop);
+      assert(kind && "Reduction op not yet supported");
+
+      Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+      Value vector = rewriter.create<vector::TransferReadOp>(
+          loc, VectorType::get(sourceType.getShape(), elemType), source,
+          ValueRange{zero}, ArrayRef<bool>{true});
+      if (convertToF32Precision) {
+        vector = rewriter.create<arith::ExtFOp>(
+            loc, VectorType::get(sourceType.getShape(), constantType), vector);
+      }
+
+      Value finalResult =
+          rewriter.create<vector::ReductionOp>(loc, *kind, vector, accBase);
+      if (convertToF32Precision) {
+        finalResult = rewriter.create<arith::TruncFOp>(
+            loc, BFloat16Type::get(rewriter.getContext()), finalResult);
+      }
+
+      rewriter.replaceOp(op, finalResult);
+      return success();
+    }
+
+    Value init = rewriter.create<tensor::EmptyOp>(
+        loc, cast<RankedTensorType>(resType).getShape(), constantType);
+    Value initTensor = rewriter
+                           .create<linalg::FillOp>(loc, ValueRange{accBase},
+                                                   ValueRange{init})
+                           .result();
+
+    if (auto res = getBatchReduceMatmul(op, source, initTensor, rop, rewriter)) {
+      rewriter.replaceOp(op, res);
+      return success();
     }
 
     Value finalResult =
@@ -729,11 +2483,6 @@ private:
                 })
             .getResult(0);
 
-    if (sourceType.getRank() == 1) {
-      finalResult =
-          rewriter.create<tensor::ExtractOp>(loc, constantType, finalResult);
-    }
-
     if (convertToF32Precision) {
       finalResult = rewriter.create<arith::TruncFOp>(
           loc, BFloat16Type::get(rewriter.getContext()), finalResult);
@@ -759,10 +2508,96 @@ public:
            "axis is within "
            "operand's rank");
 
+    if (op.getOperands().size() == 2)
+      return convertToLinalgArgReduce(op, adaptor, rewriter);
+
+    if (op.getOperands().size() != 1)
+      return op.emitError("Only support lowering reductions of one tensor or "
+                          "of a (value, index) pair.");
+
     return convertToLinalgReduce(op, adaptor, rewriter);
   }
 };
 
+// Lowers tt.scan to a loop along the axis, each iteration combining the
+// slice of the results before it with the slice of the operands at the
+// iteration, with a linalg.generic that vectorizes over the other dimensions:
+//   out[0] = in[0], out[i] = combine(out[i - 1], in[i])
+struct ScanConverter : public OpConversionPattern<triton::ScanOp> {
+  using OpConversionPattern<triton::ScanOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ScanOp op, typename triton::ScanOp::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto axis = op.getAxis();
+    auto operands = adaptor.getOperands();
+    auto type = cast<RankedTensorType>(operands.front().getType());
+    auto rank = type.getRank();
+    auto numOperands = operands.size();
+
+    // The slices of all other dimensions at one position along the axis
+    SmallVector<OpFoldResult> sizes =
+        getAsIndexOpFoldResult(rewriter.getContext(), type.getShape());
+    sizes[axis] = rewriter.getIndexAttr(1);
+    SmallVector<OpFoldResult> strides(rank, rewriter.getIndexAttr(1));
+    auto getOffsets = [&](Value pos) {
+      SmallVector<OpFoldResult> offsets(rank, rewriter.getIndexAttr(0));
+      offsets[axis] = pos;
+      return offsets;
+    };
+
+    Block &combineBlock = op.getCombineOp().front();
+    auto returnOp = cast<triton::ScanReturnOp>(combineBlock.getTerminator());
+    SmallVector<AffineMap> indexingMaps(3 * numOperands,
+                                        rewriter.getMultiDimIdentityMap(rank));
+
+    Value one =
+        rewriter.create<arith::ConstantOp>(loc, rewriter.getIndexAttr(1));
+    Value size = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getIndexAttr(type.getShape()[axis]));
+    auto forOp = rewriter.create<scf::ForOp>(
+        loc, one, size, one, operands,
+        [&](OpBuilder &b, Location loc, Value iv, ValueRange iterArgs) {
+          Value prev = b.create<arith::SubIOp>(loc, iv, one);
+          SmallVector<Value> inputs;
+          SmallVector<Value> curs;
+          for (Value acc : iterArgs) {
+            inputs.push_back(b.create<tensor::ExtractSliceOp>(
+                loc, acc, getOffsets(prev), sizes, strides));
+            curs.push_back(b.create<tensor::ExtractSliceOp>(
+                loc, acc, getOffsets(iv), sizes, strides));
+          }
+          inputs.append(curs);
+
+          auto genericOp = b.create<linalg::GenericOp>(
+              loc, ValueRange(curs).getTypes(), inputs, curs, indexingMaps,
+              getNParallelLoopsAttrs(rank),
+              [&](OpBuilder &nb, Location nloc, ValueRange args) {
+                IRMapping mapping;
+                mapping.map(combineBlock.getArguments(),
+                            args.take_front(2 * numOperands));
+                for (auto &combineOp : combineBlock.without_terminator())
+                  nb.clone(combineOp, mapping);
+                SmallVector<Value> results;
+                for (Value result : returnOp.getResult())
+                  results.push_back(mapping.lookupOrDefault(result));
+                nb.create<linalg::YieldOp>(nloc, results);
+              });
+
+          SmallVector<Value> results;
+          for (auto [result, acc] :
+               llvm::zip(genericOp.getResults(), iterArgs))
+            results.push_back(b.create<tensor::InsertSliceOp>(
+                loc, result, acc, getOffsets(iv), sizes, strides));
+          b.create<scf::YieldOp>(loc, results);
+        });
+
+    rewriter.replaceOp(op, forOp.getResults());
+    return success();
+  }
+};
+
 struct GetProgramIDConverter
     : public OpConversionPattern<triton::GetProgramIdOp> {
   using OpConversionPattern<triton::GetProgramIdOp>::OpConversionPattern;
@@ -821,6 +2656,33 @@ public:
   }
 };
 
+// Fold acc + tt.dot(a, b, 0) into tt.dot(a, b, acc). Triton emits the former
+// for `acc += tl.dot(a, b)`; with the accumulator as the dot operand,
+// MatmulConverter accumulates into it directly instead of materializing the
+// product and adding it in a separate elementwise op. AddOpTy is arith::AddFOp
+// or arith::AddIOp.
+template <typename AddOpTy>
+struct DotAccumulatorConverter : public OpRewritePattern<AddOpTy> {
+  using OpRewritePattern<AddOpTy>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(AddOpTy addOp,
+                                PatternRewriter &rewriter) const final {
+    for (unsigned i = 0; i < 2; i++) {
+      auto dotOp = addOp->getOperand(i).getDefiningOp<triton::DotOp>();
+      if (!dotOp || !dotOp->hasOneUse() || !isZeroSplat(dotOp.getC()))
+        continue;
+
+      auto acc = addOp->getOperand(1 - i);
+      rewriter.replaceOpWithNewOp<triton::DotOp>(
+          addOp, addOp.getType(), dotOp.getA(), dotOp.getB(), acc,
+          dotOp.getAllowTF32());
+      rewriter.eraseOp(dotOp);
+      return success();
+    }
+    return failure();
+  }
+};
+
 // Convert a pair of cmpf and select to either min or max.
 // Leave the pattern as simple as possible because triton has plans to emit
 // min and max directly.
@@ -892,29 +2754,46 @@ struct DenseConstantConverter : public OpConversionPattern<arith::ConstantOp> {
 void mlir::triton::populateTritonToLinalgCanonicalizationPatterns(
     RewritePatternSet &patterns) {
   patterns.add<MinMaxConverter>(patterns.getContext());
+  patterns.add<DotAccumulatorConverter<arith::AddFOp>,
+               DotAccumulatorConverter<arith::AddIOp>>(patterns.getContext());
 }
 
 void mlir::triton::populateTritonToLinalgConversionPatterns(
     TypeConverter &typeConverter, RewritePatternSet &patterns,
-    unsigned int launchGridRank) {
+    unsigned int launchGridRank, bool inPlaceStores, PtrStateCache *cache,
+    unsigned int loadMemorySpace) {
   populateFunctionOpInterfaceTypeConversionPattern<triton::FuncOp>(
       patterns, typeConverter);
   patterns.add<MetaOpConverter>(patterns.getContext());
-  patterns.add<StoreConverter>(patterns.getContext());
-  patterns.add<AddPtrConverter>(patterns.getContext());
+  patterns.add<StoreConverter>(patterns.getContext(), inPlaceStores, cache);
+  patterns.add<AddPtrConverter>(patterns.getContext(), cache);
+  patterns.add<AtomicRMWConverter, AtomicCASConverter>(patterns.getContext());
+  patterns.add<BlockPtrConverter<triton::MakeTensorPtrOp>,
+               BlockPtrConverter<triton::AdvanceOp>>(patterns.getContext(),
+                                                      cache);
   patterns.add<GetProgramIDConverter>(patterns.getContext(), launchGridRank);
   patterns.add<YieldConverter>(patterns.getContext());
-  patterns.add<LoadConverter>(patterns.getContext());
-  patterns.add<LoopConverter>(patterns.getContext());
+  patterns.add<ConditionConverter>(patterns.getContext());
+  patterns.add<LoadConverter>(patterns.getContext(), loadMemorySpace, cache);
+  patterns.add<PrefetchConverter>(patterns.getContext());
+  patterns.add<LoopConverter>(patterns.getContext(), cache);
+  patterns.add<WhileConverter>(patterns.getContext(), cache);
+  patterns.add<IfConverter>(patterns.getContext(), cache);
   patterns.add<BroadcastConverter>(patterns.getContext());
   patterns.add<TransposeConverter>(patterns.getContext());
   patterns.add<MakeRangeConverter>(patterns.getContext());
   patterns.add<ExpandDimsConverter>(patterns.getContext());
+  patterns.add<ViewConverter>(patterns.getContext());
+  patterns.add<CatConverter>(patterns.getContext());
   patterns.add<BitcastConverter>(patterns.getContext());
+  patterns.add<FpToFpConverter>(patterns.getContext());
+  patterns.add<ExtElemwiseConverter>(patterns.getContext());
   patterns.add<AssertConverter>(patterns.getContext());
+  patterns.add<ProfileMarkerConverter>(patterns.getContext());
   patterns.add<MatmulConverter>(patterns.getContext());
   patterns.add<SplatConverter>(patterns.getContext());
   patterns.add<ReduceConverter>(patterns.getContext());
+  patterns.add<ScanConverter>(patterns.getContext());
   patterns.add<DenseConstantConverter>(patterns.getContext());
 
   // Note: the ordering here matters!
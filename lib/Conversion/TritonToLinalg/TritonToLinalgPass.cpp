@@ -8,14 +8,21 @@
 #include "triton/Conversion/TritonToLinalg/TritonToLinalg.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 
+#include "mlir/Analysis/SliceAnalysis.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/Transforms/TilingInterfaceImpl.h"
+#include "mlir/Dialect/Linalg/Transforms/Transforms.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/Transforms/TileUsingInterface.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "mlir/Transforms/Passes.h"
 
+#include "llvm/ADT/MapVector.h"
 #include "llvm/Support/Debug.h"
 
 #define DEBUG_TYPE "triton-to-linalg"
@@ -33,7 +40,12 @@ public:
   TritonTypeConverter() {
     // The order of type conversion is important: later ones are tried earlier.
     addConversion([](Type type) { return type; });
-    addConversion([](triton::PointerType ptrType) {
+    addConversion([](triton::PointerType ptrType) -> Type {
+      // Block pointers become a view of the block
+      if (auto tensorType =
+              ptrType.getPointeeType().dyn_cast<RankedTensorType>())
+        return MemRefType::get(tensorType.getShape(),
+                               tensorType.getElementType());
       return UnrankedMemRefType::get(ptrType.getPointeeType(), 0);
     });
     addConversion([](TensorType tensorType) -> Type {
@@ -48,7 +60,6 @@ public:
 
 struct TritonToLinalgPass : public TritonToLinalgBase<TritonToLinalgPass> {
 
-  static unsigned int constexpr LAUNCH_GRID_RANK = 3;
 
   // Add additional I32 arguments to represent program
   // ID, one for each dimension of the launch grid
@@ -79,12 +90,665 @@ struct TritonToLinalgPass : public TritonToLinalgBase<TritonToLinalgPass> {
     }
   }
 
+  // Trace a pointer or a tensor of pointers back to the kernel argument it is
+  // computed from. Returns nullptr if the base pointer cannot be determined,
+  // e.g. when the pointer is carried through a loop.
+  static Value getBasePtr(Value ptr) {
+    while (auto op = ptr.getDefiningOp()) {
+      if (auto addptrOp = dyn_cast<triton::AddPtrOp>(op))
+        ptr = addptrOp.getPtr();
+      else if (auto splatOp = dyn_cast<triton::SplatOp>(op))
+        ptr = splatOp.getSrc();
+      else if (auto broadcastOp = dyn_cast<triton::BroadcastOp>(op))
+        ptr = broadcastOp.getSrc();
+      else if (auto expandDimsOp = dyn_cast<triton::ExpandDimsOp>(op))
+        ptr = expandDimsOp.getSrc();
+      else
+        return nullptr;
+    }
+
+    auto parentOp = ptr.cast<BlockArgument>().getOwner()->getParentOp();
+    return isa<triton::FuncOp>(parentOp) ? ptr : nullptr;
+  }
+
+  // Collect the base pointers that stores and atomics in root write through.
+  // Returns false if the base pointer of a write cannot be determined.
+  static bool getWrittenPtrs(Operation *root,
+                             llvm::SmallDenseSet<Value> &writtenPtrs) {
+    bool unknownWrite = false;
+    root->walk([&](Operation *op) {
+      Value ptr;
+      if (auto storeOp = dyn_cast<triton::StoreOp>(op))
+        ptr = storeOp.getPtr();
+      else if (auto rmwOp = dyn_cast<triton::AtomicRMWOp>(op))
+        ptr = rmwOp.getPtr();
+      else if (auto casOp = dyn_cast<triton::AtomicCASOp>(op))
+        ptr = casOp.getPtr();
+      else
+        return;
+
+      if (auto base = getBasePtr(ptr))
+        writtenPtrs.insert(base);
+      else
+        unknownWrite = true;
+    });
+    return !unknownWrite;
+  }
+
+  // Tag unmasked loads whose base pointer is never written to in the same
+  // function with "ZeroCopy". LoadConverter lowers tagged loads to a read-only
+  // tensor view of the source memref instead of an alloc + copy.
+  static void markZeroCopyLoads(triton::FuncOp func) {
+    llvm::SmallDenseSet<Value> writtenPtrs;
+    if (!getWrittenPtrs(func, writtenPtrs))
+      return;
+
+    func.walk([&](triton::LoadOp loadOp) {
+      if (loadOp.getMask() ||
+          !loadOp.getResult().getType().isa<RankedTensorType>())
+        return;
+      auto base = getBasePtr(loadOp.getPtr());
+      if (base && !writtenPtrs.contains(base))
+        loadOp->setAttr("ZeroCopy", UnitAttr::get(func.getContext()));
+    });
+  }
+
+  // The load that value is computed from by pure ops converting or
+  // rearranging a single tile, e.g. tt.trans or arith.extf, if any.
+  static triton::LoadOp getSourceLoad(Value value) {
+    while (auto op = value.getDefiningOp()) {
+      if (auto loadOp = dyn_cast<triton::LoadOp>(op))
+        return loadOp;
+      if (op->getNumOperands() != 1 || op->getNumResults() != 1 ||
+          op->getNumRegions() != 0 || !isMemoryEffectFree(op))
+        return nullptr;
+      value = op->getOperand(0);
+    }
+    return nullptr;
+  }
+
+  // Tag the tile loads of func with the "MemorySpace" that LoadConverter
+  // allocates their buffer in: the operands of tt.dot, which are read many
+  // times over, go to matmul-operand-memory-space, and other tiles of at
+  // least streaming-tile-bytes, which are read once, to
+  // streaming-memory-space. Loads that already have a "MemorySpace", e.g.
+  // set by the frontend, keep it. Returns the number of loads tagged.
+  unsigned assignLoadMemorySpaces(triton::FuncOp func) {
+    llvm::SmallDenseSet<Operation *> dotOperands;
+    func.walk([&](triton::DotOp dotOp) {
+      for (auto operand : {dotOp.getA(), dotOp.getB()})
+        if (auto loadOp = getSourceLoad(operand))
+          dotOperands.insert(loadOp);
+    });
+
+    unsigned numTagged = 0;
+    auto i64Type = IntegerType::get(func.getContext(), 64);
+    func.walk([&](triton::LoadOp loadOp) {
+      auto type = loadOp.getResult().getType().dyn_cast<RankedTensorType>();
+      if (!type || loadOp->hasAttr("MemorySpace"))
+        return;
+
+      unsigned space = 0;
+      if (dotOperands.contains(loadOp))
+        space = matmulOperandMemorySpace;
+      else if (type.getNumElements() * type.getElementTypeBitWidth() / 8 >=
+               streamingTileBytes)
+        space = streamingMemorySpace;
+      if (!space)
+        return;
+
+      loadOp->setAttr("MemorySpace", IntegerAttr::get(i64Type, space));
+      ++numTagged;
+    });
+    return numTagged;
+  }
+
+  // Allocate the zero-filled accumulators of matmuls in space: the
+  // tensor.empty filled by the init of the matmul, possibly carried through
+  // the iter args of loops, is replaced by a bufferization.alloc_tensor in
+  // space, which One-Shot Bufferize allocates the accumulator in. Returns
+  // the number of accumulators placed.
+  static unsigned assignAccumulatorMemorySpace(ModuleOp moduleOp,
+                                               unsigned space) {
+    SmallVector<tensor::EmptyOp> empties;
+    moduleOp.walk([&](linalg::LinalgOp op) {
+      if (!isa<linalg::MatmulOp, linalg::BatchMatmulOp,
+               linalg::QuantizedMatmulOp, linalg::QuantizedBatchMatmulOp>(op) ||
+          !op.hasTensorSemantics())
+        return;
+
+      Value init = op.getDpsInitOperand(0)->get();
+      while (auto arg = init.dyn_cast<BlockArgument>()) {
+        auto forOp = dyn_cast<scf::ForOp>(arg.getOwner()->getParentOp());
+        if (!forOp || arg.getArgNumber() == 0)
+          return;
+        init = forOp.getOpOperandForRegionIterArg(arg).get();
+      }
+      auto fillOp = init.getDefiningOp<linalg::FillOp>();
+      if (!fillOp)
+        return;
+      auto empty = fillOp.getOutputs()[0].getDefiningOp<tensor::EmptyOp>();
+      if (empty && empty->hasOneUse() && empty.getType().hasStaticShape() &&
+          !llvm::is_contained(empties, empty))
+        empties.push_back(empty);
+    });
+
+    IRRewriter rewriter(moduleOp.getContext());
+    for (auto empty : empties) {
+      rewriter.setInsertionPoint(empty);
+      auto alloc = rewriter.replaceOpWithNewOp<bufferization::AllocTensorOp>(
+          empty, empty.getType(), ValueRange{});
+      alloc.setMemorySpaceAttr(rewriter.getI64IntegerAttr(space));
+    }
+    return empties.size();
+  }
+
+  // Move loads that read the same data in every iteration of the scf.for
+  // they are in, together with the ops computing their operands, in front of
+  // the loop, so that they are converted into a single alloc + copy. The
+  // operands must not depend on the induction variable or the iter args, and
+  // nothing in the loop may write through the base pointer of the load.
+  // Inner loops are visited first, so loads can be hoisted through several
+  // loops. Since the loops may not run, the hoisted loads are then guarded by
+  // an scf.if on all of them having a first iteration, which yields zeros
+  // otherwise. Returns the number of loads hoisted.
+  static unsigned hoistLoopInvariantLoads(triton::FuncOp func) {
+    SmallVector<scf::ForOp> forOps;
+    func.walk([&](scf::ForOp forOp) { forOps.push_back(forOp); });
+
+    // The loops each hoisted load was moved out of, innermost first.
+    llvm::MapVector<Operation *, SmallVector<scf::ForOp>> hoisted;
+    for (auto forOp : forOps) {
+      llvm::SmallDenseSet<Value> writtenPtrs;
+      if (!getWrittenPtrs(forOp, writtenPtrs))
+        continue;
+
+      auto isInvariant = [&](Value v) {
+        return v.getParentRegion() != &forOp.getRegion();
+      };
+
+      SmallVector<triton::LoadOp> loads(
+          forOp.getBody()->getOps<triton::LoadOp>());
+      for (auto loadOp : loads) {
+        auto base = getBasePtr(loadOp.getPtr());
+        if (!base || writtenPtrs.contains(base) ||
+            !Builder(loadOp->getContext()).getZeroAttr(loadOp.getType()))
+          continue;
+
+        // The guard of a load hoisted out of inner loops tests their bounds
+        auto &loops = hoisted[loadOp];
+        if (!llvm::all_of(loops, [&](scf::ForOp inner) {
+              return isInvariant(inner.getLowerBound()) &&
+                     isInvariant(inner.getUpperBound());
+            }))
+          continue;
+
+        // Ops of the loop body computing the operands of the load. All of
+        // them must be pure and only read values defined outside the loop.
+        SetVector<Operation *> slice;
+        getBackwardSlice(loadOp.getOperation(), &slice, [&](Operation *op) {
+          return op->getBlock() == forOp.getBody();
+        });
+        bool invariant = llvm::all_of(slice, [&](Operation *op) {
+          return op->getNumRegions() == 0 && isMemoryEffectFree(op) &&
+                 llvm::all_of(op->getOperands(), [&](Value operand) {
+                   return isInvariant(operand) ||
+                          slice.contains(operand.getDefiningOp());
+                 });
+        });
+        invariant &= llvm::all_of(loadOp->getOperands(), [&](Value operand) {
+          return isInvariant(operand) ||
+                 slice.contains(operand.getDefiningOp());
+        });
+        if (!invariant)
+          continue;
+
+        for (auto op : slice)
+          op->moveBefore(forOp);
+        loadOp->moveBefore(forOp);
+        loops.push_back(forOp);
+      }
+    }
+
+    unsigned numHoisted = 0;
+    for (auto &[op, loops] : hoisted) {
+      if (loops.empty())
+        continue;
+      auto loadOp = cast<triton::LoadOp>(op);
+      auto loc = loadOp.getLoc();
+      OpBuilder builder(loadOp);
+      Value hasIterations;
+      for (auto forOp : loops) {
+        Value cond = builder.create<arith::CmpIOp>(
+            loc, arith::CmpIPredicate::slt, forOp.getLowerBound(),
+            forOp.getUpperBound());
+        hasIterations =
+            hasIterations
+                ? builder.create<arith::AndIOp>(loc, hasIterations, cond)
+                : cond;
+      }
+      auto ifOp = builder.create<scf::IfOp>(
+          loc, hasIterations,
+          [&](OpBuilder &b, Location loc) {
+            b.create<scf::YieldOp>(loc, loadOp.getResult());
+          },
+          [&](OpBuilder &b, Location loc) {
+            Value zeros = b.create<arith::ConstantOp>(
+                loc, b.getZeroAttr(loadOp.getType()));
+            b.create<scf::YieldOp>(loc, zeros);
+          });
+      auto thenYield = ifOp.thenYield();
+      loadOp.getResult().replaceAllUsesExcept(ifOp.getResult(0), thenYield);
+      loadOp->moveBefore(thenYield);
+      ++numHoisted;
+    }
+    return numHoisted;
+  }
+
+  // Whether the buffer, or a tensor or memref aliasing it, is carried out of
+  // the region it is defined in. Destination-style ops such as linalg.generic
+  // only return aliases of their outs operands.
+  static bool escapesRegion(Value buffer) {
+    SmallVector<Value> worklist{buffer};
+    llvm::SmallDenseSet<Value> visited;
+    while (!worklist.empty()) {
+      auto value = worklist.pop_back_val();
+      if (!visited.insert(value).second)
+        continue;
+
+      for (auto &use : value.getUses()) {
+        auto user = use.getOwner();
+        if (user->hasTrait<OpTrait::IsTerminator>())
+          return true;
+
+        if (auto dpsOp = dyn_cast<DestinationStyleOpInterface>(user)) {
+          if (dpsOp.hasTensorSemantics() && dpsOp.isDpsInit(&use))
+            worklist.push_back(dpsOp.getTiedOpResult(&use));
+          continue;
+        }
+
+        for (auto result : user->getResults()) {
+          if (result.getType().isa<BaseMemRefType, TensorType>())
+            worklist.push_back(result);
+        }
+      }
+    }
+    return false;
+  }
+
+  // Move a statically shaped alloc in front of the loops it is nested in, so
+  // that it is allocated once instead of on every iteration. This is only
+  // done if the buffer does not outlive an iteration of the innermost loop.
+  // Returns true if the alloc was moved.
+  static bool hoistLoopAlloc(memref::AllocOp alloc) {
+    if (!alloc.getType().hasStaticShape() || alloc->getNumOperands() != 0 ||
+        !isa<scf::ForOp>(alloc->getParentOp()) ||
+        escapesRegion(alloc.getResult()))
+      return false;
+
+    while (auto forOp = dyn_cast<scf::ForOp>(alloc->getParentOp()))
+      alloc->moveBefore(forOp);
+    return true;
+  }
+
+  // Linalg ops that only rearrange their input: the generics of tt.broadcast
+  // and generalized transposes.
+  static bool isViewProducer(Operation *op) {
+    return op && isa<linalg::GenericOp>(op) &&
+           (op->hasAttr("broadcastDims") || op->hasAttr("Transpose"));
+  }
+
+  // Fold broadcasts and transposes into the elementwise linalg.generic ops
+  // that consume them by composing the indexing maps, so that the rearranged
+  // tile is never allocated or written. Producers that also feed other ops,
+  // e.g. reductions or matmuls, are kept for those. Returns the number of
+  // producers that were fused away.
+  static FailureOr<unsigned> fuseViewProducers(ModuleOp moduleOp) {
+    IRRewriter rewriter(moduleOp.getContext());
+    SmallVector<linalg::TransposeOp> transposes;
+    moduleOp.walk([&](linalg::TransposeOp op) { transposes.push_back(op); });
+    for (auto op : transposes) {
+      if (!llvm::all_of(op->getUsers(), [](Operation *user) {
+            return isa<linalg::GenericOp>(user);
+          }))
+        continue;
+      rewriter.setInsertionPoint(op);
+      auto genericOp = linalg::generalizeNamedOp(rewriter, op);
+      if (succeeded(genericOp))
+        (*genericOp)->setAttr("Transpose", rewriter.getUnitAttr());
+    }
+
+    auto countViewProducers = [&]() {
+      unsigned count = 0;
+      moduleOp.walk([&](linalg::GenericOp op) {
+        if (isViewProducer(op))
+          ++count;
+      });
+      return count;
+    };
+    auto numProducers = countViewProducers();
+
+    RewritePatternSet patterns(moduleOp.getContext());
+    linalg::populateElementwiseOpFusionPatterns(
+        patterns, [](OpOperand *fusedOperand) {
+          return isViewProducer(fusedOperand->get().getDefiningOp());
+        });
+    if (failed(applyPatternsAndFoldGreedily(moduleOp, std::move(patterns))))
+      return failure();
+
+    return numProducers - countViewProducers();
+  }
+
+  // The linalg.fill of a scalar into a tensor.empty that DenseConstantConverter
+  // lowers splat constants to.
+  static linalg::FillOp getSplatFill(Value value) {
+    auto fillOp = value.getDefiningOp<linalg::FillOp>();
+    if (!fillOp || !fillOp.hasTensorSemantics() ||
+        !fillOp.getOutputs()[0].getDefiningOp<tensor::EmptyOp>())
+      return nullptr;
+    return fillOp;
+  }
+
+  // Keep splat constants symbolic in the linalg.generic ops consuming them.
+  // Inputs filled with a splat are read as the scalar in the body, and filled
+  // outs operands whose value is never read are replaced by the empty tensor
+  // of the fill. The canonicalizer then drops the unused operands and fills,
+  // so that the tile is only written where it is actually needed, e.g. as a
+  // matmul accumulator or the value of a store. Returns the number of
+  // operands folded.
+  static unsigned foldSplatFills(ModuleOp moduleOp) {
+    IRRewriter rewriter(moduleOp.getContext());
+    unsigned numFolded = 0;
+    moduleOp.walk([&](linalg::GenericOp op) {
+      if (!op.hasTensorSemantics())
+        return;
+
+      for (auto &opOperand : op->getOpOperands()) {
+        auto fillOp = getSplatFill(opOperand.get());
+        if (!fillOp)
+          continue;
+
+        auto arg = op.getMatchingBlockArgument(&opOperand);
+        if (op.isDpsInput(&opOperand)) {
+          if (arg.use_empty())
+            continue;
+          rewriter.replaceAllUsesWith(arg, fillOp.getInputs()[0]);
+        } else {
+          if (!arg.use_empty())
+            continue;
+          rewriter.updateRootInPlace(
+              op, [&]() { opOperand.set(fillOp.getOutputs()[0]); });
+        }
+        ++numFolded;
+      }
+    });
+    return numFolded;
+  }
+
+  // The op owning all uses of value, or nullptr if there is none or several.
+  static Operation *getSoleUser(Value value) {
+    if (value.use_empty())
+      return nullptr;
+    auto user = *value.getUsers().begin();
+    return llvm::all_of(value.getUsers(),
+                        [&](Operation *other) { return other == user; })
+               ? user
+               : nullptr;
+  }
+
+  // Elementwise linalg.generic with a single result that never reads its
+  // outs operand, e.g. a converted arith or math op.
+  static bool isElementwiseGeneric(Operation *op) {
+    auto genericOp = dyn_cast_or_null<linalg::GenericOp>(op);
+    return genericOp && genericOp.hasTensorSemantics() &&
+           genericOp.getNumResults() == 1 &&
+           genericOp.getNumParallelLoops() == genericOp.getNumLoops() &&
+           !genericOp.payloadUsesValueFromOperand(
+               genericOp.getDpsInitOperand(0));
+  }
+
+  // Tile the chain of elementwise generics consuming the result of each
+  // matmul, i.e. the epilogue of a tt.dot, and fuse the matmul and the rest
+  // of the chain into the tiles. The accumulator is then produced and
+  // consumed one tile at a time instead of being written and read again in
+  // full by every op of the epilogue. Returns the number of matmuls fused.
+  static FailureOr<unsigned> fuseDotEpilogues(ModuleOp moduleOp,
+                                              int64_t tileSize) {
+    SmallVector<std::pair<Operation *, linalg::GenericOp>> epilogues;
+    moduleOp.walk([&](linalg::LinalgOp op) {
+      if (!isa<linalg::MatmulOp, linalg::BatchMatmulOp,
+               linalg::QuantizedMatmulOp, linalg::QuantizedBatchMatmulOp>(op))
+        return;
+
+      linalg::GenericOp epilogue;
+      auto user = getSoleUser(op->getResult(0));
+      while (isElementwiseGeneric(user)) {
+        epilogue = cast<linalg::GenericOp>(user);
+        user = getSoleUser(epilogue->getResult(0));
+      }
+      if (epilogue)
+        epilogues.emplace_back(op, epilogue);
+    });
+
+    IRRewriter rewriter(moduleOp.getContext());
+    unsigned numFused = 0;
+    for (auto [matmulOp, epilogue] : epilogues) {
+      // Tile the rows and columns of the result; batch dimensions are kept
+      // whole.
+      auto ranges = epilogue.getStaticLoopRanges();
+      SmallVector<int64_t> tileSizes(ranges.size(), 0);
+      bool tiled = false;
+      for (size_t i = ranges.size() - std::min<size_t>(ranges.size(), 2);
+           i < ranges.size(); i++) {
+        if (ShapedType::isDynamic(ranges[i]) || ranges[i] > tileSize) {
+          tileSizes[i] = tileSize;
+          tiled = true;
+        }
+      }
+      if (!tiled)
+        continue;
+
+      // The outs operand is never read. Detach it from the producers, which
+      // could otherwise not be fused through the destination of the loops.
+      rewriter.setInsertionPoint(epilogue);
+      auto init = epilogue.getDpsInitOperand(0);
+      auto initType = init->get().getType().cast<RankedTensorType>();
+      if (initType.hasStaticShape() &&
+          !init->get().getDefiningOp<tensor::EmptyOp>()) {
+        Value empty = rewriter.create<tensor::EmptyOp>(
+            epilogue.getLoc(), initType.getShape(),
+            initType.getElementType());
+        rewriter.updateRootInPlace(epilogue, [&]() { init->set(empty); });
+      }
+
+      scf::SCFTileAndFuseOptions options;
+      options.tilingOptions.setTileSizes(tileSizes);
+      auto result = scf::tileConsumerAndFuseProducerGreedilyUsingSCFForOp(
+          rewriter, cast<TilingInterface>(epilogue.getOperation()), options);
+      if (failed(result))
+        return failure();
+
+      rewriter.replaceOp(epilogue,
+                         result->replacements.lookup(epilogue->getResult(0)));
+      if (llvm::is_contained(result->fusedProducers, matmulOp))
+        ++numFused;
+    }
+    return numFused;
+  }
+
+  // Read the reductions that tt.expand_dims and tt.broadcast spread back
+  // over their rows directly in the linalg.generic ops consuming them: an
+  // input that a tensor.expand_shape only adds unit dimensions to, and that
+  // is read at index 0 along them, is replaced by the source of the reshape.
+  // Tiling can then follow the rows from the consumers to the reductions,
+  // which it cannot through the reshape.
+  static void foldUnitExpandShapes(ModuleOp moduleOp) {
+    IRRewriter rewriter(moduleOp.getContext());
+    moduleOp.walk([&](linalg::GenericOp op) {
+      if (!op.hasTensorSemantics())
+        return;
+      auto maps = op.getIndexingMapsArray();
+      bool changed = false;
+      for (auto input : op.getDpsInputOperands()) {
+        auto expandOp = input->get().getDefiningOp<tensor::ExpandShapeOp>();
+        if (!expandOp)
+          continue;
+        auto shape = expandOp.getResultType().getShape();
+        AffineMap &map = maps[input->getOperandNumber()];
+        SmallVector<AffineExpr> exprs;
+        bool foldable = true;
+        for (auto group : expandOp.getReassociationIndices()) {
+          auto kept = llvm::find_if(group, [&](int64_t dim) {
+            return shape[dim] != 1;
+          });
+          int64_t keptDim = kept == group.end() ? group.front() : *kept;
+          for (int64_t dim : group) {
+            auto cst = map.getResult(dim).dyn_cast<AffineConstantExpr>();
+            if (dim != keptDim && (shape[dim] != 1 || !cst || cst.getValue()))
+              foldable = false;
+          }
+          exprs.push_back(map.getResult(keptDim));
+        }
+        if (!foldable)
+          continue;
+        map = AffineMap::get(map.getNumDims(), 0, exprs, op.getContext());
+        rewriter.updateRootInPlace(op,
+                                   [&]() { input->set(expandOp.getSrc()); });
+        changed = true;
+      }
+      if (changed)
+        rewriter.updateRootInPlace(op, [&]() {
+          op.setIndexingMapsAttr(rewriter.getAffineMapArrayAttr(maps));
+        });
+    });
+  }
+
+  // linalg.reduce over the last dimension of a tensor, which ReduceConverter
+  // lowers to a reduction of the first of the two last dimensions of its
+  // transpose.
+  static bool isRowReduction(linalg::ReduceOp op) {
+    auto transposeOp =
+        op.getInputs().front().getDefiningOp<linalg::TransposeOp>();
+    if (!transposeOp || op.getDimensions().size() != 1)
+      return false;
+    int64_t rank =
+        transposeOp.getInit().getType().cast<ShapedType>().getRank();
+    SmallVector<int64_t> perm = llvm::to_vector(llvm::seq<int64_t>(0, rank));
+    std::swap(perm[rank - 1], perm[rank - 2]);
+    return op.getDimensions().front() == rank - 2 &&
+           transposeOp.getPermutation() == ArrayRef<int64_t>(perm);
+  }
+
+  // Tile by rows each elementwise generic that computes a stored tensor from
+  // reductions of its rows, e.g. the max, exp, sum and divide of a softmax or
+  // the mean, variance and normalization of a layer-norm, and fuse the
+  // reductions and everything else they are computed from into the tiles.
+  // Every op then makes its pass over the same tileSize rows, which stay in
+  // the cache, instead of over the whole block. With in-place-stores, the
+  // tiles are written straight into the destination of the store. Returns
+  // the number of generics tiled.
+  static FailureOr<unsigned> fuseRowReductions(ModuleOp moduleOp,
+                                               int64_t tileSize) {
+    foldUnitExpandShapes(moduleOp);
+
+    SmallVector<linalg::GenericOp> roots;
+    moduleOp.walk([&](memref::TensorStoreOp op) {
+      Value value = op.getTensor();
+      if (auto sliceOp = value.getDefiningOp<tensor::ExtractSliceOp>())
+        value = sliceOp.getSource();
+      auto genericOp = value.getDefiningOp<linalg::GenericOp>();
+      if (!genericOp || !isElementwiseGeneric(genericOp) ||
+          genericOp.getNumLoops() < 2)
+        return;
+
+      SetVector<Operation *> slice;
+      getBackwardSlice(genericOp.getOperation(), &slice, [&](Operation *op) {
+        return op->getBlock() == genericOp->getBlock();
+      });
+      bool hasRowReductions = false;
+      for (Operation *producer : slice) {
+        auto reduceOp = dyn_cast<linalg::ReduceOp>(producer);
+        if (!reduceOp)
+          continue;
+        // Each tile would reduce all the rows of the block again
+        if (!isRowReduction(reduceOp))
+          return;
+        hasRowReductions = true;
+      }
+      if (hasRowReductions)
+        roots.push_back(genericOp);
+    });
+
+    IRRewriter rewriter(moduleOp.getContext());
+    unsigned numTiled = 0;
+    for (auto root : roots) {
+      // Rows are kept whole, and the leading dimensions are tiled one at a
+      // time.
+      auto ranges = root.getStaticLoopRanges();
+      size_t rank = ranges.size();
+      SmallVector<int64_t> tileSizes(rank, 1);
+      tileSizes[rank - 1] = 0;
+      tileSizes[rank - 2] = tileSize;
+      if (rank == 2 && !ShapedType::isDynamic(ranges[0]) &&
+          ranges[0] <= tileSize)
+        continue;
+      // The producers of the masked region of an in-place store are only
+      // read through its slices, which tiling does not fuse through
+      auto isSlice = [](OpOperand *input) {
+        return input->get().getDefiningOp<tensor::ExtractSliceOp>();
+      };
+      bool inPlace = root.getDpsInitOperand(0)
+                         ->get()
+                         .getDefiningOp<bufferization::ToTensorOp>();
+      if (inPlace && llvm::any_of(root.getDpsInputOperands(), isSlice))
+        continue;
+
+      // The outs operands of the converted elementwise ops are one of their
+      // inputs, which they never read. Detach them, so that the producers
+      // are fused into the tiles rather than through the destination of the
+      // loop, unless the destination is the one of the store.
+      SetVector<Operation *> slice;
+      getBackwardSlice(root.getOperation(), &slice, [&](Operation *op) {
+        return op->getBlock() == root->getBlock();
+      });
+      slice.insert(root);
+      for (Operation *op : slice) {
+        if (!isElementwiseGeneric(op))
+          continue;
+        auto genericOp = cast<linalg::GenericOp>(op);
+        OpOperand *init = genericOp.getDpsInitOperand(0);
+        if (init->get().getDefiningOp<tensor::EmptyOp>() ||
+            (genericOp == root && inPlace))
+          continue;
+        rewriter.setInsertionPoint(genericOp);
+        auto initType = init->get().getType().cast<RankedTensorType>();
+        Value empty = rewriter.create<tensor::EmptyOp>(
+            genericOp.getLoc(),
+            tensor::getMixedSizes(rewriter, genericOp.getLoc(), init->get()),
+            initType.getElementType());
+        rewriter.updateRootInPlace(genericOp, [&]() { init->set(empty); });
+      }
+
+      scf::SCFTileAndFuseOptions options;
+      options.tilingOptions.setTileSizes(tileSizes);
+      auto result = scf::tileConsumerAndFuseProducerGreedilyUsingSCFForOp(
+          rewriter, cast<TilingInterface>(root.getOperation()), options);
+      if (failed(result))
+        return failure();
+
+      rewriter.replaceOp(root, result->replacements.lookup(root->getResult(0)));
+      ++numTiled;
+    }
+    return numTiled;
+  }
+
 public:
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<func::FuncDialect, arith::ArithDialect, math::MathDialect,
                     linalg::LinalgDialect, AffineDialect, scf::SCFDialect,
                     tensor::TensorDialect, bufferization::BufferizationDialect,
-                    memref::MemRefDialect>();
+                    memref::MemRefDialect, vector::VectorDialect>();
+    linalg::registerTilingInterfaceExternalModels(registry);
   }
 
   void runOnOperation() override {
@@ -98,12 +762,25 @@ public:
       }
     }
 
+    if (hoistInvariantLoads)
+      moduleOp.walk([&](triton::FuncOp op) {
+        numHoistedLoads += hoistLoopInvariantLoads(op);
+      });
+
     moduleOp.walk([this](triton::FuncOp op) {
       if (failed(runUseAnalysis(op))) {
         signalPassFailure();
       }
     });
 
+    if (zeroCopyLoads)
+      moduleOp.walk([](triton::FuncOp op) { markZeroCopyLoads(op); });
+
+    if (matmulOperandMemorySpace || streamingMemorySpace)
+      moduleOp.walk([&](triton::FuncOp op) {
+        numPlacedLoads += assignLoadMemorySpaces(op);
+      });
+
     RewritePatternSet patterns(&getContext());
     ConversionTarget target(getContext());
     TritonTypeConverter tritonTypeConverter;
@@ -112,7 +789,8 @@ public:
         func::FuncDialect, arith::ArithDialect, math::MathDialect,
         linalg::LinalgDialect, AffineDialect, scf::SCFDialect,
         cf::ControlFlowDialect, tensor::TensorDialect,
-        bufferization::BufferizationDialect, memref::MemRefDialect>();
+        bufferization::BufferizationDialect, memref::MemRefDialect,
+        vector::VectorDialect>();
 
     target.addLegalOp<ModuleOp>();
 
@@ -124,6 +802,8 @@ public:
     // first. Without marking this op as legal, the conversion process will fail
     // because there's no legalization pattern for triton.reduce_return.
     target.addLegalOp<triton::ReduceReturnOp>();
+    // Likewise for triton.scan_return, which is cloned into linalg.generic
+    target.addLegalOp<triton::ScanReturnOp>();
 
     target.addLegalOp<triton::ReturnOp>();
 
@@ -147,17 +827,25 @@ public:
       return true;
     });
 
-    target.addDynamicallyLegalOp<scf::ForOp, scf::YieldOp>([](Operation *op) {
-      return llvm::all_of(op->getOperandTypes(), [](Type t) {
-        if (isa<triton::PointerType>(t)) {
-          return false;
-        }
-        if (auto shapedType = dyn_cast<ShapedType>(t)) {
-          return shapedType.getElementType().isIntOrFloat();
-        }
-        assert(t.isIntOrIndexOrFloat());
-        return true;
-      });
+    auto isLegalScfType = [](Type t) {
+      if (isa<triton::PointerType>(t)) {
+        return false;
+      }
+      if (auto shapedType = dyn_cast<ShapedType>(t)) {
+        return shapedType.getElementType().isIntOrFloat();
+      }
+      assert(t.isIntOrIndexOrFloat());
+      return true;
+    };
+
+    target.addDynamicallyLegalOp<scf::ForOp, scf::WhileOp, scf::YieldOp,
+                                 scf::ConditionOp>([=](Operation *op) {
+      return llvm::all_of(op->getOperandTypes(), isLegalScfType);
+    });
+
+    // scf.if only produces pointers; it has no operands carrying them.
+    target.addDynamicallyLegalOp<scf::IfOp>([=](Operation *op) {
+      return llvm::all_of(op->getResultTypes(), isLegalScfType);
     });
 
     target.addDynamicallyLegalDialect<arith::ArithDialect, math::MathDialect>(
@@ -178,8 +866,10 @@ public:
           return !operateOnTensors;
         });
 
+    PtrStateCache ptrStateCache;
     triton::populateTritonToLinalgConversionPatterns(
-        tritonTypeConverter, patterns, LAUNCH_GRID_RANK);
+        tritonTypeConverter, patterns, LAUNCH_GRID_RANK, inPlaceStores,
+        &ptrStateCache, loadMemorySpace);
 
     for (auto func : getOperation().getOps<triton::FuncOp>())
       addProgramId(func);
@@ -187,6 +877,40 @@ public:
     if (failed(applyFullConversion(moduleOp, target, std::move(patterns))))
       signalPassFailure();
 
+    if (accumulatorMemorySpace)
+      numPlacedAccumulators +=
+          assignAccumulatorMemorySpace(moduleOp, accumulatorMemorySpace);
+
+    if (foldSplatConstants)
+      numFoldedSplatConstants += foldSplatFills(moduleOp);
+
+    if (fuseBroadcasts) {
+      auto numFused = fuseViewProducers(moduleOp);
+      if (failed(numFused))
+        signalPassFailure();
+      else
+        numFusedBroadcasts += *numFused;
+    }
+
+    if (dotEpilogueTileSize) {
+      auto numFused = fuseDotEpilogues(moduleOp, dotEpilogueTileSize);
+      if (failed(numFused))
+        signalPassFailure();
+      else
+        numFusedDotEpilogues += *numFused;
+    }
+
+    if (rowReductionTileSize) {
+      auto numFused = fuseRowReductions(moduleOp, rowReductionTileSize);
+      if (failed(numFused))
+        signalPassFailure();
+      else
+        numFusedRowReductions += *numFused;
+    }
+
+    numPtrStateCacheHits += ptrStateCache.getNumHits();
+    numPtrStateCacheMisses += ptrStateCache.getNumMisses();
+
     // Convert tt.func and tt.return into func's counterparts
     moduleOp.walk([&](triton::FuncOp func) {
       OpBuilder builder(func);
@@ -217,9 +941,22 @@ public:
       func.erase();
     });
 
+    if (hoistLoopAllocs) {
+      SmallVector<memref::AllocOp> allocs;
+      moduleOp.walk([&](memref::AllocOp alloc) { allocs.push_back(alloc); });
+      for (auto alloc : allocs) {
+        if (hoistLoopAlloc(alloc))
+          ++numHoistedAllocs;
+      }
+    }
+
     // Erase dead code and fold constants created during lowering
     PassManager pm(&getContext(), moduleOp.getOperationName());
     pm.addPass(createCanonicalizerPass());
+    // The producers fused into the tiles of several consumers, e.g. the exp
+    // of a softmax, which its sum and its divide read, are computed once
+    if (rowReductionTileSize)
+      pm.addPass(createCSEPass());
     if (failed(runPipeline(pm, getOperation()))) {
       signalPassFailure();
     }
@@ -6,6 +6,8 @@
 #include "mlir/Dialect/Index/IR/IndexDialect.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
@@ -254,15 +256,18 @@ struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
     auto origShape = origType.getShape();
     auto typeConverter = getTypeConverter<TritonGPUTypeConverter>();
     int numWarps = typeConverter->getNumWarps();
+    int threadsPerWarp = typeConverter->getThreadsPerWarp();
+    int numThreads = numWarps * threadsPerWarp;
 
     SmallVector<unsigned> retSizePerThread = {1, 1};
-    if (origShape[0] * origShape[1] / (numWarps * 32) >= 4)
+    if (origShape[0] * origShape[1] / numThreads >= 4)
       retSizePerThread = {2, 2};
-    if (origShape[0] * origShape[1] / (numWarps * 32) >= 16)
+    if (origShape[0] * origShape[1] / numThreads >= 16)
       retSizePerThread = {4, 4};
     SmallVector<unsigned> retOrder = {1, 0};
     Attribute dEncoding = triton::gpu::BlockedEncodingAttr::get(
-        getContext(), origShape, retSizePerThread, retOrder, numWarps);
+        getContext(), origShape, retSizePerThread, retOrder, numWarps,
+        threadsPerWarp);
     RankedTensorType retType =
         RankedTensorType::get(origShape, origType.getElementType(), dEncoding);
     // a & b must be of smem layout
@@ -380,6 +385,21 @@ struct TritonStorePattern : public OpConversionPattern<triton::StoreOp> {
   }
 };
 
+struct TritonPrefetchPattern
+    : public OpConversionPattern<triton::PrefetchOp> {
+  using OpConversionPattern<triton::PrefetchOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::PrefetchOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::PrefetchOp>(
+                      op, adaptor.getPtr(), adaptor.getMask(),
+                      adaptor.getEvict()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
 struct TritonAtomicCASPattern
     : public OpConversionPattern<triton::AtomicCASOp> {
   using OpConversionPattern<triton::AtomicCASOp>::OpConversionPattern;
@@ -497,6 +517,38 @@ struct TritonReduceReturnPattern
   }
 };
 
+struct TritonScanPattern : public OpConversionPattern<triton::ScanOp> {
+  using OpConversionPattern<triton::ScanOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ScanOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto newScan = rewriter.create<triton::ScanOp>(
+        op.getLoc(), adaptor.getOperands(), adaptor.getAxis());
+    addNamedAttrs(newScan, adaptor.getAttributes());
+
+    auto &newCombineOp = newScan.getCombineOp();
+    rewriter.inlineRegionBefore(op.getCombineOp(), newCombineOp,
+                                newCombineOp.end());
+    rewriter.replaceOp(op, newScan.getResult());
+    return success();
+  }
+};
+
+struct TritonScanReturnPattern
+    : public OpConversionPattern<triton::ScanReturnOp> {
+  using OpConversionPattern<triton::ScanReturnOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ScanReturnOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::ScanReturnOp>(
+                      op, adaptor.getResult()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
 struct TritonPrintPattern : public OpConversionPattern<triton::PrintOp> {
   using OpConversionPattern<triton::PrintOp>::OpConversionPattern;
 
@@ -537,10 +589,13 @@ void populateTritonPatterns(TritonGPUTypeConverter &typeConverter,
           TritonGenericPattern<triton::PtrToIntOp>,
           TritonGenericPattern<triton::SplatOp>, TritonBroadcastPattern,
           TritonGenericPattern<triton::AddPtrOp>, TritonCatPattern,
-          TritonReducePattern, TritonReduceReturnPattern, TritonTransPattern,
+          TritonReducePattern, TritonReduceReturnPattern, TritonScanPattern,
+          TritonScanReturnPattern, TritonTransPattern,
           TritonExpandDimsPattern, TritonMakeRangePattern, TritonDotPattern,
-          TritonLoadPattern, TritonStorePattern, TritonExtElemwisePattern,
-          TritonPrintPattern, TritonAssertPattern, TritonAtomicRMWPattern>(
+          TritonLoadPattern, TritonStorePattern, TritonPrefetchPattern,
+          TritonGenericPattern<triton::DescriptorLoadOp>,
+          TritonExtElemwisePattern, TritonPrintPattern, TritonAssertPattern,
+          TritonAtomicRMWPattern>(
           typeConverter, context);
 }
 
@@ -775,13 +830,49 @@ class ConvertTritonToTritonGPU
 public:
   ConvertTritonToTritonGPU() = default;
   // constructor with some parameters set explicitly.
-  ConvertTritonToTritonGPU(int numWarps) { this->numWarps = numWarps; }
+  ConvertTritonToTritonGPU(int numWarps, int threadsPerWarp, int numCTAs) {
+    this->numWarps = numWarps;
+    this->threadsPerWarp = threadsPerWarp;
+    this->numCTAs = numCTAs;
+  }
+
+  // Starts the tensors of each shape accessed through pointers in the layout
+  // that coalesces the first of those accesses, so that they don't need to be
+  // converted to it later
+  LogicalResult setCoalescedEncodings(TritonGPUTypeConverter &typeConverter) {
+    ModuleOp mod = getOperation();
+    std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
+    AxisInfoAnalysis *axisInfo = solver->load<AxisInfoAnalysis>();
+    if (failed(solver->initializeAndRun(mod)))
+      return failure();
+    mod.walk([&](Operation *op) {
+      Value ptr;
+      if (auto load = dyn_cast<triton::LoadOp>(op))
+        ptr = load.getPtr();
+      else if (auto store = dyn_cast<triton::StoreOp>(op))
+        ptr = store.getPtr();
+      else if (auto rmw = dyn_cast<triton::AtomicRMWOp>(op))
+        ptr = rmw.getPtr();
+      else if (auto cas = dyn_cast<triton::AtomicCASOp>(op))
+        ptr = cas.getPtr();
+      auto ty = ptr ? ptr.getType().dyn_cast<RankedTensorType>() : nullptr;
+      if (!ty || !axisInfo->getLatticeElement(ptr))
+        return;
+      Attribute encoding = getCoalescedEncoding(&getContext(), *axisInfo, ptr,
+                                                numWarps, threadsPerWarp);
+      if (typeConverter.setShapeEncoding(ty.getShape(), encoding))
+        ++numCoalescedShapes;
+    });
+    return success();
+  }
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp mod = getOperation();
     // type converter
-    TritonGPUTypeConverter typeConverter(context, numWarps);
+    TritonGPUTypeConverter typeConverter(context, numWarps, threadsPerWarp);
+    if (failed(setCoalescedEncodings(typeConverter)))
+      return signalPassFailure();
     TritonGPUConversionTarget target(*context, typeConverter);
     // rewrite patterns
     RewritePatternSet patterns(context);
@@ -804,6 +895,13 @@ public:
     mod->setAttr(
         AttrNumWarpsName,
         IntegerAttr::get(i32_ty, llvm::APInt(32, numWarps.getValue())));
+    mod->setAttr(
+        AttrNumThreadsPerWarp,
+        IntegerAttr::get(i32_ty, llvm::APInt(32, threadsPerWarp.getValue())));
+    if (numCTAs > 1)
+      mod->setAttr(
+          AttrNumCTAsName,
+          IntegerAttr::get(i32_ty, llvm::APInt(32, numCTAs.getValue())));
 
     // update layouts
     //  broadcast src => multicast, dst => broadcasted
@@ -815,8 +913,11 @@ public:
 } // namespace
 
 std::unique_ptr<OperationPass<ModuleOp>>
-mlir::triton::createConvertTritonToTritonGPUPass(int numWarps) {
-  return std::make_unique<::ConvertTritonToTritonGPU>(numWarps);
+mlir::triton::createConvertTritonToTritonGPUPass(int numWarps,
+                                                 int threadsPerWarp,
+                                                 int numCTAs) {
+  return std::make_unique<::ConvertTritonToTritonGPU>(numWarps, threadsPerWarp,
+                                                      numCTAs);
 }
 
 std::unique_ptr<OperationPass<ModuleOp>>
@@ -3,7 +3,9 @@
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/FunctionImplementation.h"
 #include "mlir/IR/FunctionInterfaces.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/PatternMatch.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/IR/Types.h"
 
@@ -381,46 +383,48 @@ mlir::LogicalResult mlir::triton::ReduceOp::verify() {
   return success();
 }
 
-mlir::LogicalResult mlir::triton::ReduceOp::verifyRegions() {
-  auto argElementTypes = this->getElementTypes();
-  const auto &operands = this->getOperands();
-  const auto numArgs = 2 * operands.size();
-  auto &block = *this->getBody();
+// Verifies that the combine region of a reduce or scan takes the
+// accumulators then the combined elements, and returns the new accumulators.
+template <typename ReturnOp>
+static mlir::LogicalResult
+verifyCombineRegion(Operation *op, Block &block,
+                    ArrayRef<Type> argElementTypes) {
+  const auto numOperands = argElementTypes.size();
+  const auto numArgs = 2 * numOperands;
   if (block.getNumArguments() != numArgs) {
-    return this->emitOpError() << "nested block must take " << numArgs
-                               << " arguments, but given block with "
-                               << block.getNumArguments() << " arguments";
+    return op->emitOpError() << "nested block must take " << numArgs
+                             << " arguments, but given block with "
+                             << block.getNumArguments() << " arguments";
   }
-  unsigned i = 0;
   const auto &blockArgTypes = block.getArgumentTypes();
   for (unsigned i = 0; i < numArgs; ++i) {
     const auto &blockArgTy = blockArgTypes[i];
-    const auto &argElemTy = argElementTypes[i % operands.size()];
+    const auto &argElemTy = argElementTypes[i % numOperands];
     if (blockArgTy != argElemTy) {
-      return this->emitOpError()
+      return op->emitOpError()
              << "type mismatch on combine operation. Expected argument " << i
              << " to have type " << argElemTy << " but got " << blockArgTy;
     }
   }
 
-  auto terminator =
-      dyn_cast<mlir::triton::ReduceReturnOp>(block.getTerminator());
+  auto terminator = dyn_cast<ReturnOp>(block.getTerminator());
   if (!terminator) {
-    return this->emitOpError()
+    return op->emitOpError()
            << "combine operation must be terminated "
-           << "with a ReduceReturnOp but got " << block.getTerminator();
+           << "with a " << ReturnOp::getOperationName() << " but got "
+           << block.getTerminator();
   }
   const auto &combineResults = terminator->getOperands();
-  if (combineResults.size() != operands.size()) {
-    return this->emitOpError()
-           << "expected combine operation to return " << operands.size()
+  if (combineResults.size() != numOperands) {
+    return op->emitOpError()
+           << "expected combine operation to return " << numOperands
            << " values but got " << combineResults.size();
   }
   for (unsigned i = 0; i < combineResults.size(); ++i) {
     const auto &resultTy = combineResults[i].getType();
     const auto &argElemTy = argElementTypes[i];
     if (resultTy != argElemTy) {
-      return this->emitOpError()
+      return op->emitOpError()
              << "type mismatch on combine operation. Expected argument " << i
              << " to have type " << argElemTy << " but got " << resultTy;
     }
@@ -428,6 +432,11 @@ mlir::LogicalResult mlir::triton::ReduceOp::verifyRegions() {
   return mlir::success();
 }
 
+mlir::LogicalResult mlir::triton::ReduceOp::verifyRegions() {
+  return verifyCombineRegion<ReduceReturnOp>(*this, *this->getBody(),
+                                             this->getElementTypes());
+}
+
 llvm::SmallVector<mlir::RankedTensorType> ReduceOp::getInputTypes() {
   llvm::SmallVector<RankedTensorType> srcTys;
   srcTys.reserve(this->getNumOperands());
@@ -449,6 +458,69 @@ llvm::SmallVector<Type> ReduceOp::getElementTypes() {
 
 unsigned ReduceOp::getNumOperands() { return this->getOperands().size(); }
 
+//-- ScanOp --
+void ScanOp::build(mlir::OpBuilder &builder, mlir::OperationState &state,
+                   mlir::ValueRange operands, int axis) {
+  SmallVector<Type> inferredReturnTypes;
+  for (auto arg : operands)
+    inferredReturnTypes.push_back(arg.getType());
+  ScanOp::build(builder, state, inferredReturnTypes, operands, axis);
+}
+
+mlir::LogicalResult mlir::triton::ScanOp::inferReturnTypes(
+    MLIRContext *context, std::optional<Location> location, ValueRange operands,
+    DictionaryAttr attributes, RegionRange regions,
+    SmallVectorImpl<Type> &inferredReturnTypes) {
+  // each result has the type of its operand
+  for (auto arg : operands)
+    inferredReturnTypes.push_back(arg.getType());
+  return success();
+}
+
+mlir::LogicalResult mlir::triton::ScanOp::verify() {
+  if (this->getOperands().size() < 1) {
+    return this->emitOpError() << "must have at least 1 operand";
+  }
+  for (const auto &operand : this->getOperands()) {
+    auto type = operand.getType().dyn_cast<RankedTensorType>();
+    if (!type) {
+      return this->emitOpError() << "operands must be RankedTensorType";
+    }
+    if (static_cast<int64_t>(this->getAxis()) >= type.getRank()) {
+      return this->emitOpError()
+             << "axis " << this->getAxis() << " is out of range for rank "
+             << type.getRank();
+    }
+  }
+  return success();
+}
+
+mlir::LogicalResult mlir::triton::ScanOp::verifyRegions() {
+  return verifyCombineRegion<ScanReturnOp>(*this, *this->getBody(),
+                                           this->getElementTypes());
+}
+
+llvm::SmallVector<mlir::RankedTensorType> ScanOp::getInputTypes() {
+  llvm::SmallVector<RankedTensorType> srcTys;
+  srcTys.reserve(this->getNumOperands());
+  for (const auto &ty : this->getOperands().getTypes()) {
+    srcTys.push_back(ty.cast<RankedTensorType>());
+  }
+  return srcTys;
+}
+
+llvm::SmallVector<Type> ScanOp::getElementTypes() {
+  llvm::SmallVector<Type> srcElemTys;
+  srcElemTys.reserve(this->getNumOperands());
+  for (const auto &op : this->getOperands()) {
+    srcElemTys.push_back(
+        op.getType().cast<RankedTensorType>().getElementType());
+  }
+  return srcElemTys;
+}
+
+unsigned ScanOp::getNumOperands() { return this->getOperands().size(); }
+
 //-- SplatOp --
 OpFoldResult SplatOp::fold(ArrayRef<Attribute> operands) {
   auto constOperand = getSrc().getDefiningOp<arith::ConstantOp>();
@@ -587,6 +659,102 @@ OpFoldResult BroadcastOp::fold(ArrayRef<Attribute> operands) {
   }
 }
 
+//-- Elementwise ops of broadcast and expanded operands --
+static bool isSameExpansion(BroadcastOp op, BroadcastOp other) {
+  auto srcType = op.getSrc().getType().cast<RankedTensorType>();
+  auto otherSrcType = other.getSrc().getType().cast<RankedTensorType>();
+  return srcType.getShape() == otherSrcType.getShape() &&
+         srcType.getEncoding() == otherSrcType.getEncoding();
+}
+
+static bool isSameExpansion(ExpandDimsOp op, ExpandDimsOp other) {
+  auto srcType = op.getSrc().getType().cast<RankedTensorType>();
+  auto otherSrcType = other.getSrc().getType().cast<RankedTensorType>();
+  return op.getAxis() == other.getAxis() &&
+         srcType.getShape() == otherSrcType.getShape() &&
+         srcType.getEncoding() == otherSrcType.getEncoding();
+}
+
+// elementwise(X(a), X(b), splat(s), constant) ->
+//   X(elementwise(a, b, splat'(s), constant'))
+// where X is a broadcast or an expand_dims of the same source shape, so that
+// the elementwise op is computed on the smaller tensor. Chains such as
+// addi(broadcast(expand_dims(make_range)), splat) sink one level at a time,
+// down to addi(make_range, splat).
+template <typename OpType>
+struct SinkBelowElementwise : public RewritePattern {
+  SinkBelowElementwise(MLIRContext *context)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context) {}
+
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    if (!op->hasTrait<OpTrait::Elementwise>() || op->getNumResults() != 1 ||
+        op->getNumRegions() != 0 || !isMemoryEffectFree(op))
+      return failure();
+    auto resType = op->getResult(0).getType().dyn_cast<RankedTensorType>();
+    if (!resType)
+      return failure();
+
+    OpType expansion;
+    for (Value operand : op->getOperands()) {
+      SplatElementsAttr value;
+      if (auto other = operand.getDefiningOp<OpType>()) {
+        // broadcasts of scalars are splats in all but name
+        if (!other.getSrc().getType().template isa<RankedTensorType>())
+          return failure();
+        if (!expansion)
+          expansion = other;
+        else if (!isSameExpansion(expansion, other))
+          return failure();
+      } else if (!operand.getType().isa<RankedTensorType>() ||
+                 !(operand.getDefiningOp<SplatOp>() ||
+                   matchPattern(operand, m_Constant(&value)))) {
+        return failure();
+      }
+    }
+    if (!expansion || expansion.getType()
+                              .template cast<RankedTensorType>()
+                              .getEncoding() != resType.getEncoding())
+      return failure();
+
+    auto srcType =
+        expansion.getSrc().getType().template cast<RankedTensorType>();
+    auto getNarrowType = [&](Type type) {
+      return RankedTensorType::get(
+          srcType.getShape(), type.cast<RankedTensorType>().getElementType(),
+          srcType.getEncoding());
+    };
+    Location loc = op->getLoc();
+    SmallVector<Value> operands;
+    for (Value operand : op->getOperands()) {
+      SplatElementsAttr value;
+      if (auto other = operand.getDefiningOp<OpType>())
+        operands.push_back(other.getSrc());
+      else if (auto splat = operand.getDefiningOp<SplatOp>())
+        operands.push_back(rewriter.create<SplatOp>(
+            loc, getNarrowType(operand.getType()), splat.getSrc()));
+      else if (matchPattern(operand, m_Constant(&value))) {
+        auto narrowType = getNarrowType(operand.getType());
+        operands.push_back(rewriter.create<arith::ConstantOp>(
+            loc, narrowType, value.resizeSplat(narrowType)));
+      }
+    }
+    Operation *narrowOp =
+        rewriter.create(loc, op->getName().getIdentifier(), operands,
+                        {getNarrowType(resType)}, op->getAttrs());
+    rewriter.replaceOpWithNewOp<OpType>(op, TypeRange{resType},
+                                        narrowOp->getResults(),
+                                        expansion->getAttrs());
+    return success();
+  }
+};
+
+void TritonDialect::getCanonicalizationPatterns(
+    RewritePatternSet &results) const {
+  results.add<SinkBelowElementwise<BroadcastOp>,
+              SinkBelowElementwise<ExpandDimsOp>>(getContext());
+}
+
 //-- MakeTensorPtrOp --
 void MakeTensorPtrOp::build(::mlir::OpBuilder &builder,
                             ::mlir::OperationState &state, ::mlir::Value base,
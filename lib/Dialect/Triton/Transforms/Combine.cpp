@@ -1,6 +1,7 @@
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -101,6 +102,121 @@ public:
   }
 };
 
+// Returns the mask of the elements that select(cond, ...) picks from its true
+// value, splatting a scalar cond to the shape of the selected values
+static Value getSelectMask(arith::SelectOp selectOp,
+                           PatternRewriter &rewriter) {
+  Value cond = selectOp.getCondition();
+  auto type = selectOp.getType().dyn_cast<RankedTensorType>();
+  if (!type || cond.getType().isa<RankedTensorType>())
+    return cond;
+  return rewriter.create<triton::SplatOp>(
+      selectOp.getLoc(),
+      RankedTensorType::get(type.getShape(), cond.getType(),
+                            type.getEncoding()),
+      cond);
+}
+
+// Whether `value` is defined before `op` in a block that contains it
+static bool isDefinedBefore(Value value, Operation *op) {
+  Block *block = value.getParentBlock();
+  Operation *ancestor = block->findAncestorOpInBlock(*op);
+  if (!ancestor)
+    return false;
+  Operation *def = value.getDefiningOp();
+  return !def || def->isBeforeInBlock(ancestor);
+}
+
+// Whether no op between `from` and `to`, two ops of the same block, may write
+// to memory
+static bool noWritesBetween(Operation *from, Operation *to) {
+  if (from->getBlock() != to->getBlock() || !from->isBeforeInBlock(to))
+    return false;
+  for (Operation *op = from->getNextNode(); op != to; op = op->getNextNode()) {
+    if (isMemoryEffectFree(op))
+      continue;
+    auto iface = dyn_cast<MemoryEffectOpInterface>(op);
+    if (!iface || !iface.onlyHasEffect<MemoryEffects::Read>())
+      return false;
+  }
+  return true;
+}
+
+// select(cond, load(ptrs), other) => load(ptrs, cond, other)
+// when the load has no mask and no other use, so that it is predicated on
+// cond rather than reading the lanes that are thrown away. The load stays
+// where it is, which needs cond and other to be available there; constant
+// others are rematerialized before it.
+struct CombineSelectUnmaskedLoadPattern
+    : public mlir::OpRewritePattern<arith::SelectOp> {
+  CombineSelectUnmaskedLoadPattern(mlir::MLIRContext *context)
+      : OpRewritePattern<arith::SelectOp>(context, 2) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(arith::SelectOp selectOp,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto loadOp = selectOp.getTrueValue().getDefiningOp<triton::LoadOp>();
+    if (!loadOp || loadOp.getMask() || loadOp.getIsVolatile() ||
+        loadOp.getBoundaryCheck() || !loadOp->hasOneUse() ||
+        triton::isTensorPointerType(loadOp.getPtr().getType()))
+      return mlir::failure();
+    Value cond = selectOp.getCondition();
+    Value other = selectOp.getFalseValue();
+    if (!isDefinedBefore(cond, loadOp))
+      return mlir::failure();
+    Operation *otherDef = other.getDefiningOp();
+    bool rematerializeOther = !isDefinedBefore(other, loadOp);
+    if (rematerializeOther &&
+        !(otherDef && matchPattern(otherDef, m_Constant())))
+      return mlir::failure();
+
+    rewriter.setInsertionPoint(loadOp);
+    if (rematerializeOther)
+      other = rewriter.clone(*otherDef)->getResult(0);
+    Value mask = getSelectMask(selectOp, rewriter);
+    auto newLoad = rewriter.create<triton::LoadOp>(
+        loadOp.getLoc(), loadOp.getPtr(), mask, other, loadOp.getCache(),
+        loadOp.getEvict(), loadOp.getIsVolatile());
+    rewriter.replaceOp(selectOp, newLoad.getResult());
+    rewriter.eraseOp(loadOp);
+    return mlir::success();
+  }
+};
+
+// store(ptrs, select(cond, value, load(ptrs)), mask)
+//   => store(ptrs, value, mask & cond)
+// when nothing writes to memory between the load and the store, i.e. the
+// lanes that are not selected would store back what they loaded
+struct CombineSelectStorePattern
+    : public mlir::OpRewritePattern<triton::StoreOp> {
+  CombineSelectStorePattern(mlir::MLIRContext *context)
+      : OpRewritePattern<triton::StoreOp>(context, 2) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(triton::StoreOp storeOp,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto selectOp = storeOp.getValue().getDefiningOp<arith::SelectOp>();
+    if (!selectOp || storeOp.getBoundaryCheck())
+      return mlir::failure();
+    auto loadOp = selectOp.getFalseValue().getDefiningOp<triton::LoadOp>();
+    // the lanes that the store writes and the load masks off would store the
+    // other of the load
+    if (!loadOp || loadOp.getPtr() != storeOp.getPtr() ||
+        (loadOp.getMask() && loadOp.getMask() != storeOp.getMask()) ||
+        loadOp.getIsVolatile() || !noWritesBetween(loadOp, storeOp))
+      return mlir::failure();
+
+    rewriter.setInsertionPoint(storeOp);
+    Value mask = getSelectMask(selectOp, rewriter);
+    if (Value storeMask = storeOp.getMask())
+      mask = rewriter.create<arith::AndIOp>(storeOp.getLoc(), storeMask, mask);
+    rewriter.replaceOpWithNewOp<triton::StoreOp>(
+        storeOp, storeOp.getPtr(), selectOp.getTrueValue(), mask,
+        storeOp.getCache(), storeOp.getEvict());
+    return mlir::success();
+  }
+};
+
 // load(ptr, splat(1), ...)        -> load(ptr, ...)
 // load(ptr, splat(0), other, ...) -> other
 struct CanonicalizeMaskedLoadPattern
@@ -207,6 +323,8 @@ public:
     patterns.add<CombineDotAddFRevPattern>(context);
     // %}
     patterns.add<CombineSelectMaskedLoadPattern>(context);
+    patterns.add<CombineSelectUnmaskedLoadPattern>(context);
+    patterns.add<CombineSelectStorePattern>(context);
     // patterns.add<CombineAddPtrPattern>(context);
     patterns.add<CombineBroadcastConstantPattern>(context);
 
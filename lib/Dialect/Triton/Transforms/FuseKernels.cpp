@@ -0,0 +1,148 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+/// Returns whether `func` or the functions it calls read the program ids or
+/// counts of the kernel they run in, which only the kernel's own body can be
+/// remapped for.
+bool readsProgramIds(triton::FuncOp func, ModuleOp mod,
+                     DenseSet<Operation *> &visited) {
+  if (!visited.insert(func).second)
+    return false;
+  auto result = func.walk([&](Operation *op) {
+    if (isa<triton::GetProgramIdOp, triton::GetNumProgramsOp>(op))
+      return WalkResult::interrupt();
+    if (auto call = dyn_cast<triton::CallOp>(op)) {
+      auto callee = mod.lookupSymbol<triton::FuncOp>(call.getCallee());
+      if (callee && readsProgramIds(callee, mod, visited))
+        return WalkResult::interrupt();
+    }
+    return WalkResult::advance();
+  });
+  return result.wasInterrupted();
+}
+
+class FuseKernelsPass : public TritonFuseKernelsBase<FuseKernelsPass> {
+public:
+  FuseKernelsPass() = default;
+  FuseKernelsPass(StringRef name) { this->fusedName = name.str(); }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    SmallVector<triton::FuncOp> kernels;
+    for (auto func : mod.getOps<triton::FuncOp>())
+      if (func.isPublic())
+        kernels.push_back(func);
+    if (kernels.empty())
+      return;
+
+    for (auto kernel : kernels) {
+      if (!kernel.getBody().hasOneBlock() || kernel.getNumResults() != 0) {
+        kernel.emitError("only kernels of a single block without results "
+                         "can be fused");
+        return signalPassFailure();
+      }
+      DenseSet<Operation *> visited;
+      visited.insert(kernel);
+      auto calls = kernel.walk([&](triton::CallOp call) {
+        auto callee = mod.lookupSymbol<triton::FuncOp>(call.getCallee());
+        if (callee && readsProgramIds(callee, mod, visited))
+          return WalkResult::interrupt();
+        return WalkResult::advance();
+      });
+      if (calls.wasInterrupted()) {
+        kernel.emitError("kernels calling functions that read program ids "
+                         "cannot be fused");
+        return signalPassFailure();
+      }
+    }
+
+    createFusedKernel(mod, kernels);
+    for (auto kernel : kernels)
+      kernel.erase();
+  }
+
+private:
+  /// Creates the kernel taking the arguments of `kernels`, then the number of
+  /// programs of each of them, which runs the body of each kernel in the
+  /// range of its programs along axis 0. Their own program ids and counts are
+  /// those of their range, along a grid of a single dimension.
+  void createFusedKernel(ModuleOp mod, ArrayRef<triton::FuncOp> kernels) {
+    auto loc = kernels.front().getLoc();
+    OpBuilder builder(mod.getBodyRegion());
+    auto i32Ty = builder.getI32Type();
+
+    SmallVector<Type> argTypes;
+    SmallVector<DictionaryAttr> argAttrs;
+    for (auto kernel : kernels) {
+      llvm::append_range(argTypes, kernel.getArgumentTypes());
+      kernel.getAllArgAttrs(argAttrs);
+    }
+    unsigned numKernelArgs = argTypes.size();
+    argTypes.append(kernels.size(), i32Ty);
+    argAttrs.append(kernels.size(), builder.getDictionaryAttr({}));
+
+    // The fused kernel goes first, as the one the module is launched by
+    builder.setInsertionPointToStart(mod.getBody());
+    auto fused = builder.create<triton::FuncOp>(
+        loc, fusedName, builder.getFunctionType(argTypes, {}));
+    fused.setAllArgAttrs(argAttrs);
+    Block *entry = fused.addEntryBlock();
+    builder.setInsertionPointToStart(entry);
+
+    Value pid = builder.create<triton::GetProgramIdOp>(
+        loc, i32Ty, builder.getI32IntegerAttr(0));
+    Value start = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+    unsigned argIdx = 0;
+    for (auto [i, kernel] : llvm::enumerate(kernels)) {
+      Value programs = entry->getArgument(numKernelArgs + i);
+      Value end = builder.create<arith::AddIOp>(loc, start, programs);
+      Value afterStart = builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::sge, pid, start);
+      Value beforeEnd = builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::slt, pid, end);
+      Value inRange =
+          builder.create<arith::AndIOp>(loc, afterStart, beforeEnd);
+      auto ifOp = builder.create<scf::IfOp>(loc, inRange,
+                                            /*withElseRegion=*/false);
+
+      OpBuilder body = ifOp.getThenBodyBuilder();
+      Value localPid = body.create<arith::SubIOp>(loc, pid, start);
+      Value zero = body.create<arith::ConstantIntOp>(loc, 0, 32);
+      Value one = body.create<arith::ConstantIntOp>(loc, 1, 32);
+      IRMapping mapping;
+      for (auto arg : kernel.getArguments())
+        mapping.map(arg, entry->getArgument(argIdx++));
+      for (Operation &op : kernel.getBody().front().without_terminator())
+        body.clone(op, mapping);
+
+      ifOp.getThenRegion().walk([&](Operation *op) {
+        if (auto getPid = dyn_cast<triton::GetProgramIdOp>(op)) {
+          getPid.replaceAllUsesWith(getPid.getAxis() == 0 ? localPid : zero);
+          getPid.erase();
+        } else if (auto getNum = dyn_cast<triton::GetNumProgramsOp>(op)) {
+          getNum.replaceAllUsesWith(getNum.getAxis() == 0 ? programs : one);
+          getNum.erase();
+        }
+      });
+      start = end;
+    }
+    builder.create<triton::ReturnOp>(loc);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> mlir::triton::createFuseKernelsPass(StringRef name) {
+  return std::make_unique<FuseKernelsPass>(name);
+}
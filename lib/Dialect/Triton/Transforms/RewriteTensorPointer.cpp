@@ -1,4 +1,5 @@
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/Pass/Pass.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/Transforms/Passes.h"
@@ -15,6 +16,7 @@ using namespace mlir;
 /// with tensor pointers
 struct RewritedInfo {
 private:
+  triton::MakeTensorPtrOp makeTensorPtrOp;
   Value base;
   SmallVector<Value> shape;
   SmallVector<Value> strides;
@@ -29,18 +31,23 @@ public:
 
   RewritedInfo(const RewritedInfo &other) = default;
 
-  RewritedInfo(Value base, const SmallVector<Value> &shape,
+  RewritedInfo(triton::MakeTensorPtrOp makeTensorPtrOp, Value base,
+               const SmallVector<Value> &shape,
                const SmallVector<Value> &strides,
                const SmallVector<Value> &offsets,
                const ArrayRef<int64_t> &tensorShape)
-      : base(base), shape(shape), strides(strides), offsets(offsets),
-        tensorShape(tensorShape) {
+      : makeTensorPtrOp(makeTensorPtrOp), base(base), shape(shape),
+        strides(strides), offsets(offsets), tensorShape(tensorShape) {
     assert(shape.size() == strides.size() && shape.size() == offsets.size() &&
            shape.size() == tensorShape.size());
   }
 
   unsigned int length() const { return shape.size(); }
 
+  triton::MakeTensorPtrOp getMakeTensorPtrOp() const {
+    return makeTensorPtrOp;
+  }
+
   Value getOffset(unsigned i) { return offsets[i]; }
 
   SmallVector<Value> getOffsets() { return offsets; }
@@ -186,11 +193,118 @@ public:
   }
 };
 
+/// Returns the index of the kernel argument `v` is, or is extended from, or
+/// -1 and the value of `v` if it is a constant. The launcher of the kernel
+/// builds tensor maps from those.
+static std::optional<std::pair<int64_t, int64_t>>
+getArgOrConstant(triton::FuncOp funcOp, Value v) {
+  while (auto extOp = v.getDefiningOp<arith::ExtSIOp>())
+    v = extOp.getIn();
+  APInt value;
+  if (matchPattern(v, m_ConstantInt(&value)))
+    return std::make_pair(int64_t(-1), value.getSExtValue());
+  auto arg = v.dyn_cast<BlockArgument>();
+  if (!arg || arg.getOwner() != &funcOp.getBody().front())
+    return std::nullopt;
+  return std::make_pair(int64_t(arg.getArgNumber()), int64_t(0));
+}
+
+static bool isArgDivisibleBy16(triton::FuncOp funcOp, int64_t argIdx) {
+  auto divisibility =
+      funcOp.getArgAttrOfType<IntegerAttr>(argIdx, "tt.divisibility");
+  return divisibility && divisibility.getInt() % 16 == 0;
+}
+
+/// Returns the tensor map the blocks of `op` can be copied with by the tensor
+/// memory accelerator, or nullptr. The launcher builds it from the global
+/// address, shape and strides of the tensor, which must be kernel arguments
+/// or constants, with the address and the outer strides 16-byte aligned:
+///   base: the argument of the address
+///   shape, strides: the arguments of each dimension, or -1 for constants
+///   shape_values, stride_values: the constants
+///   box: the shape of the block
+///   elem: the element type
+static DictionaryAttr getTensorMapAttr(triton::MakeTensorPtrOp op) {
+  auto funcOp = op->getParentOfType<triton::FuncOp>();
+  if (!funcOp || !funcOp.isPublic())
+    return {};
+
+  // Only row-major 2D blocks, whose copies are pipelined, are supported
+  auto tensorType = op.getResult()
+                        .getType()
+                        .cast<triton::PointerType>()
+                        .getPointeeType()
+                        .cast<RankedTensorType>();
+  if (tensorType.getRank() != 2 || op.getOrder() != ArrayRef<int32_t>{1, 0})
+    return {};
+  auto elemType = tensorType.getElementType();
+  if (!elemType.isIntOrFloat())
+    return {};
+  unsigned bitWidth = elemType.getIntOrFloatBitWidth();
+  if (bitWidth < 8 || !llvm::isPowerOf2_32(bitWidth))
+    return {};
+  int64_t elemBytes = bitWidth / 8;
+
+  // A box is at most 256 elements along each dimension, and its rows are
+  // multiples of 16 bytes
+  auto box = tensorType.getShape();
+  if (llvm::any_of(box, [](int64_t dim) { return dim > 256; }) ||
+      box.back() * elemBytes % 16 != 0)
+    return {};
+
+  auto base = getArgOrConstant(funcOp, op.getBase());
+  if (!base || base->first < 0 || !isArgDivisibleBy16(funcOp, base->first))
+    return {};
+
+  SmallVector<int64_t> shapeArgs, shapeValues;
+  for (Value dim : op.getShape()) {
+    auto argOrConstant = getArgOrConstant(funcOp, dim);
+    if (!argOrConstant)
+      return {};
+    shapeArgs.push_back(argOrConstant->first);
+    shapeValues.push_back(argOrConstant->second);
+  }
+
+  SmallVector<int64_t> strideArgs, strideValues;
+  for (auto [i, stride] : llvm::enumerate(op.getStrides())) {
+    auto argOrConstant = getArgOrConstant(funcOp, stride);
+    if (!argOrConstant)
+      return {};
+    auto [arg, value] = *argOrConstant;
+    // The innermost dimension is contiguous
+    if (i + 1 == op.getStrides().size()) {
+      if (arg >= 0 || value != 1)
+        return {};
+    } else if (arg >= 0 ? !isArgDivisibleBy16(funcOp, arg)
+                        : value * elemBytes % 16 != 0) {
+      return {};
+    }
+    strideArgs.push_back(arg);
+    strideValues.push_back(value);
+  }
+
+  Builder builder(op.getContext());
+  SmallVector<int32_t> boxDims(box.begin(), box.end());
+  return builder.getDictionaryAttr(
+      {builder.getNamedAttr("base", builder.getI32IntegerAttr(base->first)),
+       builder.getNamedAttr("box", builder.getDenseI32ArrayAttr(boxDims)),
+       builder.getNamedAttr("elem", TypeAttr::get(elemType)),
+       builder.getNamedAttr("shape", builder.getDenseI64ArrayAttr(shapeArgs)),
+       builder.getNamedAttr("shape_values",
+                            builder.getDenseI64ArrayAttr(shapeValues)),
+       builder.getNamedAttr("strides",
+                            builder.getDenseI64ArrayAttr(strideArgs)),
+       builder.getNamedAttr("stride_values",
+                            builder.getDenseI64ArrayAttr(strideValues))});
+}
+
 class RewriteTensorPointerPass
     : public TritonRewriteTensorPointerBase<RewriteTensorPointerPass> {
 private:
   int computeCapability;
   DenseMap<Value, RewritedInfo> rewritedInfo;
+  // make_tensor_ptr => the descriptor its blocks are loaded through
+  DenseMap<Operation *, Value> descriptors;
 
 public:
   explicit RewriteTensorPointerPass(int computeCapability)
@@ -217,6 +331,36 @@ public:
     return newOperands;
   }
 
+  /// Returns the descriptor `loadOp` loads its block through on devices with
+  /// tensor memory access copies, or nullptr if it is loaded as a tensor of
+  /// pointers. The descriptor is added as an argument of the kernel for the
+  /// first load of each block pointer.
+  Value getDescriptor(triton::LoadOp loadOp, const RewritedInfo &info) {
+    // Out of bounds elements are filled with zeros
+    if (computeCapability < 90 || loadOp.getIsVolatile() ||
+        loadOp.getPadding() == triton::PaddingOption::PAD_NAN)
+      return {};
+
+    Operation *makeTensorPtrOp = info.getMakeTensorPtrOp();
+    auto it = descriptors.find(makeTensorPtrOp);
+    if (it != descriptors.end())
+      return it->second;
+
+    Value desc;
+    if (auto tensorMap = getTensorMapAttr(info.getMakeTensorPtrOp())) {
+      auto funcOp = makeTensorPtrOp->getParentOfType<triton::FuncOp>();
+      Builder builder(funcOp.getContext());
+      unsigned argIdx = funcOp.getNumArguments();
+      funcOp.insertArgument(
+          argIdx, triton::PointerType::get(builder.getI8Type(), 1),
+          builder.getDictionaryAttr(
+              builder.getNamedAttr("tt.tensormap", tensorMap)),
+          funcOp.getLoc());
+      desc = funcOp.getArgument(argIdx);
+    }
+    return descriptors[makeTensorPtrOp] = desc;
+  }
+
   Operation *rewriteMakeTensorPtrOp(OpBuilder &builder,
                                     triton::MakeTensorPtrOp op,
                                     std::stack<Operation *> &eraser) {
@@ -234,8 +378,8 @@ public:
 
     // Save information
     rewritedInfo[op.getResult()] =
-        RewritedInfo(op.getBase(), op.getShape(), op.getStrides(), i64Offsets,
-                     tensorType.getShape());
+        RewritedInfo(op, op.getBase(), op.getShape(), op.getStrides(),
+                     i64Offsets, tensorType.getShape());
 
     // Erase the original operation
     eraser.push(op);
@@ -281,6 +425,21 @@ public:
     assert(rewritedInfo.count(ptr));
     auto info = rewritedInfo[ptr];
 
+    // Loads through descriptors are bounds-checked by the copy
+    if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
+      if (Value desc = getDescriptor(loadOp, info)) {
+        SmallVector<Value> indices;
+        for (Value offset : info.getOffsets())
+          indices.push_back(builder.create<arith::TruncIOp>(
+              loadOp.getLoc(), builder.getI32Type(), offset));
+        auto newResult = builder.create<triton::DescriptorLoadOp>(
+            loadOp.getLoc(), loadOp.getType(), desc, indices);
+        op->getResult(0).replaceAllUsesWith(newResult);
+        eraser.push(op);
+        return nullptr;
+      }
+    }
+
     // Load/store with tensor pointers implicitly will check the bound while
     // accessing memory, so we should set `mask` and `other` (according to the
     // padding). Also note that load with tensor pointers do not have `mask` and
@@ -469,10 +628,6 @@ public:
   }
 
   void runOnOperation() override {
-    // Only rewrite if the hardware does not support
-    if (computeCapability >= 90)
-      return;
-
     // NOTES(Chenggang): we don't use `ConversionPatternRewriter`, because
     // MLIR does not support one-multiple value mapping. For example, if we use
     // `ConversionPatternRewriter`, we can not make a type converter, which
@@ -490,6 +645,7 @@ public:
     // The operation could not be erased during visit, because they may have
     // later usages, so we erase after visit
     rewritedInfo.clear();
+    descriptors.clear();
     while (!eraser.empty()) {
       auto op = eraser.top();
       eraser.pop();
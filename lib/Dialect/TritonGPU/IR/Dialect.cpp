@@ -18,6 +18,40 @@ namespace triton {
 
 namespace gpu {
 
+SmallVector<unsigned>
+LayoutInfoCache::getOrCompute(Attribute layout, Kind kind,
+                              function_ref<SmallVector<unsigned>()> compute) {
+  auto key = std::make_pair(layout, static_cast<unsigned>(kind));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = facts.find(key);
+    if (it != facts.end())
+      return it->second;
+  }
+  auto fact = compute();
+  std::lock_guard<std::mutex> lock(mutex);
+  facts.try_emplace(key, fact);
+  return fact;
+}
+
+unsigned LayoutInfoCache::getOrCompute(Type type,
+                                       function_ref<unsigned()> compute) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = elemsPerThread.find(type);
+    if (it != elemsPerThread.end())
+      return it->second;
+  }
+  unsigned elems = compute();
+  std::lock_guard<std::mutex> lock(mutex);
+  elemsPerThread.try_emplace(type, elems);
+  return elems;
+}
+
+LayoutInfoCache &getLayoutInfoCache(MLIRContext *context) {
+  return context->getLoadedDialect<TritonGPUDialect>()->getLayoutInfoCache();
+}
+
 // TODO: Inheritance of layout attributes
 // so that all distributed layouts implement
 // these utilities
@@ -30,6 +64,8 @@ unsigned getElemsPerThread(Attribute layout, ArrayRef<int64_t> shape,
     return sliceLayout.getElemsPerThread(shape, eltTy);
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
     return mmaLayout.getElemsPerThread(shape, eltTy);
+  } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    return mfmaLayout.getElemsPerThread(shape, eltTy);
   } else if (auto sharedLayout = layout.dyn_cast<SharedEncodingAttr>()) {
     return sharedLayout.getElemsPerThread(shape, eltTy);
   } else if (auto dotLayout = layout.dyn_cast<DotOperandEncodingAttr>()) {
@@ -44,11 +80,15 @@ unsigned getElemsPerThread(Type type) {
   if (type.isIntOrIndexOrFloat() || type.isa<triton::PointerType>())
     return 1;
   auto tensorType = type.cast<RankedTensorType>();
-  return getElemsPerThread(tensorType.getEncoding(), tensorType.getShape(),
-                           tensorType.getElementType());
+  return getLayoutInfoCache(type.getContext())
+      .getOrCompute(type, [&] {
+        return getElemsPerThread(tensorType.getEncoding(),
+                                 tensorType.getShape(),
+                                 tensorType.getElementType());
+      });
 }
 
-SmallVector<unsigned> getThreadsPerWarp(Attribute layout) {
+static SmallVector<unsigned> computeThreadsPerWarp(Attribute layout) {
   if (auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>()) {
     return SmallVector<unsigned>(blockedLayout.getThreadsPerWarp().begin(),
                                  blockedLayout.getThreadsPerWarp().end());
@@ -56,14 +96,17 @@ SmallVector<unsigned> getThreadsPerWarp(Attribute layout) {
   if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
     if (mmaLayout.isVolta())
       return {4, 8};
-    if (mmaLayout.isAmpere())
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper())
       return {8, 4};
   }
+  if (layout.isa<MfmaEncodingAttr>())
+    return {MfmaEncodingAttr::kWavefrontSize / MfmaEncodingAttr::kNonKDim,
+            MfmaEncodingAttr::kNonKDim};
   assert(0 && "getThreadsPerWarp not implemented");
   return {};
 }
 
-SmallVector<unsigned> getWarpsPerCTA(Attribute layout) {
+static SmallVector<unsigned> computeWarpsPerCTA(Attribute layout) {
   if (auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>()) {
     return SmallVector<unsigned>(blockedLayout.getWarpsPerCTA().begin(),
                                  blockedLayout.getWarpsPerCTA().end());
@@ -72,11 +115,15 @@ SmallVector<unsigned> getWarpsPerCTA(Attribute layout) {
     return SmallVector<unsigned>(mmaLayout.getWarpsPerCTA().begin(),
                                  mmaLayout.getWarpsPerCTA().end());
   }
+  if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    return SmallVector<unsigned>(mfmaLayout.getWarpsPerCTA().begin(),
+                                 mfmaLayout.getWarpsPerCTA().end());
+  }
   assert(0 && "getWarpsPerCTA not implemented");
   return {};
 }
 
-SmallVector<unsigned> getSizePerThread(Attribute layout) {
+static SmallVector<unsigned> computeSizePerThread(Attribute layout) {
   if (auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>()) {
     return SmallVector<unsigned>(blockedLayout.getSizePerThread().begin(),
                                  blockedLayout.getSizePerThread().end());
@@ -86,13 +133,17 @@ SmallVector<unsigned> getSizePerThread(Attribute layout) {
     // ret.erase(ret.begin() + sliceLayout.getDim());
     return ret;
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere()) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       return {2, 2};
     } else if (mmaLayout.isVolta()) {
       return {1, 2};
     } else {
       llvm_unreachable("Unexpected mma version");
     }
+  } else if (layout.isa<MfmaEncodingAttr>()) {
+    return {MfmaEncodingAttr::kNonKDim * MfmaEncodingAttr::kNonKDim /
+                MfmaEncodingAttr::kWavefrontSize,
+            1};
   } else if (auto dotLayout = layout.dyn_cast<DotOperandEncodingAttr>()) {
     auto parentLayout = dotLayout.getParent();
     assert(parentLayout && "DotOperandEncodingAttr must have a parent");
@@ -109,6 +160,11 @@ SmallVector<unsigned> getSizePerThread(Attribute layout) {
         assert(0 && "DotOperandEncodingAttr opIdx must be 0 or 1");
         return {};
       }
+    } else if (parentLayout.isa<MfmaEncodingAttr>()) {
+      // kWidth consecutive elements along K, see DotOperandEncodingAttr
+      if (dotLayout.getOpIdx() == 0)
+        return {1, 4};
+      return {4, 1};
     } else {
       assert(0 && "DotOperandEncodingAttr non-MmaEncodingAttr parent not "
                   "supported yet");
@@ -120,27 +176,35 @@ SmallVector<unsigned> getSizePerThread(Attribute layout) {
   }
 }
 
-SmallVector<unsigned> getContigPerThread(Attribute layout) {
+static SmallVector<unsigned> computeContigPerThread(Attribute layout) {
   if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    assert(mmaLayout.isVolta() || mmaLayout.isAmpere());
+    assert(mmaLayout.isVolta() || mmaLayout.isAmpere() ||
+           mmaLayout.isHopper());
     return {1, 2};
+  } else if (layout.isa<MfmaEncodingAttr>()) {
+    // rows 4i to 4i + 3 of a block are held by the same lane
+    return {4, 1};
   } else {
     return getSizePerThread(layout);
   }
 }
 
-SmallVector<unsigned> getThreadsPerCTA(Attribute layout) {
+static SmallVector<unsigned> computeThreadsPerCTA(Attribute layout) {
   SmallVector<unsigned> threads;
   if (auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>()) {
     for (int d = 0, n = blockedLayout.getOrder().size(); d < n; ++d)
       threads.push_back(blockedLayout.getThreadsPerWarp()[d] *
                         blockedLayout.getWarpsPerCTA()[d]);
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.getVersionMajor() == 2) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       threads = {8 * mmaLayout.getWarpsPerCTA()[0],
                  4 * mmaLayout.getWarpsPerCTA()[1]};
     } else
       assert(0 && "Unimplemented usage of MmaEncodingAttr");
+  } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    auto threadsPerWarp = getThreadsPerWarp(mfmaLayout);
+    threads = {threadsPerWarp[0] * mfmaLayout.getWarpsPerCTA()[0],
+               threadsPerWarp[1] * mfmaLayout.getWarpsPerCTA()[1]};
   } else {
     assert(0 && "Unimplemented usage of getShapePerCTA");
   }
@@ -148,8 +212,8 @@ SmallVector<unsigned> getThreadsPerCTA(Attribute layout) {
   return threads;
 }
 
-SmallVector<unsigned> getShapePerCTA(Attribute layout,
-                                     ArrayRef<int64_t> tensorShape) {
+static SmallVector<unsigned> computeShapePerCTA(Attribute layout,
+                                                ArrayRef<int64_t> tensorShape) {
   SmallVector<unsigned> shape;
   if (auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>()) {
     for (unsigned d = 0, n = blockedLayout.getOrder().size(); d < n; ++d)
@@ -165,7 +229,7 @@ SmallVector<unsigned> getShapePerCTA(Attribute layout,
       shape.push_back(getShapePerCTA(parent, tensorShape)[d]);
     }
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere())
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper())
       return {16 * mmaLayout.getWarpsPerCTA()[0],
               8 * mmaLayout.getWarpsPerCTA()[1]};
     if (mmaLayout.isVolta()) {
@@ -177,6 +241,9 @@ SmallVector<unsigned> getShapePerCTA(Attribute layout,
               static_cast<unsigned>(tensorShape[1])};
     }
     assert(0 && "Unexpected MMA layout version found");
+  } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    return {MfmaEncodingAttr::kNonKDim * mfmaLayout.getWarpsPerCTA()[0],
+            MfmaEncodingAttr::kNonKDim * mfmaLayout.getWarpsPerCTA()[1]};
   } else if (auto dotLayout = layout.dyn_cast<DotOperandEncodingAttr>()) {
     auto parentLayout = dotLayout.getParent();
     assert(parentLayout && "DotOperandEncodingAttr must have a parent");
@@ -192,6 +259,11 @@ SmallVector<unsigned> getShapePerCTA(Attribute layout,
       } else {
         assert(0 && "DotOperandEncodingAttr opIdx must be 0 or 1");
       }
+    } else if (parentLayout.isa<MfmaEncodingAttr>()) {
+      auto parentShapePerCTA = getShapePerCTA(parentLayout, tensorShape);
+      if (dotLayout.getOpIdx() == 0)
+        return {parentShapePerCTA[0], 8};
+      return {8, parentShapePerCTA[1]};
     } else {
       assert(0 && "DotOperandEncodingAttr non-MmaEncodingAttr parent not "
                   "supported yet");
@@ -202,12 +274,14 @@ SmallVector<unsigned> getShapePerCTA(Attribute layout,
   return shape;
 }
 
-SmallVector<unsigned> getOrder(Attribute layout) {
+static SmallVector<unsigned> computeOrder(Attribute layout) {
   if (auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>()) {
     return SmallVector<unsigned>(blockedLayout.getOrder().begin(),
                                  blockedLayout.getOrder().end());
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
     return {1, 0};
+  } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    return {1, 0};
   } else if (auto dotLayout = layout.dyn_cast<DotOperandEncodingAttr>()) {
     return {1, 0};
   } else if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>()) {
@@ -230,11 +304,67 @@ SmallVector<unsigned> getOrder(Attribute layout) {
     assert(0 && "Unimplemented usage of getOrder");
     return {};
   }
-};
+}
+
+// The layouts of Volta mma results are made for the shape of each tensor
+static bool isShapeDependent(Attribute layout) {
+  if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>())
+    return mmaLayout.isVolta();
+  if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>())
+    return isShapeDependent(sliceLayout.getParent());
+  if (auto dotLayout = layout.dyn_cast<DotOperandEncodingAttr>())
+    return isShapeDependent(dotLayout.getParent());
+  return false;
+}
+
+SmallVector<unsigned> getThreadsPerWarp(Attribute layout) {
+  return getLayoutInfoCache(layout.getContext())
+      .getOrCompute(layout, LayoutInfoCache::Kind::ThreadsPerWarp,
+                    [&] { return computeThreadsPerWarp(layout); });
+}
+
+SmallVector<unsigned> getWarpsPerCTA(Attribute layout) {
+  return getLayoutInfoCache(layout.getContext())
+      .getOrCompute(layout, LayoutInfoCache::Kind::WarpsPerCTA,
+                    [&] { return computeWarpsPerCTA(layout); });
+}
+
+SmallVector<unsigned> getSizePerThread(Attribute layout) {
+  return getLayoutInfoCache(layout.getContext())
+      .getOrCompute(layout, LayoutInfoCache::Kind::SizePerThread,
+                    [&] { return computeSizePerThread(layout); });
+}
+
+SmallVector<unsigned> getContigPerThread(Attribute layout) {
+  return getLayoutInfoCache(layout.getContext())
+      .getOrCompute(layout, LayoutInfoCache::Kind::ContigPerThread,
+                    [&] { return computeContigPerThread(layout); });
+}
+
+SmallVector<unsigned> getThreadsPerCTA(Attribute layout) {
+  return getLayoutInfoCache(layout.getContext())
+      .getOrCompute(layout, LayoutInfoCache::Kind::ThreadsPerCTA,
+                    [&] { return computeThreadsPerCTA(layout); });
+}
+
+SmallVector<unsigned> getShapePerCTA(Attribute layout,
+                                     ArrayRef<int64_t> tensorShape) {
+  if (isShapeDependent(layout))
+    return computeShapePerCTA(layout, tensorShape);
+  return getLayoutInfoCache(layout.getContext())
+      .getOrCompute(layout, LayoutInfoCache::Kind::ShapePerCTA,
+                    [&] { return computeShapePerCTA(layout, tensorShape); });
+}
+
+SmallVector<unsigned> getOrder(Attribute layout) {
+  return getLayoutInfoCache(layout.getContext())
+      .getOrCompute(layout, LayoutInfoCache::Kind::Order,
+                    [&] { return computeOrder(layout); });
+}
 
 bool isaDistributedLayout(Attribute layout) {
   return layout.isa<BlockedEncodingAttr>() || layout.isa<MmaEncodingAttr>() ||
-         layout.isa<SliceEncodingAttr>();
+         layout.isa<MfmaEncodingAttr>() || layout.isa<SliceEncodingAttr>();
 }
 
 } // namespace gpu
@@ -353,7 +483,8 @@ unsigned MmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape,
                                             Type eltTy) const {
   size_t rank = shape.size();
   assert(rank == 2 && "Unexpected rank of mma layout");
-  assert((isVolta() || isAmpere()) && "Only version 1 and 2 is supported");
+  assert((isVolta() || isAmpere() || isHopper()) &&
+         "Only version 1, 2 and 3 are supported");
 
   int res = 0;
   if (isVolta()) {
@@ -370,7 +501,7 @@ unsigned MmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape,
     unsigned resM = repM * std::max<int>(1, shape[0] / (spwM * wptM));
     unsigned resN = 2 * repN * std::max<int>(1, shape[1] / (spwN * wptN));
     res = resM * resN;
-  } else if (isAmpere()) {
+  } else if (isAmpere() || isHopper()) {
     unsigned elemsCol = ceil<unsigned>(shape[0], 16 * getWarpsPerCTA()[0]) * 2;
     unsigned elemsRow = ceil<unsigned>(shape[1], 8 * getWarpsPerCTA()[1]) * 2;
     res = elemsCol * elemsRow;
@@ -381,6 +512,14 @@ unsigned MmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape,
   return res;
 }
 
+unsigned MfmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape,
+                                             Type eltTy) const {
+  assert(shape.size() == 2 && "Unexpected rank of mfma layout");
+  unsigned repM = ceil<unsigned>(shape[0], kNonKDim * getWarpsPerCTA()[0]);
+  unsigned repN = ceil<unsigned>(shape[1], kNonKDim * getWarpsPerCTA()[1]);
+  return repM * repN * kNonKDim * kNonKDim / kWavefrontSize;
+}
+
 unsigned SharedEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape,
                                                Type eltTy) const {
   llvm_unreachable("Unexpected shared layout");
@@ -405,8 +544,26 @@ DotOperandEncodingAttr::getMMAv2Rep(ArrayRef<int64_t> shape,
   }
 }
 
+SmallVector<int64_t>
+DotOperandEncodingAttr::getMFMARep(ArrayRef<int64_t> shape) const {
+  auto mfmaParent = getParent().cast<MfmaEncodingAttr>();
+  auto warpsPerCTA = mfmaParent.getWarpsPerCTA();
+  constexpr int64_t nonKDim = MfmaEncodingAttr::kNonKDim;
+  constexpr int64_t instrK = 8;
+  if (getOpIdx() == 0)
+    return {std::max<int64_t>(1, shape[0] / (nonKDim * warpsPerCTA[0])),
+            std::max<int64_t>(1, shape[1] / instrK)};
+  assert(getOpIdx() == 1);
+  return {std::max<int64_t>(1, shape[0] / instrK),
+          std::max<int64_t>(1, shape[1] / (nonKDim * warpsPerCTA[1]))};
+}
+
 unsigned DotOperandEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape,
                                                    Type eltTy) const {
+  if (getParent().isa<MfmaEncodingAttr>()) {
+    auto rep = getMFMARep(shape);
+    return 4 * rep[0] * rep[1];
+  }
   if (auto mmaParent = getParent().dyn_cast<MmaEncodingAttr>()) {
     int warpsPerCTAM = mmaParent.getWarpsPerCTA()[0];
     int warpsPerCTAN = mmaParent.getWarpsPerCTA()[1];
@@ -610,6 +767,47 @@ void MmaEncodingAttr::print(AsmPrinter &printer) const {
           << "}>";
 }
 
+//===----------------------------------------------------------------------===//
+// MFMA encoding
+//===----------------------------------------------------------------------===//
+
+Attribute MfmaEncodingAttr::parse(AsmParser &parser, Type type) {
+  if (parser.parseLess().failed())
+    return {};
+  DictionaryAttr dict;
+  if (parser.parseAttribute(dict).failed())
+    return {};
+  if (parser.parseGreater().failed())
+    return {};
+
+  unsigned versionMajor = 0;
+  SmallVector<unsigned, 2> warpsPerCTA;
+
+  for (const NamedAttribute &attr : dict) {
+    if (attr.getName() == "versionMajor") {
+      if (parseUInt(parser, attr, versionMajor, "versionMajor").failed())
+        return {};
+    } else if (attr.getName() == "warpsPerCTA") {
+      if (parseIntArrayAttr(parser, attr, warpsPerCTA, "warpsPerCTA").failed())
+        return {};
+    } else {
+      parser.emitError(parser.getNameLoc(), "unexpected key: ")
+          << attr.getName().strref();
+      return {};
+    }
+  }
+
+  return parser.getChecked<MfmaEncodingAttr>(parser.getContext(), versionMajor,
+                                             warpsPerCTA);
+}
+
+void MfmaEncodingAttr::print(AsmPrinter &printer) const {
+  printer << "<{"
+          << "versionMajor = " << getVersionMajor() << ", "
+          << "warpsPerCTA = [" << getWarpsPerCTA() << "]"
+          << "}>";
+}
+
 //===----------------------------------------------------------------------===//
 // Sliced Encoding
 //===----------------------------------------------------------------------===//
@@ -692,6 +890,8 @@ bool MmaEncodingAttr::isVolta() const { return getVersionMajor() == 1; }
 
 bool MmaEncodingAttr::isAmpere() const { return getVersionMajor() == 2; }
 
+bool MmaEncodingAttr::isHopper() const { return getVersionMajor() == 3; }
+
 // Get [isARow, isBRow, isAVec4, isBVec4, id] from versionMinor
 std::tuple<bool, bool, bool, bool, int>
 MmaEncodingAttr::decodeVoltaLayoutStates() const {
@@ -853,6 +1053,9 @@ public:
     if (auto mmaAttr = attr.dyn_cast<MmaEncodingAttr>()) {
       os << "mma";
       return AliasResult::FinalAlias;
+    } else if (auto mfmaAttr = attr.dyn_cast<MfmaEncodingAttr>()) {
+      os << "mfma";
+      return AliasResult::FinalAlias;
     } else if (auto sharedAttr = attr.dyn_cast<SharedEncodingAttr>()) {
       os << "shared";
       return AliasResult::FinalAlias;
@@ -1064,6 +1267,42 @@ LogicalResult ConvertLayoutOp::canonicalize(ConvertLayoutOp op,
   return mlir::failure();
 }
 
+//===----------------------------------------------------------------------===//
+// DequantizeOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult DequantizeOp::verify() {
+  auto srcType = getSrc().getType().cast<RankedTensorType>();
+  auto resultType = getType().cast<RankedTensorType>();
+  if (!srcType.getElementType().isInteger(8) ||
+      !srcType.getEncoding().isa_and_nonnull<SharedEncodingAttr>())
+    return emitOpError("expects i8 operand in shared memory");
+  auto encoding =
+      resultType.getEncoding().dyn_cast_or_null<DotOperandEncodingAttr>();
+  auto mmaLayout =
+      encoding ? encoding.getParent().dyn_cast<MmaEncodingAttr>() : nullptr;
+  if (!resultType.getElementType().isF16() || !mmaLayout ||
+      !mmaLayout.isAmpere())
+    return emitOpError("expects f16 result of mma v2 dot operand layout");
+  if (srcType.getRank() != 2 || resultType.getRank() != 2)
+    return emitOpError("expects 2D tensors");
+
+  // the warps of a CTA load whole 16x16 blocks of the operand
+  auto shape = resultType.getShape();
+  auto warpsPerCTA = mmaLayout.getWarpsPerCTA();
+  int opIdx = encoding.getOpIdx();
+  int kDim = opIdx == 0 ? 1 : 0;
+  if (shape[1 - kDim] % (16 * warpsPerCTA[opIdx]) != 0 ||
+      shape[kDim] % 16 != 0)
+    return emitOpError("expects operand of whole blocks of 16 per warp");
+  auto srcShape = srcType.getShape();
+  if (srcShape[1 - kDim] != shape[1 - kDim] ||
+      (srcShape[kDim] != shape[kDim] && srcShape[kDim] * 2 != shape[kDim]))
+    return emitOpError("expects operand of the result shape, or half of it "
+                       "along k for i4");
+  return success();
+}
+
 //===----------------------------------------------------------------------===//
 
 /// Build an ExtractSliceOp with mixed static and dynamic entries and custom
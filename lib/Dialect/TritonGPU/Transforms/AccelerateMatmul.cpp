@@ -1,3 +1,5 @@
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "triton/Analysis/Utility.h"
@@ -11,6 +13,7 @@ using triton::DotOp;
 using triton::gpu::BlockedEncodingAttr;
 using triton::gpu::ConvertLayoutOp;
 using triton::gpu::DotOperandEncodingAttr;
+using triton::gpu::MfmaEncodingAttr;
 using triton::gpu::MmaEncodingAttr;
 using triton::gpu::SliceEncodingAttr;
 
@@ -22,8 +25,7 @@ int computeCapabilityToMMAVersion(int computeCapability) {
   } else if (computeCapability < 90) {
     return 2;
   } else if (computeCapability < 100) {
-    // FIXME: temporarily add this to pass unis tests
-    return 2;
+    return 3;
   } else {
     assert(false && "computeCapability > 100 not supported");
     return 3;
@@ -41,40 +43,116 @@ SmallVector<int64_t, 2> mmaVersionToShapePerWarp(int version) {
   }
 }
 
+// The shape of the mma.sync instruction a mma v2 dot of `elemTy` operands is
+// lowered to: m16n8 with a K of 256 bits, i.e. m16n8k8 for tf32, m16n8k16 for
+// 16-bit floats and m16n8k32 for 8-bit integers.
+SmallVector<int64_t, 3> mmaV2InstrShape(Type elemTy) {
+  return {16, 8, 256 / std::max<int64_t>(elemTy.getIntOrFloatBitWidth(), 8)};
+}
+
+// Returns whether operand `operand` of a dot inside a loop is defined out of
+// it, in which case it is read from shared memory once rather than every
+// iteration.
+bool isLoopInvariantOperand(triton::DotOp dotOp, Value operand) {
+  auto forOp = dotOp->getParentOfType<scf::ForOp>();
+  if (!forOp)
+    return false;
+  if (auto cvt = operand.getDefiningOp<ConvertLayoutOp>())
+    operand = cvt.getOperand();
+  return !forOp->isAncestor(operand.getParentBlock()->getParentOp());
+}
+
+// Picks the warps along M and N computing the result of `dotOp`. Each warp
+// reads the rows of A and the columns of B of its tile, so a split of
+// wm x wn warps reads wn x M x K elements of A and wm x N x K of B; loop
+// invariant operands are only read once and don't weigh in. Warps with less
+// than an instruction of the result to compute repeat the work of the others,
+// so the splits that waste the least are considered first, then the ones
+// reading the least, then the ones with the most warps along M.
+// The dots of a chain, like QK^T and PV in attention, split their rows
+// between all the warps instead, so that each warp computes the rows of A of
+// the second dot it holds the result of the first one for, and A stays in
+// its registers.
 SmallVector<unsigned, 2> warpsPerTileV2(triton::DotOp dotOp,
                                         const ArrayRef<int64_t> shape,
                                         int numWarps) {
+  auto isDot = [](Operation *op) { return isa<triton::DotOp>(op); };
   SetVector<Operation *> slices;
   mlir::getForwardSlice(dotOp.getResult(), &slices);
-  if (llvm::find_if(slices, [](Operation *op) {
-        return isa<triton::DotOp>(op);
-      }) != slices.end())
+  if (llvm::any_of(slices, isDot))
+    return {(unsigned)numWarps, 1};
+  SetVector<Operation *> operandSlices;
+  mlir::getBackwardSlice(dotOp.getA(), &operandSlices);
+  if (llvm::any_of(operandSlices, isDot))
     return {(unsigned)numWarps, 1};
 
-  SmallVector<unsigned, 2> ret = {1, 1};
-  SmallVector<int64_t, 2> shapePerWarp = {16, 8};
-  bool changed = false;
-  // TODO (@daadaada): double-check.
-  // original logic in
-  // https://github.com/openai/triton/blob/master/lib/codegen/analysis/layout.cc#L252
-  // seems buggy for shape = [32, 16] ?
-  do {
-    changed = false;
-    if (ret[0] * ret[1] >= numWarps)
-      break;
-    if (shape[0] / shapePerWarp[0] / ret[0] >=
-        shape[1] / (shapePerWarp[1] * 2) / ret[1]) {
-      if (ret[0] < shape[0] / shapePerWarp[0]) {
-        ret[0] *= 2;
-      } else
-        ret[1] *= 2;
-    } else {
-      ret[1] *= 2;
+  auto aType = dotOp.getA().getType().cast<RankedTensorType>();
+  auto instrShape = mmaV2InstrShape(aType.getElementType());
+  int64_t readsA = isLoopInvariantOperand(dotOp, dotOp.getA()) ? 0 : shape[0];
+  int64_t readsB = isLoopInvariantOperand(dotOp, dotOp.getB()) ? 0 : shape[1];
+
+  SmallVector<unsigned, 2> ret = {(unsigned)numWarps, 1};
+  std::pair<int64_t, int64_t> bestCost = {INT64_MAX, INT64_MAX};
+  for (int64_t wm = numWarps; wm >= 1; wm /= 2) {
+    int64_t wn = numWarps / wm;
+    int64_t tileM = std::max(shape[0] / wm, instrShape[0]);
+    int64_t tileN = std::max(shape[1] / wn, instrShape[1]);
+    int64_t waste = numWarps * tileM * tileN - shape[0] * shape[1];
+    std::pair<int64_t, int64_t> cost = {waste, wn * readsA + wm * readsB};
+    if (cost < bestCost) {
+      bestCost = cost;
+      ret = {(unsigned)wm, (unsigned)wn};
     }
-  } while (true);
+  }
   return ret;
 }
 
+// Returns the order of the tensor `operand` of a dot is converted from.
+SmallVector<unsigned> getOperandOrder(Value operand) {
+  if (auto cvt = operand.getDefiningOp<ConvertLayoutOp>())
+    operand = cvt.getOperand();
+  return triton::gpu::getOrder(
+      operand.getType().cast<RankedTensorType>().getEncoding());
+}
+
+// wgmma reads K-major operands from shared memory, whose rows must be the
+// width of one of its swizzle modes, into the f32 or s32 accumulators of
+// warpgroups that each compute 64 rows of the result.
+bool supportWGMMA(triton::DotOp dotOp, int numWarps) {
+  auto aType = dotOp.getA().getType().cast<RankedTensorType>();
+  auto retType = dotOp.getResult().getType().cast<RankedTensorType>();
+  auto retShape = retType.getShape();
+  if (numWarps % 4 != 0 || retShape[0] % (16 * numWarps) != 0)
+    return false;
+  int64_t instrN = std::min<int64_t>(retShape[1], 256);
+  if (instrN % 16 != 0 || retShape[1] % instrN != 0)
+    return false;
+  auto retElemTy = retType.getElementType();
+  if (!retElemTy.isF32() && !retElemTy.isInteger(32))
+    return false;
+  int64_t rowBytes = aType.getShape()[1] * aType.getElementTypeBitWidth() / 8;
+  if (rowBytes != 32 && rowBytes != 64 && rowBytes != 128)
+    return false;
+  return getOperandOrder(dotOp.getA())[0] == 1 &&
+         getOperandOrder(dotOp.getB())[0] == 0;
+}
+
+bool isFp8(Type elemTy) {
+  return elemTy.isa<Float8E4M3FNType, Float8E5M2Type>();
+}
+
+// Converts a fp8 dot operand to fp16, in the layout it was in before being
+// converted to a dot operand.
+Value upcastFp8ToFp16(PatternRewriter &rewriter, Value operand) {
+  Value src = operand;
+  if (auto cvt = operand.getDefiningOp<ConvertLayoutOp>())
+    src = cvt.getOperand();
+  auto srcTy = src.getType().cast<RankedTensorType>();
+  auto fp16Ty = RankedTensorType::get(srcTy.getShape(), rewriter.getF16Type(),
+                                      srcTy.getEncoding());
+  return rewriter.create<triton::FpToFpOp>(operand.getLoc(), fp16Ty, src);
+}
+
 class BlockedToMMA : public mlir::RewritePattern {
   int computeCapability;
   mutable int mmaV1Counter{}; // used to generate ID for MMAv1 encoding
@@ -104,12 +182,24 @@ public:
     auto mod = op->getParentOfType<mlir::ModuleOp>();
     int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
 
+    // Dots wgmma cannot compute use mma.sync on Hopper
+    if (versionMajor == 3 && !supportWGMMA(dotOp, numWarps))
+      versionMajor = 2;
+
     // operands
     Value a = dotOp.getA();
     Value b = dotOp.getB();
     auto oldAType = a.getType().cast<RankedTensorType>();
     auto oldBType = b.getType().cast<RankedTensorType>();
 
+    // Tensor cores multiply fp8 on sm89+ only. Before that, fp8 operands
+    // are kept as fp8 in memory and multiplied as fp16.
+    if (versionMajor == 2 && computeCapability < 89 &&
+        isFp8(oldAType.getElementType())) {
+      a = upcastFp8ToFp16(rewriter, a);
+      b = upcastFp8ToFp16(rewriter, b);
+    }
+
     triton::gpu::MmaEncodingAttr mmaEnc;
     if (versionMajor == 1) {
       SetVector<Operation *> aBwdSlices, bBwdSlices;
@@ -147,8 +237,15 @@ public:
       mmaEnc = triton::gpu::MmaEncodingAttr::get(
           oldRetType.getContext(), versionMajor, 0 /*versionMinor*/,
           warpsPerTile);
+    } else if (versionMajor == 3) {
+      // whole warpgroups along M, see MmaEncodingAttr
+      SmallVector<unsigned, 2> warpsPerTile = {static_cast<unsigned>(numWarps),
+                                               1};
+      mmaEnc = triton::gpu::MmaEncodingAttr::get(
+          oldRetType.getContext(), versionMajor, 0 /*versionMinor*/,
+          warpsPerTile);
     } else {
-      llvm_unreachable("Mma layout only supports versionMajor in {1, 2}");
+      llvm_unreachable("Mma layout only supports versionMajor in {1, 2, 3}");
     }
     auto newRetType =
         RankedTensorType::get(retShape, oldRetType.getElementType(), mmaEnc);
@@ -169,11 +266,11 @@ public:
                          .getOrder();
 
     auto newAType = RankedTensorType::get(
-        oldAType.getShape(), oldAType.getElementType(),
+        oldAType.getShape(), getElementTypeOrSelf(a.getType()),
         triton::gpu::DotOperandEncodingAttr::get(oldAType.getContext(), 0,
                                                  newRetType.getEncoding()));
     auto newBType = RankedTensorType::get(
-        oldBType.getShape(), oldBType.getElementType(),
+        oldBType.getShape(), getElementTypeOrSelf(b.getType()),
         triton::gpu::DotOperandEncodingAttr::get(oldBType.getContext(), 1,
                                                  newRetType.getEncoding()));
 
@@ -187,6 +284,94 @@ public:
     return success();
   }
 };
+
+// v_mfma_f32_32x32x8 multiplies f16 operands on every CDNA generation, and
+// bf16 ones from CDNA2 on, into blocks of 32x32 f32 accumulators.
+bool supportMFMA(triton::DotOp dotOp, int matrixCoreVersion) {
+  auto aType = dotOp.getA().getType().cast<RankedTensorType>();
+  auto retType = dotOp.getResult().getType().cast<RankedTensorType>();
+  auto elemTy = aType.getElementType();
+  if (!elemTy.isF16() && !(elemTy.isBF16() && matrixCoreVersion >= 2))
+    return false;
+  if (!retType.getElementType().isF32())
+    return false;
+  auto retShape = retType.getShape();
+  return retShape[0] % MfmaEncodingAttr::kNonKDim == 0 &&
+         retShape[1] % MfmaEncodingAttr::kNonKDim == 0 &&
+         aType.getShape()[1] % 8 == 0;
+}
+
+SmallVector<unsigned, 2> warpsPerTileMFMA(triton::DotOp dotOp,
+                                          ArrayRef<int64_t> shape,
+                                          int numWarps) {
+  // The rows of the result of a dot feeding another one stay in the
+  // wavefront that multiplies them
+  SetVector<Operation *> slices;
+  mlir::getForwardSlice(dotOp.getResult(), &slices);
+  if (llvm::any_of(slices, [](Operation *op) { return isa<DotOp>(op); }))
+    return {(unsigned)numWarps, 1};
+
+  SmallVector<unsigned, 2> ret = {1, 1};
+  int64_t nonKDim = MfmaEncodingAttr::kNonKDim;
+  while (ret[0] * ret[1] < numWarps) {
+    if (shape[0] / nonKDim / ret[0] >= shape[1] / nonKDim / ret[1] &&
+        ret[0] < shape[0] / nonKDim)
+      ret[0] *= 2;
+    else
+      ret[1] *= 2;
+  }
+  return ret;
+}
+
+class BlockedToMFMA : public mlir::RewritePattern {
+  int matrixCoreVersion;
+
+public:
+  BlockedToMFMA(mlir::MLIRContext *context, int matrixCoreVersion)
+      : mlir::RewritePattern(triton::DotOp::getOperationName(), 2, context),
+        matrixCoreVersion(matrixCoreVersion) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::Operation *op,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto dotOp = cast<triton::DotOp>(op);
+    auto oldRetType = dotOp.getResult().getType().cast<RankedTensorType>();
+    if (!oldRetType.getEncoding() ||
+        !oldRetType.getEncoding().isa<BlockedEncodingAttr>())
+      return failure();
+    if (!supportMFMA(dotOp, matrixCoreVersion))
+      return failure();
+
+    auto retShape = oldRetType.getShape();
+    auto mod = op->getParentOfType<mlir::ModuleOp>();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    auto warpsPerTile = warpsPerTileMFMA(dotOp, retShape, numWarps);
+    auto mfmaEnc = MfmaEncodingAttr::get(oldRetType.getContext(),
+                                         matrixCoreVersion, warpsPerTile);
+    auto newRetType =
+        RankedTensorType::get(retShape, oldRetType.getElementType(), mfmaEnc);
+
+    auto oldAcc = dotOp.getOperand(2);
+    auto newAcc =
+        rewriter.create<ConvertLayoutOp>(oldAcc.getLoc(), newRetType, oldAcc);
+    auto convertOperand = [&](Value operand, unsigned opIdx) -> Value {
+      auto oldType = operand.getType().cast<RankedTensorType>();
+      auto newType = RankedTensorType::get(
+          oldType.getShape(), oldType.getElementType(),
+          DotOperandEncodingAttr::get(oldType.getContext(), opIdx, mfmaEnc));
+      return rewriter.create<ConvertLayoutOp>(operand.getLoc(), newType,
+                                              operand);
+    };
+    Value a = convertOperand(dotOp.getA(), 0);
+    Value b = convertOperand(dotOp.getB(), 1);
+    auto newDot = rewriter.create<triton::DotOp>(
+        dotOp.getLoc(), newRetType, a, b, newAcc, dotOp.getAllowTF32());
+
+    rewriter.replaceOpWithNewOp<ConvertLayoutOp>(op, oldRetType,
+                                                 newDot.getResult());
+    return success();
+  }
+};
 } // namespace
 
 #define GEN_PASS_CLASSES
@@ -196,22 +381,28 @@ class TritonGPUAccelerateMatmulPass
     : public TritonGPUAccelerateMatmulBase<TritonGPUAccelerateMatmulPass> {
 public:
   TritonGPUAccelerateMatmulPass() = default;
-  TritonGPUAccelerateMatmulPass(int computeCapability) {
+  TritonGPUAccelerateMatmulPass(int computeCapability, int matrixCoreVersion) {
     this->computeCapability = computeCapability;
+    this->matrixCoreVersion = matrixCoreVersion;
   }
   void runOnOperation() override {
     MLIRContext *context = &getContext();
-    ModuleOp m = getOperation();
+    triton::FuncOp f = getOperation();
 
     mlir::RewritePatternSet patterns(context);
-    patterns.add<::BlockedToMMA>(context, computeCapability);
-    if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed()) {
+    if (matrixCoreVersion > 0)
+      patterns.add<::BlockedToMFMA>(context, matrixCoreVersion);
+    else
+      patterns.add<::BlockedToMMA>(context, computeCapability);
+    if (applyPatternsAndFoldGreedily(f, std::move(patterns)).failed()) {
       signalPassFailure();
     }
   }
 };
 
 std::unique_ptr<Pass>
-mlir::createTritonGPUAccelerateMatmulPass(int computeCapability) {
-  return std::make_unique<TritonGPUAccelerateMatmulPass>(computeCapability);
+mlir::createTritonGPUAccelerateMatmulPass(int computeCapability,
+                                          int matrixCoreVersion) {
+  return std::make_unique<TritonGPUAccelerateMatmulPass>(computeCapability,
+                                                         matrixCoreVersion);
 }
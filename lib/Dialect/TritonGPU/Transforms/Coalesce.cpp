@@ -1,8 +1,10 @@
 #include "mlir/Analysis/SliceAnalysis.h"
+#include "triton/Analysis/Allocation.h"
 #include "triton/Analysis/AxisInfo.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
 #include <numeric>
 
 using namespace mlir;
@@ -11,72 +13,43 @@ using namespace mlir::triton;
 #define GEN_PASS_CLASSES
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
 
-template <class T> SmallVector<unsigned, 4> argSort(const T &arr) {
-  SmallVector<unsigned, 4> ret(arr.size());
-  std::iota(ret.begin(), ret.end(), 0);
-  std::sort(ret.begin(), ret.end(),
-            [&](unsigned x, unsigned y) { return arr[x] > arr[y]; });
-  return ret;
-}
-
 typedef DenseMap<Value, std::function<Type(Type)>> LayoutMap;
 
-struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
-  Attribute getCoalescedEncoding(AxisInfoAnalysis &axisInfo, Value ptr,
-                                 int numWarps) {
-    auto origType = ptr.getType().cast<RankedTensorType>();
-    // Get the shape of the tensor.
-    size_t rank = origType.getRank();
-    dataflow::Lattice<AxisInfo> *latticeElement =
-        axisInfo.getLatticeElement(ptr);
-    AxisInfo info = latticeElement ? latticeElement->getValue() : AxisInfo();
-    // Get the contiguity order of `ptr`
-    auto order = argSort(info.getContiguity());
-    // The desired divisibility is the maximum divisibility
-    // among all dependent pointers who have the same order as
-    // `ptr`
-    SetVector<Value> withSameOrder;
-    withSameOrder.insert(ptr);
-    if (ptr.getDefiningOp())
-      for (Operation *op : mlir::multiRootGetSlice(ptr.getDefiningOp())) {
-        for (Value val : op->getResults()) {
-          if (val.getType() != origType)
-            continue;
-          auto valInfo = axisInfo.getLatticeElement(val);
-          auto currOrder = argSort(valInfo->getValue().getContiguity());
-          if (order == currOrder)
-            withSameOrder.insert(val);
-        }
-      }
-    int numElems = product(origType.getShape());
-    int numThreads = numWarps * 32;
-    int numElemsPerThread = std::max(numElems / numThreads, 1);
-    // Thread tile size depends on memory alignment
-    SmallVector<unsigned, 4> sizePerThread(rank, 1);
-    unsigned elemNumBits = triton::getPointeeBitWidth(origType);
-    unsigned elemNumBytes = std::max(elemNumBits / 8, 1u);
-    unsigned perThread = 1;
-    for (Value val : withSameOrder) {
-      AxisInfo info = axisInfo.getLatticeElement(val)->getValue();
-      unsigned maxMultipleBytes = info.getDivisibility(order[0]);
-      unsigned maxMultiple = std::max(maxMultipleBytes / elemNumBytes, 1u);
-      unsigned maxContig = info.getContiguity(order[0]);
-      unsigned alignment = std::min(maxMultiple, maxContig);
-      unsigned currPerThread = std::min(alignment, 128 / elemNumBits);
-      perThread = std::max(perThread, currPerThread);
-    }
-    sizePerThread[order[0]] = std::min<int>(perThread, numElemsPerThread);
-    SmallVector<unsigned> dims(rank);
-    std::iota(dims.begin(), dims.end(), 0);
-    // create encoding
-    Attribute encoding = triton::gpu::BlockedEncodingAttr::get(
-        &getContext(), origType.getShape(), sizePerThread, order, numWarps);
-    return encoding;
-  }
+// Explains why the accesses of `op` through `ptr` are not vectorized in the
+// coalesced `encoding`, when each thread has more than one element to access
+static void remarkUnvectorized(Operation *op, AxisInfoAnalysis &axisInfo,
+                               Value ptr, Attribute encoding) {
+  auto blocked = encoding.cast<triton::gpu::BlockedEncodingAttr>();
+  auto ty = ptr.getType().cast<RankedTensorType>();
+  unsigned dim = blocked.getOrder()[0];
+  unsigned elemNumBits = triton::getPointeeBitWidth(ty);
+  int numThreads = product(blocked.getWarpsPerCTA()) *
+                   product(blocked.getThreadsPerWarp());
+  if (blocked.getSizePerThread()[dim] != 1 || elemNumBits >= 128 ||
+      product(ty.getShape()) <= numThreads)
+    return;
+  AxisInfo info = axisInfo.getLatticeElement(ptr)->getValue();
+  if (info.getContiguity(dim) == 1)
+    emitMissedRemark(op, "tritongpu-coalesce",
+                     "accesses are not vectorized: the pointers are not "
+                     "contiguous along dimension " +
+                         Twine(dim) + " (contiguity 1)");
+  else
+    emitMissedRemark(op, "tritongpu-coalesce",
+                     "accesses are not vectorized: the pointers are only "
+                     "known to be " +
+                         Twine(info.getDivisibility(dim)) +
+                         "-byte aligned along dimension " + Twine(dim));
+}
 
+struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
   std::function<Type(Type)> getTypeConverter(AxisInfoAnalysis &axisInfo,
-                                             Value ptr, int numWarps) {
-    Attribute encoding = getCoalescedEncoding(axisInfo, ptr, numWarps);
+                                             Operation *op, Value ptr,
+                                             int numWarps,
+                                             int threadsPerWarp) {
+    Attribute encoding = getCoalescedEncoding(&getContext(), axisInfo, ptr,
+                                              numWarps, threadsPerWarp);
+    remarkUnvectorized(op, axisInfo, ptr, encoding);
     return [encoding](Type _type) {
       RankedTensorType type = _type.cast<RankedTensorType>();
       return RankedTensorType::get(type.getShape(), type.getElementType(),
@@ -91,6 +64,20 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
     if (!ty)
       return;
     auto convertType = layoutMap.lookup(ptr);
+    // Accesses that already start in their coalesced layout are left as is
+    auto isCoalesced = [&](Type t) {
+      auto tensorTy = t.dyn_cast<RankedTensorType>();
+      return !tensorTy ||
+             tensorTy.getEncoding().isa<triton::gpu::SharedEncodingAttr>() ||
+             convertType(tensorTy) == tensorTy;
+    };
+    if (llvm::all_of(op->getOperandTypes(), isCoalesced) &&
+        (std::is_same<T, triton::gpu::InsertSliceAsyncOp>::value ||
+         llvm::all_of(op->getResultTypes(), isCoalesced))) {
+      ++numAlreadyCoalesced;
+      return;
+    }
+    ++numCoalescedAccesses;
     // convert operands
     SmallVector<Value, 4> newArgs;
     for (auto v : op->getOperands()) {
@@ -153,7 +140,10 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
       AxisInfo info = axisInfo->getLatticeElement(ptr)->getValue();
       auto mod = curr->getParentOfType<ModuleOp>();
       int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
-      auto convertType = getTypeConverter(*axisInfo, ptr, numWarps);
+      int threadsPerWarp =
+          triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+      auto convertType =
+          getTypeConverter(*axisInfo, curr, ptr, numWarps, threadsPerWarp);
       layoutMap[ptr] = convertType;
     });
 
@@ -191,6 +181,67 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
   }
 };
 
+struct CoalesceEpiloguePass
+    : public TritonGPUCoalesceEpilogueBase<CoalesceEpiloguePass> {
+  CoalesceEpiloguePass() = default;
+  CoalesceEpiloguePass(int maxSharedMemory) {
+    this->maxSharedMemory = maxSharedMemory;
+  }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
+    AxisInfoAnalysis *axisInfo = solver->load<AxisInfoAnalysis>();
+    if (failed(solver->initializeAndRun(mod)))
+      return signalPassFailure();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+
+    SmallVector<triton::StoreOp> stores;
+    mod.walk([&](triton::StoreOp store) {
+      auto valueTy = store.getValue().getType().dyn_cast<RankedTensorType>();
+      if (valueTy && valueTy.getEncoding().isa<triton::gpu::MmaEncodingAttr>())
+        stores.push_back(store);
+    });
+
+    for (triton::StoreOp store : stores) {
+      Attribute encoding =
+          getCoalescedEncoding(&getContext(), *axisInfo, store.getPtr(),
+                               numWarps, threadsPerWarp);
+      OpBuilder builder(store);
+      auto convert = [&](Value v) {
+        auto ty = v.getType().cast<RankedTensorType>();
+        return builder.create<triton::gpu::ConvertLayoutOp>(
+            store.getLoc(),
+            RankedTensorType::get(ty.getShape(), ty.getElementType(),
+                                  encoding),
+            v);
+      };
+      // The conversion of the values is the staging buffer; give up on it
+      // when it doesn't fit in what the rest of the kernel leaves free
+      auto valueCvt = convert(store.getValue());
+      if (Allocation(mod).getSharedMemorySize() >
+          static_cast<size_t>(maxSharedMemory)) {
+        valueCvt->erase();
+        continue;
+      }
+      SmallVector<Value> newArgs;
+      for (Value arg : store->getOperands())
+        newArgs.push_back(arg == store.getValue() ? valueCvt.getResult()
+                                                  : convert(arg).getResult());
+      builder.create<triton::StoreOp>(store.getLoc(), TypeRange{}, newArgs,
+                                      store->getAttrs());
+      store->erase();
+      ++numStagedStores;
+    }
+  }
+};
+
 std::unique_ptr<Pass> mlir::createTritonGPUCoalescePass() {
   return std::make_unique<CoalescePass>();
 }
+
+std::unique_ptr<Pass>
+mlir::createTritonGPUCoalesceEpiloguePass(int maxSharedMemory) {
+  return std::make_unique<CoalesceEpiloguePass>(maxSharedMemory);
+}
@@ -1,3 +1,4 @@
+#include "Utility.h"
 #include "mlir/Analysis/SliceAnalysis.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/BuiltinAttributes.h"
@@ -21,6 +22,21 @@
 
 using namespace mlir;
 
+namespace {
+
+// The ways a conversion of a distributed tensor to a dot operand is done
+enum class Decomposition {
+  // stored to and read back from a shared memory tensor
+  Shared,
+  // read from the shared memory the source was itself read from, e.g. a slot
+  // of the buffer the pipeliner loads it into
+  ReusedBuffer,
+  // moved within warps into the MMA layout the operand is read from as is
+  Shuffles,
+};
+
+} // anonymous namespace
+
 class TritonGPUDecomposeConversionsPass
     : public TritonGPUDecomposeConversionsBase<
           TritonGPUDecomposeConversionsPass> {
@@ -28,8 +44,8 @@ public:
   TritonGPUDecomposeConversionsPass() = default;
 
   void runOnOperation() override {
-    ModuleOp mod = getOperation();
-    mod.walk([&](triton::gpu::ConvertLayoutOp cvtOp) -> void {
+    triton::FuncOp f = getOperation();
+    f.walk([&](triton::gpu::ConvertLayoutOp cvtOp) -> void {
       OpBuilder builder(cvtOp);
       auto srcType = cvtOp.getOperand().getType().cast<RankedTensorType>();
       auto dstType = cvtOp.getType().cast<RankedTensorType>();
@@ -44,23 +60,115 @@ public:
               srcEncoding.dyn_cast<triton::gpu::MmaEncodingAttr>()) {
 
         if (srcMmaEncoding.getVersionMajor() == 1 ||
-            (srcMmaEncoding.getWarpsPerCTA()[1] == 1 &&
+            (srcMmaEncoding.isAmpere() &&
+             srcMmaEncoding.getWarpsPerCTA()[1] == 1 &&
              dstDotOp.getParent() == srcMmaEncoding))
           return;
       }
       auto tmpType = RankedTensorType::get(
           dstType.getShape(), dstType.getElementType(),
           triton::gpu::SharedEncodingAttr::get(
-              mod.getContext(), dstDotOp, srcType.getShape(),
+              f.getContext(), dstDotOp, srcType.getShape(),
               triton::gpu::getOrder(srcEncoding), srcType.getElementType()));
-      auto tmp = builder.create<triton::gpu::ConvertLayoutOp>(
-          cvtOp.getLoc(), tmpType, cvtOp.getOperand());
-      auto newConvert = builder.create<triton::gpu::ConvertLayoutOp>(
-          cvtOp.getLoc(), dstType, tmp);
-      cvtOp.replaceAllUsesWith(newConvert.getResult());
+      Value newConvert;
+      switch (decompose(cvtOp, tmpType)) {
+      case Decomposition::ReusedBuffer: {
+        auto srcCvt =
+            cvtOp.getOperand().getDefiningOp<triton::gpu::ConvertLayoutOp>();
+        newConvert = builder.create<triton::gpu::ConvertLayoutOp>(
+            cvtOp.getLoc(), dstType, srcCvt.getOperand());
+        cvtOp.replaceAllUsesWith(newConvert);
+        cvtOp.erase();
+        if (srcCvt->use_empty())
+          srcCvt->erase();
+        ++numReusedBuffers;
+        return;
+      }
+      case Decomposition::Shuffles: {
+        auto mmaType =
+            RankedTensorType::get(dstType.getShape(), dstType.getElementType(),
+                                  dstDotOp.getParent());
+        auto tmp = builder.create<triton::gpu::ConvertLayoutOp>(
+            cvtOp.getLoc(), mmaType, cvtOp.getOperand());
+        newConvert = builder.create<triton::gpu::ConvertLayoutOp>(
+            cvtOp.getLoc(), dstType, tmp);
+        ++numWithShuffles;
+        break;
+      }
+      case Decomposition::Shared: {
+        auto tmp = builder.create<triton::gpu::ConvertLayoutOp>(
+            cvtOp.getLoc(), tmpType, cvtOp.getOperand());
+        newConvert = builder.create<triton::gpu::ConvertLayoutOp>(
+            cvtOp.getLoc(), dstType, tmp);
+        ++numThroughShared;
+        break;
+      }
+      }
+      cvtOp.replaceAllUsesWith(newConvert);
       cvtOp.erase();
     });
   }
+
+private:
+  // Chooses how to convert to a dot operand, going through a shared memory
+  // tensor of `sharedType` unless it is estimated to be cheaper otherwise
+  Decomposition decompose(triton::gpu::ConvertLayoutOp cvtOp,
+                          RankedTensorType sharedType) {
+    auto srcType = cvtOp.getOperand().getType().cast<RankedTensorType>();
+    auto dstType = cvtOp.getType().cast<RankedTensorType>();
+    // The source was read from shared memory that already has the layout of
+    // the temporary, so there is nothing to store
+    if (auto srcCvt =
+            cvtOp.getOperand().getDefiningOp<triton::gpu::ConvertLayoutOp>()) {
+      auto bufferType =
+          srcCvt.getOperand().getType().cast<RankedTensorType>();
+      if (bufferType.getEncoding() == sharedType.getEncoding())
+        return Decomposition::ReusedBuffer;
+    }
+
+    auto dstDotOp =
+        dstType.getEncoding().cast<triton::gpu::DotOperandEncodingAttr>();
+    auto mmaType = RankedTensorType::get(
+        dstType.getShape(), dstType.getElementType(), dstDotOp.getParent());
+    if (!dstDotOp.getParent().isa<triton::gpu::MmaEncodingAttr>() ||
+        !isMmaToDotShortcut(mmaType, dstType))
+      return Decomposition::Shared;
+    unsigned elems = triton::gpu::getElemsPerThread(mmaType);
+    if (elems > maxShuffleElems) {
+      emitMissedRemark(cvtOp, "tritongpu-decompose-conversions",
+                       "converted through shared memory: the " +
+                           Twine(elems) +
+                           " elements per thread of the operand do not fit "
+                           "the register budget of warp shuffles (" +
+                           Twine(maxShuffleElems) + ")");
+      return Decomposition::Shared;
+    }
+    auto shuffles = getWarpShuffleCvt(srcType, mmaType);
+    if (!shuffles) {
+      emitMissedRemark(cvtOp, "tritongpu-decompose-conversions",
+                       "converted through shared memory: the elements of "
+                       "the operand are not held by the same warps in both "
+                       "layouts");
+      return Decomposition::Shared;
+    }
+    // A barrier separates the store from the loads of the other threads
+    ConversionCost sharedCost = getConversionCost(srcType, sharedType);
+    sharedCost += getConversionCost(sharedType, dstType);
+    sharedCost.barriers += 1;
+    // Warp shuffles into the MMA layout, then the dot operand is read from
+    // its registers
+    ConversionCost shufflesCost = getShufflesCost(*shuffles);
+    shufflesCost += getConversionCost(mmaType, dstType);
+    if (shufflesCost.total() > sharedCost.total()) {
+      emitMissedRemark(cvtOp, "tritongpu-decompose-conversions",
+                       "converted through shared memory: warp shuffles are "
+                       "estimated to cost " +
+                           Twine(shufflesCost.total()) + " rather than " +
+                           Twine(sharedCost.total()));
+      return Decomposition::Shared;
+    }
+    return Decomposition::Shuffles;
+  }
 };
 
 std::unique_ptr<Pass> mlir::createTritonGPUDecomposeConversionsPass() {
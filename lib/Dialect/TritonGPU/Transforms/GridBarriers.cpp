@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+// This pass passes the counter that the grid barriers of a kernel synchronize
+// its programs on as a trailing argument. The launcher allocates the counter
+// zeroed for each launch, and launches the kernel cooperatively so that all
+// its programs are resident at once.
+//
+// For example:
+// tt.func public @kernel(%arg0: !tt.ptr<f32>) {
+//   ...
+//   tt.grid_barrier
+//   ...
+//   tt.return
+// }
+//
+// will be translated to
+//
+// tt.func public @kernel(%arg0: !tt.ptr<f32>,
+//                        %counter: !tt.ptr<i32> {tt.grid_barrier}) {
+//   ...
+//   triton_gpu.grid_barrier %counter : !tt.ptr<i32>
+//   ...
+//   tt.return
+// }
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/Builders.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+struct GridBarriersPass : public TritonGPUGridBarriersBase<GridBarriersPass> {
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    OpBuilder builder(mod.getContext());
+    for (auto funcOp : mod.getOps<triton::FuncOp>()) {
+      SmallVector<triton::GridBarrierOp> barriers;
+      funcOp.walk([&](triton::GridBarrierOp op) { barriers.push_back(op); });
+      if (barriers.empty())
+        continue;
+      if (!funcOp.isPublic()) {
+        barriers.front().emitError(
+            "grid barriers are only supported in kernels");
+        return signalPassFailure();
+      }
+
+      unsigned numArgs = funcOp.getNumArguments();
+      funcOp.insertArgument(
+          numArgs, triton::PointerType::get(builder.getI32Type(), 1),
+          builder.getDictionaryAttr(
+              {builder.getNamedAttr("tt.divisibility",
+                                    builder.getI32IntegerAttr(16)),
+               builder.getNamedAttr("tt.grid_barrier",
+                                    builder.getUnitAttr())}),
+          funcOp.getLoc());
+      Value counter = funcOp.getArgument(numArgs);
+      for (auto barrier : barriers) {
+        builder.setInsertionPoint(barrier);
+        builder.create<triton::gpu::GridBarrierOp>(barrier.getLoc(), counter);
+        barrier->erase();
+      }
+    }
+  }
+};
+
+} // anonymous namespace
+
+std::unique_ptr<Pass> mlir::createTritonGPUGridBarriersPass() {
+  return std::make_unique<GridBarriersPass>();
+}
@@ -0,0 +1,337 @@
+//===----------------------------------------------------------------------===//
+//
+// This pass records when the warps of a kernel enter and leave its regions:
+// the scopes between `tt.profile_marker`s, and optionally the iterations of
+// its loops, its dots and its loads. Each start and end becomes a
+// `triton_gpu.profile_record`, which writes the timer of the GPU into the
+// next record of the warp in a buffer passed as a trailing argument.
+//
+// For example:
+// tt.func public @kernel(%arg0: !tt.ptr<f32>) {
+//   tt.profile_marker "body" {isStart = true}
+//   ...
+//   tt.profile_marker "body" {isStart = false}
+//   tt.return
+// }
+//
+// will be translated to
+//
+// tt.func public @kernel(%arg0: !tt.ptr<f32>, %buffer: !tt.ptr<i64>) {
+//   %base = tt.addptr %buffer, %program_offset : !tt.ptr<i64>, i64
+//   %c0 = arith.constant 0 : i32
+//   %1 = triton_gpu.profile_record %base[%c0] {regionId = 0 : i32, isStart = true}
+//   ...
+//   %2 = triton_gpu.profile_record %base[%1] {regionId = 0 : i32, isStart = false}
+//   tt.return
+// }
+//
+// The index of the next record is a value, carried by the loops and the
+// conditionals that contain records as an extra iter_arg and result.
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+class RegionInstrumenter {
+public:
+  RegionInstrumenter(MLIRContext *context, int capacity, bool loops,
+                     bool dots, bool loads, bool globalTimer)
+      : builder(context), capacity(capacity), loops(loops), dots(dots),
+        loads(loads), globalTimer(globalTimer) {}
+
+  LogicalResult instrumentKernel(triton::FuncOp funcOp, int numWarps);
+
+  ArrayRef<std::string> getRegionNames() const { return regionNames; }
+  unsigned getNumRecords() const { return numRecords; }
+
+private:
+  unsigned getRegionId(StringRef name);
+  // A region of its own for each op that is recorded automatically, named
+  // after the op and its line, or its rank among the ops of its kind when
+  // it has no location
+  unsigned getRegionId(Operation *op);
+
+  bool isSite(Operation *op) const;
+  bool containsSites(Operation *op) const;
+
+  Value record(Location loc, Value index, unsigned region, bool isStart);
+  // Records the sites of `block` in order from `index`, and returns the index
+  // of the record after them
+  Value instrumentBlock(Block &block, Value index);
+  Value instrumentLoop(scf::ForOp forOp, Value index);
+  Value instrumentIf(scf::IfOp ifOp, Value index);
+
+  OpBuilder builder;
+  int capacity;
+  bool loops, dots, loads, globalTimer;
+  // the records of the program being instrumented
+  Value base;
+  std::vector<std::string> regionNames;
+  llvm::StringMap<unsigned> regionIds;
+  llvm::StringMap<unsigned> numUnlocated;
+  unsigned numRecords = 0;
+};
+
+unsigned RegionInstrumenter::getRegionId(StringRef name) {
+  auto it = regionIds.try_emplace(name, regionNames.size());
+  if (it.second)
+    regionNames.push_back(name.str());
+  return it.first->second;
+}
+
+unsigned RegionInstrumenter::getRegionId(Operation *op) {
+  StringRef kind = op->getName().getStringRef();
+  std::string name = kind.str();
+  if (auto fileLoc = op->getLoc()->findInstanceOf<FileLineColLoc>())
+    name += ":" + std::to_string(fileLoc.getLine());
+  else
+    name += "#" + std::to_string(numUnlocated[kind]++);
+  return getRegionId(name);
+}
+
+bool RegionInstrumenter::isSite(Operation *op) const {
+  return isa<triton::ProfileMarkerOp>(op) ||
+         (loops && isa<scf::ForOp>(op)) ||
+         (dots && isa<triton::DotOp>(op)) ||
+         (loads && isa<triton::LoadOp>(op));
+}
+
+bool RegionInstrumenter::containsSites(Operation *op) const {
+  return op
+      ->walk<WalkOrder::PreOrder>([&](Operation *nested) {
+        // the index is not carried through scf.while loops
+        if (isa<scf::WhileOp>(nested))
+          return WalkResult::skip();
+        return isSite(nested) ? WalkResult::interrupt()
+                              : WalkResult::advance();
+      })
+      .wasInterrupted();
+}
+
+Value RegionInstrumenter::record(Location loc, Value index, unsigned region,
+                                 bool isStart) {
+  ++numRecords;
+  return builder.create<triton::gpu::ProfileRecordOp>(
+      loc, builder.getI32Type(), base, index, region, isStart, capacity,
+      globalTimer);
+}
+
+Value RegionInstrumenter::instrumentBlock(Block &block, Value index) {
+  // the loads whose region ends after the first use of their result
+  DenseMap<Operation *, SmallVector<unsigned>> pendingEnds;
+  for (Operation &op : llvm::make_early_inc_range(block)) {
+    SmallVector<unsigned> ends = pendingEnds.lookup(&op);
+    Location loc = op.getLoc();
+    if (auto marker = dyn_cast<triton::ProfileMarkerOp>(&op)) {
+      builder.setInsertionPoint(marker);
+      index = record(loc, index, getRegionId(marker.getLabel()),
+                     marker.getIsStart());
+      builder.setInsertionPointAfter(index.getDefiningOp());
+      marker->erase();
+    } else if (auto forOp = dyn_cast<scf::ForOp>(&op)) {
+      if (containsSites(forOp))
+        index = instrumentLoop(forOp, index);
+      else
+        builder.setInsertionPointAfter(forOp);
+    } else if (auto ifOp = dyn_cast<scf::IfOp>(&op)) {
+      if (containsSites(ifOp))
+        index = instrumentIf(ifOp, index);
+      else
+        builder.setInsertionPointAfter(ifOp);
+    } else if (dots && isa<triton::DotOp>(op)) {
+      unsigned region = getRegionId(&op);
+      builder.setInsertionPoint(&op);
+      index = record(loc, index, region, true);
+      builder.setInsertionPointAfter(&op);
+      index = record(loc, index, region, false);
+    } else if (loads && isa<triton::LoadOp>(op)) {
+      unsigned region = getRegionId(&op);
+      builder.setInsertionPoint(&op);
+      index = record(loc, index, region, true);
+      // the warp stalls on the load at the first use of its result
+      Operation *firstUse = nullptr;
+      for (Operation *user : op.getUsers()) {
+        Operation *ancestor = block.findAncestorOpInBlock(*user);
+        if (ancestor && (!firstUse || ancestor->isBeforeInBlock(firstUse)))
+          firstUse = ancestor;
+      }
+      if (firstUse)
+        pendingEnds[firstUse].push_back(region);
+      else
+        ends.push_back(region);
+      builder.setInsertionPointAfter(&op);
+    } else if (op.hasTrait<OpTrait::IsTerminator>()) {
+      builder.setInsertionPoint(&op);
+    } else {
+      builder.setInsertionPointAfter(&op);
+    }
+    for (unsigned region : ends)
+      index = record(loc, index, region, false);
+  }
+  return index;
+}
+
+Value RegionInstrumenter::instrumentLoop(scf::ForOp forOp, Value index) {
+  SmallVector<Value> initArgs(forOp.getInitArgs());
+  initArgs.push_back(index);
+  builder.setInsertionPoint(forOp);
+  auto newForOp = builder.create<scf::ForOp>(
+      forOp.getLoc(), forOp.getLowerBound(), forOp.getUpperBound(),
+      forOp.getStep(), initArgs);
+  newForOp->setAttrs(forOp->getAttrs());
+  Block *body = newForOp.getBody();
+  Block *oldBody = forOp.getBody();
+  for (auto [oldArg, newArg] :
+       llvm::zip(oldBody->getArguments(), body->getArguments()))
+    oldArg.replaceAllUsesWith(newArg);
+  body->getOperations().splice(body->end(), oldBody->getOperations());
+  for (auto [oldResult, newResult] :
+       llvm::zip(forOp.getResults(), newForOp.getResults()))
+    oldResult.replaceAllUsesWith(newResult);
+  forOp.erase();
+
+  unsigned region = loops ? getRegionId(newForOp) : 0;
+  Value bodyIndex = newForOp.getRegionIterArgs().back();
+  if (loops) {
+    builder.setInsertionPointToStart(body);
+    bodyIndex = record(newForOp.getLoc(), bodyIndex, region, true);
+  }
+  bodyIndex = instrumentBlock(*body, bodyIndex);
+  Operation *yieldOp = body->getTerminator();
+  if (loops) {
+    builder.setInsertionPoint(yieldOp);
+    bodyIndex = record(newForOp.getLoc(), bodyIndex, region, false);
+  }
+  yieldOp->insertOperands(yieldOp->getNumOperands(), bodyIndex);
+  builder.setInsertionPointAfter(newForOp);
+  return newForOp.getResults().back();
+}
+
+Value RegionInstrumenter::instrumentIf(scf::IfOp ifOp, Value index) {
+  SmallVector<Type> resultTypes(ifOp.getResultTypes());
+  resultTypes.push_back(index.getType());
+  builder.setInsertionPoint(ifOp);
+  auto newIfOp = builder.create<scf::IfOp>(ifOp.getLoc(), resultTypes,
+                                           ifOp.getCondition(),
+                                           /*withElseRegion=*/true);
+  newIfOp->setAttrs(ifOp->getAttrs());
+  newIfOp.getThenRegion().takeBody(ifOp.getThenRegion());
+  if (!ifOp.getElseRegion().empty()) {
+    newIfOp.getElseRegion().takeBody(ifOp.getElseRegion());
+  } else {
+    builder.setInsertionPointToEnd(&newIfOp.getElseRegion().front());
+    builder.create<scf::YieldOp>(ifOp.getLoc());
+  }
+  for (auto [oldResult, newResult] :
+       llvm::zip(ifOp.getResults(), newIfOp.getResults()))
+    oldResult.replaceAllUsesWith(newResult);
+  ifOp.erase();
+
+  for (Region *region : {&newIfOp.getThenRegion(), &newIfOp.getElseRegion()}) {
+    Block &block = region->front();
+    Value branchIndex = instrumentBlock(block, index);
+    Operation *yieldOp = block.getTerminator();
+    yieldOp->insertOperands(yieldOp->getNumOperands(), branchIndex);
+  }
+  builder.setInsertionPointAfter(newIfOp);
+  return newIfOp.getResults().back();
+}
+
+LogicalResult RegionInstrumenter::instrumentKernel(triton::FuncOp funcOp,
+                                                   int numWarps) {
+  if (!funcOp.getBody().hasOneBlock())
+    return failure();
+  Block &entry = funcOp.getBody().front();
+  Location loc = funcOp.getLoc();
+  Type i32Ty = builder.getI32Type();
+  Type i64Ty = builder.getI64Type();
+
+  unsigned numArgs = funcOp.getNumArguments();
+  funcOp.insertArgument(
+      numArgs, triton::PointerType::get(i64Ty, 1),
+      builder.getDictionaryAttr(builder.getNamedAttr(
+          "tt.divisibility", builder.getI32IntegerAttr(16))),
+      loc);
+  Value buffer = entry.getArgument(numArgs);
+
+  // The records of the programs follow each other in the order of their
+  // linear id, x first, with `capacity` records of two words for each warp
+  builder.setInsertionPointToStart(&entry);
+  Value pid[3], numPrograms[2];
+  for (int axis = 0; axis < 3; ++axis)
+    pid[axis] = builder.create<triton::GetProgramIdOp>(
+        loc, i32Ty, builder.getI32IntegerAttr(axis));
+  for (int axis = 0; axis < 2; ++axis)
+    numPrograms[axis] = builder.create<triton::GetNumProgramsOp>(
+        loc, i32Ty, builder.getI32IntegerAttr(axis));
+  Value program = builder.create<arith::AddIOp>(
+      loc, pid[1],
+      builder.create<arith::MulIOp>(loc, numPrograms[1], pid[2]));
+  program = builder.create<arith::AddIOp>(
+      loc, pid[0], builder.create<arith::MulIOp>(loc, numPrograms[0], program));
+  Value programWords = builder.create<arith::ConstantIntOp>(
+      loc, int64_t(numWarps) * capacity * 2, 64);
+  Value offset = builder.create<arith::MulIOp>(
+      loc, builder.create<arith::ExtSIOp>(loc, i64Ty, program), programWords);
+  base = builder.create<triton::AddPtrOp>(loc, buffer.getType(), buffer,
+                                          offset);
+  Value index = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+  instrumentBlock(entry, index);
+  return success();
+}
+
+struct InstrumentRegionsPass
+    : public TritonGPUInstrumentRegionsBase<InstrumentRegionsPass> {
+  InstrumentRegionsPass() = default;
+  InstrumentRegionsPass(int capacity, bool loops, bool dots, bool loads,
+                        bool globalTimer) {
+    this->capacity = capacity;
+    this->loops = loops;
+    this->dots = dots;
+    this->loads = loads;
+    this->globalTimer = globalTimer;
+  }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    RegionInstrumenter instrumenter(&getContext(), capacity, loops, dots,
+                                    loads, globalTimer);
+    for (auto funcOp : mod.getOps<triton::FuncOp>()) {
+      if (!funcOp.isPublic())
+        continue;
+      if (failed(instrumenter.instrumentKernel(funcOp, numWarps))) {
+        funcOp.emitError("cannot instrument a kernel with unstructured "
+                         "control flow");
+        return signalPassFailure();
+      }
+    }
+    // the markers of the functions that are not kernels, and the ones in
+    // scf.while loops, are not recorded
+    mod.walk([](triton::ProfileMarkerOp marker) { marker->erase(); });
+
+    SmallVector<StringRef> names(instrumenter.getRegionNames().begin(),
+                                 instrumenter.getRegionNames().end());
+    OpBuilder builder(mod.getContext());
+    mod->setAttr("triton_gpu.profile_regions", builder.getStrArrayAttr(names));
+    numRecords += instrumenter.getNumRecords();
+  }
+};
+
+} // anonymous namespace
+
+std::unique_ptr<Pass>
+mlir::createTritonGPUInstrumentRegionsPass(int capacity, bool loops, bool dots,
+                                           bool loads, bool globalTimer) {
+  return std::make_unique<InstrumentRegionsPass>(capacity, loops, dots, loads,
+                                                 globalTimer);
+}
@@ -20,6 +20,10 @@ using triton::gpu::SliceEncodingAttr;
 // x = convert_layout arg: #distributed -> #shared_x
 // y = trans x: #shared_x -> #shared_y
 // z = convert_layout y: #shared_y -> #dot_operand
+//
+// The transpose is a view of x, so the load of z reads the transposed operand
+// directly (ldmatrix.trans for 16-bit types, lds for 8/32-bit types) as long
+// as x is swizzled for the dot operand y, not for x itself.
 class ConvertTransConvert : public mlir::RewritePattern {
 
 public:
@@ -53,11 +57,17 @@ public:
         ZType.getEncoding().dyn_cast<triton::gpu::DotOperandEncodingAttr>();
     if (!ZEncoding)
       return mlir::failure();
-    // new X encoding
+    // new X encoding, swizzled for the transposed view Y which Z is loaded
+    // from
     auto newXOrder = triton::gpu::getOrder(argEncoding);
+    SmallVector<unsigned> newYOrder(newXOrder.rbegin(), newXOrder.rend());
+    auto YType = tmpOp.getType().cast<RankedTensorType>();
+    auto newYEncoding = triton::gpu::SharedEncodingAttr::get(
+        getContext(), ZEncoding, YType.getShape(), newYOrder,
+        YType.getElementType());
     auto newXEncoding = triton::gpu::SharedEncodingAttr::get(
-        getContext(), ZEncoding, XType.getShape(), newXOrder,
-        XType.getElementType());
+        getContext(), newYEncoding.getVec(), newYEncoding.getPerPhase(),
+        newYEncoding.getMaxPhase(), newXOrder);
     auto newXType = RankedTensorType::get(XType.getShape(),
                                           XType.getElementType(), newXEncoding);
     if (XEncoding == newXEncoding)
@@ -72,6 +82,151 @@ public:
   }
 };
 
+// convert(truncf(mulf(subf(itofp(q), zero), scale)))
+// q: #distributed i8
+// scale, zero: splat
+// convert_layout: #distributed f16 -> #dot_operand (mma v2)
+//
+// The weights of a quantized dot are dequantized in registers and staged in
+// shared memory as f16, twice as large as q. q is staged in shared memory
+// instead, and dequantized as it is loaded as the dot operand. The truncf,
+// mulf and subf are each optional.
+class DequantizeConvert : public mlir::RewritePattern {
+
+public:
+  DequantizeConvert(mlir::MLIRContext *context)
+      : mlir::RewritePattern(triton::gpu::ConvertLayoutOp::getOperationName(),
+                             1, context) {}
+
+  // The scalar f32 of a splat, or the splat itself if it is not of one.
+  static Value getSplatSrc(Value v) {
+    if (auto splat = v.getDefiningOp<triton::SplatOp>())
+      return splat.getSrc();
+    if (auto cst = v.getDefiningOp<arith::ConstantOp>())
+      if (cst.getValue().isa<SplatElementsAttr>())
+        return v;
+    return Value();
+  }
+
+  static Value createScalar(Value splat, float init, Location loc,
+                            mlir::PatternRewriter &rewriter) {
+    if (!splat)
+      return rewriter.create<arith::ConstantOp>(loc,
+                                                rewriter.getF32FloatAttr(init));
+    if (auto cst = splat.getDefiningOp<arith::ConstantOp>()) {
+      auto value = cst.getValue().cast<SplatElementsAttr>();
+      return rewriter.create<arith::ConstantOp>(
+          loc, rewriter.getF32FloatAttr(
+                   value.getSplatValue<APFloat>().convertToDouble()));
+    }
+    if (splat.getType().isF32())
+      return splat;
+    return rewriter.create<arith::ExtFOp>(loc, rewriter.getF32Type(), splat);
+  }
+
+  LogicalResult
+  matchAndRewrite(mlir::Operation *op,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto cvt = cast<triton::gpu::ConvertLayoutOp>(op);
+    auto dstType = cvt.getType().cast<RankedTensorType>();
+    auto dstEncoding =
+        dstType.getEncoding().dyn_cast<triton::gpu::DotOperandEncodingAttr>();
+    if (!dstEncoding || !dstType.getElementType().isF16())
+      return mlir::failure();
+    auto mmaLayout = dstEncoding.getParent().dyn_cast<MmaEncodingAttr>();
+    if (!mmaLayout || !mmaLayout.isAmpere() || dstType.getRank() != 2)
+      return mlir::failure();
+    auto shape = dstType.getShape();
+    int opIdx = dstEncoding.getOpIdx();
+    int kDim = opIdx == 0 ? 1 : 0;
+    if (shape[1 - kDim] % (16 * mmaLayout.getWarpsPerCTA()[opIdx]) != 0 ||
+        shape[kDim] % 16 != 0)
+      return mlir::failure();
+
+    Value v = cvt.getSrc();
+    if (!v.hasOneUse() ||
+        v.getType().cast<RankedTensorType>().getEncoding().isa<
+            triton::gpu::SharedEncodingAttr>())
+      return mlir::failure();
+    if (auto truncf = v.getDefiningOp<arith::TruncFOp>())
+      v = truncf.getIn();
+    Value scale, zero;
+    if (auto mulf = v.getDefiningOp<arith::MulFOp>();
+        mulf && v.hasOneUse()) {
+      if ((scale = getSplatSrc(mulf.getRhs())))
+        v = mulf.getLhs();
+      else if ((scale = getSplatSrc(mulf.getLhs())))
+        v = mulf.getRhs();
+      else
+        return mlir::failure();
+    }
+    if (auto subf = v.getDefiningOp<arith::SubFOp>();
+        subf && v.hasOneUse()) {
+      if (!(zero = getSplatSrc(subf.getRhs())))
+        return mlir::failure();
+      v = subf.getLhs();
+    }
+    if (!v.hasOneUse())
+      return mlir::failure();
+    Value q;
+    bool isSigned = true;
+    if (auto sitofp = v.getDefiningOp<arith::SIToFPOp>())
+      q = sitofp.getIn();
+    else if (auto uitofp = v.getDefiningOp<arith::UIToFPOp>()) {
+      q = uitofp.getIn();
+      isSigned = false;
+    } else
+      return mlir::failure();
+    auto qType = q.getType().cast<RankedTensorType>();
+    if (!qType.getElementType().isInteger(8))
+      return mlir::failure();
+
+    auto loc = cvt.getLoc();
+    auto sharedEncoding = triton::gpu::SharedEncodingAttr::get(
+        getContext(), 1, 1, 1, triton::gpu::getOrder(qType.getEncoding()));
+    auto sharedType = RankedTensorType::get(
+        qType.getShape(), qType.getElementType(), sharedEncoding);
+    Value staged =
+        rewriter.create<triton::gpu::ConvertLayoutOp>(loc, sharedType, q);
+    Value scaleVal = createScalar(scale, 1.0, loc, rewriter);
+    Value zeroVal = createScalar(zero, 0.0, loc, rewriter);
+    rewriter.replaceOpWithNewOp<triton::gpu::DequantizeOp>(
+        cvt, dstType, staged, scaleVal, zeroVal, isSigned);
+    return mlir::success();
+  }
+};
+
+// dequantize(convert(convert(x))), x: #shared
+//
+// The pipeliner stages the integers of a dequantize in shared memory in its
+// own layout, and converts them back to a distributed layout for their uses,
+// here the convert to shared memory of the dequantize. It loads them from the
+// pipelined buffer instead.
+class DequantizeSharedSrc
+    : public mlir::OpRewritePattern<triton::gpu::DequantizeOp> {
+
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::DequantizeOp op,
+                  mlir::PatternRewriter &rewriter) const override {
+    Value src = op.getSrc();
+    while (auto cvt = src.getDefiningOp<triton::gpu::ConvertLayoutOp>()) {
+      src = cvt.getSrc();
+      if (src.getType().cast<RankedTensorType>().getEncoding().isa<
+              triton::gpu::SharedEncodingAttr>())
+        break;
+    }
+    if (src == op.getSrc() ||
+        !src.getType().cast<RankedTensorType>().getEncoding().isa<
+            triton::gpu::SharedEncodingAttr>())
+      return mlir::failure();
+    rewriter.updateRootInPlace(op, [&]() { op.getSrcMutable().assign(src); });
+    return mlir::success();
+  }
+};
+
 } // namespace
 
 #define GEN_PASS_CLASSES
@@ -85,17 +240,20 @@ public:
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
-    ModuleOp m = getOperation();
+    triton::FuncOp f = getOperation();
 
-    mlir::PassManager pm(m.getContext());
+    OpPassManager pm(triton::FuncOp::getOperationName());
     pm.addPass(mlir::createCanonicalizerPass());
-    auto ret = pm.run(m);
+    if (failed(runPipeline(pm, f)))
+      return signalPassFailure();
 
     mlir::RewritePatternSet patterns(context);
     patterns.add<ConvertTransConvert>(context);
-    if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed())
+    patterns.add<DequantizeConvert>(context);
+    patterns.add<DequantizeSharedSrc>(context);
+    if (applyPatternsAndFoldGreedily(f, std::move(patterns)).failed())
       signalPassFailure();
-    if (fixupLoops(m).failed())
+    if (fixupLoops(f).failed())
       signalPassFailure();
   }
 };
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+// This pass turns a kernel that computes one tile per program into a
+// persistent kernel. The launcher starts at most one program per SM along
+// axis 0 and passes the number of tiles, i.e. the grid size the kernel was
+// launched with, as a trailing argument. Each program then loops over the
+// tiles with a grid stride.
+//
+// For example:
+// tt.func public @kernel(%arg0: !tt.ptr<f32>) {
+//   %pid = tt.get_program_id {axis = 0 : i32} : i32
+//   ...
+//   tt.return
+// }
+//
+// will be translated to
+//
+// tt.func public @kernel(%arg0: !tt.ptr<f32>, %num_tiles: i32) {
+//   %pid = tt.get_program_id {axis = 0 : i32} : i32
+//   %nprogs = tt.get_num_programs {axis = 0 : i32} : i32
+//   scf.for %tile = %pid to %num_tiles step %nprogs : i32 {
+//     ... (%pid replaced by %tile)
+//   }
+//   tt.return
+// }
+//
+// The tile loop is left alone by the pipeliner, unless `pipeline-tiles` is
+// set: the loads of the next tile are then issued while the current tile is
+// computed, which reorders them before the stores of the current tile.
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+LogicalResult makePersistent(triton::FuncOp funcOp, bool pipelineTiles) {
+  // The body must be straight-line code ending in an empty return so it can
+  // be wrapped in a loop.
+  if (!funcOp.getBody().hasOneBlock())
+    return failure();
+  Block &entry = funcOp.getBody().front();
+  auto returnOp = dyn_cast<triton::ReturnOp>(entry.getTerminator());
+  if (!returnOp || returnOp.getNumOperands() != 0)
+    return failure();
+
+  SmallVector<triton::GetProgramIdOp> pids;
+  SmallVector<triton::GetNumProgramsOp> numPrograms;
+  funcOp.walk([&](Operation *op) {
+    if (auto pidOp = dyn_cast<triton::GetProgramIdOp>(op)) {
+      if (pidOp.getAxis() == 0)
+        pids.push_back(pidOp);
+    } else if (auto numProgramsOp = dyn_cast<triton::GetNumProgramsOp>(op)) {
+      if (numProgramsOp.getAxis() == 0)
+        numPrograms.push_back(numProgramsOp);
+    }
+  });
+
+  Location loc = funcOp.getLoc();
+  OpBuilder builder(funcOp.getContext());
+  Type i32Ty = builder.getI32Type();
+  unsigned numArgs = funcOp.getNumArguments();
+  funcOp.insertArgument(numArgs, i32Ty, DictionaryAttr(), loc);
+  Value numTiles = entry.getArgument(numArgs);
+
+  builder.setInsertionPointToStart(&entry);
+  Value firstTile = builder.create<triton::GetProgramIdOp>(
+      loc, i32Ty, builder.getI32IntegerAttr(0));
+  auto stride = builder.create<triton::GetNumProgramsOp>(
+      loc, i32Ty, builder.getI32IntegerAttr(0));
+  Block::iterator bodyBegin = std::next(stride->getIterator());
+
+  builder.setInsertionPoint(returnOp);
+  auto tileLoop =
+      builder.create<scf::ForOp>(loc, firstTile, numTiles, stride.getResult());
+  if (!pipelineTiles)
+    tileLoop->setAttr("tt.no_pipeline", builder.getUnitAttr());
+
+  // Move the original body into the tile loop
+  Block *loopBody = tileLoop.getBody();
+  loopBody->getOperations().splice(loopBody->getTerminator()->getIterator(),
+                                   entry.getOperations(), bodyBegin,
+                                   tileLoop->getIterator());
+
+  for (triton::GetProgramIdOp pidOp : pids) {
+    pidOp.getResult().replaceAllUsesWith(tileLoop.getInductionVar());
+    pidOp->erase();
+  }
+  for (triton::GetNumProgramsOp numProgramsOp : numPrograms) {
+    numProgramsOp.getResult().replaceAllUsesWith(numTiles);
+    numProgramsOp->erase();
+  }
+  return success();
+}
+
+struct PersistentKernelPass
+    : public TritonGPUPersistentKernelBase<PersistentKernelPass> {
+  PersistentKernelPass() = default;
+  PersistentKernelPass(bool pipelineTiles) {
+    this->pipelineTiles = pipelineTiles;
+  }
+
+  void runOnOperation() override {
+    triton::FuncOp funcOp = getOperation();
+    // The launcher caps the grid of every kernel of the module, so each of them
+    // has to loop over its tiles, even if it doesn't read its program id.
+    if (!funcOp.isPublic())
+      return;
+    if (failed(makePersistent(funcOp, pipelineTiles))) {
+      funcOp.emitError("cannot turn a kernel with unstructured control flow "
+                       "into a persistent kernel");
+      return signalPassFailure();
+    }
+    ++numPersistentKernels;
+  }
+};
+
+} // anonymous namespace
+
+std::unique_ptr<Pass>
+mlir::createTritonGPUPersistentKernelPass(bool pipelineTiles) {
+  return std::make_unique<PersistentKernelPass>(pipelineTiles);
+}
@@ -1,13 +1,17 @@
+#include "mlir/Analysis/SliceAnalysis.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/IR/TypeUtilities.h"
 #include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/BankConflicts.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 
+#include <chrono>
+
 //===----------------------------------------------------------------------===//
 //
 // This file implements loop software pipelining
@@ -31,6 +35,96 @@ static void addNamedAttrs(Operation *op, DictionaryAttr dictAttrs) {
 
 #define int_attr(num) builder.getI64IntegerAttr(num)
 
+// TMA swizzles the 16-byte vectors of rows of 32, 64 or 128 bytes, which is
+// the swizzle of the row-major shared layouts with perPhase * rowBytes = 128
+// and maxPhase = rowBytes / 16. Returns the swizzle of `enc` in bytes for
+// tiles of `shape`, 0 if it is unswizzled, or std::nullopt if TMA cannot
+// write it.
+static std::optional<unsigned> getTMASwizzle(ttg::SharedEncodingAttr enc,
+                                             ArrayRef<int64_t> shape,
+                                             Type elemTy) {
+  if (enc.getMaxPhase() == 1)
+    return 0;
+  unsigned elemBytes = elemTy.getIntOrFloatBitWidth() / 8;
+  unsigned rowBytes = shape[1] * elemBytes;
+  // Every slot of the buffer starts a new repetition of the pattern
+  if (enc.getOrder()[0] != 1 || rowBytes < 32 || rowBytes > 128 ||
+      shape[0] % 8 != 0)
+    return std::nullopt;
+  if (enc.getVec() * elemBytes != 16 || enc.getMaxPhase() != rowBytes / 16 ||
+      enc.getPerPhase() != 128 / rowBytes)
+    return std::nullopt;
+  return rowBytes;
+}
+
+static ttg::SharedEncodingAttr getTMASharedEncoding(MLIRContext *ctx,
+                                                    unsigned swizzle,
+                                                    Type elemTy) {
+  SmallVector<unsigned> order = {1, 0};
+  if (swizzle == 0)
+    return ttg::SharedEncodingAttr::get(ctx, 1, 1, 1, order);
+  unsigned elemBytes = elemTy.getIntOrFloatBitWidth() / 8;
+  return ttg::SharedEncodingAttr::get(ctx, 16 / elemBytes, 128 / swizzle,
+                                      swizzle / 16, order);
+}
+
+// Returns the swizzle of the tensor map `desc` points to, which is set to
+// `swizzle` by the first load of the block it describes.
+static unsigned getTensorMapSwizzle(Value desc, unsigned swizzle) {
+  auto arg = desc.cast<BlockArgument>();
+  auto funcOp = cast<triton::FuncOp>(arg.getOwner()->getParentOp());
+  auto *ctx = funcOp.getContext();
+  auto tensorMap = funcOp.getArgAttrOfType<DictionaryAttr>(arg.getArgNumber(),
+                                                           "tt.tensormap");
+  if (auto attr = tensorMap.getAs<IntegerAttr>("swizzle"))
+    return attr.getInt();
+  NamedAttrList attrs(tensorMap);
+  attrs.set("swizzle", IntegerAttr::get(IntegerType::get(ctx, 32), swizzle));
+  funcOp.setArgAttr(arg.getArgNumber(), "tt.tensormap",
+                    attrs.getDictionary(ctx));
+  return swizzle;
+}
+
+static RankedTensorType getMBarriersType(MLIRContext *ctx,
+                                         int64_t numBarriers) {
+  auto enc =
+      ttg::SharedEncodingAttr::get(ctx, 1, 1, 1, SmallVector<unsigned>{0});
+  return RankedTensorType::get({numBarriers}, IntegerType::get(ctx, 64), enc);
+}
+
+// Descriptor loads can only be copied by TMA, so the ones that are not
+// pipelined are copied to a buffer of one slot and waited for right away.
+static void expandDescriptorLoad(triton::DescriptorLoadOp op) {
+  OpBuilder builder(op);
+  Location loc = op.getLoc();
+  auto ty = op.getType().cast<RankedTensorType>();
+  auto elemTy = ty.getElementType();
+  auto shape = ty.getShape();
+  unsigned swizzle = getTensorMapSwizzle(op.getDesc(), 0);
+  auto sharedEnc = getTMASharedEncoding(builder.getContext(), swizzle, elemTy);
+  auto bufferTy =
+      RankedTensorType::get({1, shape[0], shape[1]}, elemTy, sharedEnc);
+  Value buffer = builder.create<ttg::AllocTensorOp>(loc, bufferTy);
+  Value barriers = builder.create<ttg::AllocMBarrierOp>(
+      loc, getMBarriersType(builder.getContext(), 1));
+  Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+  Value pred = builder.create<arith::ConstantIntOp>(loc, 1, 1);
+  buffer = builder.create<ttg::InsertSliceTMAOp>(
+      loc, bufferTy, op.getDesc(), op.getIndices(), buffer, zero, barriers,
+      pred);
+  builder.create<ttg::MBarrierWaitOp>(loc, barriers, zero, zero);
+  auto sliceTy = RankedTensorType::get(shape, elemTy, sharedEnc);
+  Value slice = builder.create<ttg::ExtractSliceOp>(
+      loc, sliceTy, buffer,
+      SmallVector<OpFoldResult>{int_attr(0), int_attr(0), int_attr(0)},
+      SmallVector<OpFoldResult>{int_attr(1), int_attr(shape[0]),
+                                int_attr(shape[1])},
+      SmallVector<OpFoldResult>{int_attr(1), int_attr(1), int_attr(1)});
+  Value cvt = builder.create<ttg::ConvertLayoutOp>(loc, ty, slice);
+  op.getResult().replaceAllUsesWith(cvt);
+  op.erase();
+}
+
 namespace {
 
 class LoopPipeliner {
@@ -52,6 +146,10 @@ class LoopPipeliner {
   DenseMap<Value, SmallVector<Value>> loadStageBuffer;
   /// load => after extract
   DenseMap<Value, Value> loadsExtract;
+  /// load => mbarriers of its stages, for the loads copied by TMA
+  DenseMap<Value, Value> loadsBarriers;
+  /// Number of loads copied by cp.async, each in its own commit group
+  int numAsyncLoads = 0;
   ///
   Value pipelineIterIdx;
   ///
@@ -62,6 +160,9 @@ class LoopPipeliner {
   ///   numStages-1 is appended after the loop body
   int numStages;
 
+  /// Whether loads that do not feed a dot are staged as well
+  bool pipelineNonDotLoads;
+
   /// value (in loop) => value at stage N
   DenseMap<Value, SmallVector<Value>> valueMapping;
 
@@ -101,9 +202,15 @@ class LoopPipeliner {
   /// Returns a empty buffer of size <numStages, ...>
   ttg::AllocTensorOp allocateEmptyBuffer(Operation *op, OpBuilder &builder);
 
+  /// Axis info of the module, shared by all loops
+  AxisInfoAnalysis *axisInfoAnalysis;
+
 public:
-  LoopPipeliner(scf::ForOp forOp, int numStages)
-      : forOp(forOp), numStages(numStages) {
+  LoopPipeliner(scf::ForOp forOp, int numStages, bool pipelineNonDotLoads,
+                AxisInfoAnalysis *axisInfoAnalysis)
+      : forOp(forOp), numStages(numStages),
+        pipelineNonDotLoads(pipelineNonDotLoads),
+        axisInfoAnalysis(axisInfoAnalysis) {
     // cache yieldOp
     yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
   }
@@ -182,14 +289,8 @@ ttg::AllocTensorOp LoopPipeliner::allocateEmptyBuffer(Operation *op,
 LogicalResult LoopPipeliner::initialize() {
   Block *loop = forOp.getBody();
 
-  std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
-  AxisInfoAnalysis *axisInfoAnalysis = solver->load<AxisInfoAnalysis>();
-  if (failed(solver->initializeAndRun(forOp->getParentOfType<ModuleOp>()))) {
-    return failure();
-  }
-
   // can we use forOp.walk(...) here?
-  SmallVector<triton::LoadOp, 2> validLoads;
+  SmallVector<Operation *, 2> validLoads;
   for (Operation &op : *loop)
     if (auto loadOp = dyn_cast<triton::LoadOp>(&op)) {
       auto ptr = loadOp.getPtr();
@@ -200,8 +301,12 @@ LogicalResult LoopPipeliner::initialize() {
 
       auto lattice = axisInfoAnalysis->getLatticeElement(ptr)->getValue();
       auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
-      if (!tensorTy || tensorTy.getRank() < 2)
+      if (!tensorTy || tensorTy.getRank() < 2) {
+        emitMissedRemark(loadOp, "tritongpu-pipeline",
+                         "only loads of tiles of rank 2 or more are "
+                         "pipelined");
         continue;
+      }
       auto ty = tensorTy.getElementType()
                     .cast<triton::PointerType>()
                     .getPointeeType();
@@ -209,6 +314,14 @@ LogicalResult LoopPipeliner::initialize() {
       // cp.async's cp-size can only be 4, 8 and 16.
       if (width >= 32)
         validLoads.push_back(loadOp);
+      else
+        emitMissedRemark(loadOp, "tritongpu-pipeline",
+                         "not pipelined: its contiguous, aligned accesses are " +
+                             Twine(width) +
+                             " bits wide, cp.async copies at least 32");
+    } else if (isa<triton::DescriptorLoadOp>(&op)) {
+      // TMA copies whole tiles, whatever their alignment
+      validLoads.push_back(&op);
     }
 
   // Early stop: no need to continue if there is no load in the loop.
@@ -217,31 +330,42 @@ LogicalResult LoopPipeliner::initialize() {
 
   // load => values that it depends on
   DenseMap<Value, SetVector<Value>> loadDeps;
-  for (triton::LoadOp loadOp : validLoads) {
+  for (Operation *loadOp : validLoads) {
     SetVector<Value> deps;
     for (Value op : loadOp->getOperands())
       collectDeps(op, numStages - 1, deps);
-    loadDeps[loadOp] = deps;
+    loadDeps[loadOp->getResult(0)] = deps;
   }
 
-  // Don't pipeline valid loads that depend on other valid loads
-  // (Because if a valid load depends on another valid load, this load needs to
-  // wait on the other load in the prologue, which is against the point of the
-  // pipeline pass)
-  for (triton::LoadOp loadOp : validLoads) {
-    bool isCandidate = true;
-    for (triton::LoadOp other : validLoads) {
-      if (loadDeps[loadOp].contains(other)) {
-        isCandidate = false;
-        break;
-      }
-    }
-
-    // We only pipeline loads that have one covert_layout (to dot_op) use
-    // TODO: lift this constraint in the future
-    if (isCandidate && loadOp.getResult().hasOneUse()) {
-      isCandidate = false;
-      Operation *use = *loadOp.getResult().getUsers().begin();
+  // Valid loads that other valid loads depend on, e.g. the index tiles of
+  // block-sparse and paged kernels, are not pipelined. They become part of
+  // the address computation of the dependent loads, like the other ops in
+  // depOps, and are issued as regular loads numStages - 1 iterations ahead.
+  // This offsets the stages of load-after-load chains: the index tile of an
+  // iteration is loaded before the asynchronous copy of the data it points
+  // at is issued, and that copy still overlaps with the iterations in
+  // between.
+  // (Staging both loads would make the dependent copy wait on the other copy
+  // in the prologue, which is against the point of the pipeline pass)
+  DenseSet<Value> addressLoads;
+  for (Operation *loadOp : validLoads)
+    for (Operation *other : validLoads)
+      if (loadDeps[loadOp->getResult(0)].contains(other->getResult(0)))
+        addressLoads.insert(other->getResult(0));
+
+  for (Operation *loadOp : validLoads) {
+    Value load = loadOp->getResult(0);
+    bool independent = !addressLoads.contains(load);
+    if (!independent)
+      emitMissedRemark(loadOp, "tritongpu-pipeline",
+                       "not pipelined: other loads of the loop depend on it, "
+                       "it is issued as a regular load ahead of them");
+
+    // Loads that have one covert_layout (to dot_op) use are staged in the
+    // shared layout of the dot operand
+    bool isCandidate = false;
+    if (independent && load.hasOneUse()) {
+      Operation *use = *load.getUsers().begin();
 
       // advance to the first conversion as long
       // as the use resides in shared memory and it has
@@ -263,24 +387,70 @@ LogicalResult LoopPipeliner::initialize() {
           if (auto dotOpEnc = tensorType.getEncoding()
                                   .dyn_cast<ttg::DotOperandEncodingAttr>()) {
             isCandidate = true;
-            loadsMapping[loadOp] = convertLayout;
-            auto ty = loadOp.getType().cast<RankedTensorType>();
+            loadsMapping[load] = convertLayout;
+            auto ty = load.getType().cast<RankedTensorType>();
             SmallVector<int64_t> bufferShape(ty.getShape().begin(),
                                              ty.getShape().end());
             bufferShape.insert(bufferShape.begin(), numStages);
             auto sharedEnc = ttg::SharedEncodingAttr::get(
                 ty.getContext(), dotOpEnc, ty.getShape(),
                 triton::gpu::getOrder(ty.getEncoding()), ty.getElementType());
-            loadsBufferType[loadOp] = RankedTensorType::get(
+            loadsBufferType[load] = RankedTensorType::get(
                 bufferShape, ty.getElementType(), sharedEnc);
           }
         }
       }
-    } else
-      isCandidate = false;
+    }
+
+    // Other loads, e.g. of streaming reductions, are staged in a shared
+    // layout with the order of their blocked layout, and converted back to it
+    // for all of their uses. It is unswizzled unless this makes the copies
+    // conflict on shared memory banks. This is opt-in, as their buffers add
+    // to the shared memory of the kernel
+    if (pipelineNonDotLoads && independent && !isCandidate) {
+      auto ty = load.getType().cast<RankedTensorType>();
+      if (auto blockedEnc =
+              ty.getEncoding().dyn_cast<ttg::BlockedEncodingAttr>()) {
+        isCandidate = true;
+        loadsMapping[load] = load;
+        SmallVector<int64_t> bufferShape(ty.getShape().begin(),
+                                         ty.getShape().end());
+        bufferShape.insert(bufferShape.begin(), numStages);
+        auto sharedEnc = getConflictFreeSharedEncoding(
+            blockedEnc, ty.getShape(), blockedEnc.getOrder(),
+            ty.getElementType());
+        loadsBufferType[load] = RankedTensorType::get(
+            bufferShape, ty.getElementType(), sharedEnc);
+      }
+    }
 
-    if (isCandidate)
-      loads.insert(loadOp);
+    // TMA writes the tiles row-major, in the swizzle of the tensor map. The
+    // layout chosen above is kept if TMA can write it, and the buffer is
+    // unswizzled otherwise
+    auto descLoad = dyn_cast<triton::DescriptorLoadOp>(loadOp);
+    if (isCandidate && descLoad) {
+      auto ty = descLoad.getType().cast<RankedTensorType>();
+      auto bufferTy = loadsBufferType[load];
+      auto swizzle = getTMASwizzle(
+          bufferTy.getEncoding().cast<ttg::SharedEncodingAttr>(),
+          ty.getShape(), ty.getElementType());
+      unsigned tensorMapSwizzle =
+          getTensorMapSwizzle(descLoad.getDesc(), swizzle.value_or(0));
+      loadsBufferType[load] = RankedTensorType::get(
+          bufferTy.getShape(), ty.getElementType(),
+          getTMASharedEncoding(ty.getContext(), tensorMapSwizzle,
+                               ty.getElementType()));
+    }
+
+    if (isCandidate) {
+      loads.insert(load);
+      if (isa<triton::LoadOp>(loadOp))
+        ++numAsyncLoads;
+    } else if (independent) {
+      emitMissedRemark(loadOp, "tritongpu-pipeline",
+                       "not pipelined: its result is neither in a blocked "
+                       "layout nor only converted to a dot operand");
+    }
   }
 
   // We have some loads to pipeline
@@ -376,6 +546,11 @@ void LoopPipeliner::emitPrologue() {
         if (stage == 0) {
           loadsBuffer[op->getResult(0)] = allocateEmptyBuffer(op, builder);
           loadStageBuffer[op->getResult(0)] = {loadsBuffer[op->getResult(0)]};
+          if (isa<triton::DescriptorLoadOp>(op))
+            loadsBarriers[op->getResult(0)] =
+                builder.create<ttg::AllocMBarrierOp>(
+                    op->getLoc(),
+                    getMBarriersType(builder.getContext(), numStages));
         }
         // load => copy async
         if (auto loadOp = llvm::dyn_cast<triton::LoadOp>(op)) {
@@ -391,8 +566,20 @@ void LoopPipeliner::emitPrologue() {
               loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0);
           builder.create<triton::gpu::AsyncCommitGroupOp>(op->getLoc());
           loadStageBuffer[loadOp].push_back(newOp->getResult(0));
+        } else if (auto descLoad =
+                       llvm::dyn_cast<triton::DescriptorLoadOp>(op)) {
+          // descriptor load => copy with TMA, arriving on the barrier of
+          // the slot
+          SmallVector<Value> indices;
+          for (Value index : descLoad.getIndices())
+            indices.push_back(lookupOrDefault(index, stage));
+          newOp = builder.create<ttg::InsertSliceTMAOp>(
+              op->getLoc(), loadsBuffer[descLoad].getType(),
+              descLoad.getDesc(), indices, loadStageBuffer[descLoad][stage],
+              pipelineIterIdx, loadsBarriers[descLoad], loopCond);
+          loadStageBuffer[descLoad].push_back(newOp->getResult(0));
         } else
-          llvm_unreachable("This should be LoadOp");
+          llvm_unreachable("This should be LoadOp or DescriptorLoadOp");
       } else {
         if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
           Value newMask =
@@ -448,10 +635,17 @@ void LoopPipeliner::emitPrologue() {
   } // for (int stage = 0; stage < numStages - 1; ++stage)
 
   // async.wait & extract_slice
-  builder.create<ttg::AsyncWaitOp>(loads[0].getLoc(),
-                                   loads.size() * (numStages - 2));
+  if (numAsyncLoads > 0)
+    builder.create<ttg::AsyncWaitOp>(loads[0].getLoc(),
+                                     numAsyncLoads * (numStages - 2));
   loopIterIdx = builder.create<arith::ConstantIntOp>(iv.getLoc(), 0, 32);
   for (Value loadOp : loads) {
+    // The first iteration reads slot 0 once its barrier completes phase 0
+    if (Value barriers = loadsBarriers.lookup(loadOp)) {
+      Value zero = builder.create<arith::ConstantIntOp>(loadOp.getLoc(), 0, 32);
+      builder.create<ttg::MBarrierWaitOp>(loadOp.getLoc(), barriers, zero,
+                                          zero);
+    }
     auto bufferType = loadStageBuffer[loadOp][numStages - 1]
                           .getType()
                           .cast<RankedTensorType>();
@@ -478,6 +672,9 @@ void LoopPipeliner::emitPrologue() {
 
 void LoopPipeliner::emitEpilogue() {
   // If there's any outstanding async copies, we need to wait for them.
+  // The TMA copies past the last iteration are predicated off.
+  if (numAsyncLoads == 0)
+    return;
   OpBuilder builder(forOp);
   OpBuilder::InsertionGuard g(builder);
   builder.setInsertionPointAfter(forOp);
@@ -554,9 +751,14 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   for (size_t idx = 0; idx < loads.size(); ++idx) {
     OpBuilder::InsertionGuard guard(builder);
     Value load = loads[idx];
-    assert(load.hasOneUse() &&
-           "we assume that this load has one use (ConvertLayout)");
-    Value loadUse = load.getUsers().begin()->getResult(0);
+    // Loads that do not feed a dot are mapped to themselves and converted
+    // back to their own layout
+    Value loadUse = load;
+    if (loadsMapping[load] != load) {
+      assert(load.hasOneUse() &&
+             "we assume that this load has one use (ConvertLayout)");
+      loadUse = load.getUsers().begin()->getResult(0);
+    }
     // set insertion point
     Value newLoad = mapping.lookup(load);
     Value newLoadUse = mapping.lookup(loadUse);
@@ -570,7 +772,8 @@ scf::ForOp LoopPipeliner::createNewForOp() {
     newLoadUse.replaceAllUsesWith(cvt.getResult());
     // delete old load and layout conversion
     newLoadUse.getDefiningOp()->erase();
-    newLoad.getDefiningOp()->erase();
+    if (newLoad != newLoadUse)
+      newLoad.getDefiningOp()->erase();
   }
 
   // 4. prefetch the next iteration
@@ -614,6 +817,16 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   Value extractSliceIndex = builder.create<arith::RemSIOp>(
       nextIV.getLoc(), loopIterIdx,
       builder.create<arith::ConstantIntOp>(nextIV.getLoc(), numStages, 32));
+  // The barrier of a slot completes one phase per round over the slots
+  Value extractSlicePhase;
+  if (!loadsBarriers.empty())
+    extractSlicePhase = builder.create<arith::AndIOp>(
+        nextIV.getLoc(),
+        builder.create<arith::DivSIOp>(
+            nextIV.getLoc(), loopIterIdx,
+            builder.create<arith::ConstantIntOp>(nextIV.getLoc(), numStages,
+                                                 32)),
+        builder.create<arith::ConstantIntOp>(nextIV.getLoc(), 1, 32));
 
   for (Operation *op : orderedDeps)
     if (!loads.contains(op->getResult(0))) {
@@ -653,37 +866,54 @@ scf::ForOp LoopPipeliner::createNewForOp() {
     Operation *nextOp = nullptr;
     // Update loading mask
     if (loads.contains(op->getResult(0))) {
-      auto loadOp = llvm::cast<triton::LoadOp>(op);
-      auto mask = loadOp.getMask();
-      auto newMask =
-          getLoadMask(loadOp, nextMapping.lookupOrDefault(loadOp.getMask()),
-                      nextLoopCond, builder);
-      if (mask) {
-        // If mask is defined outside the loop, don't update the map more than
-        // once
-        if (!(forOp.isDefinedOutsideOfLoop(mask) && nextMapping.contains(mask)))
-          nextMapping.map(loadOp.getMask(), newMask);
-        newMask = nextMapping.lookupOrDefault(mask);
+      Value load = op->getResult(0);
+      Value insertOp;
+      if (auto descLoad = dyn_cast<triton::DescriptorLoadOp>(op)) {
+        SmallVector<Value> indices;
+        for (Value index : descLoad.getIndices())
+          indices.push_back(nextMapping.lookupOrDefault(index));
+        insertOp = builder.create<ttg::InsertSliceTMAOp>(
+            op->getLoc(), loadsBuffer[load].getType(), descLoad.getDesc(),
+            indices,
+            newForOp.getRegionIterArgs()[bufferIdx + nextBuffers.size()],
+            insertSliceIndex, loadsBarriers[load], nextLoopCond);
+        builder.create<ttg::MBarrierWaitOp>(op->getLoc(), loadsBarriers[load],
+                                            extractSliceIndex,
+                                            extractSlicePhase);
+      } else {
+        auto loadOp = llvm::cast<triton::LoadOp>(op);
+        auto mask = loadOp.getMask();
+        auto newMask =
+            getLoadMask(loadOp, nextMapping.lookupOrDefault(loadOp.getMask()),
+                        nextLoopCond, builder);
+        if (mask) {
+          // If mask is defined outside the loop, don't update the map more
+          // than once
+          if (!(forOp.isDefinedOutsideOfLoop(mask) &&
+                nextMapping.contains(mask)))
+            nextMapping.map(loadOp.getMask(), newMask);
+          newMask = nextMapping.lookupOrDefault(mask);
+        }
+        insertOp = builder.create<triton::gpu::InsertSliceAsyncOp>(
+            op->getLoc(), loadsBuffer[loadOp].getType(),
+            nextMapping.lookupOrDefault(loadOp.getPtr()),
+            newForOp.getRegionIterArgs()[bufferIdx + nextBuffers.size()],
+            insertSliceIndex, newMask,
+            nextMapping.lookupOrDefault(loadOp.getOther()), loadOp.getCache(),
+            loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0);
+        builder.create<triton::gpu::AsyncCommitGroupOp>(op->getLoc());
       }
-      Value insertAsyncOp = builder.create<triton::gpu::InsertSliceAsyncOp>(
-          op->getLoc(), loadsBuffer[loadOp].getType(),
-          nextMapping.lookupOrDefault(loadOp.getPtr()),
-          newForOp.getRegionIterArgs()[bufferIdx + nextBuffers.size()],
-          insertSliceIndex, newMask,
-          nextMapping.lookupOrDefault(loadOp.getOther()), loadOp.getCache(),
-          loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0);
-      builder.create<triton::gpu::AsyncCommitGroupOp>(op->getLoc());
-      nextBuffers.push_back(insertAsyncOp);
+      nextBuffers.push_back(insertOp);
       // ExtractSlice
-      auto bufferType = insertAsyncOp.getType().cast<RankedTensorType>();
+      auto bufferType = insertOp.getType().cast<RankedTensorType>();
       auto bufferShape = bufferType.getShape();
-      auto sliceType = loadsMapping[loadOp].getType().cast<RankedTensorType>();
+      auto sliceType = loadsMapping[load].getType().cast<RankedTensorType>();
       sliceType = RankedTensorType::get({bufferShape[1], bufferShape[2]},
                                         sliceType.getElementType(),
-                                        loadsBufferType[loadOp].getEncoding());
+                                        loadsBufferType[load].getEncoding());
 
       nextOp = builder.create<triton::gpu::ExtractSliceOp>(
-          op->getLoc(), sliceType, insertAsyncOp,
+          op->getLoc(), sliceType, insertOp,
           SmallVector<OpFoldResult>{extractSliceIndex, int_attr(0),
                                     int_attr(0)},
           SmallVector<OpFoldResult>{int_attr(1),
@@ -710,11 +940,16 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   }
 
   // async.wait & extract_slice
-  Operation *asyncWait = builder.create<ttg::AsyncWaitOp>(
-      loads[0].getLoc(), loads.size() * (numStages - 2));
-  for (auto it = extractSlices.rbegin(); it != extractSlices.rend(); ++it) {
-    // move extract_slice after asyncWait
-    it->getDefiningOp()->moveAfter(asyncWait);
+  if (numAsyncLoads > 0) {
+    Operation *asyncWait = builder.create<ttg::AsyncWaitOp>(
+        loads[0].getLoc(), numAsyncLoads * (numStages - 2));
+    for (auto it = extractSlices.rbegin(); it != extractSlices.rend(); ++it) {
+      // move extract_slice after asyncWait, the ones of TMA copies already
+      // follow their mbarrier_wait
+      Operation *extractOp = it->getDefiningOp();
+      if (extractOp->getOperand(0).getDefiningOp<ttg::InsertSliceAsyncOp>())
+        extractOp->moveAfter(asyncWait);
+    }
   }
 
   // Bump iteration count
@@ -749,16 +984,290 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   return newForOp;
 }
 
+// Double buffering through registers, for targets without asynchronous
+// copies from global to shared memory such as AMD GPUs. The tile of the next
+// iteration is loaded into registers while the current one, stored to shared
+// memory by its conversion to a dot operand, is computed upon:
+//
+//   %a0 = tt.load %ptr0                    // prologue
+//   scf.for ... iter_args(%a = %a0, %ptr = %ptr0) {
+//     %dot_a = convert_layout %a           // registers -> LDS -> dot operand
+//     %next = tt.addptr %ptr, %inc         // moved ahead of the dot
+//     %a_next = tt.load %next, %in_bounds  // in flight during the dot
+//     tt.dot %dot_a, ...
+//     scf.yield %a_next, %next
+//   }
+//
+// The first use of the loaded registers is the store to shared memory at the
+// top of the next iteration, so that the backend waits for the load there
+// (s_waitcnt vmcnt) rather than in front of the dot.
+class RegisterPipeliner {
+  scf::ForOp forOp;
+  scf::YieldOp yieldOp;
+
+  /// Loads staged in registers
+  SmallVector<triton::LoadOp> loads;
+  /// Ops of the body computing the operands of the loads
+  SetVector<Operation *> loadSlice;
+  /// Ops of the body computing the next values of the iter args the loads
+  /// depend on
+  SetVector<Operation *> nextSlice;
+  /// Iter args the loads depend on
+  SetVector<BlockArgument> depArgs;
+
+  /// Ops of the body that op depends on, or failure if they are not all pure
+  /// ops without regions, which can be cloned ahead of their position
+  FailureOr<SetVector<Operation *>> getPureSlice(Operation *op) {
+    SetVector<Operation *> slice;
+    getBackwardSlice(op, &slice, [&](Operation *other) {
+      return other->getBlock() == forOp.getBody();
+    });
+    if (!llvm::all_of(slice, [](Operation *other) {
+          return other->getNumRegions() == 0 && isMemoryEffectFree(other);
+        }))
+      return failure();
+    return slice;
+  }
+
+  Value getLoadMask(triton::LoadOp loadOp, Value mappedMask, Value cond,
+                    OpBuilder &builder) {
+    Type maskType = triton::getI1SameShape(loadOp.getType());
+    cond = builder.create<triton::SplatOp>(cond.getLoc(), maskType, cond);
+    if (!mappedMask)
+      return cond;
+    return builder.create<arith::AndIOp>(cond.getLoc(), mappedMask, cond);
+  }
+
+  /// Clone the loads with mapping, predicated on cond
+  SmallVector<Value> cloneLoads(OpBuilder &builder, IRMapping &mapping,
+                                Value cond) {
+    for (Operation *op : topologicalSort(loadSlice))
+      builder.clone(*op, mapping);
+    SmallVector<Value> results;
+    for (triton::LoadOp loadOp : loads) {
+      Value mask = loadOp.getMask()
+                       ? mapping.lookupOrDefault(loadOp.getMask())
+                       : Value();
+      mask = getLoadMask(loadOp, mask, cond, builder);
+      auto newLoad = builder.create<triton::LoadOp>(
+          loadOp.getLoc(), loadOp.getResult().getType(),
+          mapping.lookupOrDefault(loadOp.getPtr()), mask,
+          mapping.lookupOrDefault(loadOp.getOther()),
+          loadOp.getBoundaryCheckAttr(), loadOp.getPaddingAttr(),
+          loadOp.getCache(), loadOp.getEvict(), loadOp.getIsVolatile());
+      addNamedAttrs(newLoad, loadOp->getAttrDictionary());
+      results.push_back(newLoad.getResult());
+    }
+    return results;
+  }
+
+public:
+  explicit RegisterPipeliner(scf::ForOp forOp) : forOp(forOp) {
+    yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+  }
+
+  /// Collect the loads to stage. Return success if there is any
+  LogicalResult initialize() {
+    for (auto loadOp : forOp.getBody()->getOps<triton::LoadOp>()) {
+      auto tensorTy = loadOp.getType().dyn_cast<RankedTensorType>();
+      if (!tensorTy || tensorTy.getRank() < 2) {
+        emitMissedRemark(loadOp, "tritongpu-pipeline",
+                         "only loads of tiles of rank 2 or more are "
+                         "pipelined");
+        continue;
+      }
+      // Loads of the addresses of others, e.g. of block-sparse kernels, are
+      // not pure and end up here
+      auto slice = getPureSlice(loadOp);
+      if (failed(slice)) {
+        emitMissedRemark(loadOp, "tritongpu-pipeline",
+                         "not pipelined: its address depends on other loads "
+                         "or ops with side effects of the loop");
+        continue;
+      }
+
+      // The next values of the iter args the load depends on are computed
+      // ahead of their yield
+      SetVector<BlockArgument> args;
+      auto addArgs = [&](Operation *op) {
+        for (Value operand : op->getOperands())
+          if (auto arg = operand.dyn_cast<BlockArgument>();
+              arg && arg.getOwner() == forOp.getBody() &&
+              arg != forOp.getInductionVar())
+            args.insert(arg);
+      };
+      addArgs(loadOp);
+      for (Operation *op : *slice)
+        addArgs(op);
+      SetVector<Operation *> next;
+      bool pure = true;
+      for (BlockArgument arg : args) {
+        Value yielded = yieldOp->getOperand(arg.getArgNumber() - 1);
+        Operation *def = yielded.getDefiningOp();
+        if (!def || def->getBlock() != forOp.getBody())
+          continue;
+        auto defSlice = getPureSlice(def);
+        if (failed(defSlice) || def->getNumRegions() != 0 ||
+            !isMemoryEffectFree(def)) {
+          pure = false;
+          break;
+        }
+        next.insert(defSlice->begin(), defSlice->end());
+        next.insert(def);
+      }
+      if (!pure) {
+        emitMissedRemark(loadOp, "tritongpu-pipeline",
+                         "not pipelined: the address of the next iteration "
+                         "depends on loads or ops with side effects");
+        continue;
+      }
+
+      loads.push_back(loadOp);
+      loadSlice.insert(slice->begin(), slice->end());
+      nextSlice.insert(next.begin(), next.end());
+      depArgs.insert(args.begin(), args.end());
+    }
+    return success(!loads.empty());
+  }
+
+  /// Load the first tiles in front of the loop and create the new loop
+  /// carrying the staged tiles. Returns the new loop
+  scf::ForOp createNewForOp() {
+    OpBuilder builder(forOp);
+    auto loc = forOp.getLoc();
+
+    // Prologue, predicated on the loop running at all
+    IRMapping prologueMapping;
+    prologueMapping.map(forOp.getInductionVar(), forOp.getLowerBound());
+    for (BlockArgument arg : forOp.getRegionIterArgs())
+      prologueMapping.map(arg, forOp.getOpOperandForRegionIterArg(arg).get());
+    Value runs = builder.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::slt, forOp.getLowerBound(),
+        forOp.getUpperBound());
+    auto firstTiles = cloneLoads(builder, prologueMapping, runs);
+
+    SmallVector<Value> newLoopArgs(forOp.getInitArgs());
+    newLoopArgs.append(firstTiles);
+    auto newForOp = builder.create<scf::ForOp>(
+        loc, forOp.getLowerBound(), forOp.getUpperBound(), forOp.getStep(),
+        newLoopArgs);
+    newForOp->setAttrs(forOp->getAttrs());
+
+    builder.setInsertionPointToStart(newForOp.getBody());
+    IRMapping mapping;
+    mapping.map(forOp.getInductionVar(), newForOp.getInductionVar());
+    for (auto [arg, newArg] : llvm::zip(forOp.getRegionIterArgs(),
+                                        newForOp.getRegionIterArgs()))
+      mapping.map(arg, newArg);
+    unsigned numArgs = forOp.getNumRegionIterArgs();
+    for (auto [idx, loadOp] : llvm::enumerate(loads))
+      mapping.map(loadOp.getResult(),
+                  newForOp.getRegionIterArgs()[numArgs + idx]);
+
+    // The tiles of the next iteration are loaded in front of the first dot,
+    // or at the end of the body if there is none
+    Operation *prefetchPoint = yieldOp;
+    for (Operation &op : forOp.getBody()->without_terminator())
+      if (isa<triton::DotOp>(op)) {
+        prefetchPoint = &op;
+        break;
+      }
+
+    // Ops of the body that are cloned ahead of their position
+    auto isCloned = [&](Operation *op) {
+      return op->getNumResults() != 0 &&
+             llvm::all_of(op->getResults(), [&](Value result) {
+               return mapping.contains(result);
+             });
+    };
+
+    SmallVector<Value> nextTiles;
+    auto emitPrefetch = [&]() {
+      // The next values of the iter args are computed here, and the ops
+      // computing them are not cloned again at their own position
+      for (Operation *op : topologicalSort(nextSlice))
+        if (!isCloned(op))
+          builder.clone(*op, mapping);
+      IRMapping nextMapping;
+      for (BlockArgument arg : depArgs) {
+        Value yielded = yieldOp->getOperand(arg.getArgNumber() - 1);
+        nextMapping.map(arg, mapping.lookupOrDefault(yielded));
+      }
+      Value nextIV = builder.create<arith::AddIOp>(
+          loc, newForOp.getInductionVar(), newForOp.getStep());
+      nextMapping.map(forOp.getInductionVar(), nextIV);
+      Value inBounds = builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::slt, nextIV, newForOp.getUpperBound());
+      nextTiles = cloneLoads(builder, nextMapping, inBounds);
+    };
+
+    for (Operation &op : forOp.getBody()->without_terminator()) {
+      if (&op == prefetchPoint)
+        emitPrefetch();
+      if (auto loadOp = dyn_cast<triton::LoadOp>(op);
+          (loadOp && llvm::is_contained(loads, loadOp)) || isCloned(&op))
+        continue;
+      builder.clone(op, mapping);
+    }
+    if (prefetchPoint == yieldOp)
+      emitPrefetch();
+
+    SmallVector<Value> yieldValues;
+    for (Value v : yieldOp->getOperands())
+      yieldValues.push_back(mapping.lookupOrDefault(v));
+    yieldValues.append(nextTiles);
+    builder.create<scf::YieldOp>(yieldOp.getLoc(), yieldValues);
+    return newForOp;
+  }
+};
+
 // ref: mlir/lib/Dialect/SCF/Transforms/LoopPipelining.cpp
 struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
   PipelinePass() = default;
-  PipelinePass(int numStages) { this->numStages = numStages; }
+  PipelinePass(int numStages, bool registerStaging, bool pipelineNonDotLoads) {
+    this->numStages = numStages;
+    this->registerStaging = registerStaging;
+    this->pipelineNonDotLoads = pipelineNonDotLoads;
+  }
+
+  // Stage the loads of every loop through registers
+  void runRegisterPipeliner() {
+    getOperation()->walk([&](scf::ForOp forOp) {
+      if (forOp->hasAttr("tt.no_pipeline"))
+        return;
+      RegisterPipeliner pipeliner(forOp);
+      if (pipeliner.initialize().failed())
+        return;
+      scf::ForOp newForOp = pipeliner.createNewForOp();
+      for (unsigned i = 0; i < forOp->getNumResults(); ++i)
+        forOp->getResult(i).replaceAllUsesWith(newForOp->getResult(i));
+      forOp->erase();
+    });
+  }
 
   void runOnOperation() override {
     int numStages = this->numStages;
 
-    if (numStages <= 1)
+    // The descriptor loads left after pipelining are copied synchronously
+    auto expandDescriptorLoads = [&]() {
+      SmallVector<triton::DescriptorLoadOp> descLoads;
+      getOperation()->walk(
+          [&](triton::DescriptorLoadOp op) { descLoads.push_back(op); });
+      for (auto op : descLoads)
+        expandDescriptorLoad(op);
+    };
+
+    if (numStages <= 1) {
+      expandDescriptorLoads();
+      return;
+    }
+
+    // Register double buffering has two stages, whatever numStages is
+    if (registerStaging) {
+      expandDescriptorLoads();
+      runRegisterPipeliner();
       return;
+    }
 
     // Pre-processing
     // we make sure element-wise ops are done *after* the conversion
@@ -770,12 +1279,42 @@ struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
     // auto didPreprocess =
     //     applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
 
+    // The axis info of the function is computed once and shared by all loops.
+    // Pipelining a loop only creates new values inside the new loop and for
+    // its results. Loops are visited inner to outer, so the already computed
+    // info only goes stale if the results are used in another loop, which
+    // may be visited later.
+    std::unique_ptr<DataFlowSolver> solver;
+    AxisInfoAnalysis *axisInfoAnalysis = nullptr;
+    bool stale = true;
+    auto solve = [&]() -> LogicalResult {
+      auto start = std::chrono::steady_clock::now();
+      solver = createDataFlowSolver();
+      axisInfoAnalysis = solver->load<AxisInfoAnalysis>();
+      auto result = solver->initializeAndRun(getOperation());
+      axisInfoSolveMicros +=
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count();
+      ++numAxisInfoSolves;
+      stale = false;
+      return result;
+    };
+
     // Do the pipelining
-    getOperation()->walk([&](scf::ForOp forOp) -> void {
-      LoopPipeliner pipeliner(forOp, numStages);
+    getOperation()->walk([&](scf::ForOp forOp) -> WalkResult {
+      // e.g. the tile loop of a persistent kernel
+      if (forOp->hasAttr("tt.no_pipeline"))
+        return WalkResult::advance();
+
+      if (stale && failed(solve()))
+        return WalkResult::interrupt();
+
+      LoopPipeliner pipeliner(forOp, numStages, pipelineNonDotLoads,
+                              axisInfoAnalysis);
 
       if (pipeliner.initialize().failed())
-        return;
+        return WalkResult::advance();
 
       pipeliner.emitPrologue();
 
@@ -783,14 +1322,24 @@ struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
       pipeliner.emitEpilogue();
 
       // replace the original loop
-      for (unsigned i = 0; i < forOp->getNumResults(); ++i)
+      for (unsigned i = 0; i < forOp->getNumResults(); ++i) {
+        for (Operation *user : forOp->getResult(i).getUsers())
+          if (user->getParentOfType<scf::ForOp>())
+            stale = true;
         forOp->getResult(i).replaceAllUsesWith(newForOp->getResult(i));
+      }
       forOp->erase();
+      return WalkResult::advance();
     });
+
+    expandDescriptorLoads();
   }
 };
 } // anonymous namespace
 
-std::unique_ptr<Pass> mlir::createTritonGPUPipelinePass(int numStages) {
-  return std::make_unique<PipelinePass>(numStages);
+std::unique_ptr<Pass>
+mlir::createTritonGPUPipelinePass(int numStages, bool registerStaging,
+                                  bool pipelineNonDotLoads) {
+  return std::make_unique<PipelinePass>(numStages, registerStaging,
+                                        pipelineNonDotLoads);
 }
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+// This pass issues the first dot of a chain of two dots in a loop one
+// iteration ahead, like the QK^T of the online-softmax loop of attention,
+// whose result the A operand of the second dot, PV, is computed from.
+// The first dot of the next block is then computed in the same iteration as
+// the softmax of the current one, which it does not depend on, so that the
+// instructions of both can be interleaved rather than wait on each other.
+//
+// For example:
+// %r = scf.for %i = %lb to %ub step %s iter_args(%acc = %acc0, %k = %k0) {
+//   %qk = tt.dot %q, %k, %zero
+//   %p = softmax(%qk)
+//   %d = tt.dot %p, %v, %acc
+//   %k_next = ...
+//   scf.yield %d, %k_next
+// }
+//
+// will be translated to
+//
+// %qk0 = tt.dot %q, %k0, %zero
+// %r = scf.for %i = %lb to %ub step %s
+//     iter_args(%acc = %acc0, %k = %k0, %qk = %qk0) {
+//   %p = softmax(%qk)
+//   %d = tt.dot %p, %v, %acc
+//   %k_next = ...
+//   %qk_next = tt.dot %q, %k_next, %zero
+//   scf.yield %d, %k_next, %qk_next
+// }
+//
+// The operands of the first dot have to be computed without side effects
+// from the values the loop carries, e.g. from the shared memory slots the
+// pipeliner loads them into, since they are computed once more than the
+// loop runs.
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+// Returns the ops of the body of `forOp` that `value` is computed from, in
+// the order they are defined.
+SetVector<Operation *> getBodySlice(scf::ForOp forOp, Value value) {
+  SetVector<Operation *> slice;
+  getBackwardSlice(value, &slice, [&](Operation *op) {
+    return op->getBlock() == forOp.getBody();
+  });
+  return slice;
+}
+
+// Returns the first dot of a chain of two dots of the body of `forOp`.
+triton::DotOp getChainHead(scf::ForOp forOp) {
+  for (auto dotOp : forOp.getBody()->getOps<triton::DotOp>())
+    for (Operation *op : getBodySlice(forOp, dotOp.getA()))
+      if (auto headOp = dyn_cast<triton::DotOp>(op))
+        return headOp;
+  return nullptr;
+}
+
+struct PipelineChainedDotsPass
+    : public TritonGPUPipelineChainedDotsBase<PipelineChainedDotsPass> {
+  void runOnOperation() override {
+    SmallVector<scf::ForOp> loops;
+    getOperation()->walk([&](scf::ForOp forOp) { loops.push_back(forOp); });
+    for (scf::ForOp forOp : loops) {
+      triton::DotOp headOp = getChainHead(forOp);
+      if (!headOp)
+        continue;
+      SetVector<Operation *> slice = getBodySlice(forOp, headOp.getResult());
+      slice.remove(headOp);
+      if (llvm::any_of(slice, [](Operation *op) {
+            return op->getNumRegions() != 0 || !isMemoryEffectFree(op);
+          })) {
+        emitMissedRemark(headOp, "tritongpu-pipeline-chained-dots",
+                         "dot not issued an iteration ahead: its operands "
+                         "are loaded in the loop rather than pipelined");
+        continue;
+      }
+      pipelineChainHead(forOp, headOp, slice);
+      ++numPipelinedChains;
+    }
+  }
+
+  void pipelineChainHead(scf::ForOp forOp, triton::DotOp headOp,
+                         const SetVector<Operation *> &slice) {
+    auto cloneHead = [&](OpBuilder &builder, IRMapping &mapping) {
+      for (Operation *op : slice)
+        builder.clone(*op, mapping);
+      return builder.clone(*headOp, mapping)->getResult(0);
+    };
+
+    // The result of the first iteration
+    OpBuilder builder(forOp);
+    IRMapping prologueMapping;
+    for (auto [arg, init] :
+         llvm::zip(forOp.getRegionIterArgs(), forOp.getIterOperands()))
+      prologueMapping.map(arg, init);
+    prologueMapping.map(forOp.getInductionVar(), forOp.getLowerBound());
+    SmallVector<Value> loopArgs = llvm::to_vector(forOp.getIterOperands());
+    loopArgs.push_back(cloneHead(builder, prologueMapping));
+
+    auto newForOp = builder.create<scf::ForOp>(
+        forOp.getLoc(), forOp.getLowerBound(), forOp.getUpperBound(),
+        forOp.getStep(), loopArgs);
+    builder.setInsertionPointToStart(newForOp.getBody());
+    IRMapping mapping;
+    for (auto [arg, newArg] :
+         llvm::zip(forOp.getRegionIterArgs(), newForOp.getRegionIterArgs()))
+      mapping.map(arg, newArg);
+    mapping.map(forOp.getInductionVar(), newForOp.getInductionVar());
+    mapping.map(headOp.getResult(), newForOp.getRegionIterArgs().back());
+    for (Operation &op : forOp.getBody()->without_terminator())
+      if (&op != headOp.getOperation())
+        builder.clone(op, mapping);
+
+    // The result of the next iteration, from the values it is entered with
+    auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+    SmallVector<Value> yieldValues;
+    for (Value value : yieldOp.getOperands())
+      yieldValues.push_back(mapping.lookupOrDefault(value));
+    IRMapping nextMapping = mapping;
+    for (auto [arg, value] :
+         llvm::zip(forOp.getRegionIterArgs(), yieldValues))
+      nextMapping.map(arg, value);
+    auto nextIV = builder.create<arith::AddIOp>(
+        forOp.getLoc(), newForOp.getInductionVar(), newForOp.getStep());
+    nextMapping.map(forOp.getInductionVar(), nextIV);
+    yieldValues.push_back(cloneHead(builder, nextMapping));
+    if (nextIV->use_empty())
+      nextIV->erase();
+    builder.create<scf::YieldOp>(yieldOp.getLoc(), yieldValues);
+
+    // The operands of the first dot may only have been computed for it
+    for (Operation *op : llvm::reverse(slice)) {
+      Operation *newOp = mapping.lookup(op->getResult(0)).getDefiningOp();
+      if (newOp->use_empty())
+        newOp->erase();
+    }
+
+    for (unsigned i = 0; i < forOp->getNumResults(); ++i)
+      forOp->getResult(i).replaceAllUsesWith(newForOp->getResult(i));
+    forOp->erase();
+  }
+};
+
+} // anonymous namespace
+
+std::unique_ptr<Pass> mlir::createTritonGPUPipelineChainedDotsPass() {
+  return std::make_unique<PipelineChainedDotsPass>();
+}
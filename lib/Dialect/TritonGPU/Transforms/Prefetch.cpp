@@ -24,6 +24,10 @@
 //   ...
 //   scf.yield %next_a, ..., %a_prefetch_next
 // }
+//
+// With a distance of N, the first N K-slices are prefetched, each through its
+// own iter arg. The width of the slices is the K of one instruction of the
+// dot: 16 bytes for mma, and as wide as the tile allows for FMA.
 //===----------------------------------------------------------------------===//
 
 #include "mlir/IR/IRMapping.h"
@@ -43,8 +47,11 @@ class Prefetcher {
   scf::ForOp forOp;
   /// cache the YieldOp of this ForOp
   scf::YieldOp yieldOp;
+  /// number of K-slices prefetched during the previous iteration
+  unsigned distance;
+  /// K-width of the slices, 0 to infer it from the dot
+  unsigned sliceWidth;
   ///
-  // TODO: add a hook to infer prefetchWidth
   unsigned prefetchWidth = 16;
 
   /// dots to be prefetched
@@ -56,11 +63,13 @@ class Prefetcher {
   DenseMap<Value, Value> dot2bHeaderDef;
   DenseMap<Value, Value> dot2aYield;
   DenseMap<Value, Value> dot2bYield;
-  /// operand => defining
-  DenseMap<Value, Value> operand2headPrefetch;
+  /// operand => prefetched slices
+  DenseMap<Value, SmallVector<Value>> operand2headPrefetch;
 
   LogicalResult isForOpOperand(Value v);
 
+  std::optional<unsigned> getPrefetchWidth(triton::DotOp dot);
+
   Value generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
                          Attribute dotEncoding, OpBuilder &builder,
                          std::optional<int64_t> offsetK = std::nullopt,
@@ -69,7 +78,8 @@ class Prefetcher {
 public:
   Prefetcher() = delete;
 
-  Prefetcher(scf::ForOp forOp) : forOp(forOp) {
+  Prefetcher(scf::ForOp forOp, unsigned distance, unsigned sliceWidth)
+      : forOp(forOp), distance(distance), sliceWidth(sliceWidth) {
     yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
   }
 
@@ -118,6 +128,41 @@ Value Prefetcher::generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
   return prefetchSlice;
 }
 
+// Returns the K-width of the slices of the operands of `dot`, or nothing if
+// they cannot be prefetched.
+std::optional<unsigned> Prefetcher::getPrefetchWidth(triton::DotOp dot) {
+  auto aType = dot.getA().getType().cast<RankedTensorType>();
+  int64_t kSize = aType.getShape()[1];
+  unsigned elementWidth = aType.getElementTypeBitWidth();
+  Attribute dotEncoding = dot.getType().cast<RankedTensorType>().getEncoding();
+
+  // K of one instruction, which a slice must be a multiple of
+  unsigned minWidth;
+  if (auto mmaLayout = dotEncoding.dyn_cast<triton::gpu::MmaEncodingAttr>()) {
+    // wgmma reads its operands from shared memory, there is nothing to
+    // prefetch into registers
+    if (mmaLayout.isHopper())
+      return std::nullopt;
+    // mma.884 on Volta, mma.16816 (or its tf32/int8 variants) otherwise
+    minWidth = mmaLayout.isVolta() ? 4 : 256 / elementWidth;
+  } else if (dotEncoding.isa<triton::gpu::MfmaEncodingAttr>()) {
+    // v_mfma_f32_32x32x8
+    minWidth = 8;
+  } else if (dotEncoding.isa<triton::gpu::BlockedEncodingAttr>()) {
+    minWidth = 1;
+  } else {
+    return std::nullopt;
+  }
+
+  // works better with nvidia tensor cores
+  unsigned width = sliceWidth ? sliceWidth : 256 / elementWidth;
+  // small K tiles still get their first slices prefetched
+  width = std::min<int64_t>(width, kSize / distance);
+  if (width < minWidth || width % minWidth != 0 || kSize % width != 0)
+    return std::nullopt;
+  return width;
+}
+
 LogicalResult Prefetcher::initialize() {
   Block *loop = forOp.getBody();
 
@@ -131,8 +176,13 @@ LogicalResult Prefetcher::initialize() {
 
   // TODO: segfault (original for still has uses)
   // when used in flash attention that has 2 dots in the loop
-  if (dotsInFor.size() > 1)
+  if (dotsInFor.size() > 1) {
+    for (triton::DotOp dot : dotsInFor)
+      emitMissedRemark(dot, "tritongpu-prefetch",
+                       "operands not prefetched: loops with more than one "
+                       "dot are not supported");
     return failure();
+  }
 
   // returns source of cvt
   auto getPrefetchSrc = [](Value v) -> Value {
@@ -156,21 +206,29 @@ LogicalResult Prefetcher::initialize() {
   };
 
   for (triton::DotOp dot : dotsInFor) {
-    auto kSize = dot.getA().getType().cast<RankedTensorType>().getShape()[1];
-
-    // works better with nvidia tensor cores
-    unsigned elementWidth =
-        dot.getA().getType().cast<RankedTensorType>().getElementTypeBitWidth();
-    prefetchWidth = 256 / elementWidth;
-
-    // Skip prefetching if kSize is less than prefetchWidth
-    if (kSize < prefetchWidth)
+    std::optional<unsigned> width = getPrefetchWidth(dot);
+    if (!width) {
+      emitMissedRemark(dot, "tritongpu-prefetch",
+                       "operands not prefetched: K is not divisible into "
+                       "slices of whole instructions, or the dot reads its "
+                       "operands from shared memory");
       continue;
+    }
+    prefetchWidth = *width;
+
     Value aSmem = getPrefetchSrc(dot.getA());
     Value bSmem = getPrefetchSrc(dot.getB());
+    if (!aSmem || !bSmem)
+      emitMissedRemark(dot, "tritongpu-prefetch",
+                       "operands not prefetched: they are not converted "
+                       "from shared memory");
     if (aSmem && bSmem) {
       Value aHeaderDef = getIncomingOp(aSmem);
       Value bHeaderDef = getIncomingOp(bSmem);
+      if (!aHeaderDef || !bHeaderDef)
+        emitMissedRemark(dot, "tritongpu-prefetch",
+                         "operands not prefetched: their shared memory "
+                         "buffers are not carried by the loop");
       // Only prefetch loop arg
       if (aHeaderDef && bHeaderDef) {
         dots.insert(dot);
@@ -193,14 +251,19 @@ void Prefetcher::emitPrologue() {
   for (Value dot : dots) {
     Attribute dotEncoding =
         dot.getType().cast<RankedTensorType>().getEncoding();
-    Value aPrefetched =
-        generatePrefetch(dot2aHeaderDef[dot], 0, true, dotEncoding, builder);
-    operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getA()] =
-        aPrefetched;
-    Value bPrefetched =
-        generatePrefetch(dot2bHeaderDef[dot], 1, true, dotEncoding, builder);
-    operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getB()] =
-        bPrefetched;
+    for (unsigned i = 0; i < distance; ++i) {
+      int64_t kOff = i * prefetchWidth;
+      Value aPrefetched =
+          generatePrefetch(dot2aHeaderDef[dot], 0, true, dotEncoding, builder,
+                           kOff, prefetchWidth);
+      operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getA()]
+          .push_back(aPrefetched);
+      Value bPrefetched =
+          generatePrefetch(dot2bHeaderDef[dot], 1, true, dotEncoding, builder,
+                           kOff, prefetchWidth);
+      operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getB()]
+          .push_back(bPrefetched);
+    }
   }
 }
 
@@ -211,10 +274,11 @@ scf::ForOp Prefetcher::createNewForOp() {
   for (auto v : forOp.getIterOperands())
     loopArgs.push_back(v);
   for (Value dot : dots) {
-    loopArgs.push_back(
-        operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getA()]);
-    loopArgs.push_back(
-        operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getB()]);
+    auto dotOp = dot.getDefiningOp<triton::DotOp>();
+    for (unsigned i = 0; i < distance; ++i) {
+      loopArgs.push_back(operand2headPrefetch[dotOp.getA()][i]);
+      loopArgs.push_back(operand2headPrefetch[dotOp.getB()][i]);
+    }
   }
 
   auto newForOp = builder.create<scf::ForOp>(
@@ -228,26 +292,33 @@ scf::ForOp Prefetcher::createNewForOp() {
   mapping.map(forOp.getInductionVar(), newForOp.getInductionVar());
 
   for (Operation &op : forOp.getBody()->without_terminator()) {
-    Operation *newOp = builder.clone(op, mapping);
+    Operation *newOp = nullptr;
     auto dot = dyn_cast<triton::DotOp>(&op);
-    if (dot && dots.contains(dot)) {
+    if (!dot || !dots.contains(dot)) {
+      newOp = builder.clone(op, mapping);
+    } else {
       Attribute dotEncoding =
           dot.getType().cast<RankedTensorType>().getEncoding();
-      // prefetched dot
-      Operation *firstDot = builder.clone(*dot, mapping);
-      if (Value a = operand2headPrefetch.lookup(dot.getA()))
-        firstDot->setOperand(
+      // prefetched dots
+      Operation *prevDot = nullptr;
+      for (unsigned i = 0; i < distance; ++i) {
+        Operation *prefetchedDot = builder.clone(*dot, mapping);
+        Value a = operand2headPrefetch[dot.getA()][i];
+        prefetchedDot->setOperand(
             0, newForOp.getRegionIterArgForOpOperand(*a.use_begin()));
-      if (Value b = operand2headPrefetch.lookup(dot.getB()))
-        firstDot->setOperand(
+        Value b = operand2headPrefetch[dot.getB()][i];
+        prefetchedDot->setOperand(
             1, newForOp.getRegionIterArgForOpOperand(*b.use_begin()));
+        if (prevDot)
+          prefetchedDot->setOperand(2, prevDot->getResult(0));
+        prevDot = prefetchedDot;
+      }
+      newOp = prevDot;
 
       // remaining part
-      int64_t kOff = prefetchWidth;
+      int64_t kOff = distance * prefetchWidth;
       int64_t kRem =
-          dot.getA().getType().cast<RankedTensorType>().getShape()[1] -
-          prefetchWidth;
-      Operation *prevDot = firstDot;
+          dot.getA().getType().cast<RankedTensorType>().getShape()[1] - kOff;
       while (kRem != 0) {
         // int64_t kShape = largestPow2(kRem);
         int64_t kShape = prefetchWidth;
@@ -281,10 +352,15 @@ scf::ForOp Prefetcher::createNewForOp() {
   for (Value dot : dots) {
     Attribute dotEncoding =
         dot.getType().cast<RankedTensorType>().getEncoding();
-    yieldValues.push_back(generatePrefetch(mapping.lookup(dot2aYield[dot]), 0,
-                                           true, dotEncoding, builder));
-    yieldValues.push_back(generatePrefetch(mapping.lookup(dot2bYield[dot]), 1,
-                                           true, dotEncoding, builder));
+    for (unsigned i = 0; i < distance; ++i) {
+      int64_t kOff = i * prefetchWidth;
+      yieldValues.push_back(generatePrefetch(mapping.lookup(dot2aYield[dot]),
+                                             0, true, dotEncoding, builder,
+                                             kOff, prefetchWidth));
+      yieldValues.push_back(generatePrefetch(mapping.lookup(dot2bYield[dot]),
+                                             1, true, dotEncoding, builder,
+                                             kOff, prefetchWidth));
+    }
   }
   // Update ops of yield
   if (!yieldValues.empty())
@@ -293,9 +369,18 @@ scf::ForOp Prefetcher::createNewForOp() {
 }
 
 struct PrefetchPass : public TritonGPUPrefetchBase<PrefetchPass> {
+  PrefetchPass() = default;
+  PrefetchPass(int distance, int sliceWidth) {
+    this->distance = distance;
+    this->sliceWidth = sliceWidth;
+  }
+
   void runOnOperation() override {
+    if (distance < 1 || sliceWidth < 0)
+      return;
+
     getOperation()->walk([&](scf::ForOp forOp) {
-      Prefetcher prefetcher(forOp);
+      Prefetcher prefetcher(forOp, distance, sliceWidth);
 
       if (prefetcher.initialize().failed())
         return;
@@ -314,6 +399,7 @@ struct PrefetchPass : public TritonGPUPrefetchBase<PrefetchPass> {
 
 } // anonymous namespace
 
-std::unique_ptr<Pass> mlir::createTritonGPUPrefetchPass() {
-  return std::make_unique<PrefetchPass>();
+std::unique_ptr<Pass> mlir::createTritonGPUPrefetchPass(int distance,
+                                                        int sliceWidth) {
+  return std::make_unique<PrefetchPass>(distance, sliceWidth);
 }
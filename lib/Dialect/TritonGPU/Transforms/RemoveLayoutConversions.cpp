@@ -62,7 +62,7 @@ public:
           !dstParent.isa<triton::gpu::MmaEncodingAttr>())
         return mlir::failure();
       auto dstParentMma = dstParent.cast<triton::gpu::MmaEncodingAttr>();
-      if (dstParentMma.isVolta() || dstParentMma.getWarpsPerCTA()[1] > 1)
+      if (!dstParentMma.isAmpere() || dstParentMma.getWarpsPerCTA()[1] > 1)
         return mlir::failure();
       SetVector<Operation *> bwdSlices;
       mlir::getBackwardSlice(convert.getResult(), &bwdSlices);
@@ -124,7 +124,8 @@ public:
         newOperands[0].getType().cast<RankedTensorType>().getEncoding();
 
     // this may generate unsupported conversions in the LLVM codegen
-    if (newEncoding.isa<triton::gpu::MmaEncodingAttr>()) {
+    if (newEncoding.isa<triton::gpu::MmaEncodingAttr,
+                        triton::gpu::MfmaEncodingAttr>()) {
       return failure();
     }
 
@@ -328,12 +329,56 @@ public:
   }
 };
 
+// Memoizes the net number of conversions that
+// simulateBackwardRematerialization finds for rematerializing an op in a
+// layout. The greedy driver revisits conversions after every rewrite, and
+// RematerializeForward checks the operands of every op in the forward slice
+// of a conversion, so on large fused kernels the same backward slices are
+// otherwise walked over and over. It is the listener of the driver, and
+// forgets everything whenever an op is inserted or erased, so that each
+// slice is walked at most once per change of the IR.
+class RematerializationCache : public RewriterBase::Listener {
+public:
+  int getNumConversions(Operation *op, Attribute encoding) {
+    auto key = std::make_pair(op, encoding);
+    auto it = results.find(key);
+    if (it != results.end()) {
+      ++numHits;
+      return it->second;
+    }
+    SetVector<Operation *> processed;
+    SetVector<Attribute> layout;
+    llvm::MapVector<Value, Attribute> toConvert;
+    int numCvts = simulateBackwardRematerialization(op, processed, layout,
+                                                    toConvert, encoding);
+    results[key] = numCvts;
+    return numCvts;
+  }
+
+  void notifyOperationInserted(Operation *op) override { results.clear(); }
+  void notifyOperationRemoved(Operation *op) override { results.clear(); }
+
+  // conversions considered by RematerializeForward and RematerializeBackward
+  unsigned numCandidates = 0;
+  // ops cloned into another layout by them
+  unsigned numClonedOps = 0;
+  // slices whose simulation was reused
+  unsigned numHits = 0;
+
+private:
+  DenseMap<std::pair<Operation *, Attribute>, int> results;
+};
+
 //
 class RematerializeForward : public mlir::RewritePattern {
+  RematerializationCache &cache;
+
 public:
-  explicit RematerializeForward(mlir::MLIRContext *context)
+  explicit RematerializeForward(mlir::MLIRContext *context,
+                                RematerializationCache &cache)
       : mlir::RewritePattern(triton::gpu::ConvertLayoutOp::getOperationName(),
-                             1, context) {}
+                             1, context),
+        cache(cache) {}
 
   mlir::LogicalResult
   matchAndRewrite(mlir::Operation *cvtOp,
@@ -346,6 +391,7 @@ public:
     // XXX: why is this needed?
     if (srcEncoding.isa<triton::gpu::SliceEncodingAttr>())
       return failure();
+    ++cache.numCandidates;
     SetVector<Operation *> cvtSlices;
     auto filter = [&](Operation *op) {
       return op->getBlock() == cvt->getBlock() &&
@@ -374,18 +420,15 @@ public:
       // be removed
       for (Value arg : op->getOperands()) {
         Operation *argOp = arg.getDefiningOp();
-        SetVector<Operation *> processed;
-        SetVector<Attribute> layout;
-        llvm::MapVector<Value, Attribute> toConvert;
         if (argOp && (argOp != cvt) && cvtSlices.count(argOp) == 0 &&
-            simulateBackwardRematerialization(argOp, processed, layout,
-                                              toConvert, srcEncoding) > 0) {
+            cache.getNumConversions(argOp, srcEncoding) > 0) {
           return failure();
         }
       }
     }
 
     pushConversionForward(cvt, cvtSlices, rewriter);
+    ++cache.numClonedOps;
     return success();
   }
 };
@@ -397,10 +440,14 @@ public:
 // even if it means rematerializing all values whose definitions
 // are reachable from it without passing through any memory operation.
 class RematerializeBackward : public mlir::RewritePattern {
+  RematerializationCache &cache;
+
 public:
-  explicit RematerializeBackward(mlir::MLIRContext *context)
+  explicit RematerializeBackward(mlir::MLIRContext *context,
+                                 RematerializationCache &cache)
       : mlir::RewritePattern(triton::gpu::ConvertLayoutOp::getOperationName(),
-                             3, context) {}
+                             3, context),
+        cache(cache) {}
 
   mlir::LogicalResult
   matchAndRewrite(mlir::Operation *cvt,
@@ -420,16 +467,21 @@ public:
     auto targetType = cvt->getResultTypes()[0].cast<RankedTensorType>();
     if (targetType.getEncoding().isa<triton::gpu::DotOperandEncodingAttr>())
       return mlir::failure();
+    ++cache.numCandidates;
+    if (cache.getNumConversions(cvt, targetType.getEncoding()) > 0)
+      return mlir::failure();
     // DFS
     SetVector<Operation *> processed;
     SetVector<Attribute> layout;
     llvm::MapVector<Value, Attribute> toConvert;
-    std::vector<std::pair<Operation *, Attribute>> queue;
-    if (simulateBackwardRematerialization(cvt, processed, layout, toConvert,
-                                          targetType.getEncoding()) > 0)
-      return mlir::failure();
+    simulateBackwardRematerialization(cvt, processed, layout, toConvert,
+                                      targetType.getEncoding());
 
     IRMapping mapping;
+    cache.numClonedOps += llvm::count_if(toConvert, [&](const auto &item) {
+      Operation *def = item.first.getDefiningOp();
+      return def && processed.contains(def);
+    });
     rematerializeConversionChain(toConvert, rewriter, processed, mapping);
 
     rewriter.replaceOp(cvt, mapping.lookup(cvt->getOperand(0)));
@@ -443,8 +495,46 @@ public:
 
 class MoveConvertOutOfLoop : public mlir::RewritePattern {
 public:
-  explicit MoveConvertOutOfLoop(mlir::MLIRContext *context)
-      : mlir::RewritePattern(scf::ForOp::getOperationName(), 1, context) {}
+  explicit MoveConvertOutOfLoop(mlir::MLIRContext *context,
+                                bool useCostModel = false)
+      : mlir::RewritePattern(scf::ForOp::getOperationName(), 1, context),
+        useCostModel(useCostModel) {}
+
+  // Estimated cost of carrying iter arg `i` of `forOp` in `carriedType`: the
+  // conversions of its init value, update and result, and those its users
+  // need to get their own layout.
+  int64_t getLoopCarriedCost(scf::ForOp forOp, size_t i,
+                             RankedTensorType carriedType) const {
+    Value iterArg = forOp.getRegionIterArgs()[i];
+    auto origType = iterArg.getType().cast<RankedTensorType>();
+    Operation *yieldOp = forOp.getBody()->getTerminator();
+    int64_t outerWeight = getExecutionWeight(forOp);
+    int64_t innerWeight = getExecutionWeight(yieldOp);
+    ConversionCost cost;
+    if (carriedType != origType) {
+      cost += getConversionCost(origType, carriedType) * outerWeight;
+      if (!forOp.getResult(i).use_empty())
+        cost += getConversionCost(carriedType, origType) * outerWeight;
+      // the conversion of the update folds if it comes from `carriedType`
+      auto yieldCvt = yieldOp->getOperand(i)
+                          .getDefiningOp<triton::gpu::ConvertLayoutOp>();
+      if (!yieldCvt || yieldCvt.getSrc().getType() != carriedType)
+        cost += getConversionCost(origType, carriedType) * innerWeight;
+    }
+    bool needsOrigType = false;
+    for (Operation *user : iterArg.getUsers()) {
+      if (auto cvt = dyn_cast<triton::gpu::ConvertLayoutOp>(user))
+        cost += getConversionCost(
+                    carriedType,
+                    cvt.getResult().getType().cast<RankedTensorType>()) *
+                innerWeight;
+      else
+        needsOrigType = true;
+    }
+    if (needsOrigType)
+      cost += getConversionCost(carriedType, origType) * innerWeight;
+    return cost.total();
+  }
 
   SmallVector<Value, 4>
   rematerializeForLoop(mlir::PatternRewriter &rewriter, scf::ForOp &forOp,
@@ -537,6 +627,35 @@ public:
           cvtTargetTypes.insert(newType);
         }
       }
+      if (useCostModel) {
+        // carry the iter arg in the cheapest of the layouts it is converted
+        // to, if that beats its current one
+        int64_t bestCost = getLoopCarriedCost(
+            forOp, iterArg.index(),
+            iterArg.value().getType().cast<RankedTensorType>());
+        RankedTensorType bestType;
+        for (Type type : cvtTargetTypes) {
+          auto carriedType = type.cast<RankedTensorType>();
+          int64_t cost =
+              getLoopCarriedCost(forOp, iterArg.index(), carriedType);
+          if (cost < bestCost) {
+            bestCost = cost;
+            bestType = carriedType;
+          }
+        }
+        if (!bestType)
+          continue;
+        for (auto user : users) {
+          auto cvt = dyn_cast<triton::gpu::ConvertLayoutOp>(user);
+          if (!cvt || cvt.getResult().getType() != bestType)
+            continue;
+          auto newFor = rematerializeForLoop(rewriter, forOp, iterArg.index(),
+                                             bestType, cvt);
+          rewriter.replaceOp(forOp, newFor);
+          return success();
+        }
+        continue;
+      }
       if (cvtTargetTypes.size() != 1)
         continue;
       // TODO: check second condition
@@ -558,6 +677,9 @@ public:
     }
     return failure();
   }
+
+private:
+  bool useCostModel;
 };
 
 //
@@ -630,26 +752,68 @@ public:
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
-    ModuleOp m = getOperation();
+    triton::FuncOp f = getOperation();
+
+    ConversionCost before = estimateConversionCost(f);
+    costBefore = before.total();
+    smemBytesBefore = before.smemBytes;
 
     mlir::RewritePatternSet patterns(context);
+    RematerializationCache cache;
 
     patterns.add<SimplifyConversion>(context);
     patterns.add<SimplifyReduceCvt>(context);
-    patterns.add<RematerializeBackward>(context);
-    patterns.add<RematerializeForward>(context);
-    patterns.add<MoveConvertOutOfLoop>(context);
+    patterns.add<RematerializeBackward>(context, cache);
+    patterns.add<RematerializeForward>(context, cache);
+    patterns.add<MoveConvertOutOfLoop>(context, useCostModel);
     patterns.add<MoveConvertOutOfIf>(context);
     patterns.add<DecomposeDotOperand>(context);
     patterns.add<ConvertDotConvert>(context);
 
-    if (mlir::applyPatternsAndFoldGreedily(m, std::move(patterns)).failed()) {
+    GreedyRewriteConfig config;
+    config.listener = &cache;
+    if (mlir::applyPatternsAndFoldGreedily(f, std::move(patterns), config)
+            .failed()) {
       signalPassFailure();
     }
+    numRematCandidates += cache.numCandidates;
+    numRematClonedOps += cache.numClonedOps;
+    numRematCacheHits += cache.numHits;
 
-    if (fixupLoops(m).failed()) {
+    if (fixupLoops(f).failed()) {
       signalPassFailure();
     }
+
+    ConversionCost after = estimateConversionCost(f);
+    costAfter = after.total();
+    smemBytesAfter = after.smemBytes;
+
+    f.walk([&](triton::gpu::ConvertLayoutOp cvt) { remarkKept(cvt); });
+  }
+
+  // Explains why a conversion that goes through shared memory is left
+  void remarkKept(triton::gpu::ConvertLayoutOp cvt) {
+    auto srcTy = cvt.getSrc().getType().dyn_cast<RankedTensorType>();
+    auto dstTy = cvt.getResult().getType().dyn_cast<RankedTensorType>();
+    if (!srcTy || !dstTy || isSharedEncoding(cvt.getSrc()) ||
+        isSharedEncoding(cvt.getResult()) ||
+        getConversionCost(srcTy, dstTy).smemBytes == 0)
+      return;
+    Operation *def = cvt.getSrc().getDefiningOp();
+    Attribute dstEncoding = dstTy.getEncoding();
+    if (!def)
+      emitMissedRemark(cvt, "tritongpu-remove-layout-conversions",
+                       "conversion kept: its source is a block argument");
+    else if (expensiveToRemat(def, dstEncoding))
+      emitMissedRemark(cvt, "tritongpu-remove-layout-conversions",
+                       "conversion kept: its source `" +
+                           def->getName().getStringRef() +
+                           "` is too expensive to rematerialize in the "
+                           "target layout");
+    else
+      emitMissedRemark(cvt, "tritongpu-remove-layout-conversions",
+                       "conversion kept: rematerializing its source would "
+                       "need as many conversions elsewhere");
   }
 };
 
@@ -6,6 +6,7 @@
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/Verifier.h"
 #include "mlir/Interfaces/InferTypeOpInterface.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
@@ -34,6 +35,114 @@ willIncreaseRegisterPressure(triton::gpu::ConvertLayoutOp op) {
   return false;
 }
 
+static bool touchesSharedMemory(Operation *op) {
+  auto isShared = [](Type type) {
+    auto tensorType = type.dyn_cast<RankedTensorType>();
+    return tensorType && tensorType.getEncoding() &&
+           tensorType.getEncoding().isa<triton::gpu::SharedEncodingAttr>();
+  };
+  return llvm::any_of(op->getOperandTypes(), isShared) ||
+         llvm::any_of(op->getResultTypes(), isShared);
+}
+
+// Values defined by the ops of `block` that `op` uses, including from its
+// regions
+static SetVector<Value> getInBlockOperands(Block *block, Operation *op) {
+  SetVector<Value> operands;
+  op->walk([&](Operation *nested) {
+    for (Value operand : nested->getOperands()) {
+      Operation *def = operand.getDefiningOp();
+      if (def && def != op && def->getBlock() == block)
+        operands.insert(operand);
+    }
+  });
+  return operands;
+}
+
+// List-schedule the ops of `block` bottom-up, so that values are defined
+// close to their uses: among the ops whose users are all scheduled, always
+// pick the one that frees the most registers. Memory accesses keep their
+// order, and so do the ops touching shared memory, whose contents SSA values
+// don't track (e.g. a conversion from shared memory has to stay after the
+// async_wait that makes its data visible).
+static SmallVector<Operation *> getRegisterAwareSchedule(Block *block) {
+  Operation *terminator = block->getTerminator();
+  // ops that have to run before each op
+  DenseMap<Operation *, SetVector<Operation *>> predecessors;
+  Operation *lastMemOp = nullptr;
+  Operation *lastSharedOp = nullptr;
+  for (Operation &op : block->without_terminator()) {
+    SetVector<Operation *> &preds = predecessors[&op];
+    for (Value operand : getInBlockOperands(block, &op))
+      preds.insert(operand.getDefiningOp());
+    bool isMemOp = !isMemoryEffectFree(&op);
+    if (isMemOp) {
+      if (lastMemOp)
+        preds.insert(lastMemOp);
+      lastMemOp = &op;
+    }
+    if (touchesSharedMemory(&op) ||
+        (isMemOp && !isa<triton::LoadOp, triton::StoreOp>(op))) {
+      if (lastSharedOp)
+        preds.insert(lastSharedOp);
+      lastSharedOp = &op;
+    }
+  }
+  DenseMap<Operation *, unsigned> numPendingSuccessors;
+  for (auto &item : predecessors)
+    for (Operation *pred : item.second)
+      ++numPendingSuccessors[pred];
+
+  // values used by the scheduled ops, including the terminator
+  DenseSet<Value> live;
+  for (Value operand : getInBlockOperands(block, terminator))
+    live.insert(operand);
+  SmallVector<Operation *> ready;
+  for (Operation &op : block->without_terminator())
+    if (numPendingSuccessors.lookup(&op) == 0)
+      ready.push_back(&op);
+
+  auto getFreed = [&](Operation *op) {
+    int64_t freed = 0;
+    for (Value result : op->getResults())
+      if (live.contains(result))
+        freed += getNumRegisters(result);
+    for (Value operand : getInBlockOperands(block, op))
+      if (!live.contains(operand))
+        freed -= getNumRegisters(operand);
+    return freed;
+  };
+
+  SmallVector<Operation *> order;
+  while (!ready.empty()) {
+    // ready ops are in block order, so ties keep the original order
+    auto best = std::prev(ready.end());
+    int64_t bestFreed = getFreed(*best);
+    for (auto it = ready.begin(); it != std::prev(ready.end()); ++it) {
+      int64_t freed = getFreed(*it);
+      if (freed > bestFreed) {
+        best = it;
+        bestFreed = freed;
+      }
+    }
+    Operation *op = *best;
+    ready.erase(best);
+    order.push_back(op);
+    for (Value operand : getInBlockOperands(block, op))
+      live.insert(operand);
+    for (Operation *pred : predecessors.lookup(op))
+      if (--numPendingSuccessors[pred] == 0)
+        ready.insert(llvm::upper_bound(ready, pred,
+                                       [](Operation *a, Operation *b) {
+                                         return a->isBeforeInBlock(b);
+                                       }),
+                     pred);
+  }
+  std::reverse(order.begin(), order.end());
+  order.push_back(terminator);
+  return order;
+}
+
 class TritonGPUReorderInstructionsPass
     : public TritonGPUReorderInstructionsBase<
           TritonGPUReorderInstructionsPass> {
@@ -41,11 +150,11 @@ public:
   TritonGPUReorderInstructionsPass() = default;
 
   void runOnOperation() override {
-    ModuleOp m = getOperation();
+    triton::FuncOp f = getOperation();
     // Sink conversions into loops when they will increase
     // register pressure
     DenseMap<Operation *, Operation *> opToMove;
-    m.walk([&](triton::gpu::ConvertLayoutOp op) {
+    f.walk([&](triton::gpu::ConvertLayoutOp op) {
       if (!willIncreaseRegisterPressure(op))
         return;
       auto user_begin = op->user_begin();
@@ -60,7 +169,7 @@ public:
     for (auto &kv : opToMove)
       kv.first->moveBefore(kv.second);
     // Move convert(load) immediately after dependent load
-    m.walk([&](triton::gpu::ConvertLayoutOp op) {
+    f.walk([&](triton::gpu::ConvertLayoutOp op) {
       auto dstType = op.getResult().getType().cast<RankedTensorType>();
       auto dstEncoding = dstType.getEncoding();
       if (!dstEncoding.isa<triton::gpu::SharedEncodingAttr>())
@@ -72,7 +181,7 @@ public:
     });
     // Move transpositions just after their definition
     opToMove.clear();
-    m.walk([&](triton::TransOp op) {
+    f.walk([&](triton::TransOp op) {
       Operation *argOp = op.getOperand().getDefiningOp();
       if (!argOp)
         return;
@@ -80,7 +189,7 @@ public:
     });
     // Move `dot` operand so that conversions to opIdx=0 happens before
     // conversions to opIdx=1
-    m.walk([&](triton::gpu::ConvertLayoutOp op) {
+    f.walk([&](triton::gpu::ConvertLayoutOp op) {
       auto dstType = op.getResult().getType().cast<RankedTensorType>();
       auto dstEncoding =
           dstType.getEncoding().dyn_cast<triton::gpu::DotOperandEncodingAttr>();
@@ -99,7 +208,34 @@ public:
         return;
       op->moveBefore(BOp);
     });
-    return;
+    if (scheduleForRegisters)
+      rescheduleBlocks(f);
+  }
+
+private:
+  // Only blocks whose peak goes down are rescheduled
+  void rescheduleBlocks(triton::FuncOp f) {
+    SmallVector<Block *> blocks;
+    f.walk([&](Block *block) {
+      if (!block->empty() && block->mightHaveTerminator())
+        blocks.push_back(block);
+    });
+    for (Block *block : blocks) {
+      SmallVector<Operation *> origOrder =
+          llvm::to_vector(llvm::make_pointer_range(*block));
+      int64_t before = getPeakRegisters(block, origOrder);
+      peakRegsBefore.updateMax(before);
+      SmallVector<Operation *> order = getRegisterAwareSchedule(block);
+      int64_t after = getPeakRegisters(block, order);
+      if (after >= before) {
+        peakRegsAfter.updateMax(before);
+        continue;
+      }
+      peakRegsAfter.updateMax(after);
+      for (Operation *op : order)
+        op->moveBefore(block, block->end());
+      ++numRescheduledBlocks;
+    }
   }
 };
 
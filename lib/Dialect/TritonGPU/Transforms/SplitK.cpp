@@ -0,0 +1,274 @@
+//===----------------------------------------------------------------------===//
+//
+// This pass splits the K loop of matrix multiplication kernels across
+// `split-k` programs along axis 2, for problems whose M x N grid is too small
+// to fill the device. The launcher multiplies the grid along axis 2 by
+// `split-k`; each of these programs runs a contiguous chunk of the iterations
+// and atomically adds its partial sums to the output, which must therefore be
+// zero-initialized by the caller.
+//
+// For example:
+// %r:3 = scf.for %k = %lb to %ub step %s
+//     iter_args(%acc = %zero, %a_ptr = %a_init, %b_ptr = %b_init) {
+//   %d = tt.dot %a, %b, %acc
+//   %a_next = tt.addptr %a_ptr, %a_inc
+//   %b_next = tt.addptr %b_ptr, %b_inc
+//   scf.yield %d, %a_next, %b_next
+// }
+// tt.store %c_ptr, %r#0
+//
+// will be translated to
+//
+// %chunk = ceildiv(ceildiv(%ub - %lb, %s), split-k)
+// %skip = tt.get_program_id {axis = 2} * %chunk
+// %new_lb = %lb + %skip * %s
+// %new_ub = min(%ub, %new_lb + %chunk * %s)
+// %r:3 = scf.for %k = %new_lb to %new_ub step %s
+//     iter_args(%acc = %zero, %a_ptr = %a_init + %skip * %a_inc,
+//               %b_ptr = %b_init + %skip * %b_inc) {
+//   ...
+// }
+// tt.atomic_rmw fadd, %c_ptr, %r#0
+//
+// The output must have the precision of the accumulators, e.g. f32 for an f16
+// matmul. The reduction order of the partial sums is not deterministic.
+//===----------------------------------------------------------------------===//
+
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+// A K loop and what it takes to split it
+struct SplitKLoop {
+  scf::ForOp forOp;
+  // loop invariant increment of each iter arg, null for the accumulators
+  SmallVector<Value> increments;
+  // stores of the accumulators, which become atomic adds
+  SmallVector<triton::StoreOp> stores;
+};
+
+bool isAccumulator(scf::ForOp forOp, unsigned idx) {
+  auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+  auto dotOp = yieldOp.getOperand(idx).getDefiningOp<triton::DotOp>();
+  return dotOp && dotOp.getC() == forOp.getRegionIterArgs()[idx];
+}
+
+// Returns the increment of an iter arg that is advanced by a loop invariant
+// amount at each iteration, e.g. the pointers to the K slices of A and B.
+Value getLoopInvariantIncrement(scf::ForOp forOp, unsigned idx) {
+  auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+  Value arg = forOp.getRegionIterArgs()[idx];
+  Operation *def = yieldOp.getOperand(idx).getDefiningOp();
+  Value inc;
+  if (auto addPtrOp = dyn_cast_or_null<triton::AddPtrOp>(def)) {
+    if (addPtrOp.getPtr() == arg)
+      inc = addPtrOp.getOffset();
+  } else if (auto addOp = dyn_cast_or_null<arith::AddIOp>(def)) {
+    if (addOp.getLhs() == arg)
+      inc = addOp.getRhs();
+    else if (addOp.getRhs() == arg)
+      inc = addOp.getLhs();
+  }
+  if (!inc || !forOp.isDefinedOutsideOfLoop(inc))
+    return Value();
+  return inc;
+}
+
+// Returns the store of an accumulator, looking through casts. The partial
+// sums can be added together only if nothing else is computed from them.
+// Truncations are not looked through, as the partial sums would then be added
+// in the narrower type, which loses precision as K grows.
+triton::StoreOp getAccumulatorStore(Value acc) {
+  Value v = acc;
+  while (v.hasOneUse()) {
+    Operation *user = *v.getUsers().begin();
+    if (auto storeOp = dyn_cast<triton::StoreOp>(user)) {
+      if (storeOp.getValue() != v ||
+          triton::isTensorPointerType(storeOp.getPtr().getType()))
+        return nullptr;
+      return storeOp;
+    }
+    if (!isa<arith::ExtFOp, triton::gpu::ConvertLayoutOp>(user))
+      return nullptr;
+    v = user->getResult(0);
+  }
+  return nullptr;
+}
+
+LogicalResult analyzeLoop(scf::ForOp forOp, SplitKLoop &loop) {
+  loop.forOp = forOp;
+  for (unsigned i = 0; i < forOp.getNumRegionIterArgs(); ++i) {
+    Value init = forOp.getInitArgs()[i];
+    if (isAccumulator(forOp, i)) {
+      // every program starts from zero
+      if (!matchPattern(init, m_AnyZeroFloat()) && !matchPattern(init, m_Zero()))
+        return failure();
+      triton::StoreOp storeOp = getAccumulatorStore(forOp.getResult(i));
+      if (!storeOp)
+        return failure();
+      loop.increments.push_back(Value());
+      loop.stores.push_back(storeOp);
+      continue;
+    }
+    Value inc = getLoopInvariantIncrement(forOp, i);
+    if (!inc || !forOp.getResult(i).use_empty())
+      return failure();
+    loop.increments.push_back(inc);
+  }
+  return success();
+}
+
+Value castIntTo(OpBuilder &builder, Location loc, Value v, Type type) {
+  Type srcType = v.getType();
+  if (srcType == type)
+    return v;
+  if (srcType.isIndex() || type.isIndex())
+    return builder.create<arith::IndexCastOp>(loc, type, v);
+  if (srcType.getIntOrFloatBitWidth() < type.getIntOrFloatBitWidth())
+    return builder.create<arith::ExtSIOp>(loc, type, v);
+  return builder.create<arith::TruncIOp>(loc, type, v);
+}
+
+void splitLoop(SplitKLoop &loop, int splitK) {
+  scf::ForOp forOp = loop.forOp;
+  auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+  Location loc = forOp.getLoc();
+  OpBuilder builder(forOp);
+
+  Value lb = forOp.getLowerBound();
+  Value ub = forOp.getUpperBound();
+  Value step = forOp.getStep();
+  Type ivType = lb.getType();
+  Value splitId = builder.create<triton::GetProgramIdOp>(
+      loc, builder.getI32Type(), builder.getI32IntegerAttr(2));
+  splitId = castIntTo(builder, loc, splitId, ivType);
+  Value numSplits = builder.create<arith::ConstantOp>(
+      loc, builder.getIntegerAttr(ivType, splitK));
+
+  // Iterations [skip, skip + chunk) of the original loop
+  Value numIters = builder.create<arith::CeilDivSIOp>(
+      loc, builder.create<arith::SubIOp>(loc, ub, lb), step);
+  Value chunk = builder.create<arith::CeilDivSIOp>(loc, numIters, numSplits);
+  Value skip = builder.create<arith::MulIOp>(loc, splitId, chunk);
+  Value newLb = builder.create<arith::AddIOp>(
+      loc, lb, builder.create<arith::MulIOp>(loc, skip, step));
+  Value newUb = builder.create<arith::MinSIOp>(
+      loc, ub,
+      builder.create<arith::AddIOp>(
+          loc, newLb, builder.create<arith::MulIOp>(loc, chunk, step)));
+  forOp.setLowerBound(newLb);
+  forOp.setUpperBound(newUb);
+
+  // Advance the other iter args past the skipped iterations
+  for (unsigned i = 0; i < forOp.getNumRegionIterArgs(); ++i) {
+    Value inc = loop.increments[i];
+    if (!inc)
+      continue;
+    Value init = forOp.getInitArgs()[i];
+    Value offset = castIntTo(builder, loc, skip,
+                             getElementTypeOrSelf(inc.getType()));
+    if (inc.getType().isa<RankedTensorType>())
+      offset = builder.create<triton::SplatOp>(loc, inc.getType(), offset);
+    offset = builder.create<arith::MulIOp>(loc, inc, offset);
+    Value newInit;
+    if (yieldOp.getOperand(i).getDefiningOp<triton::AddPtrOp>())
+      newInit =
+          builder.create<triton::AddPtrOp>(loc, init.getType(), init, offset);
+    else
+      newInit = builder.create<arith::AddIOp>(loc, init, offset);
+    forOp->setOperand(forOp.getNumControlOperands() + i, newInit);
+  }
+
+  for (triton::StoreOp storeOp : loop.stores) {
+    OpBuilder storeBuilder(storeOp);
+    Value val = storeOp.getValue();
+    auto rmwOp = getElementTypeOrSelf(val.getType()).isa<FloatType>()
+                     ? triton::RMWOp::FADD
+                     : triton::RMWOp::ADD;
+    storeBuilder.create<triton::AtomicRMWOp>(storeOp.getLoc(), val.getType(),
+                                             rmwOp, storeOp.getPtr(), val,
+                                             storeOp.getMask());
+    storeOp->erase();
+  }
+}
+
+LogicalResult splitKernel(triton::FuncOp funcOp, int splitK,
+                          unsigned &numLoops) {
+  // Axis 2 is taken over by the splits, and the other side effects of the
+  // kernel would be repeated by each of them.
+  bool unsupported = false;
+  unsigned numStores = 0;
+  funcOp.walk([&](Operation *op) {
+    if (auto pidOp = dyn_cast<triton::GetProgramIdOp>(op))
+      unsupported |= pidOp.getAxis() == 2;
+    else if (auto numProgramsOp = dyn_cast<triton::GetNumProgramsOp>(op))
+      unsupported |= numProgramsOp.getAxis() == 2;
+    else if (isa<triton::AtomicRMWOp, triton::AtomicCASOp>(op))
+      unsupported = true;
+    else if (isa<triton::StoreOp>(op))
+      ++numStores;
+  });
+  if (unsupported)
+    return failure();
+
+  SmallVector<SplitKLoop> loops;
+  unsigned numAccStores = 0;
+  for (auto forOp : funcOp.getBody().getOps<scf::ForOp>()) {
+    bool isKLoop = false;
+    for (unsigned i = 0; i < forOp.getNumRegionIterArgs(); ++i)
+      isKLoop |= isAccumulator(forOp, i);
+    if (!isKLoop)
+      continue;
+    SplitKLoop &loop = loops.emplace_back();
+    if (failed(analyzeLoop(forOp, loop)))
+      return failure();
+    numAccStores += loop.stores.size();
+  }
+  // Plain stores would be repeated as well
+  if (loops.empty() || numAccStores != numStores)
+    return failure();
+
+  for (SplitKLoop &loop : loops)
+    splitLoop(loop, splitK);
+  numLoops += loops.size();
+  return success();
+}
+
+struct SplitKPass : public TritonGPUSplitKBase<SplitKPass> {
+  SplitKPass() = default;
+  SplitKPass(int splitK) { this->splitK = splitK; }
+
+  void runOnOperation() override {
+    if (splitK <= 1)
+      return;
+
+    triton::FuncOp funcOp = getOperation();
+    // The launcher multiplies the grid of every kernel of the module, so all
+    // of them have to be split.
+    if (!funcOp.isPublic())
+      return;
+    unsigned numLoops = 0;
+    if (failed(splitKernel(funcOp, splitK, numLoops))) {
+      funcOp.emitError("cannot split the K loop of this kernel: it must "
+                       "accumulate tt.dot from zero in top-level loops, "
+                       "only store the accumulators without truncating them, "
+                       "and not use axis 2");
+      return signalPassFailure();
+    }
+    numSplitKLoops += numLoops;
+  }
+};
+
+} // anonymous namespace
+
+std::unique_ptr<Pass> mlir::createTritonGPUSplitKPass(int splitK) {
+  return std::make_unique<SplitKPass>(splitK);
+}
@@ -1,5 +1,7 @@
 #include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
 #include "mlir/IR/IRMapping.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include <algorithm>
@@ -12,8 +14,8 @@ using namespace mlir::triton::gpu;
 // TypeConverter
 //
 TritonGPUTypeConverter::TritonGPUTypeConverter(MLIRContext *context,
-                                               int numWarps)
-    : context(context), numWarps(numWarps) {
+                                               int numWarps, int threadsPerWarp)
+    : context(context), numWarps(numWarps), threadsPerWarp(threadsPerWarp) {
   addConversion([](Type type) { return type; });
   addConversion([this](RankedTensorType tensorType) -> RankedTensorType {
     // types with encoding are already in the right format
@@ -24,12 +26,17 @@ TritonGPUTypeConverter::TritonGPUTypeConverter(MLIRContext *context,
     //   - 1 element per thread
     //   - order = arange(rank)
     ArrayRef<int64_t> shape = tensorType.getShape();
+    auto it = shapeEncodings.find(SmallVector<int64_t>(shape));
+    if (it != shapeEncodings.end())
+      return RankedTensorType::get(shape, tensorType.getElementType(),
+                                   it->second);
     int rank = shape.size();
     llvm::SmallVector<unsigned> order(rank);
     std::iota(order.begin(), order.end(), 0);
     llvm::SmallVector<unsigned> sizePerThread(rank, 1);
     Attribute encoding = triton::gpu::BlockedEncodingAttr::get(
-        this->context, shape, sizePerThread, order, this->numWarps);
+        this->context, shape, sizePerThread, order, this->numWarps,
+        this->threadsPerWarp);
     return RankedTensorType::get(shape, tensorType.getElementType(), encoding);
   });
 
@@ -67,6 +74,75 @@ TritonGPUTypeConverter::TritonGPUTypeConverter(MLIRContext *context,
   });
 }
 
+bool TritonGPUTypeConverter::setShapeEncoding(ArrayRef<int64_t> shape,
+                                              Attribute encoding) {
+  return shapeEncodings.try_emplace(SmallVector<int64_t>(shape), encoding)
+      .second;
+}
+
+//
+// Coalesced layouts
+//
+template <class T> static SmallVector<unsigned, 4> argSort(const T &arr) {
+  SmallVector<unsigned, 4> ret(arr.size());
+  std::iota(ret.begin(), ret.end(), 0);
+  std::sort(ret.begin(), ret.end(),
+            [&](unsigned x, unsigned y) { return arr[x] > arr[y]; });
+  return ret;
+}
+
+Attribute mlir::getCoalescedEncoding(MLIRContext *context,
+                                     AxisInfoAnalysis &axisInfo, Value ptr,
+                                     int numWarps, int threadsPerWarp) {
+  auto origType = ptr.getType().cast<RankedTensorType>();
+  // Get the shape of the tensor.
+  size_t rank = origType.getRank();
+  dataflow::Lattice<AxisInfo> *latticeElement =
+      axisInfo.getLatticeElement(ptr);
+  AxisInfo info = latticeElement ? latticeElement->getValue() : AxisInfo();
+  // Get the contiguity order of `ptr`
+  auto order = argSort(info.getContiguity());
+  // The desired divisibility is the maximum divisibility
+  // among all dependent pointers who have the same order as
+  // `ptr`
+  SetVector<Value> withSameOrder;
+  withSameOrder.insert(ptr);
+  if (ptr.getDefiningOp())
+    for (Operation *op : mlir::multiRootGetSlice(ptr.getDefiningOp())) {
+      for (Value val : op->getResults()) {
+        if (val.getType() != origType)
+          continue;
+        auto valInfo = axisInfo.getLatticeElement(val);
+        auto currOrder = argSort(valInfo->getValue().getContiguity());
+        if (order == currOrder)
+          withSameOrder.insert(val);
+      }
+    }
+  int numElems = product(origType.getShape());
+  int numThreads = numWarps * threadsPerWarp;
+  int numElemsPerThread = std::max(numElems / numThreads, 1);
+  // Thread tile size depends on memory alignment
+  SmallVector<unsigned, 4> sizePerThread(rank, 1);
+  unsigned elemNumBits = triton::getPointeeBitWidth(origType);
+  unsigned elemNumBytes = std::max(elemNumBits / 8, 1u);
+  unsigned perThread = 1;
+  for (Value val : withSameOrder) {
+    AxisInfo info = axisInfo.getLatticeElement(val)->getValue();
+    unsigned maxMultipleBytes = info.getDivisibility(order[0]);
+    unsigned maxMultiple = std::max(maxMultipleBytes / elemNumBytes, 1u);
+    unsigned maxContig = info.getContiguity(order[0]);
+    unsigned alignment = std::min(maxMultiple, maxContig);
+    unsigned currPerThread = std::min(alignment, 128 / elemNumBits);
+    perThread = std::max(perThread, currPerThread);
+  }
+  sizePerThread[order[0]] = std::min<int>(perThread, numElemsPerThread);
+  // create encoding
+  Attribute encoding = triton::gpu::BlockedEncodingAttr::get(
+      context, origType.getShape(), sizePerThread, order, numWarps,
+      threadsPerWarp);
+  return encoding;
+}
+
 //
 // TritonGPUConversion
 //
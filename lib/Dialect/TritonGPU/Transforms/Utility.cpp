@@ -1,6 +1,7 @@
 #include "Utility.h"
 #include "mlir/Analysis/SliceAnalysis.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "triton/Analysis/Utility.h"
@@ -54,11 +55,11 @@ public:
 
 } // namespace
 
-LogicalResult fixupLoops(ModuleOp mod) {
-  auto *ctx = mod.getContext();
+LogicalResult fixupLoops(Operation *op) {
+  auto *ctx = op->getContext();
   mlir::RewritePatternSet patterns(ctx);
   patterns.add<FixupLoop>(ctx);
-  if (applyPatternsAndFoldGreedily(mod, std::move(patterns)).failed())
+  if (applyPatternsAndFoldGreedily(op, std::move(patterns)).failed())
     return failure();
   return success();
 }
@@ -96,12 +97,13 @@ bool expensiveLoadOrStore(Operation *op, Attribute &targetEncoding) {
   // Case 1b: Tensor of pointers has more threads than elements
   // we can presume a high hit-rate that makes it cheap to load
   auto ptrType = op->getOperand(0).getType().cast<RankedTensorType>();
+  auto mod = op->getParentOfType<ModuleOp>();
   IntegerAttr numWarps =
-      op->getParentOfType<ModuleOp>()->getAttrOfType<IntegerAttr>(
-          "triton_gpu.num-warps");
+      mod->getAttrOfType<IntegerAttr>("triton_gpu.num-warps");
   if (numWarps) {
     int sizePerThread = triton::gpu::getElemsPerThread(ptrType);
-    if (ptrType.getNumElements() < numWarps.getInt() * 32)
+    int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    if (ptrType.getNumElements() < numWarps.getInt() * threadsPerWarp)
       return false;
   }
   // auto ptr = op->getOperand(0);
@@ -135,12 +137,16 @@ bool expensiveToRemat(Operation *op, Attribute &targetEncoding) {
   if (isa<triton::LoadOp, triton::StoreOp>(op))
     return expensiveLoadOrStore(op, targetEncoding);
   if (isa<tensor::ExtractSliceOp, triton::gpu::AllocTensorOp,
-          triton::gpu::InsertSliceAsyncOp, triton::AtomicRMWOp,
-          triton::AtomicCASOp, triton::DotOp>(op))
+          triton::gpu::InsertSliceAsyncOp, triton::gpu::InsertSliceTMAOp,
+          triton::DescriptorLoadOp, triton::AtomicRMWOp, triton::AtomicCASOp,
+          triton::DotOp>(op))
     return true;
   if (isa<scf::YieldOp, scf::ForOp, scf::IfOp, scf::WhileOp, scf::ConditionOp>(
           op))
     return true;
+  // Scans are only lowered from blocked layouts
+  if (isa<triton::ScanOp>(op))
+    return !targetEncoding.isa<triton::gpu::BlockedEncodingAttr>();
   return false;
 }
 
@@ -226,6 +232,108 @@ Operation *cloneWithInferType(mlir::PatternRewriter &rewriter, Operation *op,
   return newOp;
 }
 
+static int64_t getElemBytes(Type eltTy) {
+  if (eltTy.isa<triton::PointerType>())
+    return 8;
+  return std::max<int64_t>(1, eltTy.getIntOrFloatBitWidth() / 8);
+}
+
+// Number of elements a thread moves per shared memory access
+static int64_t getAccessVec(Attribute layout, int64_t elemBytes) {
+  int64_t vec = 1;
+  if (auto blockedLayout = layout.dyn_cast<triton::gpu::BlockedEncodingAttr>())
+    vec = blockedLayout.getSizePerThread()[blockedLayout.getOrder()[0]];
+  return std::max<int64_t>(1, std::min<int64_t>(vec, 16 / elemBytes));
+}
+
+ConversionCost getConversionCost(RankedTensorType srcTy,
+                                 RankedTensorType dstTy) {
+  ConversionCost cost;
+  Attribute srcLayout = srcTy.getEncoding();
+  Attribute dstLayout = dstTy.getEncoding();
+  if (srcLayout == dstLayout)
+    return cost;
+  int64_t elemBytes = getElemBytes(srcTy.getElementType());
+  bool srcShared = srcLayout.isa<triton::gpu::SharedEncodingAttr>();
+  bool dstShared = dstLayout.isa<triton::gpu::SharedEncodingAttr>();
+  if (srcShared && dstShared)
+    return cost;
+  // One way through shared memory, e.g. ldmatrix for dot operands
+  if (srcShared || dstShared) {
+    RankedTensorType distributedTy = srcShared ? dstTy : srcTy;
+    int64_t elems = triton::gpu::getElemsPerThread(distributedTy);
+    cost.smemBytes = elems * elemBytes;
+    cost.aluOps =
+        ceil(elems, getAccessVec(distributedTy.getEncoding(), elemBytes));
+    return cost;
+  }
+  int64_t srcElems = triton::gpu::getElemsPerThread(srcTy);
+  int64_t dstElems = triton::gpu::getElemsPerThread(dstTy);
+  // Registers are reused as is
+  if (srcLayout.isa<triton::gpu::MmaEncodingAttr>() &&
+      dstLayout.isa<triton::gpu::DotOperandEncodingAttr>() &&
+      isMmaToDotShortcut(srcTy, dstTy)) {
+    cost.aluOps = dstElems;
+    return cost;
+  }
+  // Moved within warps, without shared memory or barriers
+  if (auto shuffles = getWarpShuffleCvt(srcTy, dstTy))
+    return getShufflesCost(*shuffles);
+  // Store and load back through the scratch buffer, one round per
+  // repetition of the larger of the two layouts
+  cost.smemBytes = (srcElems + dstElems) * elemBytes;
+  cost.aluOps = ceil(srcElems, getAccessVec(srcLayout, elemBytes)) +
+                ceil(dstElems, getAccessVec(dstLayout, elemBytes));
+  auto shape = srcTy.getShape();
+  auto srcShapePerCTA = triton::gpu::getShapePerCTA(srcLayout, shape);
+  auto dstShapePerCTA = triton::gpu::getShapePerCTA(dstLayout, shape);
+  int64_t reps = 1;
+  for (unsigned d = 0; d < shape.size(); ++d) {
+    int64_t repShape =
+        std::max(std::min<int64_t>(shape[d], srcShapePerCTA[d]),
+                 std::min<int64_t>(shape[d], dstShapePerCTA[d]));
+    reps *= ceil(shape[d], repShape);
+  }
+  cost.barriers = 2 * reps;
+  return cost;
+}
+
+ConversionCost getShufflesCost(ArrayRef<WarpShuffleElem> elems) {
+  ConversionCost cost;
+  for (const WarpShuffleElem &elem : elems) {
+    // a shuffle per source element, or a move, and a select between them
+    cost.aluOps += elem.fromOtherLane ? elem.srcElems.size() : 1;
+    cost.aluOps += elem.srcElems.size() - 1;
+  }
+  return cost;
+}
+
+int64_t getExecutionWeight(Operation *op) {
+  int64_t weight = 1;
+  for (auto forOp = op->getParentOfType<scf::ForOp>(); forOp;
+       forOp = forOp->getParentOfType<scf::ForOp>()) {
+    std::optional<int64_t> lb = getConstantIntValue(forOp.getLowerBound());
+    std::optional<int64_t> ub = getConstantIntValue(forOp.getUpperBound());
+    std::optional<int64_t> step = getConstantIntValue(forOp.getStep());
+    if (lb && ub && step && *step > 0)
+      weight *= std::max<int64_t>(0, ceil(*ub - *lb, *step));
+    else
+      weight *= 8;
+  }
+  return weight;
+}
+
+ConversionCost estimateConversionCost(Operation *op) {
+  ConversionCost cost;
+  op->walk([&](triton::gpu::ConvertLayoutOp cvt) {
+    auto srcTy = cvt.getSrc().getType().dyn_cast<RankedTensorType>();
+    auto dstTy = cvt.getResult().getType().dyn_cast<RankedTensorType>();
+    if (srcTy && dstTy)
+      cost += getConversionCost(srcTy, dstTy) * getExecutionWeight(cvt);
+  });
+  return cost;
+}
+
 void rematerializeConversionChain(
     const llvm::MapVector<Value, Attribute> &toConvert,
     mlir::PatternRewriter &rewriter, SetVector<Operation *> &processed,
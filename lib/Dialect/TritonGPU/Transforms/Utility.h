@@ -2,11 +2,12 @@
 #define TRITON_LIB_DIALECT_TRITONGPU_TRANSFORMS_UTILITY_H_
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/PatternMatch.h"
+#include "triton/Analysis/Utility.h"
 #include "llvm/ADT/MapVector.h"
 
 namespace mlir {
 
-LogicalResult fixupLoops(ModuleOp mod);
+LogicalResult fixupLoops(Operation *op);
 
 // TODO: Interface
 LogicalResult invertEncoding(Attribute targetEncoding, Operation *op,
@@ -24,6 +25,45 @@ int simulateBackwardRematerialization(
 Operation *cloneWithInferType(mlir::PatternRewriter &rewriter, Operation *op,
                               IRMapping &mapping);
 
+// Rough per-thread cost of a layout conversion, following how ConvertLayoutOp
+// is lowered: distributed layouts are moved with warp shuffles when every
+// element stays within its warp, and otherwise go through shared memory in as
+// many rounds as the scratch buffer needs, with a barrier around each of them.
+struct ConversionCost {
+  // bytes written to and read from shared memory
+  int64_t smemBytes = 0;
+  // CTA-wide barriers
+  int64_t barriers = 0;
+  // shared memory accesses and register moves
+  int64_t aluOps = 0;
+
+  // in bytes of shared memory traffic
+  int64_t total() const { return smemBytes + 32 * barriers + aluOps; }
+
+  ConversionCost &operator+=(const ConversionCost &other) {
+    smemBytes += other.smemBytes;
+    barriers += other.barriers;
+    aluOps += other.aluOps;
+    return *this;
+  }
+  ConversionCost operator*(int64_t n) const {
+    return {smemBytes * n, barriers * n, aluOps * n};
+  }
+};
+
+ConversionCost getConversionCost(RankedTensorType srcTy,
+                                 RankedTensorType dstTy);
+
+// Rough per-thread cost of a conversion done with the warp shuffles `elems`
+ConversionCost getShufflesCost(ArrayRef<WarpShuffleElem> elems);
+
+// Number of times `op` runs per program, i.e. the product of the trip counts
+// of the enclosing loops, assuming 8 iterations for non-constant ones.
+int64_t getExecutionWeight(Operation *op);
+
+// Cost of all the layout conversions of `op`, weighted by how often they run
+ConversionCost estimateConversionCost(Operation *op);
+
 void rematerializeConversionChain(
     const llvm::MapVector<Value, Attribute> &toConvert,
     mlir::PatternRewriter &rewriter, SetVector<Operation *> &processed,
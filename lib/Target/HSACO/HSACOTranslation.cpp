@@ -13,6 +13,9 @@
 #include "triton/Target/LLVMIR/LLVMIRTranslation.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 
+#ifdef TRITON_HAS_LLD
+#include "lld/Common/Driver.h"
+#endif
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/IRBuilder.h"
@@ -23,6 +26,9 @@
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
@@ -30,10 +36,13 @@
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/Cloning.h"
-#include <filesystem>
 #include <iostream>
 #include <memory>
-#include <random>
+#include <mutex>
+
+#ifdef TRITON_HAS_LLD
+LLD_HAS_DRIVER(elf)
+#endif
 
 namespace {
 
@@ -97,58 +106,83 @@ std::string generate_amdgcn_assembly(llvm::Module *module,
   return amdgcn;
 }
 
+// LLD only links files, which are kept in memory-backed storage when the
+// system has it rather than in a temporary directory that may be on a
+// network filesystem
+llvm::SmallString<256> getLinkDirectory() {
+  llvm::SmallString<256> dir("/dev/shm");
+  if (!llvm::sys::fs::is_directory(dir) ||
+      llvm::sys::fs::access(dir, llvm::sys::fs::AccessMode::Write))
+    llvm::sys::path::system_temp_directory(/*ErasedOnReboot=*/true, dir);
+  return dir;
+}
+
 std::string generate_hsaco(llvm::Module *module, const std::string &triple,
                            const std::string &proc,
                            const std::string &features) {
   auto machine = initialize_module(module, triple, proc, features);
 
-  // create unique dir for kernel's binary and hsaco
-  std::error_code ec;
-  std::string kernel_name_base = "amd_triton_kernel";
-  std::filesystem::path tmp = std::filesystem::temp_directory_path();
-  std::filesystem::path kernel_dir_base(kernel_name_base);
-  llvm::SmallString<256> unique_dir;
-  ec = llvm::sys::fs::createUniqueDirectory((tmp / kernel_dir_base).string(),
-                                            unique_dir);
-  if (ec) {
-    std::cerr << "Directory for " << kernel_name_base
-              << " was not created. error code: " << ec << std::endl;
-  }
-  std::filesystem::path kernel_dir(unique_dir.data());
-  std::string kernel_name = kernel_dir.stem();
-
-  // Save GCN ISA binary.
-  std::filesystem::path isa_binary(kernel_name + ".o");
-  std::string isabin_path = (kernel_dir / isa_binary).string();
-  std::unique_ptr<llvm::raw_fd_ostream> isabin_fs(
-      new llvm::raw_fd_ostream(isabin_path, ec, llvm::sys::fs::OF_Text));
-  if (ec) {
-    std::cerr << isabin_path << " was not created. error code: " << ec
-              << std::endl;
-  }
-
-  // emit
+  // emit the GCN ISA object in memory
+  llvm::SmallVector<char, 0> isabin;
+  llvm::raw_svector_ostream stream(isabin);
   llvm::legacy::PassManager pass;
-  machine->addPassesToEmitFile(pass, *isabin_fs, nullptr,
-                               llvm::CGFT_ObjectFile);
+  machine->addPassesToEmitFile(pass, stream, nullptr, llvm::CGFT_ObjectFile);
   pass.run(*module);
 
-  // generate HASCO file
-  std::filesystem::path hsaco(kernel_name + ".hsaco");
-  std::string hsaco_path = (kernel_dir / hsaco).string();
+  llvm::SmallString<256> dir = getLinkDirectory();
+  llvm::SmallString<256> isabin_path;
+  llvm::SmallString<256> hsaco_path;
+  int isabin_fd;
+  std::error_code ec = llvm::sys::fs::createUniqueFile(
+      dir + "/amd_triton_kernel-%%%%%%.o", isabin_fd, isabin_path);
+  if (!ec)
+    ec = llvm::sys::fs::createUniqueFile(
+        dir + "/amd_triton_kernel-%%%%%%.hsaco", hsaco_path);
+  if (ec)
+    llvm::report_fatal_error("Failed to create the files to link an hsaco: " +
+                             ec.message());
+  llvm::FileRemover isabin_remover(isabin_path);
+  llvm::FileRemover hsaco_remover(hsaco_path);
+  {
+    llvm::raw_fd_ostream isabin_fs(isabin_fd, /*shouldClose=*/true);
+    isabin_fs << llvm::StringRef(isabin.data(), isabin.size());
+  }
+
   std::string error_message;
+#ifdef TRITON_HAS_LLD
+  // link the code object with the LLD library rather than by running ld.lld;
+  // lldMain keeps its state in globals, so threads link one at a time
+  llvm::raw_string_ostream error_stream(error_message);
+  std::vector<const char *> lld_args = {"ld.lld", "-shared",
+                                        isabin_path.c_str(), "-o",
+                                        hsaco_path.c_str()};
+  static std::mutex lld_mutex;
+  lld::Result lld_result;
+  {
+    std::lock_guard<std::mutex> lock(lld_mutex);
+    lld_result = lld::lldMain(lld_args, llvm::nulls(), error_stream,
+                              {{lld::Gnu, &lld::elf::link}});
+  }
+  if (lld_result.retCode || !lld_result.canRunAgain)
+    llvm::report_fatal_error("Failed to link the hsaco: " +
+                             error_stream.str());
+#else
+  // LLVM was built without the LLD libraries
   std::string lld_path = "/opt/rocm/llvm/bin/ld.lld";
   int lld_result = llvm::sys::ExecuteAndWait(
       lld_path,
       {lld_path, "-flavor", "gnu", "-shared", "-o", hsaco_path, isabin_path},
       std::nullopt, {}, 0, 0, &error_message);
-  if (lld_result) {
-    std::cout << "ld.lld execute fail: " << std::endl;
-    std::cout << error_message << std::endl;
-    std::cout << lld_result << std::endl;
-  }
-
-  return hsaco_path;
+  if (lld_result)
+    llvm::report_fatal_error("Failed to link the hsaco: " + error_message);
+#endif
+
+  auto hsaco = llvm::MemoryBuffer::getFile(hsaco_path, /*IsText=*/false,
+                                           /*RequiresNullTerminator=*/false);
+  if (!hsaco)
+    llvm::report_fatal_error("Failed to read the hsaco: " +
+                             hsaco.getError().message());
+  return (*hsaco)->getBuffer().str();
 }
 
 std::tuple<std::string, std::string>
@@ -161,10 +195,10 @@ llir_to_amdgcn_and_hsaco(llvm::Module *module, std::string gfx_arch,
   auto module_obj = llvm::CloneModule(*module);
   auto amdgcn =
       generate_amdgcn_assembly(module, gfx_triple, gfx_arch, gfx_features);
-  auto hsaco_path =
+  auto hsaco =
       generate_hsaco(module_obj.get(), gfx_triple, gfx_arch, gfx_features);
 
-  return std::make_tuple(amdgcn, hsaco_path);
+  return std::make_tuple(amdgcn, hsaco);
 }
 
 } // namespace
@@ -1,7 +1,11 @@
 #include "triton/Target/LLVMIR/LLVMIRTranslation.h"
 
 #include "mlir/Conversion/Passes.h"
+#include "mlir/Dialect/Bufferization/Transforms/Passes.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/Linalg/Passes.h"
+#include "mlir/Dialect/MemRef/Transforms/Passes.h"
 #include "mlir/ExecutionEngine/ExecutionEngine.h"
 #include "mlir/ExecutionEngine/OptUtils.h"
 #include "mlir/IR/Dialect.h"
@@ -20,14 +24,19 @@
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include <dlfcn.h>
 #include <filesystem>
 #include <iterator>
+#include <mutex>
+#include <optional>
 
 namespace mlir {
 namespace triton {
@@ -210,12 +219,52 @@ static void linkLibdevice(llvm::Module &module) {
   module.addModuleFlag(reflect);
 }
 
+// Returns the contents of the extern library at `path`, which are read once
+// per process and shared by the modules of every LLVMContext.
+static std::optional<llvm::MemoryBufferRef>
+getExternLibBuffer(llvm::StringRef path) {
+  static std::mutex mutex;
+  static llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> buffers;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = buffers.find(path);
+  if (it == buffers.end()) {
+    auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                              /*RequiresNullTerminator=*/false);
+    if (!buffer)
+      return std::nullopt;
+    it = buffers.try_emplace(path, std::move(*buffer)).first;
+  }
+  return it->second->getMemBufferRef();
+}
+
+// Loads the extern library at `path` into `ctx`. Bitcode libraries such as
+// libdevice are loaded lazily: functions are only materialized when the
+// linker pulls them in as a callee of the module, instead of parsing the
+// thousands of functions of the library for every kernel.
+static std::unique_ptr<llvm::Module> loadExternLib(llvm::StringRef path,
+                                                   llvm::LLVMContext &ctx) {
+  auto buffer = getExternLibBuffer(path);
+  if (!buffer)
+    return nullptr;
+  if (!llvm::isBitcode(
+          reinterpret_cast<const unsigned char *>(buffer->getBufferStart()),
+          reinterpret_cast<const unsigned char *>(buffer->getBufferEnd()))) {
+    llvm::SMDiagnostic err;
+    return llvm::parseIR(*buffer, err, ctx);
+  }
+  auto extMod = llvm::getLazyBitcodeModule(*buffer, ctx);
+  if (!extMod) {
+    llvm::consumeError(extMod.takeError());
+    return nullptr;
+  }
+  return std::move(*extMod);
+}
+
 static bool linkExternLib(llvm::Module &module, llvm::StringRef name,
                           llvm::StringRef path, bool isROCM) {
-  llvm::SMDiagnostic err;
   auto &ctx = module.getContext();
 
-  auto extMod = llvm::parseIRFile(path, err, ctx);
+  auto extMod = loadExternLib(path, ctx);
   if (!extMod) {
     llvm::errs() << "Failed to load " << path;
     return true;
@@ -244,7 +293,7 @@ static bool linkExternLib(llvm::Module &module, llvm::StringRef name,
 
 std::unique_ptr<llvm::Module>
 translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module,
-                      bool isROCM) {
+                      bool isROCM, int optLevel) {
   DialectRegistry registry;
   mlir::registerBuiltinDialectTranslation(registry);
   mlir::registerLLVMDialectTranslation(registry);
@@ -276,7 +325,7 @@ translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module,
   }
 
   auto optPipeline = mlir::makeOptimizingTransformer(
-      /*optLevel=*/3, /*sizeLevel=*/0,
+      /*optLevel=*/optLevel, /*sizeLevel=*/0,
       /*targetMachine=*/nullptr);
 
   if (auto err = optPipeline(llvmModule.get())) {
@@ -296,7 +345,7 @@ translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module,
 std::unique_ptr<llvm::Module>
 translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
                            mlir::ModuleOp module, int computeCapability,
-                           bool isROCM) {
+                           bool isROCM, int optLevel) {
   mlir::PassManager pm(module->getContext());
   mlir::registerPassManagerCLOptions();
   if (failed(applyPassManagerCLOptions(pm))) {
@@ -329,7 +378,7 @@ translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
     return nullptr;
   }
 
-  auto llvmIR = translateLLVMToLLVMIR(llvmContext, module, isROCM);
+  auto llvmIR = translateLLVMToLLVMIR(llvmContext, module, isROCM, optLevel);
   if (!llvmIR) {
     llvm::errs() << "Translate to LLVM IR failed";
     return nullptr;
@@ -347,6 +396,63 @@ translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
   return llvmIR;
 }
 
+std::unique_ptr<llvm::Module>
+translateLinalgToLLVMIR(llvm::LLVMContext *llvmContext,
+                        mlir::ModuleOp module, int optLevel) {
+  mlir::PassManager pm(module->getContext());
+  mlir::registerPassManagerCLOptions();
+  if (failed(applyPassManagerCLOptions(pm))) {
+    llvm::errs() << "failed to apply pass manager CL options\n";
+    return nullptr;
+  }
+  auto printingFlags = mlir::OpPrintingFlags();
+  printingFlags.elideLargeElementsAttrs(16);
+  pm.enableIRPrinting(
+      /*shouldPrintBeforePass=*/nullptr,
+      /*shouldPrintAfterPass=*/
+      [](mlir::Pass *pass, mlir::Operation *) {
+        return ::triton::tools::getBoolEnv("MLIR_ENABLE_DUMP");
+      },
+      /*printModuleScope=*/false,
+      /*printAfterOnlyOnChange=*/true,
+      /*printAfterOnlyOnFailure*/ false, llvm::dbgs(), printingFlags);
+
+  // Bufferize the remaining tensors and lower linalg to loops
+  pm.addPass(bufferization::createEmptyTensorToAllocTensorPass());
+  pm.addPass(bufferization::createOneShotBufferizePass());
+  pm.addPass(mlir::createCanonicalizerPass());
+  pm.addNestedPass<func::FuncOp>(mlir::createConvertLinalgToLoopsPass());
+  pm.addPass(mlir::createConvertVectorToSCFPass());
+  pm.addPass(mlir::createConvertSCFToCFPass());
+  pm.addPass(memref::createExpandStridedMetadataPass());
+  pm.addPass(mlir::createLowerAffinePass());
+
+  // Everything to the LLVM dialect
+  pm.addPass(mlir::createConvertMathToLibmPass());
+  pm.addPass(mlir::createConvertVectorToLLVMPass());
+  pm.addPass(mlir::createFinalizeMemRefToLLVMConversionPass());
+  pm.addPass(mlir::createArithToLLVMConversionPass());
+  pm.addPass(mlir::createConvertMathToLLVMPass());
+  pm.addPass(mlir::createConvertControlFlowToLLVMPass());
+  pm.addPass(mlir::createConvertFuncToLLVMPass());
+  pm.addPass(mlir::createReconcileUnrealizedCastsPass());
+  pm.addPass(mlir::createCanonicalizerPass());
+  pm.addPass(mlir::createCSEPass());
+
+  if (failed(pm.run(module))) {
+    llvm::errs() << "Pass execution failed";
+    return nullptr;
+  }
+
+  auto llvmIR =
+      translateLLVMToLLVMIR(llvmContext, module, /*isROCM=*/false, optLevel);
+  if (!llvmIR) {
+    llvm::errs() << "Translate to LLVM IR failed";
+    return nullptr;
+  }
+  return llvmIR;
+}
+
 void addExternalLibs(mlir::ModuleOp &module,
                      const std::vector<std::string> &names,
                      const std::vector<std::string> &paths) {
@@ -11,6 +11,8 @@
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 
+#include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
 
@@ -23,9 +25,40 @@ static void initLLVM() {
     LLVMInitializeNVPTXTarget();
     LLVMInitializeNVPTXTargetMC();
     LLVMInitializeNVPTXAsmPrinter();
+    auto &options = llvm::cl::getRegisteredOptions();
+    auto *shortPtr =
+        static_cast<llvm::cl::opt<bool> *>(options["nvptx-short-ptr"]);
+    assert(shortPtr);
+    shortPtr->setValue(true);
   });
 }
 
+// Target machines are created once per thread, processor and optimization
+// level, as modules are translated one at a time on each thread
+static llvm::TargetMachine *getTargetMachine(const std::string &triple,
+                                             const std::string &proc,
+                                             const std::string &features,
+                                             int optLevel) {
+  thread_local std::map<std::pair<std::string, int>,
+                        std::unique_ptr<llvm::TargetMachine>>
+      machines;
+  auto &machine = machines[{proc, optLevel}];
+  if (machine)
+    return machine.get();
+  std::string error;
+  auto target = llvm::TargetRegistry::lookupTarget(triple, error);
+  llvm::TargetOptions opt;
+  opt.AllowFPOpFusion = llvm::FPOpFusion::Fast;
+  opt.UnsafeFPMath = false;
+  opt.NoInfsFPMath = false;
+  opt.NoNaNsFPMath = true;
+  auto codeGenOptLevel = llvm::CodeGenOpt::getLevel(optLevel);
+  machine.reset(target->createTargetMachine(
+      triple, proc, features, opt, llvm::Reloc::PIC_, std::nullopt,
+      codeGenOptLevel.value_or(llvm::CodeGenOpt::Aggressive)));
+  return machine.get();
+}
+
 static bool findAndReplace(std::string &str, const std::string &begin,
                            const std::string &end, const std::string &target) {
   size_t startReplace = str.find(begin);
@@ -38,18 +71,13 @@ static bool findAndReplace(std::string &str, const std::string &begin,
   return true;
 }
 
-std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
+std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version,
+                                 int optLevel) {
   // LLVM version in use may not officially support target hardware.
   // Supported versions for LLVM 14 are here:
   // https://github.com/llvm/llvm-project/blob/f28c006a5895fc0e329fe15fead81e37457cb1d1/clang/include/clang/Basic/BuiltinsNVPTX.def
   int maxPTX = std::min(80, version);
   int maxCC = std::min(90, cc);
-  // options
-  auto options = llvm::cl::getRegisteredOptions();
-  auto *shortPtr =
-      static_cast<llvm::cl::opt<bool> *>(options["nvptx-short-ptr"]);
-  assert(shortPtr);
-  shortPtr->setValue(true);
   std::string sm = cc == 90 ? "sm_90a" : "sm_" + std::to_string(cc);
   // max PTX version
   int ptxMajor = maxPTX / 10;
@@ -69,17 +97,8 @@ std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
 
   // create machine
   module.setTargetTriple(triple);
-  std::string error;
-  auto target =
-      llvm::TargetRegistry::lookupTarget(module.getTargetTriple(), error);
-  llvm::TargetOptions opt;
-  opt.AllowFPOpFusion = llvm::FPOpFusion::Fast;
-  opt.UnsafeFPMath = false;
-  opt.NoInfsFPMath = false;
-  opt.NoNaNsFPMath = true;
-  llvm::TargetMachine *machine = target->createTargetMachine(
-      module.getTargetTriple(), proc, features, opt, llvm::Reloc::PIC_,
-      std::nullopt, llvm::CodeGenOpt::Aggressive);
+  llvm::TargetMachine *machine =
+      getTargetMachine(triple, proc, features, optLevel);
   // set data layout
   if (layout.empty())
     module.setDataLayout(machine->createDataLayout());
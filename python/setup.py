@@ -1,3 +1,4 @@
+import hashlib
 import os
 import platform
 import re
@@ -73,6 +74,22 @@ def get_llvm_package_info():
     return Package("llvm", name, url, "LLVM_INCLUDE_DIRS", "LLVM_LIBRARY_DIR", "LLVM_SYSPATH")
 
 
+def get_build_key(base_dir, build_type):
+    # hash of the sources and configuration of libtriton, which the runtime
+    # keys its caches with instead of hashing the shared object on start up
+    hasher = hashlib.md5()
+    hasher.update(f"{get_llvm_package_info().name}-{build_type}".encode("utf-8"))
+    paths = [os.path.join(base_dir, "CMakeLists.txt")]
+    for src_dir in ["include", "lib", "cmake", os.path.join("python", "src")]:
+        for root, _, files in os.walk(os.path.join(base_dir, src_dir)):
+            paths += [os.path.join(root, f) for f in files]
+    for path in sorted(paths):
+        hasher.update(os.path.relpath(path, base_dir).encode("utf-8"))
+        with open(path, "rb") as f:
+            hasher.update(f.read())
+    return hasher.hexdigest()
+
+
 def get_thirdparty_packages(triton_cache_path):
     packages = [get_pybind11_package_info(), get_llvm_package_info()]
     thirdparty_cmake_args = []
@@ -192,6 +209,7 @@ class CMakeBuild(build_ext):
         # configuration
         cfg = get_build_type()
         build_args = ["--config", cfg]
+        cmake_args.append("-DTRITON_BUILD_KEY=" + get_build_key(self.base_dir, cfg))
 
         if platform.system() == "Windows":
             cmake_args += [f"-DCMAKE_RUNTIME_OUTPUT_DIRECTORY_{cfg.upper()}={extdir}"]
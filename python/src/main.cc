@@ -8,4 +8,7 @@ void init_cutlass(pybind11::module &m);
 PYBIND11_MODULE(libtriton, m) {
   m.doc() = "Python bindings to the C++ Triton API";
   init_triton(m);
+#ifdef TRITON_BUILD_KEY
+  m.attr("build_key") = TRITON_BUILD_KEY;
+#endif
 }
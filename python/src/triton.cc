@@ -5,19 +5,29 @@
 
 #include "mlir/Conversion/Passes.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Transforms/Passes.h"
 
 #include "mlir/Parser/Parser.h"
 #include "mlir/Support/FileUtilities.h"
 
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Bufferization/IR/Bufferization.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlow.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Index/IR/IndexDialect.h"
 #include "mlir/Dialect/Index/IR/IndexOps.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
 #include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/Utility.h"
 #include "triton/Conversion/TritonGPUToLLVM/TritonGPUToLLVMPass.h"
+#include "triton/Conversion/TritonToLinalg/TritonToLinalg.h"
 #include "triton/Conversion/TritonToTritonGPU/TritonToTritonGPUPass.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/IR/Types.h"
@@ -29,18 +39,30 @@
 #include "triton/Tools/Sys/GetEnv.hpp"
 #include "triton/Tools/Sys/GetPlatform.hpp"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/IRReader/IRReader.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/TargetParser/Host.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "llvm/Support/SourceMgr.h"
 
 #include <Python.h>
 #include <cctype>
+#include <chrono>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <optional>
 #include <pybind11/buffer_info.h>
 #include <pybind11/functional.h>
@@ -48,10 +70,12 @@
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 #include <regex>
+#include <set>
 #include <signal.h>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 
 namespace py = pybind11;
 
@@ -61,6 +85,234 @@ enum backend_t {
   ROCM,
 };
 
+// Orders the modules loaded by compiled kernels by their last launch, from
+// the launchers and the native dispatchers alike, so that the least recently
+// launched one is unloaded when a device runs out of memory. Kernels are
+// identified by their id(), as long as their module is loaded on the device.
+class LaunchClock {
+public:
+  static void touch(const void *kernel, int device) {
+    ticks[{reinterpret_cast<uintptr_t>(kernel), device}] = ++now;
+  }
+
+  // Returns 0 for the modules launched by neither.
+  static uint64_t lastLaunch(uintptr_t kernel, int device) {
+    return ticks.lookup({kernel, device});
+  }
+
+  static void forget(uintptr_t kernel, int device) {
+    ticks.erase({kernel, device});
+  }
+
+private:
+  static inline uint64_t now = 0;
+  static inline llvm::DenseMap<std::pair<uintptr_t, int>, uint64_t> ticks;
+};
+
+// Launches the binaries of a JITFunction that are compiled already without
+// going through its Python launcher: the key of a call is computed from the
+// types, the divisibility by 16 and the equality to 1 of its arguments and
+// the values of its constexprs, and looked up in a native hash map. The key
+// is at least as fine as the one of the launcher, so a binary found for a
+// call is the one the launcher picks. Entries are checked against the cache
+// of the JITFunction on every hit, so binaries evicted from it are not
+// launched anymore, and against the generation of the loaded modules, so
+// functions whose module was unloaded are not either. Every hit marks the
+// module of the binary as the most recently launched one on the launch clock,
+// as the launcher does, so that hot kernels are not the ones unloaded to make
+// room.
+class KernelDispatcher {
+public:
+  // Called whenever a module loaded by a compiled kernel is unloaded.
+  static void invalidateHandles() { ++handleGeneration; }
+
+  KernelDispatcher(py::dict cache, std::vector<int> constexprs)
+      : cache(std::move(cache)), constexprs(constexprs.begin(),
+                                            constexprs.end()) {}
+
+  // Returns the binary launched for `args`, or None if the launcher has to
+  // handle the call.
+  py::object launch(py::tuple args, int grid0, int grid1, int grid2,
+                    int numWarps, int numStages, int splitK, bool debug,
+                    int device, py::object stream, py::object enterHook,
+                    py::object exitHook) {
+    std::vector<py::object> dtypes;
+    auto key = getKey(args, numWarps, numStages, splitK, debug, device,
+                      dtypes);
+    if (!key)
+      return py::none();
+    auto it = entries.find(*key);
+    if (it == entries.end())
+      return py::none();
+    Entry &entry = it->second;
+    if (entry.generation != handleGeneration || !isCached(entry, device) ||
+        !hasConstants(entry, args)) {
+      entries.erase(it);
+      return py::none();
+    }
+    LaunchClock::touch(entry.bin.ptr(), device);
+
+    size_t numRegular = args.size() - constexprs.size();
+    py::tuple callArgs(10 + numRegular);
+    size_t pos = 0;
+    auto set = [&](py::object value) {
+      PyTuple_SET_ITEM(callArgs.ptr(), pos++, value.release().ptr());
+    };
+    set(py::int_(grid0));
+    set(py::int_(grid1));
+    set(py::int_(grid2));
+    set(py::int_(entry.numWarps));
+    set(py::int_(entry.shared));
+    set(stream);
+    set(entry.cuFunction);
+    set(enterHook);
+    set(exitHook);
+    set(entry.bin);
+    for (size_t i = 0; i < args.size(); ++i)
+      if (!constexprs.count(i))
+        set(py::reinterpret_borrow<py::object>(args[i]));
+    PyObject *result =
+        PyObject_Call(entry.cWrapper.ptr(), callArgs.ptr(), nullptr);
+    if (!result)
+      throw py::error_already_set();
+    Py_DECREF(result);
+    return entry.bin;
+  }
+
+  // Registers `bin`, which the launcher found in its cache under `pyKey`
+  // and launched for `args`.
+  void add(py::tuple args, int numWarps, int numStages, int splitK,
+           bool debug, int device, py::object pyKey, py::object bin) {
+    std::vector<py::object> dtypes;
+    auto key = getKey(args, numWarps, numStages, splitK, debug, device,
+                      dtypes);
+    py::object cuFunction = bin.attr("cu_function");
+    if (!key || cuFunction.is_none())
+      return;
+    Entry entry;
+    entry.bin = bin;
+    entry.cWrapper = bin.attr("c_wrapper");
+    entry.cuFunction = cuFunction;
+    entry.numWarps = bin.attr("num_warps").cast<int>();
+    entry.shared = bin.attr("shared").cast<int>();
+    entry.deviceCache = cache[py::int_(device)];
+    entry.pyKey = pyKey;
+    entry.generation = handleGeneration;
+    for (int i : constexprs)
+      entry.constants.push_back(
+          py::reinterpret_borrow<py::object>(args[i]));
+    // the key holds their addresses
+    entry.dtypes = std::move(dtypes);
+    entries[std::move(*key)] = std::move(entry);
+  }
+
+  void clear() { entries.clear(); }
+
+  size_t size() const { return entries.size(); }
+
+private:
+  using Key = std::vector<int64_t>;
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      return llvm::hash_combine_range(key.begin(), key.end());
+    }
+  };
+
+  struct Entry {
+    py::object bin;
+    py::object cWrapper;
+    py::object cuFunction;
+    int numWarps;
+    int shared;
+    py::object deviceCache;
+    py::object pyKey;
+    uint64_t generation;
+    std::vector<py::object> constants;
+    std::vector<py::object> dtypes;
+  };
+
+  static inline uint64_t handleGeneration = 0;
+
+  enum ArgKind : int64_t { NoneArg, BoolArg, IntArg, FloatArg, PointerArg };
+
+  // Mirrors JITFunction._key_of and _spec_of, or returns std::nullopt for
+  // the arguments the launcher rejects.
+  std::optional<Key> getKey(py::tuple args, int numWarps, int numStages,
+                            int splitK, bool debug, int device,
+                            std::vector<py::object> &dtypes) {
+    Key key = {device, numWarps, numStages, splitK, debug};
+    for (size_t i = 0; i < args.size(); ++i) {
+      PyObject *arg = args[i].ptr();
+      if (constexprs.count(i)) {
+        Py_hash_t hash = PyObject_Hash(arg);
+        if (hash == -1) {
+          PyErr_Clear();
+          return std::nullopt;
+        }
+        key.push_back(hash);
+      } else if (arg == Py_None) {
+        key.push_back(NoneArg);
+      } else if (PyBool_Check(arg)) {
+        key.insert(key.end(), {BoolArg, arg == Py_True});
+      } else if (PyLong_Check(arg)) {
+        int overflow;
+        long long value = PyLong_AsLongLongAndOverflow(arg, &overflow);
+        if (overflow) {
+          unsigned long long uvalue = PyLong_AsUnsignedLongLong(arg);
+          if (PyErr_Occurred()) {
+            PyErr_Clear();
+            return std::nullopt;
+          }
+          key.insert(key.end(), {IntArg, /*u64*/ 2, uvalue % 16 == 0, 0});
+          continue;
+        }
+        bool isI32 = value >= INT32_MIN && value <= INT32_MAX;
+        key.insert(key.end(),
+                   {IntArg, isI32 ? 0 : 1, value % 16 == 0, value == 1});
+      } else if (PyFloat_Check(arg)) {
+        key.push_back(FloatArg);
+      } else {
+        py::handle handle(arg);
+        if (!py::hasattr(handle, "dtype") || !py::hasattr(handle, "data_ptr"))
+          return std::nullopt;
+        py::object dtype = handle.attr("dtype");
+        uint64_t ptr = handle.attr("data_ptr")().cast<uint64_t>();
+        key.insert(key.end(),
+                   {PointerArg, reinterpret_cast<int64_t>(dtype.ptr()),
+                    ptr % 16 == 0});
+        dtypes.push_back(std::move(dtype));
+      }
+    }
+    return key;
+  }
+
+  bool isCached(const Entry &entry, int device) {
+    PyObject *deviceCache = PyDict_GetItem(cache.ptr(), py::int_(device).ptr());
+    if (deviceCache != entry.deviceCache.ptr())
+      return false;
+    return PyDict_GetItem(deviceCache, entry.pyKey.ptr()) == entry.bin.ptr();
+  }
+
+  // Hashes of the constexprs may collide
+  bool hasConstants(const Entry &entry, py::tuple args) {
+    size_t j = 0;
+    for (int i : constexprs) {
+      int equal = PyObject_RichCompareBool(args[i].ptr(),
+                                           entry.constants[j++].ptr(), Py_EQ);
+      if (equal != 1) {
+        PyErr_Clear();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  py::dict cache;
+  std::set<size_t> constexprs;
+  std::unordered_map<Key, Entry, KeyHash> entries;
+};
+
 void init_triton_runtime(py::module &&m) {
   // wrap backend_t
   py::enum_<backend_t>(m, "backend")
@@ -68,12 +320,246 @@ void init_triton_runtime(py::module &&m) {
       .value("CUDA", CUDA)
       .value("ROCM", ROCM)
       .export_values();
+
+  py::class_<KernelDispatcher>(m, "dispatcher")
+      .def(py::init<py::dict, std::vector<int>>())
+      .def("launch", &KernelDispatcher::launch)
+      .def("add", &KernelDispatcher::add)
+      .def("clear", &KernelDispatcher::clear)
+      .def("__len__", &KernelDispatcher::size);
+  m.def("invalidate_handles", &KernelDispatcher::invalidateHandles);
+  m.def("touch_module", [](uintptr_t kernel, int device) {
+    LaunchClock::touch(reinterpret_cast<const void *>(kernel), device);
+  });
+  m.def("last_launch", &LaunchClock::lastLaunch);
+  m.def("forget_module", &LaunchClock::forget);
 }
 
 /*****************************************************************************/
 /* Python bindings for triton::ir                                            */
 /*****************************************************************************/
 
+// The wall-clock time spent in each pass run by a pass manager, accumulated
+// over the operations a nested pass runs on. Passes are reported in the order
+// they first ran, as a JSON array of {"pass", "name", "count", "time"}
+// objects with the time in seconds.
+class PassTimings {
+public:
+  struct Record {
+    std::string argument;
+    std::string name;
+    unsigned count = 0;
+    double seconds = 0;
+  };
+
+  void start(mlir::Pass *pass, mlir::Operation *op) {
+    std::lock_guard<std::mutex> lock(mutex);
+    starts[{pass, op}] = std::chrono::steady_clock::now();
+  }
+
+  void stop(mlir::Pass *pass, mlir::Operation *op) {
+    auto end = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = starts.find({pass, op});
+    if (it == starts.end())
+      return;
+    auto [index, inserted] = indices.try_emplace(pass, records.size());
+    if (inserted)
+      records.push_back({pass->getArgument().str(), pass->getName().str()});
+    Record &record = records[index->second];
+    record.count += 1;
+    record.seconds += std::chrono::duration<double>(end - it->second).count();
+    starts.erase(it);
+  }
+
+  std::string json() {
+    std::lock_guard<std::mutex> lock(mutex);
+    llvm::json::Array report;
+    for (const Record &record : records)
+      report.push_back(llvm::json::Object{{"pass", record.argument},
+                                          {"name", record.name},
+                                          {"count", record.count},
+                                          {"time", record.seconds}});
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    os << llvm::json::Value(std::move(report));
+    return os.str();
+  }
+
+private:
+  std::mutex mutex;
+  std::map<std::pair<mlir::Pass *, mlir::Operation *>,
+           std::chrono::steady_clock::time_point>
+      starts;
+  std::map<mlir::Pass *, size_t> indices;
+  std::vector<Record> records;
+};
+
+// Feeds PassTimings from the passes of a pass manager, skipping the adaptors
+// that only run a nested pipeline, whose time is that of their passes.
+class PassTimingInstrumentation : public mlir::PassInstrumentation {
+public:
+  explicit PassTimingInstrumentation(std::shared_ptr<PassTimings> timings)
+      : timings(std::move(timings)) {}
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override {
+    if (!pass->getArgument().empty())
+      timings->start(pass, op);
+  }
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override {
+    if (!pass->getArgument().empty())
+      timings->stop(pass, op);
+  }
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override {
+    runAfterPass(pass, op);
+  }
+
+private:
+  std::shared_ptr<PassTimings> timings;
+};
+
+// The dialects of the modules the compiler parses and builds
+static void registerCompilerDialects(mlir::DialectRegistry &registry) {
+  // note: we initialize llvm for undef
+  registry.insert<
+      mlir::triton::TritonDialect, mlir::triton::gpu::TritonGPUDialect,
+      mlir::math::MathDialect, mlir::arith::ArithDialect,
+      mlir::index::IndexDialect, mlir::scf::SCFDialect,
+      mlir::cf::ControlFlowDialect, mlir::LLVM::LLVMDialect,
+      mlir::func::FuncDialect, mlir::linalg::LinalgDialect,
+      mlir::tensor::TensorDialect, mlir::memref::MemRefDialect,
+      mlir::bufferization::BufferizationDialect, mlir::vector::VectorDialect,
+      mlir::AffineDialect, mlir::gpu::GPUDialect>();
+}
+
+// Contexts reused across compilations, with the dialects of the compiler
+// loaded once. A context serves one compilation at a time: it is acquired
+// for it and released after, and dropped once released `maxUses` times to
+// bound the memory held by the attributes and types it uniqued. The modules
+// of a compilation keep their context alive once dropped. Multithreaded
+// contexts share a single thread pool rather than creating one each.
+class ContextPool {
+public:
+  ContextPool(unsigned maxUses, bool multithreading)
+      : maxUses(maxUses), multithreading(multithreading) {}
+
+  py::object acquire() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!free.empty()) {
+        Entry entry = std::move(free.back());
+        free.pop_back();
+        uses[entry.context.ptr()] = entry.uses;
+        return entry.context;
+      }
+    }
+    auto *context =
+        new mlir::MLIRContext(mlir::MLIRContext::Threading::DISABLED);
+    if (multithreading)
+      context->setThreadPool(getThreadPool());
+    mlir::DialectRegistry registry;
+    registerCompilerDialects(registry);
+    context->appendDialectRegistry(registry);
+    context->loadAllAvailableDialects();
+    py::object object =
+        py::cast(context, py::return_value_policy::take_ownership);
+    std::lock_guard<std::mutex> lock(mutex);
+    uses[object.ptr()] = 0;
+    return object;
+  }
+
+  void release(py::object context) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = uses.find(context.ptr());
+    if (it == uses.end())
+      throw std::runtime_error("Context was not acquired from this pool");
+    unsigned count = it->second + 1;
+    uses.erase(it);
+    if (count < maxUses)
+      free.push_back({std::move(context), count});
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    free.clear();
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return free.size();
+  }
+
+private:
+  struct Entry {
+    py::object context;
+    unsigned uses;
+  };
+
+  // Never destroyed, as it must outlive the contexts still held by modules
+  static llvm::ThreadPool &getThreadPool() {
+    static auto *threadPool = new llvm::ThreadPool();
+    return *threadPool;
+  }
+
+  unsigned maxUses;
+  bool multithreading;
+  std::mutex mutex;
+  std::vector<Entry> free;
+  std::map<PyObject *, unsigned> uses;
+};
+
+// Broadcasts `value`, a scalar or a tensor of at most the rank of `shape`,
+// to `shape` as the frontend does: scalars are splat, and tensors get the
+// missing axes in front and their axes of size 1 broadcast
+static mlir::Value broadcastTo(mlir::OpBuilder &builder, mlir::Value value,
+                               llvm::ArrayRef<int64_t> shape) {
+  auto loc = builder.getUnknownLoc();
+  auto type = value.getType().dyn_cast<mlir::RankedTensorType>();
+  if (!type)
+    return builder.createOrFold<mlir::triton::SplatOp>(
+        loc, mlir::RankedTensorType::get(shape, value.getType()), value);
+  auto elemTy = type.getElementType();
+  while (type.getRank() < static_cast<int64_t>(shape.size())) {
+    llvm::SmallVector<int64_t> expanded{1};
+    expanded.append(type.getShape().begin(), type.getShape().end());
+    type = mlir::RankedTensorType::get(expanded, elemTy);
+    value = builder.create<mlir::triton::ExpandDimsOp>(loc, type, value,
+                                                       /*axis=*/0);
+  }
+  if (type.getShape() != shape)
+    value = builder.createOrFold<mlir::triton::BroadcastOp>(
+        loc, mlir::RankedTensorType::get(shape, elemTy), value);
+  return value;
+}
+
+// Casts `value` to the element type `elemTy` with the implicit conversions
+// of the binary operators of the frontend: integers are resized, and sign
+// extended if `isSigned`, integers are converted to floats, and floats are
+// extended
+static mlir::Value implicitCast(mlir::OpBuilder &builder, mlir::Value value,
+                                mlir::Type elemTy, bool isSigned) {
+  auto loc = builder.getUnknownLoc();
+  auto srcElemTy = mlir::getElementTypeOrSelf(value.getType());
+  if (srcElemTy == elemTy)
+    return value;
+  mlir::Type dstTy = elemTy;
+  if (auto tensorTy = value.getType().dyn_cast<mlir::RankedTensorType>())
+    dstTy = mlir::RankedTensorType::get(tensorTy.getShape(), elemTy);
+  if (srcElemTy.isa<mlir::IntegerType>() && elemTy.isa<mlir::IntegerType>()) {
+    if (srcElemTy.getIntOrFloatBitWidth() > elemTy.getIntOrFloatBitWidth())
+      return builder.create<mlir::arith::TruncIOp>(loc, dstTy, value);
+    if (isSigned)
+      return builder.create<mlir::arith::ExtSIOp>(loc, dstTy, value);
+    return builder.create<mlir::arith::ExtUIOp>(loc, dstTy, value);
+  }
+  if (srcElemTy.isa<mlir::IntegerType>()) {
+    if (isSigned)
+      return builder.create<mlir::arith::SIToFPOp>(loc, dstTy, value);
+    return builder.create<mlir::arith::UIToFPOp>(loc, dstTy, value);
+  }
+  return builder.create<mlir::arith::ExtFOp>(loc, dstTy, value);
+}
+
 void init_triton_ir(py::module &&m) {
   using ret = py::return_value_policy;
   using namespace pybind11::literals;
@@ -87,6 +573,9 @@ void init_triton_ir(py::module &&m) {
       .value("NONE", mlir::triton::CacheModifier::NONE)
       .value("CA", mlir::triton::CacheModifier::CA)
       .value("CG", mlir::triton::CacheModifier::CG)
+      .value("WB", mlir::triton::CacheModifier::WB)
+      .value("CS", mlir::triton::CacheModifier::CS)
+      .value("WT", mlir::triton::CacheModifier::WT)
       .export_values();
 
   py::enum_<mlir::triton::EvictionPolicy>(m, "EVICTION_POLICY")
@@ -118,6 +607,14 @@ void init_triton_ir(py::module &&m) {
         // some placeholders
         self.getOrLoadDialect<mlir::LLVM::LLVMDialect>();
       });
+
+  py::class_<ContextPool>(m, "context_pool")
+      .def(py::init<unsigned, bool>(), "max_uses"_a = 64,
+           "multithreading"_a = true)
+      .def("acquire", &ContextPool::acquire)
+      .def("release", &ContextPool::release)
+      .def("clear", &ContextPool::clear)
+      .def("__len__", &ContextPool::size);
   // .def(py::init([](){
   //   mlir::MLIRContext context;
   //   context.getOrLoadDialect<mlir::triton.TritonDialect>();
@@ -358,6 +855,17 @@ void init_triton_ir(py::module &&m) {
               std::string &funcName) -> mlir::triton::FuncOp {
              return self.lookupSymbol<mlir::triton::FuncOp>(funcName);
            })
+      .def("merge",
+           [](mlir::ModuleOp &self, mlir::ModuleOp &other) -> void {
+             // Clones the functions of `other` that `self` does not have,
+             // renaming the kernels that clash with those of `self`
+             mlir::SymbolTable symbols(self);
+             for (auto func : other.getOps<mlir::triton::FuncOp>()) {
+               if (!func.isPublic() && symbols.lookup(func.getName()))
+                 continue;
+               symbols.insert(func.clone());
+             }
+           })
       .def("get_single_function",
            [](mlir::ModuleOp &self) -> mlir::triton::FuncOp {
              llvm::SmallVector<mlir::triton::FuncOp> funcs;
@@ -382,13 +890,8 @@ void init_triton_ir(py::module &&m) {
       "parse_mlir_module",
       [](const std::string &inputFilename, mlir::MLIRContext &context) {
         // initialize registry
-        // note: we initialize llvm for undef
         mlir::DialectRegistry registry;
-        registry.insert<
-            mlir::triton::TritonDialect, mlir::triton::gpu::TritonGPUDialect,
-            mlir::math::MathDialect, mlir::arith::ArithDialect,
-            mlir::index::IndexDialect, mlir::scf::SCFDialect,
-            mlir::cf::ControlFlowDialect, mlir::LLVM::LLVMDialect>();
+        registerCompilerDialects(registry);
         context.appendDialectRegistry(registry);
         context.loadAllAvailableDialects();
 
@@ -1153,6 +1656,14 @@ void init_triton_ir(py::module &&m) {
              self.create<mlir::triton::StoreOp>(loc, ptrs, val, mask,
                                                 cacheModifier, evictionPolicy);
            })
+      .def("create_prefetch",
+           [](mlir::OpBuilder &self, mlir::Value &ptrs,
+              std::optional<mlir::Value> &mask,
+              mlir::triton::EvictionPolicy evictionPolicy) -> void {
+             auto loc = self.getUnknownLoc();
+             self.create<mlir::triton::PrefetchOp>(
+                 loc, ptrs, mask.value_or(mlir::Value()), evictionPolicy);
+           })
       .def("create_view",
            [](mlir::OpBuilder &self, mlir::Value &arg,
               std::vector<int64_t> &shape) -> mlir::Value {
@@ -1224,6 +1735,66 @@ void init_triton_ir(py::module &&m) {
                  loc, mlir::RankedTensorType::get(shape, argType), arg);
              return ret;
            })
+      // Bulk builders, creating the ops the frontend emits for common
+      // sequences in a single call
+      .def("create_broadcast_to",
+           [](mlir::OpBuilder &self, mlir::Value &arg,
+              std::vector<int64_t> &shape) -> mlir::Value {
+             return broadcastTo(self, arg, shape);
+           })
+      .def("create_expand_dims_at",
+           [](mlir::OpBuilder &self, mlir::Value &arg,
+              std::vector<int> &axes) -> mlir::Value {
+             // one expand_dims per axis, in order, as axes of the result
+             auto loc = self.getUnknownLoc();
+             for (int axis : axes) {
+               auto argType = arg.getType().cast<mlir::RankedTensorType>();
+               std::vector<int64_t> retShape = argType.getShape();
+               retShape.insert(retShape.begin() + axis, 1);
+               arg = self.create<mlir::triton::ExpandDimsOp>(
+                   loc,
+                   mlir::RankedTensorType::get(retShape,
+                                               argType.getElementType()),
+                   arg, axis);
+             }
+             return arg;
+           })
+      .def("create_binary",
+           [](mlir::OpBuilder &self, const std::string &op, mlir::Value &lhs,
+              mlir::Value &rhs, std::vector<int64_t> &shape,
+              mlir::Type &elemTy, bool isLhsSigned,
+              bool isRhsSigned) -> mlir::Value {
+             // `op` of lhs and rhs broadcast to `shape`, unless empty, and
+             // cast to `elemTy`, but the offsets of addptr
+             auto loc = self.getUnknownLoc();
+             mlir::Value lhsVal = lhs, rhsVal = rhs;
+             if (!shape.empty()) {
+               lhsVal = broadcastTo(self, lhsVal, shape);
+               rhsVal = broadcastTo(self, rhsVal, shape);
+             }
+             if (op == "addptr") {
+               if (!mlir::getElementTypeOrSelf(lhsVal.getType())
+                        .isa<mlir::triton::PointerType>())
+                 std::swap(lhsVal, rhsVal);
+               return self.create<mlir::triton::AddPtrOp>(
+                   loc, lhsVal.getType(), lhsVal, rhsVal);
+             }
+             lhsVal = implicitCast(self, lhsVal, elemTy, isLhsSigned);
+             rhsVal = implicitCast(self, rhsVal, elemTy, isRhsSigned);
+             if (op == "add")
+               return self.create<mlir::arith::AddIOp>(loc, lhsVal, rhsVal);
+             if (op == "fadd")
+               return self.create<mlir::arith::AddFOp>(loc, lhsVal, rhsVal);
+             if (op == "sub")
+               return self.create<mlir::arith::SubIOp>(loc, lhsVal, rhsVal);
+             if (op == "fsub")
+               return self.create<mlir::arith::SubFOp>(loc, lhsVal, rhsVal);
+             if (op == "mul")
+               return self.create<mlir::arith::MulIOp>(loc, lhsVal, rhsVal);
+             if (op == "fmul")
+               return self.create<mlir::arith::MulFOp>(loc, lhsVal, rhsVal);
+             throw std::runtime_error("unsupported binary op " + op);
+           })
       // // atomic
       .def("create_atomic_cas",
            [](mlir::OpBuilder &self, mlir::Value &ptr, mlir::Value &cmp,
@@ -1347,6 +1918,22 @@ void init_triton_ir(py::module &&m) {
              return self.create<mlir::triton::ReduceReturnOp>(loc,
                                                               return_values);
            })
+      .def("create_scan",
+           [](mlir::OpBuilder &self, std::vector<mlir::Value> operands,
+              int axis) -> mlir::OpState {
+             auto loc = self.getUnknownLoc();
+             return self.create<mlir::triton::ScanOp>(loc, operands, axis);
+           })
+      .def("create_scan_ret",
+           [](mlir::OpBuilder &self, py::args args) -> mlir::OpState {
+             auto loc = self.getUnknownLoc();
+             llvm::SmallVector<mlir::Value> return_values;
+             for (const auto &arg : args) {
+               return_values.push_back(py::cast<mlir::Value>(arg));
+             }
+             return self.create<mlir::triton::ScanReturnOp>(loc,
+                                                            return_values);
+           })
       .def("create_ptr_to_int",
            [](mlir::OpBuilder &self, mlir::Value &val,
               mlir::Type &type) -> mlir::Value {
@@ -1398,6 +1985,18 @@ void init_triton_ir(py::module &&m) {
              auto loc = self.getUnknownLoc();
              return self.create<::mlir::LLVM::UndefOp>(loc, type);
            })
+      // Start or end of a profiled region
+      .def("create_profile_marker",
+           [](mlir::OpBuilder &self, const std::string &label,
+              bool isStart) -> void {
+             auto loc = self.getUnknownLoc();
+             self.create<mlir::triton::ProfileMarkerOp>(loc, label, isStart);
+           })
+      .def("create_grid_barrier",
+           [](mlir::OpBuilder &self) -> void {
+             auto loc = self.getUnknownLoc();
+             self.create<mlir::triton::GridBarrierOp>(loc);
+           })
       // Force GPU barrier
       .def("create_barrier",
            [](mlir::OpBuilder &self) {
@@ -1425,8 +2024,18 @@ void init_triton_ir(py::module &&m) {
                                                          ptr, offsets);
            });
 
+  py::class_<PassTimings, std::shared_ptr<PassTimings>>(m, "pass_timings")
+      .def("json", &PassTimings::json);
+
   py::class_<mlir::PassManager>(m, "pass_manager")
       .def(py::init<mlir::MLIRContext *>())
+      .def("enable_timing",
+           [](mlir::PassManager &self) {
+             auto timings = std::make_shared<PassTimings>();
+             self.addInstrumentation(
+                 std::make_unique<PassTimingInstrumentation>(timings));
+             return timings;
+           })
       .def("enable_debug",
            [](mlir::PassManager &self) {
              auto printingFlags = mlir::OpPrintingFlags();
@@ -1444,17 +2053,50 @@ void init_triton_ir(py::module &&m) {
            })
       .def("run",
            [](mlir::PassManager &self, mlir::ModuleOp &mod) {
+             // The remarks of the passes, e.g. the optimizations they missed
+             // when TRITON_REMARKS is set, are returned as "loc: message"
+             std::vector<std::string> remarks;
+             // The passes don't call back into Python, so other threads can
+             // compile concurrently, e.g. the configs of the autotuner
+             py::gil_scoped_release allow_threads;
+             mlir::ScopedDiagnosticHandler collectRemarks(
+                 mod.getContext(), [&](mlir::Diagnostic &diag) {
+                   if (diag.getSeverity() != mlir::DiagnosticSeverity::Remark)
+                     return mlir::failure();
+                   std::string remark;
+                   llvm::raw_string_ostream os(remark);
+                   os << diag.getLocation() << ": " << diag;
+                   remarks.push_back(os.str());
+                   return mlir::success();
+                 });
              // TODO: maybe dump module to file and print error for better
              // diagnostics
              if (mlir::failed(self.run(mod.getOperation())))
                throw std::runtime_error("PassManager::run failed");
+             return remarks;
            })
       .def(
           "add_sccp_pass",
           [](mlir::PassManager &self) { self.addPass(mlir::createSCCPPass()); })
       .def("add_tritongpu_coalesce_pass",
            [](mlir::PassManager &self) {
-             self.addPass(mlir::createTritonGPUCoalescePass());
+             self.addNestedPass<mlir::triton::FuncOp>(
+                 mlir::createTritonGPUCoalescePass());
+           })
+      .def("add_tritongpu_coalesce_epilogue_pass",
+           [](mlir::PassManager &self, int maxSharedMemory) {
+             self.addPass(
+                 mlir::createTritonGPUCoalesceEpiloguePass(maxSharedMemory));
+           })
+      .def("add_tritongpu_instrument_regions_pass",
+           [](mlir::PassManager &self, int capacity, bool loops, bool dots,
+              bool loads, bool globalTimer) {
+             self.addPass(mlir::createTritonGPUInstrumentRegionsPass(
+                 capacity, loops, dots, loads, globalTimer));
+           })
+      .def("add_tritongpu_grid_barriers_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::createTritonGPUGridBarriersPass());
            })
       .def("add_symbol_dce_pass",
            [](mlir::PassManager &self) {
@@ -1483,39 +2125,97 @@ void init_triton_ir(py::module &&m) {
              self.addPass(mlir::triton::createRewriteTensorPointerPass(
                  computeCapability));
            })
-      .def("add_convert_triton_to_tritongpu_pass",
-           [](mlir::PassManager &self, int numWarps) {
-             self.addPass(
-                 mlir::triton::createConvertTritonToTritonGPUPass(numWarps));
+      .def("add_triton_fuse_kernels_pass",
+           [](mlir::PassManager &self, const std::string &name) {
+             self.addPass(mlir::triton::createFuseKernelsPass(name));
            })
-      .def("add_tritongpu_pipeline_pass",
-           [](mlir::PassManager &self, int numStages) {
-             self.addPass(mlir::createTritonGPUPipelinePass(numStages));
-           })
-      .def("add_tritongpu_prefetch_pass",
+      .def("add_convert_triton_to_tritongpu_pass",
+           [](mlir::PassManager &self, int numWarps, int threadsPerWarp,
+              int numCTAs) {
+             self.addPass(mlir::triton::createConvertTritonToTritonGPUPass(
+                 numWarps, threadsPerWarp, numCTAs));
+           },
+           py::arg("num_warps"), py::arg("threads_per_warp") = 32,
+           py::arg("num_ctas") = 1)
+      .def(
+          "add_tritongpu_pipeline_pass",
+          [](mlir::PassManager &self, int numStages, bool registerStaging,
+             bool pipelineNonDotLoads) {
+            self.addNestedPass<mlir::triton::FuncOp>(
+                mlir::createTritonGPUPipelinePass(numStages, registerStaging,
+                                                  pipelineNonDotLoads));
+          },
+          py::arg("num_stages"), py::arg("register_staging") = false,
+          py::arg("pipeline_non_dot_loads") = false)
+      .def("add_tritongpu_persistent_kernel_pass",
+           [](mlir::PassManager &self, bool pipelineTiles) {
+             self.addNestedPass<mlir::triton::FuncOp>(
+                 mlir::createTritonGPUPersistentKernelPass(pipelineTiles));
+           })
+      .def("add_tritongpu_split_k_pass",
+           [](mlir::PassManager &self, int splitK) {
+             self.addNestedPass<mlir::triton::FuncOp>(
+                 mlir::createTritonGPUSplitKPass(splitK));
+           })
+      .def("add_tritongpu_pipeline_chained_dots_pass",
            [](mlir::PassManager &self) {
-             self.addPass(mlir::createTritonGPUPrefetchPass());
+             self.addNestedPass<mlir::triton::FuncOp>(
+                 mlir::createTritonGPUPipelineChainedDotsPass());
            })
-      .def("add_tritongpu_accelerate_matmul_pass",
-           [](mlir::PassManager &self, int computeCapability) {
-             self.addPass(
-                 mlir::createTritonGPUAccelerateMatmulPass(computeCapability));
+      .def("add_tritongpu_prefetch_pass",
+           [](mlir::PassManager &self, int distance, int sliceWidth) {
+             self.addNestedPass<mlir::triton::FuncOp>(
+                 mlir::createTritonGPUPrefetchPass(distance, sliceWidth));
            })
+      .def(
+          "add_tritongpu_accelerate_matmul_pass",
+          [](mlir::PassManager &self, int computeCapability,
+             int matrixCoreVersion) {
+            self.addNestedPass<mlir::triton::FuncOp>(
+                mlir::createTritonGPUAccelerateMatmulPass(computeCapability,
+                                                          matrixCoreVersion));
+          },
+          py::arg("compute_capability"), py::arg("matrix_core_version") = 0)
       .def("add_tritongpu_optimize_dot_operands_pass",
            [](mlir::PassManager &self) {
-             self.addPass(mlir::createTritonGPUOptimizeDotOperandsPass());
+             self.addNestedPass<mlir::triton::FuncOp>(
+                 mlir::createTritonGPUOptimizeDotOperandsPass());
            })
       .def("add_tritongpu_remove_layout_conversions_pass",
            [](mlir::PassManager &self) {
-             self.addPass(mlir::createTritonGPURemoveLayoutConversionsPass());
+             self.addNestedPass<mlir::triton::FuncOp>(
+                 mlir::createTritonGPURemoveLayoutConversionsPass());
            })
       .def("add_tritongpu_reorder_instructions_pass",
            [](mlir::PassManager &self) {
-             self.addPass(mlir::createTritonGPUReorderInstructionsPass());
+             self.addNestedPass<mlir::triton::FuncOp>(
+                 mlir::createTritonGPUReorderInstructionsPass());
            })
       .def("add_tritongpu_decompose_conversions_pass",
            [](mlir::PassManager &self) {
-             self.addPass(mlir::createTritonGPUDecomposeConversionsPass());
+             self.addNestedPass<mlir::triton::FuncOp>(
+                 mlir::createTritonGPUDecomposeConversionsPass());
+           })
+      .def("add_triton_to_linalg_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::triton::createTritonToLinalgPass());
+           })
+      .def("add_triton_linalg_grid_launcher_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::triton::createTritonLinalgGridLauncherPass());
+           })
+      .def("add_triton_linalg_fuse_elementwise_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(
+                 mlir::triton::createTritonLinalgFuseElementwisePass());
+           })
+      .def("add_triton_linalg_tile_matmul_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::triton::createTritonLinalgTileMatmulPass());
+           })
+      .def("add_triton_linalg_split_k_pass",
+           [](mlir::PassManager &self, unsigned splitK) {
+             self.addPass(mlir::triton::createTritonLinalgSplitKPass(splitK));
            })
       .def("add_triton_gpu_to_llvm",
            [](mlir::PassManager &self) {
@@ -1526,21 +2226,210 @@ void init_triton_ir(py::module &&m) {
       });
 }
 
+/*****************************************************************************/
+/* PTX compilation with the JIT of the CUDA driver                           */
+/*****************************************************************************/
+
+// The subset of the driver API used to link a cubin, resolved from libcuda
+// at runtime so that the bindings do not depend on the driver
+namespace cuda {
+using CUresult = int;
+using CUlinkState = void *;
+enum CUjit_option {
+  CU_JIT_INFO_LOG_BUFFER = 3,
+  CU_JIT_INFO_LOG_BUFFER_SIZE_BYTES = 4,
+  CU_JIT_ERROR_LOG_BUFFER = 5,
+  CU_JIT_ERROR_LOG_BUFFER_SIZE_BYTES = 6,
+  CU_JIT_TARGET = 9,
+  CU_JIT_LOG_VERBOSE = 12,
+};
+constexpr int CU_JIT_INPUT_PTX = 1;
+// Targets with architecture-specific features, e.g. sm_90a for wgmma
+constexpr int CU_COMPUTE_ACCELERATED_TARGET_BASE = 0x10000;
+
+using cuLinkCreate_t = CUresult (*)(unsigned, CUjit_option *, void **,
+                                    CUlinkState *);
+using cuLinkAddData_t = CUresult (*)(CUlinkState, int, void *, size_t,
+                                     const char *, unsigned, CUjit_option *,
+                                     void **);
+using cuLinkComplete_t = CUresult (*)(CUlinkState, void **, size_t *);
+using cuLinkDestroy_t = CUresult (*)(CUlinkState);
+} // namespace cuda
+
+// Compiles `ptxCode` into a cubin in-process, and returns it alongside the
+// verbose log of the compiler, or std::nullopt when the driver cannot, e.g.
+// without a current context or for a PTX version newer than the driver.
+// The external ptxas then reports the actual errors.
+static std::optional<std::pair<std::string, std::string>>
+compilePtxWithDriver(const std::string &ptxCode, int capability) {
+  static llvm::sys::DynamicLibrary libcuda =
+      llvm::sys::DynamicLibrary::getPermanentLibrary("libcuda.so.1");
+  if (!libcuda.isValid())
+    return std::nullopt;
+  auto linkCreate = reinterpret_cast<cuda::cuLinkCreate_t>(
+      libcuda.getAddressOfSymbol("cuLinkCreate_v2"));
+  auto linkAddData = reinterpret_cast<cuda::cuLinkAddData_t>(
+      libcuda.getAddressOfSymbol("cuLinkAddData_v2"));
+  auto linkComplete = reinterpret_cast<cuda::cuLinkComplete_t>(
+      libcuda.getAddressOfSymbol("cuLinkComplete"));
+  auto linkDestroy = reinterpret_cast<cuda::cuLinkDestroy_t>(
+      libcuda.getAddressOfSymbol("cuLinkDestroy"));
+  if (!linkCreate || !linkAddData || !linkComplete || !linkDestroy)
+    return std::nullopt;
+
+  constexpr size_t logSize = 16384;
+  std::vector<char> infoLog(logSize, 0);
+  std::vector<char> errorLog(logSize, 0);
+  size_t target = capability == 90
+                      ? cuda::CU_COMPUTE_ACCELERATED_TARGET_BASE + capability
+                      : capability;
+  cuda::CUjit_option options[] = {cuda::CU_JIT_INFO_LOG_BUFFER,
+                                  cuda::CU_JIT_INFO_LOG_BUFFER_SIZE_BYTES,
+                                  cuda::CU_JIT_ERROR_LOG_BUFFER,
+                                  cuda::CU_JIT_ERROR_LOG_BUFFER_SIZE_BYTES,
+                                  cuda::CU_JIT_TARGET,
+                                  cuda::CU_JIT_LOG_VERBOSE};
+  void *values[] = {infoLog.data(),
+                    reinterpret_cast<void *>(logSize),
+                    errorLog.data(),
+                    reinterpret_cast<void *>(logSize),
+                    reinterpret_cast<void *>(target),
+                    reinterpret_cast<void *>(size_t(1))};
+  cuda::CUlinkState state;
+  if (linkCreate(std::size(options), options, values, &state) != 0)
+    return std::nullopt;
+  auto *data = const_cast<char *>(ptxCode.c_str());
+  std::optional<std::pair<std::string, std::string>> result;
+  void *cubin = nullptr;
+  size_t cubinSize = 0;
+  if (linkAddData(state, cuda::CU_JIT_INPUT_PTX, data, ptxCode.size() + 1,
+                  "triton", 0, nullptr, nullptr) == 0 &&
+      linkComplete(state, &cubin, &cubinSize) == 0)
+    result = {std::string(static_cast<char *>(cubin), cubinSize),
+              std::string(infoLog.data())};
+  // The cubin belongs to the link state
+  linkDestroy(state);
+  return result;
+}
+
 void init_triton_translation(py::module &m) {
   using ret = py::return_value_policy;
 
-  m.def("get_shared_memory_size", [](mlir::ModuleOp mod) {
-    auto shared = mod->getAttrOfType<mlir::IntegerAttr>("triton_gpu.shared");
-    return shared.getInt();
+  // Returns the shared memory size of a module lowered to LLVM, or the one
+  // Allocation gives a TritonGPU module that has not been lowered yet
+  m.def("get_shared_memory_size", [](mlir::ModuleOp mod) -> int64_t {
+    if (auto shared =
+            mod->getAttrOfType<mlir::IntegerAttr>("triton_gpu.shared"))
+      return shared.getInt();
+    mlir::Allocation allocation(mod);
+    return allocation.getSharedMemorySize();
+  });
+
+  // Estimates the peak number of 32-bit registers per thread of a TritonGPU
+  // module from the layouts of the values live at the same time
+  m.def("estimate_registers", [](mlir::ModuleOp mod) {
+    return mlir::getPeakRegisters(mod.getOperation());
+  });
+
+  // Returns the shared memory buffers of a module lowered to LLVM, or of a
+  // TritonGPU module that has not been lowered yet, which lets configs be
+  // pruned before compiling them.
+  m.def("get_shared_memory_buffers", [](mlir::ModuleOp mod) {
+    auto buffers =
+        mod->getAttrOfType<mlir::ArrayAttr>("triton_gpu.shared_buffers");
+    if (!buffers) {
+      mlir::Allocation allocation(mod);
+      buffers = mlir::getSharedMemoryBufferReport(allocation);
+    }
+    py::list ret;
+    for (auto attr : buffers) {
+      py::dict buffer;
+      for (auto namedAttr : attr.cast<mlir::DictionaryAttr>()) {
+        auto name = namedAttr.getName().str();
+        if (auto strAttr = namedAttr.getValue().dyn_cast<mlir::StringAttr>())
+          buffer[name.c_str()] = strAttr.str();
+        else if (auto intAttr =
+                     namedAttr.getValue().dyn_cast<mlir::IntegerAttr>())
+          buffer[name.c_str()] = intAttr.getInt();
+      }
+      ret.append(buffer);
+    }
+    return ret;
+  });
+
+  // Returns the tensor maps the kernel of a TritonGPU module copies blocks
+  // through, in the order of their arguments, which follow the arguments of
+  // the kernel in the launcher. See getTensorMapAttr in RewriteTensorPointer.
+  m.def("get_profile_regions", [](mlir::ModuleOp mod) {
+    py::list ret;
+    auto regions =
+        mod->getAttrOfType<mlir::ArrayAttr>("triton_gpu.profile_regions");
+    if (!regions)
+      return ret;
+    for (auto region : regions.getAsValueRange<mlir::StringAttr>())
+      ret.append(region.str());
+    return ret;
+  });
+
+  m.def("has_grid_barriers", [](mlir::ModuleOp mod) {
+    bool found = false;
+    mod.walk([&](mlir::Operation *op) {
+      if (mlir::isa<mlir::triton::GridBarrierOp,
+                    mlir::triton::gpu::GridBarrierOp>(op))
+        found = true;
+    });
+    return found;
+  });
+
+  m.def("get_tensormaps", [](mlir::ModuleOp mod) {
+    py::list ret;
+    mod.walk([&](mlir::triton::FuncOp funcOp) {
+      if (!funcOp.isPublic())
+        return;
+      for (unsigned i = 0; i < funcOp.getNumArguments(); ++i) {
+        auto tensorMap =
+            funcOp.getArgAttrOfType<mlir::DictionaryAttr>(i, "tt.tensormap");
+        if (!tensorMap)
+          continue;
+        py::dict map;
+        for (auto namedAttr : tensorMap) {
+          auto name = namedAttr.getName().str();
+          auto value = namedAttr.getValue();
+          if (auto intAttr = value.dyn_cast<mlir::IntegerAttr>()) {
+            map[name.c_str()] = intAttr.getInt();
+          } else if (auto arrayAttr =
+                         value.dyn_cast<mlir::DenseI32ArrayAttr>()) {
+            py::list values;
+            for (int32_t v : arrayAttr.asArrayRef())
+              values.append(v);
+            map[name.c_str()] = values;
+          } else if (auto arrayAttr =
+                         value.dyn_cast<mlir::DenseI64ArrayAttr>()) {
+            py::list values;
+            for (int64_t v : arrayAttr.asArrayRef())
+              values.append(v);
+            map[name.c_str()] = values;
+          } else if (auto typeAttr = value.dyn_cast<mlir::TypeAttr>()) {
+            std::string str;
+            llvm::raw_string_ostream os(str);
+            typeAttr.getValue().print(os);
+            map[name.c_str()] = os.str();
+          }
+        }
+        ret.append(map);
+      }
+    });
+    return ret;
   });
 
   m.def(
       "translate_triton_gpu_to_llvmir",
-      [](mlir::ModuleOp op, int computeCapability, bool isROCM) {
+      [](mlir::ModuleOp op, int computeCapability, bool isROCM,
+         int optLevel) {
         py::gil_scoped_release allow_threads;
         llvm::LLVMContext llvmContext;
         auto llvmModule = ::mlir::triton::translateTritonGPUToLLVMIR(
-            &llvmContext, op, computeCapability, isROCM);
+            &llvmContext, op, computeCapability, isROCM, optLevel);
         if (!llvmModule)
           llvm::report_fatal_error("Failed to translate TritonGPU to LLVM IR.");
 
@@ -1552,9 +2441,79 @@ void init_triton_translation(py::module &m) {
       },
       ret::take_ownership);
 
+  m.def(
+      "translate_linalg_to_llvmir",
+      [](mlir::ModuleOp op, int optLevel) {
+        py::gil_scoped_release allow_threads;
+        llvm::LLVMContext llvmContext;
+        auto llvmModule =
+            ::mlir::triton::translateLinalgToLLVMIR(&llvmContext, op, optLevel);
+        if (!llvmModule)
+          llvm::report_fatal_error("Failed to translate Linalg to LLVM IR.");
+
+        std::string str;
+        llvm::raw_string_ostream os(str);
+        llvmModule->print(os, nullptr);
+        os.flush();
+        return str;
+      },
+      ret::take_ownership);
+
+  m.def(
+      "translate_llvmir_to_host_object",
+      [](const std::string llvmIR, int optLevel) -> py::object {
+        std::string object;
+        {
+          py::gil_scoped_release allow_threads;
+          llvm::InitializeNativeTarget();
+          llvm::InitializeNativeTargetAsmPrinter();
+
+          // create LLVM module from C++
+          llvm::LLVMContext context;
+          std::unique_ptr<llvm::MemoryBuffer> buffer =
+              llvm::MemoryBuffer::getMemBuffer(llvmIR.c_str());
+          llvm::SMDiagnostic error;
+          std::unique_ptr<llvm::Module> module =
+              llvm::parseIR(buffer->getMemBufferRef(), error, context);
+          if (!module) {
+            llvm::report_fatal_error(
+                "failed to parse IR: " + error.getMessage() +
+                "lineno: " + std::to_string(error.getLineNo()));
+          }
+
+          // emit a position independent object for the host
+          auto triple = llvm::sys::getProcessTriple();
+          std::string lookupError;
+          auto target = llvm::TargetRegistry::lookupTarget(triple, lookupError);
+          if (!target)
+            throw std::runtime_error("Failed to find host target: " +
+                                     lookupError);
+          std::unique_ptr<llvm::TargetMachine> machine{
+              target->createTargetMachine(triple, llvm::sys::getHostCPUName(),
+                                          "", llvm::TargetOptions(),
+                                          llvm::Reloc::PIC_, std::nullopt,
+                                          llvm::CodeGenOpt::getLevel(optLevel)
+                                              .value_or(
+                                                  llvm::CodeGenOpt::Aggressive))};
+          module->setTargetTriple(triple);
+          module->setDataLayout(machine->createDataLayout());
+
+          llvm::SmallVector<char, 0> objectBuffer;
+          llvm::raw_svector_ostream stream(objectBuffer);
+          llvm::legacy::PassManager pass;
+          if (machine->addPassesToEmitFile(pass, stream, nullptr,
+                                           llvm::CGFT_ObjectFile))
+            throw std::runtime_error("Host target cannot emit object files");
+          pass.run(*module);
+          object.assign(objectBuffer.begin(), objectBuffer.end());
+        }
+        return py::bytes(object);
+      });
+
   m.def(
       "translate_llvmir_to_ptx",
-      [](const std::string llvmIR, int capability, int version) -> std::string {
+      [](const std::string llvmIR, int capability, int version,
+         int optLevel) -> std::string {
         py::gil_scoped_release allow_threads;
         // create LLVM module from C++
         llvm::LLVMContext context;
@@ -1570,15 +2529,31 @@ void init_triton_translation(py::module &m) {
         }
 
         // translate module to PTX
-        auto ptxCode =
-            triton::translateLLVMIRToPTX(*module, capability, version);
+        auto ptxCode = triton::translateLLVMIRToPTX(*module, capability,
+                                                    version, optLevel);
         return ptxCode;
       },
       ret::take_ownership);
 
-  m.def("compile_ptx_to_cubin",
-        [](const std::string &ptxCode, const std::string &ptxasPath,
-           int capability) -> py::object {
+  // Returns the cubin and the verbose log of the compiler, from the JIT of
+  // the driver unless `external` is set, and from `ptxasPath` otherwise or
+  // when the driver fails.
+  m.def(
+      "compile_ptx_to_cubin",
+      [](const std::string &ptxCode, const std::string &ptxasPath,
+         int capability, bool external) -> py::object {
+        std::optional<std::pair<std::string, std::string>> jit;
+        {
+          py::gil_scoped_release allow_threads;
+          if (!external)
+            jit = compilePtxWithDriver(ptxCode, capability);
+        }
+        if (jit)
+          return py::make_tuple(py::bytes(jit->first), jit->second);
+
+        std::string cubin;
+        std::string log;
+        {
           py::gil_scoped_release allow_threads;
 
           // compile ptx with ptxas
@@ -1602,10 +2577,10 @@ void init_triton_translation(py::module &m) {
                 ".o 2> " + _flog;
 
           err = system(cmd.c_str());
+          std::ifstream _log(_flog);
+          log = std::string(std::istreambuf_iterator<char>(_log), {});
           if (err != 0) {
             err >>= 8;
-            std::ifstream _log(_flog);
-            std::string log(std::istreambuf_iterator<char>(_log), {});
             if (err == 255) {
               throw std::runtime_error("Internal Triton PTX codegen error: \n" +
                                        log);
@@ -1618,16 +2593,16 @@ void init_triton_translation(py::module &m) {
               throw std::runtime_error("`ptxas` failed with error code " +
                                        std::to_string(err) + ": \n" + log);
             }
-            return {};
-          } else {
-            llvm::FileRemover srcRemover(fsrc);
-            std::ifstream _cubin(_fbin, std::ios::binary);
-            std::string cubin(std::istreambuf_iterator<char>(_cubin), {});
-            _cubin.close();
-            py::bytes bytes(cubin);
-            return std::move(bytes);
           }
-        });
+          llvm::FileRemover srcRemover(fsrc);
+          std::ifstream _cubin(_fbin, std::ios::binary);
+          cubin = std::string(std::istreambuf_iterator<char>(_cubin), {});
+          _cubin.close();
+        }
+        return py::make_tuple(py::bytes(cubin), log);
+      },
+      py::arg("ptx"), py::arg("ptxas_path"), py::arg("capability"),
+      py::arg("external") = false);
 
   m.def("add_external_libs",
         [](mlir::ModuleOp &op, const std::vector<std::string> &names,
@@ -1638,7 +2613,7 @@ void init_triton_translation(py::module &m) {
   m.def(
       "translate_llvmir_to_hsaco",
       [](const std::string llvmIR, std::string gfx_arch, std::string gfx_triple,
-         std::string gfx_features) -> std::tuple<std::string, std::string> {
+         std::string gfx_features) -> py::tuple {
         // create LLVM module from C++
         llvm::LLVMContext context;
         std::unique_ptr<llvm::MemoryBuffer> buffer =
@@ -1647,9 +2622,9 @@ void init_triton_translation(py::module &m) {
         std::unique_ptr<llvm::Module> module =
             llvm::parseIR(buffer->getMemBufferRef(), error, context);
         // translate module to HSACO
-        auto hsacoCode = triton::translateLLVMIRToHSACO(
+        auto [amdgcn, hsaco] = triton::translateLLVMIRToHSACO(
             *module, gfx_arch, gfx_triple, gfx_features);
-        return hsacoCode;
+        return py::make_tuple(amdgcn, py::bytes(hsaco));
       },
       ret::take_ownership);
 }
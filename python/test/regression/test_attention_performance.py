@@ -0,0 +1,81 @@
+"""
+Performance of the forward pass of triton.ops.attention over the sequence
+lengths of training and of long-context serving.
+
+Each run checks the output against torch, prints the TFLOP/s of the causal
+kernel and its fraction of the tensor core peak, and appends them to the JSON
+file in TRITON_ATTENTION_PERF_RESULTS if set, so that the effect of the
+scheduling of its loop, e.g. by tritongpu-pipeline-chained-dots, can be
+tracked per commit.
+"""
+import json
+import os
+import subprocess
+import sys
+
+import pytest
+import torch
+
+import triton
+import triton.ops
+from triton.testing import get_max_tensorcore_tflops
+
+if not torch.cuda.is_available() or torch.cuda.get_device_capability()[0] < 8:
+    pytest.skip("Flash attention is only supported from compute capability 80", allow_module_level=True)
+
+
+def nvsmi(attrs):
+    attrs = ','.join(attrs)
+    cmd = ['nvidia-smi', '-i', '0', '--query-gpu=' + attrs, '--format=csv,noheader,nounits']
+    out = subprocess.check_output(cmd)
+    ret = out.decode(sys.stdout.encoding).split(',')
+    ret = [int(x) for x in ret]
+    return ret
+
+
+def report(shape, dtype_str, ms, tflops, util):
+    print(f'{ms:.3f} ms \t {tflops:.3f} TFLOP/s \t util={util:.3f}', end='\t')
+    path = os.environ.get("TRITON_ATTENTION_PERF_RESULTS")
+    if not path:
+        return
+    results = []
+    if os.path.exists(path):
+        with open(path) as f:
+            results = json.load(f)
+    results.append({"kernel": "attention_fwd", "shape": list(shape), "dtype": dtype_str, "ms": ms,
+                    "tflops": tflops, "util": util})
+    with open(path, "w") as f:
+        json.dump(results, f, indent=1)
+
+
+def ref_attention(q, k, v, sm_scale):
+    n_ctx = q.shape[2]
+    mask = torch.tril(torch.ones((n_ctx, n_ctx), device=q.device))
+    p = torch.matmul(q, k.transpose(2, 3)) * sm_scale
+    p[:, :, mask == 0] = float("-inf")
+    p = torch.softmax(p.float(), dim=-1).to(q.dtype)
+    return torch.matmul(p, v)
+
+
+@pytest.mark.parametrize("Z, H, N_CTX, D_HEAD", [[4, 48, 1024, 64],
+                                                 [4, 48, 4096, 64],
+                                                 [1, 16, 16384, 64]])
+@pytest.mark.parametrize("dtype_str", ['float16'])
+def test_attention_fwd(Z, H, N_CTX, D_HEAD, dtype_str):
+    torch.manual_seed(20)
+    dtype = {'float16': torch.float16}[dtype_str]
+    q = torch.empty((Z, H, N_CTX, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0.1, std=0.2)
+    k = torch.empty((Z, H, N_CTX, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0.4, std=0.2)
+    v = torch.empty((Z, H, N_CTX, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0.3, std=0.2)
+    sm_scale = 0.2
+    fn = lambda: triton.ops.attention(q, k, v, sm_scale)
+    # the reference materializes the whole attention matrix, check one head
+    torch.testing.assert_close(fn()[:1, :1], ref_attention(q[:1, :1], k[:1, :1], v[:1, :1], sm_scale),
+                               atol=1e-2, rtol=0)
+    ms = triton.testing.do_bench(fn, return_mode="min", warmup=100, rep=500)
+    # causal: half of the blocks of both dots are computed
+    flops_per_matmul = 2. * Z * H * N_CTX * N_CTX * D_HEAD * 0.5
+    tflops = 2 * flops_per_matmul / ms * 1e-9
+    cur_sm_clock = nvsmi(['clocks.current.sm'])[0]
+    max_tflops = get_max_tensorcore_tflops(dtype, clock_rate=cur_sm_clock * 1e3)
+    report((Z, H, N_CTX, D_HEAD), dtype_str, ms, tflops, tflops / max_tflops)
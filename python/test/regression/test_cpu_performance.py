@@ -0,0 +1,285 @@
+"""
+Performance of the tutorial kernels compiled for the host through
+triton-to-linalg, against numpy on the same problems.
+
+The launcher of a kernel compiled for the host runs all the programs of its
+grid on one core, so the problems are split into as many independent shards
+of rows as there are threads, each launched from its own thread (ctypes
+releases the GIL). Each run prints its GB/s or GFLOP/s, those of numpy and
+their ratio, and appends them to the JSON file in TRITON_CPU_PERF_RESULTS if
+set, so that the efficiency of the CPU backend can be tracked per commit.
+"""
+import json
+import os
+import shutil
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+import pytest
+import torch
+
+import triton
+import triton.language as tl
+
+if os.environ.get("CC") is None and shutil.which("gcc") is None and shutil.which("clang") is None:
+    pytest.skip("kernels compiled for the host are linked by a C compiler", allow_module_level=True)
+
+THREADS = sorted({n for n in (1, 2, 4, os.cpu_count() or 1) if n <= (os.cpu_count() or 1)})
+
+#######################
+# Utilities
+#######################
+
+
+def bench(fn, warmup=2, rep=10):
+    # best wall-clock time of `fn` in ms
+    for _ in range(warmup):
+        fn()
+    times = []
+    for _ in range(rep):
+        start = time.perf_counter()
+        fn()
+        times.append(time.perf_counter() - start)
+    return min(times) * 1e3
+
+
+def compile_cpu(fn, signature, **constants):
+    return triton.compile(fn, signature=signature, target="cpu",
+                          constants={fn.arg_names.index(name): value for name, value in constants.items()})
+
+
+def run_sharded(num_threads, num_rows, launch, align=1):
+    # launches `launch(begin, end)` on num_threads disjoint ranges of rows
+    shard = triton.cdiv(triton.cdiv(num_rows, num_threads), align) * align
+    ranges = [(begin, min(begin + shard, num_rows)) for begin in range(0, num_rows, shard)]
+    if len(ranges) == 1:
+        launch(*ranges[0])
+        return
+    with ThreadPoolExecutor(len(ranges)) as executor:
+        list(executor.map(lambda r: launch(*r), ranges))
+
+
+def report(kernel, size, threads, ms, metric, value, ref_value):
+    efficiency = value / ref_value
+    print(f'{ms:.3f} ms \t {value:.3f} {metric} \t numpy: {ref_value:.3f} {metric} \t ratio={efficiency:.3f}', end='\t')
+    path = os.environ.get("TRITON_CPU_PERF_RESULTS")
+    if not path:
+        return
+    results = []
+    if os.path.exists(path):
+        with open(path) as f:
+            results = json.load(f)
+    results.append({"kernel": kernel, "size": list(size), "threads": threads, "ms": ms,
+                    "metric": metric, "value": value, "numpy": ref_value, "ratio": efficiency})
+    with open(path, "w") as f:
+        json.dump(results, f, indent=1)
+
+
+#######################
+# Vector Addition
+#######################
+
+
+@triton.jit
+def _add(x_ptr, y_ptr, output_ptr, n_elements,
+         BLOCK_SIZE: tl.constexpr):
+    pid = tl.program_id(axis=0)
+    block_start = pid * BLOCK_SIZE
+    offsets = block_start + tl.arange(0, BLOCK_SIZE)
+    mask = offsets < n_elements
+    x = tl.load(x_ptr + offsets, mask=mask)
+    y = tl.load(y_ptr + offsets, mask=mask)
+    output = x + y
+    tl.store(output_ptr + offsets, output, mask=mask)
+
+
+@pytest.mark.parametrize('N', [1024 * 256, 1024 * 4096])
+@pytest.mark.parametrize('threads', THREADS)
+def test_vector_add(N, threads):
+    BLOCK_SIZE = 1024
+    kernel = compile_cpu(_add, "*fp32,*fp32,*fp32,i32", BLOCK_SIZE=BLOCK_SIZE)
+    x = torch.randn(N)
+    y = torch.randn(N)
+    z = torch.empty(N)
+
+    def launch(begin, end):
+        kernel[(triton.cdiv(end - begin, BLOCK_SIZE),)](x[begin:end], y[begin:end], z[begin:end], end - begin)
+
+    fn = lambda: run_sharded(threads, N, launch, align=BLOCK_SIZE)
+    fn()
+    torch.testing.assert_close(z, x + y)
+    xn, yn, zn = x.numpy(), y.numpy(), z.numpy()
+    ms = bench(fn)
+    ref_ms = bench(lambda: np.add(xn, yn, out=zn))
+    gbps = lambda ms: 3 * N * z.element_size() / ms * 1e-6
+    report("vector_add", (N,), threads, ms, "GB/s", gbps(ms), gbps(ref_ms))
+
+
+#######################
+# Fused Softmax
+#######################
+
+
+@triton.jit
+def _softmax(output_ptr, input_ptr, input_row_stride, output_row_stride, n_cols,
+             BLOCK_SIZE: tl.constexpr):
+    row_idx = tl.program_id(0)
+    row_start_ptr = input_ptr + row_idx * input_row_stride
+    col_offsets = tl.arange(0, BLOCK_SIZE)
+    input_ptrs = row_start_ptr + col_offsets
+    row = tl.load(input_ptrs, mask=col_offsets < n_cols, other=-float('inf'))
+    row_minus_max = row - tl.max(row, axis=0)
+    numerator = tl.exp(row_minus_max)
+    denominator = tl.sum(numerator, axis=0)
+    softmax_output = numerator / denominator
+    output_row_start_ptr = output_ptr + row_idx * output_row_stride
+    tl.store(output_row_start_ptr + col_offsets, softmax_output, mask=col_offsets < n_cols)
+
+
+def np_softmax(x):
+    z = x - x.max(axis=1, keepdims=True)
+    numerator = np.exp(z)
+    return numerator / numerator.sum(axis=1, keepdims=True)
+
+
+@pytest.mark.parametrize('M, N', [(4096, 256), (1024, 2048)])
+@pytest.mark.parametrize('threads', THREADS)
+def test_softmax(M, N, threads):
+    kernel = compile_cpu(_softmax, "*fp32,*fp32,i32,i32,i32", BLOCK_SIZE=triton.next_power_of_2(N))
+    x = torch.randn(M, N)
+    y = torch.empty(M, N)
+
+    def launch(begin, end):
+        kernel[(end - begin,)](y[begin:end], x[begin:end], x.stride(0), y.stride(0), N)
+
+    fn = lambda: run_sharded(threads, M, launch)
+    fn()
+    torch.testing.assert_close(y, torch.softmax(x, axis=1))
+    xn = x.numpy()
+    ms = bench(fn)
+    ref_ms = bench(lambda: np_softmax(xn))
+    gbps = lambda ms: 2 * M * N * y.element_size() / ms * 1e-6
+    report("softmax", (M, N), threads, ms, "GB/s", gbps(ms), gbps(ref_ms))
+
+
+#######################
+# Matrix Multiplication
+#######################
+
+
+@triton.jit
+def _matmul(a_ptr, b_ptr, c_ptr, M, N, K,
+            stride_am, stride_ak, stride_bk, stride_bn, stride_cm, stride_cn,
+            BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr):
+    pid = tl.program_id(0)
+    num_pid_n = tl.cdiv(N, BLOCK_N)
+    pid_m = pid // num_pid_n
+    pid_n = pid % num_pid_n
+    offs_am = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    offs_bn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    offs_k = tl.arange(0, BLOCK_K)
+    a_ptrs = a_ptr + (offs_am[:, None] * stride_am + offs_k[None, :] * stride_ak)
+    b_ptrs = b_ptr + (offs_k[:, None] * stride_bk + offs_bn[None, :] * stride_bn)
+    accumulator = tl.zeros((BLOCK_M, BLOCK_N), dtype=tl.float32)
+    for k in range(0, K, BLOCK_K):
+        a = tl.load(a_ptrs)
+        b = tl.load(b_ptrs)
+        accumulator += tl.dot(a, b)
+        a_ptrs += BLOCK_K * stride_ak
+        b_ptrs += BLOCK_K * stride_bk
+    c_ptrs = c_ptr + stride_cm * offs_am[:, None] + stride_cn * offs_bn[None, :]
+    tl.store(c_ptrs, accumulator)
+
+
+@pytest.mark.parametrize('M, N, K', [(256, 256, 256), (512, 512, 512)])
+@pytest.mark.parametrize('threads', THREADS)
+def test_matmul(M, N, K, threads):
+    BLOCK_M, BLOCK_N, BLOCK_K = 32, 32, 32
+    kernel = compile_cpu(_matmul, "*fp32,*fp32,*fp32,i32,i32,i32,i32,i32,i32,i32,i32,i32",
+                         BLOCK_M=BLOCK_M, BLOCK_N=BLOCK_N, BLOCK_K=BLOCK_K)
+    a = torch.randn(M, K)
+    b = torch.randn(K, N)
+    c = torch.empty(M, N)
+
+    def launch(begin, end):
+        grid = (triton.cdiv(end - begin, BLOCK_M) * triton.cdiv(N, BLOCK_N),)
+        kernel[grid](a[begin:end], b, c[begin:end], end - begin, N, K,
+                     a.stride(0), a.stride(1), b.stride(0), b.stride(1), c.stride(0), c.stride(1))
+
+    fn = lambda: run_sharded(threads, M, launch, align=BLOCK_M)
+    fn()
+    torch.testing.assert_close(c, a @ b, atol=1e-3, rtol=1e-3)
+    an, bn, cn = a.numpy(), b.numpy(), c.numpy()
+    ms = bench(fn)
+    ref_ms = bench(lambda: np.matmul(an, bn, out=cn))
+    gflops = lambda ms: 2. * M * N * K / ms * 1e-6
+    report("matmul", (M, N, K), threads, ms, "GFLOP/s", gflops(ms), gflops(ref_ms))
+
+
+#######################
+# Layer Normalization
+#######################
+
+
+@triton.jit
+def _layer_norm_fwd(X, Y, W, B, stride, N, eps,
+                    BLOCK_SIZE: tl.constexpr):
+    row = tl.program_id(0)
+    Y += row * stride
+    X += row * stride
+    # compute mean
+    _mean = tl.zeros([BLOCK_SIZE], dtype=tl.float32)
+    for off in range(0, N, BLOCK_SIZE):
+        cols = off + tl.arange(0, BLOCK_SIZE)
+        a = tl.load(X + cols, mask=cols < N, other=0.).to(tl.float32)
+        _mean += a
+    mean = tl.sum(_mean, axis=0) / N
+    # compute variance
+    _var = tl.zeros([BLOCK_SIZE], dtype=tl.float32)
+    for off in range(0, N, BLOCK_SIZE):
+        cols = off + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(X + cols, mask=cols < N, other=0.).to(tl.float32)
+        x = tl.where(cols < N, x - mean, 0.)
+        _var += x * x
+    var = tl.sum(_var, axis=0) / N
+    rstd = 1 / tl.sqrt(var + eps)
+    # normalize and apply linear transformation
+    for off in range(0, N, BLOCK_SIZE):
+        cols = off + tl.arange(0, BLOCK_SIZE)
+        mask = cols < N
+        w = tl.load(W + cols, mask=mask)
+        b = tl.load(B + cols, mask=mask)
+        x = tl.load(X + cols, mask=mask, other=0.).to(tl.float32)
+        x_hat = (x - mean) * rstd
+        y = x_hat * w + b
+        tl.store(Y + cols, y, mask=mask)
+
+
+def np_layer_norm(x, w, b, eps):
+    mean = x.mean(axis=1, keepdims=True)
+    var = ((x - mean) ** 2).mean(axis=1, keepdims=True)
+    return (x - mean) / np.sqrt(var + eps) * w + b
+
+
+@pytest.mark.parametrize('M, N', [(4096, 512), (1024, 4096)])
+@pytest.mark.parametrize('threads', THREADS)
+def test_layer_norm(M, N, threads):
+    eps = 1e-5
+    kernel = compile_cpu(_layer_norm_fwd, "*fp32,*fp32,*fp32,*fp32,i32,i32,fp32", BLOCK_SIZE=256)
+    x = torch.randn(M, N)
+    w = torch.rand(N)
+    b = torch.rand(N)
+    y = torch.empty(M, N)
+
+    def launch(begin, end):
+        kernel[(end - begin,)](x[begin:end], y[begin:end], w, b, x.stride(0), N, eps)
+
+    fn = lambda: run_sharded(threads, M, launch)
+    fn()
+    torch.testing.assert_close(y, torch.nn.functional.layer_norm(x, (N,), w, b, eps), atol=1e-4, rtol=1e-4)
+    xn, wn, bn = x.numpy(), w.numpy(), b.numpy()
+    ms = bench(fn)
+    ref_ms = bench(lambda: np_layer_norm(xn, wn, bn, eps))
+    gbps = lambda ms: 2 * M * N * y.element_size() / ms * 1e-6
+    report("layer_norm", (M, N), threads, ms, "GB/s", gbps(ms), gbps(ref_ms))
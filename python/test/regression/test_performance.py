@@ -1,5 +1,6 @@
 import subprocess
 import sys
+import time
 
 import pytest
 import torch
@@ -210,3 +211,36 @@ def test_flash_attention(Z, H, N_CTX, D_HEAD, mode, dtype_str):
     ref_gpu_util = flash_attention_data[DEVICE_NAME][(Z, H, N_CTX, D_HEAD, mode, dtype_str)]
     print_perf(ms, cur_gpu_util, ref_gpu_util)
     triton.testing.assert_close(cur_gpu_util, ref_gpu_util, atol=0.01, rtol=0.05)
+
+
+#######################
+# Launch Overhead
+#######################
+
+
+@triton.jit
+def _empty(a0, a1, a2, a3, a4, a5, a6, a7, n_elements, BLOCK_SIZE: tl.constexpr):
+    pass
+
+
+def test_launch_overhead():
+    args = [torch.empty(1024, device='cuda') for _ in range(8)]
+
+    def launch_us(**kwargs):
+        # host time of a launch of a compiled kernel, in microseconds
+        _empty[(1,)](*args, 1024, BLOCK_SIZE=1024, **kwargs)
+        torch.cuda.synchronize()
+        num_runs = 1000
+        start = time.perf_counter()
+        for _ in range(num_runs):
+            _empty[(1,)](*args, 1024, BLOCK_SIZE=1024, **kwargs)
+        end = time.perf_counter()
+        torch.cuda.synchronize()
+        return (end - start) / num_runs * 1e6
+
+    native_us = min(launch_us() for _ in range(5))
+    # launches with extern_libs are not dispatched natively, so they build
+    # the key of the binary in Python
+    python_us = min(launch_us(extern_libs={}) for _ in range(5))
+    print(f'native: {native_us:.2f} us \t python: {python_us:.2f} us', end='\t')
+    assert native_us < python_us
@@ -457,6 +457,26 @@ def test_broadcast(dtype):
     assert (y_broadcasted_np == to_numpy(y_broadcasted_tri)).all()
 
 
+def test_broadcast_binary_op():
+    @triton.jit
+    def kernel(x_ptr, y_ptr, z_ptr, M: tl.constexpr, N: tl.constexpr):
+        offset1 = tl.arange(0, M)[:, None]
+        offset2 = tl.arange(0, N)
+        x = tl.load(x_ptr + N * offset1 + offset2[None, :])
+        y = tl.load(y_ptr + offset2)
+        # y is broadcast from rank 1 then extended, as by tl.broadcast and .to
+        tl.store(z_ptr + N * offset1 + offset2[None, :], x + y)
+
+    M = 32
+    N = 64
+    x = torch.randn((M, N), dtype=torch.float32, device='cuda')
+    y = torch.randn(N, dtype=torch.float16, device='cuda')
+    z = torch.empty_like(x)
+    h = kernel[(1,)](x, y, z, M=M, N=N)
+    torch.testing.assert_close(z, x + y.float())
+    assert "arith.extf" in h.asm["ttir"]
+
+
 # ---------------
 # test where
 # ---------------
@@ -1261,6 +1281,53 @@ def test_reduce2d(op, dtype_str, shape, axis, device='cuda'):
             np.testing.assert_equal(z_ref, z_tri)
 
 
+scan2d_shapes = [(8, 32), (16, 32), (32, 16), (2, 1024), (1024, 2), (32, 32), (1, 1024)]
+
+scan_configs = [
+    (op, type, shape, axis)
+    for type in ['int32', 'float32']
+    for axis in [1, 0]
+    for shape in scan2d_shapes
+    for op in ['cumsum', 'cumprod']
+]
+
+
+@pytest.mark.parametrize("op, dtype_str, shape, axis", scan_configs)
+def test_scan2d(op, dtype_str, shape, axis, device='cuda'):
+    check_type_supported(dtype_str)
+
+    # triton kernel
+    @triton.jit
+    def kernel(X, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, AXIS: tl.constexpr):
+        range_m = tl.arange(0, BLOCK_M)
+        range_n = tl.arange(0, BLOCK_N)
+        x = tl.load(X + range_m[:, None] * BLOCK_N + range_n[None, :])
+        z = GENERATE_TEST_HERE
+        tl.store(Z + range_m[:, None] * BLOCK_N + range_n[None, :], z)
+
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.{op}(x, axis={axis})'})
+    # input
+    rs = RandomState(17)
+    x = numpy_random(shape, dtype_str=dtype_str, rs=rs)
+    z = np.empty_like(x)
+    x_tri = to_triton(x, device=device)
+    numpy_op = {'cumsum': np.cumsum, 'cumprod': np.cumprod}[op]
+    z_dtype_str = dtype_str
+    z_ref = numpy_op(x, axis=axis).astype(getattr(np, z_dtype_str))
+    # triton result
+    z_tri = to_triton(z, device=device)
+    kernel[(1,)](x_tri, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], AXIS=axis)
+    z_tri = to_numpy(z_tri)
+    # compare
+    if dtype_str == 'float32':
+        if op == 'cumprod':
+            np.testing.assert_allclose(z_ref, z_tri, rtol=0.01, atol=1e-3)
+        else:
+            np.testing.assert_allclose(z_ref, z_tri, rtol=0.01)
+    else:
+        np.testing.assert_equal(z_ref, z_tri)
+
+
 layouts = [
     BlockedLayout([1, 4], [8, 4], [4, 1], [1, 0]),
     BlockedLayout([1, 4], [8, 4], [4, 1], [0, 1]),
@@ -0,0 +1,142 @@
+import torch
+
+import triton
+import triton.language as tl
+from triton.runtime.cache import TuningDatabase
+
+
+def test_parallel_compile(monkeypatch):
+    # always benchmark, rather than pick up the config of a previous run
+    monkeypatch.setenv("TRITON_TUNING_DB", "")
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32 * 2**i}, num_warps=2**(i % 3)) for i in range(6)]
+
+    @triton.autotune(configs=configs, key=['N'])
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    _kernel[grid](dst, src, N)
+    # every config is compiled and benchmarked, whatever order they finish in
+    assert list(_kernel.configs_timings.keys()) == configs
+    assert _kernel.best_config in configs
+    assert len(_kernel.fn.cache[torch.cuda.current_device()]) == len(configs)
+    torch.testing.assert_close(dst, src)
+
+
+def test_tuning_database(monkeypatch, tmp_path):
+    monkeypatch.setenv("TRITON_TUNING_DB", str(tmp_path / "tuning.json"))
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 128}), triton.Config(kwargs={'BLOCK_SIZE': 256})]
+
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    tuned = triton.autotune(configs=configs, key=['N'])(_kernel)
+    tuned[grid](dst, src, N)
+    assert hasattr(tuned, "configs_timings")
+
+    # a new process would find the config in the database instead of tuning
+    restarted = triton.autotune(configs=configs, key=['N'])(_kernel)
+    restarted[grid](dst, src, N)
+    assert not hasattr(restarted, "configs_timings")
+    assert restarted.best_config is configs[configs.index(tuned.best_config)]
+
+    # the entries exported on one node can be imported on another
+    exported = tmp_path / "exported.json"
+    TuningDatabase().export_entries(str(exported))
+    other = TuningDatabase(str(tmp_path / "other.json"))
+    other.import_entries(str(exported))
+    monkeypatch.setenv("TRITON_TUNING_DB", other.path)
+    imported = triton.autotune(configs=configs, key=['N'])(_kernel)
+    imported[grid](dst, src, N)
+    assert not hasattr(imported, "configs_timings")
+    assert imported.best_config is restarted.best_config
+    torch.testing.assert_close(dst, src)
+
+
+def test_prune_by_resources(monkeypatch):
+    monkeypatch.setenv("TRITON_TUNING_DB", "")
+    M = N = K = 256
+    a = torch.randn((M, K), device='cuda', dtype=torch.float16)
+    b = torch.randn((K, N), device='cuda', dtype=torch.float16)
+    c = torch.empty((M, N), device='cuda', dtype=torch.float32)
+    small = triton.Config({'BLOCK_M': 32, 'BLOCK_N': 32, 'BLOCK_K': 32}, num_warps=4, num_stages=2)
+    # the pipeline buffers of this one don't fit in the shared memory of any GPU
+    huge = triton.Config({'BLOCK_M': 256, 'BLOCK_N': 256, 'BLOCK_K': 128}, num_warps=4, num_stages=5)
+
+    @triton.autotune(configs=[small, huge], key=['M', 'N', 'K'])
+    @triton.jit
+    def _kernel(a, b, c, M, N, K, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr):
+        rm = tl.program_id(0) * BLOCK_M + tl.arange(0, BLOCK_M)
+        rn = tl.program_id(1) * BLOCK_N + tl.arange(0, BLOCK_N)
+        rk = tl.arange(0, BLOCK_K)
+        acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=tl.float32)
+        for k in range(0, K, BLOCK_K):
+            x = tl.load(a + rm[:, None] * K + (k + rk)[None, :])
+            y = tl.load(b + (k + rk)[:, None] * N + rn[None, :])
+            acc += tl.dot(x, y)
+        tl.store(c + rm[:, None] * N + rn[None, :], acc)
+
+    grid = lambda META: (triton.cdiv(M, META['BLOCK_M']), triton.cdiv(N, META['BLOCK_N']))
+    resources = _kernel.fn.run(a, b, c, M, N, K, grid=grid, estimate=True, num_stages=5, **huge.kwargs)
+    assert resources["shared"] > 228 * 1024
+    assert resources["registers"] > 0
+    _kernel[grid](a, b, c, M, N, K)
+    assert list(_kernel.configs_timings.keys()) == [small]
+    torch.testing.assert_close(c, torch.matmul(a.float(), b.float()), atol=1e-2, rtol=1e-2)
+
+
+def test_do_bench_statistics():
+    x = torch.randn(1 << 20, device='cuda')
+    result = triton.testing.do_bench(lambda: x * 2, return_mode="all", reject_outliers=True, rel_ci=0.05)
+    assert len(result.kept) <= len(result.samples)
+    lo, hi = result.ci
+    assert result.min <= lo <= result.median <= hi <= result.max
+    assert result.percentiles[20] <= result.percentiles[50] <= result.percentiles[80]
+    # the slowest iterations, e.g. preempted ones, are rejected
+    noisy = triton.testing.BenchmarkResult([1.0] * 99 + [50.0], reject_outliers=True)
+    assert len(noisy.kept) == 99 and noisy.max == 1.0
+
+
+def test_significant_winner():
+    Result = triton.testing.BenchmarkResult
+    first, second, third = [triton.Config(kwargs={'BLOCK_SIZE': 32 * 2**i}) for i in range(3)]
+    # within noise of each other, the first config wins whichever is faster
+    timings = {first: Result([1.02, 1.0, 1.04] * 10), second: Result([1.0, 0.98, 1.02] * 10)}
+    assert triton.runtime.Autotuner._pick_best(timings) is first
+    # a significantly faster one wins
+    timings[third] = Result([0.5, 0.51, 0.49] * 10)
+    assert triton.runtime.Autotuner._pick_best(timings) is third
+
+
+def test_occupancy_pruning():
+    from types import SimpleNamespace
+    from triton.compiler.compiler import get_occupancy
+    # 128 registers per thread leave room for 4 programs of 4 warps on sm_80
+    occupancy = get_occupancy(80, 4, 128, 0)
+    assert occupancy == {"programs_per_sm": 4, "occupancy": 0.25, "limiter": "registers"}
+    assert get_occupancy(80, 4, 32, 100 * 1024)["limiter"] == "shared"
+    config = triton.Config(kwargs={'BLOCK_SIZE': 128}, num_warps=4)
+
+    def compiled(**ptxas_info):
+        metadata = {"ptxas_info": ptxas_info,
+                    "occupancy": get_occupancy(80, 4, ptxas_info["registers"], 0)}
+        return SimpleNamespace(metadata=metadata)
+    lacks_resources = triton.runtime.Autotuner._lacks_resources
+    assert not lacks_resources(config, compiled(registers=128, spill_stores=0, spill_loads=0))
+    assert lacks_resources(config, compiled(registers=255, spill_stores=64, spill_loads=64))
+    # binaries compiled by a hook are not known
+    assert not lacks_resources(config, None)
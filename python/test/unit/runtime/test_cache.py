@@ -1,3 +1,4 @@
+import ast
 import multiprocessing
 import os
 import shutil
@@ -8,6 +9,8 @@ import torch
 
 import triton
 import triton.language as tl
+from triton.runtime.cache import (FileCacheManager, RemoteCacheBackend,
+                                  RemoteCacheManager, clear_memory_cache)
 from triton.runtime.jit import JITFunction
 
 tmpdir = ".tmp"
@@ -69,10 +72,39 @@ def test_nested1_change():
     assert baseline != updated
 
 
+def test_dependencies_hash_reuse(monkeypatch):
+    kernel.hash = None
+    function_1.hash = None
+    function_2.hash = None
+    baseline = kernel.cache_key
+    # the hashes of the callees are reused rather than walked again
+    walks = []
+    monkeypatch.setattr(JITFunction, "parse", lambda self: walks.append(self) or ast.parse(self.src))
+    kernel.hash = None
+    assert kernel.cache_key == baseline
+    assert walks == [kernel]
+
+
+def test_ptxas_version_key(monkeypatch, tmp_path):
+    from triton.runtime import jit
+    if jit._path_to_ptxas() is None:
+        pytest.skip("requires ptxas")
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    jit.ptxas_version_key.cache_clear()
+    version = jit.ptxas_version_key()
+    assert version and (tmp_path / "ptxas_version.json").exists()
+    # later processes read the version of the same binary from the cache
+    jit.ptxas_version_key.cache_clear()
+    monkeypatch.setattr(jit.subprocess, "check_output", None)
+    assert jit.ptxas_version_key() == version
+    jit.ptxas_version_key.cache_clear()
+
+
 def reset_tmp_dir():
     os.environ["TRITON_CACHE_DIR"] = tmpdir
     if os.path.exists(tmpdir):
         shutil.rmtree(tmpdir)
+    clear_memory_cache()
 
 
 def test_reuse():
@@ -210,3 +242,267 @@ def test_memory_leak() -> None:
         x0 = xindex
         tmp0 = tl.load(in_ptr0 + (x0), xmask)
         tl.store(out_ptr0 + (x0 + tl.zeros([XBLOCK], tl.int32)), tmp0, xmask)
+
+
+def test_ptxas_info() -> None:
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    compiled = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    info = compiled.metadata["ptxas_info"]
+    assert info["registers"] > 0
+    assert info["spill_stores"] == 0
+    assert info["spill_loads"] == 0
+
+
+def test_compile_timings() -> None:
+    reset_tmp_dir()
+
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    compiled = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    timings = compiled.metadata["timings"]
+    assert {"ttir", "ttgir", "llir"} <= timings["stages"].keys()
+    assert all(t >= 0 for t in timings["stages"].values())
+    passes = timings["passes"]["ttgir"]
+    assert "tritongpu-coalesce" in [p["pass"] for p in passes]
+    assert all(p["count"] > 0 and p["time"] >= 0 for p in passes)
+    # the timings of the first compilation are served from the cache
+    kernel_add.cache.clear()
+    cached = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    assert cached.metadata["timings"] == timings
+
+
+def test_compile_remarks(monkeypatch, capfd) -> None:
+    reset_tmp_dir()
+
+    @triton.jit
+    def kernel_strided(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + 2 * idx))
+
+    compiled = kernel_strided.warmup(torch.float32, torch.float32, 1024, grid=(1,))
+    assert "remarks" not in compiled.metadata
+    monkeypatch.setenv("TRITON_REMARKS", "1")
+    kernel_strided.cache.clear()
+    compiled = kernel_strided.warmup(torch.float32, torch.float32, 1024, grid=(1,))
+    remarks = compiled.metadata["remarks"]["ttgir"]
+    assert any("[tritongpu-coalesce] accesses are not vectorized" in r for r in remarks)
+    assert "kernel_strided.ttgir: remark:" in capfd.readouterr().err
+
+
+def test_remote_cache() -> None:
+    class DictBackend(RemoteCacheBackend):
+        def __init__(self):
+            self.files = {}
+
+        def get(self, key, filename):
+            return self.files.get((key, filename))
+
+        def put(self, key, filename, data):
+            self.files[(key, filename)] = data
+
+    backend = DictBackend()
+    reset_tmp_dir()
+    manager = RemoteCacheManager("key", backend)
+    group = {"kernel.cubin": manager.put(b"cubin", "kernel.cubin"),
+             "kernel.json": manager.put("{}", "kernel.json", binary=False)}
+    manager.put_group("kernel.json", group)
+    assert ("key", "__grp__kernel.json") in backend.files
+    # another host fetches the whole group from the remote store
+    reset_tmp_dir()
+    manager = RemoteCacheManager("key", backend)
+    assert manager.get_group("missing.json") is None
+    group = manager.get_group("kernel.json")
+    assert sorted(group) == ["kernel.cubin", "kernel.json"]
+    with open(group["kernel.cubin"], "rb") as f:
+        assert f.read() == b"cubin"
+    assert os.path.exists(os.path.join(tmpdir, "key", "__grp__kernel.json"))
+
+
+def test_removed_cache_files() -> None:
+    reset_tmp_dir()
+    manager = FileCacheManager("key")
+    group = {"kernel.cubin": manager.put(b"cubin", "kernel.cubin"),
+             "kernel.json": manager.put("{}", "kernel.json", binary=False)}
+    manager.put_group("kernel.json", group)
+    assert manager.get_group("kernel.json") == group
+    # files removed behind the back of the process, e.g. by another one, are
+    # still returned from memory until opening them fails and they are evicted
+    shutil.rmtree(tmpdir)
+    assert manager.get_file("kernel.json") == group["kernel.json"]
+    assert manager.get_group("kernel.json") == group
+    with pytest.raises(FileNotFoundError):
+        open(group["kernel.json"])
+    manager.evict("kernel.json")
+    assert manager.get_file("kernel.json") is None
+    assert manager.get_group("kernel.json") is None
+    assert manager.get_file("kernel.cubin") == group["kernel.cubin"]
+
+
+def test_stage_cache() -> None:
+    reset_tmp_dir()
+
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    first = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,), num_stages=2)
+    assert {"ttir", "ttgir"} <= first.metadata["timings"]["stages"].keys()
+    # only the stages after ttir depend on num_stages
+    second = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,), num_stages=3)
+    assert "ttir" not in second.metadata["timings"]["stages"]
+    assert "ttgir" in second.metadata["timings"]["stages"]
+    assert second.asm["ttir"] == first.asm["ttir"]
+
+
+def test_opt_level(monkeypatch) -> None:
+    reset_tmp_dir()
+
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    first = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    assert first.metadata["opt_level"] == 3
+    monkeypatch.setenv("TRITON_OPT_LEVEL", "0")
+    kernel_add.cache.clear()
+    second = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    assert second.metadata["opt_level"] == 0
+    # only the stages from llir on depend on the optimization level
+    assert "ttgir" not in second.metadata["timings"]["stages"]
+    assert "llir" in second.metadata["timings"]["stages"]
+    assert second.asm["ttgir"] == first.asm["ttgir"]
+    with pytest.raises(ValueError):
+        triton.compile(kernel_add, signature="*fp32,*fp32,*fp32", constants={3: 32}, opt_level=4)
+
+
+def test_context_pool() -> None:
+    pool = triton._C.libtriton.triton.ir.context_pool(2)
+    context = pool.acquire()
+    pool.release(context)
+    assert len(pool) == 1
+    # the context is reused, and dropped after its last use
+    assert pool.acquire() is context
+    pool.release(context)
+    assert len(pool) == 0
+    assert pool.acquire() is not context
+
+
+def test_single_flight_compile(monkeypatch) -> None:
+    import threading
+    import triton.compiler.compiler as compiler
+    reset_tmp_dir()
+    counter = 0
+    ast_to_ttir = compiler.ast_to_ttir
+
+    def count_ast_to_ttir(*args, **kwargs):
+        nonlocal counter
+        counter += 1
+        return ast_to_ttir(*args, **kwargs)
+    monkeypatch.setattr(compiler, "ast_to_ttir", count_ast_to_ttir)
+
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    barrier = threading.Barrier(4)
+    kernels = []
+
+    def compile_kernel():
+        barrier.wait()
+        kernels.append(triton.compile(kernel_add, signature="*fp32,*fp32,*fp32", constants={3: 32}))
+
+    threads = [threading.Thread(target=compile_kernel) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert len(kernels) == 4
+    # the threads that waited for the first compilation found it in the cache
+    assert counter == 1
+    assert all(k.asm["ptx"] == kernels[0].asm["ptx"] for k in kernels)
+
+
+def test_unload() -> None:
+    reset_tmp_dir()
+
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    a = torch.randn(32, device='cuda')
+    b = torch.randn(32, device='cuda')
+    o = torch.empty(32, device='cuda')
+    # modules are only loaded by launches
+    bin = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    assert not bin.handles
+    kernel_add[(1,)](a, b, o, N=32)
+    assert o.tolist() == (a + b).tolist()
+    device = torch.cuda.current_device()
+    assert set(bin.handles) == {device}
+    # an unloaded kernel is loaded again by its next launch
+    bin.unload()
+    assert not bin.handles and bin.cu_function is None
+    o.zero_()
+    kernel_add[(1,)](a, b, o, N=32)
+    assert o.tolist() == (a + b).tolist()
+    assert set(bin.handles) == {device}
+
+
+def test_dispatched_launch_refreshes_module() -> None:
+    reset_tmp_dir()
+
+    @triton.jit
+    def kernel_copy(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx))
+
+    a = torch.randn(32, device='cuda')
+    o = torch.empty(32, device='cuda')
+    o2 = torch.empty(32, device='cuda')
+    copy = kernel_copy[(1,)](a, o, N=32)
+    other = kernel_copy[(1,)](a, o, N=16)
+    device = torch.cuda.current_device()
+    last_launch = triton._C.libtriton.triton.runtime.last_launch
+    assert last_launch(id(other), device) > last_launch(id(copy), device)
+    # the second launch is dispatched natively and marks its module as the
+    # most recently launched one, so it is not the first one unloaded
+    assert kernel_copy[(1,)](a, o2, N=32) is copy
+    assert len(kernel_copy.dispatcher) == 2
+    assert last_launch(id(copy), device) > last_launch(id(other), device)
+    assert o2.tolist() == a.tolist()
+
+
+def test_lean_asm(monkeypatch) -> None:
+    reset_tmp_dir()
+
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    full = triton.compile(kernel_add, signature="*fp32,*fp32,*fp32", constants={3: 32})
+    monkeypatch.setenv("TRITON_LEAN_ASM", "1")
+    lean = triton.compile(kernel_add, signature="*fp32,*fp32,*fp32", constants={3: 32})
+    # only the binary is held, the other stages are read from the cache
+    assert set(dict.keys(lean.asm)) == {"ast", "cubin"}
+    assert set(lean.asm) == set(full.asm)
+    for ir in ("ttir", "ttgir", "llir", "ptx", "cubin"):
+        assert lean.asm[ir] == full.asm[ir]
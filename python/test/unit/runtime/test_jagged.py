@@ -0,0 +1,48 @@
+import pytest
+import torch
+
+import triton
+import triton.language as tl
+from triton.runtime import JaggedGrid
+
+
+def test_tables():
+    # sequences of 5, 0, 7 and 1 tokens
+    offsets = torch.tensor([0, 5, 5, 12, 13], dtype=torch.int32)
+    grid = JaggedGrid(offsets, 4, 3)
+    assert grid.num_seqs == 4
+    assert grid.num_tiles == 5
+    assert grid({}) == (5, 3)
+    assert grid.tile_seqs.tolist() == [0, 0, 2, 2, 3]
+    assert grid.tile_starts.tolist() == [0, 4, 5, 9, 12]
+    assert grid.tile_ends.tolist() == [4, 5, 9, 12, 13]
+
+
+@pytest.mark.parametrize("lengths", [[1, 130, 0, 64, 65], [0, 0], [300]])
+def test_launch(lengths):
+
+    @triton.jit
+    def kernel(X, Y, SCALES, tile_seqs, tile_starts, tile_ends, stride, BLOCK: tl.constexpr,
+               DIM: tl.constexpr):
+        pid = tl.program_id(0)
+        seq = tl.load(tile_seqs + pid)
+        start = tl.load(tile_starts + pid)
+        end = tl.load(tile_ends + pid)
+        rows = start + tl.arange(0, BLOCK)
+        cols = tl.arange(0, DIM)
+        offs = rows[:, None] * stride + cols[None, :]
+        mask = rows[:, None] < end
+        x = tl.load(X + offs, mask=mask)
+        tl.store(Y + offs, x * tl.load(SCALES + seq), mask=mask)
+
+    lengths = torch.tensor(lengths, device="cuda")
+    offsets = torch.cat([lengths.new_zeros(1), torch.cumsum(lengths, 0)])
+    num_tokens = int(offsets[-1])
+    x = torch.randn((num_tokens, 32), device="cuda")
+    y = torch.full_like(x, float("nan"))
+    scales = torch.randn(lengths.numel(), device="cuda")
+    grid = JaggedGrid(offsets, 64)
+    kernel[grid](x, y, scales, grid.tile_seqs, grid.tile_starts, grid.tile_ends, x.stride(0),
+                 BLOCK=64, DIM=32)
+    ref = x * torch.repeat_interleave(scales, lengths)[:, None]
+    torch.testing.assert_close(y, ref)
@@ -7,6 +7,7 @@ import gc
 # import time
 import tracemalloc
 
+import pytest
 import torch
 
 import triton
@@ -104,3 +105,170 @@ def test_memory_leak() -> None:
 
 #     # Run empty, which would run empty_kernel internally
 #     empty(*kernel_args)
+
+
+def test_native_dispatch() -> None:
+
+    @triton.jit
+    def kernel(in_ptr0, out_ptr0, xnumel, XBLOCK: tl.constexpr):
+        xindex = tl.program_id(0) * XBLOCK + tl.arange(0, XBLOCK)
+        xmask = xindex < xnumel
+        tl.store(out_ptr0 + xindex, tl.load(in_ptr0 + xindex, xmask) + 1, xmask)
+
+    device = torch.cuda.current_device()
+    inp = torch.randn(64, device='cuda')
+    out = torch.empty(64, device='cuda')
+    kernel[(4,)](inp, out, 64, XBLOCK=16)
+    assert len(kernel.dispatcher) == 1
+    # relaunched natively
+    out.zero_()
+    kernel[(4,)](inp, out, 64, XBLOCK=16)
+    torch.testing.assert_close(out, inp + 1)
+    assert len(kernel.cache[device]) == 1
+    # other specializations and constexprs get their own binaries
+    kernel[(4,)](inp, out, 63, XBLOCK=16)
+    kernel[(2,)](inp, out, 64, XBLOCK=32)
+    assert len(kernel.cache[device]) == 3
+    assert len(kernel.dispatcher) == 3
+    # binaries evicted from the cache are compiled again
+    kernel.cache[device].clear()
+    out.zero_()
+    kernel[(4,)](inp, out, 64, XBLOCK=16)
+    torch.testing.assert_close(out, inp + 1)
+    assert len(kernel.cache[device]) == 1
+
+
+def test_kernel_graph() -> None:
+
+    @triton.jit
+    def kernel(in_ptr0, out_ptr0, xnumel, XBLOCK: tl.constexpr):
+        xindex = tl.program_id(0) * XBLOCK + tl.arange(0, XBLOCK)
+        xmask = xindex < xnumel
+        tl.store(out_ptr0 + xindex, tl.load(in_ptr0 + xindex, xmask) * 2, xmask)
+
+    inp = torch.randn(64, device='cuda')
+    tmp = torch.empty(64, device='cuda')
+    out = torch.empty(64, device='cuda')
+    graph = triton.runtime.KernelGraph()
+    kernel.add_to_graph(graph, (4,), inp, tmp, 64, XBLOCK=16)
+    node = kernel.add_to_graph(graph, lambda meta: (64 // meta['XBLOCK'],), tmp, out, 64, XBLOCK=16)
+    assert len(graph) == 2
+    graph.launch()
+    torch.testing.assert_close(out, inp * 4)
+    # the second launch writes to another tensor on replay
+    other = torch.zeros(64, device='cuda')
+    kernel.update_graph(graph, node, tmp, other, 64, XBLOCK=16)
+    out.zero_()
+    graph.launch()
+    torch.testing.assert_close(other, inp * 4)
+    assert torch.count_nonzero(out) == 0
+    # arguments that select another binary cannot be swapped in
+    with pytest.raises(ValueError):
+        kernel.update_graph(graph, node, tmp, other, 63, XBLOCK=16)
+
+
+def test_region_profile() -> None:
+
+    @triton.jit
+    def kernel(in_ptr0, out_ptr0, xnumel, XBLOCK: tl.constexpr):
+        acc = tl.zeros([XBLOCK], tl.float32)
+        tl.profile_start("loop")
+        for i in range(0, xnumel, XBLOCK):
+            acc += tl.load(in_ptr0 + i + tl.arange(0, XBLOCK))
+        tl.profile_end("loop")
+        tl.store(out_ptr0 + tl.arange(0, XBLOCK), acc)
+
+    inp = torch.randn(1024, device='cuda')
+    out = torch.empty(64, device='cuda')
+    profile = triton.runtime.RegionProfile(loops=True)
+    kernel[(2,)](inp, out, 1024, XBLOCK=64, num_warps=4, profile=profile)
+    torch.testing.assert_close(out, inp.view(-1, 64).sum(0))
+    summary = profile.summary()
+    # the whole loop once per warp, and each of its 16 iterations
+    assert summary["loop"]["count"] == 2 * 4
+    loop = [region for region in summary if region.startswith("scf.for")]
+    assert len(loop) == 1 and summary[loop[0]]["count"] == 2 * 4 * 16
+    assert all(s["total"] > 0 for s in summary.values())
+    # the profiled binary does not replace the one of unprofiled launches
+    kernel[(2,)](inp, out, 1024, XBLOCK=64, num_warps=4)
+    assert len(profile.launches) == 1
+
+
+def test_fused_kernel() -> None:
+
+    @triton.jit
+    def scale(in_ptr0, out_ptr0, xnumel, XBLOCK: tl.constexpr):
+        xindex = tl.program_id(0) * XBLOCK + tl.arange(0, XBLOCK)
+        xmask = xindex < xnumel
+        tl.store(out_ptr0 + xindex, tl.load(in_ptr0 + xindex, xmask) * 2, xmask)
+
+    @triton.jit
+    def row_sum(in_ptr0, out_ptr0, RBLOCK: tl.constexpr):
+        row = tl.program_id(0)
+        x = tl.load(in_ptr0 + row * RBLOCK + tl.arange(0, RBLOCK))
+        tl.store(out_ptr0 + row, tl.sum(x, axis=0))
+        # the count of programs is the one of the launch, not of the fusion
+        tl.store(out_ptr0 + tl.num_programs(0) + row, row)
+
+    a = torch.randn(100, device='cuda')
+    b = torch.randn(8, 32, device='cuda')
+    out_a = torch.empty(100, device='cuda')
+    out_b = torch.empty(16, device='cuda')
+    fused = triton.runtime.FusedKernel(num_warps=4)
+    fused((scale, (4,), (a, out_a, 100, 32)), (row_sum, 8, (b, out_b, 32)))
+    torch.testing.assert_close(out_a, a * 2)
+    torch.testing.assert_close(out_b[:8], b.sum(1))
+    torch.testing.assert_close(out_b[8:], torch.arange(8, device='cuda', dtype=torch.float32))
+    # launches of the same specializations reuse the fused binary
+    fused((scale, (3,), (out_a, a, 68, 32)), (row_sum, 8, (b, out_b, 32)))
+    torch.testing.assert_close(a[:68], out_a[:68] * 2)
+    assert len(fused.cache) == 1
+    # grids of several dimensions cannot be fused
+    with pytest.raises(ValueError):
+        fused((scale, (2, 2), (a, out_a, 100, 32)))
+
+
+def test_cluster_launch() -> None:
+
+    @triton.jit
+    def kernel(in_ptr0, out_ptr0, XBLOCK: tl.constexpr):
+        xindex = tl.program_id(0) * XBLOCK + tl.arange(0, XBLOCK)
+        tl.store(out_ptr0 + xindex, tl.load(in_ptr0 + xindex) + 1)
+
+    inp = torch.randn(256, device='cuda')
+    out = torch.empty(256, device='cuda')
+    if torch.cuda.get_device_capability()[0] < 9:
+        with pytest.raises(ValueError):
+            kernel[(4,)](inp, out, XBLOCK=64, num_ctas=2)
+        return
+    bin = kernel[(4,)](inp, out, XBLOCK=64, num_ctas=2)
+    torch.testing.assert_close(out, inp + 1)
+    assert bin.metadata["num_ctas"] == 2
+    assert '"triton_gpu.num-ctas" = 2' in bin.asm["ttgir"]
+    # clusters tile the programs along axis 0
+    with pytest.raises(ValueError):
+        kernel[(3,)](inp, out, XBLOCK=64, num_ctas=2)
+
+
+def test_grid_barrier() -> None:
+
+    @triton.jit
+    def kernel(in_ptr0, partial_ptr0, out_ptr0, XBLOCK: tl.constexpr):
+        # each program sums its block, then all of them normalize their block
+        # by the sum of all the partial sums
+        pid = tl.program_id(0)
+        xindex = pid * XBLOCK + tl.arange(0, XBLOCK)
+        x = tl.load(in_ptr0 + xindex)
+        tl.store(partial_ptr0 + pid, tl.sum(x, axis=0))
+        tl.grid_barrier()
+        total = tl.sum(tl.load(partial_ptr0 + tl.arange(0, 16)), axis=0)
+        tl.store(out_ptr0 + xindex, x / total)
+
+    inp = torch.rand(16 * 64, device='cuda')
+    partial = torch.empty(16, device='cuda')
+    out = torch.empty_like(inp)
+    for _ in range(2):
+        bin = kernel[(16,)](inp, partial, out, XBLOCK=64)
+        torch.testing.assert_close(out, inp / inp.sum())
+    assert bin.metadata["grid_barrier"]
+    assert "membar.gl" in bin.asm["ptx"]
@@ -0,0 +1,67 @@
+import argparse
+import ctypes
+import os
+import textwrap
+
+import pytest
+import torch
+
+from triton.tools import aot
+
+kernel_src = textwrap.dedent("""
+    import triton
+    import triton.language as tl
+
+
+    @triton.jit
+    def add_kernel(x_ptr, y_ptr, out_ptr, n, BLOCK: tl.constexpr, SCALE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offsets < n
+        x = tl.load(x_ptr + offsets, mask=mask)
+        y = tl.load(y_ptr + offsets, mask=mask)
+        tl.store(out_ptr + offsets, (x + y) * SCALE, mask=mask)
+""")
+
+# the float constexpr is declared for the grid and the condition too
+configs = ["BLOCK=1024; SCALE=2.0; num_warps=8; divisible_by_16=x_ptr,y_ptr,out_ptr; "
+           "grid=(n + BLOCK - 1) / BLOCK; when=n >= 4 * BLOCK && SCALE > 1.0",
+           "BLOCK=128; SCALE=2.0; grid=(n + BLOCK - 1) / BLOCK"]
+
+
+def sm():
+    if torch.cuda.is_available():
+        major, minor = torch.cuda.get_device_capability()
+        return major * 10 + minor
+    return 80
+
+
+def build(tmp_path, shared):
+    src = tmp_path / "kernel.py"
+    src.write_text(kernel_src)
+    args = argparse.Namespace(src=str(src), kernel="add_kernel", signature="*fp32,*fp32,*fp32,i32", config=configs,
+                              sm=sm(), out_name="add", out_dir=str(tmp_path / "out"), shared=shared)
+    return aot.compile_library(args)
+
+
+def test_library_compiles(tmp_path):
+    lib = build(tmp_path, shared=False)
+    assert os.path.exists(lib)
+    source = (tmp_path / "out" / "add.c").read_text()
+    assert "const int64_t BLOCK = 1024LL;" in source
+    assert "const double SCALE = 0x1.0000000000000p+1;" in source
+    assert source.count("add_launch(") == 3
+
+
+@pytest.mark.skipif(not torch.cuda.is_available(), reason="requires a GPU")
+def test_library_dispatch(tmp_path):
+    lib = ctypes.CDLL(build(tmp_path, shared=True))
+    lib.add.argtypes = [ctypes.c_void_p, ctypes.c_uint64, ctypes.c_uint64, ctypes.c_uint64, ctypes.c_int32]
+    # the first config for large sizes, the second one for the others
+    for n in [100, 5000]:
+        x = torch.randn(n, device='cuda')
+        y = torch.randn(n, device='cuda')
+        out = torch.empty(n, device='cuda')
+        assert lib.add(None, x.data_ptr(), y.data_ptr(), out.data_ptr(), n) == 0
+        torch.cuda.synchronize()
+        assert torch.allclose(out, (x + y) * 2)
+    assert lib.add_unload() == 0
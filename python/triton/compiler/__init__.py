@@ -1,4 +1,4 @@
-from .compiler import CompiledKernel, compile
+from .compiler import CompiledKernel, CPUCompiledKernel, compile, compile_fused, estimate_resources
 from .errors import CompilationError
 
-__all__ = ["compile", "CompiledKernel", "CompilationError"]
+__all__ = ["compile", "compile_fused", "estimate_resources", "CompiledKernel", "CPUCompiledKernel", "CompilationError"]
@@ -954,12 +954,13 @@ def kernel_suffix(signature, specialization):
     return suffix
 
 
-def ast_to_ttir(fn, signature, specialization, constants, debug):
+def ast_to_ttir(fn, signature, specialization, constants, debug, context=None):
     # canonicalize signature
     if isinstance(signature, str):
         signature = {k: v.strip() for k, v in enumerate(signature.split(","))}
-    context = ir.context()
-    context.load_triton()
+    if context is None:
+        context = ir.context()
+        context.load_triton()
     # create kernel prototype
     cst_key = lambda i: fn.arg_names.index(i) if isinstance(i, str) else i
     constants = {cst_key(key): value for key, value in constants.items()}
@@ -1,12 +1,19 @@
 from __future__ import annotations
 
+import contextlib
+import ctypes
 import functools
 import hashlib
 import json
 import os
 import re
+import shutil
 import subprocess
+import sys
 import tempfile
+import threading
+import time
+import weakref
 from collections import namedtuple
 from pathlib import Path
 from typing import Any, Tuple
@@ -18,28 +25,70 @@ import triton._C.libtriton.triton as _triton
 from ..runtime import driver
 # TODO: runtime.errors
 from ..runtime.autotuner import OutOfResources
-from ..runtime.cache import get_cache_manager
+from ..runtime.cache import get_cache_manager, single_flight
 from ..tools.disasm import extract
 from .code_generator import ast_to_ttir
 from .make_launcher import make_stub
 
 
+# The passes timed by run_passes while compiling a stage, see compile()
+_pass_timings = threading.local()
+
+# Contexts with the dialects of the compiler loaded, reused by compilations
+# and recycled after TRITON_CONTEXT_MAX_USES of them
+_context_pool = _triton.ir.context_pool(int(os.environ.get("TRITON_CONTEXT_MAX_USES", 64)))
+
+
+# With TRITON_REMARKS set, the passes report the optimizations they miss, and
+# why, as remarks on the ops they give up on. They are printed when a stage is
+# compiled and kept in the metadata of the kernel
+_remarks = threading.local()
+
+
+def remarks_enabled():
+    # as parsed by triton::tools::getBoolEnv; kernels compiled with remarks
+    # have their own cache entries, so that they are compiled again and report
+    return os.environ.get("TRITON_REMARKS", "").lower() in ("on", "true", "1")
+
+
+def lean_asm_enabled():
+    # compiled kernels only keep their binaries in memory, see LeanAsm
+    return os.environ.get("TRITON_LEAN_ASM", "").lower() in ("on", "true", "1")
+
+
+def default_opt_level():
+    # the level LLVM optimizes and generates code at when compile isn't given
+    # one; lower ones compile faster, for development and autotuning
+    return int(os.environ.get("TRITON_OPT_LEVEL", 3))
+
+
+def run_passes(pm, mod):
+    timings = pm.enable_timing()
+    remarks = pm.run(mod)
+    records = getattr(_pass_timings, "records", None)
+    if records is not None:
+        records.extend(json.loads(timings.json()))
+    stage_remarks = getattr(_remarks, "records", None)
+    if stage_remarks is not None:
+        stage_remarks.extend(remarks)
+
+
 def inline_triton_ir(mod):
     pm = _triton.ir.pass_manager(mod.context)
     pm.enable_debug()
     pm.add_inliner_pass()
-    pm.run(mod)
+    run_passes(pm, mod)
     return mod
 
 
 def ttir_compute_capability_rewrite(mod, arch):
-    # For hardware without support, we must rewrite all load/store
-    # with block (tensor) pointers into tensors of pointers
+    # We must rewrite all load/store with block (tensor) pointers into tensors
+    # of pointers, except for the loads that Hopper copies with TMA
     pm = _triton.ir.pass_manager(mod.context)
     pm.enable_debug()
     if _is_cuda(arch):
         pm.add_rewrite_tensor_pointer_pass(arch)
-    pm.run(mod)
+    run_passes(pm, mod)
     return mod
 
 
@@ -54,38 +103,90 @@ def optimize_ttir(mod, arch):
     pm.add_cse_pass()
     pm.add_licm_pass()
     pm.add_symbol_dce_pass()
-    pm.run(mod)
+    run_passes(pm, mod)
     return mod
 
 
-def ttir_to_ttgir(mod, num_warps):
+def ttir_to_ttgir(mod, num_warps, threads_per_warp=32, num_ctas=1):
     pm = _triton.ir.pass_manager(mod.context)
-    pm.add_convert_triton_to_tritongpu_pass(num_warps)
-    pm.run(mod)
+    pm.add_convert_triton_to_tritongpu_pass(num_warps, threads_per_warp, num_ctas)
+    run_passes(pm, mod)
     return mod
 
 
-def optimize_ttgir(mod, num_stages, arch):
+def optimize_ttgir(mod, num_stages, arch, persistent=False, pipeline_tiles=False, split_k=1, epilogue_smem=0):
     pm = _triton.ir.pass_manager(mod.context)
     pm.enable_debug()
     pm.add_tritongpu_coalesce_pass()
     pm.add_tritongpu_remove_layout_conversions_pass()
-    if isinstance(arch, int):
+    if _is_cuda(arch):
         pm.add_tritongpu_accelerate_matmul_pass(arch)
+    elif get_matrix_core_version(arch) > 0:
+        pm.add_tritongpu_accelerate_matmul_pass(0, get_matrix_core_version(arch))
     pm.add_tritongpu_remove_layout_conversions_pass()
     pm.add_tritongpu_optimize_dot_operands_pass()
-    pm.add_tritongpu_pipeline_pass(num_stages)
-    pm.add_tritongpu_prefetch_pass()
+    if split_k > 1:
+        pm.add_tritongpu_split_k_pass(split_k)
+    if persistent:
+        pm.add_tritongpu_persistent_kernel_pass(pipeline_tiles)
+    # Without cp.async, AMD GPUs double buffer the loads through registers
+    pm.add_tritongpu_pipeline_pass(num_stages, not _is_cuda(arch))
+    if num_stages > 1:
+        pm.add_tritongpu_pipeline_chained_dots_pass()
+    pm.add_tritongpu_prefetch_pass(1, 0)
     pm.add_tritongpu_optimize_dot_operands_pass()
+    if epilogue_smem > 0:
+        pm.add_tritongpu_coalesce_epilogue_pass(epilogue_smem)
     pm.add_tritongpu_remove_layout_conversions_pass()
     pm.add_tritongpu_decompose_conversions_pass()
     pm.add_tritongpu_reorder_instructions_pass()
     pm.add_cse_pass()
     pm.add_symbol_dce_pass()
-    pm.run(mod)
+    run_passes(pm, mod)
     return mod
 
 
+def profile_ttgir(mod, profile):
+    if profile is None:
+        return mod
+    pm = _triton.ir.pass_manager(mod.context)
+    pm.enable_debug()
+    pm.add_tritongpu_instrument_regions_pass(profile["capacity"], profile["loops"], profile["dots"],
+                                             profile["loads"], profile["global_timer"])
+    run_passes(pm, mod)
+    return mod
+
+
+def grid_barriers_ttgir(mod, arch):
+    # the counter of the grid barriers is passed after the profile buffer
+    if not _triton.has_grid_barriers(mod):
+        return mod
+    if not _is_cuda(arch):
+        raise NotImplementedError("grid barriers are only supported on NVIDIA GPUs")
+    pm = _triton.ir.pass_manager(mod.context)
+    pm.enable_debug()
+    pm.add_tritongpu_grid_barriers_pass()
+    run_passes(pm, mod)
+    return mod
+
+
+def ttir_to_linalg(mod, split_k=1):
+    pm = _triton.ir.pass_manager(mod.context)
+    pm.enable_debug()
+    pm.add_triton_to_linalg_pass()
+    if split_k > 1:
+        pm.add_triton_linalg_split_k_pass(split_k)
+    pm.add_triton_linalg_fuse_elementwise_pass()
+    pm.add_triton_linalg_tile_matmul_pass()
+    pm.add_triton_linalg_grid_launcher_pass()
+    run_passes(pm, mod)
+    return mod
+
+
+def linalg_to_llir(mod, opt_level=3):
+    return _triton.translate_linalg_to_llvmir(mod, opt_level)
+
+
 def _add_external_libs(mod, libs):
     for name, path in libs.items():
         if len(name) == 0 or len(path) == 0:
@@ -93,14 +194,14 @@ def _add_external_libs(mod, libs):
     _triton.add_external_libs(mod, list(libs.keys()), list(libs.values()))
 
 
-def ttgir_to_llir(mod, extern_libs, arch):
+def ttgir_to_llir(mod, extern_libs, arch, opt_level=3):
     if extern_libs:
         _add_external_libs(mod, extern_libs)
     # TODO: separate tritongpu_to_llvmir for different backends
     if _is_cuda(arch):
-        return _triton.translate_triton_gpu_to_llvmir(mod, arch, False)
+        return _triton.translate_triton_gpu_to_llvmir(mod, arch, False, opt_level)
     else:
-        return _triton.translate_triton_gpu_to_llvmir(mod, 0, True)
+        return _triton.translate_triton_gpu_to_llvmir(mod, 0, True, opt_level)
 
 
 # PTX translation
@@ -139,31 +240,114 @@ def path_to_ptxas():
     raise RuntimeError("Cannot find ptxas")
 
 
-def llir_to_ptx(mod: Any, arch: int, ptx_version: int = None) -> str:
+def llir_to_ptx(mod: Any, arch: int, ptx_version: int = None, opt_level: int = 3) -> str:
     '''
     Translate TritonGPU module to PTX code.
     :param mod: a TritonGPU dialect module
+    :param opt_level: optimization level of the code generation of LLVM, from 0 to 3
     :return: PTX code
     '''
     if ptx_version is None:
         _, cuda_version = path_to_ptxas()
         ptx_version = ptx_get_version(cuda_version)
-    return _triton.translate_llvmir_to_ptx(mod, arch, ptx_version)
+    return _triton.translate_llvmir_to_ptx(mod, arch, ptx_version, opt_level)
 
 
-def ptx_to_cubin(ptx: str, arch: int):
+def get_ptxas_info(log: str) -> dict:
+    '''
+    Parse the resource usage reported by the verbose log of ptxas.
+    :param log: output of ptxas -v, or of the JIT of the driver
+    :return: registers, stack frame and spill sizes in bytes of the kernel
+    '''
+    info = dict()
+    regs = re.search(r"Used (\d+) registers", log)
+    if regs is not None:
+        info["registers"] = int(regs.group(1))
+    props = re.search(r"(\d+) bytes stack frame, (\d+) bytes spill stores, (\d+) bytes spill loads", log)
+    if props is not None:
+        info["stack_frame"] = int(props.group(1))
+        info["spill_stores"] = int(props.group(2))
+        info["spill_loads"] = int(props.group(3))
+    return info
+
+
+# Per-SM limits of NVIDIA GPUs from the compute capability on: resident warps,
+# resident programs (CTAs) and shared memory in bytes. All of them have 64K
+# 32-bit registers per SM, allocated to warps in units of 256.
+_SM_LIMITS = {70: (64, 32, 96 * 1024),
+              75: (32, 16, 64 * 1024),
+              80: (64, 32, 164 * 1024),
+              86: (48, 16, 100 * 1024),
+              87: (48, 16, 164 * 1024),
+              89: (48, 24, 100 * 1024),
+              90: (64, 32, 228 * 1024)}
+
+
+def get_occupancy(arch: int, num_warps: int, registers: int, shared: int) -> dict:
     '''
-    Compile TritonGPU module to cubin.
+    Compute how many programs of a kernel can be resident on an SM.
+    :param arch: compute capability
+    :param registers: registers per thread reported by ptxas
+    :param shared: shared memory per program in bytes
+    :return: the resident programs per SM, the fraction of the resident warps
+             of the SM they make up, and the resource that limits them
+    '''
+    cc = max((c for c in _SM_LIMITS if c <= arch), default=min(_SM_LIMITS))
+    max_warps, max_programs, max_shared = _SM_LIMITS[cc]
+    limits = {"warps": max_warps // num_warps, "programs": max_programs}
+    if registers > 0:
+        regs_per_warp = -(-registers * 32 // 256) * 256
+        limits["registers"] = 65536 // regs_per_warp // num_warps
+    if shared > 0:
+        # the driver reserves 1KB of shared memory per program from sm_80 on
+        reserved = 1024 if cc >= 80 else 0
+        limits["shared"] = max_shared // (shared + reserved)
+    limiter = min(limits, key=limits.get)
+    programs = limits[limiter]
+    return {"programs_per_sm": programs, "occupancy": programs * num_warps / max_warps, "limiter": limiter}
+
+
+def ptx_to_cubin(ptx: str, arch: int, ptxas_info: dict = None):
+    '''
+    Compile TritonGPU module to cubin, in-process with the JIT of the driver
+    when possible, and with ptxas otherwise or when TRITON_PTXAS_PATH is set.
     :param ptx: ptx code
     :param compute_capability: compute capability
+    :param ptxas_info: filled with the resource usage of the kernel
     :return: str
     '''
     ptxas, _ = path_to_ptxas()
-    return _triton.compile_ptx_to_cubin(ptx, ptxas, arch)
+    external = "TRITON_PTXAS_PATH" in os.environ
+    cubin, log = _triton.compile_ptx_to_cubin(ptx, ptxas, arch, external)
+    if ptxas_info is not None:
+        ptxas_info.update(get_ptxas_info(log))
+    return cubin
 
 
 # AMDGCN translation
 
+def llir_to_so(src: str, name: str, opt_level: int = 3) -> bytes:
+    '''
+    Compile LLVM IR for the host and link it into a shared library.
+    :param src: LLVM IR of a kernel converted by triton-to-linalg
+    :param name: name of the kernel
+    :param opt_level: optimization level of the code generation of LLVM, from 0 to 3
+    :return: the shared library
+    '''
+    obj = _triton.translate_llvmir_to_host_object(src, opt_level)
+    cc = os.environ.get("CC")
+    if cc is None:
+        cc = shutil.which("gcc") or shutil.which("clang")
+        if cc is None:
+            raise RuntimeError("Failed to find C compiler. Please specify via CC environment variable.")
+    with tempfile.TemporaryDirectory() as tmpdir:
+        obj_path = os.path.join(tmpdir, f"{name}.o")
+        so_path = os.path.join(tmpdir, f"{name}.so")
+        Path(obj_path).write_bytes(obj)
+        subprocess.check_call([cc, obj_path, "-shared", "-fPIC", "-lm", "-o", so_path])
+        return Path(so_path).read_bytes()
+
+
 def get_amdgcn_bitcode_paths(arch):
     gpu_arch_agnostic_bitcode_libraries = ["opencl.bc",
                                            "ocml.bc",
@@ -217,13 +401,13 @@ def get_amdgpu_arch_fulldetails():
         return None
 
 
-def llir_to_amdgcn_and_hsaco(mod: Any, gfx_arch: str, gfx_triple: str, gfx_features: str) -> Tuple[str, str]:
+def llir_to_amdgcn_and_hsaco(mod: Any, gfx_arch: str, gfx_triple: str, gfx_features: str) -> Tuple[str, bytes]:
     '''
     Translate TritonGPU module to HSACO code based on full details of gpu architecture.
     :param mod: a TritonGPU dialect module
     :return:
         - AMDGCN code
-        - Path to HSACO object
+        - HSACO code object
     '''
     return _triton.translate_llvmir_to_hsaco(mod, gfx_arch, gfx_triple, gfx_features)
 
@@ -244,6 +428,13 @@ def get_kernel_name(src: str, pattern: str) -> str:
             return line.split()[-1]
 
 
+def get_launched_kernel_name(src: str) -> str:
+    '''
+    Get the name of the kernel that triton-linalg-grid-launcher created a launcher for.
+    '''
+    return re.search(r'func\.func @(\w+)_grid\(', src).group(1)
+
+
 def convert_type_repr(x):
     match = re.search(r'!tt\.ptr<(.*)>', x)
     if match is not None:
@@ -259,13 +450,41 @@ def make_hash(fn, **kwargs):
         num_warps = kwargs.get("num_warps", 4)
         num_stages = kwargs.get("num_stages", 3)
         debug = kwargs.get("debug", False)
+        target = kwargs.get("target", None)
+        persistent = kwargs.get("persistent", False)
+        pipeline_tiles = kwargs.get("pipeline_tiles", False)
+        split_k = kwargs.get("split_k", 1)
+        num_ctas = kwargs.get("num_ctas", 1)
+        coalesce_epilogue = kwargs.get("coalesce_epilogue", False)
+        profile = kwargs.get("profile", None)
+        opt_level = kwargs.get("opt_level", default_opt_level())
         # Get unique key for the compiled code
         get_conf_key = lambda conf: (sorted(conf.divisible_by_16), sorted(conf.equal_to_1))
         configs_key = [get_conf_key(conf) for conf in configs]
-        key = f"{fn.cache_key}-{''.join(signature.values())}-{configs_key}-{constants}-{num_warps}-{num_stages}-{debug}"
+        key = f"{fn.cache_key}-{''.join(signature.values())}-{configs_key}-{constants}-{num_warps}-{num_stages}-{debug}-{target}-{persistent}-{pipeline_tiles}-{split_k}-{num_ctas}-{coalesce_epilogue}-{profile}-{opt_level}-{remarks_enabled()}"
         return hashlib.md5(key.encode("utf-8")).hexdigest()
     assert isinstance(fn, str)
-    return hashlib.md5((Path(fn).read_text() + triton.runtime.jit.version_key()).encode("utf-8")).hexdigest()
+    opt_level = kwargs.get("opt_level", default_opt_level())
+    key = f"{Path(fn).read_text()}{triton.runtime.jit.version_key()}-{opt_level}"
+    return hashlib.md5(key.encode("utf-8")).hexdigest()
+
+
+def make_stage_hashes(fn, arch, epilogue_smem=0, **kwargs):
+    # Keys of the TTIR and TTGIR of `fn` that only hash the options their
+    # stage and the stages before depend on, so that kernels compiled with
+    # other late options (e.g. num_stages) reuse them
+    configs = kwargs["configs"]
+    signature = kwargs["signature"]
+    constants = kwargs.get("constants", dict())
+    debug = kwargs.get("debug", False)
+    get_conf_key = lambda conf: (sorted(conf.divisible_by_16), sorted(conf.equal_to_1))
+    configs_key = [get_conf_key(conf) for conf in configs]
+    ttir_key = f"{fn.cache_key}-{''.join(signature.values())}-{configs_key}-{constants}-{debug}-{arch}-{remarks_enabled()}"
+    ttgir_key = f"{ttir_key}-{kwargs.get('num_warps', 4)}-{kwargs['num_stages']}-{kwargs.get('persistent', False)}-" \
+                f"{kwargs.get('pipeline_tiles', False)}-{kwargs.get('split_k', 1)}-{kwargs.get('num_ctas', 1)}-" \
+                f"{epilogue_smem}-{kwargs.get('profile', None)}"
+    return {"ttir": hashlib.md5(f"ttir-{ttir_key}".encode("utf-8")).hexdigest(),
+            "ttgir": hashlib.md5(f"ttgir-{ttgir_key}".encode("utf-8")).hexdigest()}
 
 
 # - ^\s*tt\.func\s+ : match the start of the string, any leading whitespace, the keyword func,
@@ -321,6 +540,20 @@ def _is_cuda(arch):
     return isinstance(arch, int)
 
 
+def get_matrix_core_version(arch):
+    '''
+    Get the generation of the MFMA matrix cores of an AMD GPU, or 0 if it has none.
+    '''
+    gfx_arch = os.environ.get('MI_GPU_ARCH', arch[1])
+    if gfx_arch == 'gfx908':
+        return 1
+    if gfx_arch == 'gfx90a':
+        return 2
+    if gfx_arch in ('gfx940', 'gfx941', 'gfx942'):
+        return 3
+    return 0
+
+
 def get_architecture_descriptor(capability):
     if capability is None:
         if torch.version.hip is None:
@@ -349,39 +582,155 @@ def add_rocm_stages(arch, extern_libs, stages):
                                                              gfx_arch_full_details[2]))
 
 
-def add_cuda_stages(arch, extern_libs, stages):
+def add_cuda_stages(arch, extern_libs, stages, ptxas_info, opt_level):
 
     stages["ptx"] = (lambda path: Path(path).read_text(),
-                     lambda src: llir_to_ptx(src, arch))
+                     lambda src: llir_to_ptx(src, arch, opt_level=opt_level))
     stages["cubin"] = (lambda path: Path(path).read_bytes(),
-                       lambda src: ptx_to_cubin(src, arch))
+                       lambda src: ptx_to_cubin(src, arch, ptxas_info))
 
 
-def compile(fn, **kwargs):
+def add_cpu_stages(context, stages, get_name, opt_level, split_k=1):
+    stages["linalg"] = (lambda path: parse_mlir_module(path, context),
+                        lambda src: ttir_to_linalg(src, split_k))
+    stages["llir"] = (lambda path: Path(path).read_text(),
+                      lambda src: linalg_to_llir(src, opt_level))
+    stages["so"] = (lambda path: Path(path).read_bytes(),
+                    lambda src: llir_to_so(src, get_name(), opt_level))
+
+
+def fuse_ttir(mod, name):
+    pm = _triton.ir.pass_manager(mod.context)
+    pm.enable_debug()
+    pm.add_triton_fuse_kernels_pass(name)
+    run_passes(pm, mod)
+    return mod
+
+
+def compile_fused(kernels, name="fused_kernel", **kwargs):
+    """
+    Compiles the `kernels`, (JITFunction, signature, constants, instance
+    descriptor) tuples, into the single kernel `name` of the fusion pass, with
+    the other arguments of `compile`. It takes the arguments of each kernel
+    that are not constants, then the number of programs of each kernel.
+    """
     arch = get_architecture_descriptor(kwargs.get("cc", None))
+    context = _context_pool.acquire()
+    module = None
+    for fn, signature, constants, config in kernels:
+        kernel = optimize_ttir(ast_to_ttir(fn, signature, config, constants, debug=fn.debug, context=context), arch)
+        if module is None:
+            module = kernel
+        else:
+            module.merge(kernel)
+    src = fuse_ttir(module, name).str()
+    _context_pool.release(context)
+    # the fused kernel is compiled from its TTIR, as files of any stage are
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = os.path.join(tmpdir, f"{name}.ttir")
+        Path(path).write_text(src)
+        return compile(path, **kwargs)
+
+
+def estimate_resources(fn, **kwargs):
+    """
+    Compiles `fn` down to TTGIR only, with the arguments of `compile`, and
+    returns the shared memory in bytes that `Allocation` gives it and the
+    peak number of 32-bit registers per thread estimated from its layouts,
+    which is much cheaper than running LLVM and ptxas to find out.
+    """
+    arch = get_architecture_descriptor(kwargs.get("cc", None))
+    is_cuda = _is_cuda(arch)
+    threads_per_warp = 32 if is_cuda else 64
+    num_warps = kwargs.get("num_warps", 4)
+    num_stages = kwargs.get("num_stages", 3 if is_cuda and arch >= 75 else 2)
+    configs = kwargs.get("configs", None) or [instance_descriptor()]
+    context = _context_pool.acquire()
+    module = ast_to_ttir(fn, kwargs["signature"], configs[0], kwargs.get("constants", dict()),
+                         debug=kwargs.get("debug", False), context=context)
+    module = optimize_ttir(module, arch)
+    module = optimize_ttgir(ttir_to_ttgir(module, num_warps, threads_per_warp), num_stages, arch,
+                            split_k=kwargs.get("split_k", 1))
+    resources = {"shared": _triton.get_shared_memory_size(module), "registers": _triton.estimate_registers(module)}
+    _context_pool.release(context)
+    return resources
+
+
+def compile(fn, **kwargs):
+    # target="cpu" compiles through triton-to-linalg for the host
+    is_cpu = kwargs.get("target", None) == "cpu"
+    arch = None if is_cpu else get_architecture_descriptor(kwargs.get("cc", None))
     is_cuda = _is_cuda(arch)
-    context = _triton.ir.context()
+    # contexts of compilations that fail are not reused
+    context = _context_pool.acquire()
     asm = dict()
     constants = kwargs.get("constants", dict())
     num_warps = kwargs.get("num_warps", 4)
+    # AMD GPUs run wavefronts of 64 threads
+    threads_per_warp = 32 if is_cuda else 64
     num_stages = kwargs.get("num_stages", 3 if is_cuda and arch >= 75 else 2)
     extern_libs = kwargs.get("extern_libs", dict())
     if extern_libs is None:
         extern_libs = dict()
     debug = kwargs.get("debug", False)
+    # persistent kernels start at most one program per SM and loop over the
+    # tiles of axis 0; the launcher passes the number of tiles
+    persistent = kwargs.get("persistent", False) and not is_cpu
+    pipeline_tiles = kwargs.get("pipeline_tiles", False)
+    # split-K kernels run the K loop of each tile across split_k programs along
+    # axis 2 and atomically add their partial sums to the zero-initialized output.
+    # On the host, the programs are run by each program of the grid instead,
+    # whose launch is unchanged
+    split_k = 1 if is_cpu else kwargs.get("split_k", 1)
+    # the CTAs of num_ctas consecutive programs along axis 0 are launched as a
+    # thread block cluster, scheduled together on a GPC
+    num_ctas = kwargs.get("num_ctas", 1)
+    if num_ctas > 1:
+        if not is_cuda or arch < 90:
+            raise ValueError("thread block clusters need NVIDIA GPUs of compute capability 9.0 or higher")
+        if not 1 <= num_ctas <= 8:
+            raise ValueError(f"num_ctas must be between 1 and 8, the largest portable cluster size, got {num_ctas}")
+        if persistent:
+            raise ValueError("persistent kernels cannot be launched in clusters")
+    # coalesce_epilogue stages the stores of MMA results through shared memory,
+    # as long as the kernel still fits in the shared memory of the device
+    epilogue_smem = 0
+    if kwargs.get("coalesce_epilogue", False) and is_cuda:
+        device = triton.runtime.jit.get_current_device()
+        epilogue_smem = driver.utils.get_device_properties(device)["max_shared_mem"]
+    # profiled kernels record when their warps enter and leave their regions
+    # into a buffer passed as their last argument, see RegionProfile
+    profile = kwargs.get("profile", None)
+    if profile is not None and not is_cuda:
+        raise NotImplementedError("only kernels compiled for NVIDIA GPUs can be profiled")
+    # the level LLVM optimizes the kernel and generates its code at: 0 compiles
+    # several times faster than the default of 3, for slower kernels
+    opt_level = kwargs.get("opt_level", default_opt_level())
+    if opt_level not in range(4):
+        raise ValueError(f"opt_level must be between 0 and 3, got {opt_level}")
+    kwargs["opt_level"] = opt_level
+    # resource usage of the kernel reported when compiling its cubin
+    ptxas_info = dict()
     # build compilation stages
     stages = dict()
     stages["ast"] = (lambda path: fn, None)
     stages["ttir"] = (lambda path: parse_mlir_module(path, context),
-                      lambda src: optimize_ttir(ast_to_ttir(src, signature, configs[0], constants, debug=debug), arch))
-    stages["ttgir"] = (lambda path: parse_mlir_module(path, context),
-                       lambda src: optimize_ttgir(ttir_to_ttgir(src, num_warps), num_stages, arch))
-    stages["llir"] = (lambda path: Path(path).read_text(),
-                      lambda src: ttgir_to_llir(src, extern_libs, arch))
-    if is_cuda:
-        add_cuda_stages(arch, extern_libs, stages)
+                      lambda src: optimize_ttir(ast_to_ttir(src, signature, configs[0], constants, debug=debug,
+                                                                 context=context), arch))
+    if is_cpu:
+        add_cpu_stages(context, stages, lambda: name, opt_level, kwargs.get("split_k", 1))
     else:
-        add_rocm_stages(arch, extern_libs, stages)
+        stages["ttgir"] = (lambda path: parse_mlir_module(path, context),
+                           lambda src: grid_barriers_ttgir(
+                               profile_ttgir(optimize_ttgir(ttir_to_ttgir(src, num_warps, threads_per_warp, num_ctas),
+                                                            num_stages, arch, persistent, pipeline_tiles, split_k,
+                                                            epilogue_smem), profile), arch))
+        stages["llir"] = (lambda path: Path(path).read_text(),
+                          lambda src: ttgir_to_llir(src, extern_libs, arch, opt_level))
+        if is_cuda:
+            add_cuda_stages(arch, extern_libs, stages, ptxas_info, opt_level)
+        else:
+            add_rocm_stages(arch, extern_libs, stages)
 
     # find out the signature of the function
     if isinstance(fn, triton.runtime.JITFunction):
@@ -408,10 +757,15 @@ def compile(fn, **kwargs):
         signature = {k: v for k, v in enumerate(param_tys)}
         first_stage = list(stages.keys()).index(ir)
 
-    # cache manager
-    so_path = make_stub(name, signature, constants)
     # create cache manager
-    fn_cache_manager = get_cache_manager(make_hash(fn, **kwargs))
+    fn_cache_manager_key = make_hash(fn, **kwargs)
+    fn_cache_manager = get_cache_manager(fn_cache_manager_key)
+    # the early stages of kernels get their own cache entries, shared by the
+    # kernels that only differ by the options of later stages
+    stage_cache_managers = dict()
+    if isinstance(fn, triton.runtime.JITFunction):
+        stage_hashes = make_stage_hashes(fn, arch, epilogue_smem, **{**kwargs, "num_stages": num_stages})
+        stage_cache_managers = {ir: get_cache_manager(h) for ir, h in stage_hashes.items() if ir in stages}
     # determine name and extension type of provided function
     if isinstance(fn, triton.runtime.JITFunction):
         name, ext = fn.__name__, "ast"
@@ -425,72 +779,209 @@ def compile(fn, **kwargs):
     # The group is addressed by the metadata
     metadata_group = fn_cache_manager.get_group(
         metadata_filename
-    ) or {}
+    )
+    # concurrent compilations of a kernel that is not cached wait for the
+    # first one, and then find its files in the cache, instead of repeating it
+    flight = contextlib.nullcontext()
+    if metadata_group is None:
+        flight = single_flight(fn_cache_manager_key, fn_cache_manager.compile_lock_path())
+
+    with flight:
+        if metadata_group is None:
+            metadata_group = fn_cache_manager.get_group(metadata_filename)
+        metadata_group = metadata_group or {}
+
+        metadata_path = metadata_group.get(metadata_filename)
+
+        if metadata_path is not None:
+            try:
+                with open(metadata_path) as f:
+                    metadata = json.load(f)
+            except FileNotFoundError:
+                # the group was removed since the cache remembered it, e.g. by
+                # another process, so it is compiled again
+                fn_cache_manager.evict(metadata_filename)
+                metadata_group, metadata_path = {}, None
+        if metadata_path is None:
+            metadata = {"num_warps": num_warps,
+                        "num_stages": num_stages,
+                        "constants": _get_jsonable_constants(constants),
+                        "debug": debug,
+                        "persistent": persistent,
+                        "split_k": split_k,
+                        "num_ctas": num_ctas,
+                        "opt_level": opt_level}
+            if ext == "ptx":
+                assert "shared" in kwargs, "ptx compilation must provide shared memory size"
+                metadata["shared"] = kwargs["shared"]
+            if is_cpu:
+                # the runner passes the arguments that are not specialized away
+                metadata["shared"] = 0
+                metadata["arg_positions"] = [i for i, k in enumerate(signature) if k not in constants]
+                metadata["arg_types"] = [signature[k] for k in signature if k not in constants]
+
+        first_stage = list(stages.keys()).index(ext)
+        asm = dict()
+        module = fn
+        # wall-clock time of the stages compiled here, in seconds, and of the
+        # passes each of them ran
+        timings = {"stages": dict(), "passes": dict()}
+        # remarks of the passes of the stages compiled here, see run_passes
+        remarks = dict()
+        # run compilation pipeline  and populate metadata
+        for ir, (parse, compile_kernel) in list(stages.items())[first_stage:]:
+            ir_filename = f"{name}.{ir}"
+
+            if ir == ext:
+                next_module = parse(fn)
+            else:
+                path = metadata_group.get(ir_filename)
+                stage_cache_manager = stage_cache_managers.get(ir)
+                if path is None and stage_cache_manager is not None:
+                    stage_path = stage_cache_manager.get_file(ir_filename)
+                    if stage_path is not None:
+                        next_module = parse(stage_path)
+                        metadata_group[ir_filename] = fn_cache_manager.put(Path(stage_path).read_text(), ir_filename)
+                        path = metadata_group[ir_filename]
+                elif path is not None:
+                    next_module = parse(path)
+                if path is None:
+                    _pass_timings.records = []
+                    _remarks.records = []
+                    start = time.perf_counter()
+                    try:
+                        next_module = compile_kernel(module)
+                    finally:
+                        timings["stages"][ir] = time.perf_counter() - start
+                        if _pass_timings.records:
+                            timings["passes"][ir] = _pass_timings.records
+                        _pass_timings.records = None
+                        if _remarks.records:
+                            remarks[ir] = _remarks.records
+                            for remark in _remarks.records:
+                                print(f"{name}.{ir}: remark: {remark}", file=sys.stderr)
+                        _remarks.records = None
+                    if ir == "amdgcn":
+                        extra_file_name = f"{name}.hsaco"
+                        metadata_group[ir_filename] = fn_cache_manager.put(next_module[0], ir_filename)
+                        metadata_group[extra_file_name] = fn_cache_manager.put(next_module[1], extra_file_name)
+                    else:
+                        metadata_group[ir_filename] = fn_cache_manager.put(next_module, ir_filename)
+                        if stage_cache_manager is not None:
+                            stage_cache_manager.put(str(next_module), ir_filename, binary=False)
+                elif ir == "amdgcn":
+                    extra_file_name = f"{name}.hsaco"
+                    hsaco_path = metadata_group.get(extra_file_name)
+                    assert hsaco_path is not None, "Expected to have hsaco in metadata when we have the amdgcn"
+                    next_module = (next_module, Path(hsaco_path).read_bytes())
+
+            if ir == "cubin" or ir == "so":
+                asm[ir] = next_module
+            elif ir == "amdgcn":
+                asm[ir] = str(next_module[0])
+            else:
+                asm[ir] = str(next_module)
+            if ir == "llir" and "shared" not in metadata:
+                metadata["shared"] = _triton.get_shared_memory_size(module)
+                metadata["shared_buffers"] = _triton.get_shared_memory_buffers(module)
+                metadata["tensormaps"] = _triton.get_tensormaps(module)
+                metadata["grid_barrier"] = _triton.has_grid_barriers(module)
+                if profile is not None:
+                    metadata["profile"] = dict(profile, regions=_triton.get_profile_regions(module))
+            if ir == "linalg":
+                metadata["name"] = get_launched_kernel_name(asm[ir])
+            if ir == "ptx":
+                metadata["name"] = get_kernel_name(next_module, pattern='// .globl')
+            if ir == "amdgcn":
+                metadata["name"] = get_kernel_name(next_module[0], pattern='.globl')
+                asm["hsaco"] = next_module[1]
+            module = next_module
+        # write-back metadata, if it didn't come from the cache
+        if metadata_path is None:
+            if ptxas_info:
+                metadata["ptxas_info"] = ptxas_info
+                metadata["occupancy"] = get_occupancy(arch, num_warps, ptxas_info.get("registers", 0), metadata["shared"])
+            metadata["timings"] = timings
+            if remarks:
+                metadata["remarks"] = remarks
+            metadata_group[metadata_filename] = fn_cache_manager.put(json.dumps(metadata), metadata_filename, binary=False)
+            fn_cache_manager.put_group(metadata_filename, metadata_group)
+
+    # the launcher encodes the tensor maps of the kernel, which are only known
+    # once it is compiled
+    so_path = None if is_cpu else make_stub(name, signature, constants, persistent, split_k,
+                                            metadata.get("tensormaps"), profile is not None, num_ctas,
+                                            metadata.get("grid_barrier", False))
+
+    _context_pool.release(context)
+    if lean_asm_enabled():
+        asm = LeanAsm(asm, {ir: metadata_group.get(f"{name}.{ir}") for ir in asm})
+    # return handle to compiled kernel
+    if is_cpu:
+        return CPUCompiledKernel(fn, metadata_group[f"{name}.so"], metadata, asm)
+    return CompiledKernel(fn, so_path, metadata, asm)
 
-    metadata_path = metadata_group.get(metadata_filename)
 
-    if metadata_path is not None:
-        with open(metadata_path) as f:
-            metadata = json.load(f)
-    else:
-        metadata = {"num_warps": num_warps,
-                    "num_stages": num_stages,
-                    "constants": _get_jsonable_constants(constants),
-                    "debug": debug}
-        if ext == "ptx":
-            assert "shared" in kwargs, "ptx compilation must provide shared memory size"
-            metadata["shared"] = kwargs["shared"]
-
-    first_stage = list(stages.keys()).index(ext)
-    asm = dict()
-    module = fn
-    # run compilation pipeline  and populate metadata
-    for ir, (parse, compile_kernel) in list(stages.items())[first_stage:]:
-        ir_filename = f"{name}.{ir}"
+class LeanAsm(dict):
+    """
+    The asm of a compiled kernel that only keeps its binaries in memory,
+    reading the other stages from the files of the cache they were written
+    to whenever they are accessed. Stages without a file are kept.
+    """
 
-        if ir == ext:
-            next_module = parse(fn)
-        else:
-            path = metadata_group.get(ir_filename)
-            if path is None:
-                next_module = compile_kernel(module)
-                if ir == "amdgcn":
-                    extra_file_name = f"{name}.hsaco_path"
-                    metadata_group[ir_filename] = fn_cache_manager.put(next_module[0], ir_filename)
-                    metadata_group[extra_file_name] = fn_cache_manager.put(next_module[1], extra_file_name)
-                else:
-                    metadata_group[ir_filename] = fn_cache_manager.put(next_module, ir_filename)
-                    fn_cache_manager.put(next_module, ir_filename)
-            else:
-                if ir == "amdgcn":
-                    extra_file_name = f"{name}.hsaco_path"
-                    hasco_path = metadata_group.get(extra_file_name)
-                    assert hasco_path is not None, "Expected to have hsaco_path in metadata when we have the amdgcn"
-                    next_module = (parse(path), parse(hasco_path))
-                else:
-                    next_module = parse(path)
+    binaries = ("cubin", "hsaco", "so")
 
-        if ir == "cubin":
-            asm[ir] = next_module
-        elif ir == "amdgcn":
-            asm[ir] = str(next_module[0])
-        else:
-            asm[ir] = str(next_module)
-        if ir == "llir" and "shared" not in metadata:
-            metadata["shared"] = _triton.get_shared_memory_size(module)
-        if ir == "ptx":
-            metadata["name"] = get_kernel_name(next_module, pattern='// .globl')
-        if ir == "amdgcn":
-            metadata["name"] = get_kernel_name(next_module[0], pattern='.globl')
-            asm["hsaco_path"] = next_module[1]
-        module = next_module
-    # write-back metadata, if it didn't come from the cache
-    if metadata_path is None:
-        metadata_group[metadata_filename] = fn_cache_manager.put(json.dumps(metadata), metadata_filename, binary=False)
-        fn_cache_manager.put_group(metadata_filename, metadata_group)
+    def __init__(self, asm, paths):
+        self.paths = {ir: path for ir, path in paths.items() if path is not None and ir not in self.binaries}
+        super().__init__({ir: src for ir, src in asm.items() if ir not in self.paths})
 
-    # return handle to compiled kernel
-    return CompiledKernel(fn, so_path, metadata, asm)
+    def __missing__(self, ir):
+        if ir not in self.paths:
+            raise KeyError(ir)
+        return Path(self.paths[ir]).read_text()
+
+    def __contains__(self, ir):
+        return super().__contains__(ir) or ir in self.paths
+
+    def __iter__(self):
+        yield from super().__iter__()
+        yield from (ir for ir in self.paths if not dict.__contains__(self, ir))
+
+    def __len__(self):
+        return sum(1 for _ in self)
+
+    def get(self, ir, default=None):
+        return self[ir] if ir in self else default
+
+    def keys(self):
+        return list(self)
+
+    def items(self):
+        return [(ir, self[ir]) for ir in self]
+
+    def values(self):
+        return [self[ir] for ir in self]
+
+
+# kernels whose module is loaded on a device, by (id of the kernel, device).
+# Their modules are unloaded from the least recently launched one, according
+# to the launch clock that launches here and through the native dispatcher of
+# a JITFunction advance, when a device runs out of memory to load another one
+_loaded_modules = dict()
+
+
+def _unload_coldest_module(device):
+    # returns whether a module was unloaded from device
+    for key in list(_loaded_modules):
+        if _loaded_modules[key]() is None:
+            del _loaded_modules[key]
+            _triton.runtime.forget_module(*key)
+    keys = [key for key in _loaded_modules if key[1] == device]
+    if not keys:
+        return False
+    coldest = min(keys, key=lambda key: _triton.runtime.last_launch(*key))
+    _loaded_modules[coldest]().unload(device)
+    return True
 
 
 class CompiledKernel:
@@ -507,6 +998,7 @@ class CompiledKernel:
         self.fn = fn
         spec.loader.exec_module(mod)
         self.c_wrapper = getattr(mod, "launch")
+        self.c_graph_node = getattr(mod, "graph_node", None)
         # initialize metadata
         self.shared = metadata["shared"]
         self.num_warps = metadata["num_warps"]
@@ -518,26 +1010,62 @@ class CompiledKernel:
         # because it involves doing runtime things
         # (e.g., checking amount of shared memory on current device)
         self.metadata = metadata
+        # the module and function loaded on each device the kernel was
+        # launched on, and those of the current device
+        self.handles = dict()
         self.cu_module = None
         self.cu_function = None
 
-    def _init_handles(self):
-        if self.cu_module is not None:
-            return
-        device = triton.runtime.jit.get_current_device()
+    def _load_binary(self, device):
         bin_path = {
-            driver.HIP: "hsaco_path",
+            driver.HIP: "hsaco",
             driver.CUDA: "cubin"
         }[driver.backend]
         max_shared = driver.utils.get_device_properties(device)["max_shared_mem"]
         if self.shared > max_shared:
             raise OutOfResources(self.shared, max_shared, "shared memory")
-        mod, func, n_regs, n_spills = driver.utils.load_binary(self.metadata["name"], self.asm[bin_path], self.shared, device)
-
+        while True:
+            try:
+                mod, func, n_regs, n_spills = driver.utils.load_binary(self.metadata["name"], self.asm[bin_path],
+                                                                       self.shared, device)
+                break
+            except RuntimeError as e:
+                # make room for the module by unloading cold ones
+                if "out of memory" not in str(e).lower() or not _unload_coldest_module(device):
+                    raise
         self.n_spills = n_spills
         self.n_regs = n_regs
-        self.cu_module = mod
-        self.cu_function = func
+        return mod, func
+
+    def _init_handles(self):
+        device = triton.runtime.jit.get_current_device()
+        handles = self.handles.get(device)
+        if handles is None:
+            handles = self._load_binary(device)
+            self.handles[device] = handles
+            _loaded_modules[(id(self), device)] = weakref.ref(self)
+        _triton.runtime.touch_module(id(self), device)
+        self.cu_module, self.cu_function = handles
+
+    def unload(self, device=None):
+        """
+        Unloads the module of the kernel from `device`, or from all the devices
+        it is loaded on. It is loaded again by the next launch on the device.
+        """
+        devices = list(self.handles) if device is None else [device]
+        for device in devices:
+            handles = self.handles.pop(device, None)
+            _loaded_modules.pop((id(self), device), None)
+            _triton.runtime.forget_module(id(self), device)
+            if handles is None:
+                continue
+            with torch.cuda.device(device):
+                driver.utils.unload_binary(handles[0])
+            if self.cu_module == handles[0]:
+                self.cu_module = None
+                self.cu_function = None
+        # launches of the unloaded functions are not dispatched natively
+        _triton.runtime.invalidate_handles()
 
     def __getattribute__(self, name):
         if name == 'c_wrapper':
@@ -554,6 +1082,15 @@ class CompiledKernel:
                            CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, self, *args)
         return runner
 
+    def graph_node(self, graph, exec, node, grid, args):
+        # adds the launch of the kernel on `grid` to `graph` after `node`, or
+        # updates the arguments of `node` in the instance `exec` of the graph
+        if self.c_graph_node is None:
+            raise NotImplementedError(f"kernel {self.metadata['name']} cannot be launched from a CUDA graph")
+        self._init_handles()
+        return self.c_graph_node(graph, exec, node, grid[0], grid[1], grid[2], self.num_warps, self.shared,
+                                 self.cu_function, *args)
+
     def get_sass(self, fun=None):
         if 'sass' in self.asm:
             return self.asm['sass']
@@ -566,3 +1103,60 @@ class CompiledKernel:
             os.remove(path)
         self.asm['sass'] = self.sass
         return self.sass
+
+
+class _UnrankedMemRefDescriptor(ctypes.Structure):
+    # rank 0 descriptor behind the memref<*xT> that pointer arguments are
+    # converted to; kernels only read the base pointers and the offset
+    _fields_ = [("allocated", ctypes.c_void_p),
+                ("aligned", ctypes.c_void_p),
+                ("offset", ctypes.c_int64)]
+
+
+_ctypes_of = {
+    "i1": ctypes.c_bool,
+    "i8": ctypes.c_int8,
+    "i16": ctypes.c_int16,
+    "i32": ctypes.c_int32,
+    "i64": ctypes.c_int64,
+    "u32": ctypes.c_uint32,
+    "u64": ctypes.c_uint64,
+    "fp32": ctypes.c_float,
+    "fp64": ctypes.c_double,
+}
+
+
+class CPUCompiledKernel:
+    # Kernel compiled for the host through triton-to-linalg. It is launched
+    # through the `<name>_grid` function, which runs all programs of the grid.
+
+    def __init__(self, fn, so_path, metadata, asm):
+        self.fn = fn
+        self.metadata = metadata
+        self.constants = metadata["constants"]
+        self.asm = asm
+        self.lib = ctypes.CDLL(so_path)
+        self.c_function = getattr(self.lib, f"{metadata['name']}_grid")
+        self.c_function.restype = None
+
+    def _c_args(self, args):
+        c_args, keep_alive = [], []
+        for pos, ty in zip(self.metadata["arg_positions"], self.metadata["arg_types"]):
+            arg = args[pos]
+            if ty[0] == '*':
+                ptr = arg.data_ptr() if hasattr(arg, "data_ptr") else arg
+                desc = _UnrankedMemRefDescriptor(ptr, ptr, 0)
+                keep_alive.append(desc)
+                c_args += [ctypes.c_int64(0), ctypes.cast(ctypes.pointer(desc), ctypes.c_void_p)]
+            elif ty in _ctypes_of:
+                c_args.append(_ctypes_of[ty](arg))
+            else:
+                raise TypeError(f"argument type {ty} is not supported by the CPU backend")
+        return c_args, keep_alive
+
+    def __getitem__(self, grid):
+        def runner(*args, stream=None):
+            c_args, _keep_alive = self._c_args(args)
+            grid_size = [grid[i] if i < len(grid) else 1 for i in range(3)]
+            self.c_function(*c_args, *[ctypes.c_int32(g) for g in grid_size])
+        return runner
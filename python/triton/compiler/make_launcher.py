@@ -15,24 +15,28 @@ def is_hip():
 # ----- stub --------
 
 
-def make_so_cache_key(version_hash, signature, constants):
+def make_so_cache_key(version_hash, signature, constants, persistent=False, split_k=1, tensormaps=None, profile=False,
+                      num_ctas=1, grid_barrier=False):
     # Get unique key for the compiled code
     signature = {k: 'ptr' if v[0] == '*' else v for k, v in signature.items()}
-    key = f"{version_hash}-{''.join(signature.values())}{constants}"
+    key = f"{version_hash}-{''.join(signature.values())}{constants}{'-persistent' if persistent else ''}{f'-split{split_k}' if split_k > 1 else ''}{f'-{tensormaps}' if tensormaps else ''}{'-profile' if profile else ''}{f'-cluster{num_ctas}' if num_ctas > 1 else ''}{'-grid-barrier' if grid_barrier else ''}"
     key = hashlib.md5(key.encode("utf-8")).hexdigest()
     return key
 
 
-def make_stub(name, signature, constants):
+def make_stub(name, signature, constants, persistent=False, split_k=1, tensormaps=None, profile=False, num_ctas=1,
+              grid_barrier=False):
     # name of files that are cached
-    so_cache_key = make_so_cache_key(version_key(), signature, constants)
+    so_cache_key = make_so_cache_key(version_key(), signature, constants, persistent, split_k, tensormaps, profile,
+                                     num_ctas, grid_barrier)
     so_cache_manager = get_cache_manager(so_cache_key)
     so_name = f"{name}.so"
     # retrieve stub from cache if it exists
     cache_path = so_cache_manager.get_file(so_name)
     if cache_path is None:
         with tempfile.TemporaryDirectory() as tmpdir:
-            src = generate_launcher(constants, signature)
+            src = generate_launcher(constants, signature, persistent, split_k, tensormaps, profile, num_ctas,
+                                    grid_barrier)
             src_path = os.path.join(tmpdir, "main.c")
             with open(src_path, "w") as f:
                 f.write(src)
@@ -64,8 +68,81 @@ def ty_to_cpp(ty):
     }[ty]
 
 
-def generate_launcher(constants, signature):
+# CUtensorMapDataType of the element types of tensor maps; 8-bit types are
+# copied as bytes
+tensormap_dtypes = {
+    "i8": 0, "f8E4M3FN": 0, "f8E4M3FNUZ": 0, "f8E5M2": 0, "f8E5M2FNUZ": 0,
+    "i16": 1, "i32": 3, "i64": 5,
+    "f16": 6, "f32": 7, "f64": 8, "bf16": 9,
+}
+
+tensormap_swizzles = {0: 0, 32: 1, 64: 2, 128: 3}
+
+
+def generate_tensormaps_setup(tensormaps, kernel_args):
+    # Encodes the tensor maps the kernel copies blocks through (see
+    # get_tensormaps) from the arguments of the launch, innermost dimension
+    # first, with the strides of the outer dimensions in bytes
+    def value_of(args, values, d, scale=1):
+        if args[d] >= 0:
+            arg = f"(uint64_t)arg{kernel_args[args[d]]}"
+            return arg if scale == 1 else f"{arg} * {scale}"
+        return str(values[d] * scale)
+
+    lines = [f"TensorMap tensormaps[{len(tensormaps)}];"]
+    for t, m in enumerate(tensormaps):
+        elem_bytes = {0: 1, 1: 2, 3: 4, 5: 8, 6: 2, 7: 4, 8: 8, 9: 2}[tensormap_dtypes[m["elem"]]]
+        rank = len(m["box"])
+        dims = [value_of(m["shape"], m["shape_values"], d) for d in reversed(range(rank))]
+        strides = [value_of(m["strides"], m["stride_values"], d, elem_bytes) for d in reversed(range(rank - 1))]
+        box = [str(m["box"][d]) for d in reversed(range(rank))]
+        lines += [
+            "{",
+            f"  uint64_t dims[] = {{{', '.join(dims)}}};",
+            f"  uint64_t strides[] = {{{', '.join(strides)}}};",
+            f"  uint32_t box[] = {{{', '.join(box)}}};",
+            f"  uint32_t elem_strides[] = {{{', '.join(['1'] * rank)}}};",
+            f"  CUDA_CHECK(encodeTensorMap(&tensormaps[{t}], {tensormap_dtypes[m['elem']]}, {rank}, (void *)arg{kernel_args[m['base']]}, "
+            f"dims, strides, box, elem_strides, 0, {tensormap_swizzles[m.get('swizzle', 0)]}, 2, 0));",
+            "}",
+        ]
+    lines += ["CUdeviceptr tensormaps_dev;",
+              "CUDA_CHECK(cuMemAllocAsync(&tensormaps_dev, sizeof(tensormaps), stream));",
+              "CUDA_CHECK(cuMemcpyHtoDAsync(tensormaps_dev, tensormaps, sizeof(tensormaps), stream));"]
+    lines += [f"CUdeviceptr desc{t} = tensormaps_dev + {t} * sizeof(TensorMap);" for t in range(len(tensormaps))]
+    return lines
+
+
+def generate_launcher(constants, signature, persistent=False, split_k=1, tensormaps=None, profile=False, num_ctas=1,
+                      grid_barrier=False):
+    # a profiled kernel takes the buffer its records are written to as its
+    # very last argument, which the launcher takes after the ones of the kernel
+    profile_arg = max([*signature, *constants], default=-1) + 1
+    if profile:
+        signature = {**signature, profile_arg: "*i64"}
     arg_decls = ', '.join(f"{ty_to_cpp(ty)} arg{i}" for i, ty in signature.items())
+    kernel_args = [i for i in signature.keys() if i not in constants and i != profile_arg]
+    params = [f"&arg{i}" for i in kernel_args]
+    # the blocks loaded with TMA on Hopper are described by tensor maps, which
+    # are built at launch and passed after the arguments of the kernel
+    tensormaps = tensormaps or []
+    params += [f"&desc{t}" for t in range(len(tensormaps))]
+    # a persistent kernel loops over the gridX tiles of axis 0 with at most one
+    # program per SM, and takes the number of tiles as its last argument
+    if persistent:
+        params.append("&num_tiles")
+    if profile:
+        params.append(f"&arg{profile_arg}")
+    # the programs of a kernel with grid barriers synchronize on a counter,
+    # zeroed for each launch and passed last, and are launched cooperatively so
+    # that they are all resident at once
+    if grid_barrier:
+        if num_ctas > 1:
+            raise ValueError("kernels with grid barriers cannot be launched in clusters")
+        params.append("&barrier")
+    # a split-K kernel runs the K loop of each tile across split_k programs
+    # along axis 2
+    split_k_setup = f"gridZ *= {split_k};" if split_k > 1 else ""
 
     def _extracted_type(ty):
         if ty[0] == '*':
@@ -96,9 +173,16 @@ def generate_launcher(constants, signature):
         }[ty]
 
     format = "iiiiiKKOOO" + ''.join([format_of(_extracted_type(ty)) for ty in signature.values()])
+    graph_format = "KKKiiiiiK" + ''.join([format_of(_extracted_type(ty)) for ty in signature.values()])
 
     # generate glue code
     if is_hip():
+        persistent_setup = """int32_t num_tiles = gridX;
+      int device, num_sms;
+      HIP_CHECK(hipGetDevice(&device));
+      HIP_CHECK(hipDeviceGetAttribute(&num_sms, hipDeviceAttributeMultiprocessorCount, device));
+      if (num_sms < gridX) gridX = num_sms;""" if persistent else ""
+        launch_setup = "\n      ".join(filter(None, [split_k_setup, persistent_setup]))
         src = f"""
     #define __HIP_PLATFORM_AMD__
     #include <hip/hip_runtime.h>
@@ -120,7 +204,8 @@ def generate_launcher(constants, signature):
     #define HIP_CHECK(ans) {{ gpuAssert((ans), __FILE__, __LINE__); }}
 
     static void _launch(int gridX, int gridY, int gridZ, int num_warps, int shared_memory, hipStream_t stream, hipFunction_t function, {arg_decls}) {{
-      void *params[] = {{ {', '.join(f"&arg{i}" for i in signature.keys() if i not in constants)} }};
+      {launch_setup}
+      void *params[] = {{ {', '.join(params)} }};
       if (gridX*gridY*gridZ > 0) {{
           HIP_CHECK(hipModuleLaunchKernel(function, gridX, gridY, gridZ, 64*num_warps, 1, 1, shared_memory, stream, params, 0));
       }}
@@ -239,6 +324,144 @@ def generate_launcher(constants, signature):
     }}
     """
     else:
+        persistent_setup = """int32_t num_tiles = gridX;
+  CUdevice device;
+  int num_sms;
+  CUDA_CHECK(cuCtxGetDevice(&device));
+  CUDA_CHECK(cuDeviceGetAttribute(&num_sms, CU_DEVICE_ATTRIBUTE_MULTIPROCESSOR_COUNT, device));
+  if (num_sms < gridX) gridX = num_sms;""" if persistent else ""
+        launch_setup = "\n  ".join(filter(None, [split_k_setup, persistent_setup]))
+        tensormaps_setup = "\n    ".join(generate_tensormaps_setup(tensormaps, kernel_args)) if tensormaps else ""
+        tensormaps_cleanup = "CUDA_CHECK(cuMemFreeAsync(tensormaps_dev, stream));" if tensormaps else ""
+        grid_barrier_setup = """CUdeviceptr barrier;
+    CUDA_CHECK(cuMemAllocAsync(&barrier, sizeof(uint32_t), stream));
+    CUDA_CHECK(cuMemsetD32Async(barrier, 0, 1, stream));""" if grid_barrier else ""
+        grid_barrier_cleanup = "CUDA_CHECK(cuMemFreeAsync(barrier, stream));" if grid_barrier else ""
+        # CUtensorMap and cuTensorMapEncodeTiled are part of CUDA 12, and
+        # looked up in the driver as the bundled cuda.h predates them
+        tensormaps_decls = """
+typedef struct {
+  _Alignas(64) uint64_t data[16];
+} TensorMap;
+
+typedef CUresult (*cuTensorMapEncodeTiled_t)(TensorMap *, int, uint32_t, void *, const uint64_t *, const uint64_t *,
+                                             const uint32_t *, const uint32_t *, int, int, int, int);
+
+static CUresult encodeTensorMap(TensorMap *map, int dtype, uint32_t rank, void *base, const uint64_t *dims,
+                                const uint64_t *strides, const uint32_t *box, const uint32_t *elem_strides,
+                                int interleave, int swizzle, int l2_promotion, int oob_fill) {
+  static cuTensorMapEncodeTiled_t fn = NULL;
+  if (fn == NULL) {
+    CUresult status = cuGetProcAddress("cuTensorMapEncodeTiled", (void **)&fn, 12000, CU_GET_PROC_ADDRESS_DEFAULT);
+    if (status != CUDA_SUCCESS)
+      return status;
+  }
+  return fn(map, dtype, rank, base, dims, strides, box, elem_strides, interleave, swizzle, l2_promotion, oob_fill);
+}
+""" if tensormaps else ""
+        # the CTAs of num_ctas consecutive programs along axis 0 are launched
+        # as a cluster by cuLaunchKernelEx, which is also part of CUDA 12
+        cluster_decls = """
+typedef struct {
+  int id;
+  char pad[4];
+  union {
+    char pad[64];
+    struct {
+      unsigned x, y, z;
+    } clusterDim;
+  } value;
+} LaunchAttribute;
+
+typedef struct {
+  unsigned gridDimX, gridDimY, gridDimZ, blockDimX, blockDimY, blockDimZ, sharedMemBytes;
+  CUstream hStream;
+  LaunchAttribute *attrs;
+  unsigned numAttrs;
+} LaunchConfig;
+
+typedef CUresult (*cuLaunchKernelEx_t)(const LaunchConfig *, CUfunction, void **, void **);
+
+// CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION
+#define LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION 4
+
+static CUresult launchCluster(CUfunction function, unsigned gridX, unsigned gridY, unsigned gridZ, unsigned threads,
+                              unsigned shared_memory, CUstream stream, unsigned cluster_size, void **params) {
+  static cuLaunchKernelEx_t fn = NULL;
+  if (fn == NULL) {
+    CUresult status = cuGetProcAddress("cuLaunchKernelEx", (void **)&fn, 12000, CU_GET_PROC_ADDRESS_DEFAULT);
+    if (status != CUDA_SUCCESS)
+      return status;
+  }
+  LaunchAttribute attr = {0};
+  attr.id = LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
+  attr.value.clusterDim.x = cluster_size;
+  attr.value.clusterDim.y = 1;
+  attr.value.clusterDim.z = 1;
+  LaunchConfig config = {gridX, gridY, gridZ, threads, 1, 1, shared_memory, stream, &attr, 1};
+  return fn(&config, function, params, NULL);
+}
+""" if num_ctas > 1 else ""
+        cluster_setup = f"""if (gridX % {num_ctas} != 0) {{
+    PyErr_SetString(PyExc_ValueError, "kernels launched in clusters of {num_ctas} CTAs need a multiple of {num_ctas} programs along axis 0");
+    return;
+  }}""" if num_ctas > 1 else ""
+        launch_setup = "\n  ".join(filter(None, [cluster_setup, launch_setup]))
+        if num_ctas > 1:
+            launch = f"CUDA_CHECK(launchCluster(function, gridX, gridY, gridZ, 32*num_warps, shared_memory, stream, {num_ctas}, params));"
+        elif grid_barrier:
+            launch = "CUDA_CHECK(cuLaunchCooperativeKernel(function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, stream, params));"
+        else:
+            launch = "CUDA_CHECK(cuLaunchKernel(function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, stream, params, 0));"
+        # kernels can also be added as nodes of a CUDA graph, and the arguments
+        # of their nodes updated in an instance of the graph; kernels with
+        # tensor maps are not, as the maps are allocated on the launch stream,
+        # nor profiled ones and the ones with grid barriers, whose buffers are
+        # allocated at each launch, nor the ones of clusters, launched with
+        # their own attribute
+        graph_src = "" if tensormaps or profile or num_ctas > 1 or grid_barrier else f"""
+static CUgraphNode _graph_node(CUgraph graph, CUgraphExec exec, CUgraphNode node, int gridX, int gridY, int gridZ, int num_warps, int shared_memory, CUfunction function, {arg_decls}) {{
+  {launch_setup}
+  void *params[] = {{ {', '.join(params)} }};
+  CUDA_KERNEL_NODE_PARAMS node_params = {{function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, params, NULL}};
+  if (exec) {{
+    CUDA_CHECK(cuGraphExecKernelNodeSetParams(exec, node, &node_params));
+    return node;
+  }}
+  // the node added runs after `node`, if any
+  CUgraphNode dependency = node;
+  CUDA_CHECK(cuGraphAddKernelNode(&node, graph, dependency ? &dependency : NULL, dependency ? 1 : 0, &node_params));
+  return node;
+}}
+
+static PyObject* graph_node(PyObject* self, PyObject* args) {{
+  uint64_t _graph;
+  uint64_t _exec;
+  uint64_t _node;
+  int gridX, gridY, gridZ;
+  int num_warps;
+  int shared_memory;
+  uint64_t _function;
+  {' '.join([f"{_extracted_type(ty)} _arg{i}; " for i, ty in signature.items()])}
+  if(!PyArg_ParseTuple(args, \"{graph_format}\", &_graph, &_exec, &_node, &gridX, &gridY, &gridZ, &num_warps, &shared_memory, &_function, {', '.join(f"&_arg{i}" for i, ty in signature.items())})) {{
+    return NULL;
+  }}
+  if (gridX*gridY*gridZ == 0) {{
+    PyErr_SetString(PyExc_ValueError, "Graph nodes cannot have an empty grid");
+    return NULL;
+  }}
+
+  {"; ".join([f"DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}); if (!ptr_info{i}.valid) return NULL;" if ty[0] == "*" else "" for i, ty in signature.items()])};
+  CUgraphNode node = _graph_node((CUgraph)_graph, (CUgraphExec)_exec, (CUgraphNode)_node, gridX, gridY, gridZ, num_warps, shared_memory, (CUfunction)_function, {', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items())});
+
+  if(PyErr_Occurred()) {{
+    return NULL;
+  }}
+  return PyLong_FromUnsignedLongLong((uint64_t)node);
+}}
+"""
+        graph_method = "" if tensormaps or profile or num_ctas > 1 or grid_barrier else \
+            '{"graph_node", graph_node, METH_VARARGS, "Add or update the node of a kernel with this signature in a CUDA graph"},'
         src = f"""
 #include \"cuda.h\"
 #include <stdbool.h>
@@ -259,11 +482,16 @@ static inline void gpuAssert(CUresult code, const char *file, int line)
 }}
 
 #define CUDA_CHECK(ans) {{ gpuAssert((ans), __FILE__, __LINE__); }}
-
+{tensormaps_decls}{cluster_decls}
 static void _launch(int gridX, int gridY, int gridZ, int num_warps, int shared_memory, CUstream stream, CUfunction function, {arg_decls}) {{
-  void *params[] = {{ {', '.join(f"&arg{i}" for i in signature.keys() if i not in constants)} }};
+  {launch_setup}
   if(gridX*gridY*gridZ > 0){{
-    CUDA_CHECK(cuLaunchKernel(function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, stream, params, 0));
+    {tensormaps_setup}
+    {grid_barrier_setup}
+    void *params[] = {{ {', '.join(params)} }};
+    {launch}
+    {tensormaps_cleanup}
+    {grid_barrier_cleanup}
   }}
 }}
 
@@ -347,9 +575,10 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
   Py_INCREF(Py_None);
   return Py_None;
 }}
-
+{graph_src}
 static PyMethodDef ModuleMethods[] = {{
   {{"launch", launch, METH_VARARGS, "Entry point for all kernels with this signature"}},
+  {graph_method}
   {{NULL, NULL, 0, NULL}} // sentinel
 }};
 
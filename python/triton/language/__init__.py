@@ -6,6 +6,7 @@ from .core import (
     abs,
     advance,
     arange,
+    associative_scan,
     argmin,
     argmax,
     atomic_add,
@@ -24,6 +25,8 @@ from .core import (
     cdiv,
     constexpr,
     cos,
+    cumprod,
+    cumsum,
     debug_barrier,
     device_assert,
     device_print,
@@ -38,6 +41,7 @@ from .core import (
     float8e4,
     float8e5,
     function_type,
+    grid_barrier,
     int1,
     int16,
     int32,
@@ -55,6 +59,9 @@ from .core import (
     num_programs,
     pi32_t,
     pointer_type,
+    prefetch,
+    profile_end,
+    profile_start,
     program_id,
     ravel,
     reshape,
@@ -101,6 +108,7 @@ __all__ = [
     "abs",
     "advance",
     "arange",
+    "associative_scan",
     "argmin",
     "argmax",
     "atomic_add",
@@ -120,6 +128,8 @@ __all__ = [
     "cdiv",
     "constexpr",
     "cos",
+    "cumprod",
+    "cumsum",
     "debug_barrier",
     "device_assert",
     "device_print",
@@ -134,6 +144,7 @@ __all__ = [
     "float8e5",
     "full",
     "function_type",
+    "grid_barrier",
     "int1",
     "int16",
     "int32",
@@ -156,6 +167,9 @@ __all__ = [
     "philox_impl",
     "pi32_t",
     "pointer_type",
+    "prefetch",
+    "profile_end",
+    "profile_start",
     "program_id",
     "rand",
     "rand4x",
@@ -63,6 +63,19 @@ def _to_tensor(x, builder):
     assert False, f"cannot convert {x} of type {type(x)} to tensor"
 
 
+def _cached_ir_type(builder: ir.builder, key, to_ir):
+    # The builder keeps the IR types of the dtypes it converted, so that each
+    # of them is only built once per builder rather than on each of its uses
+    try:
+        ir_types = builder.ir_types
+    except AttributeError:
+        ir_types = builder.ir_types = dict()
+    ty = ir_types.get(key)
+    if ty is None:
+        ty = ir_types[key] = to_ir(builder)
+    return ty
+
+
 class dtype:
     SINT_TYPES = ['int8', 'int16', 'int32', 'int64']
     UINT_TYPES = ['int1', 'uint8', 'uint16', 'uint32', 'uint64']
@@ -197,6 +210,9 @@ class dtype:
         return self
 
     def to_ir(self, builder: ir.builder) -> ir.type:
+        return _cached_ir_type(builder, self.name, self._to_ir)
+
+    def _to_ir(self, builder: ir.builder) -> ir.type:
         if self.name == 'void':
             return builder.get_void_ty()
         elif self.name == 'int1':
@@ -245,7 +261,8 @@ class pointer_type(dtype):
         self.name = self.__str__()
 
     def to_ir(self, builder: ir.builder) -> ir.pointer_type:
-        return builder.get_ptr_ty(self.element_ty.to_ir(builder), 1)
+        return _cached_ir_type(builder, ("ptr", self.element_ty.name),
+                               lambda builder: builder.get_ptr_ty(self.element_ty.to_ir(builder), 1))
 
     def __str__(self):
         return f'pointer<{self.element_ty}>'
@@ -292,7 +309,8 @@ class block_type(dtype):
         self.name = self.__str__()
 
     def to_ir(self, builder: ir.builder) -> ir.block_type:
-        return builder.get_block_ty(self.element_ty.to_ir(builder), self.shape)
+        return _cached_ir_type(builder, ("block", self.element_ty.name, tuple(self.shape)),
+                               lambda builder: builder.get_block_ty(self.element_ty.to_ir(builder), self.shape))
 
     def __str__(self):
         return f'<{self.shape}, {self.element_ty}>'
@@ -697,15 +715,15 @@ class tensor:
     def __getitem__(self, slices, _builder=None):
         if isinstance(slices, slice):
             slices = [slices]
-        ret = self
+        axes = []
         for dim, sl in enumerate(slices):
             if isinstance(sl, constexpr) and sl.value is None:
-                ret = semantic.expand_dims(ret, dim, _builder)
+                axes.append(dim)
             elif sl == slice(None, None, None):
                 pass
             else:
                 assert False, "unsupported"
-        return ret
+        return semantic.expand_dims_at(self, axes, _builder)
 
     @property
     def T(self):
@@ -760,6 +778,19 @@ def num_programs(axis, _builder=None):
     return semantic.num_programs(axis, _builder)
 
 
+@builtin
+def grid_barrier(_builder=None):
+    """
+    Waits until every program instance of the launch has reached the barrier. The stores of all the programs
+    before it are visible to the loads of all the programs after it, so that multi-phase algorithms can combine
+    the partial results of the programs in a single launch.
+
+    A kernel with grid barriers is launched cooperatively, and fails to launch when its grid does not fit on
+    the device all at once. Every program has to reach each barrier, the same number of times.
+    """
+    return semantic.grid_barrier(_builder)
+
+
 # -----------------------
 # Block Initialization
 # -----------------------
@@ -994,6 +1025,26 @@ def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", evict
     return semantic.store(pointer, value, mask, boundary_check, cache_modifier, eviction_policy, _builder)
 
 
+@builtin
+def prefetch(pointer, mask=None, eviction_policy="", _builder=None):
+    """
+    Prefetch the memory locations defined by `pointer` into the L2 cache,
+    without loading them into registers. This is a hint with no effect on
+    the results of the program and is ignored on devices that don't support it.
+
+    :param pointer: The memory locations to prefetch
+    :type pointer: Block of `dtype=triton.PointerType`
+    :param mask: If `mask[idx]` is false, do not prefetch `pointer[idx]`
+    :type mask: Block of triton.int1, optional
+    :param eviction_policy: "evict_last" keeps the lines in L2 longer than regular accesses
+    :type eviction_policy: str, optional
+    """
+    if _constexpr_to_value(mask) is not None:
+        mask = _to_tensor(mask, _builder)
+    eviction_policy = _constexpr_to_value(eviction_policy)
+    return semantic.prefetch(pointer, mask, eviction_policy, _builder)
+
+
 # -----------------------
 # Atomic Memory Operations
 # -----------------------
@@ -1354,6 +1405,78 @@ def xor_sum(input, axis, _builder=None, _generator=None):
                      _builder=_builder, _generator=_generator)
 
 
+# -----------------------
+# Scans
+# -----------------------
+
+def _add_scan_docstr(name: str) -> Callable[[T], T]:
+
+    def _decorator(func: T) -> T:
+        docstr = """
+    Returns the {name} of all elements in the :code:`input` tensor along the provided :code:`axis`
+
+    :param input: the input values
+    :param axis: the dimension along which the scan should be done
+    """
+        func.__doc__ = docstr.format(name=name)
+        return func
+
+    return _decorator
+
+
+@builtin
+def associative_scan(input, axis, combine_fn, _builder=None, _generator=None):
+    """Combines each element of the :code:`input` tensors along the provided :code:`axis` with the ones before it, with the combine_fn
+
+    :param input: the input tensor, or tuple of tensors
+    :param axis: the dimension along which the scan should be done
+    :param combine_fn: an associative function to combine two groups of scalar tensors (must be marked with @triton.jit)
+
+    """
+    if isinstance(input, tensor):
+        return associative_scan((input,), axis, combine_fn,
+                                _builder=_builder, _generator=_generator)[0]
+
+    def make_combine_region(scan_op):
+        in_scalar_tys = [t.type.scalar for t in input]
+        prototype = function_type(in_scalar_tys, in_scalar_tys * 2)
+
+        region = scan_op.get_region(0)
+        with _insertion_guard(_builder):
+            param_types = [ty.to_ir(_builder) for ty in prototype.param_types]
+            block = _builder.create_block_with_parent(region, param_types)
+            args = [tensor(block.arg(i), ty)
+                    for i, ty in enumerate(prototype.param_types)]
+            results = _generator.call_JitFunction(combine_fn, args, kwargs={})
+            if isinstance(results, tensor):
+                handles = [results.handle]
+            else:
+                handles = [r.handle for r in results]
+            _builder.create_scan_ret(*handles)
+
+    axis = _constexpr_to_value(axis)
+    return semantic.associative_scan(input, axis, make_combine_region, _builder)
+
+
+@triton.jit
+@_add_scan_docstr("cumsum")
+def cumsum(input, axis=0):
+    input = _promote_reduction_input(input)
+    return associative_scan(input, axis, _sum_combine)
+
+
+@triton.jit
+def _prod_combine(a, b):
+    return a * b
+
+
+@triton.jit
+@_add_scan_docstr("cumprod")
+def cumprod(input, axis=0):
+    input = _promote_reduction_input(input)
+    return associative_scan(input, axis, _prod_combine)
+
+
 # -----------------------
 # Internal for debugging
 # -----------------------
@@ -1568,6 +1691,33 @@ def device_assert(cond, msg="", _builder=None):
     return semantic.device_assert(_to_tensor(cond, _builder), msg, file_name, func_name, lineno, _builder)
 
 
+@builtin
+def profile_start(label, _builder=None):
+    """
+    Marks the start of the region :code:`label` of the kernel, whose time is recorded per warp when it is
+    launched with a :code:`triton.runtime.RegionProfile`.
+
+    :param label: the name of the region
+    :type label: str
+    """
+    label = _constexpr_to_value(label)
+    assert isinstance(label, str), f"{label} is not string"
+    return semantic.profile_marker(label, True, _builder)
+
+
+@builtin
+def profile_end(label, _builder=None):
+    """
+    Marks the end of the region :code:`label` of the kernel, see :code:`profile_start`.
+
+    :param label: the name of the region
+    :type label: str
+    """
+    label = _constexpr_to_value(label)
+    assert isinstance(label, str), f"{label} is not string"
+    return semantic.profile_marker(label, False, _builder)
+
+
 @builtin
 def make_block_ptr(base: tensor, shape, strides, offsets, block_shape, order, _builder=None):
     """
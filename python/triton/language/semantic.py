@@ -121,9 +121,62 @@ def binary_op_type_checking_impl(lhs: tl.tensor,
     return lhs, rhs
 
 
+def _implicit_cast_sign(src_sca_ty: tl.dtype, dst_sca_ty: tl.dtype) -> Optional[bool]:
+    # Whether the implicit cast from src to dst sign extends, for the casts
+    # `create_binary` builds as `cast` does, or None for the others
+    if src_sca_ty == dst_sca_ty:
+        return False
+    if src_sca_ty.is_int() and dst_sca_ty.is_int():
+        if dst_sca_ty.is_bool() or src_sca_ty.int_bitwidth == dst_sca_ty.int_bitwidth:
+            return None
+        return src_sca_ty.is_int_signed() and not src_sca_ty.is_bool()
+    if src_sca_ty.is_int() and dst_sca_ty.is_standard_floating():
+        return src_sca_ty.is_int_signed() and not src_sca_ty.is_bool()
+    if ((src_sca_ty.is_fp16() or src_sca_ty.is_bf16()) and dst_sca_ty.is_fp32()) or \
+       (src_sca_ty.is_fp32() and dst_sca_ty.is_fp64()):
+        return False
+    return None
+
+
+def _bulk_binary_op(input: tl.tensor,
+                    other: tl.tensor,
+                    op: str,
+                    builder: ir.builder,
+                    allow_lhs_ptr=False, allow_rhs_ptr=False) -> Optional[tl.tensor]:
+    # `op` of input and other, with the implicit broadcasts and casts of
+    # binary_op_type_checking_impl, built with a single call of the builder;
+    # None when it needs casts or pointer arithmetic that call does not build
+    shape = _broadcast_shape(input.type, other.type)
+    lhs_sca_ty = input.type.scalar
+    rhs_sca_ty = other.type.scalar
+    check_ptr_type_impl(lhs_sca_ty, rhs_sca_ty, allow_lhs_ptr)
+    check_ptr_type_impl(rhs_sca_ty, lhs_sca_ty, allow_rhs_ptr)
+    is_lhs_signed = is_rhs_signed = False
+    if lhs_sca_ty.is_ptr() or rhs_sca_ty.is_ptr():
+        if op != "add" or (lhs_sca_ty.is_ptr() and rhs_sca_ty.is_ptr()):
+            return None
+        ret_sca_ty = lhs_sca_ty if lhs_sca_ty.is_ptr() else rhs_sca_ty
+        op = "addptr"
+    else:
+        ret_sca_ty = computation_type_impl(lhs_sca_ty, rhs_sca_ty, False)
+        is_lhs_signed = _implicit_cast_sign(lhs_sca_ty, ret_sca_ty)
+        is_rhs_signed = _implicit_cast_sign(rhs_sca_ty, ret_sca_ty)
+        if is_lhs_signed is None or is_rhs_signed is None:
+            return None
+        if ret_sca_ty.is_floating():
+            op = "f" + op
+    ret_ty = tl.block_type(ret_sca_ty, shape) if shape else ret_sca_ty
+    handle = builder.create_binary(op, input.handle, other.handle, shape, ret_sca_ty.to_ir(builder),
+                                   is_lhs_signed, is_rhs_signed)
+    return tl.tensor(handle, ret_ty)
+
+
 def add(input: tl.tensor,
         other: tl.tensor,
         builder: ir.builder) -> tl.tensor:
+    ret = _bulk_binary_op(input, other, "add", builder, True, True)
+    if ret is not None:
+        return ret
     input, other = binary_op_type_checking_impl(input, other, builder, True, True)
     input_scalar_ty = input.type.scalar
     other_scalar_ty = other.type.scalar
@@ -146,6 +199,9 @@ def add(input: tl.tensor,
 def sub(input: tl.tensor,
         other: tl.tensor,
         builder: ir.builder) -> tl.tensor:
+    ret = _bulk_binary_op(input, other, "sub", builder, True, False)
+    if ret is not None:
+        return ret
     input, other = binary_op_type_checking_impl(input, other, builder, True, False)
     scalar_ty = input.type.scalar
     # ptr - offset
@@ -164,6 +220,9 @@ def sub(input: tl.tensor,
 def mul(input: tl.tensor,
         other: tl.tensor,
         builder: ir.builder) -> tl.tensor:
+    ret = _bulk_binary_op(input, other, "mul", builder)
+    if ret is not None:
+        return ret
     input, other = binary_op_type_checking_impl(input, other, builder)
     scalar_ty = input.type.scalar
     # float * float
@@ -547,6 +606,17 @@ def expand_dims(input: tl.tensor, axis: int, builder: ir.builder) -> tl.tensor:
     return tl.tensor(builder.create_expand_dims(input.handle, axis), ret_ty)
 
 
+def expand_dims_at(input: tl.tensor, axes: List[int], builder: ir.builder) -> tl.tensor:
+    # expand_dims at each of `axes` in turn, with a single call of the builder
+    if not axes:
+        return input
+    dst_shape = list(input.type.shape)
+    for axis in axes:
+        dst_shape.insert(axis, 1)
+    ret_ty = tl.block_type(input.type.scalar, dst_shape)
+    return tl.tensor(builder.create_expand_dims_at(input.handle, axes), ret_ty)
+
+
 def cat(lhs: tl.tensor, rhs: tl.tensor, can_reorder: bool, builder: ir.builder) -> tl.tensor:
     assert can_reorder, "current implementation of `cat` always may reorder elements"
     assert len(lhs.shape) == 1
@@ -581,58 +651,48 @@ def broadcast_impl_shape(input: tl.tensor,
     return tl.tensor(builder.create_broadcast(input.handle, shape), ret_ty)
 
 
+def _broadcast_shape(lhs_ty: tl.dtype, rhs_ty: tl.dtype) -> List[int]:
+    # shape of the implicit broadcast of lhs and rhs, empty for two scalars
+    if not lhs_ty.is_block():
+        return list(rhs_ty.get_block_shapes()) if rhs_ty.is_block() else []
+    if not rhs_ty.is_block():
+        return list(lhs_ty.get_block_shapes())
+    lhs_shape = lhs_ty.get_block_shapes()
+    rhs_shape = rhs_ty.get_block_shapes()
+    # missing axes are added in front
+    lhs_shape = [1] * (len(rhs_shape) - len(lhs_shape)) + list(lhs_shape)
+    rhs_shape = [1] * (len(lhs_shape) - len(rhs_shape)) + list(rhs_shape)
+
+    ret_shape = []
+    for i, left in enumerate(lhs_shape):
+        right = rhs_shape[i]
+        if left == 1:
+            ret_shape.append(right)
+        elif right == 1:
+            ret_shape.append(left)
+        elif left == right:
+            ret_shape.append(left)
+        else:
+            raise ValueError("Cannot make_shape_compatible: incompatible dimensions "
+                             "at index " + str(i) + ": " + str(left) + " and " + str(right))
+    return ret_shape
+
+
 def broadcast_impl_value(lhs: tl.tensor,
                          rhs: tl.tensor,
                          builder: ir.builder) -> tl.tensor:
     lhs_ty = lhs.type
     rhs_ty = rhs.type
-
-    # make_shape_compatible(block, scalar)
-    if lhs_ty.is_block() and not rhs_ty.is_block():
-        rhs_ty = tl.block_type(rhs_ty.scalar, lhs_ty.shape)
-        rhs = tl.tensor(builder.create_splat(rhs.handle, lhs_ty.get_block_shapes()), rhs_ty)
-    # make_shape_compatible(scalar, block)
-    elif not lhs_ty.is_block() and rhs_ty.is_block():
-        lhs_ty = tl.block_type(lhs_ty.scalar, rhs_ty.shape)
-        lhs = tl.tensor(builder.create_splat(lhs.handle, rhs_ty.get_block_shapes()), lhs_ty)
-    # make_shape_compatible(block, block)
-    elif lhs_ty.is_block() and rhs_ty.is_block():
-        lhs_shape = lhs_ty.get_block_shapes()
-        rhs_shape = rhs_ty.get_block_shapes()
-
-        if len(lhs_shape) < len(rhs_shape):
-            # Add new axes to lhs
-            for dim in range(len(lhs_shape), len(rhs_shape)):
-                lhs = tl.tensor(builder.create_expand_dims(lhs.handle, 0), tl.block_type(lhs_ty.scalar, [1] + lhs_shape))
-                lhs_ty = lhs.type
-                lhs_shape = lhs_ty.get_block_shapes()
-        elif len(rhs_shape) < len(lhs_shape):
-            # Add new axes to rhs
-            for dim in range(len(rhs_shape), len(lhs_shape)):
-                rhs = tl.tensor(builder.create_expand_dims(rhs.handle, 0), tl.block_type(rhs_ty.scalar, [1] + rhs_shape))
-                rhs_ty = rhs.type
-                rhs_shape = rhs_ty.get_block_shapes()
-        assert len(rhs_shape) == len(lhs_shape)
-
-        ret_shape = []
-        for i, left in enumerate(lhs_shape):
-            right = rhs_shape[i]
-            if left == 1:
-                ret_shape.append(right)
-            elif right == 1:
-                ret_shape.append(left)
-            elif left == right:
-                ret_shape.append(left)
-            else:
-                raise ValueError("Cannot make_shape_compatible: incompatible dimensions "
-                                 "at index " + str(i) + ": " + str(left) + " and " + str(right))
-        if lhs_shape != ret_shape:
-            ret_ty = tl.block_type(lhs_ty.scalar, ret_shape)
-            lhs = tl.tensor(builder.create_broadcast(lhs.handle, ret_shape), ret_ty)
-        if rhs_shape != ret_shape:
-            ret_ty = tl.block_type(rhs_ty.scalar, ret_shape)
-            rhs = tl.tensor(builder.create_broadcast(rhs.handle, ret_shape), ret_ty)
+    ret_shape = _broadcast_shape(lhs_ty, rhs_ty)
     # (scalar, scalar) => returns original blocks
+    if not ret_shape:
+        return lhs, rhs
+    # scalars are splat, and blocks get the missing axes in front and are
+    # broadcast, each with a single call of the builder
+    if not lhs_ty.is_block() or lhs_ty.get_block_shapes() != ret_shape:
+        lhs = tl.tensor(builder.create_broadcast_to(lhs.handle, ret_shape), tl.block_type(lhs_ty.scalar, ret_shape))
+    if not rhs_ty.is_block() or rhs_ty.get_block_shapes() != ret_shape:
+        rhs = tl.tensor(builder.create_broadcast_to(rhs.handle, ret_shape), tl.block_type(rhs_ty.scalar, ret_shape))
     return lhs, rhs
 
 #######
@@ -775,15 +835,33 @@ def cast(input: tl.tensor,
 # ===----------------------------------------------------------------------===//
 
 
-def _str_to_cache_modifier(cache_modifier):
+def _str_to_load_cache_modifier(cache_modifier):
     cache = ir.CACHE_MODIFIER.NONE  # default
     if cache_modifier:
         if cache_modifier == ".ca":
             cache = ir.CACHE_MODIFIER.CA
         elif cache_modifier == ".cg":
             cache = ir.CACHE_MODIFIER.CG
+        elif cache_modifier == ".cs":
+            cache = ir.CACHE_MODIFIER.CS
+        else:
+            raise ValueError(f"Cache modifier {cache_modifier} not supported for loads")
+    return cache
+
+
+def _str_to_store_cache_modifier(cache_modifier):
+    cache = ir.CACHE_MODIFIER.NONE  # default
+    if cache_modifier:
+        if cache_modifier == ".wb":
+            cache = ir.CACHE_MODIFIER.WB
+        elif cache_modifier == ".cg":
+            cache = ir.CACHE_MODIFIER.CG
+        elif cache_modifier == ".cs":
+            cache = ir.CACHE_MODIFIER.CS
+        elif cache_modifier == ".wt":
+            cache = ir.CACHE_MODIFIER.WT
         else:
-            raise ValueError(f"Cache modifier {cache_modifier} not supported")
+            raise ValueError(f"Cache modifier {cache_modifier} not supported for stores")
     return cache
 
 
@@ -913,7 +991,7 @@ def load(ptr: tl.tensor,
          is_volatile: bool,
          builder: ir.builder) -> tl.tensor:
     # Cache, eviction and padding options
-    cache = _str_to_cache_modifier(cache_modifier)
+    cache = _str_to_load_cache_modifier(cache_modifier)
     eviction = _str_to_eviction_policy(eviction_policy)
     padding = _str_to_padding_option(padding_option)
 
@@ -1002,7 +1080,7 @@ def store(ptr: tl.tensor,
           eviction_policy: str,
           builder: ir.builder) -> tl.tensor:
     # Cache and eviction options
-    cache = _str_to_cache_modifier(cache_modifier)
+    cache = _str_to_store_cache_modifier(cache_modifier)
     eviction = _str_to_eviction_policy(eviction_policy)
 
     if ptr.type.is_ptr() and ptr.type.element_ty.is_block():
@@ -1013,6 +1091,23 @@ def store(ptr: tl.tensor,
         return _store_legacy(ptr, val, mask, boundary_check, cache, eviction, builder)
 
 
+def prefetch(ptr: tl.tensor,
+             mask: Optional[tl.tensor],
+             eviction_policy: str,
+             builder: ir.builder) -> tl.tensor:
+    if not ptr.type.scalar.is_ptr() or ptr.type.scalar.element_ty.is_block():
+        raise ValueError(f"Unsupported ptr type {ptr.type.__repr__()} in `tl.prefetch`")
+    eviction = _str_to_eviction_policy(eviction_policy)
+    if mask:
+        if not mask.type.scalar.is_bool():
+            raise ValueError("Mask must have boolean scalar type")
+        if ptr.type.is_block():
+            mask = broadcast_impl_shape(mask, ptr.type.get_block_shapes(), builder)
+        elif mask.type.is_block():
+            raise ValueError("Mask argument cannot be block type if pointer argument is not a block")
+    return tl.tensor(builder.create_prefetch(ptr.handle, mask.handle if mask else None, eviction), tl.void)
+
+
 #########
 # atomic
 #########
@@ -1193,6 +1288,11 @@ def dot(lhs: tl.tensor,
         assert lhs.shape[1].value >= 32, "small blocks not supported!"
         _0 = builder.get_int32(0)
         ret_scalar_ty = tl.int32
+    elif lhs.type.scalar.is_fp8():
+        # fp8 is multiplied by 8-bit tensor cores on sm89+, as fp16 before
+        assert lhs.shape[1].value >= 32, "small blocks not supported!"
+        _0 = builder.get_fp32(0)
+        ret_scalar_ty = tl.float32
     elif lhs.type.scalar.is_fp32() or lhs.type.scalar.is_bf16():
         _0 = builder.get_fp32(0)
         ret_scalar_ty = tl.float32
@@ -1261,6 +1361,29 @@ def reduction(
     )
 
 
+# ===----------------------------------------------------------------------===
+#                               Scan
+# ===----------------------------------------------------------------------===
+
+def associative_scan(
+    inputs: Sequence[tl.tensor], axis: int, region_builder_fn, builder: ir.builder
+) -> Tuple[tl.tensor, ...]:
+    shape = inputs[0].type.shape
+    if axis < 0 or axis >= len(shape):
+        raise ValueError(f"axis {axis} is out of range for a tensor of rank {len(shape)}")
+    for t in inputs:
+        assert t.type.shape == shape
+
+    scan_op = builder.create_scan([t.handle for t in inputs], axis)
+    region_builder_fn(scan_op)
+    scan_op.verify()
+
+    return tuple(
+        tl.tensor(scan_op.get_result(i), inputs[i].type)
+        for i in range(len(inputs))
+    )
+
+
 # ===----------------------------------------------------------------------===
 #                               Math
 # ===----------------------------------------------------------------------===
@@ -1359,6 +1482,10 @@ def debug_barrier(builder: ir.builder) -> tl.tensor:
     return tl.tensor(builder.create_barrier(), tl.void)
 
 
+def grid_barrier(builder: ir.builder) -> tl.tensor:
+    return tl.tensor(builder.create_grid_barrier(), tl.void)
+
+
 def device_print(prefix: str, args: List[tl.tensor], builder: ir.builder) -> tl.tensor:
     new_args = []
     for arg in args:
@@ -1370,6 +1497,10 @@ def device_assert(cond: tl.tensor, msg: str, file_name: str, func_name, lineno:
     return tl.tensor(builder.create_assert(cond.handle, msg, file_name, func_name, lineno), tl.void)
 
 
+def profile_marker(label: str, is_start: bool, builder: ir.builder) -> tl.tensor:
+    return tl.tensor(builder.create_profile_marker(label, is_start), tl.void)
+
+
 def _convert_elem_to_ir_value(builder, elem, require_i64):
     if isinstance(elem, tl.constexpr):
         return builder.get_int64(elem.value) if require_i64 else builder.get_int32(elem.value)
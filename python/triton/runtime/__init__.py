@@ -1,8 +1,12 @@
 from .autotuner import (Autotuner, Config, Heuristics, OutOfResources, autotune,
                         heuristics)
 from .driver import driver
+from .fusion import FusedKernel
+from .graph import KernelGraph
+from .jagged import JaggedGrid
 from .jit import (JITFunction, KernelInterface, MockTensor, TensorWrapper, reinterpret,
                   version_key)
+from .profile import RegionProfile
 
 __all__ = [
     "driver",
@@ -18,4 +22,8 @@ __all__ = [
     "OutOfResources",
     "MockTensor",
     "Autotuner",
+    "KernelGraph",
+    "FusedKernel",
+    "JaggedGrid",
+    "RegionProfile",
 ]
@@ -1,11 +1,27 @@
 from __future__ import annotations
 
 import builtins
+import json
+import os
 import time
+from concurrent.futures import ThreadPoolExecutor, as_completed
 from typing import Dict
 
-from ..testing import do_bench
-from .jit import KernelInterface
+from ..testing import BenchmarkResult, do_bench
+from .cache import TuningDatabase
+from .driver import driver
+from .jit import (JITFunction, KernelInterface, MockTensor, get_current_device,
+                  set_current_device)
+
+# Limits of the register file of NVIDIA GPUs, and the number of warps per SM
+# below which the latency of memory accesses is assumed not to be hidden
+_REGS_PER_SM = 65536
+_MAX_REGS_PER_THREAD = 255
+_MIN_RESIDENT_WARPS = 4
+
+# The configs are benchmarked until the confidence interval of their median
+# time is within this fraction of it
+_BENCH_REL_CI = 0.01
 
 
 class OutOfResources(Exception):
@@ -75,11 +91,156 @@ class Autotuner(KernelInterface):
             if config.pre_hook:
                 config.pre_hook(self.nargs)
             self.hook(args)
-            self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages, **current)
+            self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages, split_k=config.split_k,
+                        num_ctas=config.num_ctas, **current)
         try:
-            return do_bench(kernel_call, quantiles=(0.5, 0.2, 0.8))
+            return do_bench(kernel_call, return_mode="all", reject_outliers=True, rel_ci=_BENCH_REL_CI)
         except OutOfResources:
-            return [float('inf'), float('inf'), float('inf')]
+            return BenchmarkResult([float('inf')])
+
+    def _run_all(self, configs, *args, **kwargs):
+        """
+        Calls the kernel with each of `configs` concurrently, e.g. to compile
+        them, and yields each config with the result of its call as soon as
+        it returns. The compiler releases the GIL while it runs passes and
+        backends, so the caller can use the ones already compiled on the
+        device while the others are still compiling.
+        """
+        device = kwargs.get("device")
+        if device is None:
+            device = get_current_device()
+
+        def run_config(config):
+            # the current device is per thread
+            set_current_device(device)
+            current = dict(kwargs, device=device, **config.kwargs)
+            return self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages,
+                               split_k=config.split_k, num_ctas=config.num_ctas, **current)
+
+        max_workers = builtins.min(len(configs), os.cpu_count() or 1)
+        with ThreadPoolExecutor(max_workers=builtins.max(max_workers, 1)) as executor:
+            futures = {executor.submit(run_config, config): config for config in configs}
+            for future in as_completed(futures):
+                yield futures[future], future.result()
+
+    def _compile_all(self, configs, *args, **kwargs):
+        for config, _ in self._run_all(configs, *args, warmup=True, **kwargs):
+            yield config
+
+    def _prune_by_resources(self, configs, *args, **kwargs):
+        """
+        Drops the configs that the compiler estimates, from their TTGIR, to
+        need more shared memory than the device has, or so many registers
+        that fewer than `_MIN_RESIDENT_WARPS` warps fit on an SM, before
+        LLVM and ptxas run for them. All the configs are kept if none would.
+        """
+        import torch
+        if len(configs) <= 1 or torch.version.hip is not None:
+            return configs
+        device = kwargs.get("device")
+        if device is None:
+            device = get_current_device()
+        max_shared = driver.utils.get_device_properties(device)["max_shared_mem"]
+
+        def fits(config, resources):
+            # compiled already
+            if resources is None:
+                return True
+            if resources["shared"] > max_shared:
+                return False
+            regs = builtins.max(resources["registers"], 1)
+            if regs > _MAX_REGS_PER_THREAD:
+                return False
+            programs = _REGS_PER_SM // (regs * 32 * config.num_warps)
+            if resources["shared"] > 0:
+                programs = builtins.min(programs, max_shared // resources["shared"])
+            return programs * config.num_warps >= builtins.min(_MIN_RESIDENT_WARPS, config.num_warps)
+
+        kept = {config for config, resources in self._run_all(configs, *args, estimate=True, **kwargs)
+                if fits(config, resources)}
+        if not kept:
+            return configs
+        return [config for config in configs if config in kept]
+
+    @staticmethod
+    def _lacks_resources(config, bin):
+        """
+        Whether ptxas reports that the compiled `bin` of `config` spills
+        registers, or uses so many of them or so much shared memory that
+        fewer than `_MIN_RESIDENT_WARPS` warps fit on an SM.
+        """
+        metadata = getattr(bin, "metadata", None) or dict()
+        info = metadata.get("ptxas_info", dict())
+        if info.get("spill_stores", 0) + info.get("spill_loads", 0) > 0:
+            return True
+        occupancy = metadata.get("occupancy")
+        if occupancy is None:
+            return False
+        warps = occupancy["programs_per_sm"] * config.num_warps
+        return warps < builtins.min(_MIN_RESIDENT_WARPS, config.num_warps)
+
+    def _bench_all(self, configs, *args, **kwargs):
+        """
+        Benchmarks the configs as soon as they are compiled, except the ones
+        that lack resources once compiled, which are only benchmarked if all
+        of the configs do.
+        """
+        timings = dict()
+        lacking = []
+        for config, bin in self._run_all(configs, *args, warmup=True, **kwargs):
+            if self._lacks_resources(config, bin):
+                lacking.append(config)
+            else:
+                timings[config] = self._bench(*args, config=config, **kwargs)
+        if not timings:
+            for config in lacking:
+                timings[config] = self._bench(*args, config=config, **kwargs)
+        # benchmarks complete in any order, keep ties on the order of the configs
+        return {config: timings[config] for config in configs if config in timings}
+
+    @staticmethod
+    def _pick_best(timings):
+        """
+        Returns the first of the benchmarked configs that the fastest one is
+        not significantly faster than, i.e. whose median time has a confidence
+        interval overlapping the one of the fastest. Configs that perform the
+        same are then told apart by their order rather than by noise, so that
+        the same one wins from run to run.
+        """
+        fastest = builtins.min(timings.values(), key=lambda t: t.median)
+        return next(config for config, t in timings.items() if not fastest.significantly_faster(t))
+
+    def _tuning_key(self, key):
+        import torch
+        fn = self.fn
+        while not isinstance(fn, JITFunction):
+            fn = fn.fn
+        device_name = torch.cuda.get_device_name(get_current_device())
+        return TuningDatabase.make_key(fn.cache_key, key, device_name)
+
+    @staticmethod
+    def _tuning_entry(config):
+        entry = {"kwargs": config.kwargs, "num_warps": config.num_warps, "num_stages": config.num_stages,
+                 "split_k": config.split_k}
+        if config.num_ctas > 1:
+            entry["num_ctas"] = config.num_ctas
+        try:
+            return json.loads(json.dumps(entry))
+        except TypeError:
+            return None
+
+    def _load_tuned(self, key):
+        # the entry is matched against the configs, which hold the pre_hooks,
+        # and is ignored if they changed since it was stored
+        entry = TuningDatabase().get(self._tuning_key(key))
+        if entry is None:
+            return None
+        return next((c for c in self.configs if self._tuning_entry(c) == entry), None)
+
+    def _store_tuned(self, key, config):
+        entry = self._tuning_entry(config)
+        if entry is not None:
+            TuningDatabase().put(self._tuning_key(key), entry)
 
     def run(self, *args, **kwargs):
         self.nargs = dict(zip(self.arg_names, args))
@@ -90,24 +251,29 @@ class Autotuner(KernelInterface):
                 if name in all_args:
                     _args.append(all_args[name])
             key = tuple(_args[i] for i in self.key_idx)
+            if key not in self.cache:
+                tuned = self._load_tuned(key)
+                if tuned is not None:
+                    self.cache[key] = tuned
             if key not in self.cache:
                 # prune configs
-                pruned_configs = self.prune_configs(kwargs)
+                pruned_configs = self._prune_by_resources(self.prune_configs(kwargs), *args, **kwargs)
                 bench_start = time.time()
-                timings = {config: self._bench(*args, config=config, **kwargs)
-                           for config in pruned_configs}
+                timings = self._bench_all(pruned_configs, *args, **kwargs)
                 bench_end = time.time()
                 self.bench_time = bench_end - bench_start
-                self.cache[key] = builtins.min(timings, key=timings.get)
+                self.cache[key] = self._pick_best(timings)
                 self.hook(args)
                 self.configs_timings = timings
+                self._store_tuned(key, self.cache[key])
             config = self.cache[key]
         else:
             config = self.configs[0]
         self.best_config = config
         if config.pre_hook is not None:
             config.pre_hook(self.nargs)
-        return self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages, **kwargs, **config.kwargs)
+        return self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages, split_k=config.split_k,
+                           num_ctas=config.num_ctas, **kwargs, **config.kwargs)
 
     def prune_configs(self, kwargs):
         pruned_configs = self.configs
@@ -128,14 +294,10 @@ class Autotuner(KernelInterface):
 
     def warmup(self, *args, **kwargs):
         self.nargs = dict(zip(self.arg_names, args))
-        for config in self.prune_configs(kwargs):
-            self.fn.warmup(
-                *args,
-                num_warps=config.num_warps,
-                num_stages=config.num_stages,
-                **kwargs,
-                **config.kwargs,
-            )
+        args = list(map(MockTensor.wrap_dtype, args))
+        configs = self._prune_by_resources(self.prune_configs(kwargs), *args, **kwargs)
+        for _ in self._compile_all(configs, *args, **kwargs):
+            pass
         self.nargs = None
 
 
@@ -151,14 +313,24 @@ class Config:
     :ivar num_stages: the number of stages that the compiler should use when software-pipelining loops.
                        Mostly useful for matrix multiplication workloads on SM80+ GPUs.
     :type num_stages: int
+    :ivar split_k: the number of programs the K loop of a matrix multiplication is split across. The
+                    partial sums are added atomically, so the output must be zero-initialized
+                    (e.g., with `reset_to_zero`) and have the type of the accumulator (e.g., float32).
+    :type split_k: int
+    :ivar num_ctas: the number of consecutive programs along axis 0 launched together as a thread
+                    block cluster, on SM90+ GPUs. The number of programs along axis 0 must be a
+                    multiple of it.
+    :type num_ctas: int
     :ivar pre_hook: a function that will be called before the kernel is called. Parameters of this
                     function are args.
     """
 
-    def __init__(self, kwargs, num_warps=4, num_stages=2, pre_hook=None):
+    def __init__(self, kwargs, num_warps=4, num_stages=2, pre_hook=None, split_k=1, num_ctas=1):
         self.kwargs = kwargs
         self.num_warps = num_warps
         self.num_stages = num_stages
+        self.split_k = split_k
+        self.num_ctas = num_ctas
         self.pre_hook = pre_hook
 
     def __str__(self):
@@ -167,6 +339,10 @@ class Config:
             res.append(f'{k}: {v}')
         res.append(f'num_warps: {self.num_warps}')
         res.append(f'num_stages: {self.num_stages}')
+        if self.split_k > 1:
+            res.append(f'split_k: {self.split_k}')
+        if self.num_ctas > 1:
+            res.append(f'num_ctas: {self.num_ctas}')
         return ', '.join(res)
 
 
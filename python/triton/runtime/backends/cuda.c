@@ -101,11 +101,65 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
                        n_spills);
 }
 
+static PyObject *unloadBinary(PyObject *self, PyObject *args) {
+  uint64_t mod;
+  if (!PyArg_ParseTuple(args, "K", &mod))
+    return NULL;
+  CUDA_CHECK(cuModuleUnload((CUmodule)mod));
+  Py_RETURN_NONE;
+}
+
+// CUDA graphs, whose kernel nodes are added by the launchers of the kernels
+static PyObject *graphCreate(PyObject *self, PyObject *args) {
+  CUgraph graph;
+  CUDA_CHECK(cuGraphCreate(&graph, 0));
+  return PyLong_FromUnsignedLongLong((uint64_t)graph);
+}
+
+static PyObject *graphInstantiate(PyObject *self, PyObject *args) {
+  uint64_t graph;
+  if (!PyArg_ParseTuple(args, "K", &graph))
+    return NULL;
+  CUgraphExec exec;
+  CUDA_CHECK(cuGraphInstantiateWithFlags(&exec, (CUgraph)graph, 0));
+  return PyLong_FromUnsignedLongLong((uint64_t)exec);
+}
+
+static PyObject *graphLaunch(PyObject *self, PyObject *args) {
+  uint64_t exec;
+  uint64_t stream;
+  if (!PyArg_ParseTuple(args, "KK", &exec, &stream))
+    return NULL;
+  CUDA_CHECK(cuGraphLaunch((CUgraphExec)exec, (CUstream)stream));
+  Py_RETURN_NONE;
+}
+
+static PyObject *graphDestroy(PyObject *self, PyObject *args) {
+  uint64_t graph;
+  uint64_t exec;
+  if (!PyArg_ParseTuple(args, "KK", &graph, &exec))
+    return NULL;
+  if (exec)
+    CUDA_CHECK(cuGraphExecDestroy((CUgraphExec)exec));
+  if (graph)
+    CUDA_CHECK(cuGraphDestroy((CUgraph)graph));
+  Py_RETURN_NONE;
+}
+
 static PyMethodDef ModuleMethods[] = {
     {"load_binary", loadBinary, METH_VARARGS,
      "Load provided cubin into CUDA driver"},
+    {"unload_binary", unloadBinary, METH_VARARGS,
+     "Unload a module loaded by load_binary"},
     {"get_device_properties", getDeviceProperties, METH_VARARGS,
      "Get the properties for a given device"},
+    {"graph_create", graphCreate, METH_NOARGS, "Create an empty CUDA graph"},
+    {"graph_instantiate", graphInstantiate, METH_VARARGS,
+     "Instantiate a CUDA graph"},
+    {"graph_launch", graphLaunch, METH_VARARGS,
+     "Launch an instance of a CUDA graph on a stream"},
+    {"graph_destroy", graphDestroy, METH_VARARGS,
+     "Destroy a CUDA graph and its instance"},
     {NULL, NULL, 0, NULL} // sentinel
 };
 
@@ -53,21 +53,6 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
     return NULL;
   }
 
-  // Open HSACO file
-  FILE *hsaco_file;
-  if ((hsaco_file = fopen(data, "rb")) == NULL) {
-    return NULL;
-  }
-
-  // Read HSCAO file into Buffer
-  fseek(hsaco_file, 0L, SEEK_END);
-  size_t hsaco_file_size = ftell(hsaco_file);
-  unsigned char *hsaco =
-      (unsigned char *)malloc(hsaco_file_size * sizeof(unsigned char));
-  rewind(hsaco_file);
-  fread(hsaco, sizeof(unsigned char), hsaco_file_size, hsaco_file);
-  fclose(hsaco_file);
-
   // set HIP options
   hipJitOption opt[] = {hipJitOptionErrorLogBufferSizeBytes,
                         hipJitOptionErrorLogBuffer,
@@ -83,9 +68,8 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
   // launch HIP Binary
   hipModule_t mod;
   hipFunction_t fun;
-  hipModuleLoadDataEx(&mod, hsaco, 5, opt, optval);
-  hipModuleGetFunction(&fun, mod, name);
-  free(hsaco);
+  HIP_CHECK(hipModuleLoadDataEx(&mod, data, 5, opt, optval));
+  HIP_CHECK(hipModuleGetFunction(&fun, mod, name));
 
   // get allocated registers and spilled registers from the function
   int n_regs = 0;
@@ -97,9 +81,19 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
                        n_spills);
 }
 
+static PyObject *unloadBinary(PyObject *self, PyObject *args) {
+  uint64_t mod;
+  if (!PyArg_ParseTuple(args, "K", &mod))
+    return NULL;
+  HIP_CHECK(hipModuleUnload((hipModule_t)mod));
+  Py_RETURN_NONE;
+}
+
 static PyMethodDef ModuleMethods[] = {
     {"load_binary", loadBinary, METH_VARARGS,
      "Load provided hsaco into HIP driver"},
+    {"unload_binary", unloadBinary, METH_VARARGS,
+     "Unload a module loaded by load_binary"},
     {"get_device_properties", getDeviceProperties, METH_VARARGS,
      "Get the properties for a given device"},
     {NULL, NULL, 0, NULL} // sentinel
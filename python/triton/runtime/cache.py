@@ -1,6 +1,9 @@
 import json
 import os
+import threading
 from abc import ABC, abstractmethod
+from collections import OrderedDict
+from contextlib import contextmanager
 from pathlib import Path
 from typing import Dict, Optional
 
@@ -35,25 +38,118 @@ class CacheManager(ABC):
     def put_group(self, filename: str, group: Dict[str, str]):
         pass
 
+    def compile_lock_path(self) -> Optional[str]:
+        # file locked by the processes compiling the files of the key, if any
+        return None
+
+    def evict(self, filename):
+        # forgets a file, and the group it addresses, that was returned from
+        # the cache but could not be opened, e.g. as another process removed it
+        pass
+
+
+class _LRU:
+    # Process-level map of the most recently used entries, which bounds the
+    # lookups of the cache managers that go to the file system
+    def __init__(self, size):
+        self.size = size
+        self.entries = OrderedDict()
+        self.lock = threading.Lock()
+
+    def get(self, key):
+        with self.lock:
+            value = self.entries.get(key)
+            if value is not None:
+                self.entries.move_to_end(key)
+            return value
+
+    def put(self, key, value):
+        if self.size <= 0:
+            return
+        with self.lock:
+            self.entries[key] = value
+            self.entries.move_to_end(key)
+            while len(self.entries) > self.size:
+                self.entries.popitem(last=False)
+
+    def discard(self, key):
+        with self.lock:
+            self.entries.pop(key, None)
+
+    def clear(self):
+        with self.lock:
+            self.entries.clear()
+
+
+# paths of the files and groups found in, or written to, cache directories;
+# only hits are remembered, as other processes may fill the cache, and they
+# are trusted until opening them fails, see `CacheManager.evict`
+_memory_cache = _LRU(int(os.environ.get("TRITON_CACHE_LRU_SIZE", 4096)))
+
+
+def clear_memory_cache():
+    """Forgets the cached files found so far, e.g. after removing a cache directory."""
+    _memory_cache.clear()
+
+
+# keys being compiled by the threads of the process
+_in_flight = set()
+_in_flight_cond = threading.Condition()
+
+
+@contextmanager
+def single_flight(key, lock_path=None):
+    """
+    Runs the body for one caller of `key` at a time. The other threads of the
+    process wait on a condition variable, and the other processes on the file
+    lock at `lock_path`, if any, so that they find the files produced by the
+    first caller in the cache instead of producing them again.
+    """
+    with _in_flight_cond:
+        while key in _in_flight:
+            _in_flight_cond.wait()
+        _in_flight.add(key)
+    try:
+        if lock_path is None:
+            yield
+        else:
+            os.makedirs(os.path.dirname(lock_path), exist_ok=True)
+            with FileLock(lock_path):
+                yield
+    finally:
+        with _in_flight_cond:
+            _in_flight.discard(key)
+            _in_flight_cond.notify_all()
+
 
 class FileCacheManager(CacheManager):
     def __init__(self, key):
         self.key = key
         self.lock_path = None
-        # create cache directory if it doesn't exist
+        # the cache directory is created by the first file put in it
         self.cache_dir = os.environ.get('TRITON_CACHE_DIR', default_cache_dir())
         if self.cache_dir:
             self.cache_dir = os.path.join(self.cache_dir, self.key)
             self.lock_path = os.path.join(self.cache_dir, "lock")
-            os.makedirs(self.cache_dir, exist_ok=True)
 
     def _make_path(self, filename) -> str:
         return os.path.join(self.cache_dir, filename)
 
+    def compile_lock_path(self) -> Optional[str]:
+        if not self.cache_dir:
+            return None
+        return self._make_path("compile.lock")
+
     def has_file(self, filename):
         if not self.cache_dir:
             return False
-        return os.path.exists(self._make_path(filename))
+        filepath = self._make_path(filename)
+        if _memory_cache.get(filepath) is not None:
+            return True
+        if not os.path.exists(filepath):
+            return False
+        _memory_cache.put(filepath, filepath)
+        return True
 
     def get_file(self, filename) -> Optional[str]:
         if self.has_file(filename):
@@ -63,9 +159,14 @@ class FileCacheManager(CacheManager):
 
     def get_group(self, filename: str) -> Optional[Dict[str, str]]:
         grp_filename = f"__grp__{filename}"
-        if not self.has_file(grp_filename):
+        if not self.cache_dir:
             return None
         grp_filepath = self._make_path(grp_filename)
+        result = _memory_cache.get(("group", grp_filepath))
+        if result is not None:
+            return dict(result)
+        if not self.has_file(grp_filename):
+            return None
         with open(grp_filepath) as f:
             grp_data = json.load(f)
         child_paths = grp_data.get("child_paths", None)
@@ -78,7 +179,16 @@ class FileCacheManager(CacheManager):
             if not os.path.exists(p):
                 raise Exception(f"Group file {p} does not exist from group {grp_filename} ")
             result[c] = p
-        return result
+        _memory_cache.put(("group", grp_filepath), result)
+        return dict(result)
+
+    def evict(self, filename):
+        if not self.cache_dir:
+            return
+        grp_filepath = self._make_path(f"__grp__{filename}")
+        _memory_cache.discard(self._make_path(filename))
+        _memory_cache.discard(grp_filepath)
+        _memory_cache.discard(("group", grp_filepath))
 
     # Note a group of pushed files as being part of a group
     def put_group(self, filename: str, group: Dict[str, str]):
@@ -96,15 +206,182 @@ class FileCacheManager(CacheManager):
             data = str(data)
         assert self.lock_path is not None
         filepath = self._make_path(filename)
+        os.makedirs(self.cache_dir, exist_ok=True)
         with FileLock(self.lock_path):
             # use tempfile to be robust against program interruptions
             mode = "wb" if binary else "w"
             with open(filepath + ".tmp", mode) as f:
                 f.write(data)
             os.rename(filepath + ".tmp", filepath)
+        _memory_cache.put(filepath, filepath)
         return filepath
 
 
+class RemoteCacheBackend(ABC):
+    """
+    Store of cached files shared by several hosts, e.g. an S3 bucket or a
+    Redis server, addressed by the key of the cache manager and the name
+    of the file. It is selected by `TRITON_REMOTE_CACHE_BACKEND`, of the
+    form `module:class`, and constructed without arguments.
+    """
+
+    @abstractmethod
+    def get(self, key: str, filename: str) -> Optional[bytes]:
+        pass
+
+    @abstractmethod
+    def put(self, key: str, filename: str, data: bytes):
+        pass
+
+
+class RemoteCacheManager(CacheManager):
+    """
+    Cache manager that writes files through to a `RemoteCacheBackend`, and
+    fetches the files missing from the local cache directory from there.
+    Groups are fetched as a whole, so the binaries and metadata of a kernel
+    compiled on another host are either all available or recompiled.
+    """
+
+    def __init__(self, key, backend=None):
+        self.key = key
+        self.local = FileCacheManager(key)
+        self.backend = _remote_backend() if backend is None else backend
+
+    def _fetch(self, filename) -> Optional[str]:
+        data = self.backend.get(self.key, filename)
+        if data is None:
+            return None
+        return self.local.put(data, filename)
+
+    def has_file(self, filename) -> bool:
+        return self.get_file(filename) is not None
+
+    def compile_lock_path(self) -> Optional[str]:
+        return self.local.compile_lock_path()
+
+    def evict(self, filename):
+        self.local.evict(filename)
+
+    def get_file(self, filename) -> Optional[str]:
+        path = self.local.get_file(filename)
+        if path is None and self.local.cache_dir:
+            path = self._fetch(filename)
+        return path
+
+    def get_group(self, filename: str) -> Optional[Dict[str, str]]:
+        group = self.local.get_group(filename)
+        if group is not None or not self.local.cache_dir:
+            return group
+        data = self.backend.get(self.key, f"__grp__{filename}")
+        if data is None:
+            return None
+        child_paths = json.loads(data).get("child_paths", None)
+        if child_paths is None:
+            return None
+        for c in child_paths:
+            if self.local.get_file(c) is None and self._fetch(c) is None:
+                return None
+        # the group is written last so that it is only found complete
+        self.local.put(data, f"__grp__{filename}")
+        return self.local.get_group(filename)
+
+    def put_group(self, filename: str, group: Dict[str, str]):
+        if not self.local.cache_dir:
+            return
+        grp_contents = json.dumps({"child_paths": sorted(list(group.keys()))})
+        return self.put(grp_contents, f"__grp__{filename}", binary=False)
+
+    def put(self, data, filename, binary=True) -> str:
+        path = self.local.put(data, filename, binary)
+        if path is not None:
+            self.backend.put(self.key, filename, data if isinstance(data, bytes) else str(data).encode("utf-8"))
+        return path
+
+
+__remote_backend = None
+
+
+def _remote_backend() -> RemoteCacheBackend:
+    global __remote_backend
+    if __remote_backend is None:
+        import importlib
+        module_path, clz_nme = os.environ["TRITON_REMOTE_CACHE_BACKEND"].split(":")
+        module = importlib.import_module(module_path)
+        __remote_backend = getattr(module, clz_nme)()
+    return __remote_backend
+
+
+class TuningDatabase:
+    """
+    Persistent store of the configs picked by the autotuner, so that they
+    survive the process. Entries are keyed by the hash of the kernel, the
+    values of its autotuning key, the name of the device and the version of
+    Triton, and hold the fields of the picked `triton.Config` but its
+    pre_hook. The database is a JSON file, `tuning.json` in the cache
+    directory by default, or the path in `TRITON_TUNING_DB`. It is disabled
+    when the path is empty.
+    """
+
+    def __init__(self, path: Optional[str] = None):
+        if path is None:
+            path = os.environ.get('TRITON_TUNING_DB')
+        if path is None:
+            cache_dir = os.environ.get('TRITON_CACHE_DIR', default_cache_dir())
+            path = os.path.join(cache_dir, "tuning.json") if cache_dir else ""
+        self.path = path
+        self.lock_path = path + ".lock" if path else None
+
+    @staticmethod
+    def make_key(kernel_hash: str, key_values, device_name: str) -> str:
+        import triton
+        return json.dumps([kernel_hash, [str(v) for v in key_values], device_name, triton.__version__])
+
+    def _read(self, path) -> Dict[str, Dict]:
+        if not path or not os.path.exists(path):
+            return {}
+        with open(path) as f:
+            return json.load(f)
+
+    def _write(self, entries: Dict[str, Dict]):
+        os.makedirs(os.path.dirname(os.path.abspath(self.path)), exist_ok=True)
+        # use tempfile to be robust against program interruptions
+        with open(self.path + ".tmp", "w") as f:
+            json.dump(entries, f, indent=1, sort_keys=True)
+        os.replace(self.path + ".tmp", self.path)
+
+    def get(self, key: str) -> Optional[Dict]:
+        if not self.path:
+            return None
+        with FileLock(self.lock_path):
+            return self._read(self.path).get(key)
+
+    def put(self, key: str, entry: Dict):
+        if not self.path:
+            return
+        with FileLock(self.lock_path):
+            entries = self._read(self.path)
+            entries[key] = entry
+            self._write(entries)
+
+    def export_entries(self, path: str):
+        """Writes all the entries of the database to the JSON file `path`."""
+        entries = {}
+        if self.path:
+            with FileLock(self.lock_path):
+                entries = self._read(self.path)
+        with open(path, "w") as f:
+            json.dump(entries, f, indent=1, sort_keys=True)
+
+    def import_entries(self, path: str):
+        """Adds the entries exported to `path`, which win over existing ones."""
+        assert self.path, "the tuning database is disabled"
+        imported = self._read(path)
+        with FileLock(self.lock_path):
+            entries = self._read(self.path)
+            entries.update(imported)
+            self._write(entries)
+
+
 __cache_cls = FileCacheManager
 __cache_cls_nme = "DEFAULT"
 
@@ -116,6 +393,10 @@ def get_cache_manager(key) -> CacheManager:
     global __cache_cls
     global __cache_cls_nme
 
+    # kernels are shared through a remote store when one is configured
+    if user_cache_manager is None and os.environ.get("TRITON_REMOTE_CACHE_BACKEND"):
+        return RemoteCacheManager(key)
+
     if user_cache_manager is not None and user_cache_manager != __cache_cls_nme:
         import importlib
         module_path, clz_nme = user_cache_manager.split(":")
@@ -51,7 +51,12 @@ class CudaUtils(object):
         mod = importlib.util.module_from_spec(spec)
         spec.loader.exec_module(mod)
         self.load_binary = mod.load_binary
+        self.unload_binary = mod.unload_binary
         self.get_device_properties = mod.get_device_properties
+        self.graph_create = mod.graph_create
+        self.graph_instantiate = mod.graph_instantiate
+        self.graph_launch = mod.graph_launch
+        self.graph_destroy = mod.graph_destroy
 
 
 class CudaDriver(DriverBase):
@@ -100,6 +105,7 @@ class HIPUtils(object):
         mod = importlib.util.module_from_spec(spec)
         spec.loader.exec_module(mod)
         self.load_binary = mod.load_binary
+        self.unload_binary = mod.unload_binary
         self.get_device_properties = mod.get_device_properties
 
 
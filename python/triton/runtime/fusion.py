@@ -0,0 +1,57 @@
+from .jit import JITFunction, get_cuda_stream
+
+
+class FusedKernel:
+    """
+    Runs independent kernels, each too small to fill the device, side by side
+    in a single launch.
+
+    Each call takes `(fn, grid, args)` launches of `triton.jit` functions, with
+    their grid of a single dimension and all their arguments in the order of
+    `fn`, constexprs included, as `fn[grid](*args)` would. It launches one
+    kernel with `num_warps` warps running the programs of each launch in turn
+    along axis 0, compiled by `compile_fused` the first time the types,
+    specializations and constexprs of the launches are seen.
+    """
+
+    def __init__(self, num_warps=4, num_stages=3, name="fused_kernel"):
+        self.num_warps = num_warps
+        self.num_stages = num_stages
+        self.name = name
+        # binary of each key of the fused launches
+        self.cache = dict()
+
+    @staticmethod
+    def _specialize(fn, args):
+        # the signature, constants and instance descriptor fn is compiled for,
+        # as in the launcher of JITFunction
+        if not isinstance(fn, JITFunction):
+            raise TypeError(f"only triton.jit functions can be fused, got {fn}")
+        config = fn._get_config(*args)
+        constants = {i: arg for i, arg in enumerate(args) if i in fn.constexprs}
+        constants.update({i: None for i, arg in enumerate(args) if arg is None})
+        constants.update({i: 1 for i in config.equal_to_1})
+        signature = {i: fn._type_of(fn._key_of(arg)) for i, arg in enumerate(args) if i not in fn.constexprs}
+        return signature, constants, config
+
+    def __call__(self, *launches, stream=None):
+        from ..compiler import compile_fused
+        kernels, key, programs, args = [], [], [], []
+        for fn, grid, fn_args in launches:
+            grid = (grid,) if isinstance(grid, int) else tuple(grid)
+            if any(dim != 1 for dim in grid[1:]):
+                raise ValueError(f"fused launches run grids of a single dimension, got {grid} for {fn.__name__}")
+            signature, constants, config = self._specialize(fn, fn_args)
+            kernels.append((fn, signature, constants, config))
+            key.append((fn.cache_key, tuple(signature.items()), tuple(constants.items()), config))
+            programs.append(grid[0])
+            args.extend(arg for i, arg in enumerate(fn_args) if i not in constants)
+        key = tuple(key)
+        bin = self.cache.get(key)
+        if bin is None:
+            bin = compile_fused(kernels, name=self.name, num_warps=self.num_warps, num_stages=self.num_stages)
+            self.cache[key] = bin
+        if stream is None:
+            stream = get_cuda_stream()
+        bin[(sum(programs), 1, 1)](*args, *programs, stream=stream)
+        return bin
@@ -0,0 +1,53 @@
+from .driver import driver
+from .jit import get_cuda_stream, get_current_device
+
+
+class KernelGraph:
+    """
+    Sequence of kernel launches of fixed grids, replayed with a single launch
+    of a CUDA graph.
+
+    Launches are added in order by `JITFunction.add_to_graph`, each running
+    after the previous one, and run by `launch`. The arguments of a launch
+    can be changed by `JITFunction.update_graph` between two replays without
+    instantiating the graph again, as long as they select the same binary.
+    The graph does not keep the tensors it is launched on alive.
+    """
+
+    def __init__(self, device=None):
+        self.device = get_current_device() if device is None else device
+        self.graph = driver.utils.graph_create()
+        self.exec = 0
+        # binary, grid, launch options and node handle of each launch
+        self.nodes = []
+
+    def add(self, bin, grid, options, args):
+        if self.exec:
+            raise RuntimeError("kernels cannot be added to a graph once launched or updated")
+        dependency = self.nodes[-1][3] if self.nodes else 0
+        node = bin.graph_node(self.graph, 0, dependency, grid, args)
+        self.nodes.append((bin, grid, options, node))
+        return len(self.nodes) - 1
+
+    def update(self, index, bin, args):
+        node_bin, grid, _, node = self.nodes[index]
+        if bin is not node_bin:
+            raise ValueError(f"arguments of node {index} require a different binary than the one it launches")
+        self.instantiate()
+        bin.graph_node(self.graph, self.exec, node, grid, args)
+
+    def instantiate(self):
+        if not self.exec:
+            self.exec = driver.utils.graph_instantiate(self.graph)
+
+    def launch(self, stream=None):
+        self.instantiate()
+        if stream is None:
+            stream = get_cuda_stream(self.device)
+        driver.utils.graph_launch(self.exec, stream)
+
+    def __len__(self):
+        return len(self.nodes)
+
+    def __del__(self):
+        driver.utils.graph_destroy(self.graph, self.exec)
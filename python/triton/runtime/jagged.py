@@ -0,0 +1,51 @@
+class JaggedGrid:
+    """
+    The grid of a kernel over the tiles of a jagged batch: variable-length
+    sequences packed one after the other without padding, whose starts are
+    given by `offsets`, with the total number of tokens last, like the
+    `cu_seqlens` of varlen attention.
+
+    Each sequence is split into tiles of `block` tokens, the last of which may
+    be partial, and program `pid` of axis 0 is launched for tile `pid` of the
+    batch, so that the grid is sized to the actual number of tokens rather
+    than to the longest sequence. The other axes of the grid are `dims`.
+
+    The kernel is passed the int32 tables `tile_seqs`, `tile_starts` and
+    `tile_ends` of the tiles, and loads the sequence and the bounds of its
+    tile from them:
+
+        start = tl.load(tile_starts + tl.program_id(0))
+        end = tl.load(tile_ends + tl.program_id(0))
+        offs = start + tl.arange(0, BLOCK)
+        x = tl.load(X + offs, mask=offs < end)
+
+    The tables are computed on the device of `offsets`, once for all the
+    launches over the batch.
+    """
+
+    def __init__(self, offsets, block, *dims):
+        self.offsets = offsets
+        self.block = block
+        self.dims = dims
+        self.num_seqs = offsets.numel() - 1
+        self.tile_seqs, self.tile_starts, self.tile_ends = self._tables()
+        self.num_tiles = self.tile_seqs.numel()
+
+    def _tables(self):
+        import torch
+        block = self.block
+        offsets = self.offsets.to(torch.int64)
+        starts, ends = offsets[:-1], offsets[1:]
+        tiles = (ends - starts + block - 1) // block
+        seqs = torch.arange(self.num_seqs, device=offsets.device)
+        tile_seqs = torch.repeat_interleave(seqs, tiles)
+        # the index of each tile in its sequence
+        first_tiles = torch.cumsum(tiles, 0) - tiles
+        tile_ids = torch.arange(tile_seqs.numel(), device=offsets.device)
+        tile_ids -= first_tiles[tile_seqs]
+        tile_starts = starts[tile_seqs] + tile_ids * block
+        tile_ends = torch.minimum(tile_starts + block, ends[tile_seqs])
+        return tuple(t.to(torch.int32) for t in (tile_seqs, tile_starts, tile_ends))
+
+    def __call__(self, meta):
+        return (self.num_tiles, *self.dims)
@@ -4,7 +4,9 @@ import ast
 import functools
 import hashlib
 import inspect
+import json
 import os
+import shutil
 import subprocess
 import textwrap
 from collections import defaultdict, namedtuple
@@ -13,6 +15,9 @@ from typing import Callable, Generic, Iterable, Optional, TypeVar, Union, cast,
 import torch
 
 import triton
+import triton._C.libtriton.triton as _triton
+
+from .cache import default_cache_dir
 
 
 def get_cuda_stream(idx=None):
@@ -41,6 +46,13 @@ def get_device_capability(idx):
     return torch.cuda.get_device_capability(idx)
 
 
+def _profile_args(profile, bin, grid_0, grid_1, grid_2, device):
+    # the buffer that a profiled kernel records into, as its last argument
+    if profile is None:
+        return ()
+    return (profile.allocate(bin, (grid_0, grid_1, grid_2), device),)
+
+
 T = TypeVar('T')
 
 # -----------------------------------------------------------------------------
@@ -80,12 +92,7 @@ class DependenciesFinder(ast.NodeVisitor):
         if func.__module__ and func.__module__.startswith('triton.'):
             return
         assert isinstance(func, JITFunction), f"Function \"{func.__name__}\" is being called from a Triton function but is not a Triton function itself. Decorate it with @triton.jit to fix this"
-        if func.hash is None:
-            tree = ast.parse(func.src)
-            finder = DependenciesFinder(func.__globals__, func.src)
-            finder.visit(tree)
-            func.hash = finder.ret
-        self.ret = (self.ret + func.hash).encode("utf-8")
+        self.ret = (self.ret + func.dependencies_hash).encode("utf-8")
         self.ret = hashlib.md5(self.ret).hexdigest()
 
 # -----------------------------------------------------------------------------
@@ -93,32 +100,85 @@ class DependenciesFinder(ast.NodeVisitor):
 # -----------------------------------------------------------------------------
 
 
+def _md5_of_file(path):
+    with open(path, "rb") as f:
+        return hashlib.md5(f.read()).hexdigest()
+
+
+def _path_to_ptxas():
+    # the ptxas the compiler picks, see `path_to_ptxas`, or the one on PATH
+    base_dir = os.path.join(os.path.dirname(__file__), os.pardir)
+    for ptxas in [os.environ.get("TRITON_PTXAS_PATH", ""),
+                  os.path.join(base_dir, "third_party", "cuda", "bin", "ptxas")]:
+        if os.path.isfile(ptxas):
+            return ptxas
+    return shutil.which("ptxas")
+
+
+@functools.lru_cache()
+def ptxas_version_key():
+    """
+    Returns the hash of the output of `ptxas --version`, or an empty string
+    without ptxas. It is kept in `ptxas_version.json` in the cache directory
+    by path, modification time and size of the binary, so that ptxas only
+    runs when it changes.
+    """
+    ptxas = _path_to_ptxas()
+    if ptxas is None:
+        return ''
+    try:
+        stat = os.stat(ptxas)
+    except OSError:
+        return ''
+    key = f"{os.path.realpath(ptxas)}:{stat.st_mtime_ns}:{stat.st_size}"
+    cache_dir = os.environ.get('TRITON_CACHE_DIR', default_cache_dir())
+    path = os.path.join(cache_dir, "ptxas_version.json") if cache_dir else ""
+    versions = {}
+    if path and os.path.exists(path):
+        try:
+            with open(path) as f:
+                versions = json.load(f)
+        except (OSError, ValueError):
+            versions = {}
+    if key in versions:
+        return versions[key]
+    try:
+        version = hashlib.md5(subprocess.check_output([ptxas, "--version"])).hexdigest()
+    except Exception:
+        return ''
+    if path:
+        versions[key] = version
+        try:
+            os.makedirs(cache_dir, exist_ok=True)
+            # use tempfile to be robust against program interruptions
+            tmp_path = f"{path}.tmp.pid_{os.getpid()}"
+            with open(tmp_path, "w") as f:
+                json.dump(versions, f, indent=1, sort_keys=True)
+            os.replace(tmp_path, path)
+        except OSError:
+            pass
+    return version
+
+
 @functools.lru_cache()
 def version_key():
     import pkgutil
     contents = []
     # frontend
-    with open(__file__, "rb") as f:
-        contents += [hashlib.md5(f.read()).hexdigest()]
+    contents += [_md5_of_file(__file__)]
     # compiler
     compiler_path = os.path.join(*triton.__path__, 'compiler')
     for lib in pkgutil.iter_modules([compiler_path]):
-        with open(lib.module_finder.find_spec(lib.name).origin, "rb") as f:
-            contents += [hashlib.md5(f.read()).hexdigest()]
-    # backend
-    with open(triton._C.libtriton.__file__, "rb") as f:
-        contents += [hashlib.md5(f.read()).hexdigest()]
+        contents += [_md5_of_file(lib.module_finder.find_spec(lib.name).origin)]
+    # backend, whose key is the hash of its sources computed by the build,
+    # rather than the hash of the whole shared object
+    build_key = getattr(triton._C.libtriton, "build_key", "")
+    contents += [build_key or _md5_of_file(triton._C.libtriton.__file__)]
     # language
     language_path = os.path.join(*triton.__path__, 'language')
     for lib in pkgutil.iter_modules([language_path]):
-        with open(lib.module_finder.find_spec(lib.name).origin, "rb") as f:
-            contents += [hashlib.md5(f.read()).hexdigest()]
-    # ptxas version
-    try:
-        ptxas_version = hashlib.md5(subprocess.check_output(["ptxas", "--version"])).hexdigest()
-    except Exception:
-        ptxas_version = ''
-    return '-'.join(triton.__version__) + '-' + ptxas_version + '-' + '-'.join(contents)
+        contents += [_md5_of_file(lib.module_finder.find_spec(lib.name).origin)]
+    return '-'.join(triton.__version__) + '-' + ptxas_version_key() + '-' + '-'.join(contents)
 
 
 class KernelInterface(Generic[T]):
@@ -217,7 +277,15 @@ class JITFunction(KernelInterface[T]):
         constants = dict(zip(self.constexprs, constexpr_key))
         return constants
 
-    def _call_hook(self, key, signature, device, constants, num_warps, num_stages, extern_libs, configs):
+    def _binary_of_same_arch(self, device, key):
+        # the binary compiled for key on another device of the same
+        # architecture as device, if any
+        for other, bins in self.cache.items():
+            if other != device and key in bins and get_device_capability(other) == get_device_capability(device):
+                return bins[key]
+        return None
+
+    def _call_hook(self, key, signature, device, constants, num_warps, num_stages, extern_libs, configs, split_k=1):
         if JITFunction.cache_hook is None:
             return False
         name = self.fn.__name__
@@ -234,7 +302,7 @@ class JITFunction(KernelInterface[T]):
 
         kwargs = dict(signature=signature, device=device, constants=constants,
                       num_warps=num_warps, num_stages=num_stages, extern_libs=extern_libs,
-                      configs=configs)
+                      configs=configs, split_k=split_k)
 
         return JITFunction.cache_hook(key=key, repr=repr, fn=LegacyCompiler(module, name), compile={"key": key, **kwargs}, is_manual_warmup=False, already_compiled=False)
 
@@ -279,15 +347,11 @@ class JITFunction(KernelInterface[T]):
 
         spec_keys = ', '.join(specializations)
         grid_args = ','.join([f'"{arg}": {arg}' for arg in self.arg_names])
+        call_args = ''.join(f'{arg}, ' for arg in self.arg_names)
+        launch_args = ''.join(f'{arg}, ' for arg in regular_args)
 
         src = f"""
-def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stages=3, extern_libs=None, stream=None, warmup=False, device=None):
-    sig_key =  {sig_keys},
-    constexpr_key = {f'{constexpr_keys},' if len(constexpr_keys) > 0 else ()}
-    spec_key = {f'{spec_keys},' if len(spec_keys) > 0 else ()}
-    key = (version_key, sig_key, constexpr_key, spec_key, num_warps, num_stages, self.debug)
-    if not extern_libs is None:
-      key = (key, tuple(extern_libs.items()))
+def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stages=3, split_k=1, num_ctas=1, extern_libs=None, stream=None, warmup=False, device=None, estimate=False, profile=None):
     assert num_warps > 0 and (num_warps & (num_warps - 1)) == 0, "num_warps must be a power of 2"
     if callable(grid):
         grid = grid({{{grid_args}}})
@@ -298,12 +362,36 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
     if device is None:
         device = get_current_device()
         set_current_device(device)
-    if stream is None and not warmup:
+    if stream is None and not warmup and not estimate:
       stream = get_cuda_stream(device)
+    # binaries launched before are looked up and launched natively, except
+    # those of clusters, which the native dispatcher does not key on
+    fast_path = not warmup and not estimate and extern_libs is None and profile is None and num_ctas == 1
+    if fast_path:
+      bin = dispatcher.launch(({call_args}), grid_0, grid_1, grid_2, num_warps, num_stages, split_k, self.debug, device, stream, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook)
+      if bin is not None:
+        return bin
+    # the key of the binary is only built for the launches the native
+    # dispatcher does not know
+    sig_key =  {sig_keys},
+    constexpr_key = {f'{constexpr_keys},' if len(constexpr_keys) > 0 else ()}
+    spec_key = {f'{spec_keys},' if len(spec_keys) > 0 else ()}
+    key = (version_key, sig_key, constexpr_key, spec_key, num_warps, num_stages, split_k, self.debug)
+    if not extern_libs is None:
+      key = (key, tuple(extern_libs.items()))
+    if profile is not None:
+      key = (key, profile.key)
+    if num_ctas > 1:
+      key = (key, num_ctas)
     try:
       bin = cache[device][key]
+      # compiled already, nothing to estimate
+      if estimate:
+          return None
       if not warmup:
-          bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, bin, {args})
+          bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, bin, {launch_args}*_profile_args(profile, bin, grid_0, grid_1, grid_2, device))
+      if fast_path:
+          dispatcher.add(({call_args}), num_warps, num_stages, split_k, self.debug, device, key, bin)
       return bin
     # kernel not cached -- compile
     except KeyError:
@@ -320,19 +408,28 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
       for i, arg in constants.items():
         if callable(arg):
           raise TypeError(f"Callable constexpr at index {{i}} is not supported")
-      if not self._call_hook(key, signature, device, constants, num_warps, num_stages, extern_libs, configs):
-        bin = triton.compile(self, signature=signature, device=device, constants=constants, num_warps=num_warps, num_stages=num_stages, extern_libs=extern_libs, configs=configs, debug=self.debug)
+      if estimate:
+        return triton.compiler.estimate_resources(self, signature=signature, constants=constants, num_warps=num_warps, num_stages=num_stages, split_k=split_k, configs=configs, debug=self.debug)
+      # binaries are loaded on each device they are launched on, so the
+      # devices of the same architecture share them
+      bin = self._binary_of_same_arch(device, key)
+      if bin is None and not self._call_hook(key, signature, device, constants, num_warps, num_stages, extern_libs, configs, split_k):
+        bin = triton.compile(self, signature=signature, device=device, constants=constants, num_warps=num_warps, num_stages=num_stages, split_k=split_k, num_ctas=num_ctas, extern_libs=extern_libs, configs=configs, debug=self.debug,
+                             profile=None if profile is None else profile.options)
+      if bin is not None:
         if not warmup:
-            bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, bin, *args)
+            bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, bin, *args, *_profile_args(profile, bin, grid_0, grid_1, grid_2, device))
         self.cache[device][key] = bin
+        if fast_path:
+            dispatcher.add(({call_args}), num_warps, num_stages, split_k, self.debug, device, key, bin)
         return bin
       return None
 """
         scope = {"version_key": version_key(), "get_cuda_stream": get_cuda_stream,
                  "self": self, "_spec_of": self._spec_of, "_key_of": self._key_of,
-                 "cache": self.cache, "triton": triton,
+                 "cache": self.cache, "triton": triton, "dispatcher": self.dispatcher,
                  "get_current_device": get_current_device,
-                 "set_current_device": set_current_device}
+                 "set_current_device": set_current_device, "_profile_args": _profile_args}
         exec(src, scope)
         return scope[self.fn.__name__]
 
@@ -365,7 +462,8 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
         from triton.language.core import \
             constexpr  # import here rather than at module level due to circular import tangle
         self.constexprs = [index for index, ty in self.annotations.items() if isinstance(ty, type) and issubclass(ty, constexpr)]
-        # launcher
+        # launcher, and its native fast path for the binaries it launched
+        self.dispatcher = _triton.runtime.dispatcher(self.cache, self.constexprs)
         self.run = self._make_launcher()
         # re-use docs of wrapped function
         self.__doc__ = fn.__doc__
@@ -374,17 +472,63 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
         self.__module__ = fn.__module__
 
     @property
-    def cache_key(self):
-        # TODO : hash should be attribute of `self`
-        if self.hash is None:
+    def dependencies_hash(self):
+        # hash of the source of the function and of the functions it calls,
+        # walked once per function object and reused by its callers
+        if self._dependencies_hash is None:
             dependencies_finder = DependenciesFinder(globals=self.__globals__, src=self.src)
             dependencies_finder.visit(self.parse())
-            self.hash = dependencies_finder.ret + version_key()
+            self._dependencies_hash = dependencies_finder.ret
+        return self._dependencies_hash
+
+    @property
+    def cache_key(self):
+        if self.hash is None:
+            self.hash = self.dependencies_hash + version_key()
         return self.hash
 
     def warmup(self, *args, **kwargs):
         return self.run(*map(MockTensor.wrap_dtype, args), **kwargs, warmup=True)
 
+    def _bind_graph_args(self, args, kwargs):
+        # arguments of the kernel passed positionally or by name, and the
+        # launch options in `kwargs`
+        args = list(args) + [kwargs.pop(name) for name in self.arg_names[len(args):] if name in kwargs]
+        if len(args) != len(self.arg_names):
+            raise TypeError(f"{self.fn.__name__} takes {len(self.arg_names)} arguments but {len(args)} were given")
+        return args, kwargs
+
+    def _graph_binary(self, graph, args, grid, options):
+        bin = self.run(*args, grid=grid, warmup=True, device=graph.device, **options)
+        if bin is None:
+            raise RuntimeError(f"{self.fn.__name__} was not compiled for launches from a graph")
+        return bin, [arg for i, arg in enumerate(args) if i not in self.constexprs]
+
+    def add_to_graph(self, graph, grid, *args, **kwargs):
+        """
+        Adds the launch of this kernel on `grid` to the `triton.runtime.KernelGraph`
+        `graph`, after the launches added before, and returns the index of its node.
+        Takes the arguments and launch options of `fn[grid](*args, **kwargs)`.
+        """
+        args, options = self._bind_graph_args(args, kwargs)
+        if callable(grid):
+            grid = grid(dict(zip(self.arg_names, args)))
+        grid = tuple(grid) + (1,) * (3 - len(grid))
+        bin, kernel_args = self._graph_binary(graph, args, grid, options)
+        return graph.add(bin, grid, options, kernel_args)
+
+    def update_graph(self, graph, node, *args, **kwargs):
+        """
+        Replaces the arguments of the launch of node `node` of `graph`, keeping
+        its grid and launch options.
+        """
+        args, options = self._bind_graph_args(args, kwargs)
+        if options:
+            raise TypeError(f"launch options of a graph node cannot be updated: {', '.join(options)}")
+        _, grid, options, _ = graph.nodes[node]
+        bin, kernel_args = self._graph_binary(graph, args, grid, options)
+        graph.update(node, bin, kernel_args)
+
     # we do not parse `src` in the constructor because
     # the user might want to monkey-patch self.src dynamically.
     # Our unit tests do this, for example.
@@ -408,6 +552,10 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
         #   to be reinitialized
         if name == 'src':
             self.hash = None
+        # - resetting the hash also drops the memoized
+        #   hash of the dependencies
+        if name == 'hash' and value is None:
+            self._dependencies_hash = None
 
     def __repr__(self):
         return f"JITFunction({self.module}:{self.fn.__name__})"
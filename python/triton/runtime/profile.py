@@ -0,0 +1,88 @@
+from collections import defaultdict, namedtuple
+
+# a timestamp written by warp `warp` of program `program`, the linear id of
+# the program x first, when it entered (is_start) or left `region`
+Record = namedtuple("Record", ["launch", "program", "warp", "region", "is_start", "time"])
+
+# the time from `start` to `end` that a warp spent in a region
+Interval = namedtuple("Interval", ["launch", "program", "warp", "start", "end"])
+
+
+class RegionProfile:
+    """
+    Collects the times that the warps of kernels launched with `profile=`
+    spend in their regions: the scopes between `tl.profile_start` and
+    `tl.profile_end`, and, if requested, each iteration of their loops,
+    each of their dots and each of their loads until the first use of the
+    loaded values.
+
+    The first thread of each warp reads the `%clock64` of its SM, in cycles,
+    or the `%globaltimer` of the device, in nanoseconds, at the start and
+    end of each region, and writes it into the `capacity` records of the
+    warp. The records past it are dropped.
+    """
+
+    def __init__(self, capacity=256, loops=False, dots=False, loads=False, global_timer=False):
+        self.options = {"capacity": capacity, "loops": loops, "dots": dots, "loads": loads,
+                        "global_timer": global_timer}
+        # binary, grid and buffer of each launch
+        self.launches = []
+
+    @property
+    def key(self):
+        return tuple(sorted(self.options.items()))
+
+    def allocate(self, bin, grid, device):
+        import torch
+        programs = grid[0] * grid[1] * grid[2] * bin.metadata.get("split_k", 1)
+        words = programs * bin.num_warps * self.options["capacity"] * 2
+        buffer = torch.zeros(words, dtype=torch.int64, device=device)
+        self.launches.append((bin, grid, buffer))
+        return buffer
+
+    def clear(self):
+        self.launches = []
+
+    def records(self):
+        """
+        Returns the records of the launches so far, in the order of their
+        launch, program, warp and time.
+        """
+        import torch
+        torch.cuda.synchronize()
+        capacity = self.options["capacity"]
+        records = []
+        for launch, (bin, _, buffer) in enumerate(self.launches):
+            regions = bin.metadata["profile"]["regions"]
+            words = buffer.view(-1, 2)
+            slots = torch.nonzero(words[:, 0]).flatten()
+            for slot, (header, time) in zip(slots.tolist(), words[slots].tolist()):
+                program, warp = divmod(slot // capacity, bin.num_warps)
+                records.append(Record(launch, program, warp, regions[(header >> 1) - 1], bool(header & 1), time))
+        return records
+
+    def timeline(self):
+        """
+        Returns the intervals each warp spent in each region, by region. Each
+        end is matched with the last start of the region in the warp.
+        """
+        timeline = defaultdict(list)
+        starts = defaultdict(list)
+        for r in self.records():
+            warp = (r.launch, r.program, r.warp, r.region)
+            if r.is_start:
+                starts[warp].append(r.time)
+            elif starts[warp]:
+                timeline[r.region].append(Interval(r.launch, r.program, r.warp, starts[warp].pop(), r.time))
+        return dict(timeline)
+
+    def summary(self):
+        """
+        Returns the number of intervals of each region, and their total and
+        mean duration, in the unit of the timer.
+        """
+        summary = dict()
+        for region, intervals in self.timeline().items():
+            total = sum(i.end - i.start for i in intervals)
+            summary[region] = {"count": len(intervals), "total": total, "mean": total / len(intervals)}
+        return summary
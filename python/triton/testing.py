@@ -1,4 +1,5 @@
 import functools
+import math
 import os
 import subprocess
 import sys
@@ -16,11 +17,170 @@ def nvsmi(attrs):
     return ret
 
 
+class BenchmarkResult:
+    """
+    The timings, in ms, of the repetitions of a benchmark, as returned by
+    :code:`do_bench(..., return_mode="all")`. :code:`samples` holds all of them
+    and :code:`kept` the ones left once outliers are rejected, which the
+    statistics are computed on.
+    """
+
+    # the two-sided 95% quantile of the normal distribution
+    _Z = 1.96
+
+    def __init__(self, samples, reject_outliers=False):
+        self.samples = [float(t) for t in samples]
+        self.kept = _reject_outliers(self.samples) if reject_outliers else list(self.samples)
+        self._sorted = sorted(self.kept)
+
+    def quantile(self, q):
+        """
+        Returns the `q`-th quantile of the kept timings, interpolated linearly
+        between the closest ones like :code:`torch.quantile`.
+        """
+        pos = q * (len(self._sorted) - 1)
+        lo = int(math.floor(pos))
+        hi = int(math.ceil(pos))
+        if lo == hi or self._sorted[lo] == self._sorted[hi]:
+            return self._sorted[lo]
+        return self._sorted[lo] + (self._sorted[hi] - self._sorted[lo]) * (pos - lo)
+
+    @property
+    def percentiles(self):
+        return {p: self.quantile(p / 100) for p in (5, 20, 50, 80, 95)}
+
+    @property
+    def median(self):
+        return self.quantile(0.5)
+
+    @property
+    def mean(self):
+        return sum(self.kept) / len(self.kept)
+
+    @property
+    def std(self):
+        if len(self.kept) < 2:
+            return 0.
+        mean = self.mean
+        return math.sqrt(sum((t - mean)**2 for t in self.kept) / (len(self.kept) - 1))
+
+    @property
+    def min(self):
+        return self._sorted[0]
+
+    @property
+    def max(self):
+        return self._sorted[-1]
+
+    @property
+    def ci(self):
+        """
+        The 95% confidence interval of the median, bounded by the order
+        statistics that hold it whatever the distribution of the timings.
+        """
+        n = len(self._sorted)
+        half = self._Z * math.sqrt(n) / 2
+        lo = max(0, int(math.floor(n / 2 - half)))
+        hi = min(n - 1, int(math.ceil(n / 2 + half)))
+        return self._sorted[lo], self._sorted[hi]
+
+    @property
+    def rel_ci(self):
+        """The half-width of :code:`ci` relative to the median."""
+        lo, hi = self.ci
+        median = self.median
+        if lo == hi:
+            return 0.
+        if not math.isfinite(median) or median <= 0:
+            return float('inf')
+        return (hi - lo) / 2 / median
+
+    def significantly_faster(self, other):
+        """Whether the confidence intervals of the medians are disjoint, `self` being the faster."""
+        return self.ci[1] < other.ci[0]
+
+    def __repr__(self):
+        lo, hi = self.ci
+        return f"BenchmarkResult(median={self.median:.4f}, ci=({lo:.4f}, {hi:.4f}), " \
+               f"samples={len(self.samples)}, outliers={len(self.samples) - len(self.kept)})"
+
+
+def _reject_outliers(samples):
+    # Tukey's fences: the timings further than 1.5 interquartile ranges from
+    # the quartiles, e.g. the ones of iterations preempted by another process
+    if len(samples) < 4:
+        return list(samples)
+    quartiles = BenchmarkResult(samples)
+    q1, q3 = quartiles.quantile(0.25), quartiles.quantile(0.75)
+    iqr = q3 - q1
+    kept = [t for t in samples if q1 - 1.5 * iqr <= t <= q3 + 1.5 * iqr]
+    return kept or list(samples)
+
+
+def _clear_grads(grad_to_none):
+    # we don't want `fn` to accumulate gradient values
+    # if it contains a backward pass. So we clear the
+    # provided gradients
+    if grad_to_none is not None:
+        for x in grad_to_none:
+            x.grad = None
+
+
+def _event_times(fn, n, cache, grad_to_none):
+    import torch
+    start_event = [torch.cuda.Event(enable_timing=True) for i in range(n)]
+    end_event = [torch.cuda.Event(enable_timing=True) for i in range(n)]
+    for i in range(n):
+        _clear_grads(grad_to_none)
+        # we clear the L2 cache before each run
+        cache.zero_()
+        # record time of `fn`
+        start_event[i].record()
+        fn()
+        end_event[i].record()
+    # Record clocks
+    torch.cuda.synchronize()
+    return [s.elapsed_time(e) for s, e in zip(start_event, end_event)]
+
+
+def _kernel_times(fn, n, cache, grad_to_none):
+    # The time the kernels of each call of `fn` run on the device, as traced
+    # by CUPTI through the profiler of PyTorch, without the launch overheads
+    # and the gaps between kernels the events measure. The flush of the L2
+    # cache, the first kernel traced, delimits the calls.
+    import torch
+    from torch.autograd import DeviceType
+    from torch.profiler import ProfilerActivity, profile
+    with profile(activities=[ProfilerActivity.CUDA]) as prof:
+        for _ in range(n):
+            _clear_grads(grad_to_none)
+            cache.zero_()
+            fn()
+        torch.cuda.synchronize()
+    kernels = sorted((e for e in prof.events() if e.device_type == DeviceType.CUDA),
+                     key=lambda e: e.time_range.start)
+    if not kernels:
+        raise RuntimeError("no kernel was traced, CUPTI may be unavailable")
+    flush = kernels[0].name
+    times = []
+    for kernel in kernels:
+        if kernel.name == flush:
+            times.append(0.)
+        else:
+            times[-1] += kernel.time_range.elapsed_us() / 1e3
+    return times
+
+
 def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
              quantiles=None,
              fast_flush=True,
-             return_mode="mean"):
-    assert return_mode in ["min", "max", "mean", "median"]
+             return_mode="mean",
+             reject_outliers=False,
+             rel_ci=None,
+             max_rep=None,
+             lock_clocks=False,
+             kernel_only=False):
+    assert return_mode in ["min", "max", "mean", "median", "all"]
     import torch
     """
     Benchmark the runtime of the provided function. By default, return the median runtime of :code:`fn` along with
@@ -38,7 +198,24 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
     :type quantiles: list[float]
     :param fast_flush: Use faster kernel to flush L2 between measurements
     :type fast_flush: bool
+    :param return_mode: The statistic to return, or "all" for a :code:`BenchmarkResult` of every timing
+    :type return_mode: str
+    :param reject_outliers: Ignore the timings outside of Tukey's fences
+    :type reject_outliers: bool
+    :param rel_ci: Repeat until the 95% confidence interval of the median is this narrow relative to it
+    :type rel_ci: float, optional
+    :param max_rep: The time (in ms) after which to stop repeating whatever the confidence interval, 5 * rep by default
+    :type max_rep: int, optional
+    :param lock_clocks: Lock the clocks of the GPU with :code:`set_gpu_clock`, which requires root
+    :type lock_clocks: bool
+    :param kernel_only: Time the kernels only, with CUPTI
+    :type kernel_only: bool
     """
+    if lock_clocks:
+        with set_gpu_clock():
+            return do_bench(fn, warmup=warmup, rep=rep, grad_to_none=grad_to_none, quantiles=quantiles,
+                            fast_flush=fast_flush, return_mode=return_mode, reject_outliers=reject_outliers,
+                            rel_ci=rel_ci, max_rep=max_rep, kernel_only=kernel_only)
 
     # Estimate the runtime of the function
     fn()
@@ -57,8 +234,6 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
     # We maintain a buffer of 256 MB that we clear
     # before each kernel call to make sure that the L2
     # doesn't contain any input data before the run
-    start_event = [torch.cuda.Event(enable_timing=True) for i in range(n_repeat)]
-    end_event = [torch.cuda.Event(enable_timing=True) for i in range(n_repeat)]
     if fast_flush:
         cache = torch.empty(int(256e6 // 4), dtype=torch.int, device='cuda')
     else:
@@ -66,29 +241,27 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
     # Warm-up
     for _ in range(n_warmup):
         fn()
-    # Benchmark
-    for i in range(n_repeat):
-        # we don't want `fn` to accumulate gradient values
-        # if it contains a backward pass. So we clear the
-        # provided gradients
-        if grad_to_none is not None:
-            for x in grad_to_none:
-                x.grad = None
-        # we clear the L2 cache before each run
-        cache.zero_()
-        # record time of `fn`
-        start_event[i].record()
-        fn()
-        end_event[i].record()
-    # Record clocks
-    torch.cuda.synchronize()
-    times = torch.tensor([s.elapsed_time(e) for s, e in zip(start_event, end_event)])
+    # Benchmark, in batches of `rep` ms until the median is known precisely
+    # enough or `max_rep` ms were spent
+    measure = _kernel_times if kernel_only else _event_times
+    times = measure(fn, n_repeat, cache, grad_to_none)
+    result = BenchmarkResult(times, reject_outliers)
+    if rel_ci is not None:
+        if max_rep is None:
+            max_rep = 5 * rep
+        elapsed = n_repeat * estimate_ms
+        while result.rel_ci > rel_ci and elapsed + n_repeat * estimate_ms <= max_rep:
+            times += measure(fn, n_repeat, cache, grad_to_none)
+            elapsed += n_repeat * estimate_ms
+            result = BenchmarkResult(times, reject_outliers)
+    if return_mode == "all":
+        return result
     if quantiles is not None:
-        ret = torch.quantile(times, torch.tensor(quantiles)).tolist()
+        ret = [result.quantile(q) for q in quantiles]
         if len(ret) == 1:
             ret = ret[0]
         return ret
-    return getattr(torch, return_mode)(times).item()
+    return getattr(torch, return_mode)(torch.tensor(result.kept)).item()
 
 
 def assert_close(x, y, atol=None, rtol=None, err_msg=''):
@@ -1,13 +1,341 @@
 import argparse
+import importlib.util
+import json
+import math
+import os
+import subprocess
 import sys
 
+import triton
 import triton._C.libtriton.triton as libtriton
 import triton.compiler.compiler as tc
+from triton.common.build import c_compiler, cuda_include_dir, libcuda_dirs
+from triton.compiler.make_launcher import ty_to_cpp
+
+
+def split_top_level(text, sep):
+    """
+    Splits `text` at the occurrences of `sep` outside of parentheses.
+    """
+    parts, depth, start = [], 0, 0
+    for i, c in enumerate(text):
+        depth += {'(': 1, ')': -1}.get(c, 0)
+        if c == sep and depth == 0:
+            parts.append(text[start:i])
+            start = i + 1
+    parts.append(text[start:])
+    return [part.strip() for part in parts]
+
+
+def parse_config(text, fn):
+    """
+    Parses a `--config` of the library target: `;`-separated `key=value`
+    fields giving the value of each constexpr of `fn`, its `num_warps` and
+    `num_stages`, the `,`-separated arguments it is specialized for as being
+    `divisible_by_16` or `equal_to_1`, its `grid` as up to three `,`-separated
+    C expressions of the arguments and constexprs, and an optional `when` C
+    condition on them that must also hold for the config to be launched.
+    """
+    config = {"constants": dict(), "num_warps": 4, "num_stages": 3, "divisible_by_16": [], "equal_to_1": [],
+              "grid": None, "when": None}
+    for field in split_top_level(text, ';'):
+        if not field:
+            continue
+        key, _, value = field.partition('=')
+        key, value = key.strip(), value.strip()
+        if key in ("num_warps", "num_stages"):
+            config[key] = int(value)
+        elif key in ("divisible_by_16", "equal_to_1"):
+            config[key] = [arg.strip() for arg in value.split(',') if arg.strip()]
+        elif key == "grid":
+            config[key] = split_top_level(value, ',')
+        elif key == "when":
+            config[key] = value
+        elif key in fn.arg_names and fn.arg_names.index(key) in fn.constexprs:
+            config["constants"][key] = eval(value, {}, {})
+        else:
+            raise ValueError(f"unknown field {key!r} in config {text!r}")
+    if config["grid"] is None or not 1 <= len(config["grid"]) <= 3:
+        raise ValueError(f"config {text!r} must have a grid of one to three dimensions")
+    missing = [fn.arg_names[i] for i in fn.constexprs if fn.arg_names[i] not in config["constants"]]
+    if missing:
+        raise ValueError(f"config {text!r} misses the constexprs {', '.join(missing)}")
+    for arg in config["divisible_by_16"] + config["equal_to_1"]:
+        if arg not in fn.arg_names or fn.arg_names.index(arg) in fn.constexprs:
+            raise ValueError(f"{arg!r} of config {text!r} is not an argument of {fn.__name__}")
+    return config
+
+
+def compile_config(fn, signature, config, sm):
+    """
+    Compiles `fn` for the runtime arguments typed by `signature`, by index,
+    and the specialization of `config`.
+    """
+    index = {name: i for i, name in enumerate(fn.arg_names)}
+    constants = {index[name]: value for name, value in config["constants"].items()}
+    descriptor = tc.instance_descriptor(divisible_by_16={index[arg] for arg in config["divisible_by_16"]},
+                                        equal_to_1={index[arg] for arg in config["equal_to_1"]})
+    constants.update({i: 1 for i in descriptor.equal_to_1})
+    bin = triton.compile(fn, signature=signature, constants=constants, num_warps=config["num_warps"],
+                         num_stages=config["num_stages"], configs=[descriptor], cc=sm)
+    if bin.metadata.get("tensormaps"):
+        raise NotImplementedError(f"{fn.__name__} uses tensor maps, which libraries do not create")
+    return bin
+
+
+# contexts whose modules a library holds at a time
+MAX_CONTEXTS = 16
+
+
+def c_constant(arg, value):
+    """
+    Returns the C declaration of the constexpr `arg` of value `value`, for
+    the grid and the `when` condition of its config to use.
+    """
+    if isinstance(value, bool):
+        return f"const int {arg} = {int(value)};"
+    if isinstance(value, int):
+        return f"const int64_t {arg} = {value}LL;"
+    if isinstance(value, float):
+        if not math.isfinite(value):
+            raise ValueError(f"constexpr {arg} = {value} has no C literal")
+        return f"const double {arg} = {value.hex()};"
+    if isinstance(value, str):
+        return f"const char *const {arg} = {json.dumps(value)};"
+    if value is None:
+        return f"const void *const {arg} = NULL;"
+    raise ValueError(f"constexpr {arg} of type {type(value).__name__} has no C type")
+
+
+def generate_library(name, fn, signature, configs, bins):
+    """
+    Returns the C header and source of a library embedding the cubins of the
+    configs of `fn`, and dispatching each launch to the first config the
+    arguments satisfy, without any compilation at runtime.
+    """
+    args = [(i, fn.arg_names[i], ty) for i, ty in signature.items()]
+    arg_decls = ', '.join(f"{ty_to_cpp(ty)} {arg}" for _, arg, ty in args)
+    header = f"""/* Generated by triton.tools.aot, do not edit. */
+#pragma once
+#include <cuda.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {{
+#endif
+
+/* Loads the cubins of the {len(bins)} configs of {fn.__name__} into the current
+   context; {name}() does it on its first launch in each context. The modules
+   of up to {MAX_CONTEXTS} contexts are held at a time. */
+CUresult {name}_load(void);
+/* Unloads the cubins of {name}_load() from the current context; call it before
+   destroying a context that {name}() launched in. */
+CUresult {name}_unload(void);
+/* Launches the first config of {fn.__name__} that its arguments satisfy on
+   `stream`, or returns CUDA_ERROR_NOT_FOUND if none does. */
+CUresult {name}(CUstream stream, {arg_decls});
+
+#ifdef __cplusplus
+}}
+#endif
+"""
+    cubins = []
+    variants = []
+    dispatch = []
+    for i, (config, bin) in enumerate(zip(configs, bins)):
+        cubin = bin.asm["cubin"]
+        data = ', '.join(f"0x{b:02x}" for b in cubin)
+        cubins.append(f"static const unsigned char {name}_cubin_{i}[{len(cubin)}] = {{ {data} }};")
+        variants.append(f'  {{ {name}_cubin_{i}, "{bin.metadata["name"]}", {bin.num_warps}, {bin.shared} }},')
+        # an argument passes the divisibility of its config when its address
+        # or value does, and is not passed when it is specialized to 1
+        conditions = [f"{arg} % 16 == 0" for arg in config["divisible_by_16"]]
+        conditions += [f"{arg} == 1" for arg in config["equal_to_1"]]
+        if config["when"]:
+            conditions.append(f"({config['when']})")
+        constants = ''.join(f"    {c_constant(arg, value)} (void){arg};\n"
+                            for arg, value in config["constants"].items())
+        params = ', '.join(f"&{arg}" for _, arg, _ in args if arg not in config["equal_to_1"]) or "NULL"
+        grid = config["grid"] + ["1"] * (3 - len(config["grid"]))
+        dispatch.append(f"""  if ({' && '.join(conditions) or '1'}) {{
+{constants}    void *params[] = {{ {params} }};
+    return {name}_launch({i}, stream, {', '.join(f'(unsigned)({dim})' for dim in grid)}, params);
+  }}""")
+    cubins = '\n'.join(cubins)
+    variants = '\n'.join(variants)
+    dispatch = '\n'.join(dispatch)
+    source = f"""/* Generated by triton.tools.aot, do not edit. */
+#include "{name}.h"
+#include <stddef.h>
+#include <string.h>
+
+{cubins}
+
+typedef struct {{
+  const unsigned char *cubin;
+  const char *kernel_name;
+  int num_warps;
+  int shared;
+}} {name}_variant_t;
+
+static const {name}_variant_t {name}_variants[{len(bins)}] = {{
+{variants}
+}};
+
+/* The modules and functions of the variants loaded into one context. */
+typedef struct {{
+  CUcontext context;
+  CUmodule modules[{len(bins)}];
+  CUfunction functions[{len(bins)}];
+}} {name}_context_t;
+
+static {name}_context_t {name}_contexts[{MAX_CONTEXTS}];
+
+static void {name}_unload_context({name}_context_t *c, CUresult *ret) {{
+  for (int i = 0; i < {len(bins)}; i++) {{
+    if (!c->modules[i])
+      continue;
+    CUresult err = cuModuleUnload(c->modules[i]);
+    if (*ret == CUDA_SUCCESS)
+      *ret = err;
+  }}
+  memset(c, 0, sizeof(*c));
+}}
+
+/* Sets *out to the modules of the current context, loading them if `load`,
+   or to NULL if they are not loaded. */
+static CUresult {name}_current(int load, {name}_context_t **out) {{
+  CUcontext context;
+  CUresult err = cuCtxGetCurrent(&context);
+  if (err != CUDA_SUCCESS)
+    return err;
+  if (!context)
+    return CUDA_ERROR_INVALID_CONTEXT;
+  {name}_context_t *free_slot = NULL;
+  for (int i = 0; i < {MAX_CONTEXTS}; i++) {{
+    if ({name}_contexts[i].context == context) {{
+      *out = &{name}_contexts[i];
+      return CUDA_SUCCESS;
+    }}
+    if (!{name}_contexts[i].context && !free_slot)
+      free_slot = &{name}_contexts[i];
+  }}
+  *out = NULL;
+  if (!load)
+    return CUDA_SUCCESS;
+  if (!free_slot)
+    return CUDA_ERROR_OUT_OF_MEMORY;
+  for (int i = 0; i < {len(bins)}; i++) {{
+    const {name}_variant_t *v = &{name}_variants[i];
+    err = cuModuleLoadData(&free_slot->modules[i], v->cubin);
+    if (err == CUDA_SUCCESS)
+      err = cuModuleGetFunction(&free_slot->functions[i], free_slot->modules[i], v->kernel_name);
+    // kernels using more than 48KB of shared memory opt into it
+    if (err == CUDA_SUCCESS && v->shared > 49152)
+      err = cuFuncSetAttribute(free_slot->functions[i], CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
+                               v->shared);
+    if (err != CUDA_SUCCESS) {{
+      CUresult ignored = CUDA_SUCCESS;
+      {name}_unload_context(free_slot, &ignored);
+      return err;
+    }}
+  }}
+  free_slot->context = context;
+  *out = free_slot;
+  return CUDA_SUCCESS;
+}}
+
+CUresult {name}_load(void) {{
+  {name}_context_t *c;
+  return {name}_current(1, &c);
+}}
+
+CUresult {name}_unload(void) {{
+  {name}_context_t *c;
+  CUresult ret = {name}_current(0, &c);
+  if (ret == CUDA_SUCCESS && c)
+    {name}_unload_context(c, &ret);
+  return ret;
+}}
+
+static CUresult {name}_launch(int variant, CUstream stream, unsigned gridX, unsigned gridY, unsigned gridZ,
+                              void **params) {{
+  {name}_context_t *c;
+  CUresult err = {name}_current(1, &c);
+  if (err != CUDA_SUCCESS)
+    return err;
+  if (gridX * gridY * gridZ == 0)
+    return CUDA_SUCCESS;
+  const {name}_variant_t *v = &{name}_variants[variant];
+  return cuLaunchKernel(c->functions[variant], gridX, gridY, gridZ, 32 * v->num_warps, 1, 1, v->shared, stream,
+                        params, NULL);
+}}
+
+CUresult {name}(CUstream stream, {arg_decls}) {{
+{dispatch}
+  return CUDA_ERROR_NOT_FOUND;
+}}
+"""
+    return header, source
+
+
+def build_library(name, header, source, out_dir, shared):
+    """
+    Writes the header and source of the library into `out_dir` and builds
+    them into `lib<name>.a`, or `lib<name>.so` if `shared`.
+    """
+    os.makedirs(out_dir, exist_ok=True)
+    src = os.path.join(out_dir, f"{name}.c")
+    with open(os.path.join(out_dir, f"{name}.h"), "w") as f:
+        f.write(header)
+    with open(src, "w") as f:
+        f.write(source)
+    cc = c_compiler()
+    flags = ["-O2", "-fPIC", f"-I{cuda_include_dir()}", f"-I{out_dir}"]
+    if shared:
+        lib = os.path.join(out_dir, f"lib{name}.so")
+        cmd = [cc, src, *flags, "-shared", "-lcuda", "-o", lib]
+        cmd += [f"-L{dir}" for dir in libcuda_dirs()]
+        subprocess.check_call(cmd)
+    else:
+        obj = os.path.join(out_dir, f"{name}.o")
+        lib = os.path.join(out_dir, f"lib{name}.a")
+        subprocess.check_call([cc, src, *flags, "-c", "-o", obj])
+        if os.path.exists(lib):
+            os.remove(lib)
+        subprocess.check_call(["ar", "rcs", lib, obj])
+    return lib
+
+
+def compile_library(args):
+    """
+    Compiles the `--kernel` of the Python source `args.src` for each of the
+    `--config`s, and builds the library dispatching between them.
+    """
+    spec = importlib.util.spec_from_file_location("__triton_aot_kernel", args.src)
+    mod = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(mod)
+    fn = getattr(mod, args.kernel)
+    if isinstance(fn, triton.runtime.Autotuner):
+        fn = fn.fn
+    if not isinstance(fn, triton.runtime.JITFunction):
+        raise argparse.ArgumentError(None, f"{args.kernel} is not a triton.jit function")
+    runtime_args = [i for i in range(len(fn.arg_names)) if i not in fn.constexprs]
+    types = [ty.strip() for ty in args.signature.split(',')]
+    if len(types) != len(runtime_args):
+        raise argparse.ArgumentError(None, f"--signature must type the {len(runtime_args)} runtime arguments of {fn.__name__}")
+    signature = dict(zip(runtime_args, types))
+    configs = [parse_config(config, fn) for config in args.config]
+    bins = [compile_config(fn, signature, config, args.sm) for config in configs]
+    name = args.out_name or fn.__name__
+    header, source = generate_library(name, fn, signature, configs, bins)
+    return build_library(name, header, source, args.out_dir, args.shared)
+
 
 if __name__ == '__main__':
 
     # valid source and target formats
-    VALID_FORMATS = ['triton-ir', 'triton-gpu-ir', 'llvm-ir', 'ptx', 'amdgcn']
+    VALID_FORMATS = ['triton-ir', 'triton-gpu-ir', 'llvm-ir', 'ptx', 'amdgcn', 'library']
 
     # set up the argument parser
     # TODO: conditional requirements
@@ -21,6 +349,19 @@ if __name__ == '__main__':
     parser.add_argument('--triple', type=str, help="target triple, for example: amdgcn-amd-amdhsa")
     parser.add_argument('--features', type=str, help="target features, for example: +sramecc,-xnack")
     parser.add_argument('--num_warps', type=int, help="number of warps to compile ttgir for")
+    parser.add_argument('--hsaco', type=str, help="file to write the HSACO code object of amdgcn compilation to")
+    parser.add_argument('--opt-level', type=int, default=3, choices=range(4),
+                        help="level LLVM optimizes and generates code at, 0 compiles fastest")
+    # library target: src is a Python file defining the kernel
+    parser.add_argument('--kernel', type=str, help="name of the triton.jit function of src to build a library of")
+    parser.add_argument('--signature', type=str, help="comma-separated types of the runtime arguments, e.g. *fp32,i32")
+    parser.add_argument('--config', action='append', default=[],
+                        help="config to compile the kernel for, e.g. \"BLOCK=1024; num_warps=4; "
+                             "divisible_by_16=x_ptr,n; grid=(n + 1023) / 1024; when=n >= 4096\", "
+                             "repeated for each config, launched by the first one the arguments satisfy")
+    parser.add_argument('--out-name', type=str, help="name of the library and its launch function")
+    parser.add_argument('--out-dir', '-o', type=str, default='.', help="directory to write the library to")
+    parser.add_argument('--shared', action='store_true', help="build a shared library instead of a static one")
 
     # parse the args
     args = parser.parse_args()
@@ -31,6 +372,15 @@ if __name__ == '__main__':
         print("Invalid target format: " + args.target)
         sys.exit(0)
 
+    # python kernel -> library of its configs
+    if args.target == 'library':
+        if not args.sm:
+            raise argparse.ArgumentError(None, "Must specify --sm for library compilation")
+        if not args.kernel or not args.signature or not args.config:
+            raise argparse.ArgumentError(None, "Must specify --kernel, --signature and --config for library compilation")
+        print(compile_library(args))
+        sys.exit(0)
+
     # parse source file to MLIR module
     context = libtriton.ir.context()
     module = libtriton.ir.parse_mlir_module(args.src, context)
@@ -75,11 +425,13 @@ if __name__ == '__main__':
         module = tc.optimize_ttgir(module, num_stages=3, arch=80)
         # triton-gpu-ir -> llvm-ir
         # use compute_capability == 80
-        module = tc.ttgir_to_llir(module, extern_libs=None, arch=80)
+        module = tc.ttgir_to_llir(module, extern_libs=None, arch=80, opt_level=args.opt_level)
         # llvm-ir -> amdgcn asm, hsaco binary
-        module, hsaco_path = tc.llir_to_amdgcn_and_hsaco(module, arch_name, arch_triple, arch_features)
+        module, hsaco = tc.llir_to_amdgcn_and_hsaco(module, arch_name, arch_triple, arch_features)
 
-        print(hsaco_path)
+        if args.hsaco:
+            with open(args.hsaco, "wb") as f:
+                f.write(hsaco)
         print(module)
         sys.exit(0)
 
@@ -94,7 +446,7 @@ if __name__ == '__main__':
         sys.exit(0)
 
     # triton-gpu-ir -> llvm-ir
-    module = tc.ttgir_to_llir(module, extern_libs=None, arch=args.sm)
+    module = tc.ttgir_to_llir(module, extern_libs=None, arch=args.sm, opt_level=args.opt_level)
     if args.target == 'llvm-ir':
         print(module)
         sys.exit(0)
@@ -103,12 +455,12 @@ if __name__ == '__main__':
     if args.target == 'ptx':
         if not args.ptx_version:
             raise argparse.ArgumentError(None, "Must specify --ptx-version for PTX compilation")
-        module = tc.llir_to_ptx(module, arch=args.sm, ptx_version=args.ptx_version)
+        module = tc.llir_to_ptx(module, arch=args.sm, ptx_version=args.ptx_version, opt_level=args.opt_level)
 
     # llvm-ir -> amdgcn
     if args.target == 'amdgcn':
         if not args.gfx:
             raise argparse.ArgumentError(None, "Must specify --gfx for AMDGCN compilation")
-        module, hsaco_path = tc.llir_to_amdgcn_and_hsaco(module, args.gfx)
+        module, hsaco = tc.llir_to_amdgcn_and_hsaco(module, args.gfx)
 
     print(module)
@@ -290,9 +290,9 @@ tt.func @shift() {
   %1 = arith.constant dense<8> : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [4], constancy = [128], constant_value = 4
   %2 = arith.constant dense<4> : tensor<128xi32>
-  // CHECK-NEXT: contiguity = [1], divisibility = [274877906944], constancy = [1], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1], divisibility = [256], constancy = [1], constant_value = <none>
   %3 = arith.shli %0, %1 : tensor<128xi32>
-  // CHECK-NEXT: contiguity = [1], divisibility = [67108864], constancy = [1], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [16], constant_value = <none>
   %4 = arith.shrsi %0, %2 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [128], constancy = [128], constant_value = 128
   %5 = arith.shli %1, %2 : tensor<128xi32>
@@ -301,6 +301,23 @@ tt.func @shift() {
 
 // -----
 
+// CHECK-LABEL: @shift_unknown
+tt.func @shift_unknown(%arg0: i32, %arg1: i32 {tt.divisibility = 16 : i32}) {
+  // CHECK: contiguity = [128], divisibility = [1073741824], constancy = [1], constant_value = <none>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
+  %1 = tt.splat %arg0 : (i32) -> tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [1], constant_value = <none>
+  %2 = arith.shli %0, %1 : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [128], constant_value = <none>
+  %3 = tt.splat %arg1 : (i32) -> tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [128], constant_value = <none>
+  %4 = arith.shli %3, %1 : tensor<128xi32>
+  tt.return
+}
+
+// -----
+
 tt.func @max_min() {
   // CHECK: contiguity = [128], divisibility = [1073741824], constancy = [1], constant_value = <none>
   %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
@@ -491,3 +508,79 @@ tt.func @vecadd_mask_align_1(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %
   tt.store %15, %13, %10 : tensor<64xf32>
   tt.return
 }
+
+// -----
+
+// CHECK-LABEL: @rem_partial_contiguity
+tt.func @rem_partial_contiguity() {
+  // CHECK: contiguity = [128], divisibility = [1073741824], constancy = [1], constant_value = <none>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [64], constancy = [128], constant_value = 64
+  %1 = arith.constant dense<64> : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [128], constant_value = 16
+  %2 = arith.constant dense<16> : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [64], divisibility = [64], constancy = [1], constant_value = <none>
+  %3 = arith.remsi %0, %1 : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [16], divisibility = [16], constancy = [1], constant_value = <none>
+  %4 = arith.remsi %3, %2 : tensor<128xi32>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @select_scalar_cond
+tt.func @select_scalar_cond(%arg0: i32 {tt.divisibility = 16 : i32}, %cond: i1) {
+  // CHECK: contiguity = [1], divisibility = [32], constancy = [1], constant_value = 32
+  %c32 = arith.constant 32 : i32
+  // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [1], constant_value = <none>
+  %0 = arith.select %cond, %arg0, %c32 : i32
+  // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [128], constant_value = <none>
+  %1 = tt.splat %0 : (i32) -> tensor<128xi32>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @for_iv_divisibility
+tt.func @for_iv_divisibility(%lb: i32 {tt.divisibility = 16 : i32}, %ub: i32) {
+  // CHECK: contiguity = [1], divisibility = [32], constancy = [1], constant_value = 32
+  %step = arith.constant 32 : i32
+  scf.for %iv = %lb to %ub step %step : i32 {
+    // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [128], constant_value = <none>
+    %0 = tt.splat %iv : (i32) -> tensor<128xi32>
+  }
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @for_ptr_iter_args
+tt.func @for_ptr_iter_args(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %ub: i32) {
+  // CHECK: contiguity = [128], divisibility = [1073741824], constancy = [1], constant_value = <none>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [128], constant_value = <none>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  // CHECK-NEXT: contiguity = [128], divisibility = [16], constancy = [1], constant_value = <none>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [128], constancy = [128], constant_value = 128
+  %c128 = arith.constant dense<128> : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = 1
+  %c1_tensor = arith.constant dense<1> : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [4611686018427387904], constancy = [1], constant_value = 0
+  %c0 = arith.constant 0 : i32
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [1], constant_value = 1
+  %c1 = arith.constant 1 : i32
+  // The iter args start from the divisibility of their init and are widened
+  // to the gcd with the yielded values until the loop reaches its fixpoint:
+  // %p keeps 16 while %q settles at the 4 bytes of its increment
+  %r:2 = scf.for %iv = %c0 to %ub step %c1 iter_args(%p = %2, %q = %2) -> (tensor<128x!tt.ptr<f32>>, tensor<128x!tt.ptr<f32>>) : i32 {
+    // CHECK-NEXT: contiguity = [128], divisibility = [16], constancy = [1], constant_value = <none>
+    %p1 = tt.addptr %p, %c128 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    // CHECK-NEXT: contiguity = [128], divisibility = [4], constancy = [1], constant_value = <none>
+    %q1 = tt.addptr %q, %c1_tensor : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    scf.yield %p1, %q1 : tensor<128x!tt.ptr<f32>>, tensor<128x!tt.ptr<f32>>
+  }
+  // CHECK-NEXT: contiguity = [128], divisibility = [16], constancy = [1], constant_value = <none>
+  // CHECK-NEXT: contiguity = [128], divisibility = [4], constancy = [1], constant_value = <none>
+  tt.return
+}
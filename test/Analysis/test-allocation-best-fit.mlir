@@ -0,0 +1,43 @@
+// RUN: triton-opt %s -split-input-file --mlir-disable-threading -test-print-allocation=best-fit=true 2>&1 | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// %c takes the place of %a, which is dead by then, below %b
+// CHECK-LABEL: reuse_gap
+tt.func @reuse_gap() {
+  // CHECK: offset = 0, size = 8192
+  %a = arith.constant dense<0.000000e+00> : tensor<128x32xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 8192, size = 4096
+  %b = arith.constant dense<0.000000e+00> : tensor<64x32xf16, #A_SHARED>
+  %0 = triton_gpu.convert_layout %a : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #AL>
+  // CHECK-NEXT: offset = 0, size = 4096
+  %c = arith.constant dense<0.000000e+00> : tensor<64x32xf16, #A_SHARED>
+  %1 = triton_gpu.convert_layout %b : (tensor<64x32xf16, #A_SHARED>) -> tensor<64x32xf16, #AL>
+  %2 = triton_gpu.convert_layout %c : (tensor<64x32xf16, #A_SHARED>) -> tensor<64x32xf16, #AL>
+  tt.return
+  // CHECK-NEXT: size = 12288
+  // CHECK-NEXT: fragmentation = 0
+}
+
+// The buffers of two consecutive loops share the same memory
+// CHECK-LABEL: disjoint_loops
+tt.func @disjoint_loops(%lb : index, %ub : index, %step : index) {
+  // CHECK: offset = 0, size = 8192
+  %a = arith.constant dense<0.000000e+00> : tensor<128x32xf16, #A_SHARED>
+  scf.for %iv = %lb to %ub step %step {
+    %0 = triton_gpu.convert_layout %a : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #AL>
+  }
+  // CHECK-NEXT: offset = 0, size = 8192
+  %b = arith.constant dense<0.000000e+00> : tensor<128x32xf16, #A_SHARED>
+  scf.for %iv = %lb to %ub step %step {
+    %1 = triton_gpu.convert_layout %b : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #AL>
+  }
+  tt.return
+  // CHECK-NEXT: size = 8192
+  // CHECK-NEXT: fragmentation = 0
+}
+
+}
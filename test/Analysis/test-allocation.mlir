@@ -166,13 +166,13 @@ tt.func @multi_color(%A : !tt.ptr<f16>) {
   %cst_1 = arith.constant dense<0.000000e+00> : tensor<16x4xf16, #A_SHARED>
   %cst_2 = arith.constant dense<0.000000e+00> : tensor<16x32xf16, #AL>
   // CHECK-NEXT: scratch offset = 64, size = 1152
-  %0 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  %0 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #BL>
   %1 = triton_gpu.convert_layout %cst : (tensor<4x8xf16, #A_SHARED>) -> tensor<4x8xf16, #AL>
   // CHECK-NEXT: offset = 0, size = 128
   %cst_3 = arith.constant dense<0.000000e+00> : tensor<4x16xf16, #A_SHARED>
   %2 = triton_gpu.convert_layout %cst_0 : (tensor<4x4xf16, #A_SHARED>) -> tensor<4x4xf16, #AL>
   // CHECK-NEXT: scratch offset = 0, size = 1152
-  %3 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  %3 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #BL>
   // CHECK-NEXT: offset = 0, size = 256
   %cst_4 = arith.constant dense<0.000000e+00> : tensor<4x32xf16, #A_SHARED>
   // CHECK-NEXT: offset = 256, size = 64
@@ -193,7 +193,7 @@ tt.func @multi_color(%A : !tt.ptr<f16>) {
   %7 = triton_gpu.convert_layout %cst_1 : (tensor<16x4xf16, #A_SHARED>) -> tensor<16x4xf16, #AL>
   %8 = triton_gpu.convert_layout %cst_4 : (tensor<4x32xf16, #A_SHARED>) -> tensor<4x32xf16, #AL>
   // CHECK-NEXT: scratch offset = 0, size = 1152
-  %9 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  %9 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #BL>
   %cst_11 = arith.constant dense<0.000000e+00> : tensor<4x4xf16, #AL>
   %10 = triton_gpu.convert_layout %cst_7 : (tensor<2x32xf16, #A_SHARED>) -> tensor<2x32xf16, #AL>
   %cst_12 = arith.constant dense<0.000000e+00> : tensor<4x16xf16, #AL>
@@ -226,6 +226,41 @@ tt.func @scratch() {
   // CHECK-NEXT: size = 512
 }
 
+// The scratch buffers of the operands are laid out one after the other,
+// booleans taking a byte each
+// CHECK-LABEL: scratch_multi_operand
+tt.func @scratch_multi_operand() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #AL>
+  %cst1 = arith.constant dense<0> : tensor<16x16xi32, #AL>
+  %cst2 = arith.constant dense<true> : tensor<16x16xi1, #AL>
+  // CHECK: scratch offset = 0, size = 2304
+  %b:3 = "tt.reduce" (%cst0, %cst1, %cst2) ({
+  ^bb0(%arg0: f32, %arg1: i32, %arg2: i1, %arg3: f32, %arg4: i32, %arg5: i1):
+    %gt = arith.cmpf ogt, %arg0, %arg3 : f32
+    %max = arith.select %gt, %arg0, %arg3 : f32
+    %idx = arith.select %gt, %arg1, %arg4 : i32
+    %any = arith.ori %arg2, %arg5 : i1
+    tt.reduce.return %max, %idx, %any : f32, i32, i1
+  }) {axis = 0 : i32} : (tensor<16x16xf32, #AL>, tensor<16x16xi32, #AL>, tensor<16x16xi1, #AL>) -> (tensor<16xf32, #sliceAd0>, tensor<16xi32, #sliceAd0>, tensor<16xi1, #sliceAd0>)
+  tt.return
+  // CHECK-NEXT: size = 2304
+}
+
+// The last lane of each warp writes the scan of the warp, one per
+// element along the other dimensions
+// CHECK-LABEL: scan_scratch
+tt.func @scan_scratch() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #AL>
+  // CHECK: scratch offset = 0, size = 256
+  %b = "tt.scan" (%cst0) ({
+  ^bb0(%arg0: f32, %arg1: f32):
+    %add = arith.addf %arg0, %arg1 : f32
+    tt.scan.return %add : f32
+  }) {axis = 0 : i32} : (tensor<16x16xf32, #AL>) -> tensor<16x16xf32, #AL>
+  tt.return
+  // CHECK-NEXT: size = 256
+}
+
 // CHECK-LABEL: trans
 tt.func @trans(%A : !tt.ptr<f16>) {
   // CHECK: offset = 0, size = 1024
@@ -396,3 +431,46 @@ tt.func @for_for_if(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>,
 }
 
 }
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#C = #triton_gpu.mma<{versionMajor = 3, warpsPerCTA = [4, 1]}>
+#A_DOT = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The operands of wgmma are aligned to the 1024 bytes of the 128B swizzle
+// CHECK-LABEL: mma_v3_operand_alignment
+tt.func @mma_v3_operand_alignment() {
+  // CHECK: offset = 0, size = 512
+  %x = arith.constant dense<0.00e+00> : tensor<16x16xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 1024, size = 16384
+  %a = arith.constant dense<0.00e+00> : tensor<128x64xf16, #A_SHARED>
+  %0 = triton_gpu.convert_layout %x : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  %1 = triton_gpu.convert_layout %a : (tensor<128x64xf16, #A_SHARED>) -> tensor<128x64xf16, #A_DOT>
+  tt.return
+  // CHECK-NEXT: size = 17408
+}
+
+}
+
+// -----
+
+#T_SRC = #triton_gpu.blocked<{sizePerThread = [8, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#T_DST = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Transposes whose padded rows conflict are swizzled instead, without padding
+// CHECK-LABEL: transpose_scratch
+tt.func @transpose_scratch() {
+  %cst = arith.constant dense<0.00e+00> : tensor<64x64xf16, #T_SRC>
+  // CHECK: scratch offset = 0, size = 8192
+  %0 = triton_gpu.convert_layout %cst : (tensor<64x64xf16, #T_SRC>) -> tensor<64x64xf16, #T_DST>
+  tt.return
+  // CHECK-NEXT: size = 8192
+}
+
+}
@@ -0,0 +1,38 @@
+// RUN: triton-opt %s -split-input-file --mlir-disable-threading -test-print-bank-conflicts 2>&1 | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#UNSWIZZLED = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#SWIZZLED = #triton_gpu.shared<{vec = 4, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 8, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A_DOT = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Every lane stores a row of 256 bytes, so that all lanes hit the same bank
+// unless the rows are swizzled
+// CHECK-LABEL: @store_rows
+tt.func @store_rows(%arg0: tensor<128x64xf32, #AL>) {
+  // CHECK-NEXT: triton_gpu.convert_layout => bank conflicts = 32
+  %0 = triton_gpu.convert_layout %arg0 : (tensor<128x64xf32, #AL>) -> tensor<128x64xf32, #UNSWIZZLED>
+  // CHECK-NEXT: triton_gpu.convert_layout => bank conflicts = 1
+  %1 = triton_gpu.convert_layout %arg0 : (tensor<128x64xf32, #AL>) -> tensor<128x64xf32, #SWIZZLED>
+  // Conversions between distributed layouts go through padded scratch buffers
+  // CHECK-NOT: bank conflicts
+  %2 = triton_gpu.convert_layout %arg0 : (tensor<128x64xf32, #AL>) -> tensor<128x64xf32, #BL>
+  tt.return
+}
+
+// The lines loaded by ldmatrix are 64 bytes apart, so that only the swizzled
+// layout of dot operands spreads them over all banks
+// CHECK-LABEL: @load_dot_operand
+tt.func @load_dot_operand(%arg0: tensor<128x32xf16, #UNSWIZZLED>, %arg1: tensor<128x32xf16, #A_SHARED>) {
+  // CHECK-NEXT: triton_gpu.convert_layout => bank conflicts = 4
+  %0 = triton_gpu.convert_layout %arg0 : (tensor<128x32xf16, #UNSWIZZLED>) -> tensor<128x32xf16, #A_DOT>
+  // CHECK-NEXT: triton_gpu.convert_layout => bank conflicts = 1
+  %1 = triton_gpu.convert_layout %arg1 : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #A_DOT>
+  tt.return
+}
+
+}
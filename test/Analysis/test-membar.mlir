@@ -502,4 +502,112 @@ tt.func @cf_if_else_return(%i1 : i1) {
   tt.return
 }
 
+
+// The pipelined loop reads the slot extracted in the previous iteration while
+// it writes the slot of a later one, so neither the prologue nor the loop
+// needs a barrier before insert_slice_async.
+// CHECK-LABEL: ring_buffer
+// CHECK-NEXT: removed barriers = 2
+tt.func @ring_buffer(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>) {
+  %a_ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<16x16x!tt.ptr<f16>, #AL>
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %c2 = arith.constant 2 : i32
+  %c3 = arith.constant 3 : i32
+  %buffer = triton_gpu.alloc_tensor : tensor<3x16x16xf16, #A_SHARED>
+  %0 = triton_gpu.insert_slice_async %a_ptr, %buffer, %c0 {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<3x16x16xf16, #A_SHARED>
+  triton_gpu.async_commit_group
+  // CHECK: triton_gpu.insert_slice_async
+  // CHECK-NOT: gpu.barrier
+  // CHECK: triton_gpu.insert_slice_async
+  %1 = triton_gpu.insert_slice_async %a_ptr, %0, %c1 {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<3x16x16xf16, #A_SHARED>
+  triton_gpu.async_commit_group
+  triton_gpu.async_wait {num = 1 : i32}
+  %slice_init = triton_gpu.extract_slice %1[%c0, 0, 0] [1, 16, 16] [1, 1, 1] : tensor<3x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+  %2:4 = scf.for %iv = %lb to %ub step %step iter_args(%buf = %1, %slice = %slice_init, %insert_iter = %c2, %extract_iter = %c1) -> (tensor<3x16x16xf16, #A_SHARED>, tensor<16x16xf16, #A_SHARED>, i32, i32) {
+    %3 = triton_gpu.convert_layout %slice : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+    %insert_idx = arith.remsi %insert_iter, %c3 : i32
+    %extract_idx = arith.remsi %extract_iter, %c3 : i32
+    // CHECK: triton_gpu.convert_layout
+    // CHECK-NOT: gpu.barrier
+    // CHECK: triton_gpu.insert_slice_async
+    %4 = triton_gpu.insert_slice_async %a_ptr, %buf, %insert_idx {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<3x16x16xf16, #A_SHARED>
+    triton_gpu.async_commit_group
+    // CHECK: triton_gpu.async_wait
+    // CHECK-NEXT: gpu.barrier
+    triton_gpu.async_wait {num = 1 : i32}
+    %next_slice = triton_gpu.extract_slice %4[%extract_idx, 0, 0] [1, 16, 16] [1, 1, 1] : tensor<3x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+    %next_insert_iter = arith.addi %insert_iter, %c1 : i32
+    %next_extract_iter = arith.addi %extract_iter, %c1 : i32
+    scf.yield %4, %next_slice, %next_insert_iter, %next_extract_iter : tensor<3x16x16xf16, #A_SHARED>, tensor<16x16xf16, #A_SHARED>, i32, i32
+  }
+  tt.return
+}
+
+// The loop overwrites the slot it reads in the same iteration
+// CHECK-LABEL: ring_buffer_overlap
+// CHECK-NEXT: removed barriers = 1
+tt.func @ring_buffer_overlap(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>) {
+  %a_ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<16x16x!tt.ptr<f16>, #AL>
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %c3 = arith.constant 3 : i32
+  %buffer = triton_gpu.alloc_tensor : tensor<3x16x16xf16, #A_SHARED>
+  %0 = triton_gpu.insert_slice_async %a_ptr, %buffer, %c0 {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<3x16x16xf16, #A_SHARED>
+  %1 = triton_gpu.insert_slice_async %a_ptr, %0, %c1 {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<3x16x16xf16, #A_SHARED>
+  triton_gpu.async_commit_group
+  triton_gpu.async_wait {num = 0 : i32}
+  %slice_init = triton_gpu.extract_slice %1[%c0, 0, 0] [1, 16, 16] [1, 1, 1] : tensor<3x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+  %2:4 = scf.for %iv = %lb to %ub step %step iter_args(%buf = %1, %slice = %slice_init, %insert_iter = %c0, %extract_iter = %c1) -> (tensor<3x16x16xf16, #A_SHARED>, tensor<16x16xf16, #A_SHARED>, i32, i32) {
+    %3 = triton_gpu.convert_layout %slice : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+    %insert_idx = arith.remsi %insert_iter, %c3 : i32
+    %extract_idx = arith.remsi %extract_iter, %c3 : i32
+    // CHECK: gpu.barrier
+    // CHECK-NEXT: triton_gpu.insert_slice_async
+    %4 = triton_gpu.insert_slice_async %a_ptr, %buf, %insert_idx {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<3x16x16xf16, #A_SHARED>
+    triton_gpu.async_commit_group
+    triton_gpu.async_wait {num = 0 : i32}
+    %next_slice = triton_gpu.extract_slice %4[%extract_idx, 0, 0] [1, 16, 16] [1, 1, 1] : tensor<3x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+    %next_insert_iter = arith.addi %insert_iter, %c1 : i32
+    %next_extract_iter = arith.addi %extract_iter, %c1 : i32
+    scf.yield %4, %next_slice, %next_insert_iter, %next_extract_iter : tensor<3x16x16xf16, #A_SHARED>, tensor<16x16xf16, #A_SHARED>, i32, i32
+  }
+  tt.return
+}
+
+// The two halves of the buffer are written and read independently, so only
+// the read of the first half after it is written needs a barrier.
+// CHECK-LABEL: disjoint_slices
+// CHECK-NEXT: removed barriers = 2
+tt.func @disjoint_slices(%A : !tt.ptr<f16>, %i1 : i1) {
+  %a_ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<16x16x!tt.ptr<f16>, #AL>
+  %mask = tt.splat %i1 : (i1) -> tensor<16x16xi1, #AL>
+  %other = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %a = tt.load %a_ptr, %mask, %other {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xf16, #AL>
+  %buffer = triton_gpu.alloc_tensor : tensor<32x16xf16, #A_SHARED>
+  // CHECK: tensor.insert_slice
+  // CHECK-NOT: gpu.barrier
+  // CHECK: tensor.insert_slice
+  %0 = tensor.insert_slice %a into %buffer[0, 0] [16, 16] [1, 1] : tensor<16x16xf16, #AL> into tensor<32x16xf16, #A_SHARED>
+  %1 = tensor.insert_slice %a into %0[16, 0] [16, 16] [1, 1] : tensor<16x16xf16, #AL> into tensor<32x16xf16, #A_SHARED>
+  %2 = triton_gpu.extract_slice %1[0, 0] [16, 16] [1, 1] : tensor<32x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: triton_gpu.convert_layout
+  %3 = triton_gpu.convert_layout %2 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  // CHECK-NOT: gpu.barrier
+  // CHECK: tensor.insert_slice
+  %4 = tensor.insert_slice %3 into %1[16, 0] [16, 16] [1, 1] : tensor<16x16xf16, #AL> into tensor<32x16xf16, #A_SHARED>
+  tt.return
+}
+
+// CHECK-LABEL: fold_barriers
+// CHECK-NEXT: removed barriers = 1
+tt.func @fold_barriers() {
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: tt.return
+  gpu.barrier
+  gpu.barrier
+  tt.return
+}
+
 }
@@ -0,0 +1,48 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<bf16>,
+    %arg1 : !tt.ptr<bf16>,
+    %arg2 : i32
+  )
+  {
+    %c0 = arith.constant 0 : i32
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32}:tensor<128xi32>
+    // offset = 0, size = 128, stride = 1
+    %1 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    // source = %arg0, offset = 0, size = 128, stride = 1
+    %3 = arith.cmpi sgt, %arg2, %c0 : i32
+    %4 = scf.if %3 -> (tensor<128x!tt.ptr<bf16>>) {
+      %5 = tt.splat %arg2 : (i32) -> tensor<128xi32>
+      %6 = tt.addptr %2, %5 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+      // source = %arg0, offset = %arg2, size = 128, stride = 1
+      scf.yield %6 : tensor<128x!tt.ptr<bf16>>
+    } else {
+      scf.yield %2 : tensor<128x!tt.ptr<bf16>>
+    }
+    %7 = tt.load %4 {cache = 1 : i32, evict = 1 : i32, isVolatile = false}: tensor<128xbf16>
+    %8 = tt.splat %arg1 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %9 = tt.addptr %8, %0 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    tt.store %9, %7 : tensor<128xbf16>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[ARG0:.*]]: memref<*xbf16>, %[[ARG1:.*]]: memref<*xbf16>, %[[ARG2:.*]]: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK:           %[[COND:.*]] = arith.cmpi sgt, %[[ARG2]], %{{.*}} : i32
+// CHECK:           %[[IF:.*]]:3 = scf.if %[[COND]] -> (memref<128xbf16, strided<[?], offset: ?>>, index, index) {
+// CHECK:             %[[OFF:.*]] = arith.index_cast %[[ARG2]] : i32 to index
+// CHECK:             %[[THEN:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{\[}}%[[OFF]]], sizes: [128], strides: {{\[}}%[[ONE:.*]]] : memref<*xbf16> to memref<128xbf16, strided<[?], offset: ?>>
+// CHECK:             scf.yield %[[THEN]], %[[OFF]], %[[ONE]] : memref<128xbf16, strided<[?], offset: ?>>, index, index
+// CHECK:           } else {
+// CHECK:             %[[ELSE:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{\[}}%[[ZERO:.*]]], sizes: [128], strides: {{\[}}%[[STRIDE:.*]]] : memref<*xbf16> to memref<128xbf16, strided<[?], offset: ?>>
+// CHECK:             scf.yield %[[ELSE]], %[[ZERO]], %[[STRIDE]] : memref<128xbf16, strided<[?], offset: ?>>, index, index
+// CHECK:           }
+// CHECK:           %[[VIEW:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{\[}}%[[IF]]#1], sizes: [128], strides: {{\[}}%[[IF]]#2] : memref<*xbf16> to memref<128xbf16, strided<[?], offset: ?>>
+// CHECK:           %[[BUF:.*]] = memref.alloc() : memref<128xbf16>
+// CHECK:           memref.copy %[[VIEW]], %[[BUF]] : memref<128xbf16, strided<[?], offset: ?>> to memref<128xbf16>
+// CHECK:           %[[VAL:.*]] = bufferization.to_tensor %[[BUF]]
+// CHECK:           %[[DST:.*]] = memref.reinterpret_cast %[[ARG1]] to offset: [0], sizes: [128], strides: [1] : memref<*xbf16> to memref<128xbf16, strided<[1]>>
+// CHECK:           memref.tensor_store %[[VAL]], %[[DST]] : memref<128xbf16, strided<[1]>>
+// CHECK:           return
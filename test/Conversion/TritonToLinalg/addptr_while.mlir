@@ -0,0 +1,53 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<bf16>,
+    %arg1 : !tt.ptr<bf16>,
+    %arg2 : i32
+  )
+  {
+    %c0 = arith.constant 0 : i32
+    %c1 = arith.constant 1 : i32
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32}:tensor<128xi32>
+    // offset = 0, size = 128, stride = 1
+    %1 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    // source = %arg0, offset = 0, size = 128, stride = 1
+    %3 = tt.splat %arg1 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %4 = tt.addptr %3, %0 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    // source = %arg1, offset = 0, size = 128, stride = 1
+    %cst = arith.constant dense<128> : tensor<128xi32>
+    %res:3 = scf.while (%i = %c0, %src = %2, %dst = %4) : (i32, tensor<128x!tt.ptr<bf16>>, tensor<128x!tt.ptr<bf16>>) -> (i32, tensor<128x!tt.ptr<bf16>>, tensor<128x!tt.ptr<bf16>>) {
+      %5 = arith.cmpi slt, %i, %arg2 : i32
+      scf.condition(%5) %i, %src, %dst : i32, tensor<128x!tt.ptr<bf16>>, tensor<128x!tt.ptr<bf16>>
+    } do {
+    ^bb0(%i_iter: i32, %src_iter: tensor<128x!tt.ptr<bf16>>, %dst_iter: tensor<128x!tt.ptr<bf16>>):
+      %6 = tt.load %src_iter {cache = 1 : i32, evict = 1 : i32, isVolatile = false}: tensor<128xbf16>
+      tt.store %dst_iter, %6 : tensor<128xbf16>
+      // pointer updates
+      %7 = tt.addptr %src_iter, %cst : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+      %8 = tt.addptr %dst_iter, %cst : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+      %9 = arith.addi %i_iter, %c1 : i32
+      scf.yield %9, %7, %8 : i32, tensor<128x!tt.ptr<bf16>>, tensor<128x!tt.ptr<bf16>>
+    }
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[ARG0:.*]]: memref<*xbf16>, %[[ARG1:.*]]: memref<*xbf16>, %[[ARG2:.*]]: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK:           %[[SRC:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{\[}}%{{.*}}], sizes: [128], strides: {{\[}}%{{.*}}] : memref<*xbf16> to memref<128xbf16, strided<[?], offset: ?>>
+// CHECK:           %[[DST:.*]] = memref.reinterpret_cast %[[ARG1]] to offset: {{\[}}%{{.*}}], sizes: [128], strides: {{\[}}%{{.*}}] : memref<*xbf16> to memref<128xbf16, strided<[?], offset: ?>>
+// CHECK:           %{{.*}}:7 = scf.while (%{{.*}} = %{{.*}}, %{{.*}} = %[[SRC]], %{{.*}} = %[[DST]], %{{.*}} = %{{.*}}, %{{.*}} = %{{.*}}, %{{.*}} = %{{.*}}, %{{.*}} = %{{.*}}) : (i32, memref<128xbf16, strided<[?], offset: ?>>, memref<128xbf16, strided<[?], offset: ?>>, index, index, index, index) -> (i32, memref<128xbf16, strided<[?], offset: ?>>, memref<128xbf16, strided<[?], offset: ?>>, index, index, index, index) {
+// CHECK:             scf.condition(%{{.*}}) %{{.*}}, %{{.*}}, %{{.*}}, %{{.*}}, %{{.*}}, %{{.*}}, %{{.*}} : i32, memref<128xbf16, strided<[?], offset: ?>>, memref<128xbf16, strided<[?], offset: ?>>, index, index, index, index
+// CHECK:           } do {
+// CHECK:           ^bb0(%{{.*}}: i32, %[[SRC_ITER:.*]]: memref<128xbf16, strided<[?], offset: ?>>, %[[DST_ITER:.*]]: memref<128xbf16, strided<[?], offset: ?>>, %[[SRC_OFF:.*]]: index, %[[SRC_STRIDE:.*]]: index, %[[DST_OFF:.*]]: index, %[[DST_STRIDE:.*]]: index):
+// CHECK:             %[[BUF:.*]] = memref.alloc() : memref<128xbf16>
+// CHECK:             memref.copy %[[SRC_ITER]], %[[BUF]]
+// CHECK:             memref.tensor_store %{{.*}}, %[[DST_ITER]]
+// CHECK:             %[[NEXT_SRC_OFF:.*]] = arith.addi %[[SRC_OFF]], %{{.*}} : index
+// CHECK:             %[[NEXT_SRC:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{\[}}%[[NEXT_SRC_OFF]]], sizes: [128], strides: {{\[}}%[[SRC_STRIDE]]]
+// CHECK:             %[[NEXT_DST_OFF:.*]] = arith.addi %[[DST_OFF]], %{{.*}} : index
+// CHECK:             %[[NEXT_DST:.*]] = memref.reinterpret_cast %[[ARG1]] to offset: {{\[}}%[[NEXT_DST_OFF]]], sizes: [128], strides: {{\[}}%[[DST_STRIDE]]]
+// CHECK:             scf.yield %{{.*}}, %[[NEXT_SRC]], %[[NEXT_DST]], %[[NEXT_SRC_OFF]], %[[SRC_STRIDE]], %[[NEXT_DST_OFF]], %[[DST_STRIDE]] : i32, memref<128xbf16, strided<[?], offset: ?>>, memref<128xbf16, strided<[?], offset: ?>>, index, index, index, index
+// CHECK:           }
+// CHECK:           return
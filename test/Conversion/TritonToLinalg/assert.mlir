@@ -0,0 +1,22 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(%arg0 : !tt.ptr<i32>, %arg1 : i32) {
+    // Assert that every element of a loaded block is below %arg1
+    %0 = tt.splat %arg0 : (!tt.ptr<i32>) -> tensor<128x!tt.ptr<i32>>
+    %1 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %2 = tt.addptr %0, %1 : tensor<128x!tt.ptr<i32>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xi32>
+    %4 = tt.splat %arg1 : (i32) -> tensor<128xi32>
+    %5 = arith.cmpi slt, %3, %4 : tensor<128xi32>
+    tt.assert %5, "x < n", "kernel", "kernel", 12 : tensor<128xi1>
+    tt.return
+  }
+}
+// The condition is reduced once and asserted as a scalar
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[COND:.*]] = linalg.generic {{.*}} -> tensor<128xi1>
+// CHECK:           %[[INIT:.*]] = linalg.fill ins(%{{.*}} : i1) outs(%{{.*}} : tensor<i1>) -> tensor<i1>
+// CHECK:           %[[ALL:.*]] = linalg.generic {indexing_maps = [#{{.*}}, #{{.*}}], iterator_types = ["reduction"]} ins(%[[COND]] : tensor<128xi1>) outs(%[[INIT]] : tensor<i1>)
+// CHECK:             arith.andi
+// CHECK:           %[[SCALAR:.*]] = tensor.extract %[[ALL]][] : tensor<i1>
+// CHECK:           cf.assert %[[SCALAR]], "kernel.py:12: kernel Assertion `x < n` failed"
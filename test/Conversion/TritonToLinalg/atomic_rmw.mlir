@@ -0,0 +1,43 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>,
+    %arg2 : i32
+  )
+  {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32}:tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    // source = %arg0, offset = 0, size = 128, stride = 1
+    %3 = tt.splat %arg2 : (i32) -> tensor<128xi32>
+    %4 = arith.cmpi slt, %0, %3 : tensor<128xi32>
+    // mask covers [0, %arg2)
+    %cst = arith.constant dense<1.000000e+00> : tensor<128xf32>
+    %5 = "tt.atomic_rmw"(%2, %cst, %4) {atomic_rmw_op = 5 : i32} : (tensor<128x!tt.ptr<f32>>, tensor<128xf32>, tensor<128xi1>) -> tensor<128xf32>
+    %6 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %7 = tt.addptr %6, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %cmp = arith.constant dense<0.000000e+00> : tensor<128xf32>
+    %8 = "tt.atomic_cas"(%7, %cmp, %5) : (tensor<128x!tt.ptr<f32>>, tensor<128xf32>, tensor<128xf32>) -> tensor<128xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[ARG0:.*]]: memref<*xf32>, %[[ARG1:.*]]: memref<*xf32>, %[[ARG2:.*]]: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK:           %[[PTR:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: [0], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1]>>
+// CHECK:           %[[OLD:.*]] = memref.alloc() : memref<128xf32>
+// CHECK:           scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} {
+// CHECK:             %[[VAL:.*]] = tensor.extract %{{.*}}{{\[}}%[[IV]]] : tensor<128xf32>
+// CHECK:             %[[RES:.*]] = memref.atomic_rmw addf %[[VAL]], %[[PTR]]{{\[}}%[[IV]]] : (f32, memref<128xf32, strided<[1]>>) -> f32
+// CHECK:             memref.store %[[RES]], %[[OLD]]{{\[}}%[[IV]]] : memref<128xf32>
+// CHECK:           }
+// CHECK:           %[[OLD_TENSOR:.*]] = bufferization.to_tensor %[[OLD]] restrict writable : memref<128xf32>
+// CHECK:           %[[CAS_PTR:.*]] = memref.reinterpret_cast %[[ARG1]] to offset: [0], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1]>>
+// CHECK:           scf.for %[[J:.*]] = %{{.*}} to %{{.*}} step %{{.*}} {
+// CHECK:             %[[NEW:.*]] = tensor.extract %[[OLD_TENSOR]]{{\[}}%[[J]]] : tensor<128xf32>
+// CHECK:             memref.generic_atomic_rmw %[[CAS_PTR]]{{\[}}%[[J]]] : memref<128xf32, strided<[1]>> {
+// CHECK:             ^bb0(%[[CUR:.*]]: f32):
+// CHECK:               %[[EQ:.*]] = arith.cmpi eq
+// CHECK:               %[[SEL:.*]] = arith.select %[[EQ]], %[[NEW]], %[[CUR]] : f32
+// CHECK:               memref.atomic_yield %[[SEL]] : f32
+// CHECK:           return
@@ -0,0 +1,51 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>,
+    %arg2 : i32,
+    %arg3 : i32
+  )
+  {
+    %c0_i32 = arith.constant 0 : i32
+    %c64_i32 = arith.constant 64 : i32
+    %c1_i64 = arith.constant 1 : i64
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c4 = arith.constant 4 : index
+    %cst = arith.constant dense<0.000000e+00> : tensor<32x64xf32>
+    // parent tensor of %arg2 x %arg3 elements in row-major order
+    %0 = arith.extsi %arg2 : i32 to i64
+    %1 = arith.extsi %arg3 : i32 to i64
+    %2 = tt.make_tensor_ptr %arg0, [%0, %1], [%1, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<32x64xf32>>
+    %3:2 = scf.for %arg4 = %c0 to %c4 step %c1 iter_args(%arg5 = %cst, %arg6 = %2) -> (tensor<32x64xf32>, !tt.ptr<tensor<32x64xf32>>) {
+      // columns past %arg3 are read as zeros
+      %4 = tt.load %arg6 {boundaryCheck = array<i32: 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<32x64xf32>> -> tensor<32x64xf32>
+      %5 = arith.addf %arg5, %4 : tensor<32x64xf32>
+      %6 = tt.advance %arg6, [%c0_i32, %c64_i32] : !tt.ptr<tensor<32x64xf32>>
+      scf.yield %5, %6 : tensor<32x64xf32>, !tt.ptr<tensor<32x64xf32>>
+    }
+    %7 = tt.make_tensor_ptr %arg1, [%0, %1], [%1, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<32x64xf32>>
+    tt.store %7, %3#0 {boundaryCheck = array<i32: 0, 1>, cache = 1 : i32, evict = 1 : i32} : !tt.ptr<tensor<32x64xf32>>, tensor<32x64xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[ARG0:[^:]*]]: memref<*xf32>, %[[ARG1:[^:]*]]: memref<*xf32>
+// CHECK-NOT:       tt.make_tensor_ptr
+// CHECK:           %[[INIT:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{.*}}, sizes: [32, 64], strides:
+// CHECK:           scf.for {{.*}} iter_args({{.*}}%[[PTR:[^ ]*]] = %[[INIT]]
+// CHECK:             %[[ALLOC:.*]] = memref.alloc() : memref<32x64xf32>
+// CHECK:             arith.ceildivsi
+// CHECK:             %[[SRC:.*]] = memref.subview %[[PTR]]
+// CHECK:             %[[TILE:.*]] = memref.subview %[[ALLOC]]
+// CHECK:             linalg.fill ins(%{{.*}} : f32)
+// CHECK:             memref.copy %[[SRC]], %[[TILE]]
+// CHECK-NOT:         tt.advance
+// CHECK:             memref.reinterpret_cast %[[ARG0]]
+// CHECK:             scf.yield
+// CHECK:           }
+// CHECK:           %[[DST:.*]] = memref.reinterpret_cast %[[ARG1]] to offset: [0], sizes: [32, 64], strides: [%{{.*}}, 1]
+// CHECK:           %[[VIEW:.*]] = memref.subview %[[DST]]
+// CHECK:           %[[SLICE:.*]] = tensor.extract_slice
+// CHECK:           memref.tensor_store %[[SLICE]], %[[VIEW]]
@@ -0,0 +1,30 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>,
+    %arg2 : i32,
+    %arg3 : i64
+  )
+  {
+    %c0_i32 = arith.constant 0 : i32
+    %c0_i64 = arith.constant 0 : i64
+    %c64_i64 = arith.constant 64 : i64
+    %0 = arith.extsi %arg2 : i32 to i64
+    // the columns are broadcast, the stride of the rows is only known at
+    // run time and may be zero as well
+    %1 = tt.make_tensor_ptr %arg0, [%0, %c64_i64], [%arg3, %c0_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<32x64xf32>>
+    %2 = tt.load %1 {boundaryCheck = array<i32: 0, 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<32x64xf32>> -> tensor<32x64xf32>
+    %3 = tt.make_tensor_ptr %arg1, [%c64_i64, %c64_i64], [%c64_i64, %c64_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<32x64xf32>>
+    tt.store %3, %2 : !tt.ptr<tensor<32x64xf32>>, tensor<32x64xf32>
+    tt.return
+  }
+}
+// The boundary checks never divide by a zero stride: the broadcast columns
+// are checked at index 0, and the rows divide by 1 if their stride is 0.
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[BCAST:.*]] = arith.cmpi eq, %[[STRIDE:[^,]*]], %{{.*}} : index
+// CHECK:           %[[DIVISOR:.*]] = arith.select %[[BCAST]], %{{.*}}, %[[STRIDE]] : index
+// CHECK:           arith.ceildivsi %{{.*}}, %[[DIVISOR]] : index
+// CHECK-NOT:       arith.ceildivsi
+// CHECK:           memref.copy
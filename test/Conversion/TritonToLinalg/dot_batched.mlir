@@ -0,0 +1,105 @@
+// RUN: triton-opt --split-input-file --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @batched_dot(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>,
+    %arg2 : !tt.ptr<f32>
+  )
+  {
+    // offsets = b * 1024 + i * 32 + j for a 4x32x32 tile
+    %0 = tt.make_range {end = 4 : i32, start = 0 : i32} : tensor<4xi32>
+    %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<4xi32>) -> tensor<4x1xi32>
+    %2 = tt.expand_dims %1 {axis = 2 : i32} : (tensor<4x1xi32>) -> tensor<4x1x1xi32>
+    %c1024 = arith.constant 1024 : i32
+    %3 = tt.splat %c1024 : (i32) -> tensor<4x1x1xi32>
+    %4 = arith.muli %2, %3 : tensor<4x1x1xi32>
+    %5 = tt.broadcast %4 : (tensor<4x1x1xi32>) -> tensor<4x32x32xi32>
+    %6 = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+    %7 = tt.expand_dims %6 {axis = 0 : i32} : (tensor<32xi32>) -> tensor<1x32xi32>
+    %8 = tt.expand_dims %7 {axis = 2 : i32} : (tensor<1x32xi32>) -> tensor<1x32x1xi32>
+    %c32 = arith.constant 32 : i32
+    %9 = tt.splat %c32 : (i32) -> tensor<1x32x1xi32>
+    %10 = arith.muli %8, %9 : tensor<1x32x1xi32>
+    %11 = tt.broadcast %10 : (tensor<1x32x1xi32>) -> tensor<4x32x32xi32>
+    %12 = tt.expand_dims %7 {axis = 1 : i32} : (tensor<1x32xi32>) -> tensor<1x1x32xi32>
+    %13 = tt.broadcast %12 : (tensor<1x1x32xi32>) -> tensor<4x32x32xi32>
+    %14 = arith.addi %5, %11 : tensor<4x32x32xi32>
+    %15 = arith.addi %14, %13 : tensor<4x32x32xi32>
+    %16 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<4x32x32x!tt.ptr<f32>>
+    %17 = tt.addptr %16, %15 : tensor<4x32x32x!tt.ptr<f32>>, tensor<4x32x32xi32>
+    %18 = tt.load %17 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<4x32x32xf32>
+    %19 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<4x32x32x!tt.ptr<f32>>
+    %20 = tt.addptr %19, %15 : tensor<4x32x32x!tt.ptr<f32>>, tensor<4x32x32xi32>
+    %21 = tt.load %20 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<4x32x32xf32>
+    %cst = arith.constant dense<0.000000e+00> : tensor<4x32x32xf32>
+    %22 = tt.dot %18, %21, %cst {allowTF32 = false} : tensor<4x32x32xf32> * tensor<4x32x32xf32> -> tensor<4x32x32xf32>
+    %23 = tt.splat %arg2 : (!tt.ptr<f32>) -> tensor<4x32x32x!tt.ptr<f32>>
+    %24 = tt.addptr %23, %15 : tensor<4x32x32x!tt.ptr<f32>>, tensor<4x32x32xi32>
+    tt.store %24, %22 : tensor<4x32x32xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @batched_dot(
+// CHECK:           %[[FILL:.*]] = linalg.fill ins(%{{.*}} : f32) outs(%{{.*}} : tensor<4x32x32xf32>) -> tensor<4x32x32xf32>
+// CHECK:           %[[RES:.*]] = linalg.batch_matmul ins(%{{.*}}, %{{.*}} : tensor<4x32x32xf32>, tensor<4x32x32xf32>) outs(%[[FILL]] : tensor<4x32x32xf32>) -> tensor<4x32x32xf32>
+// CHECK:           memref.tensor_store %[[RES]], %{{.*}}
+
+// -----
+
+module {
+  tt.func @batch_reduce_dot(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>,
+    %arg2 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.make_range {end = 4 : i32, start = 0 : i32} : tensor<4xi32>
+    %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<4xi32>) -> tensor<4x1xi32>
+    %2 = tt.expand_dims %1 {axis = 2 : i32} : (tensor<4x1xi32>) -> tensor<4x1x1xi32>
+    %c1024 = arith.constant 1024 : i32
+    %3 = tt.splat %c1024 : (i32) -> tensor<4x1x1xi32>
+    %4 = arith.muli %2, %3 : tensor<4x1x1xi32>
+    %5 = tt.broadcast %4 : (tensor<4x1x1xi32>) -> tensor<4x32x32xi32>
+    %6 = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+    %7 = tt.expand_dims %6 {axis = 0 : i32} : (tensor<32xi32>) -> tensor<1x32xi32>
+    %8 = tt.expand_dims %7 {axis = 2 : i32} : (tensor<1x32xi32>) -> tensor<1x32x1xi32>
+    %c32 = arith.constant 32 : i32
+    %9 = tt.splat %c32 : (i32) -> tensor<1x32x1xi32>
+    %10 = arith.muli %8, %9 : tensor<1x32x1xi32>
+    %11 = tt.broadcast %10 : (tensor<1x32x1xi32>) -> tensor<4x32x32xi32>
+    %12 = tt.expand_dims %7 {axis = 1 : i32} : (tensor<1x32xi32>) -> tensor<1x1x32xi32>
+    %13 = tt.broadcast %12 : (tensor<1x1x32xi32>) -> tensor<4x32x32xi32>
+    %14 = arith.addi %5, %11 : tensor<4x32x32xi32>
+    %15 = arith.addi %14, %13 : tensor<4x32x32xi32>
+    %16 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<4x32x32x!tt.ptr<f32>>
+    %17 = tt.addptr %16, %15 : tensor<4x32x32x!tt.ptr<f32>>, tensor<4x32x32xi32>
+    %18 = tt.load %17 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<4x32x32xf32>
+    %19 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<4x32x32x!tt.ptr<f32>>
+    %20 = tt.addptr %19, %15 : tensor<4x32x32x!tt.ptr<f32>>, tensor<4x32x32xi32>
+    %21 = tt.load %20 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<4x32x32xf32>
+    %cst = arith.constant dense<0.000000e+00> : tensor<4x32x32xf32>
+    %22 = tt.dot %18, %21, %cst {allowTF32 = false} : tensor<4x32x32xf32> * tensor<4x32x32xf32> -> tensor<4x32x32xf32>
+    %23 = "tt.reduce"(%22) ({
+    ^bb0(%a: f32, %b: f32):
+      %s = arith.addf %a, %b : f32
+      tt.reduce.return %s : f32
+    }) {axis = 0 : i32} : (tensor<4x32x32xf32>) -> tensor<32x32xf32>
+    %25 = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+    %26 = tt.expand_dims %25 {axis = 1 : i32} : (tensor<32xi32>) -> tensor<32x1xi32>
+    %27 = tt.splat %c32 : (i32) -> tensor<32x1xi32>
+    %28 = arith.muli %26, %27 : tensor<32x1xi32>
+    %29 = tt.broadcast %28 : (tensor<32x1xi32>) -> tensor<32x32xi32>
+    %30 = tt.expand_dims %25 {axis = 0 : i32} : (tensor<32xi32>) -> tensor<1x32xi32>
+    %31 = tt.broadcast %30 : (tensor<1x32xi32>) -> tensor<32x32xi32>
+    %32 = arith.addi %29, %31 : tensor<32x32xi32>
+    %33 = tt.splat %arg2 : (!tt.ptr<f32>) -> tensor<32x32x!tt.ptr<f32>>
+    %34 = tt.addptr %33, %32 : tensor<32x32x!tt.ptr<f32>>, tensor<32x32xi32>
+    tt.store %34, %23 : tensor<32x32xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @batch_reduce_dot(
+// CHECK:           %[[FILL:.*]] = linalg.fill ins(%{{.*}} : f32) outs(%{{.*}} : tensor<32x32xf32>) -> tensor<32x32xf32>
+// CHECK:           %[[RES:.*]] = linalg.batch_reduce_matmul ins(%{{.*}}, %{{.*}} : tensor<4x32x32xf32>, tensor<4x32x32xf32>) outs(%[[FILL]] : tensor<32x32xf32>) -> tensor<32x32xf32>
+// CHECK-NOT:       linalg.reduce
+// CHECK:           memref.tensor_store %[[RES]], %{{.*}}
@@ -0,0 +1,48 @@
+// RUN: triton-opt --triton-to-linalg="dot-epilogue-tile-size=32" %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>,
+    %arg2 : !tt.ptr<bf16>
+  )
+  {
+    // offsets of a row-major 64x64 tile
+    %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+    %c64 = arith.constant 64 : i32
+    %1 = tt.splat %c64 : (i32) -> tensor<64xi32>
+    %2 = arith.muli %0, %1 : tensor<64xi32>
+    %3 = tt.expand_dims %2 {axis = 1 : i32} : (tensor<64xi32>) -> tensor<64x1xi32>
+    %4 = tt.broadcast %3 : (tensor<64x1xi32>) -> tensor<64x64xi32>
+    %5 = tt.expand_dims %0 {axis = 0 : i32} : (tensor<64xi32>) -> tensor<1x64xi32>
+    %6 = tt.broadcast %5 : (tensor<1x64xi32>) -> tensor<64x64xi32>
+    %7 = arith.addi %4, %6 : tensor<64x64xi32>
+    %10 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<64x64x!tt.ptr<f32>>
+    %11 = tt.addptr %10, %7 : tensor<64x64x!tt.ptr<f32>>, tensor<64x64xi32>
+    %12 = tt.load %11 {cache = 1 : i32, evict = 1 : i32, isVolatile = false}: tensor<64x64xf32>
+    %20 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<64x64x!tt.ptr<f32>>
+    %21 = tt.addptr %20, %7 : tensor<64x64x!tt.ptr<f32>>, tensor<64x64xi32>
+    %22 = tt.load %21 {cache = 1 : i32, evict = 1 : i32, isVolatile = false}: tensor<64x64xf32>
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32>
+    %30 = tt.dot %12, %22, %cst {allowTF32 = false} : tensor<64x64xf32> * tensor<64x64xf32> -> tensor<64x64xf32>
+    // epilogue: activation and truncation
+    %31 = math.exp %30 : tensor<64x64xf32>
+    %32 = arith.truncf %31 : tensor<64x64xf32> to tensor<64x64xbf16>
+    %40 = tt.splat %arg2 : (!tt.ptr<bf16>) -> tensor<64x64x!tt.ptr<bf16>>
+    %41 = tt.addptr %40, %7 : tensor<64x64x!tt.ptr<bf16>>, tensor<64x64xi32>
+    tt.store %41, %32 : tensor<64x64xbf16>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[A:.*]] = bufferization.to_tensor
+// CHECK:           %[[B:.*]] = bufferization.to_tensor
+// CHECK:           %[[RES:.*]] = scf.for %[[I:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%{{.*}} = %{{.*}}) -> (tensor<64x64xbf16>) {
+// CHECK:             scf.for %[[J:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[OUT:.*]] = %{{.*}}) -> (tensor<64x64xbf16>) {
+// CHECK:               %[[A_TILE:.*]] = tensor.extract_slice %[[A]]{{\[}}%[[I]], 0] [32, 64] [1, 1]
+// CHECK:               %[[B_TILE:.*]] = tensor.extract_slice %[[B]][0, %[[J]]] [64, 32] [1, 1]
+// CHECK:               %[[ACC:.*]] = linalg.fill ins(%{{.*}} : f32) outs(%{{.*}} : tensor<32x32xf32>) -> tensor<32x32xf32>
+// CHECK:               %[[MATMUL:.*]] = linalg.matmul ins(%[[A_TILE]], %[[B_TILE]] : tensor<32x64xf32>, tensor<64x32xf32>) outs(%[[ACC]] : tensor<32x32xf32>) -> tensor<32x32xf32>
+// CHECK:               math.exp
+// CHECK:               arith.truncf
+// CHECK:               tensor.insert_slice %{{.*}} into %[[OUT]]{{\[}}%[[I]], %[[J]]] [32, 32] [1, 1]
+// CHECK:           memref.tensor_store %[[RES]]
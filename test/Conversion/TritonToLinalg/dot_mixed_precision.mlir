@@ -0,0 +1,84 @@
+// RUN: triton-opt --split-input-file --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @bf16_dot_f32(
+    %arg0 : !tt.ptr<bf16>,
+    %arg1 : !tt.ptr<bf16>,
+    %arg2 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+    %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<64xi32>) -> tensor<64x1xi32>
+    %c64 = arith.constant 64 : i32
+    %2 = tt.splat %c64 : (i32) -> tensor<64x1xi32>
+    %3 = arith.muli %1, %2 : tensor<64x1xi32>
+    %4 = tt.broadcast %3 : (tensor<64x1xi32>) -> tensor<64x64xi32>
+    %5 = tt.expand_dims %0 {axis = 0 : i32} : (tensor<64xi32>) -> tensor<1x64xi32>
+    %6 = tt.broadcast %5 : (tensor<1x64xi32>) -> tensor<64x64xi32>
+    %7 = arith.addi %4, %6 : tensor<64x64xi32>
+    %8 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<64x64x!tt.ptr<bf16>>
+    %9 = tt.addptr %8, %7 : tensor<64x64x!tt.ptr<bf16>>, tensor<64x64xi32>
+    %10 = tt.load %9 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xbf16>
+    %11 = tt.splat %arg1 : (!tt.ptr<bf16>) -> tensor<64x64x!tt.ptr<bf16>>
+    %12 = tt.addptr %11, %7 : tensor<64x64x!tt.ptr<bf16>>, tensor<64x64xi32>
+    %13 = tt.load %12 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xbf16>
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32>
+    %14 = tt.dot %10, %13, %cst {allowTF32 = false} : tensor<64x64xbf16> * tensor<64x64xbf16> -> tensor<64x64xf32>
+    %15 = tt.splat %arg2 : (!tt.ptr<f32>) -> tensor<64x64x!tt.ptr<f32>>
+    %16 = tt.addptr %15, %7 : tensor<64x64x!tt.ptr<f32>>, tensor<64x64xi32>
+    tt.store %16, %14 : tensor<64x64xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @bf16_dot_f32(
+// CHECK:           %[[ZERO:.*]] = arith.constant 0.000000e+00 : f32
+// CHECK:           %[[FILL:.*]] = linalg.fill ins(%[[ZERO]] : f32) outs(%{{.*}} : tensor<64x64xf32>) -> tensor<64x64xf32>
+// CHECK:           %[[RES:.*]] = linalg.matmul ins(%{{.*}}, %{{.*}} : tensor<64x64xbf16>, tensor<64x64xbf16>) outs(%[[FILL]] : tensor<64x64xf32>) -> tensor<64x64xf32>
+// CHECK:           memref.tensor_store %[[RES]], %{{.*}} : memref<64x64xf32, strided<[?, 1]>>
+
+// -----
+
+module {
+  tt.func @i8_dot_i32_zero_points(
+    %arg0 : !tt.ptr<i8>,
+    %arg1 : !tt.ptr<i8>,
+    %arg2 : !tt.ptr<i32>,
+    %arg3 : i32,
+    %arg4 : i32
+  )
+  {
+    %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+    %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<64xi32>) -> tensor<64x1xi32>
+    %c64 = arith.constant 64 : i32
+    %2 = tt.splat %c64 : (i32) -> tensor<64x1xi32>
+    %3 = arith.muli %1, %2 : tensor<64x1xi32>
+    %4 = tt.broadcast %3 : (tensor<64x1xi32>) -> tensor<64x64xi32>
+    %5 = tt.expand_dims %0 {axis = 0 : i32} : (tensor<64xi32>) -> tensor<1x64xi32>
+    %6 = tt.broadcast %5 : (tensor<1x64xi32>) -> tensor<64x64xi32>
+    %7 = arith.addi %4, %6 : tensor<64x64xi32>
+    %8 = tt.splat %arg0 : (!tt.ptr<i8>) -> tensor<64x64x!tt.ptr<i8>>
+    %9 = tt.addptr %8, %7 : tensor<64x64x!tt.ptr<i8>>, tensor<64x64xi32>
+    %10 = tt.load %9 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xi8>
+    %11 = tt.splat %arg1 : (!tt.ptr<i8>) -> tensor<64x64x!tt.ptr<i8>>
+    %12 = tt.addptr %11, %7 : tensor<64x64x!tt.ptr<i8>>, tensor<64x64xi32>
+    %13 = tt.load %12 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xi8>
+    %14 = arith.extsi %10 : tensor<64x64xi8> to tensor<64x64xi32>
+    %15 = tt.splat %arg3 : (i32) -> tensor<64x64xi32>
+    %16 = arith.subi %14, %15 : tensor<64x64xi32>
+    %17 = arith.extsi %13 : tensor<64x64xi8> to tensor<64x64xi32>
+    %18 = tt.splat %arg4 : (i32) -> tensor<64x64xi32>
+    %19 = arith.subi %17, %18 : tensor<64x64xi32>
+    %cst = arith.constant dense<0> : tensor<64x64xi32>
+    %20 = tt.dot %16, %19, %cst {allowTF32 = false} : tensor<64x64xi32> * tensor<64x64xi32> -> tensor<64x64xi32>
+    %21 = tt.splat %arg2 : (!tt.ptr<i32>) -> tensor<64x64x!tt.ptr<i32>>
+    %22 = tt.addptr %21, %7 : tensor<64x64x!tt.ptr<i32>>, tensor<64x64xi32>
+    tt.store %22, %20 : tensor<64x64xi32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @i8_dot_i32_zero_points(
+// CHECK-SAME:                      %{{.*}}: memref<*xi8>, %{{.*}}: memref<*xi8>, %{{.*}}: memref<*xi32>, %[[ZP_A:.*]]: i32, %[[ZP_B:.*]]: i32,
+// CHECK:           %[[A:.*]] = bufferization.to_tensor %{{.*}} : memref<64x64xi8>
+// CHECK:           %[[B:.*]] = bufferization.to_tensor %{{.*}} : memref<64x64xi8>
+// CHECK:           %[[FILL:.*]] = linalg.fill ins(%{{.*}} : i32) outs(%{{.*}} : tensor<64x64xi32>) -> tensor<64x64xi32>
+// CHECK:           %[[RES:.*]] = linalg.quantized_matmul ins(%[[A]], %[[B]], %[[ZP_A]], %[[ZP_B]] : tensor<64x64xi8>, tensor<64x64xi8>, i32, i32) outs(%[[FILL]] : tensor<64x64xi32>) -> tensor<64x64xi32>
+// CHECK:           memref.tensor_store %[[RES]], %{{.*}} : memref<64x64xi32, strided<[?, 1]>>
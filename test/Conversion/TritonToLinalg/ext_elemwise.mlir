@@ -0,0 +1,33 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    // known libdevice function
+    %4 = tt.ext_elemwise %3 {libname = "libdevice", libpath = "", symbol = "__nv_expf"} : tensor<128xf32> -> tensor<128xf32>
+    // unknown function, called per element
+    %5 = tt.ext_elemwise %4, %3 {libname = "libdevice", libpath = "", symbol = "__nv_fdimf"} : tensor<128xf32>, tensor<128xf32> -> tensor<128xf32>
+    %6 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %7 = tt.addptr %6, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    tt.store %7, %5 : tensor<128xf32>
+    tt.return
+  }
+}
+// CHECK:         func.func private @__nv_fdimf(f32, f32) -> f32
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[LOAD:.*]] = bufferization.to_tensor
+// CHECK:           %[[EXP:.*]] = linalg.generic {{.*}} ins(%[[LOAD]] : tensor<128xf32>)
+// CHECK:           ^bb0(%[[IN:.*]]: f32, %{{.*}}: f32):
+// CHECK:             %[[E:.*]] = math.exp %[[IN]] : f32
+// CHECK:             linalg.yield %[[E]] : f32
+// CHECK:           %[[FDIM:.*]] = linalg.generic {{.*}} ins(%[[EXP]], %[[LOAD]] : tensor<128xf32>, tensor<128xf32>)
+// CHECK:           ^bb0(%[[A:.*]]: f32, %[[B:.*]]: f32, %{{.*}}: f32):
+// CHECK:             %[[D:.*]] = func.call @__nv_fdimf(%[[A]], %[[B]]) : (f32, f32) -> f32
+// CHECK:             linalg.yield %[[D]] : f32
+// CHECK:           memref.tensor_store %[[FDIM]]
@@ -0,0 +1,30 @@
+// RUN: triton-opt --triton-to-linalg="fold-splat-constants=true" %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    // the scale is only read by the multiplication
+    %scale = arith.constant dense<2.000000e+00> : tensor<128xf32>
+    %4 = arith.mulf %scale, %3 : tensor<128xf32>
+    %5 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %6 = tt.addptr %5, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    tt.store %6, %4 : tensor<128xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-DAG:       %[[SCALE:.*]] = arith.constant 2.000000e+00 : f32
+// CHECK-NOT:       linalg.fill
+// CHECK:           %[[LOAD:.*]] = bufferization.to_tensor
+// CHECK:           %[[MUL:.*]] = linalg.generic {{.*}} ins(%[[LOAD]] : tensor<128xf32>) outs(%{{.*}} : tensor<128xf32>) {
+// CHECK:           ^bb0(%[[IN:.*]]: f32, %{{.*}}: f32):
+// CHECK:             %[[RES:.*]] = arith.mulf %[[SCALE]], %[[IN]] : f32
+// CHECK:             linalg.yield %[[RES]] : f32
+// CHECK:           } -> tensor<128xf32>
+// CHECK:           memref.tensor_store %[[MUL]]
@@ -0,0 +1,83 @@
+// RUN: triton-opt --split-input-file --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @fp8e4_to_f32(%arg0 : !tt.ptr<f8E4M3FN>, %arg1 : !tt.ptr<f32>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f8E4M3FN>) -> tensor<128x!tt.ptr<f8E4M3FN>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f8E4M3FN>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf8E4M3FN>
+    %4 = tt.fp_to_fp %3 : tensor<128xf8E4M3FN> -> tensor<128xf32>
+    %5 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %6 = tt.addptr %5, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    tt.store %6, %4 : tensor<128xf32>
+    tt.return
+  }
+}
+// The tile is loaded as fp8 and decoded to f16 in the body of the cast
+// CHECK-LABEL:   func.func @fp8e4_to_f32(
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<128xf8E4M3FN>
+// CHECK:           %[[LOAD:.*]] = bufferization.to_tensor %[[ALLOC]]
+// CHECK:           %[[CAST:.*]] = linalg.generic {{.*}} ins(%[[LOAD]] : tensor<128xf8E4M3FN>) outs(%{{.*}} : tensor<128xf32>)
+// CHECK:           ^bb0(%[[IN:.*]]: f8E4M3FN, %{{.*}}: f32):
+// CHECK:             %[[BYTE:.*]] = arith.bitcast %[[IN]] : f8E4M3FN to i8
+// CHECK:             %[[EXT:.*]] = arith.extui %[[BYTE]] : i8 to i16
+// CHECK:             %[[HIGH:.*]] = arith.shli %[[EXT]]
+// CHECK:             %[[SIGN:.*]] = arith.andi %[[HIGH]]
+// CHECK:             %[[MAG:.*]] = arith.andi %[[HIGH]]
+// CHECK:             %[[SHR:.*]] = arith.shrui %[[MAG]]
+// CHECK:             %[[BIASED:.*]] = arith.addi %[[SHR]]
+// CHECK:             %[[BITS:.*]] = arith.ori %[[BIASED]], %[[SIGN]] : i16
+// CHECK:             %[[HALF:.*]] = arith.bitcast %[[BITS]] : i16 to f16
+// CHECK:             %[[F32:.*]] = arith.extf %[[HALF]] : f16 to f32
+// CHECK:             linalg.yield %[[F32]] : f32
+// CHECK:           memref.tensor_store %[[CAST]]
+
+// -----
+
+module {
+  tt.func @f32_to_fp8e5(%arg0 : !tt.ptr<f32>, %arg1 : !tt.ptr<f8E5M2>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    %4 = tt.fp_to_fp %3 : tensor<128xf32> -> tensor<128xf8E5M2>
+    %5 = tt.splat %arg1 : (!tt.ptr<f8E5M2>) -> tensor<128x!tt.ptr<f8E5M2>>
+    %6 = tt.addptr %5, %0 : tensor<128x!tt.ptr<f8E5M2>>, tensor<128xi32>
+    tt.store %6, %4 : tensor<128xf8E5M2>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @f32_to_fp8e5(
+// CHECK:           linalg.generic
+// CHECK:           ^bb0(%[[IN:.*]]: f32, %{{.*}}: f8E5M2):
+// CHECK:             %[[HALF:.*]] = arith.truncf %[[IN]] : f32 to f16
+// CHECK:             %[[BITS:.*]] = arith.bitcast %[[HALF]] : f16 to i16
+// CHECK:             %[[SIGN:.*]] = arith.andi %[[BITS]]
+// CHECK:             %[[MAG:.*]] = arith.andi %[[BITS]]
+// CHECK:             %[[ROUNDED:.*]] = arith.addi %[[MAG]]
+// CHECK:             %[[SIGNED:.*]] = arith.ori %[[ROUNDED]], %[[SIGN]] : i16
+// CHECK:             %[[HIGH:.*]] = arith.shrui %[[SIGNED]]
+// CHECK:             %[[BYTE:.*]] = arith.trunci %[[HIGH]] : i16 to i8
+// CHECK:             %[[FP8:.*]] = arith.bitcast %[[BYTE]] : i8 to f8E5M2
+// CHECK:             linalg.yield %[[FP8]] : f8E5M2
+// CHECK:           memref.tensor_store
+
+// -----
+
+module {
+  tt.func @bf16_to_f16(%arg0 : !tt.ptr<bf16>, %arg1 : !tt.ptr<f16>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xbf16>
+    %4 = tt.fp_to_fp %3 : tensor<128xbf16> -> tensor<128xf16>
+    %5 = tt.splat %arg1 : (!tt.ptr<f16>) -> tensor<128x!tt.ptr<f16>>
+    %6 = tt.addptr %5, %0 : tensor<128x!tt.ptr<f16>>, tensor<128xi32>
+    tt.store %6, %4 : tensor<128xf16>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @bf16_to_f16(
+// CHECK:           ^bb0(%[[IN:.*]]: bf16, %{{.*}}: f16):
+// CHECK:             %[[F32:.*]] = arith.extf %[[IN]] : bf16 to f32
+// CHECK:             %[[F16:.*]] = arith.truncf %[[F32]] : f32 to f16
+// CHECK:             linalg.yield %[[F16]] : f16
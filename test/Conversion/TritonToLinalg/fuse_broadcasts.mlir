@@ -0,0 +1,46 @@
+// RUN: triton-opt --triton-to-linalg="fuse-broadcasts=true" %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>,
+    %arg2 : !tt.ptr<f32>
+  )
+  {
+    // row = load %arg0[0:128], shape 128x1
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    %4 = tt.expand_dims %3 {axis = 1 : i32} : (tensor<128xf32>) -> tensor<128x1xf32>
+    // tile = load %arg1[0:128, 0:64], strides [64, 1]
+    %5 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<128xi32>) -> tensor<128x1xi32>
+    %c64 = arith.constant 64 : i32
+    %6 = tt.splat %c64 : (i32) -> tensor<128x1xi32>
+    %7 = arith.muli %5, %6 : tensor<128x1xi32>
+    %8 = tt.broadcast %7 : (tensor<128x1xi32>) -> tensor<128x64xi32>
+    %9 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+    %10 = tt.expand_dims %9 {axis = 0 : i32} : (tensor<64xi32>) -> tensor<1x64xi32>
+    %11 = tt.broadcast %10 : (tensor<1x64xi32>) -> tensor<128x64xi32>
+    %12 = arith.addi %8, %11 : tensor<128x64xi32>
+    %13 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x64x!tt.ptr<f32>>
+    %14 = tt.addptr %13, %12 : tensor<128x64x!tt.ptr<f32>>, tensor<128x64xi32>
+    %15 = tt.load %14 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x64xf32>
+    // the broadcast row is only consumed by the subtraction
+    %16 = tt.broadcast %4 : (tensor<128x1xf32>) -> tensor<128x64xf32>
+    %17 = arith.subf %15, %16 : tensor<128x64xf32>
+    %18 = tt.splat %arg2 : (!tt.ptr<f32>) -> tensor<128x64x!tt.ptr<f32>>
+    %19 = tt.addptr %18, %12 : tensor<128x64x!tt.ptr<f32>>, tensor<128x64xi32>
+    tt.store %19, %17 : tensor<128x64xf32>
+    tt.return
+  }
+}
+// CHECK-DAG:   [[MAP_0_:#.+]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG:   [[MAP_1_:#.+]] = affine_map<(d0, d1) -> (d0, 0)>
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[ROW:.*]] = bufferization.to_tensor
+// CHECK:           %[[EXPANDED:.*]] = tensor.expand_shape %[[ROW]] {{\[}}[0, 1]] : tensor<128xf32> into tensor<128x1xf32>
+// CHECK:           %[[TILE:.*]] = bufferization.to_tensor
+// CHECK-NOT:       broadcastDims
+// CHECK:           %[[SUB:.*]] = linalg.generic {indexing_maps = {{\[}}[[MAP_0_]], [[MAP_1_]], [[MAP_0_]]], iterator_types = ["parallel", "parallel"]} ins(%[[TILE]], %[[EXPANDED]] : tensor<128x64xf32>, tensor<128x1xf32>)
+// CHECK:             arith.subf
+// CHECK:           memref.tensor_store %[[SUB]]
@@ -0,0 +1,52 @@
+// RUN: triton-opt --triton-linalg-fuse-elementwise="bufferize=false" %s | FileCheck %s
+// RUN: triton-opt --triton-linalg-fuse-elementwise %s | FileCheck %s --check-prefix=BUF
+#map = affine_map<(d0) -> (d0)>
+module {
+  func.func @kernel(%arg0: memref<*xf32>, %arg1: memref<*xf32>, %arg2: i32, %arg3: i32, %arg4: i32) {
+    %cst = arith.constant 5.000000e-01 : f32
+    %0 = memref.reinterpret_cast %arg0 to offset: [0], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1]>>
+    %alloc = memref.alloc() : memref<128xf32>
+    memref.copy %0, %alloc : memref<128xf32, strided<[1]>> to memref<128xf32>
+    %1 = bufferization.to_tensor %alloc restrict writable : memref<128xf32>
+    %2 = tensor.empty() : tensor<128xf32>
+    %3 = linalg.fill ins(%cst : f32) outs(%2 : tensor<128xf32>) -> tensor<128xf32>
+    %4 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins(%1, %3 : tensor<128xf32>, tensor<128xf32>) outs(%1 : tensor<128xf32>) {
+    ^bb0(%in: f32, %in_0: f32, %out: f32):
+      %8 = arith.mulf %in, %in_0 : f32
+      linalg.yield %8 : f32
+    } -> tensor<128xf32>
+    %5 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]} ins(%4 : tensor<128xf32>) outs(%4 : tensor<128xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %8 = math.tanh %in : f32
+      linalg.yield %8 : f32
+    } -> tensor<128xf32>
+    %6 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins(%5, %1 : tensor<128xf32>, tensor<128xf32>) outs(%5 : tensor<128xf32>) {
+    ^bb0(%in: f32, %in_0: f32, %out: f32):
+      %8 = arith.addf %in, %in_0 : f32
+      linalg.yield %8 : f32
+    } -> tensor<128xf32>
+    %7 = memref.reinterpret_cast %arg1 to offset: [0], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1]>>
+    memref.tensor_store %6, %7 : memref<128xf32, strided<[1]>>
+    return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[LOADED:.*]] = bufferization.to_tensor
+// CHECK:           %[[FUSED:.*]] = linalg.generic
+// CHECK-SAME:        ins(%[[LOADED]]
+// CHECK:             arith.mulf
+// CHECK:             math.tanh
+// CHECK:             arith.addf
+// CHECK:             linalg.yield
+// CHECK-NOT:       linalg.generic
+// CHECK:           memref.tensor_store %[[FUSED]]
+
+// BUF-LABEL:   func.func @kernel(
+// BUF-NOT:       tensor<
+// BUF:           linalg.generic
+// BUF-SAME:        memref<128xf32>
+// BUF:             arith.mulf
+// BUF:             math.tanh
+// BUF:             arith.addf
+// BUF-NOT:       linalg.generic
+// BUF:           return
@@ -0,0 +1,62 @@
+// RUN: triton-opt --triton-to-linalg="row-reduction-tile-size=2 in-place-stores=true" %s | FileCheck %s
+// RUN: triton-opt --triton-to-linalg="row-reduction-tile-size=2" --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+module {
+  tt.func @softmax_rows(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>) {
+    // offsets of a row-major 8x128 block
+    %rows = tt.make_range {end = 8 : i32, start = 0 : i32} : tensor<8xi32>
+    %rows1 = tt.expand_dims %rows {axis = 1 : i32} : (tensor<8xi32>) -> tensor<8x1xi32>
+    %c128 = arith.constant dense<128> : tensor<8x1xi32>
+    %rows2 = arith.muli %rows1, %c128 : tensor<8x1xi32>
+    %rows3 = tt.broadcast %rows2 : (tensor<8x1xi32>) -> tensor<8x128xi32>
+    %cols = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %cols1 = tt.expand_dims %cols {axis = 0 : i32} : (tensor<128xi32>) -> tensor<1x128xi32>
+    %cols2 = tt.broadcast %cols1 : (tensor<1x128xi32>) -> tensor<8x128xi32>
+    %offs = arith.addi %rows3, %cols2 : tensor<8x128xi32>
+    %in = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<8x128x!tt.ptr<f32>>
+    %inptrs = tt.addptr %in, %offs : tensor<8x128x!tt.ptr<f32>>, tensor<8x128xi32>
+    %x = tt.load %inptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8x128xf32>
+    // softmax of each row
+    %max = "tt.reduce"(%x) ({
+    ^bb0(%a: f32, %b: f32):
+      %m = arith.maxf %a, %b : f32
+      tt.reduce.return %m : f32
+    }) {axis = 1 : i32} : (tensor<8x128xf32>) -> tensor<8xf32>
+    %max1 = tt.expand_dims %max {axis = 1 : i32} : (tensor<8xf32>) -> tensor<8x1xf32>
+    %max2 = tt.broadcast %max1 : (tensor<8x1xf32>) -> tensor<8x128xf32>
+    %sub = arith.subf %x, %max2 : tensor<8x128xf32>
+    %exp = math.exp %sub : tensor<8x128xf32>
+    %sum = "tt.reduce"(%exp) ({
+    ^bb0(%a: f32, %b: f32):
+      %s = arith.addf %a, %b : f32
+      tt.reduce.return %s : f32
+    }) {axis = 1 : i32} : (tensor<8x128xf32>) -> tensor<8xf32>
+    %sum1 = tt.expand_dims %sum {axis = 1 : i32} : (tensor<8xf32>) -> tensor<8x1xf32>
+    %sum2 = tt.broadcast %sum1 : (tensor<8x1xf32>) -> tensor<8x128xf32>
+    %y = arith.divf %exp, %sum2 : tensor<8x128xf32>
+    %out = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<8x128x!tt.ptr<f32>>
+    %outptrs = tt.addptr %out, %offs : tensor<8x128x!tt.ptr<f32>>, tensor<8x128xi32>
+    tt.store %outptrs, %y : tensor<8x128xf32>
+    tt.return
+  }
+}
+// Both reductions, the exp and the divide run on two rows at a time, which
+// are written straight into the destination
+// CHECK-LABEL:   func.func @softmax_rows(
+// CHECK:           %[[X:.*]] = bufferization.to_tensor %{{.*}}: memref<8x128xf32>{{$}}
+// CHECK:           %[[DST:.*]] = bufferization.to_tensor %{{.*}} restrict writable : memref<8x128xf32, strided<{{.*}}>>
+// CHECK:           %[[RES:.*]] = scf.for %[[I:.*]] = %{{.*}} to %{{.*}} step %{{.*}} iter_args(%[[OUT:.*]] = %[[DST]]) -> (tensor<8x128xf32>) {
+// CHECK:             %[[X_ROWS:.*]] = tensor.extract_slice %[[X]]{{\[}}%[[I]], 0] [2, 128] [1, 1]
+// CHECK:             linalg.transpose ins(%[[X_ROWS]] : tensor<2x128xf32>)
+// CHECK:             linalg.reduce
+// CHECK:             arith.maxf
+// CHECK:             math.exp
+// CHECK:             linalg.reduce
+// CHECK:             arith.addf
+// CHECK:             arith.divf
+// CHECK:             tensor.insert_slice %{{.*}} into %[[OUT]]{{\[}}%[[I]], 0] [2, 128] [1, 1]
+// CHECK:           }
+// CHECK-NOT:       linalg.reduce
+// CHECK:           memref.tensor_store %[[RES]]
+
+// STATS: TritonToLinalg
+// STATS: 1 fused-row-reductions
@@ -0,0 +1,60 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+// Embedding lookup: row i of the output is row idx[i] of the table.
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<i32>,
+  %arg1 : !tt.ptr<f32>,
+  %arg2 : !tt.ptr<f32>,
+  %arg3 : i32
+  )
+  {
+    %0 = tt.make_range {end = 4 : i32, start = 0 : i32} : tensor<4xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<i32>) -> tensor<4x!tt.ptr<i32>>
+    %2 = tt.addptr %1, %0 : tensor<4x!tt.ptr<i32>>, tensor<4xi32>
+    %idx = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<4xi32>
+    // table offsets: idx[:, None] * stride + cols[None, :]
+    %3 = tt.expand_dims %idx {axis = 1 : i32} : (tensor<4xi32>) -> tensor<4x1xi32>
+    %4 = tt.splat %arg3 : (i32) -> tensor<4x1xi32>
+    %5 = arith.muli %3, %4 : tensor<4x1xi32>
+    %6 = tt.broadcast %5 : (tensor<4x1xi32>) -> tensor<4x64xi32>
+    %7 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+    %8 = tt.expand_dims %7 {axis = 0 : i32} : (tensor<64xi32>) -> tensor<1x64xi32>
+    %9 = tt.broadcast %8 : (tensor<1x64xi32>) -> tensor<4x64xi32>
+    %10 = arith.addi %6, %9 : tensor<4x64xi32>
+    %11 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<4x64x!tt.ptr<f32>>
+    %12 = tt.addptr %11, %10 : tensor<4x64x!tt.ptr<f32>>, tensor<4x64xi32>
+    %13 = tt.load %12 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<4x64xf32>
+    // output offsets: rows[:, None] * 64 + cols[None, :]
+    %14 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<4xi32>) -> tensor<4x1xi32>
+    %c64 = arith.constant 64 : i32
+    %15 = tt.splat %c64 : (i32) -> tensor<4x1xi32>
+    %16 = arith.muli %14, %15 : tensor<4x1xi32>
+    %17 = tt.broadcast %16 : (tensor<4x1xi32>) -> tensor<4x64xi32>
+    %18 = arith.addi %17, %9 : tensor<4x64xi32>
+    %19 = tt.splat %arg2 : (!tt.ptr<f32>) -> tensor<4x64x!tt.ptr<f32>>
+    %20 = tt.addptr %19, %18 : tensor<4x64x!tt.ptr<f32>>, tensor<4x64xi32>
+    tt.store %20, %13 : tensor<4x64xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xi32>, %[[VAL_1:.*]]: memref<*xf32>, %[[VAL_2:.*]]: memref<*xf32>, %[[VAL_3:.*]]: i32,
+// CHECK:           %[[IDX_VIEW:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: [0], sizes: [4], strides: [1] : memref<*xi32> to memref<4xi32, strided<[1]>>
+// CHECK:           %[[IDX_ALLOC:.*]] = memref.alloc() : memref<4xi32>
+// CHECK:           memref.copy %[[IDX_VIEW]], %[[IDX_ALLOC]] : memref<4xi32, strided<[1]>> to memref<4xi32>
+// CHECK:           %[[IDX:.*]] = bufferization.to_tensor %[[IDX_ALLOC]] : memref<4xi32>
+// CHECK:           %[[STRIDE:.*]] = arith.index_cast %[[VAL_3]] : i32 to index
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<4x64xf32>
+// CHECK:           scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} {
+// CHECK:             %[[ELEM:.*]] = tensor.extract %[[IDX]]{{\[}}%[[IV]]] : tensor<4xi32>
+// CHECK:             %[[ROW:.*]] = arith.index_cast %[[ELEM]] : i32 to index
+// CHECK:             %[[OFFSET:.*]] = arith.muli %[[STRIDE]], %[[ROW]] : index
+// CHECK:             %[[SRC:.*]] = memref.reinterpret_cast %[[VAL_1]] to offset: {{\[}}%[[OFFSET]]], sizes: [1, 64], strides: [1, 1] : memref<*xf32> to memref<1x64xf32, strided<[1, 1], offset: ?>>
+// CHECK:             %[[DST:.*]] = memref.subview %[[ALLOC]]{{\[}}%[[IV]], 0] [1, 64] [1, 1] : memref<4x64xf32> to memref<1x64xf32, strided<[64, 1], offset: ?>>
+// CHECK:             memref.copy %[[SRC]], %[[DST]] : memref<1x64xf32, strided<[1, 1], offset: ?>> to memref<1x64xf32, strided<[64, 1], offset: ?>>
+// CHECK:           }
+// CHECK:           %[[DATA:.*]] = bufferization.to_tensor %[[ALLOC]] : memref<4x64xf32>
+// CHECK:           %[[OUT:.*]] = memref.reinterpret_cast %[[VAL_2]] to offset: [0], sizes: [4, 64], strides: [64, 1] : memref<*xf32> to memref<4x64xf32, strided<[64, 1]>>
+// CHECK:           memref.tensor_store %[[DATA]], %[[OUT]] : memref<4x64xf32, strided<[64, 1]>>
+// CHECK:           return
+// CHECK:         }
@@ -0,0 +1,34 @@
+// RUN: triton-opt --triton-to-linalg --triton-linalg-grid-launcher %s | FileCheck %s
+// RUN: triton-opt --triton-to-linalg --triton-linalg-grid-launcher --triton-linalg-grid-launcher %s | FileCheck %s --check-prefix=TWICE
+module {
+  tt.func @kernel(%arg0 : !tt.ptr<f32>, %arg1 : f32) {
+    %0 = tt.get_program_id {axis = 0 : i32} : i32
+    %1 = tt.addptr %arg0, %0 : !tt.ptr<f32>, i32
+    tt.store %1, %arg1 : f32
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %{{.*}}: memref<*xf32>, %{{.*}}: f32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK:           memref.store
+// CHECK:           return
+// CHECK:         }
+// CHECK-LABEL:   func.func @kernel_grid(
+// CHECK-SAME:                           %[[PTR:.*]]: memref<*xf32>, %[[VAL:.*]]: f32, %[[GX:.*]]: i32, %[[GY:.*]]: i32, %[[GZ:.*]]: i32) attributes {GridLauncher} {
+// CHECK-DAG:       %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:       %[[C1:.*]] = arith.constant 1 : index
+// CHECK-DAG:       %[[UX:.*]] = arith.index_cast %[[GX]] : i32 to index
+// CHECK-DAG:       %[[UY:.*]] = arith.index_cast %[[GY]] : i32 to index
+// CHECK-DAG:       %[[UZ:.*]] = arith.index_cast %[[GZ]] : i32 to index
+// CHECK:           scf.parallel (%[[X:.*]], %[[Y:.*]], %[[Z:.*]]) = (%[[C0]], %[[C0]], %[[C0]]) to (%[[UX]], %[[UY]], %[[UZ]]) step (%[[C1]], %[[C1]], %[[C1]]) {
+// CHECK-DAG:         %[[PX:.*]] = arith.index_cast %[[X]] : index to i32
+// CHECK-DAG:         %[[PY:.*]] = arith.index_cast %[[Y]] : index to i32
+// CHECK-DAG:         %[[PZ:.*]] = arith.index_cast %[[Z]] : index to i32
+// CHECK:             func.call @kernel(%[[PTR]], %[[VAL]], %[[PX]], %[[PY]], %[[PZ]]) : (memref<*xf32>, f32, i32, i32, i32) -> ()
+// CHECK:           }
+// CHECK:           return
+// CHECK:         }
+
+// TWICE-COUNT-2:   func.func @
+// TWICE-NOT:       func.func @
+// TWICE-NOT:       _grid_grid
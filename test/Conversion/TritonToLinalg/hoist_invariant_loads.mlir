@@ -0,0 +1,57 @@
+// RUN: triton-opt --triton-to-linalg="hoist-invariant-loads=true" %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>,
+    %arg2 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %cst = arith.constant 0.000000e+00 : f32
+    %acc = tt.splat %cst : (f32) -> tensor<128xf32>
+    %c0 = arith.constant 0 : index
+    %c4 = arith.constant 4 : index
+    %c1 = arith.constant 1 : index
+    %c128 = arith.constant 128 : i32
+    %step = tt.splat %c128 : (i32) -> tensor<128xi32>
+    %sum, %ptr_out = scf.for %i = %c0 to %c4 step %c1 iter_args(%sum_iter = %acc, %ptr_iter = %2) -> (tensor<128xf32>, tensor<128x!tt.ptr<f32>>) {
+      // the tile advances with the loop
+      %3 = tt.load %ptr_iter {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+      // the scales are the same in every iteration
+      %4 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+      %5 = tt.addptr %4, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+      %6 = tt.load %5 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+      %7 = arith.mulf %3, %6 : tensor<128xf32>
+      %sum_next = arith.addf %sum_iter, %7 : tensor<128xf32>
+      %ptr = tt.addptr %ptr_iter, %step : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+      scf.yield %sum_next, %ptr : tensor<128xf32>, tensor<128x!tt.ptr<f32>>
+    }
+    %8 = tt.splat %arg2 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %9 = tt.addptr %8, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    tt.store %9, %sum : tensor<128xf32>
+    tt.return
+  }
+}
+// The scales are loaded once in front of the loop, if it has an iteration.
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[ARG0:.*]]: memref<*xf32>, %[[ARG1:.*]]: memref<*xf32>, %[[ARG2:.*]]: memref<*xf32>, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK:           %[[SCALES_PTR:.*]] = memref.reinterpret_cast %[[ARG1]] to offset: [0], sizes: [128], strides: [1]
+// CHECK:           %[[ANY:.*]] = arith.cmpi slt, %{{.*}}, %{{.*}} : index
+// CHECK:           %[[SCALES:.*]] = scf.if %[[ANY]] -> (tensor<128xf32>) {
+// CHECK:             %[[SCALES_BUF:.*]] = memref.alloc() : memref<128xf32>
+// CHECK:             memref.copy %[[SCALES_PTR]], %[[SCALES_BUF]]
+// CHECK:             %[[LOADED:.*]] = bufferization.to_tensor %[[SCALES_BUF]]
+// CHECK:             scf.yield %[[LOADED]] : tensor<128xf32>
+// CHECK:           } else {
+// CHECK:             %[[ZEROS:.*]] = arith.constant dense<0.000000e+00> : tensor<128xf32>
+// CHECK:             scf.yield %[[ZEROS]] : tensor<128xf32>
+// CHECK:           }
+// CHECK:           scf.for
+// CHECK-NOT:         memref.reinterpret_cast %[[ARG1]]
+// CHECK:             memref.copy
+// CHECK:             %[[TILE:.*]] = bufferization.to_tensor
+// CHECK:             linalg.generic {{.*}} ins(%[[TILE]], %[[SCALES]] : tensor<128xf32>, tensor<128xf32>)
+// CHECK:             arith.mulf
+// CHECK:           }
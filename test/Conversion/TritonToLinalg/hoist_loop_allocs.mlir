@@ -0,0 +1,44 @@
+// RUN: triton-opt --triton-to-linalg="hoist-loop-allocs=true" %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %cst = arith.constant 0.000000e+00 : f32
+    %acc = tt.splat %cst : (f32) -> tensor<128xf32>
+    %c0 = arith.constant 0 : index
+    %c4 = arith.constant 4 : index
+    %c1 = arith.constant 1 : index
+    %c128 = arith.constant 128 : i32
+    %step = tt.splat %c128 : (i32) -> tensor<128xi32>
+    %sum, %tile_out, %ptr_out = scf.for %i = %c0 to %c4 step %c1 iter_args(%sum_iter = %acc, %tile_iter = %acc, %ptr_iter = %2) -> (tensor<128xf32>, tensor<128xf32>, tensor<128x!tt.ptr<f32>>) {
+      // the loaded tile only feeds the sum: its buffer is allocated once
+      %3 = tt.load %ptr_iter {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+      %4 = arith.addf %sum_iter, %3 : tensor<128xf32>
+      %sum_next = arith.addf %4, %tile_iter : tensor<128xf32>
+      // the loaded tile is carried to the next iteration: keep the alloc
+      %5 = tt.load %ptr_iter {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+      %ptr = tt.addptr %ptr_iter, %step : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+      scf.yield %sum_next, %5, %ptr : tensor<128xf32>, tensor<128xf32>, tensor<128x!tt.ptr<f32>>
+    }
+    %6 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %7 = tt.addptr %6, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    tt.store %7, %sum : tensor<128xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[HOISTED:.*]] = memref.alloc() : memref<128xf32>
+// CHECK:           scf.for
+// CHECK-NOT:         memref.alloc() : memref<128xf32>
+// CHECK:             memref.copy %{{.*}}, %[[HOISTED]]
+// CHECK:             bufferization.to_tensor %[[HOISTED]]
+// CHECK:             %[[KEPT:.*]] = memref.alloc() : memref<128xf32>
+// CHECK:             memref.copy %{{.*}}, %[[KEPT]]
+// CHECK:             %[[CARRIED:.*]] = bufferization.to_tensor %[[KEPT]]
+// CHECK:             scf.yield %{{.*}}, %[[CARRIED]]
+// CHECK:           }
@@ -0,0 +1,36 @@
+// RUN: triton-opt --triton-to-linalg="in-place-stores=true" %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>,
+  %arg2 : !tt.ptr<f32>,
+  %arg3 : i32
+  )
+  {
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<1024x!tt.ptr<f32>>, tensor<1024xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32>
+    %4 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>>
+    %5 = tt.addptr %4, %0 : tensor<1024x!tt.ptr<f32>>, tensor<1024xi32>
+    %6 = tt.load %5 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32>
+    %7 = arith.addf %3, %6 : tensor<1024xf32>
+    %8 = tt.splat %arg2 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>>
+    %9 = tt.addptr %8, %0 : tensor<1024x!tt.ptr<f32>>, tensor<1024xi32>
+    %10 = tt.splat %arg3 : (i32) -> tensor<1024xi32>
+    %11 = arith.cmpi slt, %0, %10 : tensor<1024xi32>
+    tt.store %9, %7, %11 : tensor<1024xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[DST:.*]] = memref.reinterpret_cast %{{.*}} to offset: [0], sizes: [1024], strides: [1] : memref<*xf32> to memref<1024xf32, strided<[1]>>
+// CHECK:           %[[SUBVIEW:.*]] = memref.subview %[[DST]][0] [%[[DIM:.*]]] [1] : memref<1024xf32, strided<[1]>> to memref<?xf32, strided<[1]>>
+// CHECK-DAG:       %[[LHS:.*]] = tensor.extract_slice %{{.*}}[0] [%[[DIM]]] [1] : tensor<1024xf32> to tensor<?xf32>
+// CHECK-DAG:       %[[RHS:.*]] = tensor.extract_slice %{{.*}}[0] [%[[DIM]]] [1] : tensor<1024xf32> to tensor<?xf32>
+// CHECK-DAG:       %[[INIT:.*]] = bufferization.to_tensor %[[SUBVIEW]] restrict writable : memref<?xf32, strided<[1]>>
+// CHECK:           %[[RES:.*]] = linalg.generic {{.*}} ins(%[[LHS]], %[[RHS]] : tensor<?xf32>, tensor<?xf32>) outs(%[[INIT]] : tensor<?xf32>)
+// CHECK:             arith.addf
+// CHECK:           } -> tensor<?xf32>
+// CHECK:           memref.tensor_store %[[RES]], %[[SUBVIEW]] : memref<?xf32, strided<[1]>>
+// CHECK:           return
@@ -0,0 +1,48 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>,
+  %arg2 : !tt.ptr<i32>,
+  %arg3 : !tt.ptr<i32>
+  )
+  {
+    // Copy the tokens [start, end) of the tile of a jagged batch this program
+    // is launched for, whose bounds are loaded from the tables of the grid
+    %pid = tt.get_program_id {axis = 0 : i32} : i32
+    %startptr = tt.addptr %arg2, %pid : !tt.ptr<i32>, i32
+    %endptr = tt.addptr %arg3, %pid : !tt.ptr<i32>, i32
+    %start = tt.load %startptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : i32
+    %end = tt.load %endptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : i32
+    %range = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %startsplat = tt.splat %start : (i32) -> tensor<128xi32>
+    %offs = arith.addi %startsplat, %range : tensor<128xi32>
+    %endsplat = tt.splat %end : (i32) -> tensor<128xi32>
+    %mask = arith.cmpi slt, %offs, %endsplat : tensor<128xi32>
+    %0 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %1 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %ldptr = tt.addptr %0, %offs : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %stptr = tt.addptr %1, %offs : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %buff = tt.load %ldptr, %mask {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    tt.store %stptr, %buff, %mask : tensor<128xf32>
+    tt.return
+  }
+}
+// The tile is copied from the loaded start, and only up to the loaded end
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[X:[^:]*]]: memref<*xf32>, %[[Y:[^:]*]]: memref<*xf32>, %[[STARTS:[^:]*]]: memref<*xi32>, %[[ENDS:[^:]*]]: memref<*xi32>,
+// CHECK:           %[[START_VIEW:.*]] = memref.reinterpret_cast %[[STARTS]] to offset: {{\[}}%{{.*}}], sizes: [1], strides: [1]
+// CHECK:           %[[START:.*]] = memref.load %[[START_VIEW]]
+// CHECK:           %[[END_VIEW:.*]] = memref.reinterpret_cast %[[ENDS]] to offset: {{\[}}%{{.*}}], sizes: [1], strides: [1]
+// CHECK:           %[[END:.*]] = memref.load %[[END_VIEW]]
+// CHECK:           %[[START_IDX:.*]] = arith.index_cast %[[START]] : i32 to index
+// CHECK:           %[[LD:.*]] = memref.reinterpret_cast %[[X]] to offset: {{\[}}%[[START_IDX]]], sizes: [128], strides: [1]
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<128xf32>
+// CHECK:           %[[END_IDX:.*]] = arith.index_cast %[[END]] : i32 to index
+// CHECK:           %[[TILE_END:.*]] = arith.minsi %[[END_IDX]], %{{.*}} : index
+// CHECK:           %[[DIM:.*]] = arith.subi %[[TILE_END]], %{{.*}} : index
+// CHECK:           %[[SRC:.*]] = memref.subview %[[LD]][0] {{\[}}%[[DIM]]] [1]
+// CHECK:           %[[DST:.*]] = memref.subview %[[ALLOC]][0] {{\[}}%[[DIM]]] [1]
+// CHECK:           memref.copy %[[SRC]], %[[DST]]
+// CHECK:           memref.tensor_store
+// CHECK:           return
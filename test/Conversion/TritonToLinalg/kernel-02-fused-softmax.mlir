@@ -52,20 +52,13 @@ module {
 // CHECK:           [[VAR_3_:%.+]] = arith.minsi [[VAR_2_]], [[CST_128_]] : index
 // CHECK-DAG:       [[VAR_subview_:%.+]] = memref.subview [[VAR_reinterpret_cast_]][0] {{.}}[[VAR_3_]]{{.}} [1]{{.*}} : memref<128xf32, strided<[1], offset: ?>> to memref<?xf32, strided<[1], offset: ?>>
 // CHECK-DAG:       [[VAR_subview_1_:%.+]] = memref.subview [[RES_]][0] {{.}}[[VAR_3_]]{{.}} [1] : memref<128xf32> to memref<?xf32, strided<[1]>>
-// CHECK-DAG:       [[VAR_4_:%.+]] = arith.cmpi slt, [[VAR_3_]], [[CST_128_]] : index
-// CHECK:           scf.if [[VAR_4_]] {
-// CHECK:             linalg.fill ins([[CST_0_]] : f32) outs([[RES_]] : memref<128xf32>)
-// CHECK:           }
+// CHECK:           [[PAD_SIZE_1:%.+]] = arith.subi [[CST_128_]], [[VAR_3_]] : index
+// CHECK:           [[PAD_1:%.+]] = memref.subview [[RES_]]{{.}}[[VAR_3_]]{{.}} {{.}}[[PAD_SIZE_1]]{{.}} [1] : memref<128xf32> to memref<?xf32, strided<[1], offset: ?>>
+// CHECK:           linalg.fill ins([[CST_0_]] : f32) outs([[PAD_1]] : memref<?xf32, strided<[1], offset: ?>>)
 // CHECK:           memref.copy [[VAR_subview_]], [[VAR_subview_]]_1 : memref<?xf32, strided<[1], offset: ?>> to memref<?xf32, strided<[1]>>
 // CHECK-DAG:       [[VAR_5_:%.+]] = bufferization.to_tensor [[RES_]] restrict writable : memref<128xf32>
-// CHECK-DAG:       [[VAR_6_:%.+]] = bufferization.alloc_tensor() : tensor<f32>
-// CHECK:           [[VAR_inserted_:%.+]] = tensor.insert [[CST_0_]] into [[VAR_6_]][] : tensor<f32>
-// CHECK:           [[VAR_reduced_:%.+]] = linalg.reduce ins([[VAR_5_]] : tensor<128xf32>) outs([[VAR_inserted_]] : tensor<f32>) dimensions = [0]
-// CHECK:             ([[in_1:%.+]]: f32, [[init_1:%.+]]: f32) {
-// CHECK:               [[VAR_19_:%.+]] = arith.maxf [[in_1]], [[init_1]] : f32
-// CHECK:               linalg.yield [[VAR_19_]] : f32
-// CHECK:             }
-// CHECK-DAG:       [[VAR_extracted_:%.+]] = tensor.extract [[VAR_reduced_]][] : tensor<f32>
+// CHECK:           [[VAR_vector_0_:%.+]] = vector.transfer_read [[VAR_5_]]{{.}}%{{.*}}{{.}}, %{{.*}} {in_bounds = [true]} : tensor<128xf32>, vector<128xf32>
+// CHECK-DAG:       [[VAR_extracted_:%.+]] = vector.reduction <maxf>, [[VAR_vector_0_]], [[CST_0_]] : vector<128xf32> into f32
 // CHECK-DAG:       [[VAR_7_:%.+]] = tensor.empty() : tensor<128xf32>
 // CHECK:           [[VAR_8_:%.+]] = linalg.fill ins([[VAR_extracted_]] : f32) outs([[VAR_7_]] : tensor<128xf32>) -> tensor<128xf32>
 // CHECK:           [[VAR_9_:%.+]] = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins([[VAR_5_]], [[VAR_8_]] : tensor<128xf32>, tensor<128xf32>) outs([[VAR_5_]] : tensor<128xf32>) {
@@ -78,14 +71,8 @@ module {
 // CHECK:             [[VAR_19_2_:%.+]] = math.exp [[in_1]] : f32
 // CHECK:             linalg.yield [[VAR_19_2_]] : f32
 // CHECK:           } -> tensor<128xf32>
-// CHECK:           [[VAR_11_:%.+]] = bufferization.alloc_tensor() : tensor<f32>
-// CHECK:           [[VAR_inserted_2_:%.+]] = tensor.insert [[CST_0_dot_000000_]] into [[VAR_11_]][] : tensor<f32>
-// CHECK:           [[VAR_reduced_3_:%.+]] = linalg.reduce ins([[VAR_10_]] : tensor<128xf32>) outs([[VAR_inserted_2_]] : tensor<f32>) dimensions = [0]
-// CHECK:             ([[in_1:%.+]]: f32, [[init_1:%.+]]: f32) {
-// CHECK:               [[VAR_19_3_:%.+]] = arith.addf [[in_1]], [[init_1]] : f32
-// CHECK:               linalg.yield [[VAR_19_3_]] : f32
-// CHECK:             }
-// CHECK-DAG:       [[VAR_extracted_4_:%.+]] = tensor.extract [[VAR_reduced_3_]][] : tensor<f32>
+// CHECK:           [[VAR_vector_1_:%.+]] = vector.transfer_read [[VAR_10_]]{{.}}%{{.*}}{{.}}, %{{.*}} {in_bounds = [true]} : tensor<128xf32>, vector<128xf32>
+// CHECK-DAG:       [[VAR_extracted_4_:%.+]] = vector.reduction <add>, [[VAR_vector_1_]], [[CST_0_dot_000000_]] : vector<128xf32> into f32
 // CHECK-DAG:       [[VAR_12_:%.+]] = tensor.empty() : tensor<128xf32>
 // CHECK:           [[VAR_13_:%.+]] = linalg.fill ins([[VAR_extracted_4_]] : f32) outs([[VAR_12_]] : tensor<128xf32>) -> tensor<128xf32>
 // CHECK:           [[VAR_14_:%.+]] = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins([[VAR_10_]], [[VAR_13_]] : tensor<128xf32>, tensor<128xf32>) outs([[VAR_10_]] : tensor<128xf32>) {
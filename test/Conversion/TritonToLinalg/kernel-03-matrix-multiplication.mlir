@@ -159,18 +159,7 @@ module {
 // CHECK-DAG:         [[RES_1_:%.+]] = memref.alloc() : memref<64x256xbf16>
 // CHECK:             memref.copy [[VAR_arg18_]], [[RES_1_]] : memref<64x256xbf16, strided<[?, ?], offset: ?>> to memref<64x256xbf16>
 // CHECK-DAG:         [[VAR_53_:%.+]] = bufferization.to_tensor [[RES_1_]] restrict writable : memref<64x256xbf16>
-// CHECK-DAG:         [[VAR_54_:%.+]] = tensor.empty() : tensor<128x256xf32>
-// CHECK:             [[VAR_55_:%.+]] = linalg.matmul ins([[VAR_52_]], [[VAR_53_]] : tensor<128x64xbf16>, tensor<64x256xbf16>) outs([[VAR_54_]] : tensor<128x256xf32>) -> tensor<128x256xf32>
-// CHECK:             [[VAR_56_:%.+]] = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins([[VAR_55_]], [[VAR_1_]] : tensor<128x256xf32>, tensor<128x256xf32>) outs([[VAR_55_]] : tensor<128x256xf32>) {
-// CHECK:             ^bb0([[in_0:.+]]: f32, [[in_1:.+]]: f32, [[out:.+]]: f32):
-// CHECK:               [[VAR_64_:%.+]] = arith.addf [[in_0]], [[in_1]] : f32
-// CHECK:               linalg.yield [[VAR_64_]] : f32
-// CHECK:             } -> tensor<128x256xf32>
-// CHECK:             [[VAR_57_:%.+]] = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins([[VAR_arg16_]], [[VAR_56_]] : tensor<128x256xf32>, tensor<128x256xf32>) outs([[VAR_arg16_]] : tensor<128x256xf32>) {
-// CHECK:             ^bb0([[in_0:.+]]: f32, [[in_1:.+]]: f32, [[out:.+]]: f32):
-// CHECK:               [[VAR_64_1_:%.+]] = arith.addf [[in_0]], [[in_1]] : f32
-// CHECK:               linalg.yield [[VAR_64_1_]] : f32
-// CHECK:             } -> tensor<128x256xf32>
+// CHECK:             [[VAR_57_:%.+]] = linalg.matmul ins([[VAR_52_]], [[VAR_53_]] : tensor<128x64xbf16>, tensor<64x256xbf16>) outs([[VAR_arg16_]] : tensor<128x256xf32>) -> tensor<128x256xf32>
 // CHECK:             [[VAR_58_:%.+]] = arith.index_cast [[VAR_28_]] : i32 to index
 // CHECK:             [[VAR_59_:%.+]] = arith.addi [[VAR_arg19_]], [[VAR_58_]] : index
 // CHECK:             [[VAR_60_:%.+]] = arith.addi [[VAR_59_]], [[VAR_arg20_]] : index
@@ -97,12 +97,12 @@ module {
 // CHECK:             [[VAR_36_:%.+]] = arith.minsi [[VAR_34_]], [[CST_256_]] : index
 // CHECK-DAG:         [[VAR_subview_5_:%.+]] = memref.subview [[VAR_reinterpret_cast_4_]][0, 0] {{.}}[[VAR_35_]], [[VAR_36_]]{{.}} [1, 1] : memref<256x256xf32, strided<[?, 1], offset: ?>> to memref<?x?xf32, strided<[?, 1], offset: ?>>
 // CHECK-DAG:         [[VAR_subview_6_:%.+]] = memref.subview [[RES_]][0, 0] {{.}}[[VAR_35_]], [[VAR_36_]]{{.}} [1, 1] : memref<256x256xf32> to memref<?x?xf32, strided<[256, 1]>>
-// CHECK-DAG:         [[VAR_37_:%.+]] = arith.cmpi slt, [[VAR_35_]], [[CST_256_]] : index
-// CHECK-DAG:         [[VAR_38_:%.+]] = arith.cmpi slt, [[VAR_36_]], [[CST_256_]] : index
-// CHECK:             [[VAR_39_:%.+]] = arith.ori [[VAR_37_]], [[VAR_38_]] : i1
-// CHECK:             scf.if [[VAR_39_]] {
-// CHECK:               linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[RES_]] : memref<256x256xf32>)
-// CHECK:             }
+// CHECK:             [[VAR_37_:%.+]] = arith.subi [[CST_256_]], [[VAR_35_]] : index
+// CHECK:             [[VAR_38_:%.+]] = memref.subview [[RES_]]{{.}}[[VAR_35_]], 0] {{.}}[[VAR_37_]], 256] [1, 1] : memref<256x256xf32> to memref<?x256xf32, strided<[256, 1], offset: ?>>
+// CHECK:             linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[VAR_38_]] : memref<?x256xf32, strided<[256, 1], offset: ?>>)
+// CHECK:             [[VAR_39_:%.+]] = arith.subi [[CST_256_]], [[VAR_36_]] : index
+// CHECK:             [[VAR_39_1:%.+]] = memref.subview [[RES_]][0, [[VAR_36_]]{{.}} {{.}}[[VAR_35_]], [[VAR_39_]]{{.}} [1, 1] : memref<256x256xf32> to memref<?x?xf32, strided<[256, 1], offset: ?>>
+// CHECK:             linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[VAR_39_1]] : memref<?x?xf32, strided<[256, 1], offset: ?>>)
 // CHECK:             memref.copy [[VAR_subview_5_]], [[VAR_subview_6_]] : memref<?x?xf32, strided<[?, 1], offset: ?>> to memref<?x?xf32, strided<[256, 1]>>
 // CHECK:             [[VAR_40_:%.+]] = bufferization.to_tensor [[RES_]] restrict writable : memref<256x256xf32>
 // CHECK:             [[VAR_41_:%.+]] = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins([[VAR_arg10_]], [[VAR_40_]] : tensor<256x256xf32>, tensor<256x256xf32>) outs([[VAR_arg10_]] : tensor<256x256xf32>) {
@@ -134,12 +134,12 @@ module {
 // CHECK:             [[VAR_58_:%.+]] = arith.minsi [[VAR_56_]], [[CST_256_]] : index
 // CHECK-DAG:         [[VAR_subview_9_:%.+]] = memref.subview [[VAR_reinterpret_cast_7_]][0, 0] {{.}}[[VAR_57_]], [[VAR_58_]]{{.}} [1, 1] : memref<256x256xf32, strided<[?, 1], offset: ?>> to memref<?x?xf32, strided<[?, 1], offset: ?>>
 // CHECK-DAG:         [[VAR_subview_10_:%.+]] = memref.subview [[RES_1_]][0, 0] {{.}}[[VAR_57_]], [[VAR_58_]]{{.}} [1, 1] : memref<256x256xf32> to memref<?x?xf32, strided<[256, 1]>>
-// CHECK-DAG:         [[VAR_59_:%.+]] = arith.cmpi slt, [[VAR_57_]], [[CST_256_]] : index
-// CHECK-DAG:         [[VAR_60_:%.+]] = arith.cmpi slt, [[VAR_58_]], [[CST_256_]] : index
-// CHECK:             [[VAR_61_:%.+]] = arith.ori [[VAR_59_]], [[VAR_60_]] : i1
-// CHECK:             scf.if [[VAR_61_]] {
-// CHECK:               linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[RES_1_]] : memref<256x256xf32>)
-// CHECK:             }
+// CHECK:             [[VAR_59_:%.+]] = arith.subi [[CST_256_]], [[VAR_57_]] : index
+// CHECK:             [[VAR_60_:%.+]] = memref.subview [[RES_1_]]{{.}}[[VAR_57_]], 0] {{.}}[[VAR_59_]], 256] [1, 1] : memref<256x256xf32> to memref<?x256xf32, strided<[256, 1], offset: ?>>
+// CHECK:             linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[VAR_60_]] : memref<?x256xf32, strided<[256, 1], offset: ?>>)
+// CHECK:             [[VAR_61_:%.+]] = arith.subi [[CST_256_]], [[VAR_58_]] : index
+// CHECK:             [[VAR_61_1:%.+]] = memref.subview [[RES_1_]][0, [[VAR_58_]]{{.}} {{.}}[[VAR_57_]], [[VAR_61_]]{{.}} [1, 1] : memref<256x256xf32> to memref<?x?xf32, strided<[256, 1], offset: ?>>
+// CHECK:             linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[VAR_61_1]] : memref<?x?xf32, strided<[256, 1], offset: ?>>)
 // CHECK:             memref.copy [[VAR_subview_9_]], [[VAR_subview_10_]] : memref<?x?xf32, strided<[?, 1], offset: ?>> to memref<?x?xf32, strided<[256, 1]>>
 // CHECK:             [[VAR_62_:%.+]] = bufferization.to_tensor [[RES_1_]] restrict writable : memref<256x256xf32>
 // CHECK:             [[VAR_63_:%.+]] = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins([[VAR_arg11_]], [[VAR_62_]] : tensor<256x256xf32>, tensor<256x256xf32>) outs([[VAR_arg11_]] : tensor<256x256xf32>) {
@@ -115,10 +115,9 @@ module {
 // CHECK:             [[VAR_32_:%.+]] = arith.subi [[VAR_31_]], [[VAR_28_]] : index
 // CHECK-DAG:         [[VAR_subview_:%.+]] = memref.subview [[VAR_reinterpret_cast_5_]][0] {{.}}[[VAR_32_]]{{.}} [1] : memref<256xf32, strided<[1], offset: ?>> to memref<?xf32, strided<[1], offset: ?>>
 // CHECK-DAG:         [[VAR_subview_6_:%.+]] = memref.subview [[RES_]][0] {{.}}[[VAR_32_]]{{.}} [1] : memref<256xf32> to memref<?xf32, strided<[1]>>
-// CHECK-DAG:         [[VAR_33_:%.+]] = arith.cmpi slt, [[VAR_32_]], [[CST_256_]] : index
-// CHECK:             scf.if [[VAR_33_]] {
-// CHECK:               linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[RES_]] : memref<256xf32>)
-// CHECK:             }
+// CHECK:             [[PAD_SIZE_1:%.+]] = arith.subi [[CST_256_]], [[VAR_32_]] : index
+// CHECK:             [[PAD_1:%.+]] = memref.subview [[RES_]]{{.}}[[VAR_32_]]{{.}} {{.}}[[PAD_SIZE_1]]{{.}} [1] : memref<256xf32> to memref<?xf32, strided<[1], offset: ?>>
+// CHECK:             linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[PAD_1]] : memref<?xf32, strided<[1], offset: ?>>)
 // CHECK:             memref.copy [[VAR_subview_]], [[VAR_subview_]]_6 : memref<?xf32, strided<[1], offset: ?>> to memref<?xf32, strided<[1]>>
 // CHECK:             [[VAR_34_:%.+]] = bufferization.to_tensor [[RES_]] restrict writable : memref<256xf32>
 // CHECK:             [[VAR_35_:%.+]] = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins([[VAR_arg13_]], [[VAR_34_]] : tensor<256xf32>, tensor<256xf32>) outs([[VAR_arg13_]] : tensor<256xf32>) {
@@ -128,14 +127,8 @@ module {
 // CHECK:             } -> tensor<256xf32>
 // CHECK:             scf.yield [[VAR_35_]] : tensor<256xf32>
 // CHECK:           }
-// CHECK:           [[VAR_4_:%.+]] = bufferization.alloc_tensor() : tensor<f32>
-// CHECK:           [[VAR_inserted_:%.+]] = tensor.insert [[CST_0_dot_000000_]] into [[VAR_4_]][] : tensor<f32>
-// CHECK:           [[VAR_reduced_:%.+]] = linalg.reduce ins([[VAR_3_]] : tensor<256xf32>) outs([[VAR_inserted_]] : tensor<f32>) dimensions = [0]
-// CHECK:             ([[in_0:.+]]: f32, [[in_1:.+]]: f32) {
-// CHECK:               [[VAR_25_1_:%.+]] = arith.addf [[in_0]], [[in_1]] : f32
-// CHECK:               linalg.yield [[VAR_25_1_]] : f32
-// CHECK:             }
-// CHECK-DAG:       [[VAR_extracted_:%.+]] = tensor.extract [[VAR_reduced_]][] : tensor<f32>
+// CHECK:           [[VAR_vector_0_:%.+]] = vector.transfer_read [[VAR_3_]]{{.}}%{{.*}}{{.}}, %{{.*}} {in_bounds = [true]} : tensor<256xf32>, vector<256xf32>
+// CHECK-DAG:       [[VAR_extracted_:%.+]] = vector.reduction <add>, [[VAR_vector_0_]], [[CST_0_dot_000000_]] : vector<256xf32> into f32
 // CHECK-DAG:       [[VAR_5_:%.+]] = arith.sitofp [[PARAM_7_]] : i32 to f32
 // CHECK-NOT: separator of consecutive DAGs
 // CHECK-DAG:       [[VAR_6_:%.+]] = arith.divf [[VAR_extracted_]], [[VAR_5_]] : f32
@@ -178,10 +171,9 @@ module {
 // CHECK:             [[VAR_37_:%.+]] = arith.subi [[VAR_36_1_]], [[VAR_33_1_]] : index
 // CHECK-DAG:         [[VAR_subview_1_:%.+]] = memref.subview [[VAR_reinterpret_cast_5_1_]][0] {{.}}[[VAR_37_]]{{.}} [1] : memref<256xf32, strided<[1], offset: ?>> to memref<?xf32, strided<[1], offset: ?>>
 // CHECK-DAG:         [[VAR_subview_6_1_:%.+]] = memref.subview [[RES_1_]][0] {{.}}[[VAR_37_]]{{.}} [1] : memref<256xf32> to memref<?xf32, strided<[1]>>
-// CHECK-DAG:         [[VAR_38_:%.+]] = arith.cmpi slt, [[VAR_37_]], [[CST_256_]] : index
-// CHECK:             scf.if [[VAR_38_]] {
-// CHECK:               linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[RES_1_]] : memref<256xf32>)
-// CHECK:             }
+// CHECK:             [[PAD_SIZE_2:%.+]] = arith.subi [[CST_256_]], [[VAR_37_]] : index
+// CHECK:             [[PAD_2:%.+]] = memref.subview [[RES_1_]]{{.}}[[VAR_37_]]{{.}} {{.}}[[PAD_SIZE_2]]{{.}} [1] : memref<256xf32> to memref<?xf32, strided<[1], offset: ?>>
+// CHECK:             linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[PAD_2]] : memref<?xf32, strided<[1], offset: ?>>)
 // CHECK:             memref.copy [[VAR_subview_1_]], [[VAR_subview_1_]]_6 : memref<?xf32, strided<[1], offset: ?>> to memref<?xf32, strided<[1]>>
 // CHECK:             [[VAR_39_:%.+]] = bufferization.to_tensor [[RES_1_]] restrict writable : memref<256xf32>
 // CHECK:             [[VAR_40_:%.+]] = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins([[VAR_39_]], [[VAR_12_]] : tensor<256xf32>, tensor<256xf32>) outs([[VAR_39_]] : tensor<256xf32>) {
@@ -206,24 +198,18 @@ module {
 // CHECK:             } -> tensor<256xf32>
 // CHECK:             scf.yield [[VAR_43_]] : tensor<256xf32>
 // CHECK:           }
-// CHECK:           [[VAR_14_:%.+]] = bufferization.alloc_tensor() : tensor<f32>
-// CHECK:           [[VAR_inserted_1_:%.+]] = tensor.insert [[CST_0_dot_000000_]] into [[VAR_14_]][] : tensor<f32>
-// CHECK:           [[VAR_reduced_2_:%.+]] = linalg.reduce ins([[VAR_13_]] : tensor<256xf32>) outs([[VAR_inserted_1_]] : tensor<f32>) dimensions = [0]
-// CHECK:             ([[in_0:.+]]: f32, [[in_1:.+]]: f32) {
-// CHECK:               [[VAR_25_4_:%.+]] = arith.addf [[in_0]], [[in_1]] : f32
-// CHECK:               linalg.yield [[VAR_25_4_]] : f32
-// CHECK:             }
-// CHECK:           [[VAR_extracted_3_:%.+]] = tensor.extract [[VAR_reduced_2_]][] : tensor<f32>
+// CHECK:           [[VAR_vector_1_:%.+]] = vector.transfer_read [[VAR_13_]]{{.}}%{{.*}}{{.}}, %{{.*}} {in_bounds = [true]} : tensor<256xf32>, vector<256xf32>
+// CHECK:           [[VAR_extracted_3_:%.+]] = vector.reduction <add>, [[VAR_vector_1_]], [[CST_0_dot_000000_]] : vector<256xf32> into f32
 // CHECK:           [[VAR_15_:%.+]] = arith.divf [[VAR_extracted_3_]], [[VAR_5_]] : f32
 // CHECK:           [[VAR_16_:%.+]] = arith.addf [[VAR_15_]], [[PARAM_8_]] : f32
 // CHECK:           [[VAR_17_:%.+]] = math.sqrt [[VAR_16_]] : f32
 // CHECK-DAG:       [[VAR_18_:%.+]] = arith.divf [[CST_1_dot_000000_]], [[VAR_17_]] : f32
 // CHECK-DAG:       [[VAR_19_:%.+]] = arith.index_cast [[PARAM_9_]] : i32 to index
 // CHECK:           [[VAR_reinterpret_cast_:%.+]] = memref.reinterpret_cast [[PARAM_4_]] to offset: {{.}}[[VAR_19_]]{{.}}, sizes: [1], strides: [1] : memref<*xf32> to memref<1xf32, strided<[1], offset: ?>>
-// CHECK:           affine.store [[VAR_6_]], [[VAR_reinterpret_cast_]][0] : memref<1xf32, strided<[1], offset: ?>>
+// CHECK:           memref.store [[VAR_6_]], [[VAR_reinterpret_cast_]]{{\[}}%{{.*}}] : memref<1xf32, strided<[1], offset: ?>>
 // CHECK:           [[VAR_20_:%.+]] = arith.index_cast [[PARAM_9_]] : i32 to index
 // CHECK:           [[VAR_reinterpret_cast_4_:%.+]] = memref.reinterpret_cast [[PARAM_5_]] to offset: {{.}}[[VAR_20_]]{{.}}, sizes: [1], strides: [1] : memref<*xf32> to memref<1xf32, strided<[1], offset: ?>>
-// CHECK:           affine.store [[VAR_18_]], [[VAR_reinterpret_cast_4_]][0] : memref<1xf32, strided<[1], offset: ?>>
+// CHECK:           memref.store [[VAR_18_]], [[VAR_reinterpret_cast_4_]]{{\[}}%{{.*}}] : memref<1xf32, strided<[1], offset: ?>>
 // CHECK:           [[VAR_21_:%.+]] = tensor.empty() : tensor<256xf32>
 // CHECK-DAG:       [[VAR_22_:%.+]] = linalg.fill ins([[VAR_6_]] : f32) outs([[VAR_21_]] : tensor<256xf32>) -> tensor<256xf32>
 // CHECK-DAG:       [[VAR_23_:%.+]] = tensor.empty() : tensor<256xf32>
@@ -269,10 +255,9 @@ module {
 // CHECK:             [[VAR_46_:%.+]] = arith.subi [[VAR_45_]], [[VAR_42_1_]] : index
 // CHECK-DAG:         [[VAR_subview_13_:%.+]] = memref.subview [[VAR_reinterpret_cast_11_]][0] {{.}}[[VAR_46_]]{{.}} [1] : memref<256xf32, strided<[1], offset: ?>> to memref<?xf32, strided<[1], offset: ?>>
 // CHECK-DAG:         [[VAR_subview_14_:%.+]] = memref.subview [[RES_4_]][0] {{.}}[[VAR_46_]]{{.}} [1] : memref<256xf32> to memref<?xf32, strided<[1]>>
-// CHECK-DAG:         [[VAR_47_:%.+]] = arith.cmpi slt, [[VAR_46_]], [[CST_256_]] : index
-// CHECK:             scf.if [[VAR_47_]] {
-// CHECK:               linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[RES_4_]] : memref<256xf32>)
-// CHECK:             }
+// CHECK:             [[PAD_SIZE_3:%.+]] = arith.subi [[CST_256_]], [[VAR_46_]] : index
+// CHECK:             [[PAD_3:%.+]] = memref.subview [[RES_4_]]{{.}}[[VAR_46_]]{{.}} {{.}}[[PAD_SIZE_3]]{{.}} [1] : memref<256xf32> to memref<?xf32, strided<[1], offset: ?>>
+// CHECK:             linalg.fill ins([[CST_0_dot_000000_]] : f32) outs([[PAD_3]] : memref<?xf32, strided<[1], offset: ?>>)
 // CHECK:             memref.copy [[VAR_subview_13_]], [[VAR_subview_14_]] : memref<?xf32, strided<[1], offset: ?>> to memref<?xf32, strided<[1]>>
 // CHECK:             [[VAR_48_:%.+]] = bufferization.to_tensor [[RES_4_]] restrict writable : memref<256xf32>
 // CHECK:             [[VAR_49_:%.+]] = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins([[VAR_48_]], [[VAR_22_]] : tensor<256xf32>, tensor<256xf32>) outs([[VAR_48_]] : tensor<256xf32>) {
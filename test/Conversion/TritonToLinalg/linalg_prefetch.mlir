@@ -0,0 +1,77 @@
+// RUN: triton-opt --triton-linalg-prefetch="num-buffers=3" %s | FileCheck %s
+#map = affine_map<(d0) -> (d0)>
+module {
+  func.func @kernel(%arg0: memref<*xf32>, %arg1: memref<*xf32>, %arg2: index, %arg3: index) {
+    %c0 = arith.constant 0 : index
+    %c4 = arith.constant 4 : index
+    %c128 = arith.constant 128 : index
+    %0 = tensor.empty() : tensor<128xf32>
+    %1 = memref.reinterpret_cast %arg0 to offset: [%arg2], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1], offset: ?>>
+    %2:3 = scf.for %arg4 = %c0 to %arg3 step %c4 iter_args(%arg5 = %0, %arg6 = %1, %arg7 = %arg2) -> (tensor<128xf32>, memref<128xf32, strided<[1], offset: ?>>, index) {
+      %3 = memref.alloc() : memref<128xf32>
+      memref.copy %arg6, %3 : memref<128xf32, strided<[1], offset: ?>> to memref<128xf32>
+      %4 = bufferization.to_tensor %3 restrict writable : memref<128xf32>
+      %5 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel"]} ins(%arg5, %4 : tensor<128xf32>, tensor<128xf32>) outs(%arg5 : tensor<128xf32>) {
+      ^bb0(%in: f32, %in_0: f32, %out: f32):
+        %8 = arith.addf %in, %in_0 : f32
+        linalg.yield %8 : f32
+      } -> tensor<128xf32>
+      %6 = arith.addi %arg7, %c128 : index
+      %7 = memref.reinterpret_cast %arg0 to offset: [%6], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1], offset: ?>>
+      scf.yield %5, %7, %6 : tensor<128xf32>, memref<128xf32, strided<[1], offset: ?>>, index
+    }
+    %3 = memref.reinterpret_cast %arg1 to offset: [%arg2], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1], offset: ?>>
+    memref.tensor_store %2#0, %3 : memref<128xf32, strided<[1], offset: ?>>
+    return
+  }
+}
+// With 3 buffers, the copies run 2 iterations ahead: the prologue fills the
+// first two buffers and iteration i prefetches the source of iteration i + 2,
+// advancing the pointer iter args twice.
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[ARG0:.*]]: memref<*xf32>, %{{.*}}: memref<*xf32>, %[[ARG2:.*]]: index, %[[UB:.*]]: index) {
+// CHECK-DAG:       %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:       %[[C4:.*]] = arith.constant 4 : index
+// CHECK-DAG:       %[[C128:.*]] = arith.constant 128 : index
+// CHECK:           %[[INIT:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{\[}}%[[ARG2]]]
+// CHECK:           %[[RING:.*]] = memref.alloc() : memref<3x128xf32>
+// CHECK:           %[[ANY:.*]] = arith.cmpi slt, %[[C0]], %[[UB]] : index
+// CHECK:           scf.if %[[ANY]] {
+// CHECK:             %[[FIRST:.*]] = memref.subview %[[RING]][0, 0] [1, 128] [1, 1] : memref<3x128xf32> to memref<128xf32, strided<[1]>>
+// CHECK:             memref.copy %[[INIT]], %[[FIRST]]
+// CHECK:           }
+// CHECK:           %[[OFF1:.*]] = arith.addi %[[ARG2]], %[[C128]] : index
+// CHECK:           %[[PTR1:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{\[}}%[[OFF1]]]
+// CHECK:           %[[IV1:.*]] = arith.addi %[[C0]], %[[C4]] : index
+// CHECK:           %[[ANY1:.*]] = arith.cmpi slt, %[[IV1]], %[[UB]] : index
+// CHECK:           scf.if %[[ANY1]] {
+// CHECK:             %[[SECOND:.*]] = memref.subview %[[RING]][1, 0] [1, 128] [1, 1] : memref<3x128xf32> to memref<128xf32, strided<[1], offset: 128>>
+// CHECK:             memref.copy %[[PTR1]], %[[SECOND]]
+// CHECK:           }
+// CHECK-NOT:       memref.copy
+// CHECK:           scf.for %[[IV:.*]] = %[[C0]] to %[[UB]] step %[[C4]] iter_args(%{{.*}} = %{{.*}}, %[[PTR:.*]] = %[[INIT]], %[[OFF:.*]] = %[[ARG2]])
+// CHECK:             %[[C2:.*]] = arith.constant 2 : index
+// CHECK:             %[[DIST:.*]] = arith.muli %[[C4]], %[[C2]] : index
+// CHECK:             %[[AHEAD_IV:.*]] = arith.addi %[[IV]], %[[DIST]] : index
+// CHECK:             %[[HAS_AHEAD:.*]] = arith.cmpi slt, %[[AHEAD_IV]], %[[UB]] : index
+// CHECK:             scf.if %[[HAS_AHEAD]] {
+// CHECK:               %[[NEXT_OFF:.*]] = arith.addi %[[OFF]], %[[C128]] : index
+// CHECK:               memref.reinterpret_cast %[[ARG0]] to offset: {{\[}}%[[NEXT_OFF]]]
+// CHECK:               arith.addi %[[IV]], %[[C4]] : index
+// CHECK:               %[[AHEAD_OFF:.*]] = arith.addi %[[NEXT_OFF]], %[[C128]] : index
+// CHECK:               %[[AHEAD_PTR:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{\[}}%[[AHEAD_OFF]]]
+// CHECK:               %[[SUB:.*]] = arith.subi %[[AHEAD_IV]], %[[C0]] : index
+// CHECK:               %[[ITER:.*]] = arith.divsi %[[SUB]], %[[C4]] : index
+// CHECK:               %[[C3:.*]] = arith.constant 3 : index
+// CHECK:               %[[SLOT:.*]] = arith.remsi %[[ITER]], %[[C3]] : index
+// CHECK:               %[[AHEAD:.*]] = memref.subview %[[RING]]{{\[}}%[[SLOT]], 0] [1, 128] [1, 1] : memref<3x128xf32> to memref<128xf32, strided<[1], offset: ?>>
+// CHECK:               memref.copy %[[AHEAD_PTR]], %[[AHEAD]]
+// CHECK:             }
+// CHECK-NOT:         memref.alloc
+// CHECK-NOT:         memref.copy
+// CHECK:             %[[CUR:.*]] = memref.subview %[[RING]]
+// CHECK:             bufferization.to_tensor %[[CUR]] restrict writable : memref<128xf32, strided<[1], offset: ?>>
+// CHECK:             linalg.generic
+// CHECK:             scf.yield
+// CHECK:           }
+// CHECK:           memref.tensor_store
@@ -0,0 +1,19 @@
+// RUN: triton-opt --triton-to-linalg="load-memory-space=2" %s | FileCheck %s
+module {
+  tt.func @kernel(%arg0 : !tt.ptr<f32>, %arg1 : !tt.ptr<f32>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    %4 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %5 = tt.addptr %4, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    tt.store %5, %3 : tensor<128xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[SRC:.*]] = memref.reinterpret_cast %{{.*}} to offset: [0], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1]>>
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<128xf32, 2>
+// CHECK:           memref.copy %[[SRC]], %[[ALLOC]] : memref<128xf32, strided<[1]>> to memref<128xf32, 2>
+// CHECK:           %[[TENSOR:.*]] = bufferization.to_tensor %[[ALLOC]] : memref<128xf32, 2>
+// CHECK:           memref.tensor_store %[[TENSOR]], %{{.*}} : memref<128xf32, strided<[1]>>
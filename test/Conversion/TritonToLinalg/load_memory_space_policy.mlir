@@ -0,0 +1,60 @@
+// RUN: triton-opt --triton-to-linalg="matmul-operand-memory-space=2 streaming-memory-space=1 streaming-tile-bytes=16384 accumulator-memory-space=2" %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<bf16>,
+    %arg1 : !tt.ptr<bf16>,
+    %arg2 : !tt.ptr<f32>,
+    %arg3 : !tt.ptr<f32>,
+    %arg4 : !tt.ptr<f32>,
+    %arg5 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+    %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<64xi32>) -> tensor<64x1xi32>
+    %c64 = arith.constant 64 : i32
+    %2 = tt.splat %c64 : (i32) -> tensor<64x1xi32>
+    %3 = arith.muli %1, %2 : tensor<64x1xi32>
+    %4 = tt.broadcast %3 : (tensor<64x1xi32>) -> tensor<64x64xi32>
+    %5 = tt.expand_dims %0 {axis = 0 : i32} : (tensor<64xi32>) -> tensor<1x64xi32>
+    %6 = tt.broadcast %5 : (tensor<1x64xi32>) -> tensor<64x64xi32>
+    %7 = arith.addi %4, %6 : tensor<64x64xi32>
+    // matmul operands
+    %8 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<64x64x!tt.ptr<bf16>>
+    %9 = tt.addptr %8, %7 : tensor<64x64x!tt.ptr<bf16>>, tensor<64x64xi32>
+    %10 = tt.load %9 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xbf16>
+    %11 = tt.splat %arg1 : (!tt.ptr<bf16>) -> tensor<64x64x!tt.ptr<bf16>>
+    %12 = tt.addptr %11, %7 : tensor<64x64x!tt.ptr<bf16>>, tensor<64x64xi32>
+    %13 = tt.load %12 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xbf16>
+    %14 = tt.trans %13 : (tensor<64x64xbf16>) -> tensor<64x64xbf16>
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32>
+    %15 = tt.dot %10, %14, %cst {allowTF32 = false} : tensor<64x64xbf16> * tensor<64x64xbf16> -> tensor<64x64xf32>
+    // 16 KB residual tile, streamed
+    %16 = tt.splat %arg2 : (!tt.ptr<f32>) -> tensor<64x64x!tt.ptr<f32>>
+    %17 = tt.addptr %16, %7 : tensor<64x64x!tt.ptr<f32>>, tensor<64x64xi32>
+    %18 = tt.load %17 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xf32>
+    %19 = arith.addf %15, %18 : tensor<64x64xf32>
+    %20 = tt.splat %arg3 : (!tt.ptr<f32>) -> tensor<64x64x!tt.ptr<f32>>
+    %21 = tt.addptr %20, %7 : tensor<64x64x!tt.ptr<f32>>, tensor<64x64xi32>
+    tt.store %21, %19 : tensor<64x64xf32>
+    // small tile, left in the default memory space
+    %22 = tt.splat %arg4 : (!tt.ptr<f32>) -> tensor<64x!tt.ptr<f32>>
+    %23 = tt.addptr %22, %0 : tensor<64x!tt.ptr<f32>>, tensor<64xi32>
+    %24 = tt.load %23 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64xf32>
+    // placed by the frontend
+    %25 = tt.load %17 {MemorySpace = 3 : i64, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xf32>
+    %26 = tt.splat %arg5 : (!tt.ptr<f32>) -> tensor<64x!tt.ptr<f32>>
+    %27 = tt.addptr %26, %0 : tensor<64x!tt.ptr<f32>>, tensor<64xi32>
+    tt.store %27, %24 : tensor<64xf32>
+    tt.store %21, %25 : tensor<64x64xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[A:.*]] = memref.alloc() : memref<64x64xbf16, 2>
+// CHECK:           %[[B:.*]] = memref.alloc() : memref<64x64xbf16, 2>
+// CHECK:           %[[ACC:.*]] = bufferization.alloc_tensor() {memory_space = 2 : i64} : tensor<64x64xf32>
+// CHECK:           %[[FILL:.*]] = linalg.fill ins(%{{.*}} : f32) outs(%[[ACC]] : tensor<64x64xf32>) -> tensor<64x64xf32>
+// CHECK:           linalg.matmul ins(%{{.*}}, %{{.*}} : tensor<64x64xbf16>, tensor<64x64xbf16>) outs(%[[FILL]] : tensor<64x64xf32>)
+// CHECK:           memref.alloc() : memref<64x64xf32, 1>
+// CHECK:           memref.alloc() : memref<64xf32>
+// CHECK:           memref.alloc() : memref<64x64xf32, 3>
@@ -85,12 +85,12 @@ module {
 // CHECK:           %[[VAL_26:.*]] = arith.minsi %[[VAL_24]], %[[VAL_11]] : index
 // CHECK:           %[[VAL_27:.*]] = memref.subview %[[VAL_16]][0, 0] {{\[}}%[[VAL_25]], %[[VAL_26]]] [1, 1] : memref<128x256xbf16, strided<[1, ?], offset: ?>> to memref<?x?xbf16, strided<[1, ?], offset: ?>>
 // CHECK:           %[[VAL_28:.*]] = memref.subview %[[VAL_18]][0, 0] {{\[}}%[[VAL_25]], %[[VAL_26]]] [1, 1] : memref<128x256xbf16> to memref<?x?xbf16, strided<[256, 1]>>
-// CHECK:           %[[VAL_29:.*]] = arith.cmpi slt, %[[VAL_25]], %[[VAL_12]] : index
-// CHECK:           %[[VAL_30:.*]] = arith.cmpi slt, %[[VAL_26]], %[[VAL_11]] : index
-// CHECK:           %[[VAL_31:.*]] = arith.ori %[[VAL_29]], %[[VAL_30]] : i1
-// CHECK:           scf.if %[[VAL_31]] {
-// CHECK:             linalg.fill ins(%[[VAL_15]] : bf16) outs(%[[VAL_18]] : memref<128x256xbf16>)
-// CHECK:           }
+// CHECK:           %[[VAL_29:.*]] = arith.subi %[[VAL_12]], %[[VAL_25]] : index
+// CHECK:           %[[VAL_30:.*]] = memref.subview %[[VAL_18]]{{\[}}%[[VAL_25]], 0] {{\[}}%[[VAL_29]], 256] [1, 1] : memref<128x256xbf16> to memref<?x256xbf16, strided<[256, 1], offset: ?>>
+// CHECK:           linalg.fill ins(%[[VAL_15]] : bf16) outs(%[[VAL_30]] : memref<?x256xbf16, strided<[256, 1], offset: ?>>)
+// CHECK:           %[[VAL_31:.*]] = arith.subi %[[VAL_11]], %[[VAL_26]] : index
+// CHECK:           %[[VAL_31_1:.*]] = memref.subview %[[VAL_18]][0, %[[VAL_26]]] {{\[}}%[[VAL_25]], %[[VAL_31]]] [1, 1] : memref<128x256xbf16> to memref<?x?xbf16, strided<[256, 1], offset: ?>>
+// CHECK:           linalg.fill ins(%[[VAL_15]] : bf16) outs(%[[VAL_31_1]] : memref<?x?xbf16, strided<[256, 1], offset: ?>>)
 // CHECK:           memref.copy %[[VAL_27]], %[[VAL_28]] : memref<?x?xbf16, strided<[1, ?], offset: ?>> to memref<?x?xbf16, strided<[256, 1]>>
 // CHECK:           %[[VAL_32:.*]] = bufferization.to_tensor %[[VAL_18]] restrict writable : memref<128x256xbf16>
 // CHECK:           %[[VAL_33:.*]] = arith.index_cast %[[VAL_2]] : i32 to index
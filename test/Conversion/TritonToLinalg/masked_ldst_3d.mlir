@@ -0,0 +1,89 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>,
+  %arg2 : i32,
+  %arg3 : i32,
+  %arg4 : i32,
+  %arg5 : i32
+  )
+  {
+    // Load a 2x16x32 batch x seq x dim block of a row-major (?, 64, 32)
+    // tensor. The batch offsets are broadcast before they are compared, the
+    // seq and dim offsets after, and the whole block is masked by a condition
+    // on the scalar %arg5.
+    %0 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<2x16x32x!tt.ptr<f32>>
+    %1 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<2x16x32x!tt.ptr<f32>>
+    // batch index
+    %b = tt.make_range {end = 2 : i32, start = 0 : i32} : tensor<2xi32>
+    %b1 = tt.expand_dims %b {axis = 1 : i32} : (tensor<2xi32>) -> tensor<2x1xi32>
+    %b2 = tt.expand_dims %b1 {axis = 2 : i32} : (tensor<2x1xi32>) -> tensor<2x1x1xi32>
+    %b3 = tt.broadcast %b2 : (tensor<2x1x1xi32>) -> tensor<2x16x32xi32>
+    %c2048 = arith.constant 2048 : i32
+    %c2048tensor = tt.splat %c2048 : (i32) -> tensor<2x16x32xi32>
+    %boff = arith.muli %b3, %c2048tensor : tensor<2x16x32xi32>
+    // seq index
+    %s = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32>
+    %s1 = tt.expand_dims %s {axis = 0 : i32} : (tensor<16xi32>) -> tensor<1x16xi32>
+    %s2 = tt.expand_dims %s1 {axis = 2 : i32} : (tensor<1x16xi32>) -> tensor<1x16x1xi32>
+    %c32 = arith.constant 32 : i32
+    %c32tensor = tt.splat %c32 : (i32) -> tensor<1x16x1xi32>
+    %s3 = arith.muli %s2, %c32tensor : tensor<1x16x1xi32>
+    %soff = tt.broadcast %s3 : (tensor<1x16x1xi32>) -> tensor<2x16x32xi32>
+    // dim index
+    %d = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+    %d1 = tt.expand_dims %d {axis = 0 : i32} : (tensor<32xi32>) -> tensor<1x32xi32>
+    %d2 = tt.expand_dims %d1 {axis = 0 : i32} : (tensor<1x32xi32>) -> tensor<1x1x32xi32>
+    %doff = tt.broadcast %d2 : (tensor<1x1x32xi32>) -> tensor<2x16x32xi32>
+    // combined index
+    %bs = arith.addi %boff, %soff : tensor<2x16x32xi32>
+    %index = arith.addi %bs, %doff : tensor<2x16x32xi32>
+    %ldptr = tt.addptr %0, %index : tensor<2x16x32x!tt.ptr<f32>>, tensor<2x16x32xi32>
+    %stptr = tt.addptr %1, %index : tensor<2x16x32x!tt.ptr<f32>>, tensor<2x16x32xi32>
+    // batch mask, compared on the broadcast offsets
+    %bbound = tt.splat %arg2 : (i32) -> tensor<2x16x32xi32>
+    %bmask = arith.cmpi slt, %b3, %bbound : tensor<2x16x32xi32>
+    // seq mask
+    %sbound = tt.splat %arg3 : (i32) -> tensor<16xi32>
+    %smask = arith.cmpi slt, %s, %sbound : tensor<16xi32>
+    %smask1 = tt.expand_dims %smask {axis = 0 : i32} : (tensor<16xi1>) -> tensor<1x16xi1>
+    %smask2 = tt.expand_dims %smask1 {axis = 2 : i32} : (tensor<1x16xi1>) -> tensor<1x16x1xi1>
+    %smask3 = tt.broadcast %smask2 : (tensor<1x16x1xi1>) -> tensor<2x16x32xi1>
+    // dim mask
+    %dbound = tt.splat %arg4 : (i32) -> tensor<32xi32>
+    %dmask = arith.cmpi slt, %d, %dbound : tensor<32xi32>
+    %dmask1 = tt.expand_dims %dmask {axis = 0 : i32} : (tensor<32xi1>) -> tensor<1x32xi1>
+    %dmask2 = tt.expand_dims %dmask1 {axis = 0 : i32} : (tensor<1x32xi1>) -> tensor<1x1x32xi1>
+    %dmask3 = tt.broadcast %dmask2 : (tensor<1x1x32xi1>) -> tensor<2x16x32xi1>
+    // condition on a scalar
+    %c0 = arith.constant 0 : i32
+    %cond = arith.cmpi sgt, %arg5, %c0 : i32
+    %condmask = tt.splat %cond : (i1) -> tensor<2x16x32xi1>
+    // combined mask
+    %m0 = arith.andi %bmask, %smask3 : tensor<2x16x32xi1>
+    %m1 = arith.andi %m0, %dmask3 : tensor<2x16x32xi1>
+    %mask = arith.andi %m1, %condmask : tensor<2x16x32xi1>
+    %buff = tt.load %ldptr, %mask {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<2x16x32xf32>
+    tt.store %stptr, %buff, %mask : tensor<2x16x32xf32>
+    tt.return
+  }
+}
+// The block is loaded and stored by single strided 3-D copies of the
+// intersection of the masks of every dimension
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:      %[[ARG0:.*]]: memref<*xf32>, %[[ARG1:.*]]: memref<*xf32>, %[[ARG2:.*]]: i32, %[[ARG3:.*]]: i32, %[[ARG4:.*]]: i32, %[[ARG5:.*]]: i32,
+// CHECK:           %[[LD:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{.*}}, sizes: [2, 16, 32], strides: {{.*}} : memref<*xf32> to memref<2x16x32xf32, strided<{{.*}}>>
+// CHECK:           %[[ST:.*]] = memref.reinterpret_cast %[[ARG1]] to offset: {{.*}}, sizes: [2, 16, 32], strides: {{.*}} : memref<*xf32> to memref<2x16x32xf32, strided<{{.*}}>>
+// CHECK:           %[[COND:.*]] = arith.cmpi sgt, %[[ARG5]], %{{.*}} : i32
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<2x16x32xf32>
+// CHECK:           arith.select %[[COND]], %{{.*}}, %{{.*}} : index
+// CHECK:           %[[SRC:.*]] = memref.subview %[[LD]][0, 0, 0] {{\[}}%{{.*}}, %{{.*}}, %{{.*}}] [1, 1, 1] : memref<2x16x32xf32, strided<{{.*}}>> to memref<?x?x?xf32, strided<{{.*}}>>
+// CHECK:           %[[DST:.*]] = memref.subview %[[ALLOC]][0, 0, 0] {{\[}}%{{.*}}, %{{.*}}, %{{.*}}] [1, 1, 1] : memref<2x16x32xf32> to memref<?x?x?xf32, strided<[512, 32, 1]>>
+// CHECK:           memref.copy %[[SRC]], %[[DST]]
+// CHECK:           %[[TENSOR:.*]] = bufferization.to_tensor %[[ALLOC]]
+// CHECK:           arith.select %[[COND]], %{{.*}}, %{{.*}} : index
+// CHECK:           %[[OUT:.*]] = memref.subview %[[ST]][0, 0, 0] {{\[}}%{{.*}}, %{{.*}}, %{{.*}}] [1, 1, 1]
+// CHECK:           %[[SLICE:.*]] = tensor.extract_slice %[[TENSOR]][0, 0, 0] {{\[}}%{{.*}}, %{{.*}}, %{{.*}}] [1, 1, 1] : tensor<2x16x32xf32> to tensor<?x?x?xf32>
+// CHECK:           memref.tensor_store %[[SLICE]], %[[OUT]]
+// CHECK-NOT:       scf.for
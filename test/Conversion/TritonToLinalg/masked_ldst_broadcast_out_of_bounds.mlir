@@ -0,0 +1,55 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>,
+  %arg2 : i32,
+  %arg3 : i32
+  )
+  {
+    // Load a 4x32 block whose rows all belong to batch %arg2, which is masked
+    // by %arg2 < %arg3 before it is broadcast. The whole block is masked off
+    // when %arg3 < %arg2.
+    %0 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<4x32x!tt.ptr<f32>>
+    %1 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<4x32x!tt.ptr<f32>>
+    // batch index, of size 1
+    %b = tt.make_range {end = 1 : i32, start = 0 : i32} : tensor<1xi32>
+    %bstart = tt.splat %arg2 : (i32) -> tensor<1xi32>
+    %bidx = arith.addi %b, %bstart : tensor<1xi32>
+    // column index
+    %c = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+    %c1 = tt.expand_dims %c {axis = 0 : i32} : (tensor<32xi32>) -> tensor<1x32xi32>
+    %coff = tt.broadcast %c1 : (tensor<1x32xi32>) -> tensor<4x32xi32>
+    %ldptr = tt.addptr %0, %coff : tensor<4x32x!tt.ptr<f32>>, tensor<4x32xi32>
+    %stptr = tt.addptr %1, %coff : tensor<4x32x!tt.ptr<f32>>, tensor<4x32xi32>
+    // batch mask, broadcast along the rows of the block
+    %bbound = tt.splat %arg3 : (i32) -> tensor<1xi32>
+    %bmask = arith.cmpi slt, %bidx, %bbound : tensor<1xi32>
+    %bmask1 = tt.expand_dims %bmask {axis = 1 : i32} : (tensor<1xi1>) -> tensor<1x1xi1>
+    %mask = tt.broadcast %bmask1 : (tensor<1x1xi1>) -> tensor<4x32xi1>
+    %buff = tt.load %ldptr, %mask {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<4x32xf32>
+    tt.store %stptr, %buff, %mask : tensor<4x32xf32>
+    tt.return
+  }
+}
+// The batch dim min(%arg2 + 1, %arg3) - %arg2 is clamped to [0, 1] before it
+// is scaled to the 4 rows, so an out-of-bounds batch copies no rows
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:      %[[ARG0:.*]]: memref<*xf32>, %[[ARG1:.*]]: memref<*xf32>, %[[ARG2:.*]]: i32, %[[ARG3:.*]]: i32,
+// CHECK:           %[[LD:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: [0], sizes: [4, 32], strides: [0, 1]
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<4x32xf32>
+// CHECK:           %[[SIZE:.*]] = arith.subi %{{.*}}, %{{.*}} : index
+// CHECK:           %[[NONNEG:.*]] = arith.maxsi %[[SIZE]], %{{.*}} : index
+// CHECK:           %[[KEEP:.*]] = arith.minsi %[[NONNEG]], %{{.*}} : index
+// CHECK:           %[[ROWS:.*]] = arith.muli {{.*}}%[[KEEP]]{{.*}} : index
+// CHECK:           %[[SRC:.*]] = memref.subview %[[LD]][0, 0] {{\[}}%[[ROWS]], 32] [1, 1]
+// CHECK:           %[[DST:.*]] = memref.subview %[[ALLOC]][0, 0] {{\[}}%[[ROWS]], 32] [1, 1]
+// CHECK:           memref.copy %[[SRC]], %[[DST]]
+// CHECK:           %[[ST_SIZE:.*]] = arith.subi %{{.*}}, %{{.*}} : index
+// CHECK:           %[[ST_NONNEG:.*]] = arith.maxsi %[[ST_SIZE]], %{{.*}} : index
+// CHECK:           %[[ST_KEEP:.*]] = arith.minsi %[[ST_NONNEG]], %{{.*}} : index
+// CHECK:           %[[ST_ROWS:.*]] = arith.muli {{.*}}%[[ST_KEEP]]{{.*}} : index
+// CHECK:           tensor.extract_slice %{{.*}}[0, 0] {{\[}}%[[ST_ROWS]], 32] [1, 1]
+// CHECK:           memref.tensor_store
+// CHECK:           return
+// CHECK:         }
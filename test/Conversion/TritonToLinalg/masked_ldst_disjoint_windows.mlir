@@ -0,0 +1,44 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<bf16>,
+  %arg1 : !tt.ptr<bf16>
+  )
+  {
+    %0 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %1 = tt.splat %arg1 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %2 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %ldptr = tt.addptr %0, %2 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    %stptr = tt.addptr %1, %2 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    %nans = arith.constant dense<0xFF80> : tensor<128xbf16>
+    // (%2 < 32) & (%2 >= 64) is empty
+    %hi = arith.constant dense<32> : tensor<128xi32>
+    %lo = arith.constant dense<64> : tensor<128xi32>
+    %himask = arith.cmpi slt, %2, %hi : tensor<128xi32>
+    %lomask = arith.cmpi sge, %2, %lo : tensor<128xi32>
+    %mask = arith.andi %himask, %lomask : tensor<128xi1>
+    %buff = tt.load %ldptr, %mask, %nans {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xbf16>
+    tt.store %stptr, %buff, %mask : tensor<128xbf16>
+    tt.return
+  }
+}
+// The intersection of [0, 32) and [64, 128) is the empty window at 64, so
+// nothing is copied and the whole load is filled with other
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xbf16>, %[[VAL_1:.*]]: memref<*xbf16>, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK:           %[[LD:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: [0], sizes: [128], strides: [1] : memref<*xbf16> to memref<128xbf16, strided<[1]>>
+// CHECK:           %[[ST:.*]] = memref.reinterpret_cast %[[VAL_1]] to offset: [0], sizes: [128], strides: [1] : memref<*xbf16> to memref<128xbf16, strided<[1]>>
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<128xbf16>
+// CHECK:           %[[SRC:.*]] = memref.subview %[[LD]][64] [0] [1] : memref<128xbf16, strided<[1]>> to memref<0xbf16, strided<[1], offset: 64>>
+// CHECK:           %[[DST:.*]] = memref.subview %[[ALLOC]][64] [0] [1] : memref<128xbf16> to memref<0xbf16, strided<[1], offset: 64>>
+// CHECK:           %[[LOW_PAD:.*]] = memref.subview %[[ALLOC]][0] [64] [1] : memref<128xbf16> to memref<64xbf16, strided<[1]>>
+// CHECK:           linalg.fill ins(%{{.*}} : bf16) outs(%[[LOW_PAD]] : memref<64xbf16, strided<[1]>>)
+// CHECK:           %[[HIGH_PAD:.*]] = memref.subview %[[ALLOC]][64] [64] [1] : memref<128xbf16> to memref<64xbf16, strided<[1], offset: 64>>
+// CHECK:           linalg.fill ins(%{{.*}} : bf16) outs(%[[HIGH_PAD]] : memref<64xbf16, strided<[1], offset: 64>>)
+// CHECK:           memref.copy %[[SRC]], %[[DST]] : memref<0xbf16, strided<[1], offset: 64>> to memref<0xbf16, strided<[1], offset: 64>>
+// CHECK:           %[[TENSOR:.*]] = bufferization.to_tensor %[[ALLOC]] restrict writable : memref<128xbf16>
+// CHECK:           %[[SLICE:.*]] = tensor.extract_slice %[[TENSOR]][64] [0] [1] : tensor<128xbf16> to tensor<0xbf16>
+// CHECK:           %[[ST_DST:.*]] = memref.subview %[[ST]][64] [0] [1] : memref<128xbf16, strided<[1]>> to memref<0xbf16, strided<[1], offset: 64>>
+// CHECK:           memref.tensor_store %[[SLICE]], %[[ST_DST]] : memref<0xbf16, strided<[1], offset: 64>>
+// CHECK:           return
+// CHECK:         }
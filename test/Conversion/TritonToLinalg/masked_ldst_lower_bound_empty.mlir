@@ -0,0 +1,48 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<bf16>,
+  %arg1 : !tt.ptr<bf16>,
+  %arg2 : i32
+  )
+  {
+    %0 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %1 = tt.splat %arg1 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %2 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %ldptr = tt.addptr %0, %2 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    %stptr = tt.addptr %1, %2 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    %nans = arith.constant dense<0xFF80> : tensor<128xbf16>
+    // %2 >= %arg2 masks off the whole tile when %arg2 >= 128
+    %lo = tt.splat %arg2 : (i32) -> tensor<128xi32>
+    %mask = arith.cmpi sge, %2, %lo : tensor<128xi32>
+    %buff = tt.load %ldptr, %mask, %nans {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xbf16>
+    tt.store %stptr, %buff, %mask : tensor<128xbf16>
+    tt.return
+  }
+}
+// The start of the window is clamped to the tile, so that a bound past the
+// tile leaves an empty window at its end and a low padding of the whole tile
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xbf16>, %[[VAL_1:.*]]: memref<*xbf16>, %[[VAL_2:.*]]: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK-DAG:       %[[C128:.*]] = arith.constant 128 : index
+// CHECK:           %[[LD:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: [0], sizes: [128], strides: [1] : memref<*xbf16> to memref<128xbf16, strided<[1]>>
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<128xbf16>
+// CHECK:           %[[LO:.*]] = arith.index_cast %[[VAL_2]] : i32 to index
+// CHECK:           %[[LO_MAX:.*]] = arith.maxsi %[[LO]], %{{.*}} : index
+// CHECK:           %[[START:.*]] = arith.minsi %[[LO_MAX]], %[[C128]] : index
+// CHECK:           %[[DIM:.*]] = arith.subi %[[C128]], %[[START]] : index
+// CHECK:           %[[SRC:.*]] = memref.subview %[[LD]]{{\[}}%[[START]]] {{\[}}%[[DIM]]] [1] : memref<128xbf16, strided<[1]>> to memref<?xbf16, strided<[1], offset: ?>>
+// CHECK:           %[[DST:.*]] = memref.subview %[[ALLOC]]{{\[}}%[[START]]] {{\[}}%[[DIM]]] [1] : memref<128xbf16> to memref<?xbf16, strided<[1], offset: ?>>
+// CHECK:           %[[LOW_PAD:.*]] = memref.subview %[[ALLOC]][0] {{\[}}%[[START]]] [1] : memref<128xbf16> to memref<?xbf16, strided<[1]>>
+// CHECK:           linalg.fill ins(%{{.*}} : bf16) outs(%[[LOW_PAD]] : memref<?xbf16, strided<[1]>>)
+// CHECK:           %[[HIGH_PAD:.*]] = memref.subview %[[ALLOC]]{{\[}}%{{.*}}] {{\[}}%{{.*}}] [1] : memref<128xbf16> to memref<?xbf16, strided<[1], offset: ?>>
+// CHECK:           linalg.fill ins(%{{.*}} : bf16) outs(%[[HIGH_PAD]] : memref<?xbf16, strided<[1], offset: ?>>)
+// CHECK:           memref.copy %[[SRC]], %[[DST]] : memref<?xbf16, strided<[1], offset: ?>> to memref<?xbf16, strided<[1], offset: ?>>
+// CHECK:           %[[ST_LO_MAX:.*]] = arith.maxsi %{{.*}}, %{{.*}} : index
+// CHECK:           %[[ST_START:.*]] = arith.minsi %[[ST_LO_MAX]], %[[C128]] : index
+// CHECK:           %[[ST_DIM:.*]] = arith.subi %[[C128]], %[[ST_START]] : index
+// CHECK:           tensor.extract_slice %{{.*}}{{\[}}%[[ST_START]]] {{\[}}%[[ST_DIM]]] [1] : tensor<128xbf16> to tensor<?xbf16>
+// CHECK:           memref.subview %{{.*}}{{\[}}%[[ST_START]]] {{\[}}%[[ST_DIM]]] [1] : memref<128xbf16, strided<[1]>> to memref<?xbf16, strided<[1], offset: ?>>
+// CHECK:           memref.tensor_store
+// CHECK:           return
+// CHECK:         }
@@ -0,0 +1,51 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %1 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %ldptr = tt.addptr %0, %2 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %stptr = tt.addptr %1, %2 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %zeros = arith.constant dense<0.000000e+00> : tensor<128xf32>
+    // checkerboard mask: (%2 % 2) == 0
+    %c2 = arith.constant dense<2> : tensor<128xi32>
+    %c0 = arith.constant dense<0> : tensor<128xi32>
+    %rem = arith.remsi %2, %c2 : tensor<128xi32>
+    %mask = arith.cmpi eq, %rem, %c0 : tensor<128xi32>
+    %buff = tt.load %ldptr, %mask, %zeros {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    tt.store %stptr, %buff, %mask : tensor<128xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xf32>, %[[VAL_1:.*]]: memref<*xf32>, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK:           %[[LD:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: [0], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1]>>
+// CHECK:           %[[ST:.*]] = memref.reinterpret_cast %[[VAL_1]] to offset: [0], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1]>>
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<128xf32>
+// CHECK-NOT:       memref.copy
+// CHECK:           linalg.fill ins(%{{.*}} : f32) outs(%[[ALLOC]] : memref<128xf32>)
+// CHECK:           %[[MASK:.*]] = linalg.generic
+// CHECK:             arith.cmpi eq
+// CHECK:           scf.for %[[LD_IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} {
+// CHECK:             %[[LD_COND:.*]] = tensor.extract %[[MASK]][%[[LD_IV]]] : tensor<128xi1>
+// CHECK:             scf.if %[[LD_COND]] {
+// CHECK:               %[[LD_ELEM:.*]] = memref.load %[[LD]][%[[LD_IV]]] : memref<128xf32, strided<[1]>>
+// CHECK:               memref.store %[[LD_ELEM]], %[[ALLOC]][%[[LD_IV]]] : memref<128xf32>
+// CHECK:             }
+// CHECK:           }
+// CHECK:           %[[LOADED:.*]] = bufferization.to_tensor %[[ALLOC]] : memref<128xf32>
+// CHECK:           %[[ST_MASK:.*]] = linalg.generic
+// CHECK:             arith.cmpi eq
+// CHECK-NOT:       memref.tensor_store
+// CHECK:           scf.for %[[IV:.*]] = %{{.*}} to %{{.*}} step %{{.*}} {
+// CHECK:             %[[COND:.*]] = tensor.extract %[[ST_MASK]][%[[IV]]] : tensor<128xi1>
+// CHECK:             scf.if %[[COND]] {
+// CHECK:               %[[ELEM:.*]] = tensor.extract %[[LOADED]][%[[IV]]] : tensor<128xf32>
+// CHECK:               memref.store %[[ELEM]], %[[ST]][%[[IV]]] : memref<128xf32, strided<[1]>>
+// CHECK:             }
+// CHECK:           }
+// CHECK:           return
@@ -32,10 +32,9 @@ module {
 // CHECK:           %[[VAL_12:.*]] = arith.minsi %[[VAL_11]], %[[VAL_7]] : index
 // CHECK:           %[[VAL_13:.*]] = memref.subview %[[VAL_8]][0] {{\[}}%[[VAL_12]]] [1] : memref<128xbf16, strided<[1]>> to memref<?xbf16, strided<[1]>>
 // CHECK:           %[[VAL_14:.*]] = memref.subview %[[VAL_10]][0] {{\[}}%[[VAL_12]]] [1] : memref<128xbf16> to memref<?xbf16, strided<[1]>>
-// CHECK:           %[[VAL_15:.*]] = arith.cmpi slt, %[[VAL_12]], %[[VAL_7]] : index
-// CHECK:           scf.if %[[VAL_15]] {
-// CHECK:             linalg.fill ins(%[[VAL_6]] : bf16) outs(%[[VAL_10]] : memref<128xbf16>)
-// CHECK:           }
+// CHECK:           %[[PAD_SIZE_1:.*]] = arith.subi %[[VAL_7]], %[[VAL_12]] : index
+// CHECK:           %[[PAD_1:.*]] = memref.subview %[[VAL_10]]{{\[}}%[[VAL_12]]] {{\[}}%[[PAD_SIZE_1]]] [1] : memref<128xbf16> to memref<?xbf16, strided<[1], offset: ?>>
+// CHECK:           linalg.fill ins(%[[VAL_6]] : bf16) outs(%[[PAD_1]] : memref<?xbf16, strided<[1], offset: ?>>)
 // CHECK:           memref.copy %[[VAL_13]], %[[VAL_14]] : memref<?xbf16, strided<[1]>> to memref<?xbf16, strided<[1]>>
 // CHECK:           %[[VAL_16:.*]] = bufferization.to_tensor %[[VAL_10]] restrict writable : memref<128xbf16>
 // CHECK:           %[[VAL_17:.*]] = arith.index_cast %[[VAL_2]] : i32 to index
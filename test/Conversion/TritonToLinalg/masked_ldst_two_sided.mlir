@@ -0,0 +1,47 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<bf16>,
+  %arg1 : !tt.ptr<bf16>,
+  %arg2 : i32,
+  %arg3 : i32
+  )
+  {
+    %0 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %1 = tt.splat %arg1 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %2 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %ldptr = tt.addptr %0, %2 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    %stptr = tt.addptr %1, %2 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    %nans = arith.constant dense<0xFF80> : tensor<128xbf16>
+    // (%2 >= %arg2) & (%2 < %arg3)
+    %lo = tt.splat %arg2 : (i32) -> tensor<128xi32>
+    %hi = tt.splat %arg3 : (i32) -> tensor<128xi32>
+    %lomask = arith.cmpi sge, %2, %lo : tensor<128xi32>
+    %himask = arith.cmpi slt, %2, %hi : tensor<128xi32>
+    %mask = arith.andi %lomask, %himask : tensor<128xi1>
+    %buff = tt.load %ldptr, %mask, %nans {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xbf16>
+    tt.store %stptr, %buff, %mask : tensor<128xbf16>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xbf16>, %[[VAL_1:.*]]: memref<*xbf16>, %[[VAL_2:.*]]: i32, %[[VAL_3:.*]]: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK:           %[[LD:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: [0], sizes: [128], strides: [1] : memref<*xbf16> to memref<128xbf16, strided<[1]>>
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<128xbf16>
+// CHECK:           %[[LO:.*]] = arith.index_cast %[[VAL_2]] : i32 to index
+// CHECK:           %[[LO_MAX:.*]] = arith.maxsi %[[LO]], %{{.*}} : index
+// CHECK:           %[[START:.*]] = arith.minsi %[[LO_MAX]], %{{.*}} : index
+// CHECK:           %[[HI:.*]] = arith.index_cast %[[VAL_3]] : i32 to index
+// CHECK:           %[[END:.*]] = arith.minsi %[[HI]], %{{.*}} : index
+// CHECK:           %[[OFF:.*]] = arith.maxsi %[[START]], %{{.*}} : index
+// CHECK:           %[[SRC:.*]] = memref.subview %[[LD]]{{\[}}%[[OFF]]] {{\[}}%[[DIM:.*]]] [1] : memref<128xbf16, strided<[1]>> to memref<?xbf16, strided<[1], offset: ?>>
+// CHECK:           %[[DST:.*]] = memref.subview %[[ALLOC]]{{\[}}%[[OFF]]] {{\[}}%[[DIM]]] [1] : memref<128xbf16> to memref<?xbf16, strided<[1], offset: ?>>
+// CHECK:           %[[LOW_PAD:.*]] = memref.subview %[[ALLOC]][0] {{\[}}%[[OFF]]] [1] : memref<128xbf16> to memref<?xbf16, strided<[1]>>
+// CHECK:           linalg.fill ins(%{{.*}} : bf16) outs(%[[LOW_PAD]] : memref<?xbf16, strided<[1]>>)
+// CHECK:           %[[HIGH_PAD:.*]] = memref.subview %[[ALLOC]]{{\[}}%{{.*}}] {{\[}}%{{.*}}] [1] : memref<128xbf16> to memref<?xbf16, strided<[1], offset: ?>>
+// CHECK:           linalg.fill ins(%{{.*}} : bf16) outs(%[[HIGH_PAD]] : memref<?xbf16, strided<[1], offset: ?>>)
+// CHECK:           memref.copy %[[SRC]], %[[DST]] : memref<?xbf16, strided<[1], offset: ?>> to memref<?xbf16, strided<[1], offset: ?>>
+// CHECK:           tensor.extract_slice %{{.*}}{{\[}}%{{.*}}] {{\[}}%{{.*}}] [1] : tensor<128xbf16> to tensor<?xbf16>
+// CHECK:           memref.tensor_store
+// CHECK:           return
+// CHECK:         }
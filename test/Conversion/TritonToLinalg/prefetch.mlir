@@ -0,0 +1,31 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>,
+  %arg2 : i32
+  )
+  {
+    %0 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %1 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %2 = tt.splat %arg2 : (i32) -> tensor<128xi32>
+    %3 = arith.addi %1, %2 : tensor<128xi32>
+    %ptr = tt.addptr %0, %3 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %mask = arith.cmpi slt, %3, %2 : tensor<128xi32>
+    tt.prefetch %ptr, %mask : tensor<128x!tt.ptr<f32>>
+    %scalar = tt.addptr %arg1, %arg2 : !tt.ptr<f32>, i32
+    tt.prefetch %scalar : !tt.ptr<f32>
+    tt.return
+  }
+}
+// The prefetched blocks are hinted from their first element; the mask, which
+// only the prefetch uses, is not materialized.
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xf32>, %[[VAL_1:.*]]: memref<*xf32>, %[[VAL_2:.*]]: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK:           %[[VIEW:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: {{\[}}%{{.*}}], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1], offset: ?>>
+// CHECK-NOT:       arith.cmpi
+// CHECK:           memref.prefetch %[[VIEW]]{{\[}}%{{.*}}], read, locality<3>, data : memref<128xf32, strided<[1], offset: ?>>
+// CHECK:           %[[SVIEW:.*]] = memref.reinterpret_cast %[[VAL_1]] to offset: {{\[}}%{{.*}}], sizes: [1], strides: [1] : memref<*xf32> to memref<1xf32, strided<[1], offset: ?>>
+// CHECK:           memref.prefetch %[[SVIEW]]{{\[}}%{{.*}}], read, locality<3>, data : memref<1xf32, strided<[1], offset: ?>>
+// CHECK-NOT:       tt.prefetch
+// CHECK:           return
@@ -0,0 +1,39 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+// RUN: triton-opt --triton-to-linalg --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+// Offsets built from a chain of self-additions: every level uses the previous
+// one twice, so the chain is only walked in linear time if visited states are
+// reused.
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<bf16>,
+  %arg1 : !tt.ptr<bf16>
+  )
+  {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = arith.addi %0, %0 : tensor<128xi32>
+    %2 = arith.addi %1, %1 : tensor<128xi32>
+    %3 = arith.addi %2, %2 : tensor<128xi32>
+    %4 = arith.addi %3, %3 : tensor<128xi32>
+    %5 = arith.addi %4, %4 : tensor<128xi32>
+    %6 = arith.addi %5, %5 : tensor<128xi32>
+    %7 = arith.addi %6, %6 : tensor<128xi32>
+    %8 = arith.addi %7, %7 : tensor<128xi32>
+    %9 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %10 = tt.addptr %9, %8 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    %11 = tt.load %10 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xbf16>
+    %12 = tt.splat %arg1 : (!tt.ptr<bf16>) -> tensor<128x!tt.ptr<bf16>>
+    %13 = tt.addptr %12, %8 : tensor<128x!tt.ptr<bf16>>, tensor<128xi32>
+    tt.store %13, %11 : tensor<128xbf16>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           memref.reinterpret_cast %{{.*}} to offset: [0], sizes: [128], strides: [256] : memref<*xbf16> to memref<128xbf16, strided<[256]>>
+// CHECK:           memref.reinterpret_cast %{{.*}} to offset: [0], sizes: [128], strides: [256] : memref<*xbf16> to memref<128xbf16, strided<[256]>>
+
+// The first addptr misses on its splat, %arg0 and the 9 levels of the chain,
+// and hits on the second operand of each of the 8 additions. The second one
+// misses on its splat and %arg1 only, and reuses the state of %8.
+// STATS: TritonToLinalg
+// STATS-DAG: 9 ptr-state-cache-hits
+// STATS-DAG: 13 ptr-state-cache-misses
@@ -0,0 +1,163 @@
+// RUN: triton-opt --split-input-file --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @reduce_min(%arg0 : !tt.ptr<f32>, %arg1 : !tt.ptr<f32>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<128xi32>) -> tensor<128x1xi32>
+    %c32 = arith.constant 32 : i32
+    %2 = tt.splat %c32 : (i32) -> tensor<128x1xi32>
+    %3 = arith.muli %1, %2 : tensor<128x1xi32>
+    %4 = tt.broadcast %3 : (tensor<128x1xi32>) -> tensor<128x32xi32>
+    %5 = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+    %6 = tt.expand_dims %5 {axis = 0 : i32} : (tensor<32xi32>) -> tensor<1x32xi32>
+    %7 = tt.broadcast %6 : (tensor<1x32xi32>) -> tensor<128x32xi32>
+    %8 = arith.addi %4, %7 : tensor<128x32xi32>
+    %9 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x32x!tt.ptr<f32>>
+    %10 = tt.addptr %9, %8 : tensor<128x32x!tt.ptr<f32>>, tensor<128x32xi32>
+    %11 = tt.load %10 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf32>
+    %12 = "tt.reduce"(%11) ({
+    ^bb0(%a: f32, %b: f32):
+      %m = arith.minf %a, %b : f32
+      tt.reduce.return %m : f32
+    }) {axis = 0 : i32} : (tensor<128x32xf32>) -> tensor<32xf32>
+    %13 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<32x!tt.ptr<f32>>
+    %14 = tt.addptr %13, %5 : tensor<32x!tt.ptr<f32>>, tensor<32xi32>
+    tt.store %14, %12 : tensor<32xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @reduce_min(
+// CHECK:           %[[INF:.*]] = arith.constant 0x7F800000 : f32
+// CHECK:           %[[INIT:.*]] = linalg.fill ins(%[[INF]] : f32) outs(%{{.*}} : tensor<32xf32>) -> tensor<32xf32>
+// CHECK:           linalg.reduce ins(%{{.*}} : tensor<128x32xf32>) outs(%[[INIT]] : tensor<32xf32>) dimensions = [0]
+// CHECK:             arith.minf
+
+// -----
+
+module {
+  tt.func @reduce_xor(%arg0 : !tt.ptr<i32>, %arg1 : !tt.ptr<i32>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<128xi32>) -> tensor<128x1xi32>
+    %c32 = arith.constant 32 : i32
+    %2 = tt.splat %c32 : (i32) -> tensor<128x1xi32>
+    %3 = arith.muli %1, %2 : tensor<128x1xi32>
+    %4 = tt.broadcast %3 : (tensor<128x1xi32>) -> tensor<128x32xi32>
+    %5 = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+    %6 = tt.expand_dims %5 {axis = 0 : i32} : (tensor<32xi32>) -> tensor<1x32xi32>
+    %7 = tt.broadcast %6 : (tensor<1x32xi32>) -> tensor<128x32xi32>
+    %8 = arith.addi %4, %7 : tensor<128x32xi32>
+    %9 = tt.splat %arg0 : (!tt.ptr<i32>) -> tensor<128x32x!tt.ptr<i32>>
+    %10 = tt.addptr %9, %8 : tensor<128x32x!tt.ptr<i32>>, tensor<128x32xi32>
+    %11 = tt.load %10 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xi32>
+    %12 = "tt.reduce"(%11) ({
+    ^bb0(%a: i32, %b: i32):
+      %x = arith.xori %a, %b : i32
+      tt.reduce.return %x : i32
+    }) {axis = 0 : i32} : (tensor<128x32xi32>) -> tensor<32xi32>
+    %13 = tt.splat %arg1 : (!tt.ptr<i32>) -> tensor<32x!tt.ptr<i32>>
+    %14 = tt.addptr %13, %5 : tensor<32x!tt.ptr<i32>>, tensor<32xi32>
+    tt.store %14, %12 : tensor<32xi32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @reduce_xor(
+// CHECK:           %[[ZERO:.*]] = arith.constant 0 : i32
+// CHECK:           %[[INIT:.*]] = linalg.fill ins(%[[ZERO]] : i32) outs(%{{.*}} : tensor<32xi32>) -> tensor<32xi32>
+// CHECK:           linalg.reduce ins(%{{.*}} : tensor<128x32xi32>) outs(%[[INIT]] : tensor<32xi32>) dimensions = [0]
+// CHECK:             arith.xori
+
+// -----
+
+module {
+  tt.func @argmax(%arg0 : !tt.ptr<f32>, %arg1 : !tt.ptr<i32>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    %4:2 = "tt.reduce"(%3, %0) ({
+    ^bb0(%v1: f32, %i1: i32, %v2: f32, %i2: i32):
+      %gt = arith.cmpf ogt, %v1, %v2 : f32
+      %eq = arith.cmpf oeq, %v1, %v2 : f32
+      %lt = arith.cmpi slt, %i1, %i2 : i32
+      %tie = arith.andi %eq, %lt : i1
+      %pick = arith.ori %gt, %tie : i1
+      %v = arith.select %pick, %v1, %v2 : f32
+      %i = arith.select %pick, %i1, %i2 : i32
+      tt.reduce.return %v, %i : f32, i32
+    }) {axis = 0 : i32} : (tensor<128xf32>, tensor<128xi32>) -> (f32, i32)
+    tt.store %arg1, %4#1 : i32
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @argmax(
+// CHECK-DAG:       %[[NEG_INF:.*]] = arith.constant 0xFF800000 : f32
+// CHECK-DAG:       %[[MAX_IDX:.*]] = arith.constant 2147483647 : i32
+// CHECK:           %[[RES:.*]]:2 = linalg.reduce ins(%{{.*}}, %{{.*}} : tensor<128xf32>, tensor<128xi32>) outs(%{{.*}}, %{{.*}} : tensor<f32>, tensor<i32>) dimensions = [0]
+// CHECK:             arith.cmpf ogt
+// CHECK:             arith.select
+// CHECK:             arith.select
+// CHECK:             linalg.yield
+// CHECK:           %[[IDX:.*]] = tensor.extract %[[RES]]#1[] : tensor<i32>
+// CHECK:           memref.store %[[IDX]], %{{.*}}[%{{.*}}] : memref<1xi32
+
+// -----
+
+// Unsigned comparisons start the value accumulator at the unsigned bounds.
+module {
+  tt.func @argmin_unsigned(%arg0 : !tt.ptr<i32>, %arg1 : !tt.ptr<i32>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<i32>) -> tensor<128x!tt.ptr<i32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<i32>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xi32>
+    %4:2 = "tt.reduce"(%3, %0) ({
+    ^bb0(%v1: i32, %i1: i32, %v2: i32, %i2: i32):
+      %lt = arith.cmpi ult, %v1, %v2 : i32
+      %eq = arith.cmpi eq, %v1, %v2 : i32
+      %first = arith.cmpi slt, %i1, %i2 : i32
+      %tie = arith.andi %eq, %first : i1
+      %pick = arith.ori %lt, %tie : i1
+      %v = arith.select %pick, %v1, %v2 : i32
+      %i = arith.select %pick, %i1, %i2 : i32
+      tt.reduce.return %v, %i : i32, i32
+    }) {axis = 0 : i32} : (tensor<128xi32>, tensor<128xi32>) -> (i32, i32)
+    tt.store %arg1, %4#1 : i32
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @argmin_unsigned(
+// CHECK-DAG:       %[[ALL_ONES:.*]] = arith.constant -1 : i32
+// CHECK-DAG:       %[[MAX_IDX:.*]] = arith.constant 2147483647 : i32
+// CHECK:           tensor.insert %[[ALL_ONES]] into %{{.*}}[] : tensor<i32>
+// CHECK:           %[[RES:.*]]:2 = linalg.reduce ins(%{{.*}}, %{{.*}} : tensor<128xi32>, tensor<128xi32>) outs(%{{.*}}, %{{.*}} : tensor<i32>, tensor<i32>) dimensions = [0]
+// CHECK:             arith.cmpi ult
+// CHECK:             linalg.yield
+
+// -----
+
+module {
+  tt.func @argmax_unsigned(%arg0 : !tt.ptr<i32>, %arg1 : !tt.ptr<i32>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<i32>) -> tensor<128x!tt.ptr<i32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<i32>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xi32>
+    %4:2 = "tt.reduce"(%3, %0) ({
+    ^bb0(%v1: i32, %i1: i32, %v2: i32, %i2: i32):
+      %gt = arith.cmpi ugt, %v1, %v2 : i32
+      %eq = arith.cmpi eq, %v1, %v2 : i32
+      %first = arith.cmpi slt, %i1, %i2 : i32
+      %tie = arith.andi %eq, %first : i1
+      %pick = arith.ori %gt, %tie : i1
+      %v = arith.select %pick, %v1, %v2 : i32
+      %i = arith.select %pick, %i1, %i2 : i32
+      tt.reduce.return %v, %i : i32, i32
+    }) {axis = 0 : i32} : (tensor<128xi32>, tensor<128xi32>) -> (i32, i32)
+    tt.store %arg1, %4#1 : i32
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @argmax_unsigned(
+// CHECK-DAG:       %[[ZERO:.*]] = arith.constant 0 : i32
+// CHECK-DAG:       %[[MAX_IDX:.*]] = arith.constant 2147483647 : i32
+// CHECK:           tensor.insert %[[ZERO]] into %{{.*}}[] : tensor<i32>
+// CHECK:           %[[RES:.*]]:2 = linalg.reduce ins(%{{.*}}, %{{.*}} : tensor<128xi32>, tensor<128xi32>) outs(%{{.*}}, %{{.*}} : tensor<i32>, tensor<i32>) dimensions = [0]
+// CHECK:             arith.cmpi ugt
+// CHECK:             linalg.yield
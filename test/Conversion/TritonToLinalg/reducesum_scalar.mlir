@@ -22,17 +22,11 @@ module {
 // CHECK:           %[[VAL_7:.*]] = memref.alloc() : memref<128xbf16>
 // CHECK:           memref.copy %[[VAL_6]], %[[VAL_7]] : memref<128xbf16, strided<[1]>> to memref<128xbf16>
 // CHECK:           %[[VAL_8:.*]] = bufferization.to_tensor %[[VAL_7]] restrict writable : memref<128xbf16>
-// CHECK:           %[[VAL_9:.*]] = bufferization.alloc_tensor() : tensor<f32>
-// CHECK:           %[[VAL_10:.*]] = tensor.insert %[[VAL_5]] into %[[VAL_9]][] : tensor<f32>
-// CHECK:           %[[VAL_11:.*]] = linalg.reduce ins(%[[VAL_8]] : tensor<128xbf16>) outs(%[[VAL_10]] : tensor<f32>) dimensions = [0]
-// CHECK:             (%[[VAL_12:.*]]: bf16, %[[VAL_13:.*]]: f32) {
-// CHECK:               %[[VAL_14:.*]] = arith.extf %[[VAL_12]] : bf16 to f32
-// CHECK:               %[[VAL_15:.*]] = arith.addf %[[VAL_14]], %[[VAL_13]] : f32
-// CHECK:               linalg.yield %[[VAL_15]] : f32
-// CHECK:             }
-// CHECK:           %[[VAL_16:.*]] = tensor.extract %[[VAL_11]][] : tensor<f32>
+// CHECK:           %[[VAL_9:.*]] = vector.transfer_read %[[VAL_8]]{{\[}}%{{.*}}], %{{.*}} {in_bounds = [true]} : tensor<128xbf16>, vector<128xbf16>
+// CHECK:           %[[VAL_10:.*]] = arith.extf %[[VAL_9]] : vector<128xbf16> to vector<128xf32>
+// CHECK:           %[[VAL_16:.*]] = vector.reduction <add>, %[[VAL_10]], %[[VAL_5]] : vector<128xf32> into f32
 // CHECK:           %[[VAL_17:.*]] = arith.truncf %[[VAL_16]] : f32 to bf16
 // CHECK:           %[[VAL_18:.*]] = memref.reinterpret_cast %[[VAL_1]] to offset: [0], sizes: [1], strides: [1] : memref<*xbf16> to memref<1xbf16, strided<[1]>>
-// CHECK:           affine.store %[[VAL_17]], %[[VAL_18]][0] : memref<1xbf16, strided<[1]>>
+// CHECK:           memref.store %[[VAL_17]], %[[VAL_18]]{{\[}}%{{.*}}] : memref<1xbf16, strided<[1]>>
 // CHECK:           return
 // CHECK:         }
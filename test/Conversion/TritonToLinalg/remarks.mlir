@@ -0,0 +1,25 @@
+// RUN: env TRITON_REMARKS=1 triton-opt --triton-to-linalg %s -verify-diagnostics
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %1 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %ldptr = tt.addptr %0, %2 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %stptr = tt.addptr %1, %2 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %zeros = arith.constant dense<0.000000e+00> : tensor<128xf32>
+    // checkerboard mask: (%2 % 2) == 0
+    %c2 = arith.constant dense<2> : tensor<128xi32>
+    %c0 = arith.constant dense<0> : tensor<128xi32>
+    %rem = arith.remsi %2, %c2 : tensor<128xi32>
+    %mask = arith.cmpi eq, %rem, %c0 : tensor<128xi32>
+    // expected-remark @+1 {{[triton-to-linalg] the mask is not a contiguous window, lowering to predicated accesses of single elements}}
+    %buff = tt.load %ldptr, %mask, %zeros {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    // expected-remark @+1 {{[triton-to-linalg] the mask is not a contiguous window, lowering to predicated accesses of single elements}}
+    tt.store %stptr, %buff, %mask : tensor<128xf32>
+    tt.return
+  }
+}
@@ -0,0 +1,32 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<i32>,
+  %arg1 : !tt.ptr<i32>,
+  %arg2 : i32
+  )
+  {
+    // arg1[0] = (arg2 < 128) ? arg0[arg2] : undefined
+    %0 = tt.addptr %arg0, %arg2 : !tt.ptr<i32>, i32
+    %c128 = arith.constant 128 : i32
+    %1 = arith.cmpi slt, %arg2, %c128 : i32
+    %2 = tt.load %0, %1 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : i32
+    tt.store %arg1, %2 : i32
+    tt.return
+  }
+}
+// A masked scalar load without other yields zero where the mask is off.
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xi32>, %[[VAL_1:.*]]: memref<*xi32>, %[[VAL_2:.*]]: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK-DAG:       %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:       %[[ZERO:.*]] = arith.constant 0 : i32
+// CHECK:           %[[VIEW:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: {{\[}}%{{.*}}], sizes: [1], strides: [1] : memref<*xi32> to memref<1xi32, strided<[1], offset: ?>>
+// CHECK:           %[[MASK:.*]] = arith.cmpi slt, %[[VAL_2]], %{{.*}} : i32
+// CHECK:           %[[VAL:.*]] = scf.if %[[MASK]] -> (i32) {
+// CHECK:             %[[LD:.*]] = memref.load %[[VIEW]]{{\[}}%[[C0]]] : memref<1xi32, strided<[1], offset: ?>>
+// CHECK:             scf.yield %[[LD]] : i32
+// CHECK:           } else {
+// CHECK:             scf.yield %[[ZERO]] : i32
+// CHECK:           }
+// CHECK:           memref.store %[[VAL]], %{{.*}}{{\[}}%[[C0]]] : memref<1xi32, strided<[1]>>
+// CHECK:           return
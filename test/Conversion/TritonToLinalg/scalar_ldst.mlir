@@ -0,0 +1,39 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>,
+  %arg2 : i32
+  )
+  {
+    // scale = *arg0; arg1[arg2] = (arg2 < 128) ? arg1[arg2] * scale : unchanged
+    %0 = tt.load %arg0 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : f32
+    %1 = tt.addptr %arg1, %arg2 : !tt.ptr<f32>, i32
+    %c128 = arith.constant 128 : i32
+    %2 = arith.cmpi slt, %arg2, %c128 : i32
+    %cst = arith.constant 0.000000e+00 : f32
+    %3 = tt.load %1, %2, %cst {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : f32
+    %4 = arith.mulf %3, %0 : f32
+    tt.store %1, %4, %2 : f32
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xf32>, %[[VAL_1:.*]]: memref<*xf32>, %[[VAL_2:.*]]: i32, %[[VAL_3:.*]]: i32, %[[VAL_4:.*]]: i32, %[[VAL_5:.*]]: i32) {
+// CHECK-DAG:       %[[C0:.*]] = arith.constant 0 : index
+// CHECK-DAG:       %[[CST:.*]] = arith.constant 0.000000e+00 : f32
+// CHECK:           %[[SCALE_VIEW:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: [0], sizes: [1], strides: [1] : memref<*xf32> to memref<1xf32, strided<[1]>>
+// CHECK:           %[[SCALE:.*]] = memref.load %[[SCALE_VIEW]]{{\[}}%[[C0]]] : memref<1xf32, strided<[1]>>
+// CHECK:           %[[VIEW:.*]] = memref.reinterpret_cast %[[VAL_1]] to offset: {{\[}}%{{.*}}], sizes: [1], strides: [1] : memref<*xf32> to memref<1xf32, strided<[1], offset: ?>>
+// CHECK:           %[[MASK:.*]] = arith.cmpi slt, %[[VAL_2]], %{{.*}} : i32
+// CHECK:           %[[VAL:.*]] = scf.if %[[MASK]] -> (f32) {
+// CHECK:             %[[LD:.*]] = memref.load %[[VIEW]]{{\[}}%[[C0]]] : memref<1xf32, strided<[1], offset: ?>>
+// CHECK:             scf.yield %[[LD]] : f32
+// CHECK:           } else {
+// CHECK:             scf.yield %[[CST]] : f32
+// CHECK:           }
+// CHECK:           %[[RES:.*]] = arith.mulf %[[VAL]], %[[SCALE]] : f32
+// CHECK:           scf.if %[[MASK]] {
+// CHECK:             memref.store %[[RES]], %[[VIEW]]{{\[}}%[[C0]]] : memref<1xf32, strided<[1], offset: ?>>
+// CHECK:           }
+// CHECK:           return
@@ -0,0 +1,38 @@
+// RUN: triton-opt --split-input-file --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @cumsum(%arg0 : !tt.ptr<f32>, %arg1 : !tt.ptr<f32>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<128xi32>) -> tensor<128x1xi32>
+    %c32 = arith.constant 32 : i32
+    %2 = tt.splat %c32 : (i32) -> tensor<128x1xi32>
+    %3 = arith.muli %1, %2 : tensor<128x1xi32>
+    %4 = tt.broadcast %3 : (tensor<128x1xi32>) -> tensor<128x32xi32>
+    %5 = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+    %6 = tt.expand_dims %5 {axis = 0 : i32} : (tensor<32xi32>) -> tensor<1x32xi32>
+    %7 = tt.broadcast %6 : (tensor<1x32xi32>) -> tensor<128x32xi32>
+    %8 = arith.addi %4, %7 : tensor<128x32xi32>
+    %9 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x32x!tt.ptr<f32>>
+    %10 = tt.addptr %9, %8 : tensor<128x32x!tt.ptr<f32>>, tensor<128x32xi32>
+    %11 = tt.load %10 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf32>
+    %12 = "tt.scan"(%11) ({
+    ^bb0(%a: f32, %b: f32):
+      %s = arith.addf %a, %b : f32
+      tt.scan.return %s : f32
+    }) {axis = 0 : i32} : (tensor<128x32xf32>) -> tensor<128x32xf32>
+    %13 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x32x!tt.ptr<f32>>
+    %14 = tt.addptr %13, %8 : tensor<128x32x!tt.ptr<f32>>, tensor<128x32xi32>
+    tt.store %14, %12 : tensor<128x32xf32>
+    tt.return
+  }
+}
+// Each row is combined with the scan of the row before it
+// CHECK-LABEL:   func.func @cumsum(
+// CHECK:           %[[C1:.*]] = arith.constant 1 : index
+// CHECK:           %[[N:.*]] = arith.constant 128 : index
+// CHECK:           %[[SCAN:.*]] = scf.for %[[IV:.*]] = %[[C1]] to %[[N]] step %[[C1]] iter_args(%[[ACC:.*]] = %{{.*}}) -> (tensor<128x32xf32>) {
+// CHECK:             %[[PREV:.*]] = tensor.extract_slice %[[ACC]]{{.*}} : tensor<128x32xf32> to tensor<1x32xf32>
+// CHECK:             %[[CUR:.*]] = tensor.extract_slice %[[ACC]][%[[IV]], 0] [1, 32] [1, 1] : tensor<128x32xf32> to tensor<1x32xf32>
+// CHECK:             %[[ROW:.*]] = linalg.generic {{.*}} ins(%[[PREV]], %[[CUR]] : tensor<1x32xf32>, tensor<1x32xf32>) outs(%{{.*}} : tensor<1x32xf32>)
+// CHECK:               arith.addf
+// CHECK:             %[[NEXT:.*]] = tensor.insert_slice %[[ROW]] into %[[ACC]][%[[IV]], 0] [1, 32] [1, 1] : tensor<1x32xf32> into tensor<128x32xf32>
+// CHECK:             scf.yield %[[NEXT]] : tensor<128x32xf32>
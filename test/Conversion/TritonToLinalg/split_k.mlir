@@ -0,0 +1,101 @@
+// RUN: triton-opt --split-input-file --triton-linalg-split-k="split-k=4" %s | FileCheck %s
+// RUN: triton-opt --split-input-file --triton-linalg-split-k %s | FileCheck %s --check-prefix=NOSPLIT
+
+module {
+  func.func @matmul(%arg0: memref<*xf32>, %arg1: memref<*xf32>, %arg2: memref<32x32xf32>, %arg3: i32, %arg4: i32, %arg5: i32, %arg6: i32) {
+    %c0 = arith.constant 0 : index
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c32 = arith.constant 32 : index
+    %cst = arith.constant 0.000000e+00 : f32
+    %0 = tensor.empty() : tensor<32x32xf32>
+    %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<32x32xf32>) -> tensor<32x32xf32>
+    %2:2 = scf.for %iv = %c0_i32 to %arg3 step %c1_i32 iter_args(%acc = %1, %off = %c0) -> (tensor<32x32xf32>, index) : i32 {
+      %a = memref.reinterpret_cast %arg0 to offset: [%off], sizes: [32, 32], strides: [32, 1] : memref<*xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+      %b = memref.reinterpret_cast %arg1 to offset: [%off], sizes: [32, 32], strides: [32, 1] : memref<*xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+      %abuf = memref.alloc() : memref<32x32xf32>
+      memref.copy %a, %abuf : memref<32x32xf32, strided<[32, 1], offset: ?>> to memref<32x32xf32>
+      %at = bufferization.to_tensor %abuf restrict writable : memref<32x32xf32>
+      %bbuf = memref.alloc() : memref<32x32xf32>
+      memref.copy %b, %bbuf : memref<32x32xf32, strided<[32, 1], offset: ?>> to memref<32x32xf32>
+      %bt = bufferization.to_tensor %bbuf restrict writable : memref<32x32xf32>
+      %3 = linalg.matmul ins(%at, %bt : tensor<32x32xf32>, tensor<32x32xf32>) outs(%acc : tensor<32x32xf32>) -> tensor<32x32xf32>
+      %next = arith.addi %off, %c32 : index
+      scf.yield %3, %next : tensor<32x32xf32>, index
+    }
+    memref.tensor_store %2#0, %arg2 : memref<32x32xf32>
+    return
+  }
+}
+// Each of the 4 programs runs the loop up to the end of its chunk of
+// ceil(%arg3 / 4) iterations, only loading and accumulating in its chunk, and
+// writes its accumulator to its slice of the workspace, which is then summed.
+// CHECK-LABEL: func.func @matmul
+// CHECK:         %[[INIT:.*]] = linalg.fill
+// CHECK:         %[[WS:.*]] = memref.alloc() : memref<4x32x32xf32>
+// CHECK:         scf.parallel (%[[SPLIT:.*]]) = (%{{.*}}) to (%{{.*}}) step (%{{.*}}) {
+// CHECK:           %[[SPLIT_I32:.*]] = arith.index_cast %[[SPLIT]] : index to i32
+// CHECK:           %[[TRIPS:.*]] = arith.ceildivsi
+// CHECK:           %[[CHUNK:.*]] = arith.ceildivsi %[[TRIPS]]
+// CHECK:           %[[START:.*]] = arith.addi
+// CHECK:           %[[END:.*]] = arith.minsi %arg3
+// CHECK:           %[[ZERO:.*]] = linalg.fill
+// CHECK:           %[[LOOP:.*]]:2 = scf.for %[[IV:.*]] = %{{.*}} to %[[END]] step %{{.*}} iter_args(%[[ACC:.*]] = %[[ZERO]], %[[OFF:.*]] = %{{.*}})
+// CHECK:             %[[NEXT:.*]] = arith.addi %[[OFF]]
+// CHECK:             %[[IN_CHUNK:.*]] = arith.cmpi sge, %[[IV]], %[[START]] : i32
+// CHECK:             %[[PARTIAL:.*]] = scf.if %[[IN_CHUNK]] -> (tensor<32x32xf32>) {
+// CHECK:               memref.reinterpret_cast
+// CHECK:               memref.reinterpret_cast
+// CHECK:               memref.copy
+// CHECK:               memref.copy
+// CHECK:               %[[MATMUL:.*]] = linalg.matmul {{.*}} outs(%[[ACC]] : tensor<32x32xf32>)
+// CHECK:               scf.yield %[[MATMUL]]
+// CHECK:             } else {
+// CHECK:               scf.yield %[[ACC]]
+// CHECK:             }
+// CHECK:             scf.yield %[[PARTIAL]], %[[NEXT]]
+// CHECK:           }
+// CHECK:           %[[SLICE:.*]] = memref.subview %[[WS]][%[[SPLIT]], 0, 0] [1, 32, 32] [1, 1, 1]
+// CHECK:           memref.tensor_store %[[LOOP]]#0, %[[SLICE]]
+// CHECK:         }
+// CHECK:         %[[PARTIALS:.*]] = bufferization.to_tensor %[[WS]] restrict writable : memref<4x32x32xf32>
+// CHECK:         %[[SUM:.*]] = linalg.reduce ins(%[[PARTIALS]] : tensor<4x32x32xf32>) outs(%[[INIT]] : tensor<32x32xf32>) dimensions = [0]
+// CHECK:           arith.addf
+// CHECK:         memref.dealloc %[[WS]]
+// CHECK:         memref.tensor_store %[[SUM]], %arg2
+
+// NOSPLIT-LABEL: func.func @matmul
+// NOSPLIT-NOT:     scf.parallel
+// NOSPLIT-NOT:     linalg.reduce
+
+// -----
+
+// The offset the loop carries is stored after it, so that its final value
+// has to be the one of the whole loop.
+module {
+  func.func @used_offset(%arg0: memref<*xf32>, %arg1: memref<32x32xf32>, %arg2: memref<index>, %arg3: i32) {
+    %c0 = arith.constant 0 : index
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c32 = arith.constant 32 : index
+    %cst = arith.constant 0.000000e+00 : f32
+    %0 = tensor.empty() : tensor<32x32xf32>
+    %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<32x32xf32>) -> tensor<32x32xf32>
+    %2:2 = scf.for %iv = %c0_i32 to %arg3 step %c1_i32 iter_args(%acc = %1, %off = %c0) -> (tensor<32x32xf32>, index) : i32 {
+      %a = memref.reinterpret_cast %arg0 to offset: [%off], sizes: [32, 32], strides: [32, 1] : memref<*xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+      %abuf = memref.alloc() : memref<32x32xf32>
+      memref.copy %a, %abuf : memref<32x32xf32, strided<[32, 1], offset: ?>> to memref<32x32xf32>
+      %at = bufferization.to_tensor %abuf restrict writable : memref<32x32xf32>
+      %3 = linalg.matmul ins(%at, %at : tensor<32x32xf32>, tensor<32x32xf32>) outs(%acc : tensor<32x32xf32>) -> tensor<32x32xf32>
+      %next = arith.addi %off, %c32 : index
+      scf.yield %3, %next : tensor<32x32xf32>, index
+    }
+    memref.tensor_store %2#0, %arg1 : memref<32x32xf32>
+    memref.store %2#1, %arg2[] : memref<index>
+    return
+  }
+}
+// CHECK-LABEL: func.func @used_offset
+// CHECK-NOT:     scf.parallel
+// CHECK:         scf.for
+// CHECK-NOT:     linalg.reduce
@@ -0,0 +1,39 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32> {tt.divisibility = 16 : i32},
+    %arg1 : !tt.ptr<f32> {tt.divisibility = 16 : i32},
+    %arg2 : i32 {tt.divisibility = 16 : i32}
+  )
+  {
+    // stride argument specialized to 1 by the JIT
+    %c1 = arith.constant 1 : i32
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %c1 : (i32) -> tensor<128xi32>
+    %2 = arith.muli %0, %1 : tensor<128xi32>
+    // offset = %arg2, size = 128, stride = 1
+    %3 = tt.splat %arg2 : (i32) -> tensor<128xi32>
+    %4 = arith.addi %2, %3 : tensor<128xi32>
+    %5 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %6 = tt.addptr %5, %4 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %7 = tt.load %6 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    // offset = 0, size = 128, stride = 1
+    %8 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %9 = tt.addptr %8, %2 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    tt.store %9, %7 : tensor<128xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[ARG0:.*]]: memref<*xf32> {tt.divisibility = 16 : i32}, %[[ARG1:.*]]: memref<*xf32> {tt.divisibility = 16 : i32}, %[[ARG2:.*]]: i32 {tt.divisibility = 16 : i32}, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32) {
+// CHECK:           %[[OFF:.*]] = arith.index_cast %[[ARG2]] : i32 to index
+// CHECK:           %[[SRC:.*]] = memref.reinterpret_cast %[[ARG0]] to offset: {{\[}}%[[OFF]]], sizes: [128], strides: [1] {Alignment = 16 : i64} : memref<*xf32> to memref<128xf32, strided<[1], offset: ?>>
+// CHECK:           memref.assume_alignment %[[SRC]], 16 : memref<128xf32, strided<[1], offset: ?>>
+// CHECK:           %[[BUF:.*]] = memref.alloc() : memref<128xf32>
+// CHECK:           memref.copy %[[SRC]], %[[BUF]] : memref<128xf32, strided<[1], offset: ?>> to memref<128xf32>
+// CHECK:           %[[VAL:.*]] = bufferization.to_tensor %[[BUF]]
+// CHECK:           %[[DST:.*]] = memref.reinterpret_cast %[[ARG1]] to offset: [0], sizes: [128], strides: [1] {Alignment = 16 : i64} : memref<*xf32> to memref<128xf32, strided<[1]>>
+// CHECK:           memref.assume_alignment %[[DST]], 16 : memref<128xf32, strided<[1]>>
+// CHECK:           memref.tensor_store %[[VAL]], %[[DST]] : memref<128xf32, strided<[1]>>
+// CHECK:           return
+// CHECK:         }
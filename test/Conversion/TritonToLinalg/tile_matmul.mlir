@@ -0,0 +1,35 @@
+// RUN: triton-opt --triton-linalg-tile-matmul="l1-cache-size=4096 l2-cache-size=32768 vector-bits=256 vector-registers=16" %s | FileCheck %s
+// RUN: triton-opt --triton-linalg-tile-matmul="l1-cache-size=4096 l2-cache-size=32768 vector-bits=256 vector-registers=16 pack-operands=false" %s | FileCheck %s --check-prefix=NOPACK
+module {
+  func.func @matmul(%arg0: memref<*xf32>, %arg1: memref<*xf32>, %arg2: index, %arg3: index, %arg4: memref<128x128xf32>) {
+    %a = memref.reinterpret_cast %arg0 to offset: [0], sizes: [128, 128], strides: [%arg2, 1] : memref<*xf32> to memref<128x128xf32, strided<[?, 1]>>
+    %b = memref.reinterpret_cast %arg1 to offset: [0], sizes: [128, 128], strides: [%arg3, 1] : memref<*xf32> to memref<128x128xf32, strided<[?, 1]>>
+    linalg.matmul ins(%a, %b : memref<128x128xf32, strided<[?, 1]>>, memref<128x128xf32, strided<[?, 1]>>) outs(%arg4 : memref<128x128xf32>)
+    return
+  }
+}
+// The 8 x 8 register tiles of f32 in 16 vectors of 256 bits accumulate
+// blocks of 64 rows of B, whose 64 x 8 panels fill half of L1, and of 64 x 64
+// of A, which fill half of L2. The blocks of B are packed in front of the
+// loop over the blocks of A.
+// CHECK-LABEL: func.func @matmul
+// CHECK:         scf.for %{{.*}} = %{{.*}} to %{{.*}} step %{{.*}} {
+// CHECK:           %[[B:.*]] = memref.alloc() {alignment = 64 : i64} : memref<64x128xf32>
+// CHECK:           linalg.generic {{.*}} outs(%[[B]] : memref<64x128xf32>)
+// CHECK:           scf.for %{{.*}} = %{{.*}} to %{{.*}} step %{{.*}} {
+// CHECK:             %[[A:.*]] = memref.alloc() {alignment = 64 : i64} : memref<64x64xf32>
+// CHECK:             linalg.generic {{.*}} outs(%[[A]] : memref<64x64xf32>)
+// CHECK:             scf.for
+// CHECK:               scf.for
+// CHECK:                 vector.transfer_read
+// CHECK:                 vector.transfer_read
+// CHECK:                 vector.outerproduct {{.*}} : vector<8xf32>, vector<8xf32>
+// CHECK:                 vector.transfer_write
+// CHECK:             memref.dealloc %[[A]]
+// CHECK:           memref.dealloc %[[B]]
+// CHECK-NOT:     linalg.matmul
+
+// NOPACK-LABEL: func.func @matmul
+// NOPACK-NOT:     memref.alloc
+// NOPACK:         vector.outerproduct {{.*}} : vector<8xf32>, vector<8xf32>
+// NOPACK-NOT:     linalg.matmul
@@ -0,0 +1,37 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<bf16>,
+  %arg1 : !tt.ptr<i32>
+  )
+  {
+  %0 = tt.make_range {end = 768 : i32, start = 512 : i32}:tensor<256xi32>
+  // offset = [512] size = 256, stride = 1
+  %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<256xi32>) -> tensor<256x1xi32>
+  // offset = [512,0], size = [256,1], stride = [1,0]
+  // mixed use: stored as data, and the offsets of both accesses
+  %2 = tt.broadcast %1 : (tensor<256x1xi32>) -> tensor<256x128xi32>
+  // offset = [512,0], size = [256,128], stride = [1,0]
+  %3 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<256x128x!tt.ptr<bf16>>
+  %4 = tt.addptr %3, %2 : tensor<256x128x!tt.ptr<bf16>>, tensor<256x128xi32>
+  %5 = tt.load %4 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<256x128xbf16>
+  tt.store %4, %5 : tensor<256x128xbf16>
+  %6 = tt.splat %arg1 : (!tt.ptr<i32>) -> tensor<256x1x!tt.ptr<i32>>
+  %7 = tt.addptr %6, %1 : tensor<256x1x!tt.ptr<i32>>, tensor<256x1xi32>
+  tt.store %7, %1 : tensor<256x1xi32>
+  tt.return
+  }
+}
+// Only the offsets that are stored are materialized, the broadcast only
+// feeds the pointers
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-NOT:       tensor<256x128xi32>
+// CHECK:           %[[RANGE:.*]] = linalg.generic {{.*}} outs(%{{.*}} : tensor<256xi32>)
+// CHECK:           linalg.index 0 : index
+// CHECK:           %[[EXPANDED:.*]] = tensor.expand_shape %{{.*}} {{\[\[}}0, 1]] : tensor<256xi32> into tensor<256x1xi32>
+// CHECK-NOT:       tensor<256x128xi32>
+// CHECK:           memref.reinterpret_cast %{{.*}} to offset: {{\[}}512], sizes: [256, 128], strides: [1, 0] : memref<*xbf16>
+// CHECK-NOT:       tensor<256x128xi32>
+// CHECK:           memref.reinterpret_cast %{{.*}} to offset: {{\[}}512], sizes: [256, 1], strides: [1, 0] : memref<*xi32>
+// CHECK:           memref.tensor_store %[[EXPANDED]]
+// CHECK:           return
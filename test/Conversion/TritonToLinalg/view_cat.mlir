@@ -0,0 +1,32 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+module {
+  tt.func @kernel(
+    %arg0 : !tt.ptr<f32>,
+    %arg1 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    // 128 -> 2x64 is an expand, 2x64 -> 4x32 needs a collapse first
+    %4 = tt.view %3 : (tensor<128xf32>) -> tensor<2x64xf32>
+    %5 = tt.view %4 : (tensor<2x64xf32>) -> tensor<4x32xf32>
+    %6 = tt.cat %5, %5 : (tensor<4x32xf32>, tensor<4x32xf32>) -> tensor<8x32xf32>
+    %7 = tt.view %6 : (tensor<8x32xf32>) -> tensor<256xf32>
+    %8 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32>
+    %9 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>>
+    %10 = tt.addptr %9, %8 : tensor<256x!tt.ptr<f32>>, tensor<256xi32>
+    tt.store %10, %7 : tensor<256xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK:           %[[LOAD:.*]] = bufferization.to_tensor
+// The collapse of the expand of the load folds away.
+// CHECK:           %[[VIEW:.*]] = tensor.expand_shape %[[LOAD]] {{\[}}[0, 1]] : tensor<128xf32> into tensor<4x32xf32>
+// CHECK:           %[[EMPTY:.*]] = tensor.empty() : tensor<8x32xf32>
+// CHECK:           %[[LHS:.*]] = tensor.insert_slice %[[VIEW]] into %[[EMPTY]][0, 0] [4, 32] [1, 1] : tensor<4x32xf32> into tensor<8x32xf32>
+// CHECK:           %[[CAT:.*]] = tensor.insert_slice %[[VIEW]] into %[[LHS]][4, 0] [4, 32] [1, 1] : tensor<4x32xf32> into tensor<8x32xf32>
+// CHECK:           %[[RES:.*]] = tensor.collapse_shape %[[CAT]] {{\[}}[0, 1]] : tensor<8x32xf32> into tensor<256xf32>
+// CHECK:           memref.tensor_store %[[RES]]
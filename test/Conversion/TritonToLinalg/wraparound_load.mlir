@@ -0,0 +1,54 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+// offs = (start + arange(0, 128)) % M, as used in the matmul tutorial to keep
+// loads in bounds.
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>,
+  %arg2 : i32,
+  %arg3 : i32
+  )
+  {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = tt.splat %arg2 : (i32) -> tensor<128xi32>
+    %2 = arith.addi %1, %0 : tensor<128xi32>
+    %3 = tt.splat %arg3 : (i32) -> tensor<128xi32>
+    %4 = arith.remsi %2, %3 : tensor<128xi32>
+    %5 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %6 = tt.addptr %5, %4 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %7 = tt.load %6 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    %8 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %9 = tt.addptr %8, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    tt.store %9, %7 : tensor<128xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xf32>, %[[VAL_1:.*]]: memref<*xf32>, %[[VAL_2:.*]]: i32, %[[VAL_3:.*]]: i32,
+// CHECK-DAG:       %[[START:.*]] = arith.index_cast %[[VAL_2]] : i32 to index
+// CHECK-DAG:       %[[BOUND:.*]] = arith.index_cast %[[VAL_3]] : i32 to index
+// CHECK:           %[[OFFSET:.*]] = arith.remsi %[[START]], %[[BOUND]] : index
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<128xf32>
+// CHECK:           %[[REM:.*]] = arith.subi %[[BOUND]], %[[OFFSET]] : index
+// CHECK:           %[[FIRST:.*]] = arith.minsi %[[REM]], %{{.*}} : index
+// CHECK:           %[[VIEW_0:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: {{\[}}%[[OFFSET]]], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1], offset: ?>>
+// CHECK:           %[[SRC_0:.*]] = memref.subview %[[VIEW_0]][0] {{\[}}%[[FIRST]]] [1]
+// CHECK:           %[[DST_0:.*]] = memref.subview %[[ALLOC]][0] {{\[}}%[[FIRST]]] [1]
+// CHECK:           memref.copy %[[SRC_0]], %[[DST_0]]
+// CHECK:           scf.while (%[[POS:.*]] = %[[FIRST]], %[[SHIFT:.*]] = %[[BOUND]]) : (index, index) -> (index, index) {
+// CHECK:             %[[MORE:.*]] = arith.cmpi slt, %[[POS]], %{{.*}} : index
+// CHECK:             scf.condition(%[[MORE]]) %[[POS]], %[[SHIFT]] : index, index
+// CHECK:           } do {
+// CHECK:           ^bb0(%[[CHUNK_POS:.*]]: index, %[[CHUNK_SHIFT:.*]]: index):
+// CHECK:             %[[VIEW_1:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: [%{{.*}}], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1], offset: ?>>
+// CHECK:             %[[SRC_1:.*]] = memref.subview %[[VIEW_1]][0] {{\[}}%[[CHUNK_SIZE:.*]]] [1]
+// CHECK:             %[[DST_1:.*]] = memref.subview %[[ALLOC]]{{\[}}%[[CHUNK_POS]]] {{\[}}%[[CHUNK_SIZE]]] [1]
+// CHECK:             memref.copy %[[SRC_1]], %[[DST_1]]
+// CHECK:             %[[NEXT_POS:.*]] = arith.addi %[[CHUNK_POS]], %[[CHUNK_SIZE]] : index
+// CHECK:             %[[NEXT_SHIFT:.*]] = arith.addi %[[CHUNK_SHIFT]], %[[BOUND]] : index
+// CHECK:             scf.yield %[[NEXT_POS]], %[[NEXT_SHIFT]] : index, index
+// CHECK:           }
+// CHECK:           %[[DATA:.*]] = bufferization.to_tensor %[[ALLOC]] : memref<128xf32>
+// CHECK:           memref.tensor_store %[[DATA]], %{{.*}} : memref<128xf32, strided<[1]>>
+// CHECK:           return
+// CHECK:         }
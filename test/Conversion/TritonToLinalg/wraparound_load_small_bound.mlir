@@ -0,0 +1,49 @@
+// RUN: triton-opt --triton-to-linalg %s | FileCheck %s
+// offs = arange(0, 128) % 48 wraps around twice within the tile, as when
+// BLOCK_M > M in the matmul tutorial.
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %1 = arith.constant dense<48> : tensor<128xi32>
+    %2 = arith.remsi %0, %1 : tensor<128xi32>
+    %3 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %4 = tt.addptr %3, %2 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    %5 = tt.load %4 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32>
+    %6 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+    %7 = tt.addptr %6, %0 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+    tt.store %7, %5 : tensor<128xf32>
+    tt.return
+  }
+}
+// The first 48 elements are copied before the loop, which then copies the
+// chunks [48, 96) and [96, 128), each shifted back by a multiple of 48.
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xf32>, %[[VAL_1:.*]]: memref<*xf32>,
+// CHECK:           %[[ALLOC:.*]] = memref.alloc() : memref<128xf32>
+// CHECK:           %[[VIEW_0:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: {{.*}}, sizes: [128], strides: [1]
+// CHECK:           %[[SRC_0:.*]] = memref.subview %[[VIEW_0]][0] {{\[}}%[[FIRST:.*]]] [1]
+// CHECK:           %[[DST_0:.*]] = memref.subview %[[ALLOC]][0] {{\[}}%[[FIRST]]] [1]
+// CHECK:           memref.copy %[[SRC_0]], %[[DST_0]]
+// CHECK:           scf.while (%[[POS:.*]] = %[[FIRST]], %[[SHIFT:.*]] = %[[BOUND:.*]]) : (index, index) -> (index, index) {
+// CHECK:             %[[MORE:.*]] = arith.cmpi slt, %[[POS]], %{{.*}} : index
+// CHECK:             scf.condition(%[[MORE]]) %[[POS]], %[[SHIFT]] : index, index
+// CHECK:           } do {
+// CHECK:           ^bb0(%[[CHUNK_POS:.*]]: index, %[[CHUNK_SHIFT:.*]]: index):
+// CHECK:             %[[LEFT:.*]] = arith.subi %{{.*}}, %[[CHUNK_POS]] : index
+// CHECK:             %[[CHUNK_SIZE:.*]] = arith.minsi %{{.*}}, %[[LEFT]] : index
+// CHECK:             %[[VIEW_1:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: [%{{.*}}], sizes: [128], strides: [1] : memref<*xf32> to memref<128xf32, strided<[1], offset: ?>>
+// CHECK:             %[[SRC_1:.*]] = memref.subview %[[VIEW_1]][0] {{\[}}%[[CHUNK_SIZE]]] [1]
+// CHECK:             %[[DST_1:.*]] = memref.subview %[[ALLOC]]{{\[}}%[[CHUNK_POS]]] {{\[}}%[[CHUNK_SIZE]]] [1]
+// CHECK:             memref.copy %[[SRC_1]], %[[DST_1]]
+// CHECK:             %[[NEXT_POS:.*]] = arith.addi %[[CHUNK_POS]], %[[CHUNK_SIZE]] : index
+// CHECK:             %[[NEXT_SHIFT:.*]] = arith.addi %[[CHUNK_SHIFT]], %[[BOUND]] : index
+// CHECK:             scf.yield %[[NEXT_POS]], %[[NEXT_SHIFT]] : index, index
+// CHECK:           }
+// CHECK:           %[[DATA:.*]] = bufferization.to_tensor %[[ALLOC]] : memref<128xf32>
+// CHECK:           memref.tensor_store %[[DATA]], %{{.*}} : memref<128xf32, strided<[1]>>
+// CHECK:           return
+// CHECK:         }
@@ -0,0 +1,33 @@
+// RUN: triton-opt --triton-to-linalg="zero-copy-loads=true" %s | FileCheck %s
+module {
+  tt.func @kernel(
+  %arg0 : !tt.ptr<f32>,
+  %arg1 : !tt.ptr<f32>,
+  %arg2 : !tt.ptr<f32>
+  )
+  {
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32>
+    // %arg0 is only read from: loaded in place without a copy
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>>
+    %2 = tt.addptr %1, %0 : tensor<1024x!tt.ptr<f32>>, tensor<1024xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32>
+    // %arg1 is also stored to: keep the copy
+    %4 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>>
+    %5 = tt.addptr %4, %0 : tensor<1024x!tt.ptr<f32>>, tensor<1024xi32>
+    %6 = tt.load %5 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32>
+    %7 = arith.addf %3, %6 : tensor<1024xf32>
+    tt.store %5, %7 : tensor<1024xf32>
+    tt.return
+  }
+}
+// CHECK-LABEL:   func.func @kernel(
+// CHECK-SAME:                      %[[VAL_0:.*]]: memref<*xf32>, %[[VAL_1:.*]]: memref<*xf32>, %[[VAL_2:.*]]: memref<*xf32>, %[[VAL_3:.*]]: i32, %[[VAL_4:.*]]: i32, %[[VAL_5:.*]]: i32) {
+// CHECK:           %[[VAL_6:.*]] = memref.reinterpret_cast %[[VAL_0]] to offset: [0], sizes: [1024], strides: [1] : memref<*xf32> to memref<1024xf32, strided<[1]>>
+// CHECK:           %[[VAL_7:.*]] = bufferization.to_tensor %[[VAL_6]] restrict : memref<1024xf32, strided<[1]>>
+// CHECK:           %[[VAL_8:.*]] = memref.reinterpret_cast %[[VAL_1]] to offset: [0], sizes: [1024], strides: [1] : memref<*xf32> to memref<1024xf32, strided<[1]>>
+// CHECK:           %[[VAL_9:.*]] = memref.alloc() : memref<1024xf32>
+// CHECK:           memref.copy %[[VAL_8]], %[[VAL_9]] : memref<1024xf32, strided<[1]>> to memref<1024xf32>
+// CHECK:           %[[VAL_10:.*]] = bufferization.to_tensor %[[VAL_9]] : memref<1024xf32>
+// CHECK:           memref.tensor_store %{{.*}}, %[[VAL_8]] : memref<1024xf32, strided<[1]>>
+// CHECK:           return
+// CHECK:         }
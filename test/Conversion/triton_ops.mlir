@@ -125,6 +125,21 @@ tt.func @reduce_ops_infer(%ptr: !tt.ptr<f32>, %v : tensor<1x2x4xf32>) {
   tt.return
 }
 
+tt.func @scan_ops_infer(%ptr: !tt.ptr<f32>, %v : tensor<2x4xf32>) {
+  // Test if scan ops keep the type of their operands
+
+  // CHECK: }) {axis = 1 : i32} : (tensor<2x4xf32>) -> tensor<2x4xf32>
+  %a = "tt.scan" (%v) ({
+  ^bb0(%arg0: f32, %arg1: f32):
+    %add = arith.addf %arg0, %arg1 : f32
+    tt.scan.return %add : f32
+  }) {axis = 1 : i32}  : (tensor<2x4xf32>) -> tensor<2x4xf32>
+
+  %ptr2x4 = tt.splat %ptr : (!tt.ptr<f32>) -> tensor<2x4x!tt.ptr<f32>>
+  tt.store %ptr2x4, %a : tensor<2x4xf32>
+  tt.return
+}
+
 tt.func @dot_ops_infer(%ptr: !tt.ptr<f32>, %v : f32) {
   // Test if reduce ops infer types correctly
   %v128x32 = tt.splat %v : (f32) -> tensor<128x32xf32>
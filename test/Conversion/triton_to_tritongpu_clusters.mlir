@@ -0,0 +1,12 @@
+// RUN: triton-opt %s -convert-triton-to-tritongpu="num-warps=4 num-ctas=2" | FileCheck %s
+
+// Kernels launched in thread block clusters record the number of CTAs of
+// their clusters; the layouts of each CTA are the same as without clusters
+
+// CHECK: #[[blocked0:.*]] = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+// CHECK: module attributes {"triton_gpu.num-ctas" = 2 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32}
+tt.func @clusters() {
+  // CHECK: arith.constant dense<1.000000e+00> : tensor<128xf32, #[[blocked0]]>
+  %0 = arith.constant dense<1.00e+00> : tensor<128xf32>
+  tt.return
+}
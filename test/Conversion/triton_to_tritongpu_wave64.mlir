@@ -0,0 +1,14 @@
+// RUN: triton-opt %s -split-input-file -convert-triton-to-tritongpu="num-warps=4 threads-per-warp=64" | FileCheck %s
+
+// Blocked layouts spread the 64 lanes of AMD wavefronts
+
+// CHECK: #[[blocked0:.*]] = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [64], warpsPerCTA = [4], order = [0]}>
+// CHECK: #[[blocked1:.*]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [16, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+// CHECK: module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 64 : i32}
+tt.func @wave64() {
+  // CHECK: arith.constant dense<1.000000e+00> : tensor<256xf32, #[[blocked0]]>
+  %0 = arith.constant dense<1.00e+00> : tensor<256xf32>
+  // CHECK: arith.constant dense<2.000000e+00> : tensor<16x64xf32, #[[blocked1]]>
+  %1 = arith.constant dense<2.00e+00> : tensor<16x64xf32>
+  tt.return
+}
@@ -200,6 +200,31 @@ module attributes {"triton_gpu.num-warps" = 2 : i32} {
 
 // -----
 
+// The mask of a ragged size is not constant over the vectors of 4 elements of
+// a thread, which are loaded whole when they are in bounds, and element by
+// element otherwise
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: masked_load_ragged
+  tt.func @masked_load_ragged(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %n_elements: i32) -> tensor<128xf32, #blocked> {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #blocked>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>, #blocked>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>, #blocked>, tensor<128xi32, #blocked>
+    %3 = tt.splat %n_elements : (i32) -> tensor<128xi32, #blocked>
+    %4 = arith.cmpi slt, %0, %3 : tensor<128xi32, #blocked>
+    // CHECK: llvm.and
+    // CHECK: llvm.and
+    // CHECK: llvm.and
+    // CHECK: ld.global.v4.b32
+    // CHECK-COUNT-4: ld.global.b32
+    // CHECK: llvm.select
+    %5 = tt.load %2, %4 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32, #blocked>
+    tt.return %5 : tensor<128xf32, #blocked>
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 1 : i32} {
   // CHECK-LABEL: global_load_store_vec2
@@ -327,6 +352,25 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Each function computes its own indices of the same layout
+  // CHECK-LABEL: make_range_first
+  tt.func @make_range_first() {
+    // CHECK: nvvm.read.ptx.sreg.tid.x
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    tt.return
+  }
+  // CHECK-LABEL: make_range_second
+  tt.func @make_range_second() {
+    // CHECK: nvvm.read.ptx.sreg.tid.x
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: basic_addf
@@ -340,6 +384,24 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Half elements are computed two at a time
+  // CHECK-LABEL: packed_addf_f16
+  tt.func @packed_addf_f16(%arg0 : tensor<512xf16,#blocked0>, %arg1 : tensor<512xf16,#blocked0>, %arg2 : tensor<512xbf16,#blocked0>, %arg3 : tensor<512xbf16,#blocked0>) {
+    // CHECK-COUNT-2: llvm.fadd {{.*}} : vector<2xf16>
+    // CHECK-NOT: llvm.fadd
+    %1 = arith.addf %arg0, %arg1 : tensor<512xf16,#blocked0>
+    // CHECK-COUNT-2: fma.rn.bf16x2
+    // CHECK-NOT: fma.rn.bf16
+    // CHECK: llvm.return
+    %2 = arith.subf %arg2, %arg3 : tensor<512xbf16,#blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: basic_addi
@@ -394,6 +456,18 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#shared0 = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+// CHECK: module attributes {{.*}}triton_gpu.shared_buffers = [{kind = "explicit", live_end = {{[0-9]+}} : i64, live_start = {{[0-9]+}} : i64, loc = {{.*}}, offset = 0 : i64, op = "triton_gpu.alloc_tensor", size = 512 : i64}]
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: shared_buffer_report
+  tt.func @shared_buffer_report() {
+    %0 = triton_gpu.alloc_tensor : tensor<16x16xf16, #shared0>
+    tt.return
+  }
+}
+
+// -----
+
 #shared0 = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK: llvm.mlir.global external @global_smem
@@ -653,6 +727,45 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: load_store_cache_policies
+  tt.func @load_store_cache_policies(%ptrs: tensor<128x!tt.ptr<f32>, #blocked0>, %out: tensor<128x!tt.ptr<f32>, #blocked0>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: createpolicy.fractional.L2::evict_last.b64 $0, 1.0;
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: ld.global.L1::evict_last.L2::cache_hint.b32 { ${{.*}} }, [ ${{.*}} + 0 ], ${{.*}};
+    %0 = tt.load %ptrs {cache = 1 : i32, evict = 3 : i32, isVolatile = false} : tensor<128xf32, #blocked0>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: st.global.cs.b32 [ ${{.*}} + 0 ], { ${{.*}} };
+    tt.store %out, %0 {cache = 5 : i32, evict = 1 : i32} : tensor<128xf32, #blocked0>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: createpolicy.fractional.L2::evict_first.b64 $0, 1.0;
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: st.global.wt.L2::cache_hint.b32 [ ${{.*}} + 0 ], { ${{.*}} }, ${{.*}};
+    tt.store %out, %0 {cache = 6 : i32, evict = 2 : i32} : tensor<128xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: prefetch_l2
+  tt.func @prefetch_l2(%ptrs: tensor<128x!tt.ptr<f32>, #blocked0>, %mask: tensor<128xi1, #blocked0>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$1 prefetch.global.L2 [ $0 + 0 ];
+    tt.prefetch %ptrs, %mask : tensor<128x!tt.ptr<f32>, #blocked0>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: prefetch.global.L2::evict_last [ $0 + 0 ];
+    tt.prefetch %ptrs {evict = 3 : i32} : tensor<128x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
 #blocked1 = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [0, 1]}>
 module attributes {"triton_gpu.num-warps" = 1 : i32} {
@@ -700,6 +813,27 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [8, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The groups of 8 elements of each row of the scratch buffer are XORed with
+  // its phase, for both the stores and the vectorized loads
+  // CHECK-LABEL: convert_layout_blocked_blocked_swizzled
+  tt.func @convert_layout_blocked_blocked_swizzled(%arg0: tensor<64x64xf16, #blocked0>) {
+    // CHECK: llvm.xor
+    // CHECK: llvm.store
+    // CHECK-SAME: !llvm.ptr<vector<1xf16>, 3>
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.xor
+    // CHECK: llvm.load
+    // CHECK-SAME: !llvm.ptr<vector<8xf16>, 3>
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<64x64xf16, #blocked0>) -> tensor<64x64xf16, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
 #blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [16, 2], warpsPerCTA = [1, 1], order = [1, 0]}>
 module attributes {"triton_gpu.num-warps" = 1 : i32} {
@@ -729,22 +863,11 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   // CHECK: llvm.mlir.global external @global_smem() {addr_space = 3 : i32} : !llvm.array<0 x i8>
   // CHECK-LABEL: convert_layout_blocked_blocked_multi_rep
   tt.func @convert_layout_blocked_blocked_multi_rep(%arg0: tensor<16x16xf32, #blocked0>) {
-    // CHECK: llvm.mlir.addressof @global_smem
-    // CHECK: llvm.store
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.store
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    // The elements stay in their warp, so they are exchanged with shuffles
+    // CHECK-NOT: llvm.mlir.addressof @global_smem
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK-COUNT-16: shfl.sync.idx.b32
+    // CHECK-NOT: llvm.store
     %0 = triton_gpu.convert_layout %arg0 : (tensor<16x16xf32, #blocked0>) -> tensor<16x16xf32, #blocked1>
     tt.return
   }
@@ -752,6 +875,24 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [16, 2], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_layout_mma_blocked_shuffle
+  tt.func @convert_layout_mma_blocked_shuffle(%arg0: tensor<64x16xf32, #mma>) {
+    // Every warp holds the same 16 rows in both layouts
+    // CHECK-NOT: llvm.mlir.addressof @global_smem
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: shfl.sync.idx.b32
+    // CHECK: llvm.select
+    // CHECK-NOT: llvm.store
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<64x16xf32, #mma>) -> tensor<64x16xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
 #shared0 = #triton_gpu.shared<{vec = 1, perPhase=2, maxPhase=8 ,order = [1, 0]}>
 #mma0 = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[1,1]}>
@@ -780,6 +921,57 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   }
 }
 
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 1, perPhase=1, maxPhase=1 ,order = [1, 0]}>
+#mma0 = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[1,1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma0}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma0}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_dot_fp8
+  tt.func @convert_dot_fp8(%A: tensor<16x32xf8E4M3FN, #blocked0>, %B: tensor<32x16xf8E4M3FN, #blocked0>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<16x32xf8E4M3FN, #blocked0>) -> tensor<16x32xf8E4M3FN, #shared0>
+    %BB = triton_gpu.convert_layout %B : (tensor<32x16xf8E4M3FN, #blocked0>) -> tensor<32x16xf8E4M3FN, #shared0>
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<16x32xf8E4M3FN, #shared0>) -> tensor<16x32xf8E4M3FN, #dot_operand_a>
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<32x16xf8E4M3FN, #shared0>) -> tensor<32x16xf8E4M3FN, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #mma0>
+
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: mma.sync.aligned.m16n8k32.row.col.f32.e4m3.e4m3.f32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: mma.sync.aligned.m16n8k32.row.col.f32.e4m3.e4m3.f32
+    %D = tt.dot %AA_DOT, %BB_DOT, %cst0 {allowTF32 = true, transA = false, transB = false} : tensor<16x32xf8E4M3FN, #dot_operand_a> * tensor<32x16xf8E4M3FN, #dot_operand_b> -> tensor<16x16xf32, #mma0>
+
+    tt.return
+  }
+}
+
+// -----
+
+// The transposed 8-bit operand is read with scalar loads from a swizzled
+// buffer: each of the 4 rows a thread reads xors its matrix offset with the
+// phase of the row.
+#shared0 = #triton_gpu.shared<{vec = 4, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#mma0 = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[1,1]}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma0}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_dot_i8_transposed_b
+  tt.func @convert_dot_i8_transposed_b() {
+    %BB = triton_gpu.alloc_tensor : tensor<32x32xi8, #shared0>
+    // CHECK-NOT: ldmatrix
+    // CHECK: %[[PHASE_ROW:.*]] = llvm.udiv %{{.*}}, %{{.*}} : i32
+    // CHECK: %[[PHASE:.*]] = llvm.urem %[[PHASE_ROW]], %{{.*}} : i32
+    // CHECK: llvm.xor %{{.*}}, %[[PHASE]] : i32
+    // CHECK: llvm.load
+    // CHECK-NOT: ldmatrix
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<32x32xi8, #shared0>) -> tensor<32x32xi8, #dot_operand_b>
+    tt.return
+  }
+}
+
+// -----
+
 // TODO: problems in MLIR's parser on slice layout
 // #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
 // module attributes {"triton_gpu.num-warps" = 1 : i32} {
@@ -966,6 +1158,32 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#blocked}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The 4 consecutive elements of B each thread holds along N are read at
+  // once, and accumulated in pairs
+  // CHECK-LABEL: matmul_fmadot_f16
+  tt.func @matmul_fmadot_f16(%ptr:!tt.ptr<f16> {tt.divisibility = 16 : i32},
+  %a:tensor<32x16xf16, #shared>, %b:tensor<16x32xf16, #shared>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<32x32xf16, #blocked>
+    // CHECK: llvm.load {{.*}} : !llvm.ptr<vector<4xf16>, 3>
+    // CHECK: llvm.intr.fmuladd({{.*}}) : (vector<2xf16>, vector<2xf16>, vector<2xf16>) -> vector<2xf16>
+    %a_mat = triton_gpu.convert_layout %a : (tensor<32x16xf16, #shared>) -> tensor<32x16xf16, #dot_operand_a>
+    %b_mat = triton_gpu.convert_layout %b : (tensor<16x32xf16, #shared>) -> tensor<16x32xf16, #dot_operand_b>
+
+    %28 = tt.dot %a_mat, %b_mat, %cst {allowTF32 = false, transA = false, transB = false} : tensor<32x16xf16, #dot_operand_a> * tensor<16x32xf16, #dot_operand_b> -> tensor<32x32xf16, #blocked>
+    %30 = tt.splat %ptr : (!tt.ptr<f16>) -> tensor<32x1x!tt.ptr<f16>, #blocked>
+    %36 = tt.broadcast %30 : (tensor<32x1x!tt.ptr<f16>, #blocked>) -> tensor<32x32x!tt.ptr<f16>, #blocked>
+    tt.store %36, %28 : tensor<32x32xf16, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
 #mma = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[2, 2]}>
 #shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
@@ -1015,6 +1233,26 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
     // CHECK: llvm.inline_asm
     // CHECK-SAME: @$3 atom.global.gpu.add.f32
     %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.store %arg0, %0 : tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The result is unused, so the lanes adding to the same address combine
+  // their values and only the lowest of them issues a red
+  // CHECK-LABEL: atomic_add_f32_aggregated
+  tt.func @atomic_add_f32_aggregated(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
+    // CHECK: match.any.sync.b64
+    // CHECK: vote.sync.ballot.b32
+    // CHECK: shfl.sync.idx.b32
+    // CHECK: llvm.fadd
+    // CHECK-NOT: atom.global
+    // CHECK: @$2 red.global.gpu.add.f32 [ $0 + 0 ], $1;
+    %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
     tt.return
   }
 }
@@ -1146,3 +1384,143 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
       tt.return
   }
 }
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#slice0 = #triton_gpu.slice<{dim = 1, parent = #blocked0}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Rows are reduced within warps: the four rows of each thread are reduced
+  // over 8 lanes without going through shared memory
+  // CHECK-LABEL: reduce_warp_synchronous
+  tt.func @reduce_warp_synchronous(%arg0: tensor<64x32xf32, #blocked0>) {
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK-COUNT-12: shfl.sync.bfly.b32
+    // CHECK-NOT: st.shared
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = "tt.reduce"(%arg0) ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %1 : f32
+    }) {axis = 1 : i32} : (tensor<64x32xf32, #blocked0>) -> tensor<64xf32, #slice0>
+    tt.return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#slice0 = #triton_gpu.slice<{dim = 1, parent = #blocked0}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: reduce_redux_sync
+  tt.func @reduce_redux_sync(%arg0: tensor<4x128xi32, #blocked0>) {
+    // CHECK-NOT: shfl.sync.bfly.b32
+    // CHECK: redux.sync.max.s32
+    // CHECK-NOT: shfl.sync.bfly.b32
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = "tt.reduce"(%arg0) ({
+    ^bb0(%arg1: i32, %arg2: i32):
+      %1 = arith.maxsi %arg1, %arg2 : i32
+      tt.reduce.return %1 : i32
+    }) {axis = 1 : i32} : (tensor<4x128xi32, #blocked0>) -> tensor<4xi32, #slice0>
+    tt.return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#slice0 = #triton_gpu.slice<{dim = 1, parent = #blocked0}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Two rows of f16 are exchanged by each shuffle
+  // CHECK-LABEL: reduce_packed_f16
+  tt.func @reduce_packed_f16(%arg0: tensor<64x32xf16, #blocked0>) {
+    // CHECK-COUNT-6: shfl.sync.bfly.b32
+    // CHECK-NOT: shfl.sync.bfly.b32
+    // CHECK: llvm.return
+    %0 = "tt.reduce"(%arg0) ({
+    ^bb0(%arg1: f16, %arg2: f16):
+      %1 = arith.maxf %arg1, %arg2 : f16
+      tt.reduce.return %1 : f16
+    }) {axis = 1 : i32} : (tensor<64x32xf16, #blocked0>) -> tensor<64xf16, #slice0>
+    tt.return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Rows are scanned within warps: three shuffles scan the last elements of
+  // the lanes and one more hands the scan of the lanes before to the others
+  // CHECK-LABEL: scan_warp_synchronous
+  tt.func @scan_warp_synchronous(%arg0: tensor<16x32xf32, #blocked0>) {
+    // CHECK-COUNT-4: shfl.sync.idx.b32
+    // CHECK-NOT: shfl.sync.idx.b32
+    // CHECK-NOT: st.shared
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = "tt.scan"(%arg0) ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.scan.return %1 : f32
+    }) {axis = 1 : i32} : (tensor<16x32xf32, #blocked0>) -> tensor<16x32xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The last lane of each warp shares the scan of its warp with the warps
+  // after it
+  // CHECK-LABEL: scan_across_warps
+  tt.func @scan_across_warps(%arg0: tensor<128xf32, #blocked0>) {
+    // CHECK-COUNT-5: shfl.sync.idx.b32
+    // CHECK: st.shared
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load
+    // CHECK: llvm.return
+    %0 = "tt.scan"(%arg0) ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.scan.return %1 : f32
+    }) {axis = 0 : i32} : (tensor<128xf32, #blocked0>) -> tensor<128xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The elements a struct was packed from are reused by the ops unpacking it
+  // CHECK-LABEL: forward_packed_elements
+  tt.func @forward_packed_elements(%arg0: f32) {
+    // CHECK: %[[SRC:.*]] = llvm.bitcast %{{.*}} : f32 to f32
+    // CHECK-NOT: llvm.extractvalue
+    // CHECK-COUNT-4: llvm.fadd %[[SRC]], %[[SRC]]
+    // CHECK-NOT: llvm.extractvalue
+    // CHECK: llvm.return
+    %0 = tt.splat %arg0 : (f32) -> tensor<512xf32, #blocked0>
+    %1 = arith.addf %0, %0 : tensor<512xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The first thread of each program arrives at the counter between fences
+  // once all the threads of the program are done, and spins until all the
+  // programs have arrived
+  // CHECK-LABEL: grid_barrier
+  tt.func @grid_barrier(%arg0: !tt.ptr<i32>) {
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @!$0 bra LAB_DONE;
+    // CHECK-SAME: membar.gl;
+    // CHECK-SAME: atom.global.add.u32 target, [$1], 1;
+    // CHECK-SAME: ld.volatile.global.u32 count, [$1];
+    // CHECK-SAME: @p bra LAB_WAIT;
+    // CHECK: nvvm.barrier0
+    triton_gpu.grid_barrier %arg0 : !tt.ptr<i32>
+    tt.return
+  }
+}
@@ -0,0 +1,19 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm="is-rocm=true" | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 64], warpsPerCTA = [1, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // A reduction over the 64 lanes of a wavefront exchanges the two halves
+  // through ds_bpermute, then swizzles within each half
+  // CHECK-LABEL: reduce_wave64
+  // CHECK: rocdl.ds_bpermute
+  // CHECK-COUNT-5: rocdl.ds_swizzle
+  // CHECK-NOT: shfl.sync
+  tt.func @reduce_wave64(%arg0: tensor<1x64xf32, #blocked>) {
+    %0 = "tt.reduce"(%arg0) ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %1 : f32
+    }) {axis = 1 : i32} : (tensor<1x64xf32, #blocked>) -> tensor<1xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    tt.return
+  }
+}
@@ -0,0 +1,77 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm=compute-capability=90 | FileCheck %s
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [2], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 2 : i32} {
+  // Contiguous float adds whose result is unused are issued 4 at a time
+  // CHECK-LABEL: atomic_add_f32_vec4
+  tt.func @atomic_add_f32_vec4(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1 : tensor<256xf32, #blocked0>) {
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: red.global.gpu.add.v4.f32 [ ${{.*}} + 0 ], { ${{.*}}, ${{.*}}, ${{.*}}, ${{.*}} };
+    // CHECK-NOT: red.global
+    %3 = "tt.atomic_rmw" (%2, %arg1) {atomic_rmw_op = 5 : i32} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [8, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#shared0 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#shared1 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [0, 1]}>
+#mma = #triton_gpu.mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // K-major operands are read in place from shared memory, 16 of K at a
+  // time, and waited for once
+  // CHECK-LABEL: dot_wgmma
+  tt.func @dot_wgmma(%A: tensor<64x64xf16, #blocked0>, %B: tensor<64x64xf16, #blocked1>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<64x64xf16, #blocked0>) -> tensor<64x64xf16, #shared0>
+    %BB = triton_gpu.convert_layout %B : (tensor<64x64xf16, #blocked1>) -> tensor<64x64xf16, #shared1>
+    // CHECK-NOT: ldmatrix
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<64x64xf16, #shared0>) -> tensor<64x64xf16, #dot_operand_a>
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<64x64xf16, #shared1>) -> tensor<64x64xf16, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #mma>
+    // CHECK: fence.proxy.async.shared::cta
+    // CHECK: nvvm.barrier0
+    // CHECK: wgmma.fence.sync.aligned
+    // CHECK-COUNT-4: wgmma.mma_async.sync.aligned.m64n64k16.f32.f16.f16
+    // CHECK-NOT: wgmma.mma_async
+    // CHECK: wgmma.commit_group.sync.aligned
+    // CHECK: wgmma.wait_group.sync.aligned 0
+    %D = tt.dot %AA_DOT, %BB_DOT, %cst0 {allowTF32 = true} : tensor<64x64xf16, #dot_operand_a> * tensor<64x64xf16, #dot_operand_b> -> tensor<64x64xf32, #mma>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 8, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#shared1 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Thread 0 initializes the barriers and issues the copy, which the whole
+  // CTA waits for on the barrier of its slot
+  // CHECK-LABEL: insert_slice_tma
+  tt.func public @insert_slice_tma(%desc: !tt.ptr<i8>, %x: i32, %y: i32, %index: i32, %phase: i32, %pred: i1) {
+    %0 = triton_gpu.alloc_tensor : tensor<2x64x32xf16, #shared0>
+    // CHECK: nvvm.barrier0
+    // CHECK-COUNT-2: @$0 mbarrier.init.shared.b64 [$1], 1;
+    // CHECK: fence.mbarrier_init.release.cluster
+    // CHECK: nvvm.barrier0
+    %1 = triton_gpu.alloc_mbarrier : tensor<2xi64, #shared1>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$0 mbarrier.arrive.expect_tx.shared.b64 _, [$2], 4096;
+    // CHECK-SAME: @$0 cp.async.bulk.tensor.2d.shared::cluster.global.mbarrier::complete_tx::bytes [$3], [$4, {$5, $6}], [$2];
+    // CHECK-SAME: @$1 mbarrier.arrive.shared.b64 _, [$2];
+    %2 = triton_gpu.insert_slice_tma %desc[%x, %y], %0, %index, %1, %pred : !tt.ptr<i8>, tensor<2x64x32xf16, #shared0>, tensor<2xi64, #shared1>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: mbarrier.try_wait.parity.shared.b64 p, [$0], $1;
+    triton_gpu.mbarrier_wait %1[%index], %phase : tensor<2xi64, #shared1>
+    tt.return
+  }
+}
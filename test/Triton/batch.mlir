@@ -0,0 +1,19 @@
+// RUN: echo "# a comment, then the same file twice" > %t.manifest
+// RUN: echo "%s %t.0.mlir" >> %t.manifest
+// RUN: echo "%s %t.1.mlir" >> %t.manifest
+// RUN: triton-opt --batch=%t.manifest --batch-threads=2 -canonicalize
+// RUN: FileCheck %s < %t.0.mlir
+// RUN: FileCheck %s < %t.1.mlir
+// RUN: echo "%s" > %t.invalid
+// RUN: not triton-opt --batch=%t.invalid 2>&1 | FileCheck %s --check-prefix=INVALID
+
+// CHECK-LABEL: tt.func @fold
+// CHECK-NEXT:    %[[C:.*]] = arith.constant 3 : i32
+// CHECK-NEXT:    tt.return %[[C]]
+// INVALID: expected '<input> <output>'
+tt.func @fold() -> i32 {
+  %c1 = arith.constant 1 : i32
+  %c2 = arith.constant 2 : i32
+  %0 = arith.addi %c1, %c2 : i32
+  tt.return %0 : i32
+}
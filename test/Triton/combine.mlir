@@ -85,6 +85,84 @@ tt.func @test_combine_select_masked_load_fail_pattern(%ptr: tensor<8x!tt.ptr<f32
     tt.return %0, %1, %2 : tensor<8xf32>, tensor<8xf32>, tensor<8xf32>
 }
 
+// CHECK-LABEL: @test_combine_select_unmasked_load_pattern
+tt.func @test_combine_select_unmasked_load_pattern(%ptr: tensor<8x!tt.ptr<f32>>, %mask: tensor<8xi1>, %cond: i1) -> (tensor<8xf32>, tensor<8xf32>) {
+    %false_val = arith.constant dense<0.0> : tensor<8xf32>
+
+    // CHECK: %[[res1:.*]] = tt.load %{{.*}}, %arg1, %{{.*}} {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    %x = tt.load %ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    %0 = arith.select %mask, %x, %false_val : tensor<8xf32>
+
+    // A scalar condition is splat to the shape of the load
+    // CHECK: %[[cond:.*]] = tt.splat %arg2 : (i1) -> tensor<8xi1>
+    // CHECK: %[[res2:.*]] = tt.load %{{.*}}, %[[cond]], %{{.*}} {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    %y = tt.load %ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    %1 = arith.select %cond, %y, %false_val : tensor<8xf32>
+
+    // CHECK-NOT: arith.select
+    // CHECK: tt.return %[[res1]], %[[res2]] : tensor<8xf32>, tensor<8xf32>
+    tt.return %0, %1 : tensor<8xf32>, tensor<8xf32>
+}
+
+// CHECK-LABEL: @test_combine_select_unmasked_load_fail_pattern
+tt.func @test_combine_select_unmasked_load_fail_pattern(%ptr: tensor<8x!tt.ptr<f32>>, %other: tensor<8xf32>, %a: tensor<8xi32>) -> (tensor<8xf32>, tensor<8xf32>, tensor<8xf32>) {
+    %false_val = arith.constant dense<0.0> : tensor<8xf32>
+    %b = arith.constant dense<4> : tensor<8xi32>
+
+    // Case 1: the loaded values have other uses.  Select should not be combined.
+    // CHECK: %[[x:.*]] = tt.load %{{.*}} {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    // CHECK: arith.select %{{.*}}, %[[x]], %{{.*}} : tensor<8xi1>, tensor<8xf32>
+    %x = tt.load %ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    %mask0 = arith.cmpi slt, %a, %b : tensor<8xi32>
+    %0 = arith.select %mask0, %x, %false_val : tensor<8xf32>
+
+    // Case 2: the condition is computed after the load.  Select should not be combined.
+    // CHECK: %[[y:.*]] = tt.load %{{.*}} {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    // CHECK: arith.select %{{.*}}, %[[y]], %{{.*}} : tensor<8xi1>, tensor<8xf32>
+    %y = tt.load %ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    %mask1 = arith.cmpi sgt, %a, %b : tensor<8xi32>
+    %1 = arith.select %mask1, %y, %other : tensor<8xf32>
+
+    tt.return %0, %1, %x : tensor<8xf32>, tensor<8xf32>, tensor<8xf32>
+}
+
+// CHECK-LABEL: @test_combine_select_store_pattern
+tt.func @test_combine_select_store_pattern(%ptr: tensor<8x!tt.ptr<f32>>, %val: tensor<8xf32>, %cond: tensor<8xi1>, %mask: tensor<8xi1>) {
+    // CHECK-NOT: arith.select
+    // CHECK: tt.store %arg0, %arg1, %arg2 : tensor<8xf32>
+    %old = tt.load %ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    %0 = arith.select %cond, %val, %old : tensor<8xf32>
+    tt.store %ptr, %0 : tensor<8xf32>
+
+    // The conditions of masked stores are combined with their mask
+    // CHECK: %[[mask:.*]] = arith.andi %arg3, %arg2 : tensor<8xi1>
+    // CHECK: tt.store %arg0, %arg1, %[[mask]] : tensor<8xf32>
+    %old_masked = tt.load %ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    %1 = arith.select %cond, %val, %old_masked : tensor<8xf32>
+    tt.store %ptr, %1, %mask : tensor<8xf32>
+    tt.return
+}
+
+// CHECK-LABEL: @test_combine_select_store_fail_pattern
+tt.func @test_combine_select_store_fail_pattern(%ptr: tensor<8x!tt.ptr<f32>>, %other_ptr: tensor<8x!tt.ptr<f32>>, %val: tensor<8xf32>, %cond: tensor<8xi1>) {
+    // Case 1: the stored values are loaded through other pointers.  Store should not be combined.
+    // CHECK: %[[sel0:.*]] = arith.select
+    // CHECK: tt.store %arg0, %[[sel0]] : tensor<8xf32>
+    %old0 = tt.load %other_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    %0 = arith.select %cond, %val, %old0 : tensor<8xf32>
+    tt.store %ptr, %0 : tensor<8xf32>
+
+    // Case 2: memory is written between the load and the store.  Store should not be combined.
+    // CHECK: %[[sel1:.*]] = arith.select
+    // CHECK: tt.store %arg1, %arg2 : tensor<8xf32>
+    // CHECK: tt.store %arg0, %[[sel1]] : tensor<8xf32>
+    %old1 = tt.load %ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8xf32>
+    %1 = arith.select %cond, %val, %old1 : tensor<8xf32>
+    tt.store %other_ptr, %val : tensor<8xf32>
+    tt.store %ptr, %1 : tensor<8xf32>
+    tt.return
+}
+
 // CHECK-LABEL: @test_combine_broadcast_constant_pattern
 tt.func @test_combine_broadcast_constant_pattern(%cst : f32) -> tensor<8x2xf32> {
     // CHECK: %[[cst:.*]] = arith.constant dense<1.000000e+00> : tensor<8x2xf32>
@@ -195,6 +273,39 @@ tt.func @test_canonicalize_broadcast(%arg0: tensor<1x1x8xf32>, %arg1: tensor<f32
     tt.return %broadcast1, %broadcast2, %add : tensor<4x2x8xf32>, tensor<8x8xf32>, tensor<1x1x8xf32>
 }
 
+// CHECK-LABEL: @test_sink_broadcast_below_elementwise
+tt.func @test_sink_broadcast_below_elementwise(%arg0: i32) -> tensor<64x32xi1> {
+    // CHECK: %[[RANGE:.*]] = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+    // CHECK: %[[MUL:.*]] = arith.muli %[[RANGE]], %{{.*}} : tensor<32xi32>
+    // CHECK: %[[ADD:.*]] = arith.addi %[[MUL]], %{{.*}} : tensor<32xi32>
+    // CHECK: %[[CMP:.*]] = arith.cmpi slt, %[[ADD]], %{{.*}} : tensor<32xi32>
+    // CHECK: %[[EXPAND:.*]] = tt.expand_dims %[[CMP]] {axis = 0 : i32} : (tensor<32xi1>) -> tensor<1x32xi1>
+    // CHECK: %[[BROADCAST:.*]] = tt.broadcast %[[EXPAND]] : (tensor<1x32xi1>) -> tensor<64x32xi1>
+    // CHECK: tt.return %[[BROADCAST]] : tensor<64x32xi1>
+    %range = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+    %expand = tt.expand_dims %range {axis = 0 : i32} : (tensor<32xi32>) -> tensor<1x32xi32>
+    %broadcast = tt.broadcast %expand : (tensor<1x32xi32>) -> tensor<64x32xi32>
+    %splat = tt.splat %arg0 : (i32) -> tensor<64x32xi32>
+    %stride = arith.constant dense<4> : tensor<64x32xi32>
+    %mul = arith.muli %broadcast, %stride : tensor<64x32xi32>
+    %add = arith.addi %mul, %splat : tensor<64x32xi32>
+    %cmp = arith.cmpi slt, %add, %splat : tensor<64x32xi32>
+    tt.return %cmp : tensor<64x32xi1>
+}
+
+// CHECK-LABEL: @test_sink_broadcast_below_elementwise_fail
+tt.func @test_sink_broadcast_below_elementwise_fail(%arg0: tensor<1x32xi32>, %arg1: tensor<64x1xi32>, %arg2: tensor<64x32xi32>) -> (tensor<64x32xi32>, tensor<64x32xi32>) {
+    %broadcast0 = tt.broadcast %arg0 : (tensor<1x32xi32>) -> tensor<64x32xi32>
+    %broadcast1 = tt.broadcast %arg1 : (tensor<64x1xi32>) -> tensor<64x32xi32>
+    // Case 1: the operands are broadcast from different shapes
+    // CHECK: arith.addi %{{.*}}, %{{.*}} : tensor<64x32xi32>
+    %add0 = arith.addi %broadcast0, %broadcast1 : tensor<64x32xi32>
+    // Case 2: an operand is neither broadcast nor uniform
+    // CHECK: arith.addi %{{.*}}, %arg2 : tensor<64x32xi32>
+    %add1 = arith.addi %broadcast0, %arg2 : tensor<64x32xi32>
+    tt.return %add0, %add1 : tensor<64x32xi32>, tensor<64x32xi32>
+}
+
 // CHECK-LABEL: @test_fold_views
 tt.func @test_fold_views() -> (tensor<16x8xf32>, tensor<16x128xf32>, tensor<1x1x128xf32>) {
     %a = arith.constant dense<1.0> : tensor<1x128xf32>
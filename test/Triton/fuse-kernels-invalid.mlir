@@ -0,0 +1,27 @@
+// RUN: triton-opt %s -split-input-file -triton-fuse-kernels -verify-diagnostics
+
+module {
+tt.func private @program_id() -> i32 {
+  %pid = tt.get_program_id {axis = 0 : i32} : i32
+  tt.return %pid : i32
+}
+// expected-error @below {{kernels calling functions that read program ids cannot be fused}}
+tt.func public @call(%x: !tt.ptr<i32>) {
+  %pid = tt.call @program_id() : () -> i32
+  tt.store %x, %pid : i32
+  tt.return
+}
+}
+
+// -----
+
+module {
+// expected-error @below {{only kernels of a single block without results can be fused}}
+tt.func public @branch(%x: !tt.ptr<i32>, %c: i1) {
+  cf.cond_br %c, ^bb1, ^bb2
+^bb1:
+  tt.return
+^bb2:
+  tt.return
+}
+}
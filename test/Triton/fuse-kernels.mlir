@@ -0,0 +1,52 @@
+// RUN: triton-opt %s -triton-fuse-kernels=name=fused | FileCheck %s
+
+// Each kernel runs in the range of its programs, with its own program ids
+// and counts, and takes its arguments in turn
+// CHECK-NOT: tt.func public @scale
+// CHECK-LABEL: tt.func public @fused
+// CHECK-SAME: (%[[X:arg[0-9]+]]: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %[[Y:arg[0-9]+]]: !tt.ptr<f32>, %[[N:arg[0-9]+]]: i32, %[[PROGRAMS0:arg[0-9]+]]: i32, %[[PROGRAMS1:arg[0-9]+]]: i32)
+// CHECK: %[[PID:.*]] = tt.get_program_id {axis = 0 : i32} : i32
+// CHECK: %[[START0:.*]] = arith.constant 0 : i32
+// CHECK: %[[END0:.*]] = arith.addi %[[START0]], %[[PROGRAMS0]] : i32
+// CHECK: %[[AFTER0:.*]] = arith.cmpi sge, %[[PID]], %[[START0]] : i32
+// CHECK: %[[BEFORE0:.*]] = arith.cmpi slt, %[[PID]], %[[END0]] : i32
+// CHECK: %[[IN0:.*]] = arith.andi %[[AFTER0]], %[[BEFORE0]] : i1
+// CHECK: scf.if %[[IN0]] {
+// CHECK:   %[[LOCAL0:.*]] = arith.subi %[[PID]], %[[START0]] : i32
+// CHECK:   %[[PTR0:.*]] = tt.addptr %[[X]], %[[LOCAL0]] : !tt.ptr<f32>, i32
+// CHECK:   %[[VAL0:.*]] = arith.sitofp %[[PROGRAMS0]] : i32 to f32
+// CHECK:   tt.store %[[PTR0]], %[[VAL0]] : f32
+// CHECK: }
+// CHECK: %[[END1:.*]] = arith.addi %[[END0]], %[[PROGRAMS1]] : i32
+// CHECK: %[[AFTER1:.*]] = arith.cmpi sge, %[[PID]], %[[END0]] : i32
+// CHECK: %[[BEFORE1:.*]] = arith.cmpi slt, %[[PID]], %[[END1]] : i32
+// CHECK: %[[IN1:.*]] = arith.andi %[[AFTER1]], %[[BEFORE1]] : i1
+// CHECK: scf.if %[[IN1]] {
+// CHECK:   %[[LOCAL1:.*]] = arith.subi %[[PID]], %[[END0]] : i32
+// CHECK:   %[[ZERO:.*]] = arith.constant 0 : i32
+// CHECK:   %[[IDX:.*]] = arith.addi %[[LOCAL1]], %[[ZERO]] : i32
+// CHECK:   %[[PTR1:.*]] = tt.addptr %[[Y]], %[[IDX]] : !tt.ptr<f32>, i32
+// CHECK:   %[[VAL1:.*]] = arith.sitofp %[[N]] : i32 to f32
+// CHECK:   tt.store %[[PTR1]], %[[VAL1]] : f32
+// CHECK: }
+// CHECK: tt.return
+// CHECK-NOT: tt.func
+module {
+tt.func public @scale(%x: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %pid = tt.get_program_id {axis = 0 : i32} : i32
+  %num = tt.get_num_programs {axis = 0 : i32} : i32
+  %ptr = tt.addptr %x, %pid : !tt.ptr<f32>, i32
+  %val = arith.sitofp %num : i32 to f32
+  tt.store %ptr, %val : f32
+  tt.return
+}
+tt.func public @fill(%y: !tt.ptr<f32>, %n: i32) {
+  %pid = tt.get_program_id {axis = 0 : i32} : i32
+  %pid1 = tt.get_program_id {axis = 1 : i32} : i32
+  %idx = arith.addi %pid, %pid1 : i32
+  %ptr = tt.addptr %y, %idx : !tt.ptr<f32>, i32
+  %val = arith.sitofp %n : i32 to f32
+  tt.store %ptr, %val : f32
+  tt.return
+}
+}
@@ -0,0 +1,44 @@
+// RUN: triton-opt %s -split-input-file -triton-rewrite-tensor-pointer=compute-capability=90 | FileCheck %s
+
+// The loads of row-major blocks of tensors whose address and outer strides
+// are 16-byte aligned go through a tensor map described by a new argument
+
+// CHECK-LABEL: tt.func public @load_tma
+// CHECK-SAME: %[[DESC:[^:]*]]: !tt.ptr<i8> {tt.tensormap = {base = 0 : i32, box = array<i32: 64, 32>, elem = f16, shape = array<i64: 1, -1>, shape_values = array<i64: 0, 64>, stride_values = array<i64: 0, 1>, strides = array<i64: 2, -1>}}
+tt.func public @load_tma(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: i32, %arg2: i32 {tt.divisibility = 16 : i32}) -> tensor<64x32xf16> {
+  %c0_i32 = arith.constant 0 : i32
+  %c32_i32 = arith.constant 32 : i32
+  %c1_i64 = arith.constant 1 : i64
+  %c64_i64 = arith.constant 64 : i64
+  %0 = arith.extsi %arg1 : i32 to i64
+  %1 = arith.extsi %arg2 : i32 to i64
+  // CHECK-NOT: tt.make_tensor_ptr
+  %2 = tt.make_tensor_ptr %arg0, [%0, %c64_i64], [%1, %c1_i64], [%c0_i32, %c32_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<64x32xf16>>
+  // CHECK: %[[X:.*]] = arith.trunci %{{.*}} : i64 to i32
+  // CHECK: %[[Y:.*]] = arith.trunci %{{.*}} : i64 to i32
+  // CHECK: tt.descriptor_load %[[DESC]][%[[X]], %[[Y]]] : !tt.ptr<i8> -> tensor<64x32xf16>
+  %3 = tt.load %2 {boundaryCheck = array<i32: 0, 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<64x32xf16>> -> tensor<64x32xf16>
+  tt.return %3 : tensor<64x32xf16>
+}
+
+// -----
+
+// The stride of %arg2 is not known to be 16-byte aligned, and a NaN padding
+// cannot be filled by the copy
+
+// CHECK-LABEL: tt.func public @load_legacy
+// CHECK-NOT: tt.tensormap
+// CHECK-NOT: tt.descriptor_load
+// CHECK-COUNT-2: tt.load %{{.*}}, %{{.*}}, %{{.*}}
+tt.func public @load_legacy(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: i32, %arg2: i32) -> (tensor<64x32xf16>, tensor<64x32xf16>) {
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i64 = arith.constant 1 : i64
+  %c64_i64 = arith.constant 64 : i64
+  %0 = arith.extsi %arg1 : i32 to i64
+  %1 = arith.extsi %arg2 : i32 to i64
+  %2 = tt.make_tensor_ptr %arg0, [%0, %c64_i64], [%1, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<64x32xf16>>
+  %3 = tt.load %2 {boundaryCheck = array<i32: 0, 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<64x32xf16>> -> tensor<64x32xf16>
+  %4 = tt.make_tensor_ptr %arg0, [%0, %c64_i64], [%c64_i64, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<64x32xf16>>
+  %5 = tt.load %4 {boundaryCheck = array<i32: 0, 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 2 : i32} : !tt.ptr<tensor<64x32xf16>> -> tensor<64x32xf16>
+  tt.return %3, %5 : tensor<64x32xf16>, tensor<64x32xf16>
+}
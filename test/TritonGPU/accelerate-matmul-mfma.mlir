@@ -0,0 +1,36 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-accelerate-matmul=matrix-core-version=2 | FileCheck %s
+
+// CHECK: #[[MFMA:[a-z0-9]+]] = #triton_gpu.mfma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: tt.func @dot_mfma
+// CHECK-DAG: triton_gpu.convert_layout %{{.*}} : (tensor<128x64xf32, #blocked>) -> tensor<128x64xf32, #[[MFMA]]>
+// CHECK-DAG: triton_gpu.convert_layout %{{.*}} : (tensor<128x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>) -> tensor<128x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #[[MFMA]]}>>
+// CHECK-DAG: triton_gpu.convert_layout %{{.*}} : (tensor<32x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>>) -> tensor<32x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MFMA]]}>>
+// CHECK: tt.dot {{.*}} -> tensor<128x64xf32, #[[MFMA]]>
+tt.func @dot_mfma(%a: tensor<128x32xf16, #blocked>, %b: tensor<32x64xf16, #blocked>) -> tensor<128x64xf32, #blocked> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #blocked>
+  %0 = triton_gpu.convert_layout %a : (tensor<128x32xf16, #blocked>) -> tensor<128x32xf16, #A>
+  %1 = triton_gpu.convert_layout %b : (tensor<32x64xf16, #blocked>) -> tensor<32x64xf16, #B>
+  %2 = tt.dot %0, %1, %cst {allowTF32 = true} : tensor<128x32xf16, #A> * tensor<32x64xf16, #B> -> tensor<128x64xf32, #blocked>
+  tt.return %2 : tensor<128x64xf32, #blocked>
+}
+
+// Dots whose N is not a multiple of the 32 columns of an instruction are
+// left to the FMA lowering
+// CHECK-LABEL: tt.func @dot_fma
+// CHECK: tt.dot {{.*}} -> tensor<128x16xf32, #blocked>
+tt.func @dot_fma(%a: tensor<128x32xf16, #blocked>, %b: tensor<32x16xf16, #blocked>) -> tensor<128x16xf32, #blocked> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x16xf32, #blocked>
+  %0 = triton_gpu.convert_layout %a : (tensor<128x32xf16, #blocked>) -> tensor<128x32xf16, #A>
+  %1 = triton_gpu.convert_layout %b : (tensor<32x16xf16, #blocked>) -> tensor<32x16xf16, #B>
+  %2 = tt.dot %0, %1, %cst {allowTF32 = true} : tensor<128x32xf16, #A> * tensor<32x16xf16, #B> -> tensor<128x16xf32, #blocked>
+  tt.return %2 : tensor<128x16xf32, #blocked>
+}
+
+}
@@ -0,0 +1,142 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-accelerate-matmul=compute-capability=80 | FileCheck %s --check-prefix=SM80
+// RUN: triton-opt %s -split-input-file -tritongpu-accelerate-matmul=compute-capability=89 | FileCheck %s --check-prefix=SM89
+// RUN: triton-opt %s -split-input-file -tritongpu-accelerate-matmul=compute-capability=90 | FileCheck %s --check-prefix=SM90
+
+// SM90-DAG: #[[MMA_V3:[a-z0-9]+]] = #triton_gpu.mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1]}>
+// SM90-DAG: #[[MMA_V2:[a-z0-9]+]] = #triton_gpu.mma<{versionMajor = 2
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// fp8 operands are converted to fp16 before sm89, and multiplied as fp8 on
+// sm89+
+// SM80-LABEL: tt.func @dot_fp8
+// SM80-DAG: %[[A:.*]] = tt.fp_to_fp %{{.*}} : tensor<128x32xf8E4M3FN, #blocked> -> tensor<128x32xf16, #blocked>
+// SM80-DAG: %[[B:.*]] = tt.fp_to_fp %{{.*}} : tensor<32x64xf8E4M3FN, #blocked> -> tensor<32x64xf16, #blocked>
+// SM80-DAG: triton_gpu.convert_layout %[[A]] : (tensor<128x32xf16, #blocked>) -> tensor<128x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+// SM80-DAG: triton_gpu.convert_layout %[[B]] : (tensor<32x64xf16, #blocked>) -> tensor<32x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>>
+// SM80: tt.dot {{.*}} : tensor<128x32xf16, {{.*}}> * tensor<32x64xf16, {{.*}}> -> tensor<128x64xf32, #mma>
+// SM89-LABEL: tt.func @dot_fp8
+// SM89-NOT: tt.fp_to_fp
+// SM89: tt.dot {{.*}} : tensor<128x32xf8E4M3FN, {{.*}}> * tensor<32x64xf8E4M3FN, {{.*}}> -> tensor<128x64xf32, #mma>
+tt.func @dot_fp8(%a: tensor<128x32xf8E4M3FN, #blocked>, %b: tensor<32x64xf8E4M3FN, #blocked>) -> tensor<128x64xf32, #blocked> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #blocked>
+  %0 = triton_gpu.convert_layout %a : (tensor<128x32xf8E4M3FN, #blocked>) -> tensor<128x32xf8E4M3FN, #A>
+  %1 = triton_gpu.convert_layout %b : (tensor<32x64xf8E4M3FN, #blocked>) -> tensor<32x64xf8E4M3FN, #B>
+  %2 = tt.dot %0, %1, %cst {allowTF32 = true} : tensor<128x32xf8E4M3FN, #A> * tensor<32x64xf8E4M3FN, #B> -> tensor<128x64xf32, #blocked>
+  tt.return %2 : tensor<128x64xf32, #blocked>
+}
+
+// wgmma reads K-major operands only, i.e. a row-major A and a column-major B,
+// other dots are computed by mma.sync on sm90
+// SM90-LABEL: tt.func @dot_k_major
+// SM90: tt.dot {{.*}} -> tensor<128x64xf32, #[[MMA_V3]]>
+tt.func @dot_k_major(%a: tensor<128x64xf16, #blocked>, %b: tensor<64x64xf16, #blocked1>) -> tensor<128x64xf32, #blocked> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #blocked>
+  %0 = triton_gpu.convert_layout %a : (tensor<128x64xf16, #blocked>) -> tensor<128x64xf16, #A>
+  %1 = triton_gpu.convert_layout %b : (tensor<64x64xf16, #blocked1>) -> tensor<64x64xf16, #B>
+  %2 = tt.dot %0, %1, %cst {allowTF32 = true} : tensor<128x64xf16, #A> * tensor<64x64xf16, #B> -> tensor<128x64xf32, #blocked>
+  tt.return %2 : tensor<128x64xf32, #blocked>
+}
+
+// SM90-LABEL: tt.func @dot_n_major
+// SM90: tt.dot {{.*}} -> tensor<128x64xf32, #[[MMA_V2]]>
+tt.func @dot_n_major(%a: tensor<128x64xf16, #blocked>, %b: tensor<64x64xf16, #blocked>) -> tensor<128x64xf32, #blocked> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #blocked>
+  %0 = triton_gpu.convert_layout %a : (tensor<128x64xf16, #blocked>) -> tensor<128x64xf16, #A>
+  %1 = triton_gpu.convert_layout %b : (tensor<64x64xf16, #blocked>) -> tensor<64x64xf16, #B>
+  %2 = tt.dot %0, %1, %cst {allowTF32 = true} : tensor<128x64xf16, #A> * tensor<64x64xf16, #B> -> tensor<128x64xf32, #blocked>
+  tt.return %2 : tensor<128x64xf32, #blocked>
+}
+
+}
+
+// -----
+
+// Warps are split along N as much as along M when both operands are read every
+// iteration, and along M only when B is loaded once out of the loop
+// SM80-DAG: #[[MMA_2X2:[a-z0-9]+]] = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [2, 2]}>
+// SM80-DAG: #[[MMA_4X1:[a-z0-9]+]] = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1]}>
+// SM80-DAG: #[[MMA_1X4:[a-z0-9]+]] = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [1, 4]}>
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// SM80-LABEL: tt.func @dot_in_loop
+// SM80: tt.dot {{.*}} -> tensor<64x128xf32, #[[MMA_2X2]]>
+tt.func @dot_in_loop(%a_ptrs: tensor<64x32x!tt.ptr<f16>, #blocked>, %b_ptrs: tensor<32x128x!tt.ptr<f16>, #blocked>, %n: i32) -> tensor<64x128xf32, #blocked> {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<64x128xf32, #blocked>
+  %acc = scf.for %i = %c0 to %n step %c1 iter_args(%c = %cst) -> (tensor<64x128xf32, #blocked>) : i32 {
+    %a = tt.load %a_ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x32xf16, #blocked>
+    %b = tt.load %b_ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x128xf16, #blocked>
+    %0 = triton_gpu.convert_layout %a : (tensor<64x32xf16, #blocked>) -> tensor<64x32xf16, #A>
+    %1 = triton_gpu.convert_layout %b : (tensor<32x128xf16, #blocked>) -> tensor<32x128xf16, #B>
+    %2 = tt.dot %0, %1, %c {allowTF32 = true} : tensor<64x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<64x128xf32, #blocked>
+    scf.yield %2 : tensor<64x128xf32, #blocked>
+  }
+  tt.return %acc : tensor<64x128xf32, #blocked>
+}
+
+// SM80-LABEL: tt.func @dot_invariant_b
+// SM80: tt.dot {{.*}} -> tensor<64x128xf32, #[[MMA_4X1]]>
+tt.func @dot_invariant_b(%a_ptrs: tensor<64x32x!tt.ptr<f16>, #blocked>, %b: tensor<32x128xf16, #blocked>, %n: i32) -> tensor<64x128xf32, #blocked> {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<64x128xf32, #blocked>
+  %acc = scf.for %i = %c0 to %n step %c1 iter_args(%c = %cst) -> (tensor<64x128xf32, #blocked>) : i32 {
+    %a = tt.load %a_ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x32xf16, #blocked>
+    %0 = triton_gpu.convert_layout %a : (tensor<64x32xf16, #blocked>) -> tensor<64x32xf16, #A>
+    %1 = triton_gpu.convert_layout %b : (tensor<32x128xf16, #blocked>) -> tensor<32x128xf16, #B>
+    %2 = tt.dot %0, %1, %c {allowTF32 = true} : tensor<64x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<64x128xf32, #blocked>
+    scf.yield %2 : tensor<64x128xf32, #blocked>
+  }
+  tt.return %acc : tensor<64x128xf32, #blocked>
+}
+
+// Skinny dots put all warps along N rather than repeat the 16 rows of M
+// SM80-LABEL: tt.func @dot_skinny
+// SM80: tt.dot {{.*}} -> tensor<16x128xf32, #[[MMA_1X4]]>
+tt.func @dot_skinny(%a: tensor<16x32xf16, #blocked>, %b: tensor<32x128xf16, #blocked>) -> tensor<16x128xf32, #blocked> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x128xf32, #blocked>
+  %0 = triton_gpu.convert_layout %a : (tensor<16x32xf16, #blocked>) -> tensor<16x32xf16, #A>
+  %1 = triton_gpu.convert_layout %b : (tensor<32x128xf16, #blocked>) -> tensor<32x128xf16, #B>
+  %2 = tt.dot %0, %1, %cst {allowTF32 = true} : tensor<16x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<16x128xf32, #blocked>
+  tt.return %2 : tensor<16x128xf32, #blocked>
+}
+
+// The second dot of a chain splits its rows like the first one, instead of
+// along N as @dot_in_loop, so that its A operand stays in registers
+// SM80-LABEL: tt.func @dot_chained
+// SM80: tt.dot {{.*}} -> tensor<64x64xf32, #[[MMA_4X1]]>
+// SM80: tt.dot {{.*}} -> tensor<64x128xf32, #[[MMA_4X1]]>
+tt.func @dot_chained(%q: tensor<64x32xf16, #blocked>, %k_ptrs: tensor<32x64x!tt.ptr<f16>, #blocked>, %v_ptrs: tensor<64x128x!tt.ptr<f16>, #blocked>, %n: i32) -> tensor<64x128xf32, #blocked> {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+  %cst_acc = arith.constant dense<0.000000e+00> : tensor<64x128xf32, #blocked>
+  %0 = triton_gpu.convert_layout %q : (tensor<64x32xf16, #blocked>) -> tensor<64x32xf16, #A>
+  %acc = scf.for %i = %c0 to %n step %c1 iter_args(%c = %cst_acc) -> (tensor<64x128xf32, #blocked>) : i32 {
+    %k = tt.load %k_ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x64xf16, #blocked>
+    %1 = triton_gpu.convert_layout %k : (tensor<32x64xf16, #blocked>) -> tensor<32x64xf16, #B>
+    %qk = tt.dot %0, %1, %cst {allowTF32 = true} : tensor<64x32xf16, #A> * tensor<32x64xf16, #B> -> tensor<64x64xf32, #blocked>
+    %s = math.exp %qk : tensor<64x64xf32, #blocked>
+    %p = arith.truncf %s : tensor<64x64xf32, #blocked> to tensor<64x64xf16, #blocked>
+    %2 = triton_gpu.convert_layout %p : (tensor<64x64xf16, #blocked>) -> tensor<64x64xf16, #A>
+    %v = tt.load %v_ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x128xf16, #blocked>
+    %3 = triton_gpu.convert_layout %v : (tensor<64x128xf16, #blocked>) -> tensor<64x128xf16, #B>
+    %4 = tt.dot %2, %3, %c {allowTF32 = true} : tensor<64x64xf16, #A> * tensor<64x128xf16, #B> -> tensor<64x128xf32, #blocked>
+    scf.yield %4 : tensor<64x128xf32, #blocked>
+  }
+  tt.return %acc : tensor<64x128xf32, #blocked>
+}
+
+}
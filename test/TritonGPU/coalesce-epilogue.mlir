@@ -0,0 +1,31 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-coalesce-epilogue | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-coalesce-epilogue=max-shared-memory=1024 | FileCheck %s --check-prefix=NOSMEM
+
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#slice = #triton_gpu.slice<{dim = 0, parent = #mma}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The accumulator is staged through shared memory and stored 8 halves at a
+// time, in the layout the rows of pointers are contiguous in
+// CHECK: #[[BLOCKED:.*]] = #triton_gpu.blocked<{sizePerThread = [1, 8]{{.*}}order = [1, 0]}>
+// CHECK-LABEL: tt.func @stage_mma_store
+// CHECK: %[[VAL:.*]] = triton_gpu.convert_layout %arg1 : (tensor<128x64xf16, #mma>) -> tensor<128x64xf16, #[[BLOCKED]]>
+// CHECK: %[[PTR:.*]] = triton_gpu.convert_layout %{{.*}} : (tensor<128x64x!tt.ptr<f16>, #mma>) -> tensor<128x64x!tt.ptr<f16>, #[[BLOCKED]]>
+// CHECK: tt.store %[[PTR]], %[[VAL]] : tensor<128x64xf16, #[[BLOCKED]]>
+
+// The staging buffer doesn't fit in 1KB, so the store is left alone
+// NOSMEM-LABEL: tt.func @stage_mma_store
+// NOSMEM-NOT: triton_gpu.convert_layout
+// NOSMEM: tt.store %{{.*}}, %arg1 : tensor<128x64xf16, #mma>
+tt.func @stage_mma_store(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %acc: tensor<128x64xf16, #mma>) {
+  %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #slice>
+  %1 = tt.expand_dims %0 {axis = 0 : i32} : (tensor<64xi32, #slice>) -> tensor<1x64xi32, #mma>
+  %2 = tt.broadcast %1 : (tensor<1x64xi32, #mma>) -> tensor<128x64xi32, #mma>
+  %3 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<128x64x!tt.ptr<f16>, #mma>
+  %4 = tt.addptr %3, %2 : tensor<128x64x!tt.ptr<f16>, #mma>, tensor<128x64xi32, #mma>
+  tt.store %4, %acc : tensor<128x64xf16, #mma>
+  tt.return
+}
+
+}
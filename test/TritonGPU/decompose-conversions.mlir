@@ -0,0 +1,64 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-decompose-conversions | FileCheck %s
+// RUN: env TRITON_REMARKS=1 triton-opt %s -split-input-file -tritongpu-decompose-conversions -verify-diagnostics -o /dev/null
+// RUN: triton-opt %s -split-input-file -tritongpu-decompose-conversions=max-shuffle-elems=16 | FileCheck %s --check-prefix=BUDGET
+// RUN: triton-opt %s -split-input-file -tritongpu-decompose-conversions --mlir-pass-statistics -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+
+// The A operand of a decoding step: the lanes of the warp already hold the
+// elements of the MMA layout, which are moved in registers rather than
+// through shared memory
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 2], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [1, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+// CHECK-LABEL: tt.func @decode_tile
+// CHECK: %[[MMA:.*]] = triton_gpu.convert_layout %{{.*}} : (tensor<16x64xf16, #blocked>) -> tensor<16x64xf16, #mma>
+// CHECK: triton_gpu.convert_layout %[[MMA]] : (tensor<16x64xf16, #mma>) -> tensor<16x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+// Unless its 32 elements per thread are over the register budget
+// BUDGET-LABEL: tt.func @decode_tile
+// BUDGET: triton_gpu.convert_layout %{{.*}} : (tensor<16x64xf16, #blocked>) -> tensor<16x64xf16, #shared>
+tt.func @decode_tile(%arg0: tensor<16x64xf16, #blocked>) -> tensor<16x64xf16, #A> {
+  %0 = triton_gpu.convert_layout %arg0 : (tensor<16x64xf16, #blocked>) -> tensor<16x64xf16, #A>
+  tt.return %0 : tensor<16x64xf16, #A>
+}
+}
+
+// -----
+
+// The rows of the warps of the two layouts differ
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+// CHECK-LABEL: tt.func @prefill_tile
+// CHECK: %[[SHARED:.*]] = triton_gpu.convert_layout %{{.*}} : (tensor<128x64xf16, #blocked>) -> tensor<128x64xf16, #shared>
+// CHECK: triton_gpu.convert_layout %[[SHARED]] : (tensor<128x64xf16, #shared>) -> tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+tt.func @prefill_tile(%arg0: tensor<128x64xf16, #blocked>) -> tensor<128x64xf16, #A> {
+  // expected-remark @+1 {{[tritongpu-decompose-conversions] converted through shared memory: the elements of the operand are not held by the same warps in both layouts}}
+  %0 = triton_gpu.convert_layout %arg0 : (tensor<128x64xf16, #blocked>) -> tensor<128x64xf16, #A>
+  tt.return %0 : tensor<128x64xf16, #A>
+}
+}
+
+// -----
+
+// A slot of the pipeliner that was read into registers is read from again
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+// CHECK-LABEL: tt.func @pipelined_slot
+// CHECK-SAME: %[[SLOT:[^:]*]]: tensor<128x64xf16, #shared>
+// CHECK-NEXT: %[[A:.*]] = triton_gpu.convert_layout %[[SLOT]] : (tensor<128x64xf16, #shared>) -> tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+// CHECK-NEXT: tt.return %[[A]]
+tt.func @pipelined_slot(%arg0: tensor<128x64xf16, #shared>) -> tensor<128x64xf16, #A> {
+  %0 = triton_gpu.convert_layout %arg0 : (tensor<128x64xf16, #shared>) -> tensor<128x64xf16, #blocked>
+  %1 = triton_gpu.convert_layout %0 : (tensor<128x64xf16, #blocked>) -> tensor<128x64xf16, #A>
+  tt.return %1 : tensor<128x64xf16, #A>
+}
+}
+
+// STATS: TritonGPUDecomposeConversions
+// STATS-DAG: 1 reused-buffers
+// STATS-DAG: 1 through-shared
+// STATS-DAG: 1 with-shuffles
@@ -0,0 +1,42 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-grid-barriers -verify-diagnostics | FileCheck %s
+
+// The barriers of a kernel synchronize its programs on a counter passed last
+// CHECK-LABEL: tt.func public @two_phases
+// CHECK-SAME: %[[COUNTER:arg[0-9]+]]: !tt.ptr<i32> {tt.divisibility = 16 : i32, tt.grid_barrier}
+// CHECK: tt.store
+// CHECK-NEXT: triton_gpu.grid_barrier %[[COUNTER]] : !tt.ptr<i32>
+// CHECK-NEXT: tt.load
+// CHECK-NOT: tt.grid_barrier
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func public @two_phases(%arg0: !tt.ptr<f32>) {
+  %pid = tt.get_program_id {axis = 0 : i32} : i32
+  %cst = arith.constant 1.000000e+00 : f32
+  %0 = tt.addptr %arg0, %pid : !tt.ptr<f32>, i32
+  tt.store %0, %cst : f32
+  tt.grid_barrier
+  %1 = tt.load %arg0 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : f32
+  tt.store %0, %1 : f32
+  tt.return
+}
+}
+
+// -----
+
+// Kernels without barriers are left unchanged
+// CHECK-LABEL: tt.func public @no_barrier
+// CHECK-SAME: (%arg0: !tt.ptr<f32>)
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func public @no_barrier(%arg0: !tt.ptr<f32>) {
+  tt.return
+}
+}
+
+// -----
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func private @helper() {
+  // expected-error @+1 {{grid barriers are only supported in kernels}}
+  tt.grid_barrier
+  tt.return
+}
+}
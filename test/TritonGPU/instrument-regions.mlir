@@ -0,0 +1,102 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-instrument-regions=loops=true | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-instrument-regions="dots=true loads=true global-timer=true" | FileCheck %s --check-prefix=OPS
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+// The index of the next record is carried by the loop, and the records of
+// each program start after the 4 warps x 256 records x 2 words of the ones
+// before it
+// CHECK: module attributes {"triton_gpu.num-warps" = 4 : i32, triton_gpu.profile_regions = ["body", "scf.for:{{[0-9]+}}"]}
+// CHECK-LABEL: tt.func public @sum_kernel
+// CHECK-SAME: %[[BUFFER:arg[0-9]+]]: !tt.ptr<i64> {tt.divisibility = 16 : i32}
+// CHECK: %[[WORDS:.*]] = arith.constant 2048 : i64
+// CHECK: %[[OFFSET:.*]] = arith.muli %{{.*}}, %[[WORDS]] : i64
+// CHECK: %[[BASE:.*]] = tt.addptr %[[BUFFER]], %[[OFFSET]] : !tt.ptr<i64>, i64
+// CHECK: %[[C0:.*]] = arith.constant 0 : i32
+// CHECK: %[[START:.*]] = triton_gpu.profile_record %[[BASE]][%[[C0]]] {capacity = 256 : i32, isStart = true, regionId = 0 : i32}
+// CHECK: %[[LOOP:.*]]:3 = scf.for {{.*}} iter_args({{.*}}, %[[INDEX:.*]] = %[[START]]) -> ({{.*}}, i32)
+// CHECK: %[[ITER:.*]] = triton_gpu.profile_record %[[BASE]][%[[INDEX]]] {capacity = 256 : i32, isStart = true, regionId = 1 : i32}
+// CHECK: tt.load
+// CHECK: arith.addf
+// CHECK: %[[ITER_END:.*]] = triton_gpu.profile_record %[[BASE]][%[[ITER]]] {capacity = 256 : i32, isStart = false, regionId = 1 : i32}
+// CHECK: scf.yield {{.*}}, %[[ITER_END]] : {{.*}}, i32
+// CHECK: triton_gpu.profile_record %[[BASE]][%[[LOOP]]#2] {capacity = 256 : i32, isStart = false, regionId = 0 : i32}
+// CHECK-NOT: tt.profile_marker
+// CHECK: tt.store
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func public @sum_kernel(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>, %n: i32) {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %step = arith.constant dense<256> : tensor<256xi32, #blocked>
+  %zero = arith.constant dense<0.000000e+00> : tensor<256xf32, #blocked>
+  %range = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked>
+  %base = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>, #blocked>
+  %init = tt.addptr %base, %range : tensor<256x!tt.ptr<f32>, #blocked>, tensor<256xi32, #blocked>
+  tt.profile_marker "body" {isStart = true}
+  %loop:2 = scf.for %i = %c0 to %n step %c1 iter_args(%sum = %zero, %ptr = %init) -> (tensor<256xf32, #blocked>, tensor<256x!tt.ptr<f32>, #blocked>) : i32 {
+    %val = tt.load %ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<256xf32, #blocked>
+    %add = arith.addf %sum, %val : tensor<256xf32, #blocked>
+    %next = tt.addptr %ptr, %step : tensor<256x!tt.ptr<f32>, #blocked>, tensor<256xi32, #blocked>
+    scf.yield %add, %next : tensor<256xf32, #blocked>, tensor<256x!tt.ptr<f32>, #blocked>
+  }
+  tt.profile_marker "body" {isStart = false}
+  %obase = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>, #blocked>
+  %optrs = tt.addptr %obase, %range : tensor<256x!tt.ptr<f32>, #blocked>, tensor<256xi32, #blocked>
+  tt.store %optrs, %loop#0 : tensor<256xf32, #blocked>
+  tt.return
+}
+}
+
+// -----
+
+// A conditional with records yields the index of its branches, the one
+// without records forwarding the index it started from
+// CHECK-LABEL: tt.func public @cond_kernel
+// CHECK: %[[C0:.*]] = arith.constant 0 : i32
+// CHECK: %[[IF:.*]] = scf.if %{{.*}} -> (i32) {
+// CHECK: %[[START:.*]] = triton_gpu.profile_record %{{.*}}[%[[C0]]] {capacity = 256 : i32, isStart = true, regionId = 0 : i32}
+// CHECK: tt.store
+// CHECK: %[[END:.*]] = triton_gpu.profile_record %{{.*}}[%[[START]]] {capacity = 256 : i32, isStart = false, regionId = 0 : i32}
+// CHECK: scf.yield %[[END]] : i32
+// CHECK: } else {
+// CHECK: scf.yield %[[C0]] : i32
+// CHECK: }
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func public @cond_kernel(%arg0: !tt.ptr<i32>, %cond: i1) {
+  %c1 = arith.constant 1 : i32
+  scf.if %cond {
+    tt.profile_marker "store" {isStart = true}
+    tt.store %arg0, %c1 : i32
+    tt.profile_marker "store" {isStart = false}
+  }
+  tt.return
+}
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot0 = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot1 = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+
+// Dots are recorded around them, and loads until the first use of their
+// result; the time is read from the global timer
+// OPS: triton_gpu.profile_regions = ["tt.load:{{[0-9]+}}", "tt.dot:{{[0-9]+}}"]
+// OPS-LABEL: tt.func public @dot_kernel
+// OPS: triton_gpu.profile_record {{.*}} {capacity = 256 : i32, globalTimer, isStart = true, regionId = 0 : i32}
+// OPS-NEXT: %[[A:.*]] = tt.load
+// OPS-NEXT: triton_gpu.convert_layout %[[A]]
+// OPS-NEXT: triton_gpu.profile_record {{.*}} {capacity = 256 : i32, globalTimer, isStart = false, regionId = 0 : i32}
+// OPS: triton_gpu.profile_record {{.*}} {capacity = 256 : i32, globalTimer, isStart = true, regionId = 1 : i32}
+// OPS-NEXT: tt.dot
+// OPS-NEXT: triton_gpu.profile_record {{.*}} {capacity = 256 : i32, globalTimer, isStart = false, regionId = 1 : i32}
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func public @dot_kernel(%ptrs: tensor<16x16x!tt.ptr<f32>, #blocked>, %b: tensor<16x16xf32, #dot1>, %out: tensor<16x16x!tt.ptr<f32>, #blocked>) {
+  %zero = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #blocked>
+  %a = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xf32, #blocked>
+  %a_dot = triton_gpu.convert_layout %a : (tensor<16x16xf32, #blocked>) -> tensor<16x16xf32, #dot0>
+  %c = tt.dot %a_dot, %b, %zero {allowTF32 = true} : tensor<16x16xf32, #dot0> * tensor<16x16xf32, #dot1> -> tensor<16x16xf32, #blocked>
+  tt.store %out, %c : tensor<16x16xf32, #blocked>
+  tt.return
+}
+}
@@ -1,4 +1,5 @@
-// RUN: triton-opt %s -split-input-file -tritongpu-pipeline=num-stages=3 -canonicalize | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline="num-stages=3 pipeline-non-dot-loads=true" -canonicalize | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline=num-stages=3 -canonicalize | FileCheck %s --check-prefix=DEFAULT
 
 // 4 warps
 // matmul: 128x32 @ 32x128 -> 128x128
@@ -313,3 +314,205 @@ tt.func @lut_bmm_vector(%77: tensor<16x16xi64, #BL> {tt.divisibility=16: i32, tt
   }
   tt.return %79#0 : tensor<16x16xf32, #C>
 }
+
+// CHECK: tt.func @sum_loop
+// CHECK: %[[BUFFER:.*]] = triton_gpu.alloc_tensor {{.*}} : tensor<3x32x128xf16, #[[SHARED:.*]]>
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: triton_gpu.async_wait {num = 1 : i32}
+// CHECK: %[[TILE0:.*]] = triton_gpu.extract_slice
+// CHECK: scf.for {{.*}} iter_args({{.*}}, %[[arg_tile:.*]] = %[[TILE0]],
+// CHECK:   %[[TILE:.*]] = triton_gpu.convert_layout %[[arg_tile]] : (tensor<32x128xf16, #[[SHARED]]>) -> tensor<32x128xf16, #{{.*}}>
+// CHECK:   arith.addf {{.*}}, %[[TILE]]
+// CHECK:   triton_gpu.insert_slice_async
+// CHECK:   triton_gpu.async_wait {num = 1 : i32}
+// CHECK:   triton_gpu.extract_slice
+
+// Without pipeline-non-dot-loads, the tile is loaded in the loop
+// DEFAULT-LABEL: tt.func @sum_loop
+// DEFAULT-NOT: triton_gpu.alloc_tensor
+// DEFAULT: scf.for
+// DEFAULT-NOT: triton_gpu.insert_slice_async
+// DEFAULT:   tt.load
+// DEFAULT-NOT: triton_gpu.insert_slice_async
+// DEFAULT: tt.return
+tt.func @sum_loop(%lb : index, %ub : index, %step : index,
+                  %B : !tt.ptr<f16> {tt.divisibility = 16 : i32}) -> tensor<32x128xf16, #BL> {
+  %b_ptr_splat = tt.splat %B : (!tt.ptr<f16>) -> tensor<32x128x!tt.ptr<f16>, #BL>
+  %b_tmp0 = tt.make_range {end = 128: i32, start = 0: i32} : tensor<128xi32, #BLs0>
+  %b_tmp1 = tt.expand_dims %b_tmp0 {axis = 0 : i32} : (tensor<128xi32, #BLs0>) -> tensor<1x128xi32, #BL>
+  %b_offs = tt.broadcast %b_tmp1 : (tensor<1x128xi32, #BL>) -> tensor<32x128xi32, #BL>
+  %b_ptr_init = tt.addptr %b_ptr_splat, %b_offs : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+  %b_off = arith.constant dense<4> : tensor<32x128xi32, #BL>
+  %sum_init = arith.constant dense<0.00e+00> : tensor<32x128xf16, #BL>
+
+  // the loaded tile is not a dot operand
+  %loop:2 = scf.for %iv = %lb to %ub step %step iter_args(%b_ptr = %b_ptr_init, %prev_sum = %sum_init) -> (tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xf16, #BL>) {
+    %b = tt.load %b_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x128xf16, #BL>
+    %sum = arith.addf %prev_sum, %b : tensor<32x128xf16, #BL>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+    scf.yield %next_b_ptr, %sum : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xf16, #BL>
+  }
+  tt.return %loop#1: tensor<32x128xf16, #BL>
+}
+
+// The index tile is loaded ahead of the data it points at, which is pipelined
+// CHECK: tt.func @indirect_bmm
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: %[[IDX_0:.*]] = tt.load {{.*}} : tensor<16x16xi64
+// CHECK: %[[OFFSET_0:.*]] = arith.muli {{.*}}, %[[IDX_0]]
+// CHECK: %[[DATA_PTR_0:.*]] = tt.addptr {{.*}}, %[[OFFSET_0]]
+// CHECK: triton_gpu.insert_slice_async %[[DATA_PTR_0]]
+// CHECK: scf.for
+// CHECK:   tt.dot
+// CHECK:   %[[NEXT_IDX:.*]] = tt.load {{.*}} : tensor<16x16xi64
+// CHECK:   %[[NEXT_OFFSET:.*]] = arith.muli {{.*}}, %[[NEXT_IDX]]
+// CHECK:   %[[NEXT_DATA_PTR:.*]] = tt.addptr {{.*}}, %[[NEXT_OFFSET]]
+// CHECK:   triton_gpu.insert_slice_async
+// CHECK:   triton_gpu.insert_slice_async %[[NEXT_DATA_PTR]]
+// CHECK:   triton_gpu.async_wait {num = 2 : i32}
+tt.func @indirect_bmm(%77: tensor<16x16xi64, #BL> {tt.divisibility=16: i32, tt.constancy=16: i32},
+                   %76: index,
+                   %49: tensor<16x16x!tt.ptr<f16>, #AL> {tt.divisibility=16: i32, tt.contiguity=2 : i32},
+                   %75: tensor<16x16x!tt.ptr<i64>, #BL> {tt.divisibility=16: i32, tt.contiguity=16 : i32},
+                   %78: tensor<16x16xi32, #AL> {tt.constancy=16: i32, tt.divisibility=16: i32},
+                   %60: tensor<16x16x!tt.ptr<f16>, #BL> {tt.divisibility=16: i32, tt.contiguity=16 : i32}) -> tensor<16x16xf32, #C>{
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #C>
+  %c1 = arith.constant 1 : index
+  %c0 = arith.constant 0 : index
+  %c16_i32 = arith.constant dense<16> : tensor<16x16xi32, #BL>
+  %79:3 = scf.for %arg18 = %c0 to %76 step %c1 iter_args(%arg19 = %cst, %arg20 = %49, %arg21 = %75) -> (tensor<16x16xf32, #C>, tensor<16x16x!tt.ptr<f16>, #AL>, tensor<16x16x!tt.ptr<i64>, #BL>) {
+    %82 = tt.load %arg20 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xf16, #AL>
+    %83 = tt.load %arg21 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xi64, #BL>
+    %85 = arith.muli %77, %83 : tensor<16x16xi64, #BL>
+    %86 = tt.addptr %60, %85 : tensor<16x16x!tt.ptr<f16>, #BL>, tensor<16x16xi64, #BL>
+    %87 = tt.load %86 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xf16, #BL>
+    %88 = triton_gpu.convert_layout %82 : (tensor<16x16xf16, #AL>) -> tensor<16x16xf16, #A>
+    %89 = triton_gpu.convert_layout %87 : (tensor<16x16xf16, #BL>) -> tensor<16x16xf16, #B>
+    %90 = tt.dot %88, %89, %arg19 {allowTF32 = true} : tensor<16x16xf16, #A> * tensor<16x16xf16, #B> -> tensor<16x16xf32, #C>
+    %91 = tt.addptr %arg20, %78 : tensor<16x16x!tt.ptr<f16>, #AL>, tensor<16x16xi32, #AL>
+    %92 = tt.addptr %arg21, %c16_i32 : tensor<16x16x!tt.ptr<i64>, #BL>, tensor<16x16xi32, #BL>
+    scf.yield %90, %91, %92 : tensor<16x16xf32, #C>, tensor<16x16x!tt.ptr<f16>, #AL>, tensor<16x16x!tt.ptr<i64>, #BL>
+  }
+  tt.return %79#0 : tensor<16x16xf32, #C>
+}
+
+// The loop of the block-sparse DSD kernel, whose pointers are incremented by
+// the LUT entries of the next block. The increments are loaded ahead, masked
+// by the condition of their iteration, and the tiles they point at are copied
+// asynchronously
+// CHECK: tt.func @dsd_bmm
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: tt.load {{.*}} : i32
+// CHECK: tt.load {{.*}} : i32
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: scf.for
+// CHECK:   tt.dot
+// CHECK:   tt.load {{.*}} : i32
+// CHECK:   tt.load {{.*}} : i32
+// CHECK:   triton_gpu.insert_slice_async
+// CHECK:   triton_gpu.insert_slice_async
+// CHECK:   triton_gpu.async_wait {num = 2 : i32}
+tt.func @dsd_bmm(%ub: index,
+                 %pa_init: tensor<16x16x!tt.ptr<f16>, #AL> {tt.divisibility=16: i32, tt.contiguity=16 : i32},
+                 %pb_init: tensor<16x16x!tt.ptr<f16>, #BL> {tt.divisibility=16: i32, tt.contiguity=16 : i32},
+                 %lut: !tt.ptr<i32> {tt.divisibility=16: i32},
+                 %stride_bk: i32 {tt.divisibility=16: i32}) -> tensor<16x16xf32, #C> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #C>
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c1_i32 = arith.constant 1 : i32
+  %c2_i32 = arith.constant 2 : i32
+  %pinc_a = tt.addptr %lut, %c1_i32 : !tt.ptr<i32>, i32
+  %inc_a_init = tt.load %pinc_a {cache = 1 : i32, evict = 1 : i32, isVolatile = false, tt.divisibility = dense<8> : tensor<1xi32>} : i32
+  %inc_b_init = tt.load %lut {cache = 1 : i32, evict = 1 : i32, isVolatile = false, tt.divisibility = dense<8> : tensor<1xi32>} : i32
+  %loop:6 = scf.for %iv = %c0 to %ub step %c1 iter_args(%acc = %cst, %pa = %pa_init, %pb = %pb_init, %pinc = %lut, %inc_a = %inc_a_init, %inc_b = %inc_b_init) -> (tensor<16x16xf32, #C>, tensor<16x16x!tt.ptr<f16>, #AL>, tensor<16x16x!tt.ptr<f16>, #BL>, !tt.ptr<i32>, i32, i32) {
+    %a = tt.load %pa {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xf16, #AL>
+    %b = tt.load %pb {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xf16, #BL>
+    %a_op = triton_gpu.convert_layout %a : (tensor<16x16xf16, #AL>) -> tensor<16x16xf16, #A>
+    %b_op = triton_gpu.convert_layout %b : (tensor<16x16xf16, #BL>) -> tensor<16x16xf16, #B>
+    %dot = tt.dot %a_op, %b_op, %acc {allowTF32 = true} : tensor<16x16xf16, #A> * tensor<16x16xf16, #B> -> tensor<16x16xf32, #C>
+    %inc_a_splat = tt.splat %inc_a : (i32) -> tensor<16x16xi32, #AL>
+    %next_pa = tt.addptr %pa, %inc_a_splat : tensor<16x16x!tt.ptr<f16>, #AL>, tensor<16x16xi32, #AL>
+    %inc_b_scaled = arith.muli %inc_b, %stride_bk : i32
+    %inc_b_splat = tt.splat %inc_b_scaled : (i32) -> tensor<16x16xi32, #BL>
+    %next_pb = tt.addptr %pb, %inc_b_splat : tensor<16x16x!tt.ptr<f16>, #BL>, tensor<16x16xi32, #BL>
+    %next_pinc = tt.addptr %pinc, %c2_i32 : !tt.ptr<i32>, i32
+    %next_pinc_a = tt.addptr %next_pinc, %c1_i32 : !tt.ptr<i32>, i32
+    %next_inc_a = tt.load %next_pinc_a {cache = 1 : i32, evict = 1 : i32, isVolatile = false, tt.divisibility = dense<8> : tensor<1xi32>} : i32
+    %next_inc_b = tt.load %next_pinc {cache = 1 : i32, evict = 1 : i32, isVolatile = false, tt.divisibility = dense<8> : tensor<1xi32>} : i32
+    scf.yield %dot, %next_pa, %next_pb, %next_pinc, %next_inc_a, %next_inc_b : tensor<16x16xf32, #C>, tensor<16x16x!tt.ptr<f16>, #AL>, tensor<16x16x!tt.ptr<f16>, #BL>, !tt.ptr<i32>, i32, i32
+  }
+  tt.return %loop#0 : tensor<16x16xf32, #C>
+}
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #C}>
+
+// Descriptor loads are copied with TMA in the swizzle of their dot operand,
+// which is recorded in the tensor map, and waited for on an mbarrier per slot
+// CHECK-LABEL: tt.func public @matmul_tma
+// CHECK-SAME: swizzle = 64 : i32
+// CHECK-DAG: %[[CONSTANT_0:.*]] = arith.constant 0 : i32
+// CHECK-DAG: %[[CONSTANT_1:.*]] = arith.constant 1 : i32
+// CHECK-DAG: %[[CONSTANT_3:.*]] = arith.constant 3 : i32
+// CHECK: %[[ABUFFER:.*]] = triton_gpu.alloc_tensor : tensor<3x128x32xf16, #[[SHARED:.*]]>
+// CHECK: %[[BARRIERS:.*]] = triton_gpu.alloc_mbarrier : tensor<3xi64
+// CHECK: %[[A0BUFFER:.*]] = triton_gpu.insert_slice_tma %{{.*}}[%[[CONSTANT_0]], %{{.*}}], %[[ABUFFER]], %[[CONSTANT_0]], %[[BARRIERS]], %{{.*}}
+// CHECK: %[[A1BUFFER:.*]] = triton_gpu.insert_slice_tma %{{.*}}[%[[CONSTANT_0]], %{{.*}}], %[[A0BUFFER]], %[[CONSTANT_1]], %[[BARRIERS]], %{{.*}}
+// CHECK-NOT: triton_gpu.async_wait
+// CHECK: triton_gpu.mbarrier_wait %[[BARRIERS]][%[[CONSTANT_0]]], %[[CONSTANT_0]]
+// CHECK: %[[A0:.*]] = triton_gpu.extract_slice %[[A1BUFFER]][0, 0, 0]
+// CHECK: scf.for {{.*}} iter_args({{.*}}, %[[arg_a0:.*]] = %[[A0]], {{.*}}, %[[PIPELINE_IDX:.*]] = %{{.*}}, %[[LOOP_IDX:.*]] = %[[CONSTANT_1]]
+// CHECK:   triton_gpu.convert_layout %[[arg_a0]]
+// CHECK:   tt.dot
+// CHECK-DAG: %[[INSERT_IDX:.*]] = arith.remsi %[[PIPELINE_IDX]], %[[CONSTANT_3]]
+// CHECK-DAG: %[[EXTRACT_IDX:.*]] = arith.remsi %[[LOOP_IDX]], %[[CONSTANT_3]]
+// CHECK-DAG: %[[ROUND:.*]] = arith.divsi %[[LOOP_IDX]], %[[CONSTANT_3]]
+// CHECK-DAG: %[[PHASE:.*]] = arith.andi %[[ROUND]], %[[CONSTANT_1]]
+// CHECK:   %[[NEXT_A_BUFFER:.*]] = triton_gpu.insert_slice_tma {{.*}}, %[[INSERT_IDX]], %[[BARRIERS]]
+// CHECK:   triton_gpu.mbarrier_wait %[[BARRIERS]][%[[EXTRACT_IDX]]], %[[PHASE]]
+// CHECK:   triton_gpu.extract_slice %[[NEXT_A_BUFFER]][%[[EXTRACT_IDX]], 0, 0]
+// CHECK: }
+// CHECK-NOT: triton_gpu.async_wait
+tt.func public @matmul_tma(%A: !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                           %lb : index, %ub : index, %step : index,
+                           %b : tensor<32x128xf16, #B>,
+                           %desc: !tt.ptr<i8> {tt.tensormap = {base = 0 : i32, box = array<i32: 128, 32>, elem = f16, shape = array<i64: -1, -1>, shape_values = array<i64: 128, 4096>, stride_values = array<i64: 4096, 1>, strides = array<i64: -1, -1>}}) -> tensor<128x128xf32, #C> {
+  %c0_i32 = arith.constant 0 : i32
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  %loop = scf.for %iv = %lb to %ub step %step iter_args(%prev_c = %c_init) -> (tensor<128x128xf32, #C>) {
+    %k = arith.index_cast %iv : index to i32
+    %a_ = tt.descriptor_load %desc[%c0_i32, %k] : !tt.ptr<i8> -> tensor<128x32xf16, #AL>
+    %a = triton_gpu.convert_layout %a_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A>
+    %c = tt.dot %a, %b, %prev_c {allowTF32 = true} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+    scf.yield %c : tensor<128x128xf32, #C>
+  }
+  tt.return %loop : tensor<128x128xf32, #C>
+}
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+// Descriptor loads outside of pipelined loops wait for their copy right away
+// CHECK-LABEL: tt.func public @load_tma_sync
+// CHECK-SAME: swizzle = 0 : i32
+// CHECK: %[[BUFFER:.*]] = triton_gpu.alloc_tensor : tensor<1x64x32xf16
+// CHECK: %[[BARRIERS:.*]] = triton_gpu.alloc_mbarrier : tensor<1xi64
+// CHECK: %[[INSERT:.*]] = triton_gpu.insert_slice_tma %{{.*}}[%{{.*}}, %{{.*}}], %[[BUFFER]], %[[ZERO:.*]], %[[BARRIERS]], %{{.*}}
+// CHECK: triton_gpu.mbarrier_wait %[[BARRIERS]][%[[ZERO]]], %[[ZERO]]
+// CHECK: %[[SLICE:.*]] = triton_gpu.extract_slice %[[INSERT]][0, 0, 0] [1, 64, 32] [1, 1, 1]
+// CHECK: triton_gpu.convert_layout %[[SLICE]]
+tt.func public @load_tma_sync(%A: !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                              %x : i32, %y : i32,
+                              %desc: !tt.ptr<i8> {tt.tensormap = {base = 0 : i32, box = array<i32: 64, 32>, elem = f16, shape = array<i64: -1, -1>, shape_values = array<i64: 128, 4096>, stride_values = array<i64: 4096, 1>, strides = array<i64: -1, -1>}}) -> tensor<64x32xf16, #AL> {
+  %a = tt.descriptor_load %desc[%x, %y] : !tt.ptr<i8> -> tensor<64x32xf16, #AL>
+  tt.return %a : tensor<64x32xf16, #AL>
+}
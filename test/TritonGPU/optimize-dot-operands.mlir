@@ -0,0 +1,72 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-optimize-dot-operands | FileCheck %s
+
+// The shared memory of a transposed operand is swizzled for the dot operand
+// it is loaded as, i.e. for its transposed shape and order.
+// CHECK: #[[SHARED_F32:shared[0-9]*]] = #triton_gpu.shared<{vec = 4, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: tt.func @transposed_b_f32
+// CHECK: %[[X:.*]] = triton_gpu.convert_layout %{{.*}} : (tensor<64x32xf32, #blocked>) -> tensor<64x32xf32, #[[SHARED_F32]]>
+// CHECK: %[[Y:.*]] = tt.trans %[[X]]
+// CHECK: triton_gpu.convert_layout %[[Y]] : (tensor<32x64xf32, #{{.*}}>) -> tensor<32x64xf32, #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>>
+tt.func @transposed_b_f32(%a: tensor<128x32xf32, #A>, %b: tensor<64x32xf32, #blocked>) -> tensor<128x64xf32, #mma> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+  %0 = triton_gpu.convert_layout %b : (tensor<64x32xf32, #blocked>) -> tensor<64x32xf32, #shared>
+  %1 = tt.trans %0 : (tensor<64x32xf32, #shared>) -> tensor<32x64xf32, #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0, 1]}>>
+  %2 = triton_gpu.convert_layout %1 : (tensor<32x64xf32, #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0, 1]}>>) -> tensor<32x64xf32, #B>
+  %3 = tt.dot %a, %2, %cst {allowTF32 = true} : tensor<128x32xf32, #A> * tensor<32x64xf32, #B> -> tensor<128x64xf32, #mma>
+  tt.return %3 : tensor<128x64xf32, #mma>
+}
+
+}
+
+// -----
+
+// The i8 weights of a dot are staged in shared memory and dequantized as they
+// are loaded as its operand, instead of being staged dequantized to f16.
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: tt.func @dequantize_b
+// CHECK-SAME: %[[Q:[^:]*]]: tensor<32x64xi8, #blocked>, %[[SCALE:[^:]*]]: f16
+// CHECK-NOT: arith.sitofp
+// CHECK-DAG: %[[ZERO:.*]] = arith.constant 8.000000e+00 : f32
+// CHECK-DAG: %[[S:.*]] = arith.extf %[[SCALE]] : f16 to f32
+// CHECK-DAG: %[[X:.*]] = triton_gpu.convert_layout %[[Q]] : (tensor<32x64xi8, #blocked>) -> tensor<32x64xi8, #shared{{[0-9]*}}>
+// CHECK: %[[Y:.*]] = triton_gpu.dequantize %[[X]], %[[S]], %[[ZERO]] {isSigned = true} : tensor<32x64xi8, #shared{{[0-9]*}}> -> tensor<32x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>>
+// CHECK: tt.dot %{{.*}}, %[[Y]]
+tt.func @dequantize_b(%a: tensor<128x32xf16, #A>, %q: tensor<32x64xi8, #blocked>, %scale: f16) -> tensor<128x64xf32, #mma> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+  %zero = arith.constant dense<8.000000e+00> : tensor<32x64xf16, #blocked>
+  %s = tt.splat %scale : (f16) -> tensor<32x64xf16, #blocked>
+  %0 = arith.sitofp %q : tensor<32x64xi8, #blocked> to tensor<32x64xf16, #blocked>
+  %1 = arith.subf %0, %zero : tensor<32x64xf16, #blocked>
+  %2 = arith.mulf %1, %s : tensor<32x64xf16, #blocked>
+  %3 = triton_gpu.convert_layout %2 : (tensor<32x64xf16, #blocked>) -> tensor<32x64xf16, #B>
+  %4 = tt.dot %a, %3, %cst {allowTF32 = true} : tensor<128x32xf16, #A> * tensor<32x64xf16, #B> -> tensor<128x64xf32, #mma>
+  tt.return %4 : tensor<128x64xf32, #mma>
+}
+
+// The weights are used elsewhere, so they stay dequantized in registers.
+// CHECK-LABEL: tt.func @dequantize_used
+// CHECK-NOT: triton_gpu.dequantize
+tt.func @dequantize_used(%a: tensor<128x32xf16, #A>, %q: tensor<32x64xi8, #blocked>) -> (tensor<128x64xf32, #mma>, tensor<32x64xf16, #blocked>) {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+  %0 = arith.uitofp %q : tensor<32x64xi8, #blocked> to tensor<32x64xf16, #blocked>
+  %1 = triton_gpu.convert_layout %0 : (tensor<32x64xf16, #blocked>) -> tensor<32x64xf16, #B>
+  %2 = tt.dot %a, %1, %cst {allowTF32 = true} : tensor<128x32xf16, #A> * tensor<32x64xf16, #B> -> tensor<128x64xf32, #mma>
+  tt.return %2, %0 : tensor<128x64xf32, #mma>, tensor<32x64xf16, #blocked>
+}
+
+}
@@ -0,0 +1,55 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-persistent-kernel | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-persistent-kernel=pipeline-tiles=true | FileCheck %s --check-prefix=PIPELINE
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: tt.func public @add_kernel
+// CHECK-SAME: %[[NUM_TILES:arg[0-9]+]]: i32
+// CHECK: %[[PID:.*]] = tt.get_program_id {axis = 0 : i32} : i32
+// CHECK: %[[NPROGS:.*]] = tt.get_num_programs {axis = 0 : i32} : i32
+// CHECK: scf.for %[[TILE:.*]] = %[[PID]] to %[[NUM_TILES]] step %[[NPROGS]] : i32 {
+// CHECK-NOT: tt.get_program_id
+// CHECK: arith.muli %[[TILE]]
+// CHECK: tt.load
+// CHECK: tt.store
+// CHECK: } {tt.no_pipeline}
+// CHECK-NEXT: tt.return
+// PIPELINE-LABEL: tt.func public @add_kernel
+// PIPELINE: scf.for
+// PIPELINE-NOT: tt.no_pipeline
+// PIPELINE: tt.return
+tt.func public @add_kernel(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>) {
+  %c256_i32 = arith.constant 256 : i32
+  %0 = tt.get_program_id {axis = 0 : i32} : i32
+  %1 = arith.muli %0, %c256_i32 : i32
+  %2 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked>
+  %3 = tt.splat %1 : (i32) -> tensor<256xi32, #blocked>
+  %4 = arith.addi %3, %2 : tensor<256xi32, #blocked>
+  %5 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>, #blocked>
+  %6 = tt.addptr %5, %4 : tensor<256x!tt.ptr<f32>, #blocked>, tensor<256xi32, #blocked>
+  %7 = tt.load %6 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<256xf32, #blocked>
+  %8 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>, #blocked>
+  %9 = tt.addptr %8, %4 : tensor<256x!tt.ptr<f32>, #blocked>, tensor<256xi32, #blocked>
+  tt.store %9, %7 : tensor<256xf32, #blocked>
+  tt.return
+}
+
+}
+
+// -----
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The number of programs is the number of tiles inside the tile loop
+// CHECK-LABEL: tt.func public @num_programs
+// CHECK-SAME: %[[NUM_TILES:arg[0-9]+]]: i32
+// CHECK: scf.for
+// CHECK: tt.store %{{.*}}, %[[NUM_TILES]] : i32
+tt.func public @num_programs(%arg0: !tt.ptr<i32>) {
+  %0 = tt.get_num_programs {axis = 0 : i32} : i32
+  tt.store %arg0, %0 : i32
+  tt.return
+}
+
+}
@@ -0,0 +1,75 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline-chained-dots | FileCheck %s
+
+#mma = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [0, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// QK^T of the next block is computed at the end of the iteration, from the
+// slot of K the pipeliner extracts for it, and carried by the loop
+// CHECK-LABEL: tt.func @attention
+// CHECK: %[[K0:.*]] = triton_gpu.convert_layout %arg1
+// CHECK: %[[QK0:.*]] = tt.dot %arg0, %[[K0]]
+// CHECK: scf.for {{.*}} iter_args(%[[ACC:.*]] = %{{.*}}, %[[K:.*]] = %arg1, %[[QK:.*]] = %[[QK0]])
+// CHECK-NOT: triton_gpu.convert_layout %[[K]]
+// CHECK: math.exp %[[QK]]
+// CHECK: %[[D:.*]] = tt.dot {{.*}}, %[[ACC]]
+// CHECK: %[[K_NEXT:.*]] = triton_gpu.extract_slice
+// CHECK: %[[K_NEXT_DOT:.*]] = triton_gpu.convert_layout %[[K_NEXT]]
+// CHECK: %[[QK_NEXT:.*]] = tt.dot %arg0, %[[K_NEXT_DOT]]
+// CHECK: scf.yield %[[D]], %[[K_NEXT]], %[[QK_NEXT]]
+tt.func @attention(%q: tensor<128x64xf16, #A>, %k_init: tensor<64x128xf16, #shared>, %k_buffer: tensor<2x64x128xf16, #shared>, %v: tensor<128x64xf16, #B>, %lb: i32, %ub: i32, %step: i32) -> tensor<128x64xf32, #mma> {
+  %c2 = arith.constant 2 : i32
+  %zero = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #mma>
+  %acc_init = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+  %r:2 = scf.for %i = %lb to %ub step %step iter_args(%acc = %acc_init, %k = %k_init) -> (tensor<128x64xf32, #mma>, tensor<64x128xf16, #shared>) : i32 {
+    %k_dot = triton_gpu.convert_layout %k : (tensor<64x128xf16, #shared>) -> tensor<64x128xf16, #B>
+    %qk = tt.dot %q, %k_dot, %zero {allowTF32 = true} : tensor<128x64xf16, #A> * tensor<64x128xf16, #B> -> tensor<128x128xf32, #mma>
+    %p = math.exp %qk : tensor<128x128xf32, #mma>
+    %p_f16 = arith.truncf %p : tensor<128x128xf32, #mma> to tensor<128x128xf16, #mma>
+    %p_dot = triton_gpu.convert_layout %p_f16 : (tensor<128x128xf16, #mma>) -> tensor<128x128xf16, #A>
+    %d = tt.dot %p_dot, %v, %acc {allowTF32 = true} : tensor<128x128xf16, #A> * tensor<128x64xf16, #B> -> tensor<128x64xf32, #mma>
+    %idx = arith.remsi %i, %c2 : i32
+    %k_next = triton_gpu.extract_slice %k_buffer[%idx, 0, 0] [1, 64, 128] [1, 1, 1] : tensor<2x64x128xf16, #shared> to tensor<64x128xf16, #shared>
+    scf.yield %d, %k_next : tensor<128x64xf32, #mma>, tensor<64x128xf16, #shared>
+  }
+  tt.return %r#0 : tensor<128x64xf32, #mma>
+}
+
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// K is loaded in the loop, and cannot be loaded for an iteration past the
+// last one
+// CHECK-LABEL: tt.func @attention_unpipelined
+// CHECK: scf.for {{.*}} iter_args(%{{[^,]*}} = %{{[^,]*}}) ->
+// CHECK: tt.load
+// CHECK: tt.dot
+// CHECK: tt.dot
+tt.func @attention_unpipelined(%q: tensor<128x64xf16, #A>, %k_ptrs: tensor<64x128x!tt.ptr<f16>, #blocked>, %v: tensor<128x64xf16, #B>, %lb: i32, %ub: i32, %step: i32) -> tensor<128x64xf32, #mma> {
+  %zero = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #mma>
+  %acc_init = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+  %r = scf.for %i = %lb to %ub step %step iter_args(%acc = %acc_init) -> (tensor<128x64xf32, #mma>) : i32 {
+    %k = tt.load %k_ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x128xf16, #blocked>
+    %k_dot = triton_gpu.convert_layout %k : (tensor<64x128xf16, #blocked>) -> tensor<64x128xf16, #B>
+    %qk = tt.dot %q, %k_dot, %zero {allowTF32 = true} : tensor<128x64xf16, #A> * tensor<64x128xf16, #B> -> tensor<128x128xf32, #mma>
+    %p = math.exp %qk : tensor<128x128xf32, #mma>
+    %p_f16 = arith.truncf %p : tensor<128x128xf32, #mma> to tensor<128x128xf16, #mma>
+    %p_dot = triton_gpu.convert_layout %p_f16 : (tensor<128x128xf16, #mma>) -> tensor<128x128xf16, #A>
+    %d = tt.dot %p_dot, %v, %acc {allowTF32 = true} : tensor<128x128xf16, #A> * tensor<128x64xf16, #B> -> tensor<128x64xf32, #mma>
+    scf.yield %d : tensor<128x64xf32, #mma>
+  }
+  tt.return %r : tensor<128x64xf32, #mma>
+}
+
+}
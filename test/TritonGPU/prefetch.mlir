@@ -1,4 +1,5 @@
 // RUN: triton-opt %s -split-input-file -tritongpu-prefetch | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-prefetch=distance=2 | FileCheck %s --check-prefix=DIST
 
 // 4 warps
 // matmul: 128x32 @ 32x128 -> 128x128
@@ -62,3 +63,65 @@ tt.func @matmul_loop(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>,
   }
   tt.return
 }
+
+// -----
+
+#A = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#B = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#C = #triton_gpu.blocked<{sizePerThread = [4, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_OP = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
+#B_OP = #triton_gpu.dot_op<{opIdx = 1, parent = #C}>
+
+// FMA dots with a K smaller than 16 bytes are prefetched entirely
+// CHECK: tt.func @fma_small_k
+// CHECK-DAG: %[[A0_PREFETCH_SMEM:.*]] = triton_gpu.extract_slice %[[A0:.*]][0, 0] [64, 8]
+// CHECK-DAG: %[[B0_PREFETCH_SMEM:.*]] = triton_gpu.extract_slice %[[B0:.*]][0, 0] [8, 64]
+// CHECK:     scf.for
+// CHECK:       tt.dot
+// CHECK-NOT:   tt.dot
+// CHECK:       triton_gpu.extract_slice {{.*}}[0, 0] [64, 8]
+// CHECK:       triton_gpu.extract_slice {{.*}}[0, 0] [8, 64]
+// CHECK:     scf.yield
+tt.func @fma_small_k(%lb : index, %ub : index, %step : index, %a_init : tensor<64x8xf16, #A>, %b_init : tensor<8x64xf16, #B>) {
+  %c_init = arith.constant dense<0.00e+00> : tensor<64x64xf32, #C>
+  scf.for %iv = %lb to %ub step %step iter_args(%a = %a_init, %b = %b_init, %prev_c = %c_init) -> (tensor<64x8xf16, #A>, tensor<8x64xf16, #B>, tensor<64x64xf32, #C>) {
+    %a_op = triton_gpu.convert_layout %a : (tensor<64x8xf16, #A>) -> tensor<64x8xf16, #A_OP>
+    %b_op = triton_gpu.convert_layout %b : (tensor<8x64xf16, #B>) -> tensor<8x64xf16, #B_OP>
+    %c = tt.dot %a_op, %b_op, %prev_c {allowTF32 = true, transA = false, transB = false} : tensor<64x8xf16, #A_OP> * tensor<8x64xf16, #B_OP> -> tensor<64x64xf32, #C>
+    scf.yield %a, %b, %c : tensor<64x8xf16, #A>, tensor<8x64xf16, #B>, tensor<64x64xf32, #C>
+  }
+  tt.return
+}
+
+// -----
+
+#A = #triton_gpu.shared<{vec = 4, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#B = #triton_gpu.shared<{vec = 4, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#C = #triton_gpu.mma<{versionMajor = 1, versionMinor = 3, warpsPerCTA = [2, 2]}>
+#A_OP = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
+#B_OP = #triton_gpu.dot_op<{opIdx = 1, parent = #C}>
+
+// With a distance of 2, the first two K-slices are loaded during the previous
+// iteration, and the last one at the start of the current iteration.
+// DIST-LABEL: tt.func @mmav1_distance
+// DIST-DAG: triton_gpu.extract_slice %{{.*}}[0, 0] [64, 16]
+// DIST-DAG: triton_gpu.extract_slice %{{.*}}[0, 16] [64, 16]
+// DIST-DAG: triton_gpu.extract_slice %{{.*}}[0, 0] [16, 64]
+// DIST-DAG: triton_gpu.extract_slice %{{.*}}[16, 0] [16, 64]
+// DIST:     scf.for {{.*}} iter_args(%[[A:.*]] = %{{.*}}, %[[B:.*]] = %{{.*}}, %{{.*}} = %{{.*}}, %[[A0:.*]] = %{{.*}}, %[[B0:.*]] = %{{.*}}, %[[A1:.*]] = %{{.*}}, %[[B1:.*]] = %{{.*}})
+// DIST:       %[[D0:.*]] = tt.dot %[[A0]], %[[B0]], %{{.*}}
+// DIST-DAG:   triton_gpu.extract_slice %[[A]][0, 32] [64, 16]
+// DIST-DAG:   triton_gpu.extract_slice %[[B]][32, 0] [16, 64]
+// DIST:       %[[D1:.*]] = tt.dot %[[A1]], %[[B1]], %[[D0]]
+// DIST:       tt.dot %{{.*}}, %{{.*}}, %[[D1]]
+// DIST:     scf.yield
+tt.func @mmav1_distance(%lb : index, %ub : index, %step : index, %a_init : tensor<64x48xf16, #A>, %b_init : tensor<48x64xf16, #B>) {
+  %c_init = arith.constant dense<0.00e+00> : tensor<64x64xf32, #C>
+  scf.for %iv = %lb to %ub step %step iter_args(%a = %a_init, %b = %b_init, %prev_c = %c_init) -> (tensor<64x48xf16, #A>, tensor<48x64xf16, #B>, tensor<64x64xf32, #C>) {
+    %a_op = triton_gpu.convert_layout %a : (tensor<64x48xf16, #A>) -> tensor<64x48xf16, #A_OP>
+    %b_op = triton_gpu.convert_layout %b : (tensor<48x64xf16, #B>) -> tensor<48x64xf16, #B_OP>
+    %c = tt.dot %a_op, %b_op, %prev_c {allowTF32 = true, transA = false, transB = false} : tensor<64x48xf16, #A_OP> * tensor<48x64xf16, #B_OP> -> tensor<64x64xf32, #C>
+    scf.yield %a, %b, %c : tensor<64x48xf16, #A>, tensor<48x64xf16, #B>, tensor<64x64xf32, #C>
+  }
+  tt.return
+}
@@ -0,0 +1,33 @@
+// RUN: env TRITON_REMARKS=1 triton-opt %s -split-input-file -tritongpu-coalesce -verify-diagnostics
+// RUN: triton-opt %s -split-input-file -tritongpu-coalesce | FileCheck %s
+
+// Remarks are only emitted when TRITON_REMARKS is set
+// CHECK-LABEL: tt.func @strided_load
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func @strided_load(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %c2 = arith.constant dense<2> : tensor<1024xi32, #blocked>
+  %range = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+  %offsets = arith.muli %range, %c2 : tensor<1024xi32, #blocked>
+  %base = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>, #blocked>
+  %ptrs = tt.addptr %base, %offsets : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+  // expected-remark @+1 {{[tritongpu-coalesce] accesses are not vectorized: the pointers are not contiguous along dimension 0 (contiguity 1)}}
+  %val = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32, #blocked>
+  tt.return
+}
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func @unaligned_load(%arg0: !tt.ptr<f32>) {
+  %range = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+  %base = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>, #blocked>
+  %ptrs = tt.addptr %base, %range : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+  // expected-remark @+1 {{[tritongpu-coalesce] accesses are not vectorized: the pointers are only known to be 1-byte aligned along dimension 0}}
+  %val = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32, #blocked>
+  tt.return
+}
+}
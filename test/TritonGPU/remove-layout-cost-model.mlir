@@ -0,0 +1,62 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-remove-layout-conversions=cost-model=true | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Carrying the accumulator in #blocked would take two conversions per
+// iteration (for the dot and for the update) instead of the one of the store.
+// CHECK-LABEL: tt.func @keep_accumulator_layout
+// CHECK: scf.for {{.*}} -> (tensor<128x128xf32, #mma>)
+// CHECK: triton_gpu.convert_layout
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK: scf.yield
+tt.func @keep_accumulator_layout(%a: tensor<128x32xf16, #A>, %b: tensor<32x128xf16, #B>, %ptr: tensor<128x128x!tt.ptr<f32>, #blocked>, %lb: i32, %ub: i32, %step: i32) {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #mma>
+  %0 = scf.for %iv = %lb to %ub step %step iter_args(%acc = %cst) -> (tensor<128x128xf32, #mma>) : i32 {
+    %1 = triton_gpu.convert_layout %acc : (tensor<128x128xf32, #mma>) -> tensor<128x128xf32, #blocked>
+    tt.store %ptr, %1 : tensor<128x128xf32, #blocked>
+    %2 = tt.dot %a, %b, %acc {allowTF32 = true} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #mma>
+    scf.yield %2 : tensor<128x128xf32, #mma>
+  }
+  tt.return
+}
+
+}
+
+// -----
+
+#O = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 4], order = [1, 0]}>
+#X = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#Y = #triton_gpu.blocked<{sizePerThread = [1, 2], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// #X and #Y assign the same rows to every warp, so the conversion between them
+// is done with warp shuffles, while #O splits the columns across the warps.
+// Carrying the iter arg in #O costs a conversion to #X and one to #Y every
+// iteration. Carrying it in #X trades them for a conversion back to #O for the
+// store and the shuffles to #Y, which is only cheaper because the shuffles
+// need neither shared memory nor barriers.
+// CHECK-LABEL: tt.func @carry_in_shuffle_layout
+// CHECK-SAME: %{{.*}}: tensor<64x64x!tt.ptr<f32>, [[X:#[a-z0-9]+]]>
+// CHECK: scf.for {{.*}} -> (tensor<64x64xf32, [[X]]>)
+tt.func @carry_in_shuffle_layout(%ptrX: tensor<64x64x!tt.ptr<f32>, #X>, %ptrY: tensor<64x64x!tt.ptr<f32>, #Y>, %ptrO: tensor<64x64x!tt.ptr<f32>, #O>, %lb: i32, %ub: i32, %step: i32) {
+  %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #O>
+  %0 = scf.for %iv = %lb to %ub step %step iter_args(%acc = %cst) -> (tensor<64x64xf32, #O>) : i32 {
+    %x = triton_gpu.convert_layout %acc : (tensor<64x64xf32, #O>) -> tensor<64x64xf32, #X>
+    %y = triton_gpu.convert_layout %acc : (tensor<64x64xf32, #O>) -> tensor<64x64xf32, #Y>
+    tt.store %ptrY, %y : tensor<64x64xf32, #Y>
+    tt.store %ptrO, %acc : tensor<64x64xf32, #O>
+    %v = tt.load %ptrX {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xf32, #X>
+    %n = arith.addf %x, %v : tensor<64x64xf32, #X>
+    %back = triton_gpu.convert_layout %n : (tensor<64x64xf32, #X>) -> tensor<64x64xf32, #O>
+    scf.yield %back : tensor<64x64xf32, #O>
+  }
+  tt.return
+}
+
+}
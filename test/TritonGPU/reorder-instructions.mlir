@@ -0,0 +1,23 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-reorder-instructions=schedule-for-registers=true | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The splat is sunk to its use, so that it is not live across the load
+// CHECK-LABEL: tt.func @sink_to_use
+// CHECK: tt.load
+// CHECK-NEXT: arith.addf
+// CHECK-NEXT: tt.store
+// CHECK-NEXT: tt.splat
+// CHECK-NEXT: tt.store
+tt.func @sink_to_use(%v: f32, %p0: tensor<128x128x!tt.ptr<f32>, #blocked>, %p1: tensor<128x128x!tt.ptr<f32>, #blocked>) {
+  %0 = tt.splat %v : (f32) -> tensor<128x128xf32, #blocked>
+  %1 = tt.load %p0 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x128xf32, #blocked>
+  %2 = arith.addf %1, %1 : tensor<128x128xf32, #blocked>
+  tt.store %p0, %2 : tensor<128x128xf32, #blocked>
+  tt.store %p1, %0 : tensor<128x128xf32, #blocked>
+  tt.return
+}
+
+}
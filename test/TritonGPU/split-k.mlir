@@ -0,0 +1,97 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-split-k=split-k=4 -verify-diagnostics | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #C}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: tt.func public @matmul_kernel
+// CHECK: %[[SPLIT:.*]] = tt.get_program_id {axis = 2 : i32} : i32
+// CHECK: %[[SPLITS:.*]] = arith.constant 4 : i32
+// CHECK: %[[RANGE:.*]] = arith.subi %[[UB:.*]], %[[LB:.*]] : i32
+// CHECK: %[[ITERS:.*]] = arith.ceildivsi %[[RANGE]], %[[STEP:.*]] : i32
+// CHECK: %[[CHUNK:.*]] = arith.ceildivsi %[[ITERS]], %[[SPLITS]] : i32
+// CHECK: %[[SKIP:.*]] = arith.muli %[[SPLIT]], %[[CHUNK]] : i32
+// CHECK: %[[SKIP_K:.*]] = arith.muli %[[SKIP]], %[[STEP]] : i32
+// CHECK: %[[NEW_LB:.*]] = arith.addi %[[LB]], %[[SKIP_K]] : i32
+// CHECK: %[[CHUNK_K:.*]] = arith.muli %[[CHUNK]], %[[STEP]] : i32
+// CHECK: %[[END:.*]] = arith.addi %[[NEW_LB]], %[[CHUNK_K]] : i32
+// CHECK: %[[NEW_UB:.*]] = arith.minsi %[[UB]], %[[END]] : i32
+// CHECK: %[[A_SKIP:.*]] = tt.splat %[[SKIP]] : (i32) -> tensor<128x32xi32, #{{.*}}>
+// CHECK: %[[A_OFF:.*]] = arith.muli %{{.*}}, %[[A_SKIP]]
+// CHECK: %[[A_INIT:.*]] = tt.addptr %{{.*}}, %[[A_OFF]]
+// CHECK: %[[B_SKIP:.*]] = tt.splat %[[SKIP]] : (i32) -> tensor<32x128xi32, #{{.*}}>
+// CHECK: %[[B_OFF:.*]] = arith.muli %{{.*}}, %[[B_SKIP]]
+// CHECK: %[[B_INIT:.*]] = tt.addptr %{{.*}}, %[[B_OFF]]
+// CHECK: %[[LOOP:.*]]:3 = scf.for %{{.*}} = %[[NEW_LB]] to %[[NEW_UB]] step %[[STEP]] iter_args(%{{.*}} = %[[A_INIT]], %{{.*}} = %[[B_INIT]], %{{.*}} = %{{.*}})
+// CHECK-NOT: tt.store
+// CHECK: "tt.atomic_rmw"(%{{.*}}, %[[LOOP]]#2) {atomic_rmw_op = 5 : i32}
+tt.func public @matmul_kernel(%lb : i32, %ub : i32, %step : i32,
+                  %A : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                  %B : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                  %C : !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %a_ptr_init = tt.splat %A : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %b_ptr_init = tt.splat %B : (!tt.ptr<f16>) -> tensor<32x128x!tt.ptr<f16>, #BL>
+  %c_ptr = tt.splat %C : (!tt.ptr<f32>) -> tensor<128x128x!tt.ptr<f32>, #C>
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  %a_off = arith.constant dense<32> : tensor<128x32xi32, #AL>
+  %b_off = arith.constant dense<4096> : tensor<32x128xi32, #BL>
+
+  %loop:3 = scf.for %iv = %lb to %ub step %step iter_args(%a_ptr = %a_ptr_init, %b_ptr = %b_ptr_init, %prev_c = %c_init) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>) : i32 {
+    %a_ = tt.load %a_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    %a = triton_gpu.convert_layout %a_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A>
+    %b_ = tt.load %b_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x128xf16, #BL>
+    %b = triton_gpu.convert_layout %b_ : (tensor<32x128xf16, #BL>) -> tensor<32x128xf16, #B>
+    %c = tt.dot %a, %b, %prev_c {allowTF32 = true, transA = false, transB = false} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+    %next_a_ptr = tt.addptr %a_ptr, %a_off : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+    scf.yield %next_a_ptr, %next_b_ptr, %c : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>
+  }
+  tt.store %c_ptr, %loop#2 : tensor<128x128xf32, #C>
+  tt.return
+}
+
+}
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #C}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The partial sums would be added in f16
+// expected-error @+1 {{cannot split the K loop of this kernel}}
+tt.func public @matmul_kernel_f16_out(%lb : i32, %ub : i32, %step : i32,
+                  %A : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                  %B : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                  %C : !tt.ptr<f16> {tt.divisibility = 16 : i32}) {
+  %a_ptr_init = tt.splat %A : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %b_ptr_init = tt.splat %B : (!tt.ptr<f16>) -> tensor<32x128x!tt.ptr<f16>, #BL>
+  %c_ptr = tt.splat %C : (!tt.ptr<f16>) -> tensor<128x128x!tt.ptr<f16>, #C>
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  %a_off = arith.constant dense<32> : tensor<128x32xi32, #AL>
+  %b_off = arith.constant dense<4096> : tensor<32x128xi32, #BL>
+
+  %loop:3 = scf.for %iv = %lb to %ub step %step iter_args(%a_ptr = %a_ptr_init, %b_ptr = %b_ptr_init, %prev_c = %c_init) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>) : i32 {
+    %a_ = tt.load %a_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    %a = triton_gpu.convert_layout %a_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A>
+    %b_ = tt.load %b_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x128xf16, #BL>
+    %b = triton_gpu.convert_layout %b_ : (tensor<32x128xf16, #BL>) -> tensor<32x128xf16, #B>
+    %c = tt.dot %a, %b, %prev_c {allowTF32 = true, transA = false, transB = false} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+    %next_a_ptr = tt.addptr %a_ptr, %a_off : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+    scf.yield %next_a_ptr, %next_b_ptr, %c : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>
+  }
+  %out = arith.truncf %loop#2 : tensor<128x128xf32, #C> to tensor<128x128xf16, #C>
+  tt.store %c_ptr, %out : tensor<128x128xf16, #C>
+  tt.return
+}
+
+}
@@ -10,6 +10,13 @@ struct TestAllocationPass
 
   MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestAllocationPass);
 
+  TestAllocationPass() = default;
+  TestAllocationPass(const TestAllocationPass &other) : PassWrapper(other) {}
+
+  Option<bool> bestFit{*this, "best-fit",
+                       llvm::cl::desc("use the best fit allocation policy"),
+                       llvm::cl::init(false)};
+
   StringRef getArgument() const final { return "test-print-allocation"; }
   StringRef getDescription() const final {
     return "print the result of the allocation pass";
@@ -21,7 +28,8 @@ struct TestAllocationPass
     // Convert to std::string can remove quotes from opName
     auto opName = SymbolTable::getSymbolName(operation).getValue().str();
     os << opName << "\n";
-    Allocation allocation(operation);
+    Allocation allocation(operation, bestFit ? AllocationPolicy::BestFit
+                                             : AllocationPolicy::FirstFit);
     operation->walk([&](Operation *op) {
       auto scratchBufferId = allocation.getBufferId(op);
       if (scratchBufferId != Allocation::InvalidBufferId) {
@@ -41,6 +49,7 @@ struct TestAllocationPass
       }
     });
     os << "size = " << allocation.getSharedMemorySize() << "\n";
+    os << "fragmentation = " << allocation.getFragmentation() << "\n";
   }
 };
 
@@ -0,0 +1,41 @@
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/BankConflicts.h"
+
+using namespace mlir;
+
+namespace {
+
+struct TestBankConflictsPass
+    : public PassWrapper<TestBankConflictsPass,
+                         OperationPass<triton::FuncOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestBankConflictsPass);
+
+  StringRef getArgument() const final { return "test-print-bank-conflicts"; }
+  StringRef getDescription() const final {
+    return "print the bank conflict degree of shared memory accesses";
+  }
+
+  void runOnOperation() override {
+    Operation *operation = getOperation();
+    auto &os = llvm::errs();
+    auto opName = SymbolTable::getSymbolName(operation).getValue().str();
+    os << "@" << opName << "\n";
+    operation->walk([&](Operation *op) {
+      unsigned degree = getBankConflictDegree(op);
+      if (degree == 0)
+        return;
+      os << op->getName() << " => bank conflicts = " << degree << "\n";
+    });
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace test {
+void registerTestBankConflictsPass() {
+  PassRegistration<TestBankConflictsPass>();
+}
+} // namespace test
+} // namespace mlir
@@ -32,6 +32,7 @@ struct TestMembarPass
     MembarAnalysis membarPass(&allocation);
     membarPass.run();
 
+    os << "removed barriers = " << membarPass.getNumRemovedBarriers() << "\n";
     os << *operation << "\n";
   }
 };